@@ -14,6 +14,10 @@
 #include <d3d12.h>
 #include <asdxTypedef.h>
 #include <asdxRef.h>
+#include <asdxResidency.h>
+#include <asdxReleaseQueue.h>
+#include <asdxMemoryTracker.h>
+#include <asdxTimer.h>
 
 
 //-------------------------------------------------------------------------------------------------
@@ -58,6 +62,7 @@ protected:
     HWND                m_hWnd;             //!< EBhEnhł.
     UINT                m_BufferCount;      //!< obt@ł.
     DXGI_FORMAT         m_SwapChainFormat;  //!< Xbv`FC̃tH[}bgł.
+    DXGI_FORMAT         m_DepthStencilFormat;   //!< [xXeVobt@̃tH[}bgł.
     D3D12_VIEWPORT      m_Viewport;         //!< r[|[gł.
 
     //=============================================================================================
@@ -75,23 +80,41 @@ protected:
         D3D12_RESOURCE_STATES       stateBefore,
         D3D12_RESOURCE_STATES       stateAfter );
     void Present( u32 syncInterval );
+    void DeferRelease( IUnknown* pObject );
 
 private:
     //=============================================================================================
     // private variables.
     //=============================================================================================
+    static const u32 FrameCount = 2;        //!< ɏt[(obNobt@)ł.
+
     asdx::RefPtr<ID3D12Device>              m_Device;                   //!< foCXł.
-    asdx::RefPtr<ID3D12CommandAllocator>    m_CmdAllocator;             //!< R}hAP[^ł.
+    asdx::RefPtr<ID3D12CommandAllocator>    m_CmdAllocator[FrameCount]; //!< t[Ƃ̃R}hAP[^ł.
     asdx::RefPtr<ID3D12CommandQueue>        m_CmdQueue;                 //!< R}hL[ł.
     asdx::RefPtr<ID3D12GraphicsCommandList> m_CmdList;                  //!< R}hXgł.
     asdx::RefPtr<IDXGIAdapter>              m_Adapter;                  //!< A_v^[ł.
     asdx::RefPtr<IDXGIFactory4>             m_Factory;                  //!< DXGIt@Ng[ł.
-    asdx::RefPtr<IDXGISwapChain>            m_SwapChain;                //!< Xbv`FCł.
+    asdx::RefPtr<IDXGISwapChain3>           m_SwapChain;                //!< Xbv`FCł.
     asdx::RefPtr<ID3D12DescriptorHeap>      m_DescriptorHeap;           //!< fXNv^[q[vł.
-    asdx::RefPtr<ID3D12Resource>            m_ColorTarget;              //!< J[^[Qbg̃\[Xł.
+    asdx::RefPtr<ID3D12Resource>            m_ColorTarget[FrameCount];  //!< obNobt@Ƃ̃J[^[Qbg̃\[Xł.
+    asdx::RefPtr<ID3D12DescriptorHeap>      m_DepthDescriptorHeap;      //!< [xXeVp̃fXNv^[q[vł.
+    asdx::RefPtr<ID3D12Resource>            m_DepthTarget;              //!< [x^[Qbg̃\[Xł.
     asdx::RefPtr<ID3D12Fence>               m_Fence;                    //!< tFXł.
-    D3D12_CPU_DESCRIPTOR_HANDLE             m_ColorTargetHandle;        //!< J[^[Qbg̃nhł.
+    D3D12_CPU_DESCRIPTOR_HANDLE             m_ColorTargetHandle[FrameCount];    //!< J[^[Qbg̃nhł.
+    D3D12_CPU_DESCRIPTOR_HANDLE             m_DepthTargetHandle;        //!< [x^[Qbg̃nhł.
     HANDLE                                  m_EventHandle;              //!< Cxgnhł.
+    asdx::ResidencyManager                  m_Residency;                //!< WfV[}l[Wł.
+    u32                                     m_ColorTargetResidency[FrameCount]; //!< J[^[Qbg̃WfV[nhł.
+    u32                                     m_DepthTargetResidency;     //!< [x^[Qbg̃WfV[nhł.
+    asdx::ReleaseQueue<IUnknown>            m_ReleaseQueue;             //!< L[ł.
+    u64                                     m_FenceValue;               //!< ŌɃVOitFXlł.
+    u64                                     m_FrameFenceValue[FrameCount];  //!< t[Ƃ̊tFXlł.
+    u32                                     m_FrameIndex;               //!< L^̃t[ԍł.
+    u32                                     m_BackBufferIndex;          //!< `̃obNobt@ԍł.
+    asdx::StopWatch                         m_FrameWatch;               //!< t[Ԃ̌vpł.
+    f64                                     m_FrameTimeSum;             //!< Wṽt[Ԃ̍vł(~b).
+    u64                                     m_FrameAllocSum[asdx::MEMORY_TAG_COUNT];    //!< Wṽ^OƂ̊mۉ񐔂̍vł.
+    u32                                     m_FrameStatsCount;          //!< Wṽt[ł.
 
     //=============================================================================================
     // private methods.
@@ -103,6 +126,13 @@ private:
     bool InitD3D ();
     void TermD3D ();
     void MainLoop();
+    void WaitForGpu();
+    u64  SignalFence();
+    void WaitForFence( u64 value );
+    bool CreateColorTargets();
+    void ReleaseColorTargets();
+    bool CreateDepthTarget( u32 width, u32 height );
+    void UpdateFrameStats();
 
     static LRESULT CALLBACK MsgProc(HWND hWnd, UINT uMsg, WPARAM wp, LPARAM lp);
 };
@@ -0,0 +1,189 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAlignedAllocator.h
+// Desc : Aligned Allocator and Containers.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_ALIGNED_ALLOCATOR_H__
+#define __ASDX_ALIGNED_ALLOCATOR_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxMemoryTracker.h>
+#include <cstdlib>
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <vector>
+#include <limits>
+
+#if ASDX_IS_WIN
+#include <malloc.h>
+#endif//ASDX_IS_WIN
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const u32 CacheLineSize = 64;    //!< キャッシュラインのバイト数です.
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アライメントされたメモリを確保します.
+//!
+//! @param [in]     size        確保するバイト数.
+//! @param [in]     alignment   アライメント. 2の累乗かつポインタのサイズ以上である必要があります.
+//! @return     確保したメモリを返却します. 確保に失敗した場合は nullptr を返却します.
+//! @note       AlignedFree() で解放してください.
+//-------------------------------------------------------------------------------------------------
+inline void* AlignedAlloc( size_t size, size_t alignment )
+{
+    assert( alignment >= sizeof(void*) && ( alignment & ( alignment - 1 ) ) == 0 );
+#if ASDX_IS_WIN
+    return _aligned_malloc( size, alignment );
+#else
+    void* ptr = nullptr;
+    if ( posix_memalign( &ptr, alignment, size ) != 0 )
+    { ptr = nullptr; }
+    return ptr;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      AlignedAlloc() で確保したメモリを解放します.
+//-------------------------------------------------------------------------------------------------
+inline void AlignedFree( void* ptr )
+{
+#if ASDX_IS_WIN
+    _aligned_free( ptr );
+#else
+    free( ptr );
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AlignedAllocator class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, u32 Alignment = CacheLineSize, MEMORY_TAG Tag = MEMORY_TAG_MATH>
+class AlignedAllocator
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+    static_assert( ( Alignment & ( Alignment - 1 ) ) == 0, "Alignment must be a power of two." );
+    static_assert( Alignment >= sizeof(void*), "Alignment must be at least the size of a pointer." );
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    template<typename U>
+    struct rebind
+    { typedef AlignedAllocator<U, Alignment, Tag> other; };
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    AlignedAllocator()
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      別の型のアロケータから生成します.
+    //---------------------------------------------------------------------------------------------
+    template<typename U>
+    AlignedAllocator( const AlignedAllocator<U, Alignment, Tag>& )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      count 個分のメモリを確保します.
+    //!
+    //! @note       確保に失敗した場合は std::bad_alloc を送出します.
+    //---------------------------------------------------------------------------------------------
+    T* allocate( size_t count )
+    {
+        if ( count > max_size() )
+        { throw std::bad_alloc(); }
+
+        auto size = sizeof(T) * count;
+        auto ptr  = AlignedAlloc( size, Alignment );
+        if ( ptr == nullptr )
+        { throw std::bad_alloc(); }
+
+        MemoryTracker::Instance().OnAlloc( Tag, size );
+        return static_cast<T*>( ptr );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      allocate() で確保したメモリを解放します.
+    //---------------------------------------------------------------------------------------------
+    void deallocate( T* ptr, size_t count )
+    {
+        MemoryTracker::Instance().OnFree( Tag, sizeof(T) * count );
+        AlignedFree( ptr );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      確保できる最大の要素数を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t max_size() const
+    { return std::numeric_limits<size_t>::max() / sizeof(T); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      等価比較演算子です. 状態を持たないので常に等しくなります.
+    //---------------------------------------------------------------------------------------------
+    template<typename U>
+    bool operator == ( const AlignedAllocator<U, Alignment, Tag>& ) const
+    { return true; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      非等価比較演算子です.
+    //---------------------------------------------------------------------------------------------
+    template<typename U>
+    bool operator != ( const AlignedAllocator<U, Alignment, Tag>& ) const
+    { return false; }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      先頭が Alignment でアライメントされた可変長配列です.
+//!
+//! @note       要素ごとのアライメントは要素の型に従います. 要素ごとに揃える場合は
+//!             AlignedType や CacheAligned を要素にしてください.
+//-------------------------------------------------------------------------------------------------
+template<typename T, u32 Alignment = CacheLineSize>
+using AlignedVector = std::vector<T, AlignedAllocator<T, Alignment>>;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CacheAligned structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+struct ASDX_ALIGN(64) CacheAligned
+{
+    T   Value;      //!< 値です. 隣の要素とキャッシュラインを共有しません.
+};
+
+static_assert( sizeof(CacheAligned<u32>) == CacheLineSize, "CacheAligned must occupy one cache line." );
+
+} // namespace asdx
+
+#endif//__ASDX_ALIGNED_ALLOCATOR_H__
@@ -0,0 +1,440 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAnimation.h
+// Desc : Skeletal Animation Sampling Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_ANIMATION_H__
+#define __ASDX_ANIMATION_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxSimd.h>
+#include <asdxSoA.h>
+#include <asdxQuantization.h>
+#include <asdxParallel.h>
+#include <vector>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AnimationPose class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class AnimationPose
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    Vector4SoA  Rotation;       //!< ジョイントごとの回転(クォータニオン)です.
+    Vector3SoA  Translation;    //!< ジョイントごとの平行移動です.
+    Vector3SoA  Scale;          //!< ジョイントごとのスケールです.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ジョイント数を変更します.
+    //---------------------------------------------------------------------------------------------
+    void Resize( u32 jointCount )
+    {
+        Rotation   .Resize( jointCount );
+        Translation.Resize( jointCount );
+        Scale      .Resize( jointCount );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ジョイント数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetJointCount() const
+    { return Rotation.GetCount(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      2つのポーズをブレンドします.
+    //!
+    //! @param [in]     a           入力ポーズ.
+    //! @param [in]     b           入力ポーズ.
+    //! @param [in]     weight      b の重み.
+    //! @param [out]    result      ブレンド結果. a, b と同じオブジェクトでも構いません.
+    //! @note       回転は最短経路の正規化線形補間(nlerp)で補間します.
+    //---------------------------------------------------------------------------------------------
+    static void Blend( const AnimationPose& a, const AnimationPose& b, f32 weight, AnimationPose& result )
+    {
+        assert( a.GetJointCount() == b.GetJointCount() );
+        result.Resize( a.GetJointCount() );
+
+        NLerp( a.Rotation, b.Rotation, weight, result.Rotation );
+        Vector3SoA::Lerp( a.Translation, b.Translation, weight, result.Translation );
+        Vector3SoA::Lerp( a.Scale,       b.Scale,       weight, result.Scale );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      クォータニオンの配列を正規化線形補間します.
+    //!
+    //! @param [in]     a           入力クォータニオン.
+    //! @param [in]     b           入力クォータニオン.
+    //! @param [in]     amount      補間係数.
+    //! @param [out]    result      補間結果. a, b と同じオブジェクトでも構いません.
+    //! @note       内積が負の場合は b を反転して最短経路で補間します.
+    //---------------------------------------------------------------------------------------------
+    static void NLerp( const Vector4SoA& a, const Vector4SoA& b, f32 amount, Vector4SoA& result )
+    {
+        using namespace simd;
+        assert( a.GetCount() == b.GetCount() );
+        result.Resize( a.GetCount() );
+
+        auto t = SetN( amount );
+        auto n = a.GetPaddedCount();
+        for( u32 i=0; i<n; i+=FloatNWidth )
+        {
+            auto ax = LoadN( a.X() + i );
+            auto ay = LoadN( a.Y() + i );
+            auto az = LoadN( a.Z() + i );
+            auto aw = LoadN( a.W() + i );
+            auto bx = LoadN( b.X() + i );
+            auto by = LoadN( b.Y() + i );
+            auto bz = LoadN( b.Z() + i );
+            auto bw = LoadN( b.W() + i );
+
+            auto d = AddN( AddN( AddN( MulN( ax, bx ), MulN( ay, by ) ), MulN( az, bz ) ), MulN( aw, bw ) );
+            bx = FlipSignN( bx, d );
+            by = FlipSignN( by, d );
+            bz = FlipSignN( bz, d );
+            bw = FlipSignN( bw, d );
+
+            auto x = AddN( ax, MulN( t, SubN( bx, ax ) ) );
+            auto y = AddN( ay, MulN( t, SubN( by, ay ) ) );
+            auto z = AddN( az, MulN( t, SubN( bz, az ) ) );
+            auto w = AddN( aw, MulN( t, SubN( bw, aw ) ) );
+
+            // 余白の要素はゼロのまま.
+            auto mag = SqrtN( AddN( AddN( AddN( MulN( x, x ), MulN( y, y ) ), MulN( z, z ) ), MulN( w, w ) ) );
+            StoreN( result.X() + i, MaskPositiveN( mag, DivN( x, mag ) ) );
+            StoreN( result.Y() + i, MaskPositiveN( mag, DivN( y, mag ) ) );
+            StoreN( result.Z() + i, MaskPositiveN( mag, DivN( z, mag ) ) );
+            StoreN( result.W() + i, MaskPositiveN( mag, DivN( w, mag ) ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ジョイントごとのローカル変換行列を求めます.
+    //!
+    //! @param [out]    pResult     GetJointCount() 個の出力先.
+    //! @note       Matrix::CreateScale() * Matrix::CreateFromQuaternion() * Matrix::CreateTranslation()
+    //!             と同じ変換です.
+    //---------------------------------------------------------------------------------------------
+    void ToMatrix3x4( Matrix3x4* pResult ) const
+    {
+        using namespace simd;
+
+        auto one   = SetN( 1.0f );
+        auto two   = SetN( 2.0f );
+        auto count = GetJointCount();
+
+        ASDX_ALIGN(32) f32 temp[12][8];
+        for( u32 i=0; i<count; i+=FloatNWidth )
+        {
+            auto qx = LoadN( Rotation.X() + i );
+            auto qy = LoadN( Rotation.Y() + i );
+            auto qz = LoadN( Rotation.Z() + i );
+            auto qw = LoadN( Rotation.W() + i );
+            auto sx = LoadN( Scale.X() + i );
+            auto sy = LoadN( Scale.Y() + i );
+            auto sz = LoadN( Scale.Z() + i );
+
+            auto xx = MulN( qx, qx );
+            auto yy = MulN( qy, qy );
+            auto zz = MulN( qz, qz );
+            auto xy = MulN( qx, qy );
+            auto yw = MulN( qy, qw );
+            auto yz = MulN( qy, qz );
+            auto xw = MulN( qx, qw );
+            auto zx = MulN( qz, qx );
+            auto zw = MulN( qz, qw );
+
+            // 転置して格納するので, 各行は Matrix の列になる.
+            StoreN( temp[ 0], MulN( sx, SubN( one, MulN( two, AddN( yy, zz ) ) ) ) );
+            StoreN( temp[ 1], MulN( sy, MulN( two, SubN( xy, zw ) ) ) );
+            StoreN( temp[ 2], MulN( sz, MulN( two, AddN( zx, yw ) ) ) );
+            StoreN( temp[ 3], LoadN( Translation.X() + i ) );
+            StoreN( temp[ 4], MulN( sx, MulN( two, AddN( xy, zw ) ) ) );
+            StoreN( temp[ 5], MulN( sy, SubN( one, MulN( two, AddN( zz, xx ) ) ) ) );
+            StoreN( temp[ 6], MulN( sz, MulN( two, SubN( yz, xw ) ) ) );
+            StoreN( temp[ 7], LoadN( Translation.Y() + i ) );
+            StoreN( temp[ 8], MulN( sx, MulN( two, SubN( zx, yw ) ) ) );
+            StoreN( temp[ 9], MulN( sy, MulN( two, AddN( yz, xw ) ) ) );
+            StoreN( temp[10], MulN( sz, SubN( one, MulN( two, AddN( yy, xx ) ) ) ) );
+            StoreN( temp[11], LoadN( Translation.Z() + i ) );
+
+            auto end = ( count - i < FloatNWidth ) ? count - i : FloatNWidth;
+            for( u32 j=0; j<end; ++j )
+            {
+                auto& m = pResult[i + j];
+                for( u32 k=0; k<12; ++k )
+                { ( &m._11 )[k] = temp[k][j]; }
+            }
+        }
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AnimationClip class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class AnimationClip
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    AnimationClip()
+    : m_JointCount  ( 0 )
+    , m_JointStride ( 0 )
+    , m_FrameCount  ( 0 )
+    , m_FrameRate   ( 30.0f )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param [in]     jointCount      ジョイント数です.
+    //! @param [in]     frameCount      キーフレーム数です(1以上).
+    //! @param [in]     frameRate       1秒あたりのキーフレーム数です.
+    //! @note       全てのキーは単位姿勢で初期化されます.
+    //---------------------------------------------------------------------------------------------
+    void Init( u32 jointCount, u32 frameCount, f32 frameRate )
+    {
+        assert( frameCount > 0 );
+        assert( frameRate > 0.0f );
+
+        m_JointCount  = jointCount;
+        m_JointStride = ( jointCount + SoABuffer<4>::BlockSize - 1 ) & ~( SoABuffer<4>::BlockSize - 1 );
+        m_FrameCount  = frameCount;
+        m_FrameRate   = frameRate;
+
+        m_Rotations   .assign( size_t( m_JointStride ) * 4 * frameCount, 0 );
+        m_Translations.assign( size_t( m_JointStride ) * 3 * frameCount, 0 );
+        m_Scales      .assign( size_t( m_JointStride ) * 3 * frameCount, 0 );
+
+        for( u32 f=0; f<frameCount; ++f )
+        {
+            for( u32 j=0; j<jointCount; ++j )
+            { SetKey( f, j, Quaternion( 0.0f, 0.0f, 0.0f, 1.0f ), Vector3( 0.0f, 0.0f, 0.0f ), Vector3( 1.0f, 1.0f, 1.0f ) ); }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      キーを設定します.
+    //!
+    //! @param [in]     frame           キーフレーム番号です.
+    //! @param [in]     joint           ジョイント番号です.
+    //! @param [in]     rotation        回転(正規化済み)です. SNORM16 x 4 に量子化されます.
+    //! @param [in]     translation     平行移動です. f16 x 3 に変換されます.
+    //! @param [in]     scale           スケールです. f16 x 3 に変換されます.
+    //---------------------------------------------------------------------------------------------
+    void SetKey( u32 frame, u32 joint, const Quaternion& rotation, const Vector3& translation, const Vector3& scale )
+    {
+        assert( frame < m_FrameCount );
+        assert( joint < m_JointCount );
+
+        auto pR = &m_Rotations   [ size_t( frame ) * m_JointStride * 4 ];
+        auto pT = &m_Translations[ size_t( frame ) * m_JointStride * 3 ];
+        auto pS = &m_Scales      [ size_t( frame ) * m_JointStride * 3 ];
+
+        pR[ m_JointStride * 0 + joint ] = EncodeSnorm16( rotation.x );
+        pR[ m_JointStride * 1 + joint ] = EncodeSnorm16( rotation.y );
+        pR[ m_JointStride * 2 + joint ] = EncodeSnorm16( rotation.z );
+        pR[ m_JointStride * 3 + joint ] = EncodeSnorm16( rotation.w );
+
+        pT[ m_JointStride * 0 + joint ] = F32ToF16( translation.x );
+        pT[ m_JointStride * 1 + joint ] = F32ToF16( translation.y );
+        pT[ m_JointStride * 2 + joint ] = F32ToF16( translation.z );
+
+        pS[ m_JointStride * 0 + joint ] = F32ToF16( scale.x );
+        pS[ m_JointStride * 1 + joint ] = F32ToF16( scale.y );
+        pS[ m_JointStride * 2 + joint ] = F32ToF16( scale.z );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ジョイント数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetJointCount() const
+    { return m_JointCount; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      キーフレーム数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetFrameCount() const
+    { return m_FrameCount; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      再生時間(秒)を取得します.
+    //---------------------------------------------------------------------------------------------
+    f32 GetDuration() const
+    { return ( m_FrameCount - 1 ) / m_FrameRate; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      指定時刻のポーズを求めます.
+    //!
+    //! @param [in]     time        時刻(秒)です.
+    //! @param [in]     loop        ループ再生する場合は true を指定します.
+    //! @param [out]    result      ポーズの格納先です.
+    //! @note       前後のキーフレームを全ジョイント分まとめて展開し, SIMD で補間します.
+    //---------------------------------------------------------------------------------------------
+    void Sample( f32 time, bool loop, AnimationPose& result ) const
+    {
+        // 対象のキーフレームを求める.
+        auto duration = GetDuration();
+        if ( loop && duration > 0.0f )
+        {
+            time = fmodf( time, duration );
+            if ( time < 0.0f )
+            { time += duration; }
+        }
+
+        auto frame = Clamp( time * m_FrameRate, 0.0f, f32( m_FrameCount - 1 ) );
+        auto f0    = static_cast<u32>( frame );
+        auto f1    = ( f0 + 1 < m_FrameCount ) ? f0 + 1 : f0;
+        auto alpha = frame - f32( f0 );
+
+        auto& next = GetScratchPose();
+        result.Resize( m_JointCount );
+        next  .Resize( m_JointCount );
+
+        Decode( f0, result );
+        if ( f1 == f0 || alpha <= 0.0f )
+        {
+            AnimationPose::NLerp( result.Rotation, result.Rotation, 0.0f, result.Rotation );
+            return;
+        }
+
+        Decode( f1, next );
+        AnimationPose::Blend( result, next, alpha, result );
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    u32                 m_JointCount;       //!< ジョイント数です.
+    u32                 m_JointStride;      //!< 成分配列あたりの要素数です(8の倍数).
+    u32                 m_FrameCount;       //!< キーフレーム数です.
+    f32                 m_FrameRate;        //!< 1秒あたりのキーフレーム数です.
+    std::vector<s16>    m_Rotations;        //!< [frame][xyzw][joint] の回転キーです.
+    std::vector<f16>    m_Translations;     //!< [frame][xyz][joint] の平行移動キーです.
+    std::vector<f16>    m_Scales;           //!< [frame][xyz][joint] のスケールキーです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      キーフレームを展開します.
+    //---------------------------------------------------------------------------------------------
+    void Decode( u32 frame, AnimationPose& pose ) const
+    {
+        // 作業用ポーズは容量が縮まないので, 容量ではなく切り上げたジョイント数で判定する.
+        assert( pose.GetJointCount() == m_JointCount );
+        assert( pose.Rotation.GetPaddedCount() == m_JointStride );
+
+        auto pR = &m_Rotations   [ size_t( frame ) * m_JointStride * 4 ];
+        auto pT = &m_Translations[ size_t( frame ) * m_JointStride * 3 ];
+        auto pS = &m_Scales      [ size_t( frame ) * m_JointStride * 3 ];
+
+        // 余白のキーもゼロなので, 切り上げたジョイント数分まとめて展開する.
+        for( u32 c=0; c<4; ++c )
+        { DecodeSnorm16Stream( pR + m_JointStride * c, m_JointStride, pose.Rotation.GetComponent( c ) ); }
+
+        for( u32 c=0; c<3; ++c )
+        {
+            F16ToF32Stream( pT + m_JointStride * c, m_JointStride, pose.Translation.GetComponent( c ) );
+            F16ToF32Stream( pS + m_JointStride * c, m_JointStride, pose.Scale      .GetComponent( c ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      スレッドごとの作業用ポーズを取得します.
+    //---------------------------------------------------------------------------------------------
+    static AnimationPose& GetScratchPose()
+    {
+        thread_local AnimationPose s_Pose;
+        return s_Pose;
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AnimationJob structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct AnimationJob
+{
+    const AnimationClip*    pClip;          //!< 再生するクリップです.
+    f32                     Time;           //!< pClip の時刻(秒)です.
+    const AnimationClip*    pBlendClip;     //!< ブレンドするクリップです. nullptr の場合はブレンドしません.
+    f32                     BlendTime;      //!< pBlendClip の時刻(秒)です.
+    f32                     BlendWeight;    //!< pBlendClip の重みです.
+    bool                    Loop;           //!< ループ再生するかどうか.
+    AnimationPose*          pPose;          //!< 出力先のポーズです.
+    Matrix3x4*              pMatrices;      //!< ローカル変換行列の出力先です. nullptr の場合は出力しません.
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      複数キャラクターのアニメーションを並列に評価します.
+//!
+//! @param [in]     pJobs       ジョブの配列.
+//! @param [in]     count       ジョブ数.
+//! @param [in]     grain       1タスクあたりのジョブ数です.
+//-------------------------------------------------------------------------------------------------
+inline void EvaluateAnimationJobs( const AnimationJob* pJobs, u32 count, u32 grain = 16 )
+{
+    ParallelFor( count, grain, [pJobs]( u32 begin, u32 end )
+    {
+        thread_local AnimationPose s_BlendPose;
+
+        for( u32 i=begin; i<end; ++i )
+        {
+            auto& job = pJobs[i];
+            assert( job.pClip != nullptr && job.pPose != nullptr );
+
+            job.pClip->Sample( job.Time, job.Loop, *job.pPose );
+
+            if ( job.pBlendClip != nullptr )
+            {
+                job.pBlendClip->Sample( job.BlendTime, job.Loop, s_BlendPose );
+                AnimationPose::Blend( *job.pPose, s_BlendPose, job.BlendWeight, *job.pPose );
+            }
+
+            if ( job.pMatrices != nullptr )
+            { job.pPose->ToMatrix3x4( job.pMatrices ); }
+        }
+    });
+}
+
+} // namespace asdx
+
+#endif//__ASDX_ANIMATION_H__
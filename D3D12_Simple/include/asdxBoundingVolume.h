@@ -0,0 +1,535 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxBoundingVolume.h
+// Desc : Bounding Volume Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_BOUNDING_VOLUME_H__
+#define __ASDX_BOUNDING_VOLUME_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <cfloat>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BoundingBox structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BoundingBox
+{
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    Vector3 Mini;       //!< 最小値です.
+    Vector3 Maxi;       //!< 最大値です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @note       空のボックス(最小値 > 最大値)で初期化します.
+    //---------------------------------------------------------------------------------------------
+    BoundingBox()
+    : Mini(  FLT_MAX,  FLT_MAX,  FLT_MAX )
+    , Maxi( -FLT_MAX, -FLT_MAX, -FLT_MAX )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    BoundingBox( const Vector3& mini, const Vector3& maxi )
+    : Mini( mini )
+    , Maxi( maxi )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      中心を取得します.
+    //---------------------------------------------------------------------------------------------
+    Vector3 GetCenter() const
+    { return Vector3( ( Mini.x + Maxi.x ) * 0.5f, ( Mini.y + Maxi.y ) * 0.5f, ( Mini.z + Maxi.z ) * 0.5f ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      各軸の半分の大きさを取得します.
+    //---------------------------------------------------------------------------------------------
+    Vector3 GetExtent() const
+    { return Vector3( ( Maxi.x - Mini.x ) * 0.5f, ( Maxi.y - Mini.y ) * 0.5f, ( Maxi.z - Mini.z ) * 0.5f ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      空のボックスかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsEmpty() const
+    { return ( Mini.x > Maxi.x ) || ( Mini.y > Maxi.y ) || ( Mini.z > Maxi.z ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      点を含むように拡張します.
+    //---------------------------------------------------------------------------------------------
+    void Merge( const Vector3& point )
+    {
+        Mini = Vector3::Min( Mini, point );
+        Maxi = Vector3::Max( Maxi, point );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボックスを含むように拡張します.
+    //---------------------------------------------------------------------------------------------
+    void Merge( const BoundingBox& value )
+    {
+        Mini = Vector3::Min( Mini, value.Mini );
+        Maxi = Vector3::Max( Maxi, value.Maxi );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      点を含むかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Contains( const Vector3& point ) const
+    {
+        return ( Mini.x <= point.x ) && ( point.x <= Maxi.x )
+            && ( Mini.y <= point.y ) && ( point.y <= Maxi.y )
+            && ( Mini.z <= point.z ) && ( point.z <= Maxi.z );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボックス同士が交差するかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Intersects( const BoundingBox& value ) const
+    {
+        return ( Mini.x <= value.Maxi.x ) && ( value.Mini.x <= Maxi.x )
+            && ( Mini.y <= value.Maxi.y ) && ( value.Mini.y <= Maxi.y )
+            && ( Mini.z <= value.Maxi.z ) && ( value.Mini.z <= Maxi.z );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      点群を囲むボックスを生成します.
+    //---------------------------------------------------------------------------------------------
+    static BoundingBox CreateFromPoints( const Vector3* pPoints, u32 count )
+    {
+        BoundingBox result;
+        for( u32 i=0; i<count; ++i )
+        { result.Merge( pPoints[i] ); }
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      変換後のボックスを囲むボックスを求めます.
+    //!
+    //! @note       Arvo の方法で8頂点を変換せずに求めます.
+    //---------------------------------------------------------------------------------------------
+    static BoundingBox Transform( const BoundingBox& value, const Matrix& matrix )
+    {
+        auto c = Vector3::Transform( value.GetCenter(), matrix );
+        auto e = value.GetExtent();
+
+        Vector3 r(
+            fabsf( matrix._11 ) * e.x + fabsf( matrix._21 ) * e.y + fabsf( matrix._31 ) * e.z,
+            fabsf( matrix._12 ) * e.x + fabsf( matrix._22 ) * e.y + fabsf( matrix._32 ) * e.z,
+            fabsf( matrix._13 ) * e.x + fabsf( matrix._23 ) * e.y + fabsf( matrix._33 ) * e.z );
+
+        return BoundingBox( c - r, c + r );
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BoundingSphere structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BoundingSphere
+{
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    Vector3 Center;     //!< 中心です.
+    f32     Radius;     //!< 半径です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    BoundingSphere()
+    : Center( 0.0f, 0.0f, 0.0f )
+    , Radius( 0.0f )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    BoundingSphere( const Vector3& center, f32 radius )
+    : Center( center )
+    , Radius( radius )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      点を含むかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Contains( const Vector3& point ) const
+    { return Vector3::DistanceSq( Center, point ) <= Radius * Radius; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      球同士が交差するかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Intersects( const BoundingSphere& value ) const
+    {
+        auto r = Radius + value.Radius;
+        return Vector3::DistanceSq( Center, value.Center ) <= r * r;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボックスに外接する球を生成します.
+    //---------------------------------------------------------------------------------------------
+    static BoundingSphere CreateFromBox( const BoundingBox& value )
+    {
+        auto e = value.GetExtent();
+        return BoundingSphere( value.GetCenter(), sqrtf( e.x * e.x + e.y * e.y + e.z * e.z ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      点群を囲む球を生成します.
+    //!
+    //! @note       バウンディングボックスの中心から最も遠い点までを半径とします(最小球ではありません).
+    //---------------------------------------------------------------------------------------------
+    static BoundingSphere CreateFromPoints( const Vector3* pPoints, u32 count )
+    {
+        auto center = BoundingBox::CreateFromPoints( pPoints, count ).GetCenter();
+        auto radius = 0.0f;
+        for( u32 i=0; i<count; ++i )
+        { radius = Max( radius, Vector3::DistanceSq( center, pPoints[i] ) ); }
+        return BoundingSphere( center, sqrtf( radius ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      変換後の球を求めます.
+    //!
+    //! @note       非一様スケールの場合は最大の軸のスケールで半径を拡大します.
+    //---------------------------------------------------------------------------------------------
+    static BoundingSphere Transform( const BoundingSphere& value, const Matrix& matrix )
+    {
+        auto sx = matrix._11 * matrix._11 + matrix._12 * matrix._12 + matrix._13 * matrix._13;
+        auto sy = matrix._21 * matrix._21 + matrix._22 * matrix._22 + matrix._23 * matrix._23;
+        auto sz = matrix._31 * matrix._31 + matrix._32 * matrix._32 + matrix._33 * matrix._33;
+        auto s  = sqrtf( Max( sx, Max( sy, sz ) ) );
+        return BoundingSphere( Vector3::Transform( value.Center, matrix ), value.Radius * s );
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// OrientedBox structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct OrientedBox
+{
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    Vector3 Center;     //!< 中心です.
+    Vector3 Extent;     //!< 各軸の半分の大きさです.
+    Vector3 Axis[3];    //!< 正規化された各軸の方向です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    OrientedBox()
+    : Center( 0.0f, 0.0f, 0.0f )
+    , Extent( 0.0f, 0.0f, 0.0f )
+    {
+        Axis[0] = Vector3( 1.0f, 0.0f, 0.0f );
+        Axis[1] = Vector3( 0.0f, 1.0f, 0.0f );
+        Axis[2] = Vector3( 0.0f, 0.0f, 1.0f );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      点を含むかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Contains( const Vector3& point ) const
+    {
+        auto d = point - Center;
+        return ( fabsf( Vector3::Dot( d, Axis[0] ) ) <= Extent.x )
+            && ( fabsf( Vector3::Dot( d, Axis[1] ) ) <= Extent.y )
+            && ( fabsf( Vector3::Dot( d, Axis[2] ) ) <= Extent.z );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボックスを変換した有向ボックスを生成します.
+    //!
+    //! @param [in]     value       ローカル空間のボックス.
+    //! @param [in]     matrix      ワールド変換行列(せん断を含まないこと).
+    //---------------------------------------------------------------------------------------------
+    static OrientedBox CreateFromBox( const BoundingBox& value, const Matrix& matrix )
+    {
+        OrientedBox result;
+        result.Center = Vector3::Transform( value.GetCenter(), matrix );
+
+        auto e = value.GetExtent();
+        f32 extent[3] = { e.x, e.y, e.z };
+        for( u32 i=0; i<3; ++i )
+        {
+            Vector3 axis( matrix.m[i][0], matrix.m[i][1], matrix.m[i][2] );
+            auto len = sqrtf( Vector3::Dot( axis, axis ) );
+            result.Axis[i] = ( len > 0.0f ) ? axis / len : result.Axis[i];
+            extent[i] *= len;
+        }
+        result.Extent = Vector3( extent[0], extent[1], extent[2] );
+        return result;
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Frustum structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Frustum
+{
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    Vector4 Planes[6];      //!< 内向きの平面です. dot( xyz, p ) + w >= 0 が内側です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ビュー射影行列から視錐台を生成します.
+    //!
+    //! @param [in]     viewProj    ビュー射影行列(深度範囲 [0, 1]).
+    //! @note       平面は左, 右, 下, 上, 近, 遠の順に格納します.
+    //---------------------------------------------------------------------------------------------
+    static Frustum CreateFromMatrix( const Matrix& viewProj )
+    {
+        const auto& m = viewProj;
+
+        Frustum result;
+        result.Planes[0] = Vector4( m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41 );
+        result.Planes[1] = Vector4( m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41 );
+        result.Planes[2] = Vector4( m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42 );
+        result.Planes[3] = Vector4( m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42 );
+        result.Planes[4] = Vector4( m._13,         m._23,         m._33,         m._43 );
+        result.Planes[5] = Vector4( m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43 );
+
+        for( u32 i=0; i<6; ++i )
+        {
+            auto& p = result.Planes[i];
+            auto len = sqrtf( p.x * p.x + p.y * p.y + p.z * p.z );
+            if ( len > 0.0f )
+            { p = p / len; }
+        }
+
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      点が内側にあるかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Contains( const Vector3& point ) const
+    {
+        for( u32 i=0; i<6; ++i )
+        {
+            const auto& p = Planes[i];
+            if ( p.x * point.x + p.y * point.y + p.z * point.z + p.w < 0.0f )
+            { return false; }
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボックスが視錐台と重なる可能性があるかチェックします.
+    //!
+    //! @note       平面ごとの判定のため, 視錐台の角の外側にあるボックスは可視と判定されることがあります.
+    //!             CullBoxes() と同じ判定結果になります.
+    //---------------------------------------------------------------------------------------------
+    bool Intersects( const BoundingBox& value ) const
+    {
+        auto c = value.GetCenter();
+        auto e = value.GetExtent();
+        for( u32 i=0; i<6; ++i )
+        {
+            const auto& p = Planes[i];
+            auto d = p.x * c.x + p.y * c.y + p.z * c.z + p.w;
+            auto r = fabsf( p.x ) * e.x + fabsf( p.y ) * e.y + fabsf( p.z ) * e.z;
+            if ( d + r < 0.0f )
+            { return false; }
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      球が視錐台と重なる可能性があるかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Intersects( const BoundingSphere& value ) const
+    {
+        const auto& c = value.Center;
+        for( u32 i=0; i<6; ++i )
+        {
+            const auto& p = Planes[i];
+            auto d = p.x * c.x + p.y * c.y + p.z * c.z + p.w;
+            if ( d + value.Radius < 0.0f )
+            { return false; }
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      有向ボックスが視錐台と重なる可能性があるかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool Intersects( const OrientedBox& value ) const
+    {
+        const auto& c = value.Center;
+        const auto& e = value.Extent;
+        for( u32 i=0; i<6; ++i )
+        {
+            const auto& p = Planes[i];
+            auto d  = p.x * c.x + p.y * c.y + p.z * c.z + p.w;
+            auto r0 = fabsf( p.x * value.Axis[0].x + p.y * value.Axis[0].y + p.z * value.Axis[0].z );
+            auto r1 = fabsf( p.x * value.Axis[1].x + p.y * value.Axis[1].y + p.z * value.Axis[1].z );
+            auto r2 = fabsf( p.x * value.Axis[2].x + p.y * value.Axis[2].y + p.z * value.Axis[2].z );
+            if ( d + ( r0 * e.x + r1 * e.y + r2 * e.z ) < 0.0f )
+            { return false; }
+        }
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Ray structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Ray
+{
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    Vector3 Origin;         //!< 始点です.
+    Vector3 Direction;      //!< 方向です(正規化は不要です).
+    f32     TMin;           //!< 交差判定する区間の最小値です.
+    f32     TMax;           //!< 交差判定する区間の最大値です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Ray()
+    : Origin    ( 0.0f, 0.0f, 0.0f )
+    , Direction ( 0.0f, 0.0f, 1.0f )
+    , TMin      ( 0.0f )
+    , TMax      ( FLT_MAX )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Ray( const Vector3& origin, const Vector3& direction, f32 tmin = 0.0f, f32 tmax = FLT_MAX )
+    : Origin    ( origin )
+    , Direction ( direction )
+    , TMin      ( tmin )
+    , TMax      ( tmax )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      指定距離の位置を求めます.
+    //---------------------------------------------------------------------------------------------
+    Vector3 GetPoint( f32 t ) const
+    { return Vector3( Origin.x + Direction.x * t, Origin.y + Direction.y * t, Origin.z + Direction.z * t ); }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイとボックスの交差判定を行います(スラブ法).
+//!
+//! @param [in]     origin      レイの始点.
+//! @param [in]     invDir      レイの方向の逆数.
+//! @param [in]     value       ボックス.
+//! @param [in]     tmin        区間の最小値.
+//! @param [in]     tmax        区間の最大値.
+//! @param [out]    tnear       交差区間の開始位置.
+//! @retval true    交差します.
+//! @retval false   交差しません.
+//-------------------------------------------------------------------------------------------------
+inline bool IntersectRayBox
+(
+    const Vector3&      origin,
+    const Vector3&      invDir,
+    const BoundingBox&  value,
+    f32                 tmin,
+    f32                 tmax,
+    f32&                tnear
+)
+{
+    auto tx0 = ( value.Mini.x - origin.x ) * invDir.x;
+    auto tx1 = ( value.Maxi.x - origin.x ) * invDir.x;
+    auto ty0 = ( value.Mini.y - origin.y ) * invDir.y;
+    auto ty1 = ( value.Maxi.y - origin.y ) * invDir.y;
+    auto tz0 = ( value.Mini.z - origin.z ) * invDir.z;
+    auto tz1 = ( value.Maxi.z - origin.z ) * invDir.z;
+
+    tmin = Max( tmin, Max( Min( tx0, tx1 ), Max( Min( ty0, ty1 ), Min( tz0, tz1 ) ) ) );
+    tmax = Min( tmax, Min( Max( tx0, tx1 ), Min( Max( ty0, ty1 ), Max( tz0, tz1 ) ) ) );
+
+    tnear = tmin;
+    return tmin <= tmax;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイと三角形の交差判定を行います(Moller-Trumbore 法).
+//!
+//! @param [in]     ray         レイ.
+//! @param [in]     p0          三角形の頂点.
+//! @param [in]     p1          三角形の頂点.
+//! @param [in]     p2          三角形の頂点.
+//! @param [out]    t           交差位置までの距離.
+//! @param [out]    u           p1 の重心座標.
+//! @param [out]    v           p2 の重心座標.
+//! @retval true    [ray.TMin, ray.TMax] の範囲で交差します.
+//! @retval false   交差しません.
+//! @note       両面を判定します.
+//-------------------------------------------------------------------------------------------------
+inline bool IntersectRayTriangle
+(
+    const Ray&      ray,
+    const Vector3&  p0,
+    const Vector3&  p1,
+    const Vector3&  p2,
+    f32&            t,
+    f32&            u,
+    f32&            v
+)
+{
+    auto e1  = p1 - p0;
+    auto e2  = p2 - p0;
+    auto pv  = Vector3::Cross( ray.Direction, e2 );
+    auto det = Vector3::Dot( e1, pv );
+    if ( det == 0.0f )
+    { return false; }
+
+    auto inv = 1.0f / det;
+    auto tv  = ray.Origin - p0;
+    u = Vector3::Dot( tv, pv ) * inv;
+    if ( u < 0.0f || u > 1.0f )
+    { return false; }
+
+    auto qv = Vector3::Cross( tv, e1 );
+    v = Vector3::Dot( ray.Direction, qv ) * inv;
+    if ( v < 0.0f || u + v > 1.0f )
+    { return false; }
+
+    t = Vector3::Dot( e2, qv ) * inv;
+    return ( ray.TMin <= t ) && ( t <= ray.TMax );
+}
+
+} // namespace asdx
+
+#endif//__ASDX_BOUNDING_VOLUME_H__
@@ -0,0 +1,1208 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxBroadphase.h
+// Desc : Broadphase Collision Detection Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_BROADPHASE_H__
+#define __ASDX_BROADPHASE_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxBoundingVolume.h>
+#include <asdxSimd.h>
+#include <asdxParallel.h>
+#include <asdxAlignedAllocator.h>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+#include <cfloat>
+#include <limits>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BroadphasePair structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BroadphasePair
+{
+    u32     A;      //!< 小さい方の番号です.
+    u32     B;      //!< 大きい方の番号です.
+};
+
+
+namespace detail {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      チャンクごとに求めたペアを1つの配列に連結します.
+//!
+//! @note       チャンクの順に連結するので, 結果はスレッド数に依存しません.
+//-------------------------------------------------------------------------------------------------
+inline void GatherPairs
+(
+    const std::vector<std::vector<BroadphasePair>>& chunks,
+    u32                                             chunkCount,
+    std::vector<BroadphasePair>&                    pairs
+)
+{
+    size_t total = 0;
+    for( u32 c=0; c<chunkCount; ++c )
+    { total += chunks[c].size(); }
+
+    pairs.resize( total );
+
+    size_t offset = 0;
+    for( u32 c=0; c<chunkCount; ++c )
+    {
+        if ( chunks[c].empty() )
+        { continue; }
+
+        memcpy( pairs.data() + offset, chunks[c].data(), sizeof(BroadphasePair) * chunks[c].size() );
+        offset += chunks[c].size();
+    }
+}
+
+} // namespace detail
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DynamicAabbTree class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      動的に更新できる AABB ツリーです.
+//!
+//! @note       プロキシは余白と移動量の分だけ太らせたボックスで登録され, 太らせたボックスから
+//!             はみ出すまでは再挿入しません. 挿入は表面積のコストで兄弟を選び, 木の回転で
+//!             高さを平衡に保ちます. ペアは太らせたボックス同士の重なりで判定します.
+//-------------------------------------------------------------------------------------------------
+class DynamicAabbTree
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 NullProxy = 0xffffffff;    //!< 無効なプロキシ番号です.
+    static const u32 StackSize = 256;           //!< 走査時のスタックの大きさです.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param [in]     margin              ボックスを太らせる余白です.
+    //! @param [in]     displacementScale   移動方向に太らせる際に移動量に掛ける倍率です.
+    //---------------------------------------------------------------------------------------------
+    explicit DynamicAabbTree( f32 margin = 0.1f, f32 displacementScale = 2.0f )
+    : m_Root             ( NullProxy )
+    , m_FreeList         ( NullProxy )
+    , m_ProxyCount       ( 0 )
+    , m_Margin           ( margin )
+    , m_DisplacementScale( displacementScale )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全てのプロキシを破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Clear()
+    {
+        m_Nodes     .clear();
+        m_MoveBuffer.clear();
+        m_Root       = NullProxy;
+        m_FreeList   = NullProxy;
+        m_ProxyCount = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      プロキシを生成します.
+    //!
+    //! @param [in]     bounds      バウンディングボックスです.
+    //! @param [in]     userData    ユーザーデータです.
+    //! @return     プロキシ番号を返却します. 次の FindPairs() で移動したものとして扱われます.
+    //---------------------------------------------------------------------------------------------
+    u32 CreateProxy( const BoundingBox& bounds, u32 userData )
+    {
+        auto proxy = AllocNode();
+
+        auto& node = m_Nodes[proxy];
+        node.Bounds   = ComputeFatBounds( bounds, nullptr );
+        node.UserData = userData;
+        node.Height   = 0;
+
+        InsertLeaf( proxy );
+        MarkMoved( proxy );
+        m_ProxyCount++;
+
+        return proxy;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      プロキシを破棄します.
+    //---------------------------------------------------------------------------------------------
+    void DestroyProxy( u32 proxy )
+    {
+        assert( IsProxy( proxy ) );
+
+        if ( m_Nodes[proxy].Moved )
+        {
+            auto itr = std::find( m_MoveBuffer.begin(), m_MoveBuffer.end(), proxy );
+            assert( itr != m_MoveBuffer.end() );
+            *itr = m_MoveBuffer.back();
+            m_MoveBuffer.pop_back();
+        }
+
+        RemoveLeaf( proxy );
+        FreeNode( proxy );
+        m_ProxyCount--;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      プロキシを移動します.
+    //!
+    //! @param [in]     proxy           プロキシ番号です.
+    //! @param [in]     bounds          移動後のバウンディングボックスです.
+    //! @param [in]     displacement    次の更新までの予測移動量です.
+    //! @retval true    再挿入しました.
+    //! @retval false   太らせたボックスに収まっているので何もしませんでした.
+    //---------------------------------------------------------------------------------------------
+    bool MoveProxy( u32 proxy, const BoundingBox& bounds, const Vector3& displacement = Vector3( 0.0f, 0.0f, 0.0f ) )
+    {
+        assert( IsProxy( proxy ) );
+
+        auto fat = ComputeFatBounds( bounds, &displacement );
+        if ( !NeedsReinsert( m_Nodes[proxy].Bounds, bounds, fat ) )
+        { return false; }
+
+        Reinsert( proxy, fat );
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      複数のプロキシをまとめて移動します.
+    //!
+    //! @param [in]     pProxies        count 個のプロキシ番号です.
+    //! @param [in]     pBounds         count 個の移動後のバウンディングボックスです.
+    //! @param [in]     pDisplacements  count 個の予測移動量です. nullptr の場合はゼロとします.
+    //! @param [in]     count           プロキシ数です.
+    //! @param [in]     grain           1タスクあたりのプロキシ数です.
+    //! @note       再挿入が必要かどうかの判定を並列に行い, 木の更新は逐次行います.
+    //---------------------------------------------------------------------------------------------
+    void MoveProxies
+    (
+        const u32*          pProxies,
+        const BoundingBox*  pBounds,
+        const Vector3*      pDisplacements,
+        u32                 count,
+        u32                 grain = 4096
+    )
+    {
+        m_Reinsert.resize( count );
+
+        ParallelFor( count, grain, [&]( u32 begin, u32 end )
+        {
+            for( u32 i=begin; i<end; ++i )
+            {
+                auto fat = ComputeFatBounds( pBounds[i], ( pDisplacements != nullptr ) ? &pDisplacements[i] : nullptr );
+                m_Reinsert[i] = NeedsReinsert( m_Nodes[pProxies[i]].Bounds, pBounds[i], fat ) ? 1 : 0;
+            }
+        });
+
+        for( u32 i=0; i<count; ++i )
+        {
+            if ( m_Reinsert[i] == 0 )
+            { continue; }
+
+            auto fat = ComputeFatBounds( pBounds[i], ( pDisplacements != nullptr ) ? &pDisplacements[i] : nullptr );
+            Reinsert( pProxies[i], fat );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      移動したプロキシが関わる重なりのペアを求めます.
+    //!
+    //! @param [out]    pairs       ペアの格納先です. A < B のプロキシ番号で, 重複はありません.
+    //! @param [in]     grain       1タスクあたりの移動したプロキシ数です.
+    //! @note       移動したプロキシごとの探索を並列に行います. 呼び出し後は移動フラグを消去します.
+    //---------------------------------------------------------------------------------------------
+    void FindPairs( std::vector<BroadphasePair>& pairs, u32 grain = 256 )
+    {
+        pairs.clear();
+
+        auto moveCount = static_cast<u32>( m_MoveBuffer.size() );
+        if ( moveCount == 0 )
+        { return; }
+
+        if ( grain == 0 )
+        { grain = 1; }
+
+        // 移動したプロキシが多い場合は木の順に並べ替え, 連続する探索が同じノードを辿るようにする.
+        if ( moveCount > m_ProxyCount / 32 )
+        { SortMoveBuffer(); }
+
+        auto chunkCount = ( moveCount + grain - 1 ) / grain;
+        if ( m_ChunkPairs.size() < chunkCount )
+        { m_ChunkPairs.resize( chunkCount ); }
+
+        ParallelFor( chunkCount, 1, [&]( u32 chunkBegin, u32 chunkEnd )
+        {
+            for( u32 c=chunkBegin; c<chunkEnd; ++c )
+            {
+                auto& output = m_ChunkPairs[c];
+                output.clear();
+
+                auto end = Min( moveCount, ( c + 1 ) * grain );
+                for( u32 i=c * grain; i<end; ++i )
+                {
+                    auto proxy = m_MoveBuffer[i];
+                    Query( m_Nodes[proxy].Bounds, [&]( u32 other )
+                    {
+                        // 両方が移動した場合は番号の小さい方だけが報告する.
+                        if ( other == proxy || ( m_Nodes[other].Moved && other < proxy ) )
+                        { return; }
+
+                        BroadphasePair pair;
+                        pair.A = Min( proxy, other );
+                        pair.B = Max( proxy, other );
+                        output.push_back( pair );
+                    });
+                }
+            }
+        });
+
+        detail::GatherPairs( m_ChunkPairs, chunkCount, pairs );
+
+        for( size_t i=0; i<m_MoveBuffer.size(); ++i )
+        { m_Nodes[m_MoveBuffer[i]].Moved = 0; }
+        m_MoveBuffer.clear();
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボックスと重なるプロキシを列挙します.
+    //!
+    //! @param [in]     box         ボックスです.
+    //! @param [in]     func        void func( u32 proxy ) です.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    void Query( const BoundingBox& box, Func func ) const
+    {
+        if ( m_Root == NullProxy )
+        { return; }
+
+        u32 stack[StackSize];
+        u32 top = 0;
+        stack[top++] = m_Root;
+
+        while( top > 0 )
+        {
+            auto  index = stack[--top];
+            auto& node  = m_Nodes[index];
+            if ( !node.Bounds.Intersects( box ) )
+            { continue; }
+
+            if ( node.IsLeaf() )
+            {
+                func( index );
+                continue;
+            }
+
+            assert( top + 2 <= StackSize );
+            stack[top++] = node.Child[0];
+            stack[top++] = node.Child[1];
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      太らせたバウンディングボックスを取得します.
+    //---------------------------------------------------------------------------------------------
+    const BoundingBox& GetFatBounds( u32 proxy ) const
+    {
+        assert( IsProxy( proxy ) );
+        return m_Nodes[proxy].Bounds;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ユーザーデータを取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetUserData( u32 proxy ) const
+    {
+        assert( IsProxy( proxy ) );
+        return m_Nodes[proxy].UserData;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      プロキシ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetProxyCount() const
+    { return m_ProxyCount; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      次の FindPairs() で探索する移動したプロキシ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetMovedCount() const
+    { return static_cast<u32>( m_MoveBuffer.size() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      木の高さを取得します.
+    //---------------------------------------------------------------------------------------------
+    s32 GetHeight() const
+    { return ( m_Root != NullProxy ) ? m_Nodes[m_Root].Height : 0; }
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Node structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Node
+    {
+        BoundingBox Bounds;     //!< 太らせたバウンディングボックスです.
+        u32         Parent;     //!< 親の番号です. 未使用の場合は次の未使用ノードの番号です.
+        u32         Child[2];   //!< 子の番号です. 葉の場合は NullProxy です.
+        s32         Height;     //!< 葉からの高さです. 葉は 0, 未使用は -1 です.
+        u32         UserData;   //!< ユーザーデータです.
+        u32         Moved;      //!< 移動バッファに登録済みかどうかです.
+
+        bool IsLeaf() const
+        { return Child[0] == NullProxy; }
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    AlignedVector<Node>                         m_Nodes;                //!< ノードです. 葉の番号がプロキシ番号になります.
+    u32                                         m_Root;                 //!< ルートの番号です.
+    u32                                         m_FreeList;             //!< 未使用ノードのリストの先頭です.
+    u32                                         m_ProxyCount;           //!< プロキシ数です.
+    f32                                         m_Margin;               //!< ボックスを太らせる余白です.
+    f32                                         m_DisplacementScale;    //!< 移動量に掛ける倍率です.
+    std::vector<u32>                            m_MoveBuffer;           //!< 移動したプロキシです.
+    std::vector<u8>                             m_Reinsert;             //!< MoveProxies() の再挿入フラグです.
+    std::vector<std::vector<BroadphasePair>>    m_ChunkPairs;           //!< チャンクごとのペアです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      有効なプロキシかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsProxy( u32 proxy ) const
+    { return proxy < m_Nodes.size() && m_Nodes[proxy].Height == 0; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      表面積を求めます.
+    //---------------------------------------------------------------------------------------------
+    static f32 GetArea( const BoundingBox& value )
+    {
+        auto e = value.Maxi - value.Mini;
+        return 2.0f * ( e.x * e.y + e.y * e.z + e.z * e.x );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      2つのボックスを囲むボックスを求めます.
+    //---------------------------------------------------------------------------------------------
+    static BoundingBox Union( const BoundingBox& a, const BoundingBox& b )
+    { return BoundingBox( Vector3::Min( a.Mini, b.Mini ), Vector3::Max( a.Maxi, b.Maxi ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      a が b を包含するかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    static bool Contains( const BoundingBox& a, const BoundingBox& b )
+    {
+        return ( a.Mini.x <= b.Mini.x ) && ( a.Mini.y <= b.Mini.y ) && ( a.Mini.z <= b.Mini.z )
+            && ( b.Maxi.x <= a.Maxi.x ) && ( b.Maxi.y <= a.Maxi.y ) && ( b.Maxi.z <= a.Maxi.z );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      太らせたボックスを求めます.
+    //---------------------------------------------------------------------------------------------
+    BoundingBox ComputeFatBounds( const BoundingBox& bounds, const Vector3* pDisplacement ) const
+    {
+        Vector3 margin( m_Margin, m_Margin, m_Margin );
+        BoundingBox result( bounds.Mini - margin, bounds.Maxi + margin );
+
+        // 移動する方向にだけ伸ばす.
+        if ( pDisplacement != nullptr )
+        {
+            auto d = *pDisplacement * m_DisplacementScale;
+            result.Mini += Vector3::Min( d, Vector3( 0.0f, 0.0f, 0.0f ) );
+            result.Maxi += Vector3::Max( d, Vector3( 0.0f, 0.0f, 0.0f ) );
+        }
+
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      再挿入が必要かどうかチェックします.
+    //!
+    //! @param [in]     current     登録済みの太らせたボックスです.
+    //! @param [in]     bounds      移動後のボックスです.
+    //! @param [in]     fat         移動後のボックスを太らせたボックスです.
+    //! @note       はみ出した場合に加えて, 減速して登録済みのボックスが大きすぎる場合も再挿入します.
+    //---------------------------------------------------------------------------------------------
+    bool NeedsReinsert( const BoundingBox& current, const BoundingBox& bounds, const BoundingBox& fat ) const
+    {
+        if ( !Contains( current, bounds ) )
+        { return true; }
+
+        auto r = 4.0f * m_Margin;
+        BoundingBox huge( fat.Mini - Vector3( r, r, r ), fat.Maxi + Vector3( r, r, r ) );
+        return !Contains( huge, current );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      太らせたボックスを更新して再挿入します.
+    //---------------------------------------------------------------------------------------------
+    void Reinsert( u32 proxy, const BoundingBox& fat )
+    {
+        // 移動量は小さいので, 元の位置の祖先で新しいボックスを包含するものの下から探索する.
+        auto start = RemoveLeaf( proxy );
+        while( start != NullProxy && !Contains( m_Nodes[start].Bounds, fat ) )
+        { start = m_Nodes[start].Parent; }
+
+        m_Nodes[proxy].Bounds = fat;
+        InsertLeaf( proxy, start );
+        MarkMoved( proxy );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      移動バッファに登録します.
+    //---------------------------------------------------------------------------------------------
+    void MarkMoved( u32 proxy )
+    {
+        if ( m_Nodes[proxy].Moved )
+        { return; }
+
+        m_Nodes[proxy].Moved = 1;
+        m_MoveBuffer.push_back( proxy );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      移動バッファを木の深さ優先の順に並べ替えます.
+    //---------------------------------------------------------------------------------------------
+    void SortMoveBuffer()
+    {
+        auto moveCount = m_MoveBuffer.size();
+        m_MoveBuffer.clear();
+
+        u32 stack[StackSize];
+        u32 top = 0;
+        stack[top++] = m_Root;
+
+        while( top > 0 )
+        {
+            auto& node = m_Nodes[stack[--top]];
+            if ( node.IsLeaf() )
+            {
+                if ( node.Moved )
+                { m_MoveBuffer.push_back( stack[top] ); }
+                continue;
+            }
+
+            assert( top + 2 <= StackSize );
+            stack[top++] = node.Child[1];
+            stack[top++] = node.Child[0];
+        }
+
+        assert( m_MoveBuffer.size() == moveCount );
+        (void)moveCount;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードを確保します.
+    //---------------------------------------------------------------------------------------------
+    u32 AllocNode()
+    {
+        u32 index;
+        if ( m_FreeList != NullProxy )
+        {
+            index      = m_FreeList;
+            m_FreeList = m_Nodes[index].Parent;
+        }
+        else
+        {
+            index = static_cast<u32>( m_Nodes.size() );
+            m_Nodes.push_back( Node() );
+        }
+
+        auto& node = m_Nodes[index];
+        node.Parent   = NullProxy;
+        node.Child[0] = NullProxy;
+        node.Child[1] = NullProxy;
+        node.Height   = 0;
+        node.UserData = 0;
+        node.Moved    = 0;
+        return index;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードを解放します.
+    //---------------------------------------------------------------------------------------------
+    void FreeNode( u32 index )
+    {
+        auto& node = m_Nodes[index];
+        node.Parent = m_FreeList;
+        node.Height = -1;
+        node.Moved  = 0;
+        m_FreeList  = index;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      挿入した場合の表面積の増加が最小になる兄弟を探します.
+    //!
+    //! @param [in]     leaf        挿入するボックスです.
+    //! @param [in]     hint        先に探索する部分木の根です. leaf を包含している必要があります.
+    //! @note       兄弟にした場合のコストは新しい親の表面積と祖先の表面積の増加量の和です.
+    //!             先に hint の下を探索して良い上限を得ておくと, 木全体の探索の枝刈りが効きます.
+    //---------------------------------------------------------------------------------------------
+    u32 FindBestSibling( const BoundingBox& leaf, u32 hint ) const
+    {
+        auto best     = m_Root;
+        auto bestCost = GetArea( Union( m_Nodes[m_Root].Bounds, leaf ) );
+
+        // hint は leaf を包含するので, hint より上の祖先の増加量はゼロになる.
+        if ( hint != NullProxy && hint != m_Root )
+        { SearchSibling( leaf, hint, best, bestCost ); }
+
+        SearchSibling( leaf, m_Root, best, bestCost );
+        return best;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      部分木から兄弟の候補を分枝限定法で探索します.
+    //!
+    //! @note       祖先の増加量は降りるほど単調に増えるので, 下限が最良値を超える部分木は枝刈りします.
+    //---------------------------------------------------------------------------------------------
+    void SearchSibling( const BoundingBox& leaf, u32 root, u32& best, f32& bestCost ) const
+    {
+        struct Candidate
+        {
+            u32 Index;          //!< ノードの番号です.
+            f32 Inherited;      //!< 祖先の表面積の増加量です.
+        };
+
+        auto leafArea = GetArea( leaf );
+
+        Candidate stack[StackSize];
+        u32 top = 0;
+        stack[top].Index     = root;
+        stack[top].Inherited = 0.0f;
+        top++;
+
+        while( top > 0 )
+        {
+            auto  candidate = stack[--top];
+            auto& node      = m_Nodes[candidate.Index];
+
+            auto direct = GetArea( Union( node.Bounds, leaf ) );
+            auto cost   = direct + candidate.Inherited;
+            if ( cost < bestCost )
+            {
+                best     = candidate.Index;
+                bestCost = cost;
+            }
+
+            if ( node.IsLeaf() )
+            { continue; }
+
+            // 子を兄弟にした場合のコストの下限です.
+            auto inherited = candidate.Inherited + ( direct - GetArea( node.Bounds ) );
+            if ( leafArea + inherited >= bestCost )
+            { continue; }
+
+            assert( top + 2 <= StackSize );
+            stack[top].Index     = node.Child[0];
+            stack[top].Inherited = inherited;
+            top++;
+            stack[top].Index     = node.Child[1];
+            stack[top].Inherited = inherited;
+            top++;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      親をたどって高さとボックスを更新します.
+    //---------------------------------------------------------------------------------------------
+    void Refit( u32 index )
+    {
+        while( index != NullProxy )
+        {
+            index = Balance( index );
+
+            auto& node   = m_Nodes[index];
+            auto& child0 = m_Nodes[node.Child[0]];
+            auto& child1 = m_Nodes[node.Child[1]];
+            node.Height = 1 + Max( child0.Height, child1.Height );
+            node.Bounds = Union( child0.Bounds, child1.Bounds );
+
+            index = node.Parent;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      葉を挿入します.
+    //!
+    //! @param [in]     leaf        挿入する葉です.
+    //! @param [in]     hint        先に兄弟を探索する部分木の根です. leaf を包含している必要があります.
+    //!                             NullProxy の場合は木全体だけを探索します.
+    //---------------------------------------------------------------------------------------------
+    void InsertLeaf( u32 leaf, u32 hint = NullProxy )
+    {
+        if ( m_Root == NullProxy )
+        {
+            m_Root = leaf;
+            m_Nodes[leaf].Parent = NullProxy;
+            return;
+        }
+
+        auto leafBounds = m_Nodes[leaf].Bounds;
+        auto sibling    = FindBestSibling( leafBounds, hint );
+        auto oldParent  = m_Nodes[sibling].Parent;
+        auto newParent  = AllocNode();  // 配列が再確保される可能性があるので参照は後で取る.
+
+        auto& parent = m_Nodes[newParent];
+        parent.Parent   = oldParent;
+        parent.Bounds   = Union( leafBounds, m_Nodes[sibling].Bounds );
+        parent.Height   = m_Nodes[sibling].Height + 1;
+        parent.Child[0] = sibling;
+        parent.Child[1] = leaf;
+
+        if ( oldParent != NullProxy )
+        {
+            auto& node = m_Nodes[oldParent];
+            if ( node.Child[0] == sibling )
+            { node.Child[0] = newParent; }
+            else
+            { node.Child[1] = newParent; }
+        }
+        else
+        { m_Root = newParent; }
+
+        m_Nodes[sibling].Parent = newParent;
+        m_Nodes[leaf]   .Parent = newParent;
+
+        Refit( newParent );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      葉を取り外します.
+    //!
+    //! @return     取り外した葉の兄弟を返却します. 木が空になった場合は NullProxy を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 RemoveLeaf( u32 leaf )
+    {
+        if ( leaf == m_Root )
+        {
+            m_Root = NullProxy;
+            return NullProxy;
+        }
+
+        auto parent      = m_Nodes[leaf].Parent;
+        auto grandParent = m_Nodes[parent].Parent;
+        auto sibling     = ( m_Nodes[parent].Child[0] == leaf ) ? m_Nodes[parent].Child[1] : m_Nodes[parent].Child[0];
+
+        FreeNode( parent );
+
+        if ( grandParent == NullProxy )
+        {
+            m_Root = sibling;
+            m_Nodes[sibling].Parent = NullProxy;
+            return sibling;
+        }
+
+        auto& node = m_Nodes[grandParent];
+        if ( node.Child[0] == parent )
+        { node.Child[0] = sibling; }
+        else
+        { node.Child[1] = sibling; }
+        m_Nodes[sibling].Parent = grandParent;
+
+        Refit( grandParent );
+        return sibling;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      左右の高さの差が 1 を超える場合に回転します.
+    //!
+    //! @return     部分木の新しい根の番号を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 Balance( u32 indexA )
+    {
+        auto& a = m_Nodes[indexA];
+        if ( a.IsLeaf() || a.Height < 2 )
+        { return indexA; }
+
+        auto indexB = a.Child[0];
+        auto indexC = a.Child[1];
+        auto& b = m_Nodes[indexB];
+        auto& c = m_Nodes[indexC];
+
+        auto balance = c.Height - b.Height;
+        if ( balance > 1 )
+        {
+            // C を持ち上げる.
+            Rotate( indexA, indexC, 1 );
+            return indexC;
+        }
+
+        if ( balance < -1 )
+        {
+            // B を持ち上げる.
+            Rotate( indexA, indexB, 0 );
+            return indexB;
+        }
+
+        return indexA;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      子 indexUp を indexA の位置に持ち上げます.
+    //!
+    //! @param [in]     indexA      回転する部分木の根です.
+    //! @param [in]     indexUp     持ち上げる子です.
+    //! @param [in]     side        indexUp が indexA の何番目の子かです.
+    //---------------------------------------------------------------------------------------------
+    void Rotate( u32 indexA, u32 indexUp, u32 side )
+    {
+        auto& a  = m_Nodes[indexA];
+        auto& up = m_Nodes[indexUp];
+        auto& other = m_Nodes[a.Child[1 - side]];
+
+        auto indexF = up.Child[0];
+        auto indexG = up.Child[1];
+        auto& f = m_Nodes[indexF];
+        auto& g = m_Nodes[indexG];
+
+        // up を A の親の位置に付け替える.
+        up.Child[0] = indexA;
+        up.Parent   = a.Parent;
+        a.Parent    = indexUp;
+
+        if ( up.Parent != NullProxy )
+        {
+            auto& node = m_Nodes[up.Parent];
+            if ( node.Child[0] == indexA )
+            { node.Child[0] = indexUp; }
+            else
+            { node.Child[1] = indexUp; }
+        }
+        else
+        { m_Root = indexUp; }
+
+        // 高い方の孫を up に残し, 低い方を A に渡す.
+        auto keep  = ( f.Height > g.Height ) ? indexF : indexG;
+        auto give  = ( f.Height > g.Height ) ? indexG : indexF;
+
+        up.Child[1]   = keep;
+        a.Child[side] = give;
+        m_Nodes[give].Parent = indexA;
+
+        a.Bounds  = Union( other.Bounds, m_Nodes[give].Bounds );
+        a.Height  = 1 + Max( other.Height, m_Nodes[give].Height );
+        up.Bounds = Union( a.Bounds, m_Nodes[keep].Bounds );
+        up.Height = 1 + Max( a.Height, m_Nodes[keep].Height );
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SweepAndPrune class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SIMD による Sweep and Prune です.
+//!
+//! @note       ボックスを分散が最大の軸で基数ソートし, 残りの2軸を格子に分けて格子ごとに掃引します.
+//!             各ボックスの後ろに続く区間は FloatNWidth 個ずつまとめて判定します.
+//!             複数の格子にまたがるペアは重なり領域の最小の角を含む格子だけが報告します.
+//-------------------------------------------------------------------------------------------------
+class SweepAndPrune
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 CellTarget  = 512;     //!< 格子あたりの目標のボックス数です.
+    static const u32 MaxGridSize = 32;      //!< 格子の1辺の最大の分割数です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    SweepAndPrune()
+    : m_Axis    ( 0 )
+    , m_GridSize( 1 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      重なるボックスのペアを求めます.
+    //!
+    //! @param [in]     pBounds     バウンディングボックスの配列です.
+    //! @param [in]     count       ボックスの数です.
+    //! @param [out]    pairs       ペアの格納先です. A < B の配列番号で, 重複はありません.
+    //! @note       境界が接する場合も重なりとみなします. BoundingBox::Intersects() と同じです.
+    //!             格子ごとの掃引を並列に行います.
+    //---------------------------------------------------------------------------------------------
+    void FindPairs( const BoundingBox* pBounds, u32 count, std::vector<BroadphasePair>& pairs )
+    {
+        pairs.clear();
+        if ( count < 2 )
+        { return; }
+
+        m_Axis = SelectAxis( pBounds, count );
+        Sort( pBounds, count );
+        SetupGrid( pBounds, count );
+        Scatter( pBounds, count );
+
+        auto cellCount = m_GridSize * m_GridSize;
+        if ( m_ChunkPairs.size() < cellCount )
+        { m_ChunkPairs.resize( cellCount ); }
+
+        ParallelFor( cellCount, 1, [&]( u32 cellBegin, u32 cellEnd )
+        {
+            for( u32 c=cellBegin; c<cellEnd; ++c )
+            {
+                auto& output = m_ChunkPairs[c];
+                output.clear();
+                Sweep( c, output );
+            }
+        });
+
+        detail::GatherPairs( m_ChunkPairs, cellCount, pairs );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前の FindPairs() で使用したソート軸を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetSweepAxis() const
+    { return m_Axis; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前の FindPairs() で使用した格子の1辺の分割数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetGridSize() const
+    { return m_GridSize; }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    u32                                         m_Axis;             //!< ソート軸です.
+    u32                                         m_GridSize;         //!< 格子の1辺の分割数です.
+    f32                                         m_Origin [2];       //!< 格子の原点です.
+    f32                                         m_InvCell[2];       //!< 格子の幅の逆数です.
+    std::vector<u32>                            m_Keys [2];         //!< ソートキーです.
+    std::vector<u32>                            m_Order[2];         //!< ソート順の元の番号です.
+    std::vector<u32>                            m_CellOffsets;      //!< 格子ごとの先頭位置です.
+    std::vector<u32>                            m_CellCounts;       //!< 格子ごとのボックス数です.
+    std::vector<u32>                            m_Index;            //!< 格子順の元の番号です.
+    AlignedVector<f32>                          m_Mini[3];          //!< 格子順の最小値です. [0] がソート軸です.
+    AlignedVector<f32>                          m_Maxi[3];          //!< 格子順の最大値です. [0] がソート軸です.
+    std::vector<std::vector<BroadphasePair>>    m_ChunkPairs;       //!< 格子ごとのペアです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      中心の分散が最大の軸を選びます.
+    //---------------------------------------------------------------------------------------------
+    static u32 SelectAxis( const BoundingBox* pBounds, u32 count )
+    {
+        f64 sum[3]   = { 0.0, 0.0, 0.0 };
+        f64 sumSq[3] = { 0.0, 0.0, 0.0 };
+        for( u32 i=0; i<count; ++i )
+        {
+            auto center = pBounds[i].Mini + pBounds[i].Maxi;
+            for( u32 a=0; a<3; ++a )
+            {
+                f64 v = ( &center.x )[a];
+                sum  [a] += v;
+                sumSq[a] += v * v;
+            }
+        }
+
+        u32 axis = 0;
+        f64 best = -1.0;
+        for( u32 a=0; a<3; ++a )
+        {
+            auto variance = sumSq[a] - sum[a] * sum[a] / f64( count );
+            if ( variance > best )
+            {
+                best = variance;
+                axis = a;
+            }
+        }
+        return axis;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      浮動小数を大小関係を保った整数に変換します.
+    //---------------------------------------------------------------------------------------------
+    static u32 ToSortKey( f32 value )
+    {
+        u32 bits;
+        memcpy( &bits, &value, sizeof(bits) );
+        return ( bits & 0x80000000 ) ? ~bits : ( bits | 0x80000000 );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ソート軸の最小値で基数ソートします.
+    //---------------------------------------------------------------------------------------------
+    void Sort( const BoundingBox* pBounds, u32 count )
+    {
+        for( u32 i=0; i<2; ++i )
+        {
+            m_Keys [i].resize( count );
+            m_Order[i].resize( count );
+        }
+
+        for( u32 i=0; i<count; ++i )
+        {
+            m_Keys [0][i] = ToSortKey( ( &pBounds[i].Mini.x )[m_Axis] );
+            m_Order[0][i] = i;
+        }
+
+        // 8 ビットずつ 4 回の安定な計数ソートを行う.
+        for( u32 pass=0; pass<4; ++pass )
+        {
+            auto  shift    = pass * 8;
+            auto& srcKeys  = m_Keys [pass & 1];
+            auto& srcOrder = m_Order[pass & 1];
+            auto& dstKeys  = m_Keys [( pass + 1 ) & 1];
+            auto& dstOrder = m_Order[( pass + 1 ) & 1];
+
+            u32 offsets[256] = {};
+            for( u32 i=0; i<count; ++i )
+            { offsets[( srcKeys[i] >> shift ) & 0xff]++; }
+
+            u32 sum = 0;
+            for( u32 i=0; i<256; ++i )
+            {
+                auto n = offsets[i];
+                offsets[i] = sum;
+                sum += n;
+            }
+
+            for( u32 i=0; i<count; ++i )
+            {
+                auto dst = offsets[( srcKeys[i] >> shift ) & 0xff]++;
+                dstKeys [dst] = srcKeys [i];
+                dstOrder[dst] = srcOrder[i];
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ソート軸以外の2軸の格子を決めます.
+    //!
+    //! @note       格子あたり CellTarget 個程度になるように分割します. ただし格子の幅がボックスの
+    //!             平均の大きさの 4 倍を下回ると重複が増えるので, それ以上は分割しません.
+    //---------------------------------------------------------------------------------------------
+    void SetupGrid( const BoundingBox* pBounds, u32 count )
+    {
+        f32 mini[2] = {  FLT_MAX,  FLT_MAX };
+        f32 maxi[2] = { -FLT_MAX, -FLT_MAX };
+        f64 size[2] = { 0.0, 0.0 };
+        for( u32 i=0; i<count; ++i )
+        {
+            for( u32 a=0; a<2; ++a )
+            {
+                auto axis = ( m_Axis + 1 + a ) % 3;
+                auto lo   = ( &pBounds[i].Mini.x )[axis];
+                auto hi   = ( &pBounds[i].Maxi.x )[axis];
+                mini[a] = Min( mini[a], lo );
+                maxi[a] = Max( maxi[a], hi );
+                size[a] += hi - lo;
+            }
+        }
+
+        auto grid = static_cast<f32>( sqrt( f64( count ) / f64( CellTarget ) ) );
+        for( u32 a=0; a<2; ++a )
+        {
+            auto extent  = maxi[a] - mini[a];
+            auto average = static_cast<f32>( size[a] / f64( count ) );
+            if ( !( extent < FLT_MAX ) )
+            { grid = 1.0f; }
+            else if ( average > 0.0f )
+            { grid = Min( grid, extent / ( 4.0f * average ) ); }
+        }
+
+        m_GridSize = static_cast<u32>( Clamp( grid, 1.0f, f32( MaxGridSize ) ) );
+        for( u32 a=0; a<2; ++a )
+        {
+            auto extent = maxi[a] - mini[a];
+            m_Origin [a] = mini[a];
+            m_InvCell[a] = ( m_GridSize > 1 && extent > 0.0f ) ? f32( m_GridSize ) / extent : 0.0f;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      座標を格子の番号に変換します.
+    //---------------------------------------------------------------------------------------------
+    u32 ToCell( f32 value, u32 index ) const
+    {
+        auto t = ( value - m_Origin[index] ) * m_InvCell[index];
+        return static_cast<u32>( Clamp( t, 0.0f, f32( m_GridSize - 1 ) ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ソート順を保ったまま格子ごとの SoA へ振り分けます.
+    //!
+    //! @note       格子ごとに末尾の FloatNWidth 個を NaN で埋め, 比較が常に偽になるようにします.
+    //---------------------------------------------------------------------------------------------
+    void Scatter( const BoundingBox* pBounds, u32 count )
+    {
+        const u32 axes[3] = { m_Axis, ( m_Axis + 1 ) % 3, ( m_Axis + 2 ) % 3 };
+        const auto nan    = std::numeric_limits<f32>::quiet_NaN();
+        const auto padding = simd::FloatNWidth;
+
+        auto cellCount = m_GridSize * m_GridSize;
+        m_CellCounts .assign( cellCount, 0 );
+        m_CellOffsets.resize( cellCount + 1 );
+
+        auto& order = m_Order[0];
+        for( u32 i=0; i<count; ++i )
+        {
+            auto& box = pBounds[order[i]];
+            auto x0 = ToCell( ( &box.Mini.x )[axes[1]], 0 );
+            auto x1 = ToCell( ( &box.Maxi.x )[axes[1]], 0 );
+            auto y0 = ToCell( ( &box.Mini.x )[axes[2]], 1 );
+            auto y1 = ToCell( ( &box.Maxi.x )[axes[2]], 1 );
+            for( auto y=y0; y<=y1; ++y )
+            {
+                for( auto x=x0; x<=x1; ++x )
+                { m_CellCounts[y * m_GridSize + x]++; }
+            }
+        }
+
+        u32 total = 0;
+        for( u32 c=0; c<cellCount; ++c )
+        {
+            m_CellOffsets[c] = total;
+            total += m_CellCounts[c] + padding;
+        }
+        m_CellOffsets[cellCount] = total;
+
+        m_Index.resize( total );
+        for( u32 a=0; a<3; ++a )
+        {
+            m_Mini[a].assign( total, nan );
+            m_Maxi[a].assign( total, nan );
+        }
+
+        // ソート順に追加するので格子ごとの並びもソート済みになる.
+        for( u32 c=0; c<cellCount; ++c )
+        { m_CellCounts[c] = m_CellOffsets[c]; }
+
+        for( u32 i=0; i<count; ++i )
+        {
+            auto& box = pBounds[order[i]];
+            auto x0 = ToCell( ( &box.Mini.x )[axes[1]], 0 );
+            auto x1 = ToCell( ( &box.Maxi.x )[axes[1]], 0 );
+            auto y0 = ToCell( ( &box.Mini.x )[axes[2]], 1 );
+            auto y1 = ToCell( ( &box.Maxi.x )[axes[2]], 1 );
+            for( auto y=y0; y<=y1; ++y )
+            {
+                for( auto x=x0; x<=x1; ++x )
+                {
+                    auto dst = m_CellCounts[y * m_GridSize + x]++;
+                    m_Index[dst] = order[i];
+                    for( u32 a=0; a<3; ++a )
+                    {
+                        m_Mini[a][dst] = ( &box.Mini.x )[axes[a]];
+                        m_Maxi[a][dst] = ( &box.Maxi.x )[axes[a]];
+                    }
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      格子内のボックスと後続のボックスの重なりを求めます.
+    //---------------------------------------------------------------------------------------------
+    void Sweep( u32 cell, std::vector<BroadphasePair>& output ) const
+    {
+        using namespace simd;
+
+        const u32 fullMask = ( 1u << FloatNWidth ) - 1;
+
+        auto begin = m_CellOffsets[cell];
+        auto end   = m_CellOffsets[cell + 1] - FloatNWidth;
+        auto cellX = cell % m_GridSize;
+        auto cellY = cell / m_GridSize;
+
+        auto pMin0 = m_Mini[0].data();
+        auto pMin1 = m_Mini[1].data();
+        auto pMax1 = m_Maxi[1].data();
+        auto pMin2 = m_Mini[2].data();
+        auto pMax2 = m_Maxi[2].data();
+
+        for( u32 i=begin; i<end; ++i )
+        {
+            auto max0 = SetN( m_Maxi[0][i] );
+            auto min1 = SetN( pMin1[i] );
+            auto max1 = SetN( pMax1[i] );
+            auto min2 = SetN( pMin2[i] );
+            auto max2 = SetN( pMax2[i] );
+
+            for( u32 j=i + 1; j<end; j+=FloatNWidth )
+            {
+                // ソート済みなので, ソート軸で外れた要素以降は全て外れる.
+                auto sweep = LessEqualMaskN( LoadUN( pMin0 + j ), max0 );
+                if ( sweep == 0 )
+                { break; }
+
+                auto mask = sweep
+                    & LessEqualMaskN( LoadUN( pMin1 + j ), max1 ) & LessEqualMaskN( min1, LoadUN( pMax1 + j ) )
+                    & LessEqualMaskN( LoadUN( pMin2 + j ), max2 ) & LessEqualMaskN( min2, LoadUN( pMax2 + j ) );
+
+                for( u32 k=0; mask != 0; ++k, mask >>= 1 )
+                {
+                    if ( ( mask & 1 ) == 0 )
+                    { continue; }
+
+                    // 重なり領域の最小の角を含む格子だけが報告する.
+                    if ( m_GridSize > 1 )
+                    {
+                        auto x = ToCell( Max( pMin1[i], pMin1[j + k] ), 0 );
+                        auto y = ToCell( Max( pMin2[i], pMin2[j + k] ), 1 );
+                        if ( x != cellX || y != cellY )
+                        { continue; }
+                    }
+
+                    auto a = m_Index[i];
+                    auto b = m_Index[j + k];
+
+                    BroadphasePair pair;
+                    pair.A = Min( a, b );
+                    pair.B = Max( a, b );
+                    output.push_back( pair );
+                }
+
+                if ( sweep != fullMask )
+                { break; }
+            }
+        }
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_BROADPHASE_H__
@@ -0,0 +1,1001 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxBvh.h
+// Desc : Bounding Volume Hierarchy Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_BVH_H__
+#define __ASDX_BVH_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxBoundingVolume.h>
+#include <asdxCulling.h>
+#include <asdxParallel.h>
+#include <asdxAlignedAllocator.h>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BvhNode structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BvhNode
+{
+    f32     Mini[3];    //!< 最小値です.
+    u32     Offset;     //!< 葉の場合は最初のプリミティブ番号の位置, 節の場合は左の子の番号です(右の子は +1).
+    f32     Maxi[3];    //!< 最大値です.
+    u32     Count;      //!< 葉の場合はプリミティブ数, 節の場合は 0 です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      葉かどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsLeaf() const
+    { return Count > 0; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      バウンディングボックスを取得します.
+    //---------------------------------------------------------------------------------------------
+    BoundingBox GetBounds() const
+    { return BoundingBox( Vector3( Mini[0], Mini[1], Mini[2] ), Vector3( Maxi[0], Maxi[1], Maxi[2] ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      バウンディングボックスを設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetBounds( const BoundingBox& value )
+    {
+        Mini[0] = value.Mini.x; Mini[1] = value.Mini.y; Mini[2] = value.Mini.z;
+        Maxi[0] = value.Maxi.x; Maxi[1] = value.Maxi.y; Maxi[2] = value.Maxi.z;
+    }
+};
+static_assert( sizeof(BvhNode) == 32, "BvhNode must be 32 bytes." );
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Bvh class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Bvh
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 BinCount    = 16;  //!< SAH 評価時のビン数です.
+    static const u32 StackSize   = 64;  //!< 走査時のスタックの大きさです.
+    static const u32 MaxSahDepth = 32;  //!< SAH で分割する最大の深さです. 以降は中央で分割します.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Bvh()
+    : m_Depth( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      階層を構築します.
+    //!
+    //! @param [in]     pBounds         プリミティブのバウンディングボックスの配列.
+    //! @param [in]     count           プリミティブ数.
+    //! @param [in]     maxLeafSize     葉に含める最大のプリミティブ数.
+    //! @note       ビン分割の SAH で分割します. 上位の階層はビンの集計を並列に行い,
+    //!             十分に小さくなった部分木はそれぞれ別のタスクで構築します.
+    //---------------------------------------------------------------------------------------------
+    void Build( const BoundingBox* pBounds, u32 count, u32 maxLeafSize = 4 )
+    {
+        Clear();
+        if ( count == 0 )
+        { return; }
+
+        if ( maxLeafSize == 0 )
+        { maxLeafSize = 1; }
+
+        BuildContext ctx;
+        ctx.MaxLeafSize = maxLeafSize;
+        ctx.Refs.resize( count );
+
+        BuildTask root;
+        root.Node  = 0;
+        root.Depth = 0;
+        root.Begin = 0;
+        root.End   = count;
+        root.Bounds  .Reset();
+        root.Centroid.Reset();
+
+        // 参照を連続した配列に詰めてルートの範囲を並列に求める.
+        {
+            const u32 grain = 4096;
+            auto chunkCount = ( count + grain - 1 ) / grain;
+            // 各スレッドの書き込み先が同じキャッシュラインに乗らないようにする.
+            AlignedVector<CacheAligned<BuildTask>> partial( chunkCount );
+            ParallelFor( chunkCount, 1, [&]( u32 chunkBegin, u32 chunkEnd )
+            {
+                for( u32 c=chunkBegin; c<chunkEnd; ++c )
+                {
+                    auto& part = partial[c].Value;
+                    part.Bounds  .Reset();
+                    part.Centroid.Reset();
+
+                    auto end = Min( count, ( c + 1 ) * grain );
+                    for( u32 i=c * grain; i<end; ++i )
+                    {
+                        auto& ref = ctx.Refs[i];
+                        ref.Mini[0] = pBounds[i].Mini.x;
+                        ref.Mini[1] = pBounds[i].Mini.y;
+                        ref.Mini[2] = pBounds[i].Mini.z;
+                        ref.Maxi[0] = pBounds[i].Maxi.x;
+                        ref.Maxi[1] = pBounds[i].Maxi.y;
+                        ref.Maxi[2] = pBounds[i].Maxi.z;
+                        ref.Index   = i;
+                        ref.Padding = 0;
+
+                        f32 center[3];
+                        ref.GetCenter( center );
+                        part.Bounds  .Merge( ref.Mini, ref.Maxi );
+                        part.Centroid.Merge( center, center );
+                    }
+                }
+            });
+
+            for( size_t c=0; c<partial.size(); ++c )
+            {
+                root.Bounds  .Merge( partial[c].Value.Bounds );
+                root.Centroid.Merge( partial[c].Value.Centroid );
+            }
+        }
+
+        m_Nodes.reserve( 2 * ( count / maxLeafSize ) + 1 );
+        m_Nodes.resize( 1 );
+
+        // 上位の階層を分割して部分木のタスクを集める.
+        auto threshold = Max( 1024u, count / 64 );
+        std::vector<BuildTask> pending;
+        std::vector<BuildTask> stack;
+        stack.push_back( root );
+        while( !stack.empty() )
+        {
+            auto task = stack.back();
+            stack.pop_back();
+
+            if ( task.End - task.Begin <= threshold )
+            {
+                pending.push_back( task );
+                continue;
+            }
+
+            BuildTask left, right;
+            if ( !Split( ctx, task, true, left, right ) )
+            {
+                MakeLeaf( m_Nodes[task.Node], task );
+                continue;
+            }
+
+            auto child = static_cast<u32>( m_Nodes.size() );
+            m_Nodes.resize( child + 2 );
+            SetInterior( m_Nodes[task.Node], task.Bounds, child );
+
+            left.Node  = child;
+            right.Node = child + 1;
+            stack.push_back( right );
+            stack.push_back( left );
+        }
+
+        // 部分木を並列に構築して連結する.
+        std::vector<AlignedVector<BvhNode>> subtrees( pending.size() );
+        ParallelFor( static_cast<u32>( pending.size() ), 1, [&]( u32 begin, u32 end )
+        {
+            for( u32 i=begin; i<end; ++i )
+            { BuildSubtree( ctx, pending[i], subtrees[i] ); }
+        });
+
+        for( size_t i=0; i<pending.size(); ++i )
+        {
+            auto& local = subtrees[i];
+            auto  base  = static_cast<u32>( m_Nodes.size() ) - 1;
+            for( size_t j=0; j<local.size(); ++j )
+            {
+                if ( !local[j].IsLeaf() )
+                { local[j].Offset += base; }
+            }
+
+            m_Nodes[pending[i].Node] = local[0];
+            m_Nodes.insert( m_Nodes.end(), local.begin() + 1, local.end() );
+        }
+
+        m_Indices.resize( count );
+        for( u32 i=0; i<count; ++i )
+        { m_Indices[i] = ctx.Refs[i].Index; }
+
+        // 子は必ず親より後ろにあるので, 前から辿れば深さが求まる.
+        std::vector<u32> depth( m_Nodes.size(), 0 );
+        for( size_t i=0; i<m_Nodes.size(); ++i )
+        {
+            m_Depth = Max( m_Depth, depth[i] );
+            if ( m_Nodes[i].IsLeaf() )
+            { continue; }
+
+            depth[m_Nodes[i].Offset + 0] = depth[i] + 1;
+            depth[m_Nodes[i].Offset + 1] = depth[i] + 1;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      階層を保ったままバウンディングボックスを更新します.
+    //!
+    //! @param [in]     pBounds     Build() と同じ並びの新しいバウンディングボックス.
+    //! @note       葉を並列に更新した後, 節を子から順に更新します. 変形が大きいと走査効率は落ちます.
+    //---------------------------------------------------------------------------------------------
+    void Refit( const BoundingBox* pBounds )
+    {
+        if ( m_Nodes.empty() )
+        { return; }
+
+        auto nodeCount = static_cast<u32>( m_Nodes.size() );
+        ParallelFor( nodeCount, 1024, [&]( u32 begin, u32 end )
+        {
+            for( u32 i=begin; i<end; ++i )
+            {
+                auto& node = m_Nodes[i];
+                if ( !node.IsLeaf() )
+                { continue; }
+
+                BoundingBox box;
+                for( u32 j=0; j<node.Count; ++j )
+                { box.Merge( pBounds[m_Indices[node.Offset + j]] ); }
+                node.SetBounds( box );
+            }
+        });
+
+        // 子は必ず親より後ろにあるので, 後ろから更新すればよい.
+        for( u32 i=nodeCount; i-- > 0; )
+        {
+            auto& node = m_Nodes[i];
+            if ( node.IsLeaf() )
+            { continue; }
+
+            const auto& l = m_Nodes[node.Offset + 0];
+            const auto& r = m_Nodes[node.Offset + 1];
+            for( u32 k=0; k<3; ++k )
+            {
+                node.Mini[k] = Min( l.Mini[k], r.Mini[k] );
+                node.Maxi[k] = Max( l.Maxi[k], r.Maxi[k] );
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Clear()
+    {
+        m_Nodes  .clear();
+        m_Indices.clear();
+        m_Depth = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードを取得します. 0番目がルートです.
+    //---------------------------------------------------------------------------------------------
+    const BvhNode* GetNodes() const
+    { return m_Nodes.empty() ? nullptr : &m_Nodes[0]; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノード数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetNodeCount() const
+    { return static_cast<u32>( m_Nodes.size() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      最も深い節の深さを取得します. ルートの深さは 0 です.
+    //---------------------------------------------------------------------------------------------
+    u32 GetDepth() const
+    { return m_Depth; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      葉から参照されるプリミティブ番号の配列を取得します.
+    //---------------------------------------------------------------------------------------------
+    const u32* GetIndices() const
+    { return m_Indices.empty() ? nullptr : &m_Indices[0]; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全体のバウンディングボックスを取得します.
+    //---------------------------------------------------------------------------------------------
+    BoundingBox GetBounds() const
+    { return m_Nodes.empty() ? BoundingBox() : m_Nodes[0].GetBounds(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイと最も近いプリミティブを探します.
+    //!
+    //! @param [in,out] ray         レイ. 交差した場合 TMax が更新されます.
+    //! @param [in]     func        bool func( u32 index, Ray& ray ) です. 交差した場合は ray.TMax を
+    //!                             交差位置に更新して true を返却します.
+    //! @retval true    交差しました.
+    //! @retval false   交差しませんでした.
+    //! @note       近い子から順に走査し, ray.TMax より遠いノードは訪問しません.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    bool Intersect( Ray& ray, Func func ) const
+    { return TraverseRay<false>( ray, func ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイがいずれかのプリミティブと交差するかチェックします.
+    //!
+    //! @note       func は Intersect() と同じです. 最初に交差した時点で終了します.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    bool IntersectAny( const Ray& ray, Func func ) const
+    {
+        auto temp = ray;
+        return TraverseRay<true>( temp, func );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      視錐台と重なる可能性がある葉のプリミティブを列挙します.
+    //!
+    //! @param [in]     frustum     視錐台.
+    //! @param [in]     func        void func( u32 index ) です.
+    //! @note       ノードの判定は Frustum::Intersects() と同じです. プリミティブ単位の判定は行いません.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    void Query( const Frustum& frustum, Func func ) const
+    {
+        detail::CullingPlanes planes( frustum );
+        TraverseBox( [&]( const BvhNode& node )
+        { return detail::BoxCuller::IsVisible( planes, node.GetBounds() ); }, func );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボックスと重なる葉のプリミティブを列挙します.
+    //!
+    //! @param [in]     box         ボックス.
+    //! @param [in]     func        void func( u32 index ) です.
+    //---------------------------------------------------------------------------------------------
+    template<typename Func>
+    void Query( const BoundingBox& box, Func func ) const
+    {
+        TraverseBox( [&]( const BvhNode& node )
+        {
+            return ( node.Mini[0] <= box.Maxi.x ) && ( box.Mini.x <= node.Maxi[0] )
+                && ( node.Mini[1] <= box.Maxi.y ) && ( box.Mini.y <= node.Maxi[1] )
+                && ( node.Mini[2] <= box.Maxi.z ) && ( box.Mini.z <= node.Maxi[2] );
+        }, func );
+    }
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Box structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Box
+    {
+        f32 Mini[4];    //!< 最小値です. 4番目の要素は SIMD 用の余白です.
+        f32 Maxi[4];    //!< 最大値です. 4番目の要素は SIMD 用の余白です.
+
+        void Reset()
+        {
+            Mini[0] = Mini[1] = Mini[2] = Mini[3] =  FLT_MAX;
+            Maxi[0] = Maxi[1] = Maxi[2] = Maxi[3] = -FLT_MAX;
+        }
+
+        void Merge( const f32 mini[3], const f32 maxi[3] )
+        {
+            for( u32 a=0; a<3; ++a )
+            {
+                Mini[a] = Min( Mini[a], mini[a] );
+                Maxi[a] = Max( Maxi[a], maxi[a] );
+            }
+        }
+
+        void Merge( const Box& value )
+        { Merge( value.Mini, value.Maxi ); }
+
+        //! 表面積の半分を求めます.
+        f32 HalfArea() const
+        {
+            auto dx = Maxi[0] - Mini[0];
+            auto dy = Maxi[1] - Mini[1];
+            auto dz = Maxi[2] - Mini[2];
+            return dx * dy + dy * dz + dz * dx;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // BuildRef structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct BuildRef
+    {
+        f32 Mini[3];    //!< 最小値です.
+        u32 Index;      //!< プリミティブ番号です.
+        f32 Maxi[3];    //!< 最大値です.
+        u32 Padding;    //!< 32 byte に揃えるための余白です.
+
+        void GetCenter( f32 center[3] ) const
+        {
+            for( u32 a=0; a<3; ++a )
+            { center[a] = ( Mini[a] + Maxi[a] ) * 0.5f; }
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // BuildTask structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct BuildTask
+    {
+        u32     Node;       //!< 書き込み先のノード番号です.
+        u32     Depth;      //!< 深さです.
+        u32     Begin;      //!< 参照の開始位置です.
+        u32     End;        //!< 参照の終了位置です.
+        Box     Bounds;     //!< プリミティブの範囲です.
+        Box     Centroid;   //!< プリミティブの中心の範囲です.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // BuildContext structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct BuildContext
+    {
+        AlignedVector<BuildRef> Refs;           //!< 分割に合わせて並べ替える参照です.
+        u32                     MaxLeafSize;    //!< 葉の最大プリミティブ数です.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Bin structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Bin
+    {
+        Box     Bounds;     //!< プリミティブの範囲です.
+        u32     Count;      //!< プリミティブ数です.
+
+        void Reset()
+        {
+            Bounds.Reset();
+            Count = 0;
+        }
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    AlignedVector<BvhNode>  m_Nodes;        //!< ノードです.
+    std::vector<u32>        m_Indices;      //!< 葉から参照するプリミティブ番号です.
+    u32                     m_Depth;        //!< 最も深い節の深さです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードのバウンディングボックスを設定します.
+    //---------------------------------------------------------------------------------------------
+    static void SetNodeBounds( BvhNode& node, const Box& value )
+    {
+        for( u32 a=0; a<3; ++a )
+        {
+            node.Mini[a] = value.Mini[a];
+            node.Maxi[a] = value.Maxi[a];
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      葉を設定します.
+    //---------------------------------------------------------------------------------------------
+    static void MakeLeaf( BvhNode& node, const BuildTask& task )
+    {
+        SetNodeBounds( node, task.Bounds );
+        node.Offset = task.Begin;
+        node.Count  = task.End - task.Begin;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      節を設定します.
+    //---------------------------------------------------------------------------------------------
+    static void SetInterior( BvhNode& node, const Box& bounds, u32 child )
+    {
+        SetNodeBounds( node, bounds );
+        node.Offset = child;
+        node.Count  = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      中心の座標からビン番号を求めます.
+    //!
+    //! @note       振り分けと並べ替えで同じ番号になるように, 両方ともこの計算を使います.
+    //---------------------------------------------------------------------------------------------
+    static u32 GetBinIndex( f32 center, f32 offset, f32 scale )
+    {
+        // 整数に変換する前に浮動小数で範囲に収める. NaN や負の値は比較が偽になるのでビン0に入れる.
+        auto pos = ( center - offset ) * scale;
+        return ( pos > 0.0f ) ? static_cast<u32>( Min( pos, f32( BinCount - 1 ) ) ) : 0u;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      プリミティブをビンに振り分けます.
+    //---------------------------------------------------------------------------------------------
+    static void Binning
+    (
+        const BuildRef* pRefs,
+        u32             begin,
+        u32             end,
+        const f32       offset[3],
+        const f32       scale[3],
+        Bin             bins[3][BinCount]
+    )
+    {
+        // 範囲が無い軸は全てビン0に入るだけなので分岐しない.
+    #if ASDX_SIMD_SSE2
+        auto vOffset = _mm_setr_ps( offset[0], offset[1], offset[2], 0.0f );
+        auto vScale  = _mm_setr_ps( scale [0], scale [1], scale [2], 0.0f );
+        auto vHalf   = _mm_set1_ps( 0.5f );
+        auto vZero   = _mm_setzero_ps();
+        auto vLast   = _mm_set1_ps( f32( BinCount - 1 ) );
+        for( u32 i=begin; i<end; ++i )
+        {
+            // 4番目の要素は番号なので, 非正規化数にならないように z で埋める.
+            auto mini = _mm_loadu_ps( pRefs[i].Mini );
+            auto maxi = _mm_loadu_ps( pRefs[i].Maxi );
+            mini = _mm_shuffle_ps( mini, mini, _MM_SHUFFLE( 2, 2, 1, 0 ) );
+            maxi = _mm_shuffle_ps( maxi, maxi, _MM_SHUFFLE( 2, 2, 1, 0 ) );
+
+            auto center = _mm_mul_ps( _mm_add_ps( mini, maxi ), vHalf );
+            auto pos    = _mm_mul_ps( _mm_sub_ps( center, vOffset ), vScale );
+
+            // GetBinIndex() を3軸まとめて行う. _mm_max_ps は NaN の場合に第2引数を返すのでビン0になる.
+            pos = _mm_min_ps( _mm_max_ps( pos, vZero ), vLast );
+            auto index = _mm_cvttps_epi32( pos );
+
+            ASDX_ALIGN(16) s32 b[4];
+            _mm_store_si128( reinterpret_cast<__m128i*>( b ), index );
+            for( u32 a=0; a<3; ++a )
+            {
+                auto& bin = bins[a][b[a]];
+                _mm_storeu_ps( bin.Bounds.Mini, _mm_min_ps( _mm_loadu_ps( bin.Bounds.Mini ), mini ) );
+                _mm_storeu_ps( bin.Bounds.Maxi, _mm_max_ps( _mm_loadu_ps( bin.Bounds.Maxi ), maxi ) );
+                bin.Count++;
+            }
+        }
+    #else
+        for( u32 i=begin; i<end; ++i )
+        {
+            const auto& ref = pRefs[i];
+
+            f32 center[3];
+            ref.GetCenter( center );
+            for( u32 a=0; a<3; ++a )
+            {
+                auto& bin = bins[a][GetBinIndex( center[a], offset[a], scale[a] )];
+                bin.Bounds.Merge( ref.Mini, ref.Maxi );
+                bin.Count++;
+            }
+        }
+    #endif
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      SAH が最小となる位置で分割します.
+    //!
+    //! @retval true    分割しました.
+    //! @retval false   葉にするべきです.
+    //---------------------------------------------------------------------------------------------
+    static bool Split( BuildContext& ctx, const BuildTask& task, bool parallel, BuildTask& left, BuildTask& right )
+    {
+        auto count = task.End - task.Begin;
+        if ( count <= ctx.MaxLeafSize )
+        { return false; }
+
+        left.Depth  = task.Depth + 1;
+        right.Depth = task.Depth + 1;
+
+        const auto& offset = task.Centroid.Mini;
+        f32 scale[3];
+        for( u32 a=0; a<3; ++a )
+        {
+            auto extent = task.Centroid.Maxi[a] - task.Centroid.Mini[a];
+            scale[a] = ( extent > 0.0f ) ? BinCount * ( 1.0f - 1e-6f ) / extent : 0.0f;
+        }
+
+        // 中心が全て重なっている場合や深くなりすぎた場合は番号の中央で分ける.
+        // 以降は半分ずつになるので, 深さは MaxSahDepth + 32 を超えない.
+        if ( ( scale[0] <= 0.0f && scale[1] <= 0.0f && scale[2] <= 0.0f ) || task.Depth >= MaxSahDepth )
+        {
+            auto mid = task.Begin + count / 2;
+            SetChild( ctx, task.Begin, mid, left );
+            SetChild( ctx, mid, task.End, right );
+            return true;
+        }
+
+        auto pRefs = &ctx.Refs[0];
+
+        Bin bins[3][BinCount];
+        for( u32 a=0; a<3; ++a )
+        {
+            for( u32 b=0; b<BinCount; ++b )
+            { bins[a][b].Reset(); }
+        }
+
+        const u32 grain = 16384;
+        if ( parallel && count > grain )
+        {
+            auto chunkCount = ( count + grain - 1 ) / grain;
+            std::vector<Bin> partial( chunkCount * 3 * BinCount );
+            ParallelFor( chunkCount, 1, [&]( u32 chunkBegin, u32 chunkEnd )
+            {
+                for( u32 c=chunkBegin; c<chunkEnd; ++c )
+                {
+                    Bin* pFlat = &partial[c * 3 * BinCount];
+                    for( u32 b=0; b<3 * BinCount; ++b )
+                    { pFlat[b].Reset(); }
+
+                    auto pBins = reinterpret_cast<Bin(*)[BinCount]>( pFlat );
+
+                    auto begin = task.Begin + c * grain;
+                    auto end   = Min( task.End, begin + grain );
+                    Binning( pRefs, begin, end, offset, scale, pBins );
+                }
+            });
+
+            for( u32 c=0; c<chunkCount; ++c )
+            {
+                for( u32 a=0; a<3; ++a )
+                {
+                    for( u32 b=0; b<BinCount; ++b )
+                    {
+                        const auto& src = partial[( c * 3 + a ) * BinCount + b];
+                        bins[a][b].Bounds.Merge( src.Bounds );
+                        bins[a][b].Count += src.Count;
+                    }
+                }
+            }
+        }
+        else
+        {
+            Binning( pRefs, task.Begin, task.End, offset, scale, bins );
+        }
+
+        // 左右から累積して最小コストの分割位置を探す.
+        auto bestCost  = FLT_MAX;
+        auto bestAxis  = 0u;
+        auto bestSplit = 0u;
+        for( u32 a=0; a<3; ++a )
+        {
+            if ( scale[a] <= 0.0f )
+            { continue; }
+
+            f32 rightCost[BinCount];
+            Box box;
+            box.Reset();
+            u32 n = 0;
+            for( u32 b=BinCount - 1; b>0; --b )
+            {
+                box.Merge( bins[a][b].Bounds );
+                n += bins[a][b].Count;
+                rightCost[b] = ( n > 0 ) ? box.HalfArea() * n : 0.0f;
+            }
+
+            box.Reset();
+            n = 0;
+            for( u32 b=1; b<BinCount; ++b )
+            {
+                box.Merge( bins[a][b - 1].Bounds );
+                n += bins[a][b - 1].Count;
+                if ( n == 0 || n == count )
+                { continue; }
+
+                auto cost = box.HalfArea() * n + rightCost[b];
+                if ( cost < bestCost )
+                {
+                    bestCost  = cost;
+                    bestAxis  = a;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        if ( bestSplit == 0 )
+        { return false; }
+
+        // 分割位置で並べ替えながら子の中心の範囲を求める.
+        auto a = bestAxis;
+        auto o = offset[a];
+        auto s = scale[a];
+        left .Bounds  .Reset();
+        left .Centroid.Reset();
+        right.Bounds  .Reset();
+        right.Centroid.Reset();
+
+        auto i = task.Begin;
+        auto j = task.End;
+        while( i < j )
+        {
+            f32 center[3];
+            pRefs[i].GetCenter( center );
+            if ( GetBinIndex( center[a], o, s ) < bestSplit )
+            {
+                left.Centroid.Merge( center, center );
+                ++i;
+            }
+            else
+            {
+                right.Centroid.Merge( center, center );
+                std::swap( pRefs[i], pRefs[--j] );
+            }
+        }
+
+        left.Begin  = task.Begin;
+        left.End    = i;
+        right.Begin = i;
+        right.End   = task.End;
+        for( u32 b=0; b<BinCount; ++b )
+        {
+            auto& dst = ( b < bestSplit ) ? left : right;
+            dst.Bounds.Merge( bins[a][b].Bounds );
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      子の範囲を求めます.
+    //---------------------------------------------------------------------------------------------
+    static void SetChild( const BuildContext& ctx, u32 begin, u32 end, BuildTask& task )
+    {
+        task.Begin = begin;
+        task.End   = end;
+        task.Bounds  .Reset();
+        task.Centroid.Reset();
+        for( u32 i=begin; i<end; ++i )
+        {
+            const auto& ref = ctx.Refs[i];
+
+            f32 center[3];
+            ref.GetCenter( center );
+            task.Bounds  .Merge( ref.Mini, ref.Maxi );
+            task.Centroid.Merge( center, center );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      部分木を構築します.
+    //!
+    //! @note       nodes[0] が部分木のルートで, 子の番号は nodes 内の番号です.
+    //---------------------------------------------------------------------------------------------
+    static void BuildSubtree( BuildContext& ctx, const BuildTask& root, AlignedVector<BvhNode>& nodes )
+    {
+        nodes.reserve( 2 * ( ( root.End - root.Begin ) / ctx.MaxLeafSize ) + 1 );
+        nodes.resize( 1 );
+
+        std::vector<BuildTask> stack;
+        stack.push_back( root );
+        stack.back().Node = 0;
+        while( !stack.empty() )
+        {
+            auto task = stack.back();
+            stack.pop_back();
+
+            BuildTask left, right;
+            if ( !Split( ctx, task, false, left, right ) )
+            {
+                MakeLeaf( nodes[task.Node], task );
+                continue;
+            }
+
+            auto child = static_cast<u32>( nodes.size() );
+            nodes.resize( child + 2 );
+            SetInterior( nodes[task.Node], task.Bounds, child );
+
+            left.Node  = child;
+            right.Node = child + 1;
+            stack.push_back( right );
+            stack.push_back( left );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイとノードの交差判定を行います.
+    //---------------------------------------------------------------------------------------------
+    static bool IntersectNode( const BvhNode& node, const f32 origin[3], const f32 invDir[3], f32 tmin, f32 tmax, f32& tnear )
+    {
+        for( u32 a=0; a<3; ++a )
+        {
+            auto t0 = ( node.Mini[a] - origin[a] ) * invDir[a];
+            auto t1 = ( node.Maxi[a] - origin[a] ) * invDir[a];
+            tmin = Max( tmin, Min( t0, t1 ) );
+            tmax = Min( tmax, Max( t0, t1 ) );
+        }
+        tnear = tmin;
+        return tmin <= tmax;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイで走査します.
+    //---------------------------------------------------------------------------------------------
+    template<bool AnyHit, typename Func>
+    bool TraverseRay( Ray& ray, Func& func ) const
+    {
+        if ( m_Nodes.empty() )
+        { return false; }
+
+        const f32 origin[3] = { ray.Origin.x, ray.Origin.y, ray.Origin.z };
+        const f32 invDir[3] = { 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z };
+
+        f32 tnear;
+        if ( !IntersectNode( m_Nodes[0], origin, invDir, ray.TMin, ray.TMax, tnear ) )
+        { return false; }
+
+        u32 stack[StackSize];
+        f32 dist [StackSize];
+        u32 top = 0;
+        stack[top] = 0;
+        dist [top] = tnear;
+        top++;
+
+        auto hit = false;
+        while( top > 0 )
+        {
+            --top;
+            if ( dist[top] > ray.TMax )
+            { continue; }
+
+            const auto* pNode = &m_Nodes[stack[top]];
+            for(;;)
+            {
+                if ( pNode->IsLeaf() )
+                {
+                    for( u32 i=0; i<pNode->Count; ++i )
+                    {
+                        if ( func( m_Indices[pNode->Offset + i], ray ) )
+                        {
+                            hit = true;
+                            if ( AnyHit )
+                            { return true; }
+                        }
+                    }
+                    break;
+                }
+
+                const auto& l = m_Nodes[pNode->Offset + 0];
+                const auto& r = m_Nodes[pNode->Offset + 1];
+                f32 tl, tr;
+                auto hitL = IntersectNode( l, origin, invDir, ray.TMin, ray.TMax, tl );
+                auto hitR = IntersectNode( r, origin, invDir, ray.TMin, ray.TMax, tr );
+
+                if ( hitL && hitR )
+                {
+                    // 遠い方を積んで近い方を続けて調べる.
+                    assert( top < StackSize );
+                    if ( tl <= tr )
+                    {
+                        stack[top] = pNode->Offset + 1;
+                        dist [top] = tr;
+                        pNode = &l;
+                    }
+                    else
+                    {
+                        stack[top] = pNode->Offset + 0;
+                        dist [top] = tl;
+                        pNode = &r;
+                    }
+                    top++;
+                }
+                else if ( hitL )
+                { pNode = &l; }
+                else if ( hitR )
+                { pNode = &r; }
+                else
+                { break; }
+            }
+        }
+
+        return hit;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノード判定関数で走査して葉のプリミティブを列挙します.
+    //---------------------------------------------------------------------------------------------
+    template<typename Test, typename Func>
+    void TraverseBox( Test test, Func& func ) const
+    {
+        if ( m_Nodes.empty() || !test( m_Nodes[0] ) )
+        { return; }
+
+        u32 stack[StackSize];
+        u32 top = 0;
+        stack[top++] = 0;
+        while( top > 0 )
+        {
+            const auto& node = m_Nodes[stack[--top]];
+            if ( node.IsLeaf() )
+            {
+                for( u32 i=0; i<node.Count; ++i )
+                { func( m_Indices[node.Offset + i] ); }
+                continue;
+            }
+
+            for( u32 c=0; c<2; ++c )
+            {
+                if ( test( m_Nodes[node.Offset + c] ) )
+                {
+                    assert( top < StackSize );
+                    stack[top++] = node.Offset + c;
+                }
+            }
+        }
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BvhHit structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BvhHit
+{
+    u32     Index;      //!< 交差した三角形の番号です.
+    f32     T;          //!< 交差位置までの距離です.
+    f32     U;          //!< 2番目の頂点の重心座標です.
+    f32     V;          //!< 3番目の頂点の重心座標です.
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      三角形のバウンディングボックスを並列に求めます.
+//!
+//! @param [in]     pPositions      頂点座標の配列.
+//! @param [in]     pIndices        三角形ごとに3つ並んだ頂点番号の配列.
+//! @param [in]     triangleCount   三角形の数.
+//! @param [out]    pBounds         triangleCount 個の出力先.
+//-------------------------------------------------------------------------------------------------
+inline void ComputeTriangleBounds( const Vector3* pPositions, const u32* pIndices, u32 triangleCount, BoundingBox* pBounds )
+{
+    ParallelFor( triangleCount, 4096, [=]( u32 begin, u32 end )
+    {
+        for( u32 i=begin; i<end; ++i )
+        {
+            BoundingBox box;
+            box.Merge( pPositions[pIndices[i * 3 + 0]] );
+            box.Merge( pPositions[pIndices[i * 3 + 1]] );
+            box.Merge( pPositions[pIndices[i * 3 + 2]] );
+            pBounds[i] = box;
+        }
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      三角形メッシュとレイの最も近い交差を求めます.
+//!
+//! @param [in]     bvh             ComputeTriangleBounds() の結果から構築した階層.
+//! @param [in]     pPositions      頂点座標の配列.
+//! @param [in]     pIndices        三角形ごとに3つ並んだ頂点番号の配列.
+//! @param [in,out] ray             レイ. 交差した場合 TMax が更新されます.
+//! @param [out]    hit             交差情報.
+//! @retval true    交差しました.
+//! @retval false   交差しませんでした.
+//-------------------------------------------------------------------------------------------------
+inline bool IntersectTriangles( const Bvh& bvh, const Vector3* pPositions, const u32* pIndices, Ray& ray, BvhHit& hit )
+{
+    return bvh.Intersect( ray, [&]( u32 index, Ray& r )
+    {
+        f32 t, u, v;
+        if ( !IntersectRayTriangle( r, pPositions[pIndices[index * 3 + 0]], pPositions[pIndices[index * 3 + 1]], pPositions[pIndices[index * 3 + 2]], t, u, v ) )
+        { return false; }
+
+        r.TMax    = t;
+        hit.Index = index;
+        hit.T     = t;
+        hit.U     = u;
+        hit.V     = v;
+        return true;
+    });
+}
+
+} // namespace asdx
+
+#endif//__ASDX_BVH_H__
@@ -0,0 +1,294 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxCulling.h
+// Desc : Batch Frustum Culling Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_CULLING_H__
+#define __ASDX_CULLING_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxBoundingVolume.h>
+#include <asdxSimd.h>
+#include <asdxParallel.h>
+#include <vector>
+#include <cstring>
+
+
+namespace asdx {
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CullingPlanes structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct CullingPlanes
+{
+    static const u32 Count = 8;     //!< 平面数です. 6枚を超える分は平面0の複製です.
+
+    ASDX_ALIGN(32) f32 X [Count];   //!< 法線の X 成分です.
+    ASDX_ALIGN(32) f32 Y [Count];   //!< 法線の Y 成分です.
+    ASDX_ALIGN(32) f32 Z [Count];   //!< 法線の Z 成分です.
+    ASDX_ALIGN(32) f32 W [Count];   //!< 距離です.
+    ASDX_ALIGN(32) f32 AX[Count];   //!< 法線の X 成分の絶対値です.
+    ASDX_ALIGN(32) f32 AY[Count];   //!< 法線の Y 成分の絶対値です.
+    ASDX_ALIGN(32) f32 AZ[Count];   //!< 法線の Z 成分の絶対値です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      視錐台の平面を SoA に並べ替えます.
+    //---------------------------------------------------------------------------------------------
+    explicit CullingPlanes( const Frustum& frustum )
+    {
+        for( u32 i=0; i<Count; ++i )
+        {
+            const auto& p = frustum.Planes[( i < 6 ) ? i : 0];
+            X [i] = p.x;
+            Y [i] = p.y;
+            Z [i] = p.z;
+            W [i] = p.w;
+            AX[i] = fabsf( p.x );
+            AY[i] = fabsf( p.y );
+            AZ[i] = fabsf( p.z );
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      平面までの符号付き距離を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+simd::FloatN PlaneDistance( const CullingPlanes& planes, u32 i, simd::FloatN x, simd::FloatN y, simd::FloatN z )
+{
+    using namespace simd;
+    auto d = AddN( MulN( LoadN( planes.X + i ), x ), MulN( LoadN( planes.Y + i ), y ) );
+    return AddN( AddN( d, MulN( LoadN( planes.Z + i ), z ) ), LoadN( planes.W + i ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BoxCuller structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BoxCuller
+{
+    typedef BoundingBox BoundType;
+
+    static bool IsVisible( const CullingPlanes& planes, const BoundingBox& value )
+    {
+        using namespace simd;
+        auto c  = value.GetCenter();
+        auto e  = value.GetExtent();
+        auto cx = SetN( c.x );
+        auto cy = SetN( c.y );
+        auto cz = SetN( c.z );
+        auto ex = SetN( e.x );
+        auto ey = SetN( e.y );
+        auto ez = SetN( e.z );
+
+        for( u32 i=0; i<CullingPlanes::Count; i+=FloatNWidth )
+        {
+            auto d = PlaneDistance( planes, i, cx, cy, cz );
+            auto r = AddN( AddN( MulN( LoadN( planes.AX + i ), ex ), MulN( LoadN( planes.AY + i ), ey ) ), MulN( LoadN( planes.AZ + i ), ez ) );
+            if ( AnyNegativeN( AddN( d, r ) ) )
+            { return false; }
+        }
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SphereCuller structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SphereCuller
+{
+    typedef BoundingSphere BoundType;
+
+    static bool IsVisible( const CullingPlanes& planes, const BoundingSphere& value )
+    {
+        using namespace simd;
+        auto cx = SetN( value.Center.x );
+        auto cy = SetN( value.Center.y );
+        auto cz = SetN( value.Center.z );
+        auto r  = SetN( value.Radius );
+
+        for( u32 i=0; i<CullingPlanes::Count; i+=FloatNWidth )
+        {
+            if ( AnyNegativeN( AddN( PlaneDistance( planes, i, cx, cy, cz ), r ) ) )
+            { return false; }
+        }
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// OrientedBoxCuller structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct OrientedBoxCuller
+{
+    typedef OrientedBox BoundType;
+
+    static bool IsVisible( const CullingPlanes& planes, const OrientedBox& value )
+    {
+        using namespace simd;
+        auto cx = SetN( value.Center.x );
+        auto cy = SetN( value.Center.y );
+        auto cz = SetN( value.Center.z );
+        auto ex = SetN( value.Extent.x );
+        auto ey = SetN( value.Extent.y );
+        auto ez = SetN( value.Extent.z );
+
+        for( u32 i=0; i<CullingPlanes::Count; i+=FloatNWidth )
+        {
+            auto px = LoadN( planes.X + i );
+            auto py = LoadN( planes.Y + i );
+            auto pz = LoadN( planes.Z + i );
+
+            FloatN r[3];
+            for( u32 j=0; j<3; ++j )
+            {
+                const auto& a = value.Axis[j];
+                r[j] = AbsN( AddN( AddN( MulN( px, SetN( a.x ) ), MulN( py, SetN( a.y ) ) ), MulN( pz, SetN( a.z ) ) ) );
+            }
+
+            auto d = PlaneDistance( planes, i, cx, cy, cz );
+            auto e = AddN( AddN( MulN( r[0], ex ), MulN( r[1], ey ) ), MulN( r[2], ez ) );
+            if ( AnyNegativeN( AddN( d, e ) ) )
+            { return false; }
+        }
+        return true;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [begin, end) の範囲をカリングして可視要素の番号を詰めて出力します.
+//-------------------------------------------------------------------------------------------------
+template<typename Culler>
+u32 CullRange
+(
+    const CullingPlanes&                planes,
+    const typename Culler::BoundType*   pBounds,
+    u32                                 begin,
+    u32                                 end,
+    u32*                                pVisible
+)
+{
+    u32 count = 0;
+    for( u32 i=begin; i<end; ++i )
+    {
+        // 分岐せずに書き込んでからカウンタを進める.
+        pVisible[count] = i;
+        count += Culler::IsVisible( planes, pBounds[i] ) ? 1 : 0;
+    }
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      カリングを行います.
+//-------------------------------------------------------------------------------------------------
+template<typename Culler>
+u32 Cull( const Frustum& frustum, const typename Culler::BoundType* pBounds, u32 count, u32* pVisible )
+{
+    CullingPlanes planes( frustum );
+    return CullRange<Culler>( planes, pBounds, 0, count, pVisible );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      並列にカリングを行います.
+//!
+//! @note       各タスクは pVisible の自分の範囲に結果を書き込み, 最後に前から詰めます.
+//!             出力順は Cull() と同じです.
+//-------------------------------------------------------------------------------------------------
+template<typename Culler>
+u32 CullParallel( const Frustum& frustum, const typename Culler::BoundType* pBounds, u32 count, u32* pVisible, u32 grain )
+{
+    if ( grain == 0 )
+    { grain = 1; }
+
+    auto chunkCount = ( count + grain - 1 ) / grain;
+    if ( chunkCount <= 1 )
+    { return Cull<Culler>( frustum, pBounds, count, pVisible ); }
+
+    CullingPlanes planes( frustum );
+    std::vector<u32> counts( chunkCount );
+
+    ParallelFor( chunkCount, 1, [&]( u32 chunkBegin, u32 chunkEnd )
+    {
+        for( u32 c=chunkBegin; c<chunkEnd; ++c )
+        {
+            auto begin = c * grain;
+            auto end   = ( count - begin < grain ) ? count : begin + grain;
+            counts[c] = CullRange<Culler>( planes, pBounds, begin, end, pVisible + begin );
+        }
+    });
+
+    // 書き込み先は常に読み出し元以前なので, 前から順に移動すれば上書きされない.
+    u32 offset = counts[0];
+    for( u32 c=1; c<chunkCount; ++c )
+    {
+        if ( counts[c] > 0 )
+        { memmove( pVisible + offset, pVisible + c * grain, sizeof(u32) * counts[c] ); }
+        offset += counts[c];
+    }
+
+    return offset;
+}
+
+} // namespace detail
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ボックスの配列を視錐台カリングします.
+//!
+//! @param [in]     frustum     視錐台.
+//! @param [in]     pBounds     ボックスの配列.
+//! @param [in]     count       ボックスの数.
+//! @param [out]    pVisible    可視なボックスの番号を昇順に詰めて出力します. count 個分の領域が必要です.
+//! @return     可視なボックスの数を返却します.
+//! @note       1つのボックスを全平面に対して同時に判定します. Frustum::Intersects() と同じ結果です.
+//-------------------------------------------------------------------------------------------------
+inline u32 CullBoxes( const Frustum& frustum, const BoundingBox* pBounds, u32 count, u32* pVisible )
+{ return detail::Cull<detail::BoxCuller>( frustum, pBounds, count, pVisible ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      球の配列を視錐台カリングします.
+//!
+//! @note       引数と戻り値は CullBoxes() と同じです.
+//-------------------------------------------------------------------------------------------------
+inline u32 CullSpheres( const Frustum& frustum, const BoundingSphere* pBounds, u32 count, u32* pVisible )
+{ return detail::Cull<detail::SphereCuller>( frustum, pBounds, count, pVisible ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      有向ボックスの配列を視錐台カリングします.
+//!
+//! @note       引数と戻り値は CullBoxes() と同じです.
+//-------------------------------------------------------------------------------------------------
+inline u32 CullOrientedBoxes( const Frustum& frustum, const OrientedBox* pBounds, u32 count, u32* pVisible )
+{ return detail::Cull<detail::OrientedBoxCuller>( frustum, pBounds, count, pVisible ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ボックスの配列を並列に視錐台カリングします.
+//!
+//! @param [in]     grain       1タスクあたりの要素数です.
+//! @note       結果は CullBoxes() と同じです.
+//-------------------------------------------------------------------------------------------------
+inline u32 CullBoxesParallel( const Frustum& frustum, const BoundingBox* pBounds, u32 count, u32* pVisible, u32 grain = 4096 )
+{ return detail::CullParallel<detail::BoxCuller>( frustum, pBounds, count, pVisible, grain ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      球の配列を並列に視錐台カリングします.
+//!
+//! @note       結果は CullSpheres() と同じです.
+//-------------------------------------------------------------------------------------------------
+inline u32 CullSpheresParallel( const Frustum& frustum, const BoundingSphere* pBounds, u32 count, u32* pVisible, u32 grain = 4096 )
+{ return detail::CullParallel<detail::SphereCuller>( frustum, pBounds, count, pVisible, grain ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      有向ボックスの配列を並列に視錐台カリングします.
+//!
+//! @note       結果は CullOrientedBoxes() と同じです.
+//-------------------------------------------------------------------------------------------------
+inline u32 CullOrientedBoxesParallel( const Frustum& frustum, const OrientedBox* pBounds, u32 count, u32* pVisible, u32 grain = 4096 )
+{ return detail::CullParallel<detail::OrientedBoxCuller>( frustum, pBounds, count, pVisible, grain ); }
+
+} // namespace asdx
+
+#endif//__ASDX_CULLING_H__
@@ -0,0 +1,1037 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxEntity.h
+// Desc : Archetype Based Entity Component Storage.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_ENTITY_H__
+#define __ASDX_ENTITY_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxHandle.h>
+#include <asdxParallel.h>
+#include <asdxAlignedAllocator.h>
+#include <asdxMemoryTracker.h>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <cassert>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const u32 MaxComponentTypes  = 64;           //!< 登録できるコンポーネントの種類の上限です.
+static const u32 EntityChunkSize    = 16 * 1024;    //!< チャンク1つのバイト数です.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EntityRecord structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct EntityRecord
+{
+    u32     Archetype;      //!< 所属するアーキタイプの番号です.
+    u32     Chunk;          //!< アーキタイプ内のチャンク番号です.
+    u32     Row;            //!< チャンク内の行番号です.
+};
+
+typedef Handle<EntityRecord>    Entity;     //!< エンティティです.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ComponentInfo structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ComponentInfo
+{
+    u32     Size;           //!< バイト数です.
+    u32     Alignment;      //!< アライメントです.
+};
+
+
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ComponentRegistry class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ComponentRegistry : private NonCopyable
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static ComponentRegistry& Instance()
+    {
+        static ComponentRegistry s_Instance;
+        return s_Instance;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントの種類を登録します.
+    //!
+    //! @return     コンポーネントの種類番号を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 Register( u32 size, u32 alignment )
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        assert( m_Count < MaxComponentTypes );
+
+        auto id = m_Count;
+        m_Infos[id].Size      = size;
+        m_Infos[id].Alignment = alignment;
+        m_Count++;
+        return id;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントの情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    const ComponentInfo& GetInfo( u32 id ) const
+    {
+        assert( id < MaxComponentTypes );
+        return m_Infos[id];
+    }
+
+private:
+    std::mutex      m_Mutex;                        //!< 登録を保護します.
+    ComponentInfo   m_Infos[MaxComponentTypes];     //!< 種類ごとの情報です.
+    u32             m_Count;                        //!< 登録済みの種類数です.
+
+    ComponentRegistry()
+    : m_Count( 0 )
+    { memset( m_Infos, 0, sizeof(m_Infos) ); }
+};
+
+} // namespace detail
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ComponentType structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      コンポーネントの種類番号を払い出します.
+//!
+//! @note       チャンク間の移動はビット単位のコピーで行い, デストラクタは呼び出しません.
+//!             そのため, コンポーネントはトリビアルに破棄できる型に限ります.
+//!             種類番号は最初に使用した順に払い出されます.
+//-------------------------------------------------------------------------------------------------
+ASDX_TEMPLATE(T)
+struct ComponentType
+{
+    static_assert( std::is_trivially_destructible<T>::value, "Component must be trivially destructible." );
+    static_assert( alignof(T) <= CacheLineSize, "Component alignment must not exceed the cache line size." );
+    static_assert( sizeof(T) + CacheLineSize <= EntityChunkSize, "Component must fit one row per chunk." );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      種類番号を取得します.
+    //---------------------------------------------------------------------------------------------
+    static u32 GetId()
+    {
+        static const u32 s_Id = detail::ComponentRegistry::Instance().Register( sizeof(T), alignof(T) );
+        return s_Id;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      種類を表すビットマスクを取得します.
+    //---------------------------------------------------------------------------------------------
+    static u64 GetMask()
+    { return u64( 1 ) << GetId(); }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      コンポーネントの組み合わせを表すビットマスクを求めます.
+//-------------------------------------------------------------------------------------------------
+template<typename... Ts>
+inline u64 MakeComponentMask()
+{
+    u64 mask = 0;
+    int dummy[] = { 0, ( mask |= ComponentType<typename std::remove_const<Ts>::type>::GetMask(), 0 )... };
+    (void)dummy;
+    return mask;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EntityChunk structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct EntityChunk
+{
+    u8*     pData;      //!< EntityChunkSize バイトのメモリです. 各列はキャッシュラインに揃っています.
+    u32     Count;      //!< 格納しているエンティティ数です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EntityArchetype class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      同じコンポーネントの組み合わせを持つエンティティの表です.
+//!
+//! @note       チャンクの先頭にエンティティの列, 続いて種類番号順にコンポーネントの列を並べます.
+//!             末尾以外のチャンクは常に満杯で, 削除時は末尾の行で穴を埋めます.
+//-------------------------------------------------------------------------------------------------
+class EntityArchetype : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 InvalidOffset = 0xffffffff;    //!< 持っていないコンポーネントの列です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param [in]     mask        コンポーネントの組み合わせです.
+    //---------------------------------------------------------------------------------------------
+    explicit EntityArchetype( u64 mask )
+    : m_Mask    ( mask )
+    , m_Capacity( 0 )
+    , m_Count   ( 0 )
+    {
+        u32 rowBytes = sizeof(Entity);
+        u32 padding  = 0;
+        for( u32 id=0; id<MaxComponentTypes; ++id )
+        {
+            m_Offsets[id] = InvalidOffset;
+            m_Sizes  [id] = 0;
+            if ( mask & ( u64( 1 ) << id ) )
+            {
+                m_Sizes[id] = detail::ComponentRegistry::Instance().GetInfo( id ).Size;
+                m_TypeIds.push_back( id );
+                rowBytes += m_Sizes[id];
+                padding  += CacheLineSize;
+            }
+        }
+
+        // 列ごとにキャッシュラインへ揃えても収まる行数を求める.
+        m_Capacity = ( padding < EntityChunkSize ) ? ( EntityChunkSize - padding ) / rowBytes : 0;
+        if ( m_Capacity == 0 )
+        { m_Capacity = 1; }
+        while( m_Capacity > 1 && Layout( m_Capacity ) > EntityChunkSize )
+        { m_Capacity--; }
+
+        // 縮めるループを通らなかった場合も列の開始位置を確定させる.
+        if ( Layout( m_Capacity ) > EntityChunkSize )
+        { throw std::length_error( "EntityArchetype : components do not fit one row per chunk." ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~EntityArchetype()
+    {
+        for( size_t i=0; i<m_Chunks.size(); ++i )
+        { FreeChunk( m_Chunks[i] ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントの組み合わせを取得します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetMask() const
+    { return m_Mask; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンクあたりの行数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetCapacity() const
+    { return m_Capacity; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エンティティ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetEntityCount() const
+    { return m_Count; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンク数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetChunkCount() const
+    { return static_cast<u32>( m_Chunks.size() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンクを取得します.
+    //---------------------------------------------------------------------------------------------
+    const EntityChunk& GetChunk( u32 index ) const
+    { return m_Chunks[index]; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントを持っているかどうか.
+    //---------------------------------------------------------------------------------------------
+    bool HasComponent( u32 typeId ) const
+    { return m_Offsets[typeId] != InvalidOffset; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンク内のエンティティの列を取得します.
+    //---------------------------------------------------------------------------------------------
+    Entity* GetEntities( const EntityChunk& chunk ) const
+    { return reinterpret_cast<Entity*>( chunk.pData ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンク内のコンポーネントの列を取得します.
+    //---------------------------------------------------------------------------------------------
+    u8* GetColumn( const EntityChunk& chunk, u32 typeId ) const
+    {
+        assert( HasComponent( typeId ) );
+        return chunk.pData + m_Offsets[typeId];
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      行を確保します.
+    //!
+    //! @param [in]     entity      行に格納するエンティティです.
+    //! @param [out]    chunk       確保したチャンク番号です.
+    //! @param [out]    row         確保した行番号です.
+    //! @note       コンポーネントはゼロで初期化されます.
+    //---------------------------------------------------------------------------------------------
+    void Alloc( Entity entity, u32& chunk, u32& row )
+    {
+        if ( m_Chunks.empty() || m_Chunks.back().Count == m_Capacity )
+        { m_Chunks.push_back( AllocChunk() ); }
+
+        chunk = static_cast<u32>( m_Chunks.size() - 1 );
+        auto& c = m_Chunks.back();
+        row = c.Count++;
+        m_Count++;
+
+        GetEntities( c )[row] = entity;
+        for( size_t i=0; i<m_TypeIds.size(); ++i )
+        {
+            auto id = m_TypeIds[i];
+            memset( GetColumn( c, id ) + size_t( row ) * m_Sizes[id], 0, m_Sizes[id] );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      行を解放します.
+    //!
+    //! @param [in]     chunk       チャンク番号です.
+    //! @param [in]     row         行番号です.
+    //! @return     穴埋めのため (chunk, row) に移動したエンティティを返却します.
+    //!             移動が無かった場合は null ハンドルを返却します.
+    //---------------------------------------------------------------------------------------------
+    Entity Free( u32 chunk, u32 row )
+    {
+        assert( chunk < m_Chunks.size() && row < m_Chunks[chunk].Count );
+
+        auto& last    = m_Chunks.back();
+        auto  lastRow = last.Count - 1;
+        auto  moved   = Entity();
+
+        if ( &m_Chunks[chunk] != &last || row != lastRow )
+        {
+            CopyRow( last, lastRow, m_Chunks[chunk], row );
+            moved = GetEntities( last )[lastRow];
+        }
+
+        last.Count--;
+        m_Count--;
+
+        if ( last.Count == 0 )
+        {
+            FreeChunk( last );
+            m_Chunks.pop_back();
+        }
+
+        return moved;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      共通するコンポーネントを別のアーキタイプの行にコピーします.
+    //---------------------------------------------------------------------------------------------
+    void CopyShared( u32 chunk, u32 row, const EntityArchetype& dst, u32 dstChunk, u32 dstRow ) const
+    {
+        auto& s = m_Chunks[chunk];
+        auto& d = dst.m_Chunks[dstChunk];
+        for( size_t i=0; i<m_TypeIds.size(); ++i )
+        {
+            auto id = m_TypeIds[i];
+            if ( !dst.HasComponent( id ) )
+            { continue; }
+
+            memcpy(
+                dst.GetColumn( d, id ) + size_t( dstRow ) * m_Sizes[id],
+                GetColumn( s, id ) + size_t( row ) * m_Sizes[id],
+                m_Sizes[id] );
+        }
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    u64                         m_Mask;                         //!< コンポーネントの組み合わせです.
+    u32                         m_Capacity;                     //!< チャンクあたりの行数です.
+    u32                         m_Count;                        //!< エンティティ数です.
+    u32                         m_Offsets[MaxComponentTypes];   //!< 種類ごとの列の開始位置です.
+    u32                         m_Sizes  [MaxComponentTypes];   //!< 種類ごとの要素のバイト数です.
+    std::vector<u32>            m_TypeIds;                      //!< 持っている種類番号です.
+    std::vector<EntityChunk>    m_Chunks;                       //!< チャンクです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      列の開始位置を決めます.
+    //!
+    //! @return     capacity 行を格納するのに必要なバイト数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 Layout( u32 capacity )
+    {
+        auto offset = u32( sizeof(Entity) ) * capacity;
+        for( size_t i=0; i<m_TypeIds.size(); ++i )
+        {
+            auto id = m_TypeIds[i];
+            offset = ( offset + CacheLineSize - 1 ) & ~( CacheLineSize - 1 );
+            m_Offsets[id] = offset;
+            offset += m_Sizes[id] * capacity;
+        }
+        return offset;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      行をコピーします.
+    //---------------------------------------------------------------------------------------------
+    void CopyRow( const EntityChunk& src, u32 srcRow, EntityChunk& dst, u32 dstRow ) const
+    {
+        GetEntities( dst )[dstRow] = GetEntities( src )[srcRow];
+        for( size_t i=0; i<m_TypeIds.size(); ++i )
+        {
+            auto id = m_TypeIds[i];
+            memcpy(
+                GetColumn( dst, id ) + size_t( dstRow ) * m_Sizes[id],
+                GetColumn( src, id ) + size_t( srcRow ) * m_Sizes[id],
+                m_Sizes[id] );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンクを確保します.
+    //---------------------------------------------------------------------------------------------
+    static EntityChunk AllocChunk()
+    {
+        EntityChunk chunk;
+        chunk.pData = static_cast<u8*>( AlignedAlloc( EntityChunkSize, CacheLineSize ) );
+        chunk.Count = 0;
+        if ( chunk.pData == nullptr )
+        { throw std::bad_alloc(); }
+
+        MemoryTracker::Instance().OnAlloc( MEMORY_TAG_OTHER, EntityChunkSize );
+        return chunk;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンクを解放します.
+    //---------------------------------------------------------------------------------------------
+    static void FreeChunk( EntityChunk& chunk )
+    {
+        MemoryTracker::Instance().OnFree( MEMORY_TAG_OTHER, EntityChunkSize );
+        AlignedFree( chunk.pData );
+        chunk.pData = nullptr;
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EntityWorld class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      エンティティとコンポーネントを管理します.
+//!
+//! @note       Each() / EachParallel() の処理中は構造変更(生成・破棄・コンポーネントの追加と削除)を
+//!             行えません. 処理中の構造変更は EntityCommandBuffer に記録して後で反映してください.
+//!             処理中に構造変更を行うと std::logic_error を送出します. EachParallel() のワーカーから
+//!             送出された場合は捕捉できないため std::terminate() で停止します.
+//-------------------------------------------------------------------------------------------------
+class EntityWorld : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    EntityWorld()
+    : m_IterationDepth( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エンティティを生成します.
+    //!
+    //! @param [in]     values      コンポーネントの初期値です.
+    //! @return     生成したエンティティを返却します.
+    //---------------------------------------------------------------------------------------------
+    template<typename... Ts>
+    Entity Create( const Ts&... values )
+    {
+        auto entity = CreateRaw( MakeComponentMask<Ts...>() );
+        int dummy[] = { 0, ( *Get<Ts>( entity ) = values, 0 )... };
+        (void)dummy;
+        return entity;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントの組み合わせを指定してエンティティを生成します.
+    //!
+    //! @param [in]     mask        コンポーネントの組み合わせです.
+    //! @return     生成したエンティティを返却します. コンポーネントはゼロで初期化されます.
+    //---------------------------------------------------------------------------------------------
+    Entity CreateRaw( u64 mask )
+    {
+        CheckStructuralChange();
+
+        EntityRecord record;
+        record.Archetype = GetOrCreateArchetype( mask );
+        record.Chunk     = 0;
+        record.Row       = 0;
+
+        auto entity = m_Records.Create( record );
+        auto pRecord = m_Records.Get( entity );
+        m_Archetypes[record.Archetype]->Alloc( entity, pRecord->Chunk, pRecord->Row );
+        return entity;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エンティティを破棄します.
+    //!
+    //! @retval true    破棄しました.
+    //! @retval false   エンティティが無効でした.
+    //---------------------------------------------------------------------------------------------
+    bool Destroy( Entity entity )
+    {
+        CheckStructuralChange();
+
+        auto pRecord = m_Records.Get( entity );
+        if ( pRecord == nullptr )
+        { return false; }
+
+        auto moved = m_Archetypes[pRecord->Archetype]->Free( pRecord->Chunk, pRecord->Row );
+        if ( !moved.IsNull() )
+        {
+            auto pMoved = m_Records.Get( moved );
+            pMoved->Chunk = pRecord->Chunk;
+            pMoved->Row   = pRecord->Row;
+        }
+
+        return m_Records.Destroy( entity );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エンティティが有効かどうかを判定します.
+    //---------------------------------------------------------------------------------------------
+    bool IsAlive( Entity entity ) const
+    { return m_Records.IsValid( entity ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントを追加します.
+    //!
+    //! @note       既に持っている場合は値を上書きします.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(T)
+    void Add( Entity entity, const T& value )
+    { AddRaw( entity, ComponentType<T>::GetId(), &value ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントを削除します.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(T)
+    void Remove( Entity entity )
+    { RemoveRaw( entity, ComponentType<T>::GetId() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントを持っているかどうか.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(T)
+    bool Has( Entity entity ) const
+    { return GetRaw( entity, ComponentType<typename std::remove_const<T>::type>::GetId() ) != nullptr; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントを取得します.
+    //!
+    //! @return     コンポーネントを返却します. 持っていない場合は nullptr を返却します.
+    //! @note       返却したポインタは次の構造変更まで有効です.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(T)
+    T* Get( Entity entity )
+    { return static_cast<T*>( GetRaw( entity, ComponentType<typename std::remove_const<T>::type>::GetId() ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントを取得します.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(T)
+    const T* Get( Entity entity ) const
+    { return static_cast<const T*>( GetRaw( entity, ComponentType<typename std::remove_const<T>::type>::GetId() ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      種類番号を指定してコンポーネントを追加します.
+    //!
+    //! @param [in]     entity      対象のエンティティです.
+    //! @param [in]     typeId      種類番号です.
+    //! @param [in]     pValue      値です. nullptr の場合はゼロで初期化します.
+    //---------------------------------------------------------------------------------------------
+    void AddRaw( Entity entity, u32 typeId, const void* pValue )
+    {
+        CheckStructuralChange();
+
+        auto pRecord = m_Records.Get( entity );
+        if ( pRecord == nullptr )
+        { return; }
+
+        auto mask = m_Archetypes[pRecord->Archetype]->GetMask();
+        if ( ( mask & ( u64( 1 ) << typeId ) ) == 0 )
+        { ChangeArchetype( entity, *pRecord, mask | ( u64( 1 ) << typeId ) ); }
+
+        if ( pValue != nullptr )
+        { memcpy( GetRaw( entity, typeId ), pValue, detail::ComponentRegistry::Instance().GetInfo( typeId ).Size ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      種類番号を指定してコンポーネントを削除します.
+    //---------------------------------------------------------------------------------------------
+    void RemoveRaw( Entity entity, u32 typeId )
+    {
+        CheckStructuralChange();
+
+        auto pRecord = m_Records.Get( entity );
+        if ( pRecord == nullptr )
+        { return; }
+
+        auto mask = m_Archetypes[pRecord->Archetype]->GetMask();
+        if ( mask & ( u64( 1 ) << typeId ) )
+        { ChangeArchetype( entity, *pRecord, mask & ~( u64( 1 ) << typeId ) ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      種類番号を指定してコンポーネントを取得します.
+    //---------------------------------------------------------------------------------------------
+    void* GetRaw( Entity entity, u32 typeId ) const
+    {
+        auto pRecord = m_Records.Get( entity );
+        if ( pRecord == nullptr )
+        { return nullptr; }
+
+        auto& archetype = *m_Archetypes[pRecord->Archetype];
+        if ( !archetype.HasComponent( typeId ) )
+        { return nullptr; }
+
+        auto& chunk = archetype.GetChunk( pRecord->Chunk );
+        return archetype.GetColumn( chunk, typeId )
+             + size_t( pRecord->Row ) * detail::ComponentRegistry::Instance().GetInfo( typeId ).Size;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      指定したコンポーネントを全て持つエンティティをチャンク単位で処理します.
+    //!
+    //! @param [in]     func        void( u32 count, const Entity* pEntities, Ts* pComponents... ) の
+    //!                             形式の関数です. 各配列は count 個の連続した要素を持ちます.
+    //! @note       読み取り専用のコンポーネントは const を付けて指定できます.
+    //---------------------------------------------------------------------------------------------
+    template<typename... Ts, typename Func>
+    void Each( Func func )
+    {
+        auto mask = MakeComponentMask<Ts...>();
+
+        IterationScope scope( m_IterationDepth );
+        for( size_t a=0; a<m_Archetypes.size(); ++a )
+        {
+            auto& archetype = *m_Archetypes[a];
+            if ( ( archetype.GetMask() & mask ) != mask )
+            { continue; }
+
+            for( u32 c=0; c<archetype.GetChunkCount(); ++c )
+            { Invoke<Ts...>( archetype, archetype.GetChunk( c ), func ); }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      指定したコンポーネントを全て持つエンティティをチャンク単位で並列に処理します.
+    //!
+    //! @param [in]     func        Each() と同じ形式の関数です. 複数のスレッドから同時に呼び出されます.
+    //! @param [in]     grain       1タスクあたりのチャンク数です.
+    //---------------------------------------------------------------------------------------------
+    template<typename... Ts, typename Func>
+    void EachParallel( Func func, u32 grain = 1 )
+    {
+        auto mask = MakeComponentMask<Ts...>();
+
+        // 対象のチャンクを列挙してからチャンク単位で分配する.
+        std::vector<std::pair<const EntityArchetype*, const EntityChunk*>> chunks;
+        for( size_t a=0; a<m_Archetypes.size(); ++a )
+        {
+            auto& archetype = *m_Archetypes[a];
+            if ( ( archetype.GetMask() & mask ) != mask )
+            { continue; }
+
+            for( u32 c=0; c<archetype.GetChunkCount(); ++c )
+            { chunks.push_back( std::make_pair( &archetype, &archetype.GetChunk( c ) ) ); }
+        }
+
+        IterationScope scope( m_IterationDepth );
+        ParallelFor( static_cast<u32>( chunks.size() ), grain, [&]( u32 begin, u32 end )
+        {
+            for( u32 i=begin; i<end; ++i )
+            { Invoke<Ts...>( *chunks[i].first, *chunks[i].second, func ); }
+        });
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エンティティ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetEntityCount() const
+    { return m_Records.GetCount(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アーキタイプ数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetArchetypeCount() const
+    { return static_cast<u32>( m_Archetypes.size() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アーキタイプを取得します.
+    //---------------------------------------------------------------------------------------------
+    const EntityArchetype& GetArchetype( u32 index ) const
+    { return *m_Archetypes[index]; }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    HandlePool<EntityRecord>                        m_Records;          //!< エンティティの格納位置です.
+    std::vector<std::unique_ptr<EntityArchetype>>   m_Archetypes;       //!< アーキタイプです.
+    std::unordered_map<u64, u32>                    m_ArchetypeMap;     //!< 組み合わせからアーキタイプ番号への対応です.
+    std::atomic<u32>                                m_IterationDepth;   //!< 処理中の Each() の数です.
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // IterationScope structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct IterationScope
+    {
+        std::atomic<u32>& Depth;    //!< 処理中の Each() の数です.
+
+        explicit IterationScope( std::atomic<u32>& depth ) : Depth( depth ) { Depth++; }
+        ~IterationScope() { Depth--; }
+        IterationScope& operator = ( const IterationScope& ) = delete;
+    };
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      構造変更できるかどうかチェックします.
+    //!
+    //! @note       リリースビルドでもチェックし, 処理中であれば std::logic_error を送出します.
+    //---------------------------------------------------------------------------------------------
+    void CheckStructuralChange() const
+    {
+        if ( m_IterationDepth.load( std::memory_order_relaxed ) != 0 )
+        { throw std::logic_error( "EntityWorld : structural change during iteration." ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アーキタイプを検索し, 無ければ生成します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetOrCreateArchetype( u64 mask )
+    {
+        auto itr = m_ArchetypeMap.find( mask );
+        if ( itr != m_ArchetypeMap.end() )
+        { return itr->second; }
+
+        auto index = static_cast<u32>( m_Archetypes.size() );
+        m_Archetypes.push_back( std::unique_ptr<EntityArchetype>( new EntityArchetype( mask ) ) );
+        m_ArchetypeMap[mask] = index;
+        return index;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エンティティを別のアーキタイプに移動します.
+    //---------------------------------------------------------------------------------------------
+    void ChangeArchetype( Entity entity, EntityRecord& record, u64 mask )
+    {
+        auto  index = GetOrCreateArchetype( mask );
+        auto& src   = *m_Archetypes[record.Archetype];
+        auto& dst   = *m_Archetypes[index];
+
+        u32 chunk, row;
+        dst.Alloc( entity, chunk, row );
+        src.CopyShared( record.Chunk, record.Row, dst, chunk, row );
+
+        auto moved = src.Free( record.Chunk, record.Row );
+        if ( !moved.IsNull() )
+        {
+            auto pMoved = m_Records.Get( moved );
+            pMoved->Chunk = record.Chunk;
+            pMoved->Row   = record.Row;
+        }
+
+        record.Archetype = index;
+        record.Chunk     = chunk;
+        record.Row       = row;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンクの列を引数にして関数を呼び出します.
+    //---------------------------------------------------------------------------------------------
+    template<typename... Ts, typename Func>
+    static void Invoke( const EntityArchetype& archetype, const EntityChunk& chunk, Func& func )
+    {
+        func(
+            chunk.Count,
+            static_cast<const Entity*>( archetype.GetEntities( chunk ) ),
+            reinterpret_cast<Ts*>( archetype.GetColumn( chunk, ComponentType<typename std::remove_const<Ts>::type>::GetId() ) )... );
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EntityCommandBuffer class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      構造変更を記録して後でまとめて反映します.
+//!
+//! @note       記録は複数のスレッドから同時に行えます. 反映は記録した順に行うため,
+//!             複数のスレッドから記録した場合の順序は不定です.
+//-------------------------------------------------------------------------------------------------
+class EntityCommandBuffer : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    EntityCommandBuffer()
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エンティティの生成を記録します.
+    //---------------------------------------------------------------------------------------------
+    template<typename... Ts>
+    void Create( const Ts&... values )
+    {
+        std::vector<u8> payload;
+        int dummy[] = { 0, ( AppendComponent( payload, ComponentType<Ts>::GetId(), &values, sizeof(Ts) ), 0 )... };
+        (void)dummy;
+
+        Push( COMMAND_CREATE, Entity(), static_cast<u32>( sizeof...(Ts) ), payload.data(), static_cast<u32>( payload.size() ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      エンティティの破棄を記録します.
+    //---------------------------------------------------------------------------------------------
+    void Destroy( Entity entity )
+    { Push( COMMAND_DESTROY, entity, 0, nullptr, 0 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントの追加を記録します.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(T)
+    void Add( Entity entity, const T& value )
+    { Push( COMMAND_ADD, entity, ComponentType<T>::GetId(), &value, sizeof(T) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンポーネントの削除を記録します.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(T)
+    void Remove( Entity entity )
+    { Push( COMMAND_REMOVE, entity, ComponentType<T>::GetId(), nullptr, 0 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      記録が空かどうか.
+    //---------------------------------------------------------------------------------------------
+    bool IsEmpty() const
+    { return m_Buffer.empty(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      記録を破棄します.
+    //---------------------------------------------------------------------------------------------
+    void Clear()
+    { m_Buffer.clear(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      記録した構造変更を反映して, 記録を破棄します.
+    //!
+    //! @param [in]     world       反映先です.
+    //! @note       反映時に無効になっているエンティティへのコマンドは無視します.
+    //---------------------------------------------------------------------------------------------
+    void Playback( EntityWorld& world )
+    {
+        size_t offset = 0;
+        while( offset < m_Buffer.size() )
+        {
+            Header header;
+            memcpy( &header, &m_Buffer[offset], sizeof(header) );
+            auto pPayload = m_Buffer.data() + offset + sizeof(header);
+
+            switch( header.Command )
+            {
+            case COMMAND_CREATE:
+                {
+                    // 先に組み合わせを求めてアーキタイプの移動を避ける.
+                    u64    mask = 0;
+                    size_t pos  = 0;
+                    for( u32 i=0; i<header.TypeId; ++i )
+                    {
+                        ComponentHeader component;
+                        memcpy( &component, pPayload + pos, sizeof(component) );
+                        mask |= u64( 1 ) << component.TypeId;
+                        pos  += sizeof(component) + Align( component.Size );
+                    }
+
+                    auto entity = world.CreateRaw( mask );
+
+                    pos = 0;
+                    for( u32 i=0; i<header.TypeId; ++i )
+                    {
+                        ComponentHeader component;
+                        memcpy( &component, pPayload + pos, sizeof(component) );
+                        memcpy( world.GetRaw( entity, component.TypeId ), pPayload + pos + sizeof(component), component.Size );
+                        pos += sizeof(component) + Align( component.Size );
+                    }
+                }
+                break;
+
+            case COMMAND_DESTROY:
+                world.Destroy( header.Target );
+                break;
+
+            case COMMAND_ADD:
+                world.AddRaw( header.Target, header.TypeId, pPayload );
+                break;
+
+            case COMMAND_REMOVE:
+                world.RemoveRaw( header.Target, header.TypeId );
+                break;
+            }
+
+            offset += sizeof(header) + Align( header.PayloadSize );
+        }
+
+        m_Buffer.clear();
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    enum COMMAND
+    {
+        COMMAND_CREATE = 0,     //!< エンティティの生成です.
+        COMMAND_DESTROY,        //!< エンティティの破棄です.
+        COMMAND_ADD,            //!< コンポーネントの追加です.
+        COMMAND_REMOVE,         //!< コンポーネントの削除です.
+    };
+
+    struct Header
+    {
+        u32     Command;        //!< COMMAND です.
+        u32     TypeId;         //!< 種類番号です. 生成の場合はコンポーネント数です.
+        Entity  Target;         //!< 対象のエンティティです.
+        u32     PayloadSize;    //!< 後続のデータのバイト数です.
+        u32     Padding;        //!< 予約領域です.
+    };
+
+    struct ComponentHeader
+    {
+        u32     TypeId;         //!< 種類番号です.
+        u32     Size;           //!< 値のバイト数です.
+    };
+
+    std::vector<u8>     m_Buffer;       //!< 記録したコマンドです.
+    std::mutex          m_Mutex;        //!< 記録を保護します.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      8 バイト単位に切り上げます.
+    //---------------------------------------------------------------------------------------------
+    static size_t Align( size_t size )
+    { return ( size + 7 ) & ~size_t( 7 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      生成コマンドのコンポーネントを追記します.
+    //---------------------------------------------------------------------------------------------
+    static void AppendComponent( std::vector<u8>& payload, u32 typeId, const void* pValue, u32 size )
+    {
+        ComponentHeader header;
+        header.TypeId = typeId;
+        header.Size   = size;
+
+        auto offset = payload.size();
+        payload.resize( offset + sizeof(header) + Align( size ), 0 );
+        memcpy( &payload[offset], &header, sizeof(header) );
+        memcpy( &payload[offset + sizeof(header)], pValue, size );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コマンドを追記します.
+    //---------------------------------------------------------------------------------------------
+    void Push( u32 command, Entity target, u32 typeId, const void* pPayload, u32 payloadSize )
+    {
+        Header header;
+        header.Command     = command;
+        header.TypeId      = typeId;
+        header.Target      = target;
+        header.PayloadSize = payloadSize;
+        header.Padding     = 0;
+
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        auto offset = m_Buffer.size();
+        m_Buffer.resize( offset + sizeof(header) + Align( payloadSize ), 0 );
+        memcpy( &m_Buffer[offset], &header, sizeof(header) );
+        if ( payloadSize > 0 )
+        { memcpy( &m_Buffer[offset + sizeof(header)], pPayload, payloadSize ); }
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_ENTITY_H__
@@ -0,0 +1,728 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxFastMath.h
+// Desc : Fast Approximate Transcendental Functions.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_FAST_MATH_H__
+#define __ASDX_FAST_MATH_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxSimd.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+
+//-------------------------------------------------------------------------------------------------
+// Configuration
+//-------------------------------------------------------------------------------------------------
+
+// ASDX_FAST_MATH を 1 にすると Sin(), Cos() 等と, それを使う行列・クォータニオンの生成が近似版になります.
+// 既定値の 0 では標準ライブラリを呼び出し, 従来と同じ結果になります.
+#ifndef ASDX_FAST_MATH
+#define ASDX_FAST_MATH          (0)
+#endif//ASDX_FAST_MATH
+
+// 近似版の精度 (倍精度の標準ライブラリとの比較による実測値. ulp は単精度の最小単位).
+//  - FastSin, FastCos, FastSinCos : |x| <= 8192 で絶対誤差 9.3e-8 以内. |x| が大きいほど引数の還元誤差が増えます.
+//  - FastAcos  : 絶対誤差 3.1e-7 以内. 範囲外の入力は [-1, 1] に丸めます.
+//  - FastAtan2 : 絶対誤差 2.8e-7 以内. (0, 0) は 0 を返します.
+//  - FastExp2  : [-126, 127.5) で相対誤差 1.0e-7 以内. -126 未満は 0 を返し, 127.5 以上は飽和します.
+//  - FastLog2  : 正の正規化数で相対誤差 1.7e-7 以内. 0 は -∞, 負数は NaN を返します. 非正規化数は対象外です.
+//  - FastPow   : x > 0 で相対誤差 (2 + |y * log2(x)|) * 1.2e-7 以内. y = 0 は x によらず 1 を返します.
+//                x = 0 は y > 0 で 0, y < 0 で +∞ を返します. x < 0 は y が整数なら |x|^y に符号を付け, それ以外は NaN を返します.
+//  - FastRsqrt : 正の正規化数で相対誤差 2.4e-7 以内. 0 と ∞ は対象外です.
+// NaN を渡すと NaN を返します (FastAcos と, y = 0 の FastPow を除く).
+// FMA が有効な場合は多項式の丸めが変わるため, スカラー版と SIMD 版の結果が最大 1ulp 異なります.
+// スカラー版が標準ライブラリより速いかどうかは実装によります. tools/Benchmark.cpp の FastMath グループで確認してください.
+
+
+namespace asdx {
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FastOps1 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FastOps1
+{
+    static const u32 Width = 1;
+    typedef f32 Float;
+    typedef s32 Int;
+
+    static Float Load       ( const f32* p )                    { return *p; }
+    static void  Store      ( f32* p, Float v )                 { *p = v; }
+    static Float Set        ( f32 v )                           { return v; }
+    static Int   SetInt     ( s32 v )                           { return v; }
+    static Float Add        ( Float a, Float b )                { return a + b; }
+    static Float Sub        ( Float a, Float b )                { return a - b; }
+    static Float Mul        ( Float a, Float b )                { return a * b; }
+    static Float Div        ( Float a, Float b )                { return a / b; }
+    static Float MulAdd     ( Float a, Float b, Float c )       { return a * b + c; }
+    static Float Min        ( Float a, Float b )                { return ( a < b ) ? a : b; }
+    static Float Max        ( Float a, Float b )                { return ( a > b ) ? a : b; }
+    static Float Sqrt       ( Float a )                         { return sqrtf( a ); }
+    static Float And        ( Float a, Float b )                { return CastFloat( CastInt( a ) & CastInt( b ) ); }
+    static Float AndNot     ( Float a, Float b )                { return CastFloat( CastInt( a ) & ~CastInt( b ) ); }
+    static Float Or         ( Float a, Float b )                { return CastFloat( CastInt( a ) | CastInt( b ) ); }
+    static Float Xor        ( Float a, Float b )                { return CastFloat( CastInt( a ) ^ CastInt( b ) ); }
+    static Float CmpLT      ( Float a, Float b )                { return CastFloat( ( a <  b ) ? -1 : 0 ); }
+    static Float CmpLE      ( Float a, Float b )                { return CastFloat( ( a <= b ) ? -1 : 0 ); }
+    static Float CmpGT      ( Float a, Float b )                { return CastFloat( ( a >  b ) ? -1 : 0 ); }
+    static Float CmpEQ      ( Float a, Float b )                { return CastFloat( ( a == b ) ? -1 : 0 ); }
+    static Float Select     ( Float m, Float a, Float b )       { return Or( And( m, a ), AndNot( b, m ) ); }
+    static Float ToFloat    ( Int a )                           { return static_cast<f32>( a ); }
+    static Int   CastInt    ( Float a )                         { s32 r; memcpy( &r, &a, sizeof(r) ); return r; }
+    static Float CastFloat  ( Int a )                           { f32 r; memcpy( &r, &a, sizeof(r) ); return r; }
+    static Int   AddInt     ( Int a, Int b )                    { return a + b; }
+    static Int   SubInt     ( Int a, Int b )                    { return a - b; }
+    static Int   AndInt     ( Int a, Int b )                    { return a & b; }
+    static Int   OrInt      ( Int a, Int b )                    { return a | b; }
+    template<int N> static Int ShiftL( Int a )                  { return static_cast<s32>( static_cast<u32>( a ) << N ); }
+    template<int N> static Int ShiftR( Int a )                  { return a >> N; }
+
+    static Float Rsqrt( Float a )
+    {
+    #if ASDX_SIMD_SSE2
+        return _mm_cvtss_f32( _mm_rsqrt_ss( _mm_set_ss( a ) ) );
+    #else
+        // 近似値の初期値を整数演算で求める (相対誤差 3.5%).
+        return CastFloat( static_cast<s32>( 0x5f375a86u - ( static_cast<u32>( CastInt( a ) ) >> 1 ) ) );
+    #endif
+    }
+
+    static Int ToInt( Float a )
+    {
+        // 範囲外と NaN のキャストは未定義動作なので, SIMD 版の cvttps と同じく 0x80000000 を返す.
+        if ( a >= -2147483648.0f && a < 2147483648.0f )
+        { return static_cast<s32>( a ); }
+        return static_cast<s32>( 0x80000000u );
+    }
+
+    static const u32 RsqrtIteration = ASDX_SIMD_SSE2 ? 1 : 3;   //!< Newton 法の反復回数です.
+};
+
+#if ASDX_SIMD_SSE2
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FastOps4 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FastOps4
+{
+    static const u32 Width = 4;
+    typedef __m128  Float;
+    typedef __m128i Int;
+
+    static Float Load       ( const f32* p )                    { return _mm_loadu_ps( p ); }
+    static void  Store      ( f32* p, Float v )                 { _mm_storeu_ps( p, v ); }
+    static Float Set        ( f32 v )                           { return _mm_set1_ps( v ); }
+    static Int   SetInt     ( s32 v )                           { return _mm_set1_epi32( v ); }
+    static Float Add        ( Float a, Float b )                { return _mm_add_ps( a, b ); }
+    static Float Sub        ( Float a, Float b )                { return _mm_sub_ps( a, b ); }
+    static Float Mul        ( Float a, Float b )                { return _mm_mul_ps( a, b ); }
+    static Float Div        ( Float a, Float b )                { return _mm_div_ps( a, b ); }
+    static Float MulAdd     ( Float a, Float b, Float c )       { return simd::MulAdd( a, b, c ); }
+    static Float Min        ( Float a, Float b )                { return _mm_min_ps( a, b ); }
+    static Float Max        ( Float a, Float b )                { return _mm_max_ps( a, b ); }
+    static Float Sqrt       ( Float a )                         { return _mm_sqrt_ps( a ); }
+    static Float Rsqrt      ( Float a )                         { return _mm_rsqrt_ps( a ); }
+    static Float And        ( Float a, Float b )                { return _mm_and_ps( a, b ); }
+    static Float AndNot     ( Float a, Float b )                { return _mm_andnot_ps( b, a ); }
+    static Float Or         ( Float a, Float b )                { return _mm_or_ps( a, b ); }
+    static Float Xor        ( Float a, Float b )                { return _mm_xor_ps( a, b ); }
+    static Float CmpLT      ( Float a, Float b )                { return _mm_cmplt_ps( a, b ); }
+    static Float CmpLE      ( Float a, Float b )                { return _mm_cmple_ps( a, b ); }
+    static Float CmpGT      ( Float a, Float b )                { return _mm_cmpgt_ps( a, b ); }
+    static Float CmpEQ      ( Float a, Float b )                { return _mm_cmpeq_ps( a, b ); }
+    static Float Select     ( Float m, Float a, Float b )       { return _mm_or_ps( _mm_and_ps( m, a ), _mm_andnot_ps( m, b ) ); }
+    static Int   ToInt      ( Float a )                         { return _mm_cvttps_epi32( a ); }
+    static Float ToFloat    ( Int a )                           { return _mm_cvtepi32_ps( a ); }
+    static Int   CastInt    ( Float a )                         { return _mm_castps_si128( a ); }
+    static Float CastFloat  ( Int a )                           { return _mm_castsi128_ps( a ); }
+    static Int   AddInt     ( Int a, Int b )                    { return _mm_add_epi32( a, b ); }
+    static Int   SubInt     ( Int a, Int b )                    { return _mm_sub_epi32( a, b ); }
+    static Int   AndInt     ( Int a, Int b )                    { return _mm_and_si128( a, b ); }
+    static Int   OrInt      ( Int a, Int b )                    { return _mm_or_si128( a, b ); }
+    template<int N> static Int ShiftL( Int a )                  { return _mm_slli_epi32( a, N ); }
+    template<int N> static Int ShiftR( Int a )                  { return _mm_srai_epi32( a, N ); }
+
+    static const u32 RsqrtIteration = 1;
+};
+#endif//ASDX_SIMD_SSE2
+
+#if ASDX_SIMD_AVX2
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FastOps8 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FastOps8
+{
+    static const u32 Width = 8;
+    typedef __m256  Float;
+    typedef __m256i Int;
+
+    static Float Load       ( const f32* p )                    { return _mm256_loadu_ps( p ); }
+    static void  Store      ( f32* p, Float v )                 { _mm256_storeu_ps( p, v ); }
+    static Float Set        ( f32 v )                           { return _mm256_set1_ps( v ); }
+    static Int   SetInt     ( s32 v )                           { return _mm256_set1_epi32( v ); }
+    static Float Add        ( Float a, Float b )                { return _mm256_add_ps( a, b ); }
+    static Float Sub        ( Float a, Float b )                { return _mm256_sub_ps( a, b ); }
+    static Float Mul        ( Float a, Float b )                { return _mm256_mul_ps( a, b ); }
+    static Float Div        ( Float a, Float b )                { return _mm256_div_ps( a, b ); }
+    static Float MulAdd     ( Float a, Float b, Float c )       { return simd::MulAdd( a, b, c ); }
+    static Float Min        ( Float a, Float b )                { return _mm256_min_ps( a, b ); }
+    static Float Max        ( Float a, Float b )                { return _mm256_max_ps( a, b ); }
+    static Float Sqrt       ( Float a )                         { return _mm256_sqrt_ps( a ); }
+    static Float Rsqrt      ( Float a )                         { return _mm256_rsqrt_ps( a ); }
+    static Float And        ( Float a, Float b )                { return _mm256_and_ps( a, b ); }
+    static Float AndNot     ( Float a, Float b )                { return _mm256_andnot_ps( b, a ); }
+    static Float Or         ( Float a, Float b )                { return _mm256_or_ps( a, b ); }
+    static Float Xor        ( Float a, Float b )                { return _mm256_xor_ps( a, b ); }
+    static Float CmpLT      ( Float a, Float b )                { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+    static Float CmpLE      ( Float a, Float b )                { return _mm256_cmp_ps( a, b, _CMP_LE_OQ ); }
+    static Float CmpGT      ( Float a, Float b )                { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+    static Float CmpEQ      ( Float a, Float b )                { return _mm256_cmp_ps( a, b, _CMP_EQ_OQ ); }
+    static Float Select     ( Float m, Float a, Float b )       { return _mm256_blendv_ps( b, a, m ); }
+    static Int   ToInt      ( Float a )                         { return _mm256_cvttps_epi32( a ); }
+    static Float ToFloat    ( Int a )                           { return _mm256_cvtepi32_ps( a ); }
+    static Int   CastInt    ( Float a )                         { return _mm256_castps_si256( a ); }
+    static Float CastFloat  ( Int a )                           { return _mm256_castsi256_ps( a ); }
+    static Int   AddInt     ( Int a, Int b )                    { return _mm256_add_epi32( a, b ); }
+    static Int   SubInt     ( Int a, Int b )                    { return _mm256_sub_epi32( a, b ); }
+    static Int   AndInt     ( Int a, Int b )                    { return _mm256_and_si256( a, b ); }
+    static Int   OrInt      ( Int a, Int b )                    { return _mm256_or_si256( a, b ); }
+    template<int N> static Int ShiftL( Int a )                  { return _mm256_slli_epi32( a, N ); }
+    template<int N> static Int ShiftR( Int a )                  { return _mm256_srai_epi32( a, N ); }
+
+    static const u32 RsqrtIteration = 1;
+};
+#endif//ASDX_SIMD_AVX2
+
+//-------------------------------------------------------------------------------------------------
+// バッチ処理に使う最大幅の演算です.
+//-------------------------------------------------------------------------------------------------
+#if ASDX_SIMD_AVX2
+typedef FastOps8    FastOpsN;
+#elif ASDX_SIMD_SSE2
+typedef FastOps4    FastOpsN;
+#else
+typedef FastOps1    FastOpsN;
+#endif
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      最近接偶数に丸めます.
+//!
+//! @note       1.5 * 2^23 を加減算して丸めるため, 丸めモードに依存せず |x| < 2^22 で正しい値になります.
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float RoundKernel( typename Ops::Float x )
+{
+    auto magic = Ops::Set( 12582912.0f );
+    return Ops::Sub( Ops::Add( x, magic ), magic );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      符号ビットを取り出します.
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float SignBit( typename Ops::Float x )
+{ return Ops::And( x, Ops::Set( -0.0f ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      正弦と余弦を同時に求めます.
+//!
+//! @note       π/2 単位で引数を還元し, [-π/4, π/4] の多項式で近似します (係数は Cephes による).
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+void SinCosKernel( typename Ops::Float x, typename Ops::Float& s, typename Ops::Float& c )
+{
+    // π/2 を3つに分けて還元誤差を抑える (Cody-Waite).
+    auto q  = RoundKernel<Ops>( Ops::Mul( x, Ops::Set( 0.63661977236758134f ) ) );
+    auto r  = Ops::MulAdd( q, Ops::Set( -1.5703125f ), x );
+    r = Ops::MulAdd( q, Ops::Set( -4.837512969970703125e-4f ), r );
+    r = Ops::MulAdd( q, Ops::Set( -7.54978995489188216e-8f ), r );
+
+    auto z  = Ops::Mul( r, r );
+    auto sp = Ops::MulAdd( Ops::Set( -1.9515295891e-4f ), z, Ops::Set( 8.3321608736e-3f ) );
+    sp = Ops::MulAdd( sp, z, Ops::Set( -1.6666654611e-1f ) );
+    sp = Ops::MulAdd( Ops::Mul( sp, z ), r, r );
+
+    auto cp = Ops::MulAdd( Ops::Set( 2.443315711809948e-5f ), z, Ops::Set( -1.388731625493765e-3f ) );
+    cp = Ops::MulAdd( cp, z, Ops::Set( 4.166664568298827e-2f ) );
+    cp = Ops::MulAdd( Ops::Mul( cp, z ), z, Ops::MulAdd( Ops::Set( -0.5f ), z, Ops::Set( 1.0f ) ) );
+
+    // 象限に応じて入れ替えと符号反転を行う.
+    auto qi   = Ops::ToInt( q );
+    auto one  = Ops::SetInt( 1 );
+    auto two  = Ops::SetInt( 2 );
+    auto swap = Ops::CastFloat( Ops::SubInt( Ops::SetInt( 0 ), Ops::AndInt( qi, one ) ) );
+    auto sinSign = Ops::CastFloat( Ops::template ShiftL<30>( Ops::AndInt( qi, two ) ) );
+    auto cosSign = Ops::CastFloat( Ops::template ShiftL<30>( Ops::AndInt( Ops::AddInt( qi, one ), two ) ) );
+
+    s = Ops::Xor( Ops::Select( swap, cp, sp ), sinSign );
+    c = Ops::Xor( Ops::Select( swap, sp, cp ), cosSign );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      逆余弦を求めます.
+//!
+//! @note       |x| > 0.5 では acos(x) = 2 * asin(sqrt((1 - |x|) / 2)) を使います (係数は Cephes による).
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float AcosKernel( typename Ops::Float x )
+{
+    auto half = Ops::Set( 0.5f );
+
+    // NaN は Max() で -1 になり π を返す.
+    x = Ops::Min( Ops::Max( x, Ops::Set( -1.0f ) ), Ops::Set( 1.0f ) );
+
+    auto sign = SignBit<Ops>( x );
+    auto a    = Ops::Xor( x, sign );
+    auto big  = Ops::CmpGT( a, half );
+    auto z    = Ops::Select( big, Ops::Mul( half, Ops::Sub( Ops::Set( 1.0f ), a ) ), Ops::Mul( a, a ) );
+    auto s    = Ops::Select( big, Ops::Sqrt( z ), a );
+
+    // p = asin(s).
+    auto p = Ops::MulAdd( Ops::Set( 4.2163199048e-2f ), z, Ops::Set( 2.4181311049e-2f ) );
+    p = Ops::MulAdd( p, z, Ops::Set( 4.5470025998e-2f ) );
+    p = Ops::MulAdd( p, z, Ops::Set( 7.4953002686e-2f ) );
+    p = Ops::MulAdd( p, z, Ops::Set( 1.6666752422e-1f ) );
+    p = Ops::MulAdd( Ops::Mul( p, z ), s, s );
+
+    // |x| <= 0.5 : π/2 - asin(x),  x > 0.5 : 2p,  x < -0.5 : π - 2p.
+    auto small   = Ops::Sub( Ops::Set( 1.57079632679489662f ), Ops::Xor( p, sign ) );
+    auto twice   = Ops::Add( p, p );
+    auto largeV  = Ops::Select( Ops::CmpLT( x, Ops::Set( 0.0f ) ), Ops::Sub( Ops::Set( 3.14159265358979324f ), twice ), twice );
+    return Ops::Select( big, largeV, small );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      逆正接を求めます (係数は Cephes による).
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float AtanKernel( typename Ops::Float x )
+{
+    auto sign = SignBit<Ops>( x );
+    auto a    = Ops::Xor( x, sign );
+    auto one  = Ops::Set( 1.0f );
+
+    // tan(3π/8) より大きければ π/2 - atan(1/a), tan(π/8) より大きければ π/4 + atan((a-1)/(a+1)).
+    auto big  = Ops::CmpGT( a, Ops::Set( 2.414213562373095f ) );
+    auto mid  = Ops::CmpGT( a, Ops::Set( 0.4142135623730950f ) );
+    auto t    = Ops::Select( big, Ops::Div( Ops::Set( -1.0f ), a ), Ops::Select( mid, Ops::Div( Ops::Sub( a, one ), Ops::Add( a, one ) ), a ) );
+    auto y0   = Ops::Select( big, Ops::Set( 1.57079632679489662f ), Ops::And( mid, Ops::Set( 0.78539816339744831f ) ) );
+
+    auto z = Ops::Mul( t, t );
+    auto p = Ops::MulAdd( Ops::Set( 8.05374449538e-2f ), z, Ops::Set( -1.38776856032e-1f ) );
+    p = Ops::MulAdd( p, z, Ops::Set( 1.99777106478e-1f ) );
+    p = Ops::MulAdd( p, z, Ops::Set( -3.33329491539e-1f ) );
+    p = Ops::MulAdd( Ops::Mul( p, z ), t, t );
+
+    return Ops::Xor( Ops::Add( y0, p ), sign );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2引数の逆正接を求めます.
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float Atan2Kernel( typename Ops::Float y, typename Ops::Float x )
+{
+    auto zero = Ops::Set( 0.0f );
+    auto both = Ops::And( Ops::CmpEQ( x, zero ), Ops::CmpEQ( y, zero ) );
+    auto r    = AtanKernel<Ops>( Ops::Select( both, zero, Ops::Div( y, x ) ) );
+
+    // x < 0 なら y の符号に合わせて ±π を加える.
+    auto pi = Ops::Or( Ops::Set( 3.14159265358979324f ), SignBit<Ops>( y ) );
+    return Ops::Add( r, Ops::And( Ops::CmpLT( x, zero ), pi ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2の累乗を求めます.
+//!
+//! @note       x = n + f (|f| <= 0.5) に分けて, 2^f を多項式で近似して指数部に n を足します (係数は Cephes による).
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float Exp2Kernel( typename Ops::Float x )
+{
+    // n が 128 に丸められると指数部があふれるので 127.5 より僅かに小さい値で飽和させる.
+    // NaN は Max() で -126 になるので, 元の値を残して最後に戻す.
+    auto input = x;
+    auto under = Ops::CmpLT( x, Ops::Set( -126.0f ) );
+    x = Ops::Min( Ops::Max( x, Ops::Set( -126.0f ) ), Ops::Set( 127.49999f ) );
+
+    auto n = RoundKernel<Ops>( x );
+    auto f = Ops::Sub( x, n );
+
+    auto p = Ops::MulAdd( Ops::Set( 1.535336188319500e-4f ), f, Ops::Set( 1.339887440266574e-3f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 9.618437357674640e-3f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 5.550332471162809e-2f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 2.402264791363012e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 6.931472028550421e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 1.0f ) );
+
+    auto scale  = Ops::CastFloat( Ops::template ShiftL<23>( Ops::AddInt( Ops::ToInt( n ), Ops::SetInt( 127 ) ) ) );
+    auto result = Ops::AndNot( Ops::Mul( p, scale ), under );
+    return Ops::Select( Ops::CmpEQ( input, input ), result, input );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2を底とする対数を求めます.
+//!
+//! @note       x = 2^e * m (√0.5 <= m < √2) に分けて, log(m) を多項式で近似します (係数は Cephes による).
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float Log2Kernel( typename Ops::Float x )
+{
+    auto bits = Ops::CastInt( x );
+    auto e    = Ops::SubInt( Ops::template ShiftR<23>( bits ), Ops::SetInt( 127 ) );
+    auto m    = Ops::CastFloat( Ops::OrInt( Ops::AndInt( bits, Ops::SetInt( 0x007FFFFF ) ), Ops::SetInt( 0x3F800000 ) ) );
+
+    // 比較結果は全ビット 1 (= -1) なので, 引くと指数が 1 増える.
+    auto big = Ops::CmpGT( m, Ops::Set( 1.41421356237309505f ) );
+    m = Ops::Select( big, Ops::Mul( m, Ops::Set( 0.5f ) ), m );
+    e = Ops::SubInt( e, Ops::CastInt( big ) );
+
+    auto f = Ops::Sub( m, Ops::Set( 1.0f ) );
+    auto z = Ops::Mul( f, f );
+    auto p = Ops::MulAdd( Ops::Set( 7.0376836292e-2f ), f, Ops::Set( -1.1514610310e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 1.1676998740e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( -1.2420140846e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 1.4249322787e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( -1.6668057665e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 2.0000714765e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( -2.4999993993e-1f ) );
+    p = Ops::MulAdd( p, f, Ops::Set( 3.3333331174e-1f ) );
+    p = Ops::Mul( Ops::Mul( p, f ), z );
+    p = Ops::MulAdd( Ops::Set( -0.5f ), z, p );
+
+    // log2(m) = (f + p) * log2(e). f の項を分けて丸め誤差を抑える.
+    auto log2e  = Ops::Set( 1.44269504088896341f );
+    auto result = Ops::Add( Ops::MulAdd( p, log2e, Ops::Mul( f, log2e ) ), Ops::ToFloat( e ) );
+
+    auto zero = Ops::Set( 0.0f );
+    auto inf  = Ops::Set( std::numeric_limits<f32>::infinity() );
+    result = Ops::Select( Ops::CmpEQ( x, zero ), Ops::Set( -std::numeric_limits<f32>::infinity() ), result );
+    result = Ops::Select( Ops::CmpEQ( x, inf ), inf, result );
+    result = Ops::Select( Ops::CmpLT( x, zero ), Ops::Set( std::numeric_limits<f32>::quiet_NaN() ), result );
+
+    // NaN は指数部が 255 なので約 128.6 になってしまう. 入力をそのまま返す.
+    return Ops::Select( Ops::CmpEQ( x, x ), result, x );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      累乗を求めます.
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float PowKernel( typename Ops::Float x, typename Ops::Float y )
+{
+    auto zero = Ops::Set( 0.0f );
+    auto sign = SignBit<Ops>( x );
+
+    // |x|^y を求める. log2(0) = -∞ なので y > 0 なら Exp2Kernel() が 0 を返す.
+    auto r = Exp2Kernel<Ops>( Ops::Mul( y, Log2Kernel<Ops>( Ops::Xor( x, sign ) ) ) );
+
+    // 負の底は y が整数のときだけ定義でき, 奇数なら符号が反転する.
+    // |y| >= 2^24 は全て偶数なので, その範囲に丸めてから整数に変換する.
+    auto limit = Ops::Set( 16777216.0f );
+    auto yc    = Ops::Min( Ops::Max( y, Ops::Sub( zero, limit ) ), limit );
+    auto yi    = Ops::ToInt( yc );
+    auto isInt = Ops::CmpEQ( Ops::ToFloat( yi ), yc );
+    auto odd   = Ops::CastFloat( Ops::template ShiftL<31>( yi ) );
+    auto neg   = Ops::Select( isInt, Ops::Xor( r, odd ), Ops::Set( std::numeric_limits<f32>::quiet_NaN() ) );
+    r = Ops::Select( Ops::CmpLT( x, zero ), neg, r );
+
+    // 0^y (y < 0) は Exp2Kernel() では飽和してしまうので +∞ にする. x^0 は NaN を含めて 1 とする.
+    auto pole = Ops::And( Ops::CmpEQ( x, zero ), Ops::CmpLT( y, zero ) );
+    r = Ops::Select( pole, Ops::Set( std::numeric_limits<f32>::infinity() ), r );
+    return Ops::Select( Ops::CmpEQ( y, zero ), Ops::Set( 1.0f ), r );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      平方根の逆数を求めます.
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float RsqrtKernel( typename Ops::Float x )
+{
+    // Newton 法 : r' = r * (1.5 - 0.5 * x * r^2).
+    auto r  = Ops::Rsqrt( x );
+    auto hx = Ops::Mul( x, Ops::Set( 0.5f ) );
+    for( u32 i=0; i<Ops::RsqrtIteration; ++i )
+    { r = Ops::Mul( r, Ops::Sub( Ops::Set( 1.5f ), Ops::Mul( hx, Ops::Mul( r, r ) ) ) ); }
+    return r;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      1入力1出力の関数を配列に適用します.
+//-------------------------------------------------------------------------------------------------
+template<typename Func1, typename FuncN>
+void ApplyStream( const f32* pInput, u32 count, f32* pOutput, Func1 func1, FuncN funcN )
+{
+    u32 i = 0;
+    for( ; i + FastOpsN::Width <= count; i += FastOpsN::Width )
+    { FastOpsN::Store( pOutput + i, funcN( FastOpsN::Load( pInput + i ) ) ); }
+    for( ; i<count; ++i )
+    { pOutput[i] = func1( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2入力1出力の関数を配列に適用します.
+//-------------------------------------------------------------------------------------------------
+template<typename Func1, typename FuncN>
+void ApplyStream( const f32* pInput0, const f32* pInput1, u32 count, f32* pOutput, Func1 func1, FuncN funcN )
+{
+    u32 i = 0;
+    for( ; i + FastOpsN::Width <= count; i += FastOpsN::Width )
+    { FastOpsN::Store( pOutput + i, funcN( FastOpsN::Load( pInput0 + i ), FastOpsN::Load( pInput1 + i ) ) ); }
+    for( ; i<count; ++i )
+    { pOutput[i] = func1( pInput0[i], pInput1[i] ); }
+}
+
+} // namespace detail
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      正弦の近似値を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 FastSin( f32 x )
+{
+    f32 s, c;
+    detail::SinCosKernel<detail::FastOps1>( x, s, c );
+    return s;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      余弦の近似値を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 FastCos( f32 x )
+{
+    f32 s, c;
+    detail::SinCosKernel<detail::FastOps1>( x, s, c );
+    return c;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      正弦と余弦の近似値を同時に求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastSinCos( f32 x, f32& s, f32& c )
+{ detail::SinCosKernel<detail::FastOps1>( x, s, c ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      逆余弦の近似値を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 FastAcos( f32 x )
+{ return detail::AcosKernel<detail::FastOps1>( x ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2引数の逆正接の近似値を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 FastAtan2( f32 y, f32 x )
+{ return detail::Atan2Kernel<detail::FastOps1>( y, x ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2の累乗の近似値を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 FastExp2( f32 x )
+{ return detail::Exp2Kernel<detail::FastOps1>( x ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2を底とする対数の近似値を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 FastLog2( f32 x )
+{ return detail::Log2Kernel<detail::FastOps1>( x ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      累乗の近似値を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 FastPow( f32 x, f32 y )
+{ return detail::PowKernel<detail::FastOps1>( x, y ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      平方根の逆数の近似値を求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 FastRsqrt( f32 x )
+{ return detail::RsqrtKernel<detail::FastOps1>( x ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の正弦の近似値を求めます.
+//!
+//! @param [in]     pInput      入力配列.
+//! @param [in]     count       要素数.
+//! @param [out]    pOutput     出力配列. pInput と同じでも構いません.
+//! @note       AVX2 が有効なら8要素, SSE2 なら4要素ずつ処理します. 端数はスカラー版で処理します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastSinStream( const f32* pInput, u32 count, f32* pOutput )
+{
+    typedef detail::FastOpsN::Float FloatN;
+    detail::ApplyStream( pInput, count, pOutput,
+        []( f32 x )    { return FastSin( x ); },
+        []( FloatN x ) { FloatN s, c; detail::SinCosKernel<detail::FastOpsN>( x, s, c ); return s; } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の余弦の近似値を求めます.
+//!
+//! @note       引数は FastSinStream() と同じです.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastCosStream( const f32* pInput, u32 count, f32* pOutput )
+{
+    typedef detail::FastOpsN::Float FloatN;
+    detail::ApplyStream( pInput, count, pOutput,
+        []( f32 x )    { return FastCos( x ); },
+        []( FloatN x ) { FloatN s, c; detail::SinCosKernel<detail::FastOpsN>( x, s, c ); return c; } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の正弦と余弦の近似値を同時に求めます.
+//!
+//! @param [in]     pInput      入力配列.
+//! @param [in]     count       要素数.
+//! @param [out]    pSin        正弦の出力配列.
+//! @param [out]    pCos        余弦の出力配列.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastSinCosStream( const f32* pInput, u32 count, f32* pSin, f32* pCos )
+{
+    typedef detail::FastOpsN Ops;
+    u32 i = 0;
+    for( ; i + Ops::Width <= count; i += Ops::Width )
+    {
+        Ops::Float s, c;
+        detail::SinCosKernel<Ops>( Ops::Load( pInput + i ), s, c );
+        Ops::Store( pSin + i, s );
+        Ops::Store( pCos + i, c );
+    }
+    for( ; i<count; ++i )
+    { FastSinCos( pInput[i], pSin[i], pCos[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の逆余弦の近似値を求めます.
+//!
+//! @note       引数は FastSinStream() と同じです.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastAcosStream( const f32* pInput, u32 count, f32* pOutput )
+{
+    typedef detail::FastOpsN::Float FloatN;
+    detail::ApplyStream( pInput, count, pOutput,
+        []( f32 x )    { return FastAcos( x ); },
+        []( FloatN x ) { return detail::AcosKernel<detail::FastOpsN>( x ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の2引数の逆正接の近似値を求めます.
+//!
+//! @param [in]     pY          y の配列.
+//! @param [in]     pX          x の配列.
+//! @param [in]     count       要素数.
+//! @param [out]    pOutput     出力配列.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastAtan2Stream( const f32* pY, const f32* pX, u32 count, f32* pOutput )
+{
+    typedef detail::FastOpsN::Float FloatN;
+    detail::ApplyStream( pY, pX, count, pOutput,
+        []( f32 y, f32 x )       { return FastAtan2( y, x ); },
+        []( FloatN y, FloatN x ) { return detail::Atan2Kernel<detail::FastOpsN>( y, x ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の2の累乗の近似値を求めます.
+//!
+//! @note       引数は FastSinStream() と同じです.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastExp2Stream( const f32* pInput, u32 count, f32* pOutput )
+{
+    typedef detail::FastOpsN::Float FloatN;
+    detail::ApplyStream( pInput, count, pOutput,
+        []( f32 x )    { return FastExp2( x ); },
+        []( FloatN x ) { return detail::Exp2Kernel<detail::FastOpsN>( x ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の2を底とする対数の近似値を求めます.
+//!
+//! @note       引数は FastSinStream() と同じです.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastLog2Stream( const f32* pInput, u32 count, f32* pOutput )
+{
+    typedef detail::FastOpsN::Float FloatN;
+    detail::ApplyStream( pInput, count, pOutput,
+        []( f32 x )    { return FastLog2( x ); },
+        []( FloatN x ) { return detail::Log2Kernel<detail::FastOpsN>( x ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の累乗の近似値を求めます.
+//!
+//! @param [in]     pX          底の配列.
+//! @param [in]     pY          指数の配列.
+//! @param [in]     count       要素数.
+//! @param [out]    pOutput     出力配列.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastPowStream( const f32* pX, const f32* pY, u32 count, f32* pOutput )
+{
+    typedef detail::FastOpsN::Float FloatN;
+    detail::ApplyStream( pX, pY, count, pOutput,
+        []( f32 x, f32 y )       { return FastPow( x, y ); },
+        []( FloatN x, FloatN y ) { return detail::PowKernel<detail::FastOpsN>( x, y ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      配列の平方根の逆数の近似値を求めます.
+//!
+//! @note       引数は FastSinStream() と同じです.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FastRsqrtStream( const f32* pInput, u32 count, f32* pOutput )
+{
+    typedef detail::FastOpsN::Float FloatN;
+    detail::ApplyStream( pInput, count, pOutput,
+        []( f32 x )    { return FastRsqrt( x ); },
+        []( FloatN x ) { return detail::RsqrtKernel<detail::FastOpsN>( x ); } );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// ASDX_FAST_MATH で精度を切り替える関数です.
+//-------------------------------------------------------------------------------------------------
+#if ASDX_FAST_MATH
+ASDX_INLINE f32  Sin   ( f32 x )                    { return FastSin( x ); }
+ASDX_INLINE f32  Cos   ( f32 x )                    { return FastCos( x ); }
+ASDX_INLINE void SinCos( f32 x, f32& s, f32& c )    { FastSinCos( x, s, c ); }
+ASDX_INLINE f32  Acos  ( f32 x )                    { return FastAcos( x ); }
+ASDX_INLINE f32  Atan2 ( f32 y, f32 x )             { return FastAtan2( y, x ); }
+ASDX_INLINE f32  Exp2  ( f32 x )                    { return FastExp2( x ); }
+ASDX_INLINE f32  Log2  ( f32 x )                    { return FastLog2( x ); }
+ASDX_INLINE f32  Pow   ( f32 x, f32 y )             { return FastPow( x, y ); }
+ASDX_INLINE f32  Rsqrt ( f32 x )                    { return FastRsqrt( x ); }
+#else
+ASDX_INLINE f32  Sin   ( f32 x )                    { return sinf( x ); }
+ASDX_INLINE f32  Cos   ( f32 x )                    { return cosf( x ); }
+ASDX_INLINE void SinCos( f32 x, f32& s, f32& c )    { s = sinf( x ); c = cosf( x ); }
+ASDX_INLINE f32  Acos  ( f32 x )                    { return acosf( x ); }
+ASDX_INLINE f32  Atan2 ( f32 y, f32 x )             { return atan2f( y, x ); }
+ASDX_INLINE f32  Exp2  ( f32 x )                    { return exp2f( x ); }
+ASDX_INLINE f32  Log2  ( f32 x )                    { return log2f( x ); }
+ASDX_INLINE f32  Pow   ( f32 x, f32 y )             { return powf( x, y ); }
+ASDX_INLINE f32  Rsqrt ( f32 x )                    { return 1.0f / sqrtf( x ); }
+#endif
+
+} // namespace asdx
+
+#endif//__ASDX_FAST_MATH_H__
@@ -0,0 +1,476 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxFrameAllocator.h
+// Desc : Per-Frame Linear Allocator Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_FRAME_ALLOCATOR_H__
+#define __ASDX_FRAME_ALLOCATOR_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxMemoryTracker.h>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <cassert>
+
+#if ASDX_IS_WIN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameAllocatorStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FrameAllocatorStats
+{
+    u64     FrameBytes;         //!< 直前に完了したフレームで確保したバイト数です.
+    u64     PeakFrameBytes;     //!< 1フレームで確保したバイト数の最大値です.
+    u32     FrameChunks;        //!< 直前に完了したフレームで使用したチャンク数です.
+    u32     PeakFrameChunks;    //!< 1フレームで使用したチャンク数の最大値です.
+    u32     TotalChunks;        //!< OSから確保したチャンクの総数です.
+    u32     LargeAllocCount;    //!< チャンクに収まらず個別に確保した回数の累計です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameAllocator class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class FrameAllocator : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const size_t DefaultChunkSize = 64 * 1024;           //!< 既定のチャンクサイズです.
+    static const size_t HugePageSize     = 2 * 1024 * 1024;     //!< ヒュージページのサイズです.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    FrameAllocator()
+    : m_Id          ( GenerateId() )
+    , m_FrameCount  ( 0 )
+    , m_FrameIndex  ( 0 )
+    , m_Epoch       ( 1 )
+    , m_ChunkSize   ( 0 )
+    , m_UseHugePage ( false )
+    , m_Tag         ( MEMORY_TAG_OTHER )
+    {
+        memset( &m_Stats, 0, sizeof(m_Stats) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~FrameAllocator()
+    { Term(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param [in]     frameCount      バッファリングするフレーム数です. GPUが参照している可能性のあるフレーム数を指定します.
+    //! @param [in]     chunkSize       スレッドに割り当てるチャンクのサイズです.
+    //! @param [in]     useHugePage     ヒュージページを使用する場合は true を指定します(Linuxのみ).
+    //! @param [in]     tag             メモリ追跡に使用するタグです.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( u32 frameCount, size_t chunkSize = DefaultChunkSize, bool useHugePage = false, MEMORY_TAG tag = MEMORY_TAG_OTHER )
+    {
+        if ( frameCount == 0 || chunkSize == 0 )
+        { return false; }
+
+        Term();
+
+    #if ASDX_IS_WIN
+        // ラージページは特権が必要になるため使用しない.
+        useHugePage = false;
+    #endif
+
+        if ( useHugePage )
+        { chunkSize = ( chunkSize + HugePageSize - 1 ) & ~( HugePageSize - 1 ); }
+
+        m_Frames.reset( new Frame[frameCount] );
+        m_FrameCount  = frameCount;
+        m_FrameIndex  = 0;
+        m_ChunkSize   = chunkSize;
+        m_UseHugePage = useHugePage;
+        m_Tag         = tag;
+        m_Epoch++;
+
+        memset( &m_Stats, 0, sizeof(m_Stats) );
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //!
+    //! @note       GPUが全てのフレームの処理を完了してから呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    void Term()
+    {
+        for( u32 i=0; i<m_FrameCount; ++i )
+        { Recycle( m_Frames[i] ); }
+
+        for( size_t i=0; i<m_FreeChunks.size(); ++i )
+        { FreePages( m_FreeChunks[i], m_ChunkSize ); }
+
+        m_FreeChunks.clear();
+        m_Frames.reset();
+        m_FrameCount = 0;
+        m_Epoch++;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のフレームのメモリを確保します.
+    //!
+    //! @param [in]     size            確保するサイズです.
+    //! @param [in]     alignment       アライメントです. 2のべき乗を指定します.
+    //! @return     確保したメモリを返却します. 確保に失敗した場合は nullptr を返却します.
+    //! @note       確保したメモリは NextFrame() をフレーム数回呼び出すまで有効です.
+    //!             個別に解放する必要はありません. 複数スレッドから同時に呼び出せます.
+    //---------------------------------------------------------------------------------------------
+    void* Alloc( size_t size, size_t alignment = 16 )
+    {
+        assert( m_FrameCount > 0 );
+        assert( ( alignment & ( alignment - 1 ) ) == 0 );
+
+        auto& frame = m_Frames[m_FrameIndex];
+        auto& block = GetThreadBlock( m_Id );
+
+        // フレームが切り替わっていたら前のチャンクは使わない.
+        auto epoch = m_Epoch.load( std::memory_order_relaxed );
+        if ( block.Epoch != epoch )
+        {
+            block.Epoch = epoch;
+            block.Ptr   = nullptr;
+            block.End   = nullptr;
+        }
+
+        auto ptr = AlignUp( block.Ptr, alignment );
+        if ( block.Ptr == nullptr || ptr + size > block.End )
+        {
+            // チャンクに収まらないものは個別に確保する.
+            if ( size + alignment > m_ChunkSize )
+            { return AllocLarge( frame, size, alignment ); }
+
+            auto chunk = AcquireChunk( frame );
+            if ( chunk == nullptr )
+            { return nullptr; }
+
+            block.Ptr = chunk;
+            block.End = chunk + m_ChunkSize;
+            ptr = AlignUp( block.Ptr, alignment );
+        }
+
+        block.Ptr = ptr + size;
+        frame.Bytes.fetch_add( size, std::memory_order_relaxed );
+
+        return ptr;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のフレームの配列を確保します.
+    //!
+    //! @param [in]     count           要素数です.
+    //! @return     確保した配列を返却します. コンストラクタは呼び出されません.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(T)
+    T* AllocArray( size_t count )
+    { return static_cast<T*>( Alloc( sizeof(T) * count, alignof(T) ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      次のフレームに切り替えます.
+    //!
+    //! @note       フレーム数前に確保したメモリが再利用されるので，GPUがそのフレームの処理を
+    //!             完了してから呼び出してください. Alloc() と同時に呼び出してはいけません.
+    //---------------------------------------------------------------------------------------------
+    void NextFrame()
+    {
+        assert( m_FrameCount > 0 );
+
+        // 完了したフレームの統計を更新.
+        {
+            auto& frame = m_Frames[m_FrameIndex];
+            auto  bytes = frame.Bytes.load( std::memory_order_relaxed );
+            auto  count = static_cast<u32>( frame.Chunks.size() );
+
+            m_Stats.FrameBytes  = bytes;
+            m_Stats.FrameChunks = count;
+            if ( bytes > m_Stats.PeakFrameBytes )
+            { m_Stats.PeakFrameBytes = bytes; }
+            if ( count > m_Stats.PeakFrameChunks )
+            { m_Stats.PeakFrameChunks = count; }
+        }
+
+        m_FrameIndex = ( m_FrameIndex + 1 ) % m_FrameCount;
+        m_Epoch.fetch_add( 1, std::memory_order_relaxed );
+
+        // 再利用するフレームのチャンクをプールに戻す.
+        Recycle( m_Frames[m_FrameIndex] );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //!
+    //! @return     統計情報を返却します.
+    //---------------------------------------------------------------------------------------------
+    const FrameAllocatorStats& GetStats() const
+    { return m_Stats; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のフレームで確保したバイト数を取得します.
+    //!
+    //! @return     現在のフレームで確保したバイト数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetCurrentFrameBytes() const
+    { return m_Frames[m_FrameIndex].Bytes.load( std::memory_order_relaxed ); }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    struct Large
+    {
+        u8*     Ptr;        //!< 確保したメモリです.
+        size_t  Size;       //!< 確保したサイズです.
+    };
+
+    struct Frame
+    {
+        std::vector<u8*>    Chunks;     //!< このフレームで使用したチャンクです.
+        std::vector<Large>  Larges;     //!< このフレームで個別に確保したメモリです.
+        std::atomic<u64>    Bytes;      //!< このフレームで確保したバイト数です.
+
+        Frame()
+        : Bytes( 0 )
+        { /* DO_NOTHING */ }
+    };
+
+    struct ThreadBlock
+    {
+        u64     Owner;      //!< 所有しているアロケータのIDです.
+        u64     Epoch;      //!< 割り当て時のエポックです.
+        u8*     Ptr;        //!< 次に確保する位置です.
+        u8*     End;        //!< チャンクの終端です.
+    };
+
+    static const u32 ThreadBlockCount = 4;      //!< スレッドごとに保持するブロック数です.
+
+    u64                         m_Id;           //!< アロケータのIDです.
+    std::unique_ptr<Frame[]>    m_Frames;       //!< フレームです.
+    u32                         m_FrameCount;   //!< フレーム数です.
+    u32                         m_FrameIndex;   //!< 現在のフレーム番号です.
+    std::atomic<u64>            m_Epoch;        //!< フレームを切り替えるたびに進むエポックです.
+    size_t                      m_ChunkSize;    //!< チャンクサイズです.
+    bool                        m_UseHugePage;  //!< ヒュージページを使用するかどうか.
+    MEMORY_TAG                  m_Tag;          //!< メモリ追跡に使用するタグです.
+    std::vector<u8*>            m_FreeChunks;   //!< 共有のチャンクプールです.
+    std::mutex                  m_Mutex;        //!< チャンクプールとフレームのリストを保護します.
+    FrameAllocatorStats         m_Stats;        //!< 統計情報です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アロケータのIDを生成します.
+    //---------------------------------------------------------------------------------------------
+    static u64 GenerateId()
+    {
+        static std::atomic<u64> s_Counter( 0 );
+        return ++s_Counter;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      呼び出しスレッドのブロックを取得します.
+    //---------------------------------------------------------------------------------------------
+    static ThreadBlock& GetThreadBlock( u64 owner )
+    {
+        thread_local ThreadBlock s_Blocks[ThreadBlockCount] = {};
+        thread_local u32         s_Next = 0;
+
+        for( u32 i=0; i<ThreadBlockCount; ++i )
+        {
+            if ( s_Blocks[i].Owner == owner )
+            { return s_Blocks[i]; }
+        }
+
+        // 見つからなければ順番に使いまわす.
+        auto& block = s_Blocks[s_Next];
+        s_Next = ( s_Next + 1 ) % ThreadBlockCount;
+
+        block.Owner = owner;
+        block.Epoch = 0;
+        block.Ptr   = nullptr;
+        block.End   = nullptr;
+        return block;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アライメントを揃えます.
+    //---------------------------------------------------------------------------------------------
+    static u8* AlignUp( u8* ptr, size_t alignment )
+    {
+        auto value = reinterpret_cast<size_t>( ptr );
+        return reinterpret_cast<u8*>( ( value + alignment - 1 ) & ~( alignment - 1 ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンクを取得し，フレームに登録します.
+    //---------------------------------------------------------------------------------------------
+    u8* AcquireChunk( Frame& frame )
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+
+        u8* chunk = nullptr;
+        if ( !m_FreeChunks.empty() )
+        {
+            chunk = m_FreeChunks.back();
+            m_FreeChunks.pop_back();
+        }
+        else
+        {
+            chunk = AllocPages( m_ChunkSize, m_UseHugePage );
+            if ( chunk == nullptr )
+            { return nullptr; }
+            m_Stats.TotalChunks++;
+        }
+
+        frame.Chunks.push_back( chunk );
+        return chunk;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      チャンクに収まらないメモリを確保します.
+    //---------------------------------------------------------------------------------------------
+    void* AllocLarge( Frame& frame, size_t size, size_t alignment )
+    {
+        // ページ境界に揃うので，ページサイズ以下のアライメントはそのまま満たされる.
+        assert( alignment <= 4096 );
+        ASDX_UNUSED_VAR( alignment );
+
+        auto ptr = AllocPages( size, false );
+        if ( ptr == nullptr )
+        { return nullptr; }
+
+        Large large;
+        large.Ptr  = ptr;
+        large.Size = size;
+
+        {
+            std::lock_guard<std::mutex> locker( m_Mutex );
+            frame.Larges.push_back( large );
+            m_Stats.LargeAllocCount++;
+        }
+
+        frame.Bytes.fetch_add( size, std::memory_order_relaxed );
+        return ptr;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      フレームのメモリをプールに戻します.
+    //---------------------------------------------------------------------------------------------
+    void Recycle( Frame& frame )
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+
+        m_FreeChunks.insert( m_FreeChunks.end(), frame.Chunks.begin(), frame.Chunks.end() );
+        frame.Chunks.clear();
+
+        for( size_t i=0; i<frame.Larges.size(); ++i )
+        { FreePages( frame.Larges[i].Ptr, frame.Larges[i].Size ); }
+        frame.Larges.clear();
+
+        frame.Bytes.store( 0, std::memory_order_relaxed );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ページ単位でメモリを確保し，メモリ追跡に記録します.
+    //---------------------------------------------------------------------------------------------
+    u8* AllocPages( size_t size, bool useHugePage )
+    {
+        auto ptr = AllocPagesOS( size, useHugePage );
+        if ( ptr != nullptr )
+        { MemoryTracker::Instance().OnAlloc( m_Tag, size ); }
+        return ptr;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ページ単位で確保したメモリを解放し，メモリ追跡に記録します.
+    //---------------------------------------------------------------------------------------------
+    void FreePages( u8* ptr, size_t size )
+    {
+        MemoryTracker::Instance().OnFree( m_Tag, size );
+        FreePagesOS( ptr, size );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      OSからページ単位でメモリを確保します.
+    //---------------------------------------------------------------------------------------------
+    static u8* AllocPagesOS( size_t size, bool useHugePage )
+    {
+    #if ASDX_IS_WIN
+        ASDX_UNUSED_VAR( useHugePage );
+        return static_cast<u8*>( VirtualAlloc( nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE ) );
+    #else
+        void* ptr = MAP_FAILED;
+
+        #if defined(MAP_HUGETLB)
+        if ( useHugePage )
+        { ptr = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 ); }
+        #endif
+
+        // 予約済みのヒュージページが無い場合は透過的ヒュージページを要求する.
+        if ( ptr == MAP_FAILED )
+        {
+            ptr = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+            if ( ptr == MAP_FAILED )
+            { return nullptr; }
+
+            #if defined(MADV_HUGEPAGE)
+            if ( useHugePage )
+            { madvise( ptr, size, MADV_HUGEPAGE ); }
+            #endif
+        }
+
+        return static_cast<u8*>( ptr );
+    #endif
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      OSから確保したメモリを解放します.
+    //---------------------------------------------------------------------------------------------
+    static void FreePagesOS( u8* ptr, size_t size )
+    {
+    #if ASDX_IS_WIN
+        ASDX_UNUSED_VAR( size );
+        VirtualFree( ptr, 0, MEM_RELEASE );
+    #else
+        munmap( ptr, size );
+    #endif
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_FRAME_ALLOCATOR_H__
@@ -0,0 +1,338 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxHandle.h
+// Desc : Generational Handle Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_HANDLE_H__
+#define __ASDX_HANDLE_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <vector>
+#include <utility>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Handle structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+ASDX_TEMPLATE(T)
+struct Handle
+{
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    u32     Index;          //!< プール内のスロット番号です.
+    u32     Generation;     //!< 世代番号です. 0 は無効なハンドルを表します.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Handle()
+    : Index     ( 0 )
+    , Generation( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param [in]     index       スロット番号.
+    //! @param [in]     generation  世代番号.
+    //---------------------------------------------------------------------------------------------
+    Handle( u32 index, u32 generation )
+    : Index     ( index )
+    , Generation( generation )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      nullハンドルかどうかチェックします.
+    //!
+    //! @retval true    nullハンドルです.
+    //! @retval false   プールから払い出されたハンドルです.
+    //! @note       破棄済みかどうかは HandlePool::IsValid() で判定してください.
+    //---------------------------------------------------------------------------------------------
+    bool IsNull() const
+    { return Generation == 0; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      等価演算子です.
+    //---------------------------------------------------------------------------------------------
+    bool operator == ( const Handle& value ) const
+    { return ( Index == value.Index ) && ( Generation == value.Generation ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      非等価演算子です.
+    //---------------------------------------------------------------------------------------------
+    bool operator != ( const Handle& value ) const
+    { return ( Index != value.Index ) || ( Generation != value.Generation ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HandlePool class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+ASDX_TEMPLATE(T)
+class HandlePool : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    typedef Handle<T>   HandleType;     //!< ハンドル型です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    HandlePool()
+    : m_FreeHead( InvalidIndex )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリを予約します.
+    //!
+    //! @param [in]     count       予約する要素数.
+    //---------------------------------------------------------------------------------------------
+    void Reserve( u32 count )
+    {
+        m_Objects.reserve( count );
+        m_Owners .reserve( count );
+        m_Slots  .reserve( count );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを追加します.
+    //!
+    //! @param [in]     value       追加するオブジェクト.
+    //! @return     追加したオブジェクトを参照するハンドルを返却します.
+    //---------------------------------------------------------------------------------------------
+    HandleType Create( T&& value )
+    {
+        auto index = AllocSlot();
+        m_Objects.push_back( std::move( value ) );
+        return HandleType( index, m_Slots[index].Generation );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを追加します.
+    //!
+    //! @param [in]     value       追加するオブジェクト.
+    //! @return     追加したオブジェクトを参照するハンドルを返却します.
+    //---------------------------------------------------------------------------------------------
+    HandleType Create( const T& value )
+    {
+        auto index = AllocSlot();
+        m_Objects.push_back( value );
+        return HandleType( index, m_Slots[index].Generation );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを破棄します.
+    //!
+    //! @param [in]     handle      破棄するオブジェクトのハンドル.
+    //! @retval true    破棄しました.
+    //! @retval false   ハンドルが無効でした.
+    //! @note       密な配列を保つため末尾の要素を空いた位置に移動します.
+    //---------------------------------------------------------------------------------------------
+    bool Destroy( HandleType handle )
+    {
+        if ( !IsValid( handle ) )
+        { return false; }
+
+        Slot& slot = m_Slots[handle.Index];
+        auto dense = slot.Dense;
+        auto last  = static_cast<u32>( m_Objects.size() - 1 );
+
+        if ( dense != last )
+        {
+            m_Objects[dense] = std::move( m_Objects[last] );
+            m_Owners [dense] = m_Owners[last];
+            m_Slots[m_Owners[dense]].Dense = dense;
+        }
+        m_Objects.pop_back();
+        m_Owners .pop_back();
+
+        // 世代を進めて古いハンドルを無効化する. 0 は無効値なので飛ばす.
+        slot.Generation++;
+        if ( slot.Generation == 0 )
+        { slot.Generation = 1; }
+
+        slot.Dense = m_FreeHead;
+        m_FreeHead = handle.Index;
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ハンドルが有効かどうかチェックします.
+    //!
+    //! @param [in]     handle      判定するハンドル.
+    //! @retval true    有効なハンドルです.
+    //! @retval false   nullハンドルまたは破棄済みのオブジェクトを参照しています.
+    //---------------------------------------------------------------------------------------------
+    bool IsValid( HandleType handle ) const
+    {
+        if ( handle.Index >= m_Slots.size() )
+        { return false; }
+
+        // 空きスロットの Dense はフリーリストの次を指すので, 所有者が一致するかも確認する.
+        // 破棄時に世代を進めるため, 空きスロットの世代は未発行のハンドルと一致し得る.
+        const Slot& slot = m_Slots[handle.Index];
+        return ( slot.Generation == handle.Generation )
+            && ( slot.Dense < m_Owners.size() )
+            && ( m_Owners[slot.Dense] == handle.Index );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを取得します.
+    //!
+    //! @param [in]     handle      取得するオブジェクトのハンドル.
+    //! @return     オブジェクトへのポインタを返却します. ハンドルが無効な場合は nullptr を返却します.
+    //! @note       返却したポインタは Create() / Destroy() を呼び出すまで有効です.
+    //---------------------------------------------------------------------------------------------
+    T* Get( HandleType handle )
+    {
+        if ( !IsValid( handle ) )
+        { return nullptr; }
+        return &m_Objects[m_Slots[handle.Index].Dense];
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを取得します.
+    //!
+    //! @param [in]     handle      取得するオブジェクトのハンドル.
+    //! @return     オブジェクトへのポインタを返却します. ハンドルが無効な場合は nullptr を返却します.
+    //---------------------------------------------------------------------------------------------
+    const T* Get( HandleType handle ) const
+    {
+        if ( !IsValid( handle ) )
+        { return nullptr; }
+        return &m_Objects[m_Slots[handle.Index].Dense];
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全てのオブジェクトを破棄します.
+    //!
+    //! @note       発行済みのハンドルは全て無効になります.
+    //---------------------------------------------------------------------------------------------
+    void Clear()
+    {
+        for( u32 i=0; i<m_Owners.size(); ++i )
+        {
+            auto index = m_Owners[i];
+            Slot& slot = m_Slots[index];
+
+            slot.Generation++;
+            if ( slot.Generation == 0 )
+            { slot.Generation = 1; }
+
+            slot.Dense = m_FreeHead;
+            m_FreeHead = index;
+        }
+
+        m_Objects.clear();
+        m_Owners .clear();
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      有効なオブジェクト数を取得します.
+    //!
+    //! @return     有効なオブジェクト数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetCount() const
+    { return static_cast<u32>( m_Objects.size() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      密に格納されたオブジェクトの先頭を取得します.
+    //!
+    //! @return     オブジェクト配列の先頭ポインタを返却します.
+    //! @note       全要素の走査は GetData() から GetCount() 個を順に処理してください.
+    //---------------------------------------------------------------------------------------------
+    T* GetData()
+    { return m_Objects.data(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      密に格納されたオブジェクトの先頭を取得します.
+    //!
+    //! @return     オブジェクト配列の先頭ポインタを返却します.
+    //---------------------------------------------------------------------------------------------
+    const T* GetData() const
+    { return m_Objects.data(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      密な配列の位置からハンドルを取得します.
+    //!
+    //! @param [in]     dense       GetData() 上の位置.
+    //! @return     その位置のオブジェクトを参照するハンドルを返却します.
+    //---------------------------------------------------------------------------------------------
+    HandleType GetHandle( u32 dense ) const
+    {
+        assert( dense < m_Owners.size() );
+        auto index = m_Owners[dense];
+        return HandleType( index, m_Slots[index].Generation );
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    static const u32 InvalidIndex = 0xffffffff;
+
+    struct Slot
+    {
+        u32 Dense;          //!< 密な配列上の位置です(未使用時はフリーリストの次のスロット).
+        u32 Generation;     //!< 世代番号です.
+    };
+
+    std::vector<T>      m_Objects;      //!< 密に格納したオブジェクトです.
+    std::vector<u32>    m_Owners;       //!< 密な配列の各要素を所有するスロット番号です.
+    std::vector<Slot>   m_Slots;        //!< スロットです.
+    u32                 m_FreeHead;     //!< フリーリストの先頭です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      スロットを確保し，密な配列の末尾に割り当てます.
+    //---------------------------------------------------------------------------------------------
+    u32 AllocSlot()
+    {
+        u32 index = m_FreeHead;
+        if ( index != InvalidIndex )
+        { m_FreeHead = m_Slots[index].Dense; }
+        else
+        {
+            index = static_cast<u32>( m_Slots.size() );
+            Slot slot;
+            slot.Generation = 1;
+            m_Slots.push_back( slot );
+        }
+
+        m_Slots[index].Dense = static_cast<u32>( m_Objects.size() );
+        m_Owners.push_back( index );
+
+        return index;
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_HANDLE_H__
@@ -0,0 +1,682 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxIntersection.h
+// Desc : Packet Intersection Kernels.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_INTERSECTION_H__
+#define __ASDX_INTERSECTION_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxBoundingVolume.h>
+#include <asdxSimd.h>
+#include <limits>
+#include <cstdint>
+
+
+namespace asdx {
+namespace detail {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      値を確定させ, 前後の演算が FMA に縮約されないようにします.
+//!
+//! @note       辺関数は隣接する三角形で符号が正確に反転する必要があるため,
+//!             片方の積だけが丸められずに融合されると水密性が崩れます.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+inline T Settle( T value )
+{
+#if defined(__GNUC__) && ASDX_SIMD_SSE2
+    __asm__( "" : "+x"( value ) );
+#endif
+    return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LaneOps1 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct LaneOps1
+{
+    static const u32 Width = 1;
+    typedef f32  Float;
+    typedef bool Mask;
+
+    static Float Load   ( const f32* p )            { return *p; }
+    static Mask  LoadMask( const u32* p )           { return *p != 0; }
+    static void  Store  ( f32* p, Float v )         { *p = v; }
+    static Float Set    ( f32 v )                   { return v; }
+    static Float Add    ( Float a, Float b )        { return a + b; }
+    static Float Sub    ( Float a, Float b )        { return a - b; }
+    static Float Mul    ( Float a, Float b )        { return a * b; }
+    static Float Div    ( Float a, Float b )        { return a / b; }
+    static Float Min    ( Float a, Float b )        { return ( a < b ) ? a : b; }
+    static Float Max    ( Float a, Float b )        { return ( a > b ) ? a : b; }
+    static Mask  CmpLT  ( Float a, Float b )        { return a <  b; }
+    static Mask  CmpLE  ( Float a, Float b )        { return a <= b; }
+    static Mask  CmpGT  ( Float a, Float b )        { return a >  b; }
+    static Mask  CmpNE  ( Float a, Float b )        { return a != b; }
+    static Mask  And    ( Mask a, Mask b )          { return a && b; }
+    static Mask  Or     ( Mask a, Mask b )          { return a || b; }
+    static Mask  AndNot ( Mask a, Mask b )          { return a && !b; }
+    static Float Select ( Mask m, Float a, Float b ) { return m ? a : b; }
+    static u32   MoveMask( Mask m )                 { return m ? 1u : 0u; }
+};
+
+#if ASDX_SIMD_SSE2
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LaneOps4 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct LaneOps4
+{
+    static const u32 Width = 4;
+    typedef __m128 Float;
+    typedef __m128 Mask;
+
+    static Float Load   ( const f32* p )            { return _mm_load_ps( p ); }
+    static Mask  LoadMask( const u32* p )           { return _mm_load_ps( reinterpret_cast<const f32*>( p ) ); }
+    static void  Store  ( f32* p, Float v )         { _mm_store_ps( p, v ); }
+    static Float Set    ( f32 v )                   { return _mm_set1_ps( v ); }
+    static Float Add    ( Float a, Float b )        { return _mm_add_ps( a, b ); }
+    static Float Sub    ( Float a, Float b )        { return _mm_sub_ps( a, b ); }
+    static Float Mul    ( Float a, Float b )        { return _mm_mul_ps( a, b ); }
+    static Float Div    ( Float a, Float b )        { return _mm_div_ps( a, b ); }
+    static Float Min    ( Float a, Float b )        { return _mm_min_ps( a, b ); }
+    static Float Max    ( Float a, Float b )        { return _mm_max_ps( a, b ); }
+    static Mask  CmpLT  ( Float a, Float b )        { return _mm_cmplt_ps( a, b ); }
+    static Mask  CmpLE  ( Float a, Float b )        { return _mm_cmple_ps( a, b ); }
+    static Mask  CmpGT  ( Float a, Float b )        { return _mm_cmpgt_ps( a, b ); }
+    static Mask  CmpNE  ( Float a, Float b )        { return _mm_cmpneq_ps( a, b ); }
+    static Mask  And    ( Mask a, Mask b )          { return _mm_and_ps( a, b ); }
+    static Mask  Or     ( Mask a, Mask b )          { return _mm_or_ps( a, b ); }
+    static Mask  AndNot ( Mask a, Mask b )          { return _mm_andnot_ps( b, a ); }
+    static Float Select ( Mask m, Float a, Float b ) { return _mm_or_ps( _mm_and_ps( m, a ), _mm_andnot_ps( m, b ) ); }
+    static u32   MoveMask( Mask m )                 { return static_cast<u32>( _mm_movemask_ps( m ) ); }
+};
+#endif//ASDX_SIMD_SSE2
+
+#if ASDX_SIMD_AVX
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LaneOps8 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct LaneOps8
+{
+    static const u32 Width = 8;
+    typedef __m256 Float;
+    typedef __m256 Mask;
+
+    static Float Load   ( const f32* p )            { return _mm256_load_ps( p ); }
+    static Mask  LoadMask( const u32* p )           { return _mm256_load_ps( reinterpret_cast<const f32*>( p ) ); }
+    static void  Store  ( f32* p, Float v )         { _mm256_store_ps( p, v ); }
+    static Float Set    ( f32 v )                   { return _mm256_set1_ps( v ); }
+    static Float Add    ( Float a, Float b )        { return _mm256_add_ps( a, b ); }
+    static Float Sub    ( Float a, Float b )        { return _mm256_sub_ps( a, b ); }
+    static Float Mul    ( Float a, Float b )        { return _mm256_mul_ps( a, b ); }
+    static Float Div    ( Float a, Float b )        { return _mm256_div_ps( a, b ); }
+    static Float Min    ( Float a, Float b )        { return _mm256_min_ps( a, b ); }
+    static Float Max    ( Float a, Float b )        { return _mm256_max_ps( a, b ); }
+    static Mask  CmpLT  ( Float a, Float b )        { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+    static Mask  CmpLE  ( Float a, Float b )        { return _mm256_cmp_ps( a, b, _CMP_LE_OQ ); }
+    static Mask  CmpGT  ( Float a, Float b )        { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+    static Mask  CmpNE  ( Float a, Float b )        { return _mm256_cmp_ps( a, b, _CMP_NEQ_UQ ); }
+    static Mask  And    ( Mask a, Mask b )          { return _mm256_and_ps( a, b ); }
+    static Mask  Or     ( Mask a, Mask b )          { return _mm256_or_ps( a, b ); }
+    static Mask  AndNot ( Mask a, Mask b )          { return _mm256_andnot_ps( b, a ); }
+    static Float Select ( Mask m, Float a, Float b ) { return _mm256_blendv_ps( b, a, m ); }
+    static u32   MoveMask( Mask m )                 { return static_cast<u32>( _mm256_movemask_ps( m ) ); }
+};
+#endif//ASDX_SIMD_AVX
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PacketOps structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<u32 N, bool Wide = ( ASDX_SIMD_AVX && ( N % 8 ) == 0 ), bool Narrow = ( ASDX_SIMD_SSE2 && ( N % 4 ) == 0 )>
+struct PacketOps
+{ typedef LaneOps1 Type; };
+
+#if ASDX_SIMD_SSE2
+template<u32 N>
+struct PacketOps<N, false, true>
+{ typedef LaneOps4 Type; };
+#endif//ASDX_SIMD_SSE2
+
+#if ASDX_SIMD_AVX
+template<u32 N, bool Narrow>
+struct PacketOps<N, true, Narrow>
+{ typedef LaneOps8 Type; };
+#endif//ASDX_SIMD_AVX
+
+} // namespace detail
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RayPacket structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<u32 N>
+struct RayPacket
+{
+    static_assert( N == 1 || N == 4 || N == 8 || N == 16, "RayPacket supports 1, 4, 8 or 16 rays." );
+    static const u32 Size = N;                  //!< レイの数です.
+
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    ASDX_ALIGN(32) f32  OriginX[N];             //!< 始点の X 成分です.
+    ASDX_ALIGN(32) f32  OriginY[N];             //!< 始点の Y 成分です.
+    ASDX_ALIGN(32) f32  OriginZ[N];             //!< 始点の Z 成分です.
+    ASDX_ALIGN(32) f32  DirX   [N];             //!< 方向の X 成分です.
+    ASDX_ALIGN(32) f32  DirY   [N];             //!< 方向の Y 成分です.
+    ASDX_ALIGN(32) f32  DirZ   [N];             //!< 方向の Z 成分です.
+    ASDX_ALIGN(32) f32  TMin   [N];             //!< 交差判定する区間の最小値です.
+    ASDX_ALIGN(32) f32  TMax   [N];             //!< 交差判定する区間の最大値です. 交差すると更新されます.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      i 番目のレイを設定します.
+    //---------------------------------------------------------------------------------------------
+    void Set( u32 i, const Ray& ray )
+    {
+        assert( i < N );
+        OriginX[i] = ray.Origin.x;
+        OriginY[i] = ray.Origin.y;
+        OriginZ[i] = ray.Origin.z;
+        DirX   [i] = ray.Direction.x;
+        DirY   [i] = ray.Direction.y;
+        DirZ   [i] = ray.Direction.z;
+        TMin   [i] = ray.TMin;
+        TMax   [i] = ray.TMax;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      i 番目のレイを取得します.
+    //---------------------------------------------------------------------------------------------
+    Ray Get( u32 i ) const
+    {
+        assert( i < N );
+        return Ray( Vector3( OriginX[i], OriginY[i], OriginZ[i] ), Vector3( DirX[i], DirY[i], DirZ[i] ), TMin[i], TMax[i] );
+    }
+};
+
+typedef RayPacket<4>    RayPacket4;
+typedef RayPacket<8>    RayPacket8;
+typedef RayPacket<16>   RayPacket16;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PacketHit structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<u32 N>
+struct PacketHit
+{
+    ASDX_ALIGN(32) f32  T    [N];               //!< 交差位置までの距離です.
+    ASDX_ALIGN(32) f32  U    [N];               //!< 2番目の頂点の重心座標です.
+    ASDX_ALIGN(32) f32  V    [N];               //!< 3番目の頂点の重心座標です.
+    ASDX_ALIGN(32) u32  Index[N];               //!< 交差した三角形の番号です. 交差していない場合は UINT32_MAX です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      交差していない状態にします.
+    //---------------------------------------------------------------------------------------------
+    void Reset()
+    {
+        for( u32 i=0; i<N; ++i )
+        {
+            T    [i] = FLT_MAX;
+            U    [i] = 0.0f;
+            V    [i] = 0.0f;
+            Index[i] = UINT32_MAX;
+        }
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WatertightPacket structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<u32 N>
+struct WatertightPacket
+{
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    ASDX_ALIGN(32) f32  ShearX[N];              //!< Dx / Dz です(軸は並べ替え後).
+    ASDX_ALIGN(32) f32  ShearY[N];              //!< Dy / Dz です(軸は並べ替え後).
+    ASDX_ALIGN(32) f32  ShearZ[N];              //!< 1 / Dz です(軸は並べ替え後).
+    ASDX_ALIGN(32) u32  IsX   [3][N];           //!< 並べ替え後の軸 kx, ky, kz が X かどうかのマスクです.
+    ASDX_ALIGN(32) u32  IsY   [3][N];           //!< 並べ替え後の軸 kx, ky, kz が Y かどうかのマスクです.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイパケットから剪断変換を求めます.
+    //!
+    //! @note       方向の成分の絶対値が最大の軸を z に並べ替えます. レイの方向を変更したら再計算が必要です.
+    //---------------------------------------------------------------------------------------------
+    void Init( const RayPacket<N>& rays )
+    {
+        for( u32 i=0; i<N; ++i )
+        {
+            const f32 d[3] = { rays.DirX[i], rays.DirY[i], rays.DirZ[i] };
+            u32 k[3];
+            ComputeAxis( d, k );
+
+            ShearX[i] = d[k[0]] / d[k[2]];
+            ShearY[i] = d[k[1]] / d[k[2]];
+            ShearZ[i] = 1.0f / d[k[2]];
+            for( u32 a=0; a<3; ++a )
+            {
+                IsX[a][i] = ( k[a] == 0 ) ? UINT32_MAX : 0;
+                IsY[a][i] = ( k[a] == 1 ) ? UINT32_MAX : 0;
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      並べ替え後の軸を求めます.
+    //---------------------------------------------------------------------------------------------
+    static void ComputeAxis( const f32 d[3], u32 k[3] )
+    {
+        auto ax = fabsf( d[0] );
+        auto ay = fabsf( d[1] );
+        auto az = fabsf( d[2] );
+        k[2] = ( ax > ay ) ? ( ( ax > az ) ? 0 : 2 ) : ( ( ay > az ) ? 1 : 2 );
+        k[0] = ( k[2] + 1 ) % 3;
+        k[1] = ( k[0] + 1 ) % 3;
+
+        // 巻き順を保つために z が負なら x と y を入れ替える.
+        if ( d[k[2]] < 0.0f )
+        {
+            auto tmp = k[0];
+            k[0] = k[1];
+            k[1] = tmp;
+        }
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BoxPacket8 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BoxPacket8
+{
+    static const u32 Size = 8;                  //!< ボックスの数です.
+
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    ASDX_ALIGN(32) f32  MiniX[Size];            //!< 最小値の X 成分です.
+    ASDX_ALIGN(32) f32  MiniY[Size];            //!< 最小値の Y 成分です.
+    ASDX_ALIGN(32) f32  MiniZ[Size];            //!< 最小値の Z 成分です.
+    ASDX_ALIGN(32) f32  MaxiX[Size];            //!< 最大値の X 成分です.
+    ASDX_ALIGN(32) f32  MaxiY[Size];            //!< 最大値の Y 成分です.
+    ASDX_ALIGN(32) f32  MaxiZ[Size];            //!< 最大値の Z 成分です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全てのボックスを交差しない状態にします.
+    //!
+    //! @note       NaN で埋めるため, レイの向きに関わらず必ず交差しないと判定されます.
+    //---------------------------------------------------------------------------------------------
+    void Reset()
+    {
+        auto nan = std::numeric_limits<f32>::quiet_NaN();
+        for( u32 i=0; i<Size; ++i )
+        { MiniX[i] = MiniY[i] = MiniZ[i] = MaxiX[i] = MaxiY[i] = MaxiZ[i] = nan; }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      i 番目のボックスを設定します.
+    //---------------------------------------------------------------------------------------------
+    void Set( u32 i, const BoundingBox& value )
+    {
+        assert( i < Size );
+        MiniX[i] = value.Mini.x;
+        MiniY[i] = value.Mini.y;
+        MiniZ[i] = value.Mini.z;
+        MaxiX[i] = value.Maxi.x;
+        MaxiY[i] = value.Maxi.y;
+        MaxiZ[i] = value.Maxi.z;
+    }
+};
+
+
+namespace detail {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイパケットと三角形の交差判定を行います(Moller-Trumbore 法).
+//-------------------------------------------------------------------------------------------------
+template<typename Ops, u32 N>
+u32 IntersectPacketTriangle
+(
+    RayPacket<N>&   rays,
+    const Vector3&  p0,
+    const Vector3&  p1,
+    const Vector3&  p2,
+    u32             index,
+    PacketHit<N>&   hit
+)
+{
+    typedef typename Ops::Mask  Mask;
+
+    auto e1   = p1 - p0;
+    auto e2   = p2 - p0;
+    auto e1x  = Ops::Set( e1.x ), e1y = Ops::Set( e1.y ), e1z = Ops::Set( e1.z );
+    auto e2x  = Ops::Set( e2.x ), e2y = Ops::Set( e2.y ), e2z = Ops::Set( e2.z );
+    auto p0x  = Ops::Set( p0.x ), p0y = Ops::Set( p0.y ), p0z = Ops::Set( p0.z );
+    auto zero = Ops::Set( 0.0f );
+    auto one  = Ops::Set( 1.0f );
+
+    u32 result = 0;
+    for( u32 i=0; i<N; i+=Ops::Width )
+    {
+        auto dx = Ops::Load( rays.DirX + i );
+        auto dy = Ops::Load( rays.DirY + i );
+        auto dz = Ops::Load( rays.DirZ + i );
+
+        // IntersectRayTriangle() と同じ順序で演算するため結果はビット単位で一致します.
+        // ただしコンパイラが積和を FMA に縮約する場合は丸め差が出ます.
+        auto pvx = Ops::Sub( Ops::Mul( dy, e2z ), Ops::Mul( dz, e2y ) );
+        auto pvy = Ops::Sub( Ops::Mul( dz, e2x ), Ops::Mul( dx, e2z ) );
+        auto pvz = Ops::Sub( Ops::Mul( dx, e2y ), Ops::Mul( dy, e2x ) );
+        auto det = Ops::Add( Ops::Add( Ops::Mul( e1x, pvx ), Ops::Mul( e1y, pvy ) ), Ops::Mul( e1z, pvz ) );
+        auto inv = Ops::Div( one, det );
+
+        auto tvx = Ops::Sub( Ops::Load( rays.OriginX + i ), p0x );
+        auto tvy = Ops::Sub( Ops::Load( rays.OriginY + i ), p0y );
+        auto tvz = Ops::Sub( Ops::Load( rays.OriginZ + i ), p0z );
+        auto u   = Ops::Mul( Ops::Add( Ops::Add( Ops::Mul( tvx, pvx ), Ops::Mul( tvy, pvy ) ), Ops::Mul( tvz, pvz ) ), inv );
+
+        auto qvx = Ops::Sub( Ops::Mul( tvy, e1z ), Ops::Mul( tvz, e1y ) );
+        auto qvy = Ops::Sub( Ops::Mul( tvz, e1x ), Ops::Mul( tvx, e1z ) );
+        auto qvz = Ops::Sub( Ops::Mul( tvx, e1y ), Ops::Mul( tvy, e1x ) );
+        auto v   = Ops::Mul( Ops::Add( Ops::Add( Ops::Mul( dx, qvx ), Ops::Mul( dy, qvy ) ), Ops::Mul( dz, qvz ) ), inv );
+        auto t   = Ops::Mul( Ops::Add( Ops::Add( Ops::Mul( e2x, qvx ), Ops::Mul( e2y, qvy ) ), Ops::Mul( e2z, qvz ) ), inv );
+
+        auto tmax = Ops::Load( rays.TMax + i );
+        Mask valid = Ops::CmpNE( det, zero );
+        valid = Ops::AndNot( valid, Ops::Or( Ops::CmpLT( u, zero ), Ops::CmpGT( u, one ) ) );
+        valid = Ops::AndNot( valid, Ops::Or( Ops::CmpLT( v, zero ), Ops::CmpGT( Ops::Add( u, v ), one ) ) );
+        valid = Ops::And( valid, Ops::And( Ops::CmpLE( Ops::Load( rays.TMin + i ), t ), Ops::CmpLE( t, tmax ) ) );
+
+        auto bits = Ops::MoveMask( valid );
+        if ( bits == 0 )
+        { continue; }
+
+        Ops::Store( rays.TMax + i, Ops::Select( valid, t, tmax ) );
+        Ops::Store( hit.T + i, Ops::Select( valid, t, Ops::Load( hit.T + i ) ) );
+        Ops::Store( hit.U + i, Ops::Select( valid, u, Ops::Load( hit.U + i ) ) );
+        Ops::Store( hit.V + i, Ops::Select( valid, v, Ops::Load( hit.V + i ) ) );
+        for( u32 j=0; j<Ops::Width; ++j )
+        {
+            if ( bits & ( 1u << j ) )
+            { hit.Index[i + j] = index; }
+        }
+        result |= bits << i;
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レーンごとに軸を選択します.
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+typename Ops::Float SelectAxis( typename Ops::Mask isX, typename Ops::Mask isY, typename Ops::Float x, typename Ops::Float y, typename Ops::Float z )
+{ return Ops::Select( isX, x, Ops::Select( isY, y, z ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイパケットと三角形の水密な交差判定を行います(Woop らの方法).
+//-------------------------------------------------------------------------------------------------
+template<typename Ops, u32 N>
+u32 IntersectPacketTriangleWatertight
+(
+    RayPacket<N>&               rays,
+    const WatertightPacket<N>&  shear,
+    const Vector3&              p0,
+    const Vector3&              p1,
+    const Vector3&              p2,
+    u32                         index,
+    PacketHit<N>&               hit
+)
+{
+    typedef typename Ops::Float Float;
+    typedef typename Ops::Mask  Mask;
+
+    const Float px[3] = { Ops::Set( p0.x ), Ops::Set( p1.x ), Ops::Set( p2.x ) };
+    const Float py[3] = { Ops::Set( p0.y ), Ops::Set( p1.y ), Ops::Set( p2.y ) };
+    const Float pz[3] = { Ops::Set( p0.z ), Ops::Set( p1.z ), Ops::Set( p2.z ) };
+    auto zero = Ops::Set( 0.0f );
+    auto one  = Ops::Set( 1.0f );
+
+    u32 result = 0;
+    for( u32 i=0; i<N; i+=Ops::Width )
+    {
+        auto ox = Ops::Load( rays.OriginX + i );
+        auto oy = Ops::Load( rays.OriginY + i );
+        auto oz = Ops::Load( rays.OriginZ + i );
+        auto sx = Ops::Load( shear.ShearX + i );
+        auto sy = Ops::Load( shear.ShearY + i );
+        auto sz = Ops::Load( shear.ShearZ + i );
+
+        Mask isX[3], isY[3];
+        for( u32 a=0; a<3; ++a )
+        {
+            isX[a] = Ops::LoadMask( shear.IsX[a] + i );
+            isY[a] = Ops::LoadMask( shear.IsY[a] + i );
+        }
+
+        // 始点を原点に移して, レイの方向が +z になるように剪断変換する.
+        Float vx[3], vy[3], vz[3];
+        for( u32 k=0; k<3; ++k )
+        {
+            auto rx = Ops::Sub( px[k], ox );
+            auto ry = Ops::Sub( py[k], oy );
+            auto rz = Ops::Sub( pz[k], oz );
+            auto kx = SelectAxis<Ops>( isX[0], isY[0], rx, ry, rz );
+            auto ky = SelectAxis<Ops>( isX[1], isY[1], rx, ry, rz );
+            auto kz = SelectAxis<Ops>( isX[2], isY[2], rx, ry, rz );
+            vx[k] = Ops::Sub( kx, Ops::Mul( sx, kz ) );
+            vy[k] = Ops::Sub( ky, Ops::Mul( sy, kz ) );
+            vz[k] = Ops::Mul( sz, kz );
+        }
+
+        // 辺関数. 0 は両側の三角形で交差と見なすため隙間ができない.
+        auto e0 = Ops::Sub( Settle( Ops::Mul( vx[2], vy[1] ) ), Settle( Ops::Mul( vy[2], vx[1] ) ) );
+        auto e1 = Ops::Sub( Settle( Ops::Mul( vx[0], vy[2] ) ), Settle( Ops::Mul( vy[0], vx[2] ) ) );
+        auto e2 = Ops::Sub( Settle( Ops::Mul( vx[1], vy[0] ) ), Settle( Ops::Mul( vy[1], vx[0] ) ) );
+
+        auto neg = Ops::Or( Ops::Or( Ops::CmpLT( e0, zero ), Ops::CmpLT( e1, zero ) ), Ops::CmpLT( e2, zero ) );
+        auto pos = Ops::Or( Ops::Or( Ops::CmpGT( e0, zero ), Ops::CmpGT( e1, zero ) ), Ops::CmpGT( e2, zero ) );
+        auto det = Ops::Add( Ops::Add( e0, e1 ), e2 );
+
+        Mask valid = Ops::AndNot( Ops::CmpNE( det, zero ), Ops::And( neg, pos ) );
+
+        auto inv  = Ops::Div( one, det );
+        auto t    = Ops::Mul( Ops::Add( Ops::Add( Ops::Mul( e0, vz[0] ), Ops::Mul( e1, vz[1] ) ), Ops::Mul( e2, vz[2] ) ), inv );
+        auto tmax = Ops::Load( rays.TMax + i );
+        valid = Ops::And( valid, Ops::And( Ops::CmpLE( Ops::Load( rays.TMin + i ), t ), Ops::CmpLE( t, tmax ) ) );
+
+        auto bits = Ops::MoveMask( valid );
+        if ( bits == 0 )
+        { continue; }
+
+        Ops::Store( rays.TMax + i, Ops::Select( valid, t, tmax ) );
+        Ops::Store( hit.T + i, Ops::Select( valid, t, Ops::Load( hit.T + i ) ) );
+        Ops::Store( hit.U + i, Ops::Select( valid, Ops::Mul( e1, inv ), Ops::Load( hit.U + i ) ) );
+        Ops::Store( hit.V + i, Ops::Select( valid, Ops::Mul( e2, inv ), Ops::Load( hit.V + i ) ) );
+        for( u32 j=0; j<Ops::Width; ++j )
+        {
+            if ( bits & ( 1u << j ) )
+            { hit.Index[i + j] = index; }
+        }
+        result |= bits << i;
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイと8個のボックスの交差判定を行います(スラブ法).
+//-------------------------------------------------------------------------------------------------
+template<typename Ops, bool Robust>
+u32 IntersectRayBoxes8
+(
+    const Vector3&      origin,
+    const Vector3&      invDir,
+    const BoxPacket8&   boxes,
+    f32                 tmin,
+    f32                 tmax,
+    f32*                pNear
+)
+{
+    // 遠い側の距離を 1 + 2 * gamma(3) 倍して丸め誤差による取りこぼしを防ぐ (Ize 2013).
+    const f32 eps   = FLT_EPSILON * 0.5f;
+    const f32 scale = Robust ? 1.0f + 2.0f * ( 3.0f * eps ) / ( 1.0f - 3.0f * eps ) : 1.0f;
+
+    auto ox = Ops::Set( origin.x ), oy = Ops::Set( origin.y ), oz = Ops::Set( origin.z );
+    auto ix = Ops::Set( invDir.x ), iy = Ops::Set( invDir.y ), iz = Ops::Set( invDir.z );
+    auto t0 = Ops::Set( tmin );
+    auto t1 = Ops::Set( tmax );
+    auto s  = Ops::Set( scale );
+
+    u32 result = 0;
+    for( u32 i=0; i<BoxPacket8::Size; i+=Ops::Width )
+    {
+        auto tx0 = Ops::Mul( Ops::Sub( Ops::Load( boxes.MiniX + i ), ox ), ix );
+        auto tx1 = Ops::Mul( Ops::Sub( Ops::Load( boxes.MaxiX + i ), ox ), ix );
+        auto ty0 = Ops::Mul( Ops::Sub( Ops::Load( boxes.MiniY + i ), oy ), iy );
+        auto ty1 = Ops::Mul( Ops::Sub( Ops::Load( boxes.MaxiY + i ), oy ), iy );
+        auto tz0 = Ops::Mul( Ops::Sub( Ops::Load( boxes.MiniZ + i ), oz ), iz );
+        auto tz1 = Ops::Mul( Ops::Sub( Ops::Load( boxes.MaxiZ + i ), oz ), iz );
+
+        // IntersectRayBox() と同じ順序で比較するため, Robust でなければ結果は一致します.
+        auto nearT = Ops::Max( t0, Ops::Max( Ops::Min( tx0, tx1 ), Ops::Max( Ops::Min( ty0, ty1 ), Ops::Min( tz0, tz1 ) ) ) );
+        auto farT  = Ops::Min( Ops::Max( tx0, tx1 ), Ops::Min( Ops::Max( ty0, ty1 ), Ops::Max( tz0, tz1 ) ) );
+        if ( Robust )
+        { farT = Ops::Mul( farT, s ); }
+        farT = Ops::Min( t1, farT );
+
+        if ( pNear != nullptr )
+        { Ops::Store( pNear + i, nearT ); }
+        result |= Ops::MoveMask( Ops::CmpLE( nearT, farT ) ) << i;
+    }
+
+    return result;
+}
+
+} // namespace detail
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイパケットと三角形の交差判定を行います(Moller-Trumbore 法).
+//!
+//! @param [in,out] rays        レイパケット. 交差したレイは TMax が更新されます.
+//! @param [in]     p0          三角形の頂点.
+//! @param [in]     p1          三角形の頂点.
+//! @param [in]     p2          三角形の頂点.
+//! @param [in]     index       交差情報に書き込む三角形の番号.
+//! @param [in,out] hit         交差したレイの交差情報が更新されます.
+//! @return     交差したレイのビットマスクを返却します.
+//! @note       各レイの結果は IntersectRayTriangle() とビット単位で一致します.
+//!             AVX が有効で N が 8 の倍数なら8レーン, それ以外は SSE の4レーン単位で処理します.
+//-------------------------------------------------------------------------------------------------
+template<u32 N>
+u32 IntersectPacketTriangle
+(
+    RayPacket<N>&   rays,
+    const Vector3&  p0,
+    const Vector3&  p1,
+    const Vector3&  p2,
+    u32             index,
+    PacketHit<N>&   hit
+)
+{ return detail::IntersectPacketTriangle<typename detail::PacketOps<N>::Type>( rays, p0, p1, p2, index, hit ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイパケットと三角形の水密な交差判定を行います(Woop らの方法).
+//!
+//! @param [in]     shear       rays から WatertightPacket::Init() で求めた剪断変換.
+//! @note       その他の引数と戻り値は IntersectPacketTriangle() と同じです.
+//!             辺を共有する三角形の間をレイが抜けることはありません. 辺上のレイは両側で交差と判定されます.
+//!             元論文の倍精度での再計算は行わないため, 辺のごく近傍で余分に交差と判定されることがあります.
+//-------------------------------------------------------------------------------------------------
+template<u32 N>
+u32 IntersectPacketTriangleWatertight
+(
+    RayPacket<N>&               rays,
+    const WatertightPacket<N>&  shear,
+    const Vector3&              p0,
+    const Vector3&              p1,
+    const Vector3&              p2,
+    u32                         index,
+    PacketHit<N>&               hit
+)
+{ return detail::IntersectPacketTriangleWatertight<typename detail::PacketOps<N>::Type>( rays, shear, p0, p1, p2, index, hit ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイと三角形の水密な交差判定を行います(Woop らの方法).
+//!
+//! @note       引数と戻り値は IntersectRayTriangle() と同じです. 結果は IntersectPacketTriangleWatertight() と一致します.
+//-------------------------------------------------------------------------------------------------
+inline bool IntersectRayTriangleWatertight
+(
+    const Ray&      ray,
+    const Vector3&  p0,
+    const Vector3&  p1,
+    const Vector3&  p2,
+    f32&            t,
+    f32&            u,
+    f32&            v
+)
+{
+    RayPacket<1> rays;
+    rays.Set( 0, ray );
+
+    WatertightPacket<1> shear;
+    shear.Init( rays );
+
+    PacketHit<1> hit;
+    hit.Reset();
+    if ( detail::IntersectPacketTriangleWatertight<detail::LaneOps1>( rays, shear, p0, p1, p2, 0, hit ) == 0 )
+    { return false; }
+
+    t = hit.T[0];
+    u = hit.U[0];
+    v = hit.V[0];
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイと8個のボックスの交差判定を行います(スラブ法).
+//!
+//! @param [in]     origin      レイの始点.
+//! @param [in]     invDir      レイの方向の逆数.
+//! @param [in]     boxes       ボックス.
+//! @param [in]     tmin        区間の最小値.
+//! @param [in]     tmax        区間の最大値.
+//! @param [out]    pNear       8個の交差区間の開始位置の出力先(32 byte アライメント). nullptr の場合は出力しません.
+//! @return     交差したボックスのビットマスクを返却します.
+//! @note       各ボックスの結果は IntersectRayBox() と一致します.
+//-------------------------------------------------------------------------------------------------
+inline u32 IntersectRayBoxes8( const Vector3& origin, const Vector3& invDir, const BoxPacket8& boxes, f32 tmin, f32 tmax, f32* pNear = nullptr )
+{ return detail::IntersectRayBoxes8<detail::PacketOps<8>::Type, false>( origin, invDir, boxes, tmin, tmax, pNear ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      丸め誤差で交差を取りこぼさないレイと8個のボックスの交差判定を行います.
+//!
+//! @note       引数と戻り値は IntersectRayBoxes8() と同じです. 遠い側の距離を 1 + 2γ(3) 倍して保守的に判定します.
+//-------------------------------------------------------------------------------------------------
+inline u32 IntersectRayBoxes8Robust( const Vector3& origin, const Vector3& invDir, const BoxPacket8& boxes, f32 tmin, f32 tmax, f32* pNear = nullptr )
+{ return detail::IntersectRayBoxes8<detail::PacketOps<8>::Type, true>( origin, invDir, boxes, tmin, tmax, pNear ); }
+
+} // namespace asdx
+
+#endif//__ASDX_INTERSECTION_H__
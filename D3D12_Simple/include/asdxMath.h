@@ -11,6 +11,8 @@
 // Includes
 //--------------------------------------------------------------------------------------------------
 #include <asdxTypedef.h>
+#include <asdxSimd.h>
+#include <asdxFastMath.h>
 #include <cmath>
 #include <cfloat>
 #include <cassert>
@@ -26,6 +28,7 @@ struct Vector2;
 struct Vector3;
 struct Vector4;
 struct Matrix;
+struct Matrix3x4;
 struct Quaternion;
 
 
@@ -191,6 +194,26 @@ f16     F32ToF16( f32 value );
 //--------------------------------------------------------------------------------------------------
 f32     F16ToF32( f16 value );
 
+//--------------------------------------------------------------------------------------------------
+//! @brief      f32型の配列をf16型の配列に変換します.
+//!
+//! @param [in]     pInput      入力配列.
+//! @param [in]     count       要素数.
+//! @param [out]    pOutput     出力配列.
+//! @note       F32ToF16() とビット単位で一致します(NaN のペイロードを除く).
+//--------------------------------------------------------------------------------------------------
+void    F32ToF16Stream( const f32* pInput, u32 count, f16* pOutput );
+
+//--------------------------------------------------------------------------------------------------
+//! @brief      f16型の配列をf32型の配列に変換します.
+//!
+//! @param [in]     pInput      入力配列.
+//! @param [in]     count       要素数.
+//! @param [out]    pOutput     出力配列.
+//! @note       F16ToF32() とビット単位で一致します(F16C 使用時のシグナリング NaN を除く).
+//--------------------------------------------------------------------------------------------------
+void    F16ToF32Stream( const f16* pInput, u32 count, f32* pOutput );
+
 //--------------------------------------------------------------------------------------------------
 //! @brief      2つの値のうち，大きい方を返却します.
 //!
@@ -1489,6 +1512,42 @@ public:
     //----------------------------------------------------------------------------------------------
     static void    TransformNormal( const Vector3& normal, const Matrix& matrix, Vector3 &result );
 
+    //----------------------------------------------------------------------------------------------
+    //! @brief      指定されたアフィン変換行列を用いて，ベクトルを変換します.
+    //!
+    //! @param [in]     position    入力ベクトル.
+    //! @param [in]     matrix      変換行列.
+    //! @return     変換されたベクトル.
+    //----------------------------------------------------------------------------------------------
+    static Vector3 Transform( const Vector3& position, const Matrix3x4& matrix );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      指定されたアフィン変換行列を用いて，ベクトルを変換します.
+    //!
+    //! @param [in]     position    入力ベクトル.
+    //! @param [in]     matrix      変換行列.
+    //! @param [out]    result      変換されたベクトル.
+    //----------------------------------------------------------------------------------------------
+    static void    Transform( const Vector3& position, const Matrix3x4& matrix, Vector3 &result );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      指定されたアフィン変換行列を用いて，法線ベクトルを変換します.
+    //!
+    //! @param [in]     normal      入力ベクトル.
+    //! @param [in]     matrix      変換行列.
+    //! @return     変換された法線ベクトル.
+    //----------------------------------------------------------------------------------------------
+    static Vector3 TransformNormal( const Vector3& normal, const Matrix3x4& matrix );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      指定されたアフィン変換行列を用いて，法線ベクトルを変換します.
+    //!
+    //! @param [in]     normal      入力ベクトル.
+    //! @param [in]     matrix      変換行列.
+    //! @param [out]    result      変換された法線ベクトル.
+    //----------------------------------------------------------------------------------------------
+    static void    TransformNormal( const Vector3& normal, const Matrix3x4& matrix, Vector3 &result );
+
     //----------------------------------------------------------------------------------------------
     //! @brief      指定された行列を用いてベクトルを変換し，変換結果をw=1に射影します.
     //!
@@ -1507,6 +1566,42 @@ public:
     //----------------------------------------------------------------------------------------------
     static void    TransformCoord( const Vector3& coord, const Matrix& matrix, Vector3& result );
 
+    //----------------------------------------------------------------------------------------------
+    //! @brief      指定された行列を用いて，ベクトルの配列を変換します(w=1).
+    //!
+    //! @param [in]     pInput          入力ベクトルの配列.
+    //! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+    //! @param [in]     count           ベクトルの数.
+    //! @param [in]     matrix          変換行列.
+    //! @param [out]    pOutput         出力ベクトルの配列. pInput と同じ配列を指定しても構いません.
+    //! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+    //----------------------------------------------------------------------------------------------
+    static void    TransformStream( const Vector3* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector3* pOutput, u32 outputStride );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      指定された行列を用いて，法線ベクトルの配列を変換します(w=0).
+    //!
+    //! @param [in]     pInput          入力ベクトルの配列.
+    //! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+    //! @param [in]     count           ベクトルの数.
+    //! @param [in]     matrix          変換行列.
+    //! @param [out]    pOutput         出力ベクトルの配列. pInput と同じ配列を指定しても構いません.
+    //! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+    //----------------------------------------------------------------------------------------------
+    static void    TransformNormalStream( const Vector3* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector3* pOutput, u32 outputStride );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      指定された行列を用いてベクトルの配列を変換し，変換結果をw=1に射影します.
+    //!
+    //! @param [in]     pInput          入力ベクトルの配列.
+    //! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+    //! @param [in]     count           ベクトルの数.
+    //! @param [in]     matrix          変換行列.
+    //! @param [out]    pOutput         出力ベクトルの配列. pInput と同じ配列を指定しても構いません.
+    //! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+    //----------------------------------------------------------------------------------------------
+    static void    TransformCoordStream( const Vector3* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector3* pOutput, u32 outputStride );
+
     //----------------------------------------------------------------------------------------------
     //! @brief      スカラー3重積を計算します.
     //!
@@ -2091,6 +2186,18 @@ public:
     //----------------------------------------------------------------------------------------------
     static void    Transform( const Vector4& position, const Matrix& matrix, Vector4 &result );
 
+    //----------------------------------------------------------------------------------------------
+    //! @brief      指定された行列を用いて，ベクトルの配列を変換します.
+    //!
+    //! @param [in]     pInput          入力ベクトルの配列.
+    //! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+    //! @param [in]     count           ベクトルの数.
+    //! @param [in]     matrix          変換行列.
+    //! @param [out]    pOutput         出力ベクトルの配列. pInput と同じ配列を指定しても構いません.
+    //! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+    //----------------------------------------------------------------------------------------------
+    static void    TransformStream( const Vector4* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector4* pOutput, u32 outputStride );
+
 } Vector4;
 
 
@@ -2931,6 +3038,323 @@ public:
 } Matrix;
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AlignedType structure
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------
+//! @brief      Alignment バイトでアライメントされた T です.
+//!
+//! @note       __declspec( align ) はテンプレート引数を受け取れないため alignas を使用します.
+//!             配列にする場合は AlignedVector など Alignment を満たすアロケータを使用してください.
+//--------------------------------------------------------------------------------------------------
+template<typename T, u32 Alignment>
+struct alignas(Alignment) AlignedType : public T
+{
+    using T::T;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //----------------------------------------------------------------------------------------------
+    AlignedType()
+    { /* DO_NOTHING */ }
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //----------------------------------------------------------------------------------------------
+    AlignedType( const T& value )
+    : T( value )
+    { /* DO_NOTHING */ }
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      代入演算子です.
+    //----------------------------------------------------------------------------------------------
+    AlignedType& operator = ( const T& value )
+    {
+        T::operator = ( value );
+        return *this;
+    }
+};
+
+typedef AlignedType<Vector4, 16>    Vector4A;       //!< 16 バイトアライメントの Vector4 です.
+typedef AlignedType<Vector4, 32>    Vector4A32;     //!< 32 バイトアライメントの Vector4 です.
+typedef AlignedType<Vector4, 64>    Vector4A64;     //!< 64 バイトアライメントの Vector4 です.
+typedef AlignedType<Matrix,  16>    MatrixA;        //!< 16 バイトアライメントの Matrix です.
+typedef AlignedType<Matrix,  32>    MatrixA32;      //!< 32 バイトアライメントの Matrix です.
+typedef AlignedType<Matrix,  64>    MatrixA64;      //!< 64 バイトアライメントの Matrix です.
+
+static_assert( alignof(Vector4A)   == 16 && sizeof(Vector4A)   == 16, "Vector4A layout mismatch." );
+static_assert( alignof(Vector4A32) == 32 && sizeof(Vector4A32) == 32, "Vector4A32 layout mismatch." );
+static_assert( alignof(Vector4A64) == 64 && sizeof(Vector4A64) == 64, "Vector4A64 layout mismatch." );
+static_assert( alignof(MatrixA)    == 16 && sizeof(MatrixA)    == 64, "MatrixA layout mismatch." );
+static_assert( alignof(MatrixA32)  == 32 && sizeof(MatrixA32)  == 64, "MatrixA32 layout mismatch." );
+static_assert( alignof(MatrixA64)  == 64 && sizeof(MatrixA64)  == 64, "MatrixA64 layout mismatch." );
+
+//--------------------------------------------------------------------------------------------------
+//! @brief      16 バイトアライメントされたベクトルの配列を変換します.
+//!
+//! @param [in]     pInput      入力ベクトルの配列. 要素は隙間なく並んでいる必要があります.
+//! @param [in]     count       ベクトルの数.
+//! @param [in]     matrix      変換行列.
+//! @param [out]    pOutput     出力ベクトルの配列. pInput と同じ配列を指定しても構いません.
+//! @note       Vector4::TransformStream() と異なり，アライメント済みのロード・ストアのみを使用します.
+//--------------------------------------------------------------------------------------------------
+void    TransformStream( const Vector4A* pInput, u32 count, const MatrixA& matrix, Vector4A* pOutput );
+
+#if ASDX_SIMD_SSE2
+namespace simd {
+
+//--------------------------------------------------------------------------------------------------
+//! @brief      アライメントされたベクトルを読み込みます.
+//--------------------------------------------------------------------------------------------------
+template<u32 Alignment>
+ASDX_INLINE
+__m128 Load( const AlignedType<Vector4, Alignment>& value )
+{
+    static_assert( Alignment >= 16, "Alignment must be at least 16 bytes." );
+    return _mm_load_ps( &value.x );
+}
+
+//--------------------------------------------------------------------------------------------------
+//! @brief      アライメントされたベクトルに書き込みます.
+//--------------------------------------------------------------------------------------------------
+template<u32 Alignment>
+ASDX_INLINE
+void Store( AlignedType<Vector4, Alignment>& result, __m128 value )
+{
+    static_assert( Alignment >= 16, "Alignment must be at least 16 bytes." );
+    _mm_store_ps( &result.x, value );
+}
+
+//--------------------------------------------------------------------------------------------------
+//! @brief      アライメントされた行列の各行を読み込みます.
+//--------------------------------------------------------------------------------------------------
+template<u32 Alignment>
+ASDX_INLINE
+void LoadRows( const AlignedType<Matrix, Alignment>& value, __m128 rows[4] )
+{
+    static_assert( Alignment >= 16, "Alignment must be at least 16 bytes." );
+    rows[0] = _mm_load_ps( value.m[0] );
+    rows[1] = _mm_load_ps( value.m[1] );
+    rows[2] = _mm_load_ps( value.m[2] );
+    rows[3] = _mm_load_ps( value.m[3] );
+}
+
+} // namespace simd
+#endif//ASDX_SIMD_SSE2
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Matrix3x4 structure
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------
+//! @brief      アフィン変換行列です.
+//!
+//! @note       Matrix のアフィン部分(4x3)を転置して 3行4列 で保持します.
+//!             各行は (回転・スケールの列, 平行移動) で，HLSL の float3x4 と同じ並びです.
+//!             乗算の順序は Matrix と同じく，Multiply( a, b ) は a の後に b を適用します.
+//--------------------------------------------------------------------------------------------------
+typedef struct Matrix3x4
+{
+    //==============================================================================================
+    // list of friend classes and methods.
+    //==============================================================================================
+    /* NOTHING */
+
+public:
+    //==============================================================================================
+    // public variables.
+    //==============================================================================================
+    union
+    {
+        struct
+        {
+            f32 _11, _12, _13, _14;
+            f32 _21, _22, _23, _24;
+            f32 _31, _32, _33, _34;
+        };
+        f32 m[3][4];
+    };
+
+    //==============================================================================================
+    // public methods.
+    //==============================================================================================
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //----------------------------------------------------------------------------------------------
+    Matrix3x4();
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param [in]     pValues     要素数12の配列.
+    //----------------------------------------------------------------------------------------------
+    Matrix3x4( const f32* );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param [in]     m11         1行1列の値.
+    //! @param [in]     m12         1行2列の値.
+    //! @param [in]     m13         1行3列の値.
+    //! @param [in]     m14         1行4列の値.
+    //! @param [in]     m21         2行1列の値.
+    //! @param [in]     m22         2行2列の値.
+    //! @param [in]     m23         2行3列の値.
+    //! @param [in]     m24         2行4列の値.
+    //! @param [in]     m31         3行1列の値.
+    //! @param [in]     m32         3行2列の値.
+    //! @param [in]     m33         3行3列の値.
+    //! @param [in]     m34         3行4列の値.
+    //----------------------------------------------------------------------------------------------
+    Matrix3x4( const f32 m11, const f32 m12, const f32 m13, const f32 m14,
+               const f32 m21, const f32 m22, const f32 m23, const f32 m24,
+               const f32 m31, const f32 m32, const f32 m33, const f32 m34 );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      4x4 行列から変換します.
+    //!
+    //! @param [in]     value       アフィン変換行列. 4列目は無視されます.
+    //----------------------------------------------------------------------------------------------
+    explicit Matrix3x4( const Matrix& );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      インデクサです.
+    //!
+    //! @param [in]     row         行番号.
+    //! @param [in]     col         列番号.
+    //! @return     指定された行番号と列番号に対応する要素を返却します.
+    //----------------------------------------------------------------------------------------------
+    f32& operator () ( u32 row, u32 col );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      インデクサです(const版).
+    //!
+    //! @param [in]     row         行番号.
+    //! @param [in]     col         列番号.
+    //! @return     指定された行番号と列番号に対応する要素を返却します.
+    //----------------------------------------------------------------------------------------------
+    f32  operator () ( u32 row, u32 col ) const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      乗算代入演算子です.
+    //!
+    //! @param [in]     value       乗算する行列.
+    //! @return     乗算結果を返却します.
+    //----------------------------------------------------------------------------------------------
+    Matrix3x4& operator *= ( const Matrix3x4& );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      乗算演算子です.
+    //!
+    //! @param [in]     value       乗算する値.
+    //! @return     乗算結果を返却します.
+    //----------------------------------------------------------------------------------------------
+    Matrix3x4  operator *  ( const Matrix3x4& ) const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      等価比較演算子です.
+    //!
+    //! @param [in]     value       比較する値.
+    //! @retval true    値が等価です.
+    //! @retval false   値が非等価です.
+    //----------------------------------------------------------------------------------------------
+    bool    operator == ( const Matrix3x4& ) const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      非等価比較演算子です.
+    //!
+    //! @param [in]     value       比較する値.
+    //! @retval true    値が非等価です.
+    //! @retval false   値が等価です.
+    //----------------------------------------------------------------------------------------------
+    bool    operator != ( const Matrix3x4& ) const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      4x4 行列に変換します.
+    //!
+    //! @return     4列目を (0, 0, 0, 1) とした行列を返却します.
+    //----------------------------------------------------------------------------------------------
+    Matrix  ToMatrix() const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      回転・スケール部分の行列式を求めます.
+    //!
+    //! @return     行列式の値を返却します.
+    //----------------------------------------------------------------------------------------------
+    f32     Determinant() const;
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      単位行列にします.
+    //!
+    //! @return     単位行列にした結果を返却します.
+    //----------------------------------------------------------------------------------------------
+    Matrix3x4& Neutral();
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      単位行列を取得します.
+    //!
+    //! @return     単位行列を返却します.
+    //----------------------------------------------------------------------------------------------
+    static Matrix3x4 Identity();
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      行列同士を乗算します.
+    //!
+    //! @param [in]     a           入力行列.
+    //! @param [in]     b           入力行列.
+    //! @return     a の後に b を適用する行列を返却します.
+    //----------------------------------------------------------------------------------------------
+    static Matrix3x4 Multiply( const Matrix3x4& a, const Matrix3x4& b );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      行列同士を乗算します.
+    //!
+    //! @param [in]     a           入力行列.
+    //! @param [in]     b           入力行列.
+    //! @param [out]    result      a の後に b を適用する行列.
+    //----------------------------------------------------------------------------------------------
+    static void      Multiply( const Matrix3x4& a, const Matrix3x4& b, Matrix3x4 &result );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      逆行列を求めます.
+    //!
+    //! @param [in]     value       入力行列.
+    //! @return     逆行列を返却します.
+    //! @note       回転・スケール部分の 3x3 逆行列から平行移動を求めるため，
+    //!             Matrix::Invert() よりも高速です.
+    //----------------------------------------------------------------------------------------------
+    static Matrix3x4 Invert( const Matrix3x4& value );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      逆行列を求めます.
+    //!
+    //! @param [in]     value       入力行列.
+    //! @param [out]    result      逆行列.
+    //----------------------------------------------------------------------------------------------
+    static void      Invert( const Matrix3x4& value, Matrix3x4 &result );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      回転と平行移動のみの行列の逆行列を求めます.
+    //!
+    //! @param [in]     value       スケールを含まない入力行列.
+    //! @return     回転部分を転置した逆行列を返却します.
+    //----------------------------------------------------------------------------------------------
+    static Matrix3x4 InvertRigid( const Matrix3x4& value );
+
+    //----------------------------------------------------------------------------------------------
+    //! @brief      回転と平行移動のみの行列の逆行列を求めます.
+    //!
+    //! @param [in]     value       スケールを含まない入力行列.
+    //! @param [out]    result      回転部分を転置した逆行列.
+    //----------------------------------------------------------------------------------------------
+    static void      InvertRigid( const Matrix3x4& value, Matrix3x4 &result );
+
+} Matrix3x4;
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quaternion structure
 ////////////////////////////////////////////////////////////////////////////////////////////////////
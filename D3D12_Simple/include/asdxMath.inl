@@ -88,8 +88,8 @@ f32 Fresnel( f32 n1, f32 n2, f32 cosTheta )
 {
     register f32 a = n1 + n2;
     register f32 b = n1 - n2;
-    register f32 R = ( a * a ) / ( b * b );
-    return R + ( 1.0f - R ) * powf( 1.0f - cosTheta, 5.0f );
+    register f32 R = ( b * b ) / ( a * a );
+    return R + ( 1.0f - R ) * Pow( 1.0f - cosTheta, 5.0f );
 }
 
 ASDX_INLINE
@@ -97,17 +97,18 @@ f64 Fresnel( f64 n1, f64 n2, f64 cosTheta )
 {
     register f64 a = n1 + n2;
     register f64 b = n1 - n2;
-    register f64 R = ( a * a ) / ( b * b );
-    return R + ( 1.0 - R ) * pow( 1.0f - cosTheta, 5.0 );
+    register f64 R = ( b * b ) / ( a * a );
+    return R + ( 1.0 - R ) * pow( 1.0 - cosTheta, 5.0 );
 }
 
 ASDX_INLINE 
 f16 F32ToF16( f32 value )
 {
-    f16 result;
+    u32 result;
 
     // ビット列を崩さないままu32型に変換.
-    u32 bit = *reinterpret_cast<u32*>( &value );
+    u32 bit;
+    memcpy( &bit, &value, sizeof(bit) );
 
     // f32表現の符号bitを取り出し.
     u32 sign   = ( bit & 0x80000000U) >> 16U;
@@ -115,27 +116,27 @@ f16 F32ToF16( f32 value )
     // 符号部を削ぎ落す.
     bit     = bit & 0x7FFFFFFFU;
 
-    // f16として表現する際に値がデカ過ぎる場合は，無限大にクランプ.
-    if ( bit > 0x47FFEFFFU)
-    { result = 0x7FFFU; }
-    else
+    // f16として表現する際に値がデカ過ぎる場合は，無限大にする. NaN は NaN のまま.
+    if ( bit >= 0x47800000U )
+    { result = ( bit > 0x7F800000U ) ? 0x7E00U : 0x7C00U; }
+
+    // 正規化されたf16として表現するために小さすぎる値は, 0.5を足して仮数部の下位に寄せる.
+    // 丸めは加算に任せる.
+    else if ( bit < 0x38800000U )
     {
-        // 正規化されたf16として表現するために小さすぎる値は正規化されていない値に変換.
-        if ( bit < 0x38800000U)
-        {
-            u32 shift = 113U - ( bit >> 23U);
-            bit    = (0x800000U | ( bit & 0x7FFFFFU)) >> shift;
-        }
-        else
-        {
-            // 正規化されたf16として表現するために指数部に再度バイアスをかける
-            bit += 0xC8000000U;
-        }
+        f32 denorm;
+        memcpy( &denorm, &bit, sizeof(denorm) );
+        denorm += 0.5f;
 
-        // f16型表現にする.
-        result = (( bit + 0x0FFFU + (( bit >> 13U) & 1U)) >> 13U) & 0x7FFFU; 
+        u32 denormBit;
+        memcpy( &denormBit, &denorm, sizeof(denormBit) );
+        result = denormBit - 0x3F000000U;
     }
 
+    // 正規化されたf16として表現するために指数部に再度バイアスをかけ, 偶数丸めする.
+    else
+    { result = ( bit + 0xC8000FFFU + (( bit >> 13U ) & 1U ) ) >> 13U; }
+
     // 符号部を付け足して返却.
     return static_cast<f16>( result | sign );
 }
@@ -149,8 +150,14 @@ f32 F16ToF32( f16 value )
     // 仮数
     u32 mantissa = static_cast<u32>( value & 0x03FF );
 
+    // 無限大と NaN の場合.
+    if ( ( value & 0x7C00 ) == 0x7C00 )
+    {
+        // 指数部を全て1にする.
+        exponent = 255 - 112;
+    }
     // 正規化済みの場合.
-    if ( ( value & 0x7C00 ) != 0 )
+    else if ( ( value & 0x7C00 ) != 0 )
     {
         // 指数部を計算.
         exponent = static_cast<u32>( ( value >> 10 ) & 0x1F );
@@ -179,7 +186,62 @@ f32 F16ToF32( f16 value )
              ( ( exponent + 112 ) << 23) | // 指数部.
              ( mantissa << 13 );           // 仮数部.
 
-    return *reinterpret_cast<f32*>( &result );
+    f32 f;
+    memcpy( &f, &result, sizeof(f) );
+    return f;
+}
+
+ASDX_INLINE
+void F32ToF16Stream( const f32* pInput, u32 count, f16* pOutput )
+{
+    u32 i = 0;
+
+#if ASDX_SIMD_F16C
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto v = _mm256_cvtps_ph( _mm256_loadu_ps( pInput + i ), _MM_FROUND_TO_NEAREST_INT );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pOutput + i ), v );
+    }
+#elif ASDX_SIMD_SSE2
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto lo = simd::ConvertF32ToF16( _mm_loadu_ps( pInput + i + 0 ) );
+        auto hi = simd::ConvertF32ToF16( _mm_loadu_ps( pInput + i + 4 ) );
+
+        // 符号付き飽和で詰めるので, 下位16bitを符号拡張しておく.
+        lo = _mm_srai_epi32( _mm_slli_epi32( lo, 16 ), 16 );
+        hi = _mm_srai_epi32( _mm_slli_epi32( hi, 16 ), 16 );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pOutput + i ), _mm_packs_epi32( lo, hi ) );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    { pOutput[i] = F32ToF16( pInput[i] ); }
+}
+
+ASDX_INLINE
+void F16ToF32Stream( const f16* pInput, u32 count, f32* pOutput )
+{
+    u32 i = 0;
+
+#if ASDX_SIMD_F16C
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pInput + i ) );
+        _mm256_storeu_ps( pOutput + i, _mm256_cvtph_ps( v ) );
+    }
+#elif ASDX_SIMD_SSE2
+    auto zero = _mm_setzero_si128();
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pInput + i ) );
+        _mm_storeu_ps( pOutput + i + 0, simd::ConvertF16ToF32( _mm_unpacklo_epi16( v, zero ) ) );
+        _mm_storeu_ps( pOutput + i + 4, simd::ConvertF16ToF32( _mm_unpackhi_epi16( v, zero ) ) );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    { pOutput[i] = F16ToF32( pInput[i] ); }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -785,6 +847,93 @@ void Vector2::TransformCoord( const Vector2 &coords, const Matrix &matrix, Vecto
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Stream Transform
+///////////////////////////////////////////////////////////////////////////////////////////////////
+namespace detail {
+
+enum TRANSFORM_MODE
+{
+    TRANSFORM_POSITION = 0,     // w = 1 として変換します.
+    TRANSFORM_NORMAL,           // w = 0 として変換します.
+    TRANSFORM_COORD,            // w = 1 として変換し, w で除算します.
+};
+
+template<TRANSFORM_MODE Mode>
+ASDX_INLINE
+void TransformStream3( const Vector3* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector3* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_AVX2
+    // 8個ずつ SoA に読み込んで変換する. 加算の順序はスカラー版と同じにしておく.
+    if ( ( inputStride & 0x3 ) == 0 )
+    {
+        auto index = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( inputStride / 4 ) );
+        auto cols  = ( Mode == TRANSFORM_COORD ) ? 4u : 3u;
+
+        __m256 m[4][4];
+        for( u32 r=0; r<4; ++r )
+        {
+            for( u32 c=0; c<4; ++c )
+            { m[r][c] = _mm256_set1_ps( matrix.m[r][c] ); }
+        }
+
+        ASDX_ALIGN(32) f32 out[3][8];
+        for( ; i + 8 <= count; i += 8 )
+        {
+            auto base = reinterpret_cast<const f32*>( pSrc + size_t( i ) * inputStride );
+            auto x = _mm256_i32gather_ps( base + 0, index, 4 );
+            auto y = _mm256_i32gather_ps( base + 1, index, 4 );
+            auto z = _mm256_i32gather_ps( base + 2, index, 4 );
+
+            __m256 v[4];
+            for( u32 c=0; c<cols; ++c )
+            {
+                v[c] = _mm256_mul_ps( x, m[0][c] );
+                v[c] = simd::MulAdd( y, m[1][c], v[c] );
+                v[c] = simd::MulAdd( z, m[2][c], v[c] );
+                if ( Mode != TRANSFORM_NORMAL )
+                { v[c] = _mm256_add_ps( v[c], m[3][c] ); }
+            }
+
+            for( u32 c=0; c<3; ++c )
+            {
+                if ( Mode == TRANSFORM_COORD )
+                { v[c] = _mm256_div_ps( v[c], v[3] ); }
+                _mm256_store_ps( out[c], v[c] );
+            }
+
+            for( u32 j=0; j<8; ++j )
+            {
+                auto dst = reinterpret_cast<f32*>( pDst + size_t( i + j ) * outputStride );
+                dst[0] = out[0][j];
+                dst[1] = out[1][j];
+                dst[2] = out[2][j];
+            }
+        }
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto& src = *reinterpret_cast<const Vector3*>( pSrc + size_t( i ) * inputStride );
+        auto& dst = *reinterpret_cast<Vector3*>( pDst + size_t( i ) * outputStride );
+
+        if ( Mode == TRANSFORM_POSITION )
+        { dst = Vector3::Transform( src, matrix ); }
+        else if ( Mode == TRANSFORM_NORMAL )
+        { dst = Vector3::TransformNormal( src, matrix ); }
+        else
+        { dst = Vector3::TransformCoord( src, matrix ); }
+    }
+}
+
+} // namespace detail
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Vector3 structure
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1491,18 +1640,46 @@ Vector3 Vector3::TransformNormal( const Vector3& normal, const Matrix& matrix )
 {
     return Vector3(
         ((normal.x * matrix._11) + (normal.y * matrix._21)) + (normal.z * matrix._31),
-        ((normal.y * matrix._12) + (normal.y * matrix._22)) + (normal.z * matrix._32),
-        ((normal.z * matrix._13) + (normal.y * matrix._23)) + (normal.z * matrix._33) );
+        ((normal.x * matrix._12) + (normal.y * matrix._22)) + (normal.z * matrix._32),
+        ((normal.x * matrix._13) + (normal.y * matrix._23)) + (normal.z * matrix._33) );
 }
 
 ASDX_INLINE
 void Vector3::TransformNormal( const Vector3 &normal, const Matrix &matrix, Vector3 &result )
 {
     result.x = ((normal.x * matrix._11) + (normal.y * matrix._21)) + (normal.z * matrix._31);
-    result.y = ((normal.y * matrix._12) + (normal.y * matrix._22)) + (normal.z * matrix._32);
-    result.z = ((normal.z * matrix._13) + (normal.y * matrix._23)) + (normal.z * matrix._33);
+    result.y = ((normal.x * matrix._12) + (normal.y * matrix._22)) + (normal.z * matrix._32);
+    result.z = ((normal.x * matrix._13) + (normal.y * matrix._23)) + (normal.z * matrix._33);
 }
 
+ASDX_INLINE
+Vector3 Vector3::Transform( const Vector3& position, const Matrix3x4& matrix )
+{
+    return Vector3(
+        ( ((position.x * matrix._11) + (position.y * matrix._12)) + (position.z * matrix._13)) + matrix._14,
+        ( ((position.x * matrix._21) + (position.y * matrix._22)) + (position.z * matrix._23)) + matrix._24,
+        ( ((position.x * matrix._31) + (position.y * matrix._32)) + (position.z * matrix._33)) + matrix._34
+    );
+}
+
+ASDX_INLINE
+void Vector3::Transform( const Vector3 &position, const Matrix3x4 &matrix, Vector3 &result )
+{ result = Transform( position, matrix ); }
+
+ASDX_INLINE
+Vector3 Vector3::TransformNormal( const Vector3& normal, const Matrix3x4& matrix )
+{
+    return Vector3(
+        ((normal.x * matrix._11) + (normal.y * matrix._12)) + (normal.z * matrix._13),
+        ((normal.x * matrix._21) + (normal.y * matrix._22)) + (normal.z * matrix._23),
+        ((normal.x * matrix._31) + (normal.y * matrix._32)) + (normal.z * matrix._33)
+    );
+}
+
+ASDX_INLINE
+void Vector3::TransformNormal( const Vector3 &normal, const Matrix3x4 &matrix, Vector3 &result )
+{ result = TransformNormal( normal, matrix ); }
+
 ASDX_INLINE
 Vector3 Vector3::TransformCoord( const Vector3& coords, const Matrix& matrix )
 {
@@ -1530,6 +1707,18 @@ void Vector3::TransformCoord( const Vector3 &coords, const Matrix &matrix, Vecto
     result.z = Z / W;
 }
 
+ASDX_INLINE
+void Vector3::TransformStream( const Vector3* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector3* pOutput, u32 outputStride )
+{ detail::TransformStream3<detail::TRANSFORM_POSITION>( pInput, inputStride, count, matrix, pOutput, outputStride ); }
+
+ASDX_INLINE
+void Vector3::TransformNormalStream( const Vector3* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector3* pOutput, u32 outputStride )
+{ detail::TransformStream3<detail::TRANSFORM_NORMAL>( pInput, inputStride, count, matrix, pOutput, outputStride ); }
+
+ASDX_INLINE
+void Vector3::TransformCoordStream( const Vector3* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector3* pOutput, u32 outputStride )
+{ detail::TransformStream3<detail::TRANSFORM_COORD>( pInput, inputStride, count, matrix, pOutput, outputStride ); }
+
 
 ASDX_INLINE
 f32 Vector3::ScalarTriple( const Vector3& a, const Vector3& b, const Vector3& c )
@@ -1720,7 +1909,7 @@ bool Vector4::operator == ( const Vector4& v ) const
     return ( x == v.x )
         && ( y == v.y )
         && ( z == v.z )
-        && ( w == v.z );
+        && ( w == v.w );
 }
 
 ASDX_INLINE
@@ -2193,20 +2382,108 @@ void Vector4::SmoothStep( const Vector4 &a, const Vector4 &b, const f32 amount,
 ASDX_INLINE
 Vector4 Vector4::Transform( const Vector4& position, const Matrix& matrix )
 {
-    return Vector4(
-        ( ( ((position.x * matrix._11) + (position.y * matrix._21)) + (position.z * matrix._31) ) + (position.w * matrix._41)),
-        ( ( ((position.x * matrix._12) + (position.y * matrix._22)) + (position.z * matrix._32) ) + (position.w * matrix._42)),
-        ( ( ((position.x * matrix._13) + (position.y * matrix._23)) + (position.z * matrix._33) ) + (position.w * matrix._43)),
-        ( ( ((position.x * matrix._14) + (position.y * matrix._24)) + (position.z * matrix._43) ) + (position.w * matrix._44)) );
+    Vector4 result;
+    Vector4::Transform( position, matrix, result );
+    return result;
 }
 
 ASDX_INLINE
 void Vector4::Transform( const Vector4 &position, const Matrix &matrix, Vector4 &result )
 {
-    result.x = ( ( ((position.x * matrix._11) + (position.y * matrix._21)) + (position.z * matrix._31) ) + (position.w * matrix._41));
-    result.y = ( ( ((position.x * matrix._12) + (position.y * matrix._22)) + (position.z * matrix._32) ) + (position.w * matrix._42));
-    result.z = ( ( ((position.x * matrix._13) + (position.y * matrix._23)) + (position.z * matrix._33) ) + (position.w * matrix._43));
-    result.w = ( ( ((position.x * matrix._14) + (position.y * matrix._24)) + (position.z * matrix._43) ) + (position.w * matrix._44));
+#if ASDX_SIMD_SSE2
+    auto v = simd::TransformRow(
+        _mm_loadu_ps( &position.x ),
+        _mm_loadu_ps( matrix.m[0] ),
+        _mm_loadu_ps( matrix.m[1] ),
+        _mm_loadu_ps( matrix.m[2] ),
+        _mm_loadu_ps( matrix.m[3] ) );
+    _mm_storeu_ps( &result.x, v );
+#else
+    auto x = position.x;
+    auto y = position.y;
+    auto z = position.z;
+    auto w = position.w;
+    result.x = ( ( ((x * matrix._11) + (y * matrix._21)) + (z * matrix._31) ) + (w * matrix._41));
+    result.y = ( ( ((x * matrix._12) + (y * matrix._22)) + (z * matrix._32) ) + (w * matrix._42));
+    result.z = ( ( ((x * matrix._13) + (y * matrix._23)) + (z * matrix._33) ) + (w * matrix._43));
+    result.w = ( ( ((x * matrix._14) + (y * matrix._24)) + (z * matrix._34) ) + (w * matrix._44));
+#endif
+}
+
+ASDX_INLINE
+void Vector4::TransformStream( const Vector4* pInput, u32 inputStride, u32 count, const Matrix& matrix, Vector4* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_AVX2
+    // 8個ずつ SoA に読み込んで変換する.
+    if ( ( inputStride & 0x3 ) == 0 )
+    {
+        auto index = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( inputStride / 4 ) );
+
+        __m256 m[4][4];
+        for( u32 r=0; r<4; ++r )
+        {
+            for( u32 c=0; c<4; ++c )
+            { m[r][c] = _mm256_set1_ps( matrix.m[r][c] ); }
+        }
+
+        ASDX_ALIGN(32) f32 out[4][8];
+        for( ; i + 8 <= count; i += 8 )
+        {
+            auto base = reinterpret_cast<const f32*>( pSrc + size_t( i ) * inputStride );
+            auto x = _mm256_i32gather_ps( base + 0, index, 4 );
+            auto y = _mm256_i32gather_ps( base + 1, index, 4 );
+            auto z = _mm256_i32gather_ps( base + 2, index, 4 );
+            auto w = _mm256_i32gather_ps( base + 3, index, 4 );
+
+            for( u32 c=0; c<4; ++c )
+            {
+                auto v = _mm256_mul_ps( x, m[0][c] );
+                v = simd::MulAdd( y, m[1][c], v );
+                v = simd::MulAdd( z, m[2][c], v );
+                v = simd::MulAdd( w, m[3][c], v );
+                _mm256_store_ps( out[c], v );
+            }
+
+            for( u32 j=0; j<8; ++j )
+            {
+                auto dst = reinterpret_cast<f32*>( pDst + size_t( i + j ) * outputStride );
+                dst[0] = out[0][j];
+                dst[1] = out[1][j];
+                dst[2] = out[2][j];
+                dst[3] = out[3][j];
+            }
+        }
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto& src = *reinterpret_cast<const Vector4*>( pSrc + size_t( i ) * inputStride );
+        auto& dst = *reinterpret_cast<Vector4*>( pDst + size_t( i ) * outputStride );
+        dst = Vector4::Transform( src, matrix );
+    }
+}
+
+ASDX_INLINE
+void TransformStream( const Vector4A* pInput, u32 count, const MatrixA& matrix, Vector4A* pOutput )
+{
+#if ASDX_SIMD_SSE2
+    __m128 rows[4];
+    simd::LoadRows( matrix, rows );
+
+    for( u32 i=0; i<count; ++i )
+    {
+        auto v = simd::TransformRow( simd::Load( pInput[i] ), rows[0], rows[1], rows[2], rows[3] );
+        simd::Store( pOutput[i], v );
+    }
+#else
+    for( u32 i=0; i<count; ++i )
+    { pOutput[i] = Vector4::Transform( pInput[i], matrix ); }
+#endif//ASDX_SIMD_SSE2
 }
 
 
@@ -2417,33 +2694,9 @@ Matrix Matrix::operator - () const
 ASDX_INLINE 
 Matrix Matrix::operator * ( const Matrix& value ) const
 {
-#if 0
-    Matrix tmp = (*this);
-    Matrix result = Multiply( tmp, value );
+    Matrix result;
+    Multiply( (*this), value, result );
     return result;
-#else
-    return Matrix(
-        ( _11 * value._11 ) + ( _12 * value._21 ) + ( _13 * value._31 ) + ( _14 * value._41 ),
-        ( _11 * value._12 ) + ( _12 * value._22 ) + ( _13 * value._32 ) + ( _14 * value._42 ),
-        ( _11 * value._13 ) + ( _12 * value._23 ) + ( _13 * value._33 ) + ( _14 * value._43 ),
-        ( _11 * value._14 ) + ( _12 * value._24 ) + ( _13 * value._34 ) + ( _14 * value._44 ),
-
-        ( _21 * value._11 ) + ( _22 * value._21 ) + ( _23 * value._31 ) + ( _24 * value._41 ),
-        ( _21 * value._12 ) + ( _22 * value._22 ) + ( _23 * value._32 ) + ( _24 * value._42 ),
-        ( _21 * value._13 ) + ( _22 * value._23 ) + ( _23 * value._33 ) + ( _24 * value._43 ),
-        ( _21 * value._14 ) + ( _22 * value._24 ) + ( _23 * value._34 ) + ( _24 * value._44 ),
-
-        ( _31 * value._11 ) + ( _32 * value._21 ) + ( _33 * value._31 ) + ( _34 * value._41 ),
-        ( _31 * value._12 ) + ( _32 * value._22 ) + ( _33 * value._32 ) + ( _34 * value._42 ),
-        ( _31 * value._13 ) + ( _32 * value._23 ) + ( _33 * value._33 ) + ( _34 * value._43 ),
-        ( _31 * value._14 ) + ( _32 * value._24 ) + ( _33 * value._34 ) + ( _34 * value._44 ),
-
-        ( _41 * value._11 ) + ( _42 * value._21 ) + ( _43 * value._31 ) + ( _44 * value._41 ),
-        ( _41 * value._12 ) + ( _42 * value._22 ) + ( _43 * value._32 ) + ( _44 * value._42 ),
-        ( _41 * value._13 ) + ( _42 * value._23 ) + ( _43 * value._33 ) + ( _44 * value._43 ),
-        ( _41 * value._14 ) + ( _42 * value._24 ) + ( _43 * value._34 ) + ( _44 * value._44 )
-    );
-#endif
 }
 
 ASDX_INLINE 
@@ -2503,6 +2756,31 @@ bool Matrix::operator != ( const Matrix& mat ) const
 ASDX_INLINE 
 f32 Matrix::Determinant() const
 {
+#if ASDX_SIMD_SSE2
+    auto r0 = _mm_loadu_ps( m[0] );
+    auto r1 = _mm_loadu_ps( m[1] );
+    auto r2 = _mm_loadu_ps( m[2] );
+    auto r3 = _mm_loadu_ps( m[3] );
+
+    // 2x2 の小行列 A B / C D に分けて det = |A||D| + |B||C| - tr( adj(A) B adj(D) C ) で求める.
+    auto A = _mm_movelh_ps( r0, r1 );
+    auto B = _mm_movehl_ps( r1, r0 );
+    auto C = _mm_movelh_ps( r2, r3 );
+    auto D = _mm_movehl_ps( r3, r2 );
+
+    auto detSub = _mm_sub_ps(
+        _mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE( 2, 0, 2, 0 ) ), _mm_shuffle_ps( r1, r3, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ),
+        _mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE( 3, 1, 3, 1 ) ), _mm_shuffle_ps( r1, r3, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ) );
+
+    auto D_C = simd::Mat2AdjMul( D, C );
+    auto A_B = simd::Mat2AdjMul( A, B );
+
+    auto det = _mm_mul_ss( detSub, ASDX_SIMD_SPLAT( detSub, 3 ) );
+    det = _mm_add_ss( det, _mm_mul_ss( ASDX_SIMD_SPLAT( detSub, 1 ), ASDX_SIMD_SPLAT( detSub, 2 ) ) );
+    det = _mm_sub_ss( det, simd::HorizontalSum( _mm_mul_ps( A_B, ASDX_SIMD_SHUFFLE( D_C, 0, 2, 1, 3 ) ) ) );
+
+    return _mm_cvtss_f32( det );
+#else
     f32 det =
         _11*_22*_33*_44 + _11*_23*_34*_42 +
         _11*_24*_32*_43 + _12*_21*_34*_43 +
@@ -2517,6 +2795,7 @@ f32 Matrix::Determinant() const
         _13*_24*_32*_41 - _14*_21*_32*_43 -
         _14*_22*_33*_41 - _14*_23*_31*_42;
     return det;
+#endif
 }
 
 ASDX_INLINE 
@@ -2558,16 +2837,40 @@ bool Matrix::IsIdentity( const Matrix &value )
 ASDX_INLINE
 Matrix Matrix::Transpose( const Matrix& value )
 {
+#if ASDX_SIMD_SSE2
+    Matrix result;
+    Transpose( value, result );
+    return result;
+#else
     return Matrix(
         value._11, value._21, value._31, value._41,
         value._12, value._22, value._32, value._42,
         value._13, value._23, value._33, value._43,
         value._14, value._24, value._34, value._44 );
+#endif
 }
 
 ASDX_INLINE
 void Matrix::Transpose( const Matrix &value, Matrix &result )
 {
+#if ASDX_SIMD_SSE2
+    auto r0 = _mm_loadu_ps( value.m[0] );
+    auto r1 = _mm_loadu_ps( value.m[1] );
+    auto r2 = _mm_loadu_ps( value.m[2] );
+    auto r3 = _mm_loadu_ps( value.m[3] );
+    _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+    _mm_storeu_ps( result.m[0], r0 );
+    _mm_storeu_ps( result.m[1], r1 );
+    _mm_storeu_ps( result.m[2], r2 );
+    _mm_storeu_ps( result.m[3], r3 );
+#else
+    if ( &value == &result )
+    {
+        Matrix tmp = value;
+        Transpose( tmp, result );
+        return;
+    }
+
     result._11 = value._11;
     result._12 = value._21;
     result._13 = value._31;
@@ -2581,62 +2884,62 @@ void Matrix::Transpose( const Matrix &value, Matrix &result )
     result._31 = value._13;
     result._32 = value._23;
     result._33 = value._33;
-    result._34 = value._34;
+    result._34 = value._43;
 
     result._41 = value._14;
     result._42 = value._24;
     result._43 = value._34;
     result._44 = value._44;
+#endif
 }
 
 ASDX_INLINE
 Matrix Matrix::Multiply( const Matrix& a, const Matrix& b )
 {
-#if 0
-    Matrix tmp;
-    for ( s32 i=0; i<4; i++ )
-        for ( s32 j=0; j<4; j++ )
-            tmp.m[i][j] = a.m[i][0] * b.m[0][j] +
-                          a.m[i][1] * b.m[1][j] +
-                          a.m[i][2] * b.m[2][j] +
-                          a.m[i][3] * b.m[3][j];
-    return tmp;
-#else
-    return Matrix(
-        ( a._11 * b._11 ) + ( a._12 * b._21 ) + ( a._13 * b._31 ) + ( a._14 * b._41 ),
-        ( a._11 * b._12 ) + ( a._12 * b._22 ) + ( a._13 * b._32 ) + ( a._14 * b._42 ),
-        ( a._11 * b._13 ) + ( a._12 * b._23 ) + ( a._13 * b._33 ) + ( a._14 * b._43 ),
-        ( a._11 * b._14 ) + ( a._12 * b._24 ) + ( a._13 * b._34 ) + ( a._14 * b._44 ),
-
-        ( a._21 * b._11 ) + ( a._22 * b._21 ) + ( a._23 * b._31 ) + ( a._24 * b._41 ),
-        ( a._21 * b._12 ) + ( a._22 * b._22 ) + ( a._23 * b._32 ) + ( a._24 * b._42 ),
-        ( a._21 * b._13 ) + ( a._22 * b._23 ) + ( a._23 * b._33 ) + ( a._24 * b._43 ),
-        ( a._21 * b._14 ) + ( a._22 * b._24 ) + ( a._23 * b._34 ) + ( a._24 * b._44 ),
-
-        ( a._31 * b._11 ) + ( a._32 * b._21 ) + ( a._33 * b._31 ) + ( a._34 * b._41 ),
-        ( a._31 * b._12 ) + ( a._32 * b._22 ) + ( a._33 * b._32 ) + ( a._34 * b._42 ),
-        ( a._31 * b._13 ) + ( a._32 * b._23 ) + ( a._33 * b._33 ) + ( a._34 * b._43 ),
-        ( a._31 * b._14 ) + ( a._32 * b._24 ) + ( a._33 * b._34 ) + ( a._34 * b._44 ),
-
-        ( a._41 * b._11 ) + ( a._42 * b._21 ) + ( a._43 * b._31 ) + ( a._44 * b._41 ),
-        ( a._41 * b._12 ) + ( a._42 * b._22 ) + ( a._43 * b._32 ) + ( a._44 * b._42 ),
-        ( a._41 * b._13 ) + ( a._42 * b._23 ) + ( a._43 * b._33 ) + ( a._44 * b._43 ),
-        ( a._41 * b._14 ) + ( a._42 * b._24 ) + ( a._43 * b._34 ) + ( a._44 * b._44 )
-    );
-#endif
+    Matrix result;
+    Multiply( a, b, result );
+    return result;
 }
 
 ASDX_INLINE
 void Matrix::Multiply( const Matrix &a, const Matrix &b, Matrix &result )
 {
-#if 0
-    for ( s32 i=0; i<4; i++ )
-        for ( s32 j=0; j<4; j++ )
-            result.m[i][j] = a.m[i][0] * b.m[0][j] +
-                             a.m[i][1] * b.m[1][j] +
-                             a.m[i][2] * b.m[2][j] +
-                             a.m[i][3] * b.m[3][j];
+#if ASDX_SIMD_AVX
+    // 2行ずつ 256bit で計算する. 全て読み込んでから書き込むので result は a, b と同じでも良い.
+    auto b0 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( b.m[0] ) );
+    auto b1 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( b.m[1] ) );
+    auto b2 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( b.m[2] ) );
+    auto b3 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( b.m[3] ) );
+
+    auto r01 = simd::TransformRow( _mm256_loadu_ps( a.m[0] ), b0, b1, b2, b3 );
+    auto r23 = simd::TransformRow( _mm256_loadu_ps( a.m[2] ), b0, b1, b2, b3 );
+
+    _mm256_storeu_ps( result.m[0], r01 );
+    _mm256_storeu_ps( result.m[2], r23 );
+#elif ASDX_SIMD_SSE2
+    auto b0 = _mm_loadu_ps( b.m[0] );
+    auto b1 = _mm_loadu_ps( b.m[1] );
+    auto b2 = _mm_loadu_ps( b.m[2] );
+    auto b3 = _mm_loadu_ps( b.m[3] );
+
+    auto r0 = simd::TransformRow( _mm_loadu_ps( a.m[0] ), b0, b1, b2, b3 );
+    auto r1 = simd::TransformRow( _mm_loadu_ps( a.m[1] ), b0, b1, b2, b3 );
+    auto r2 = simd::TransformRow( _mm_loadu_ps( a.m[2] ), b0, b1, b2, b3 );
+    auto r3 = simd::TransformRow( _mm_loadu_ps( a.m[3] ), b0, b1, b2, b3 );
+
+    _mm_storeu_ps( result.m[0], r0 );
+    _mm_storeu_ps( result.m[1], r1 );
+    _mm_storeu_ps( result.m[2], r2 );
+    _mm_storeu_ps( result.m[3], r3 );
 #else
+    if ( &result == &a || &result == &b )
+    {
+        Matrix tmp;
+        Multiply( a, b, tmp );
+        result = tmp;
+        return;
+    }
+
     result._11 = ( a._11 * b._11 ) + ( a._12 * b._21 ) + ( a._13 * b._31 ) + ( a._14 * b._41 );
     result._12 = ( a._11 * b._12 ) + ( a._12 * b._22 ) + ( a._13 * b._32 ) + ( a._14 * b._42 );
     result._13 = ( a._11 * b._13 ) + ( a._12 * b._23 ) + ( a._13 * b._33 ) + ( a._14 * b._43 );
@@ -2697,43 +3000,39 @@ void Matrix::Multiply( const Matrix &value, const f32 scaleFactor, Matrix &resul
 ASDX_INLINE
 Matrix Matrix::MultiplyTranspose( const Matrix& a, const Matrix& b )
 {
-#if 0
     Matrix result;
-    result = Multiply( a, b );
-    result = Transpose( result );
+    MultiplyTranspose( a, b, result );
     return result;
-#else
-    return Matrix(
-        ( a._11 * b._11 ) + ( a._12 * b._21 ) + ( a._13 * b._31 ) + ( a._14 * b._41 ),
-        ( a._11 * b._12 ) + ( a._12 * b._22 ) + ( a._13 * b._32 ) + ( a._14 * b._42 ),
-        ( a._11 * b._13 ) + ( a._12 * b._23 ) + ( a._13 * b._33 ) + ( a._14 * b._43 ),
-        ( a._11 * b._14 ) + ( a._12 * b._24 ) + ( a._13 * b._34 ) + ( a._14 * b._44 ),
-
-        ( a._21 * b._11 ) + ( a._22 * b._21 ) + ( a._23 * b._31 ) + ( a._24 * b._41 ),
-        ( a._21 * b._12 ) + ( a._22 * b._22 ) + ( a._23 * b._32 ) + ( a._24 * b._42 ),
-        ( a._21 * b._13 ) + ( a._22 * b._23 ) + ( a._23 * b._33 ) + ( a._24 * b._43 ),
-        ( a._21 * b._14 ) + ( a._22 * b._24 ) + ( a._23 * b._34 ) + ( a._24 * b._44 ),
-
-        ( a._31 * b._11 ) + ( a._32 * b._21 ) + ( a._33 * b._31 ) + ( a._34 * b._41 ),
-        ( a._31 * b._12 ) + ( a._32 * b._22 ) + ( a._33 * b._32 ) + ( a._34 * b._42 ),
-        ( a._31 * b._13 ) + ( a._32 * b._23 ) + ( a._33 * b._33 ) + ( a._34 * b._43 ),
-        ( a._31 * b._14 ) + ( a._32 * b._24 ) + ( a._33 * b._34 ) + ( a._34 * b._44 ),
-
-        ( a._41 * b._11 ) + ( a._42 * b._21 ) + ( a._43 * b._31 ) + ( a._44 * b._41 ),
-        ( a._41 * b._12 ) + ( a._42 * b._22 ) + ( a._43 * b._32 ) + ( a._44 * b._42 ),
-        ( a._41 * b._13 ) + ( a._42 * b._23 ) + ( a._43 * b._33 ) + ( a._44 * b._43 ),
-        ( a._41 * b._14 ) + ( a._42 * b._24 ) + ( a._43 * b._34 ) + ( a._44 * b._44 )
-    );
-#endif
 }
 
 ASDX_INLINE
 void Matrix::MultiplyTranspose( const Matrix &a, const Matrix &b, Matrix &result )
 {
-#if 0
-    result = Multiply( a, b );
-    result = Transpose( result );
+#if ASDX_SIMD_SSE2
+    auto b0 = _mm_loadu_ps( b.m[0] );
+    auto b1 = _mm_loadu_ps( b.m[1] );
+    auto b2 = _mm_loadu_ps( b.m[2] );
+    auto b3 = _mm_loadu_ps( b.m[3] );
+
+    auto r0 = simd::TransformRow( _mm_loadu_ps( a.m[0] ), b0, b1, b2, b3 );
+    auto r1 = simd::TransformRow( _mm_loadu_ps( a.m[1] ), b0, b1, b2, b3 );
+    auto r2 = simd::TransformRow( _mm_loadu_ps( a.m[2] ), b0, b1, b2, b3 );
+    auto r3 = simd::TransformRow( _mm_loadu_ps( a.m[3] ), b0, b1, b2, b3 );
+    _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+
+    _mm_storeu_ps( result.m[0], r0 );
+    _mm_storeu_ps( result.m[1], r1 );
+    _mm_storeu_ps( result.m[2], r2 );
+    _mm_storeu_ps( result.m[3], r3 );
 #else
+    if ( &result == &a || &result == &b )
+    {
+        Matrix tmp;
+        MultiplyTranspose( a, b, tmp );
+        result = tmp;
+        return;
+    }
+
     result._11 = ( a._11 * b._11 ) + ( a._12 * b._21 ) + ( a._13 * b._31 ) + ( a._14 * b._41 );
     result._21 = ( a._11 * b._12 ) + ( a._12 * b._22 ) + ( a._13 * b._32 ) + ( a._14 * b._42 );
     result._31 = ( a._11 * b._13 ) + ( a._12 * b._23 ) + ( a._13 * b._33 ) + ( a._14 * b._43 );
@@ -2753,7 +3052,6 @@ void Matrix::MultiplyTranspose( const Matrix &a, const Matrix &b, Matrix &result
     result._24 = ( a._41 * b._12 ) + ( a._42 * b._22 ) + ( a._43 * b._32 ) + ( a._44 * b._42 );
     result._34 = ( a._41 * b._13 ) + ( a._42 * b._23 ) + ( a._43 * b._33 ) + ( a._44 * b._43 );
     result._44 = ( a._41 * b._14 ) + ( a._42 * b._24 ) + ( a._43 * b._34 ) + ( a._44 * b._44 );
-
 #endif
 }
 
@@ -2761,55 +3059,65 @@ ASDX_INLINE
 Matrix Matrix::Invert( const Matrix& value )
 {
     Matrix result;
-    register f32 det = value.Determinant();
-    assert( det != 0.0f );
-
-    result._11 = value._22*value._33*value._44 + value._23*value._34*value._42 + value._24*value._32*value._43 - value._22*value._34*value._43 - value._23*value._32*value._44 - value._24*value._33*value._42;
-    result._12 = value._12*value._34*value._43 + value._13*value._32*value._44 + value._14*value._33*value._42 - value._12*value._33*value._44 - value._13*value._34*value._42 - value._14*value._32*value._43;
-    result._13 = value._12*value._23*value._44 + value._13*value._24*value._42 + value._14*value._22*value._43 - value._12*value._24*value._43 - value._13*value._22*value._44 - value._14*value._23*value._42;
-    result._14 = value._12*value._24*value._33 + value._13*value._22*value._34 + value._14*value._23*value._32 - value._12*value._23*value._34 - value._13*value._24*value._32 - value._14*value._22*value._33;
-
-    result._21 = value._21*value._34*value._43 + value._23*value._31*value._44 + value._24*value._33*value._41 - value._21*value._33*value._44 - value._23*value._34*value._41 - value._24*value._31*value._43;
-    result._22 = value._11*value._33*value._44 + value._13*value._34*value._41 + value._14*value._31*value._43 - value._11*value._34*value._43 - value._13*value._31*value._44 - value._14*value._33*value._41;
-    result._23 = value._11*value._24*value._43 + value._13*value._21*value._44 + value._14*value._23*value._41 - value._11*value._23*value._44 - value._13*value._24*value._41 - value._14*value._21*value._43;
-    result._24 = value._11*value._23*value._34 + value._13*value._24*value._31 + value._14*value._21*value._33 - value._11*value._24*value._33 - value._13*value._21*value._34 - value._14*value._23*value._31;
-
-    result._31 = value._21*value._32*value._44 + value._22*value._34*value._41 + value._24*value._31*value._42 - value._21*value._34*value._42 - value._22*value._31*value._44 - value._24*value._32*value._41;
-    result._32 = value._11*value._34*value._42 + value._12*value._31*value._44 + value._14*value._32*value._41 - value._11*value._32*value._44 - value._12*value._34*value._41 - value._14*value._31*value._42;
-    result._33 = value._11*value._22*value._44 + value._12*value._24*value._41 + value._14*value._21*value._42 - value._11*value._24*value._42 - value._12*value._21*value._44 - value._14*value._22*value._41;
-    result._34 = value._11*value._24*value._32 + value._12*value._21*value._34 + value._14*value._22*value._31 - value._11*value._22*value._34 - value._12*value._24*value._31 - value._14*value._21*value._32;
-
-    result._41 = value._21*value._33*value._42 + value._22*value._31*value._43 + value._23*value._32*value._41 - value._21*value._32*value._43 - value._22*value._33*value._41 - value._23*value._31*value._42;
-    result._42 = value._11*value._32*value._43 + value._12*value._33*value._41 + value._13*value._31*value._42 - value._11*value._33*value._42 - value._12*value._31*value._43 - value._13*value._32*value._41;
-    result._43 = value._11*value._23*value._42 + value._12*value._21*value._43 + value._13*value._22*value._41 - value._11*value._22*value._43 - value._12*value._23*value._41 - value._13*value._21*value._42;
-    result._44 = value._11*value._22*value._33 + value._12*value._23*value._31 + value._13*value._21*value._32 - value._11*value._23*value._32 - value._12*value._21*value._33 - value._13*value._22*value._31;
-
-    result._11 /= det;
-    result._12 /= det;
-    result._13 /= det;
-    result._14 /= det;
-
-    result._21 /= det;
-    result._22 /= det;
-    result._23 /= det;
-    result._24 /= det;
-
-    result._31 /= det;
-    result._32 /= det;
-    result._33 /= det;
-    result._34 /= det;
-
-    result._41 /= det;
-    result._42 /= det;
-    result._43 /= det;
-    result._44 /= det;
-
+    Invert( value, result );
     return result;
 }
 
 ASDX_INLINE
 void Matrix::Invert( const Matrix &value, Matrix &result )
 { 
+#if ASDX_SIMD_SSE2
+    auto r0 = _mm_loadu_ps( value.m[0] );
+    auto r1 = _mm_loadu_ps( value.m[1] );
+    auto r2 = _mm_loadu_ps( value.m[2] );
+    auto r3 = _mm_loadu_ps( value.m[3] );
+
+    // 2x2 の小行列 A B / C D に分けてブロック単位で余因子を求める.
+    auto A = _mm_movelh_ps( r0, r1 );
+    auto B = _mm_movehl_ps( r1, r0 );
+    auto C = _mm_movelh_ps( r2, r3 );
+    auto D = _mm_movehl_ps( r3, r2 );
+
+    // |A|, |B|, |C|, |D|
+    auto detSub = _mm_sub_ps(
+        _mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE( 2, 0, 2, 0 ) ), _mm_shuffle_ps( r1, r3, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ),
+        _mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE( 3, 1, 3, 1 ) ), _mm_shuffle_ps( r1, r3, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ) );
+    auto detA = ASDX_SIMD_SPLAT( detSub, 0 );
+    auto detB = ASDX_SIMD_SPLAT( detSub, 1 );
+    auto detC = ASDX_SIMD_SPLAT( detSub, 2 );
+    auto detD = ASDX_SIMD_SPLAT( detSub, 3 );
+
+    auto D_C = simd::Mat2AdjMul( D, C );
+    auto A_B = simd::Mat2AdjMul( A, B );
+
+    auto X = simd::NegMulAdd( detD, A, simd::Mat2Mul( B, D_C ) );
+    auto W = simd::NegMulAdd( detA, D, simd::Mat2Mul( C, A_B ) );
+    auto Y = simd::NegMulAdd( detB, C, simd::Mat2MulAdj( D, A_B ) );
+    auto Z = simd::NegMulAdd( detC, B, simd::Mat2MulAdj( A, D_C ) );
+
+    auto det = _mm_add_ps( _mm_mul_ps( detA, detD ), _mm_mul_ps( detB, detC ) );
+    det = _mm_sub_ps( det, simd::HorizontalSum( _mm_mul_ps( A_B, ASDX_SIMD_SHUFFLE( D_C, 0, 2, 1, 3 ) ) ) );
+    assert( _mm_cvtss_f32( det ) != 0.0f );
+
+    // 上で求めたブロックは符号が反転しているので, 符号込みで行列式の逆数を掛ける.
+    auto rcp = _mm_div_ps( _mm_setr_ps( -1.0f, 1.0f, 1.0f, -1.0f ), det );
+    X = _mm_mul_ps( X, rcp );
+    Y = _mm_mul_ps( Y, rcp );
+    Z = _mm_mul_ps( Z, rcp );
+    W = _mm_mul_ps( W, rcp );
+
+    _mm_storeu_ps( result.m[0], _mm_shuffle_ps( X, Y, _MM_SHUFFLE( 1, 3, 1, 3 ) ) );
+    _mm_storeu_ps( result.m[1], _mm_shuffle_ps( X, Y, _MM_SHUFFLE( 0, 2, 0, 2 ) ) );
+    _mm_storeu_ps( result.m[2], _mm_shuffle_ps( Z, W, _MM_SHUFFLE( 1, 3, 1, 3 ) ) );
+    _mm_storeu_ps( result.m[3], _mm_shuffle_ps( Z, W, _MM_SHUFFLE( 0, 2, 0, 2 ) ) );
+#else
+    if ( &value == &result )
+    {
+        Matrix tmp = value;
+        Invert( tmp, result );
+        return;
+    }
+
     register f32 det = value.Determinant();
     assert( det != 0.0f );
 
@@ -2852,6 +3160,7 @@ void Matrix::Invert( const Matrix &value, Matrix &result )
     result._42 /= det;
     result._43 /= det;
     result._44 /= det;
+#endif
 }
 
 ASDX_INLINE
@@ -3027,8 +3336,8 @@ void Matrix::CreateTranslation( const Vector3 &pos, Matrix &result )
 ASDX_INLINE 
 Matrix Matrix::CreateRotationX( const f32 radian )
 {
-    register f32 cosRad = cosf(radian);
-    register f32 sinRad = sinf(radian);
+    register f32 cosRad = Cos(radian);
+    register f32 sinRad = Sin(radian);
     return Matrix(
         1.0f,   0.0f,   0.0f,   0.0f,
         0.0f,   cosRad, sinRad, 0.0f,
@@ -3039,8 +3348,8 @@ Matrix Matrix::CreateRotationX( const f32 radian )
 ASDX_INLINE 
 void Matrix::CreateRotationX( const f32 radian, Matrix &result )
 {
-    register f32 cosRad = cosf( radian );
-    register f32 sinRad = sinf( radian );
+    register f32 cosRad = Cos( radian );
+    register f32 sinRad = Sin( radian );
 
     result._11 = 1.0f;
     result._12 = 0.0f;
@@ -3066,8 +3375,8 @@ void Matrix::CreateRotationX( const f32 radian, Matrix &result )
 ASDX_INLINE 
 Matrix Matrix::CreateRotationY( const f32 radian )
 {
-    register f32 cosRad = cosf( radian );
-    register f32 sinRad = sinf( radian );
+    register f32 cosRad = Cos( radian );
+    register f32 sinRad = Sin( radian );
 
     return Matrix(
         cosRad, 0.0f,  -sinRad, 0.0f,
@@ -3079,8 +3388,8 @@ Matrix Matrix::CreateRotationY( const f32 radian )
 ASDX_INLINE
 void Matrix::CreateRotationY( const f32 radian, Matrix &result )
 {
-    register f32 cosRad = cosf( radian );
-    register f32 sinRad = sinf( radian );
+    register f32 cosRad = Cos( radian );
+    register f32 sinRad = Sin( radian );
 
     result._11 = cosRad;
     result._12 = 0.0f;
@@ -3106,8 +3415,8 @@ void Matrix::CreateRotationY( const f32 radian, Matrix &result )
 ASDX_INLINE
 Matrix Matrix::CreateRotationZ( const f32 radian )
 {
-    register f32 cosRad = cosf( radian );
-    register f32 sinRad = sinf( radian );
+    register f32 cosRad = Cos( radian );
+    register f32 sinRad = Sin( radian );
 
     return Matrix( 
         cosRad, sinRad, 0.0f, 0.0f,
@@ -3119,8 +3428,8 @@ Matrix Matrix::CreateRotationZ( const f32 radian )
 ASDX_INLINE
 void Matrix::CreateRotationZ( const f32 radian, Matrix &result )
 {
-    register f32 cosRad = cosf( radian );
-    register f32 sinRad = sinf( radian );
+    register f32 cosRad = Cos( radian );
+    register f32 sinRad = Sin( radian );
 
     result._11 = cosRad;
     result._12 = sinRad;
@@ -3159,7 +3468,7 @@ Matrix Matrix::CreateFromQuaternion( const Quaternion& qua )
 
     result._11 = 1.0f - (2.0f * (yy + zz));
     result._12 = 2.0f * (xy + zw);
-    result._13 = 2.0f * (zx - yz);
+    result._13 = 2.0f * (zx - yw);
     result._14 = 0.0f;
 
     result._21 = 2.0f * (xy - zw);
@@ -3195,7 +3504,7 @@ void Matrix::CreateFromQuaternion( const Quaternion &qua, Matrix &result )
 
     result._11 = 1.0f - (2.0f * (yy + zz));
     result._12 = 2.0f * (xy + zw);
-    result._13 = 2.0f * (zx - yz);
+    result._13 = 2.0f * (zx - yw);
     result._14 = 0.0f;
 
     result._21 = 2.0f * (xy - zw);
@@ -3218,8 +3527,8 @@ ASDX_INLINE
 Matrix Matrix::CreateFromAxisAngle( const Vector3& axis, const f32 radian )
 {
     Matrix result;
-    register f32 sinRad = sinf(radian);
-    register f32 cosRad = cosf(radian);
+    register f32 sinRad = Sin(radian);
+    register f32 cosRad = Cos(radian);
     register f32 a = 1.0f -cosRad;
     
     register f32 ab = axis.x * axis.y * a;
@@ -3255,8 +3564,8 @@ Matrix Matrix::CreateFromAxisAngle( const Vector3& axis, const f32 radian )
 ASDX_INLINE
 void Matrix::CreateFromAxisAngle( const Vector3 &axis, const f32 radian, Matrix &result )
 {
-    register f32 sinRad = sinf(radian);
-    register f32 cosRad = cosf(radian);
+    register f32 sinRad = Sin(radian);
+    register f32 cosRad = Cos(radian);
     register f32 a = 1.0f -cosRad;
     
     register f32 ab = axis.x * axis.y * a;
@@ -3802,6 +4111,310 @@ void Matrix::Lerp( const Matrix& a, const Matrix& b, const f32 amount, Matrix &r
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Matrix3x4 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+ASDX_INLINE
+Matrix3x4::Matrix3x4()
+{ /* DO_NOTHING */ }
+
+ASDX_INLINE
+Matrix3x4::Matrix3x4( const f32* pf )
+{
+    assert( pf != 0 );
+    memcpy( &_11, pf, sizeof(Matrix3x4) );
+}
+
+ASDX_INLINE
+Matrix3x4::Matrix3x4( f32 _f11, f32 _f12, f32 _f13, f32 _f14,
+                      f32 _f21, f32 _f22, f32 _f23, f32 _f24,
+                      f32 _f31, f32 _f32, f32 _f33, f32 _f34 )
+{
+    _11 = _f11; _12 = _f12; _13 = _f13; _14 = _f14;
+    _21 = _f21; _22 = _f22; _23 = _f23; _24 = _f24;
+    _31 = _f31; _32 = _f32; _33 = _f33; _34 = _f34;
+}
+
+ASDX_INLINE
+Matrix3x4::Matrix3x4( const Matrix& value )
+{
+#if ASDX_SIMD_SSE2
+    auto r0 = _mm_loadu_ps( value.m[0] );
+    auto r1 = _mm_loadu_ps( value.m[1] );
+    auto r2 = _mm_loadu_ps( value.m[2] );
+    auto r3 = _mm_loadu_ps( value.m[3] );
+    _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+    _mm_storeu_ps( m[0], r0 );
+    _mm_storeu_ps( m[1], r1 );
+    _mm_storeu_ps( m[2], r2 );
+#else
+    _11 = value._11; _12 = value._21; _13 = value._31; _14 = value._41;
+    _21 = value._12; _22 = value._22; _23 = value._32; _24 = value._42;
+    _31 = value._13; _32 = value._23; _33 = value._33; _34 = value._43;
+#endif
+}
+
+ASDX_INLINE
+f32& Matrix3x4::operator () ( u32 iRow, u32 iCol )
+{ return m[iRow][iCol]; }
+
+ASDX_INLINE
+f32 Matrix3x4::operator () ( u32 iRow, u32 iCol ) const
+{ return m[iRow][iCol]; }
+
+ASDX_INLINE
+Matrix3x4& Matrix3x4::operator *= ( const Matrix3x4& value )
+{
+    Multiply( *this, value, *this );
+    return (*this);
+}
+
+ASDX_INLINE
+Matrix3x4 Matrix3x4::operator * ( const Matrix3x4& value ) const
+{
+    Matrix3x4 result;
+    Multiply( *this, value, result );
+    return result;
+}
+
+ASDX_INLINE
+bool Matrix3x4::operator == ( const Matrix3x4& value ) const
+{ return ( 0 == memcmp( this, &value, sizeof( Matrix3x4 ) ) ); }
+
+ASDX_INLINE
+bool Matrix3x4::operator != ( const Matrix3x4& value ) const
+{ return ( 0 != memcmp( this, &value, sizeof( Matrix3x4 ) ) ); }
+
+ASDX_INLINE
+Matrix Matrix3x4::ToMatrix() const
+{
+#if ASDX_SIMD_SSE2
+    Matrix result;
+    auto r0 = _mm_loadu_ps( m[0] );
+    auto r1 = _mm_loadu_ps( m[1] );
+    auto r2 = _mm_loadu_ps( m[2] );
+    auto r3 = _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f );
+    _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+    _mm_storeu_ps( result.m[0], r0 );
+    _mm_storeu_ps( result.m[1], r1 );
+    _mm_storeu_ps( result.m[2], r2 );
+    _mm_storeu_ps( result.m[3], r3 );
+    return result;
+#else
+    return Matrix(
+        _11, _21, _31, 0.0f,
+        _12, _22, _32, 0.0f,
+        _13, _23, _33, 0.0f,
+        _14, _24, _34, 1.0f );
+#endif
+}
+
+ASDX_INLINE
+f32 Matrix3x4::Determinant() const
+{
+    return _11 * ( _22 * _33 - _23 * _32 )
+         + _12 * ( _23 * _31 - _21 * _33 )
+         + _13 * ( _21 * _32 - _22 * _31 );
+}
+
+ASDX_INLINE
+Matrix3x4& Matrix3x4::Neutral()
+{
+    _11 = _22 = _33 = 1.0f;
+    _12 = _13 = _14 =
+    _21 = _23 = _24 =
+    _31 = _32 = _34 = 0.0f;
+    return (*this);
+}
+
+ASDX_INLINE
+Matrix3x4 Matrix3x4::Identity()
+{
+    return Matrix3x4(
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f );
+}
+
+ASDX_INLINE
+Matrix3x4 Matrix3x4::Multiply( const Matrix3x4& a, const Matrix3x4& b )
+{
+    Matrix3x4 result;
+    Multiply( a, b, result );
+    return result;
+}
+
+ASDX_INLINE
+void Matrix3x4::Multiply( const Matrix3x4& a, const Matrix3x4& b, Matrix3x4 &result )
+{
+    // 転置して保持しているので b * a の順に掛ける.
+#if ASDX_SIMD_SSE2
+    auto a0 = _mm_loadu_ps( a.m[0] );
+    auto a1 = _mm_loadu_ps( a.m[1] );
+    auto a2 = _mm_loadu_ps( a.m[2] );
+    auto b0 = _mm_loadu_ps( b.m[0] );
+    auto b1 = _mm_loadu_ps( b.m[1] );
+    auto b2 = _mm_loadu_ps( b.m[2] );
+
+    // 平行移動成分は暗黙の4行目 (0, 0, 0, 1) との積.
+    auto maskW = _mm_castsi128_ps( _mm_setr_epi32( 0, 0, 0, -1 ) );
+
+    auto r0 = _mm_mul_ps( ASDX_SIMD_SPLAT( b0, 0 ), a0 );
+    r0 = simd::MulAdd( ASDX_SIMD_SPLAT( b0, 1 ), a1, r0 );
+    r0 = simd::MulAdd( ASDX_SIMD_SPLAT( b0, 2 ), a2, r0 );
+    r0 = _mm_add_ps( r0, _mm_and_ps( b0, maskW ) );
+
+    auto r1 = _mm_mul_ps( ASDX_SIMD_SPLAT( b1, 0 ), a0 );
+    r1 = simd::MulAdd( ASDX_SIMD_SPLAT( b1, 1 ), a1, r1 );
+    r1 = simd::MulAdd( ASDX_SIMD_SPLAT( b1, 2 ), a2, r1 );
+    r1 = _mm_add_ps( r1, _mm_and_ps( b1, maskW ) );
+
+    auto r2 = _mm_mul_ps( ASDX_SIMD_SPLAT( b2, 0 ), a0 );
+    r2 = simd::MulAdd( ASDX_SIMD_SPLAT( b2, 1 ), a1, r2 );
+    r2 = simd::MulAdd( ASDX_SIMD_SPLAT( b2, 2 ), a2, r2 );
+    r2 = _mm_add_ps( r2, _mm_and_ps( b2, maskW ) );
+
+    _mm_storeu_ps( result.m[0], r0 );
+    _mm_storeu_ps( result.m[1], r1 );
+    _mm_storeu_ps( result.m[2], r2 );
+#else
+    if ( &a == &result || &b == &result )
+    {
+        Matrix3x4 tmpA = a;
+        Matrix3x4 tmpB = b;
+        Multiply( tmpA, tmpB, result );
+        return;
+    }
+
+    for( u32 i=0; i<3; ++i )
+    {
+        result.m[i][0] = ( ( b.m[i][0] * a._11 ) + ( b.m[i][1] * a._21 ) ) + ( b.m[i][2] * a._31 );
+        result.m[i][1] = ( ( b.m[i][0] * a._12 ) + ( b.m[i][1] * a._22 ) ) + ( b.m[i][2] * a._32 );
+        result.m[i][2] = ( ( b.m[i][0] * a._13 ) + ( b.m[i][1] * a._23 ) ) + ( b.m[i][2] * a._33 );
+        result.m[i][3] = ( ( ( b.m[i][0] * a._14 ) + ( b.m[i][1] * a._24 ) ) + ( b.m[i][2] * a._34 ) ) + b.m[i][3];
+    }
+#endif
+}
+
+ASDX_INLINE
+Matrix3x4 Matrix3x4::Invert( const Matrix3x4& value )
+{
+    Matrix3x4 result;
+    Invert( value, result );
+    return result;
+}
+
+ASDX_INLINE
+void Matrix3x4::Invert( const Matrix3x4& value, Matrix3x4 &result )
+{
+    // 3x3 部分 M の逆行列の列は各行の外積を行列式で割ったもの.
+    // 平行移動は -M^-1 * t で求める.
+#if ASDX_SIMD_SSE2
+    auto r0 = _mm_loadu_ps( value.m[0] );
+    auto r1 = _mm_loadu_ps( value.m[1] );
+    auto r2 = _mm_loadu_ps( value.m[2] );
+
+    auto c0 = simd::Cross3( r1, r2 );
+    auto c1 = simd::Cross3( r2, r0 );
+    auto c2 = simd::Cross3( r0, r1 );
+
+    auto maskXYZ = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+    auto det = simd::HorizontalSum( _mm_mul_ps( _mm_and_ps( r0, maskXYZ ), c0 ) );
+    assert( _mm_cvtss_f32( det ) != 0.0f );
+
+    auto t = _mm_mul_ps( c0, ASDX_SIMD_SPLAT( r0, 3 ) );
+    t = simd::MulAdd( c1, ASDX_SIMD_SPLAT( r1, 3 ), t );
+    t = simd::MulAdd( c2, ASDX_SIMD_SPLAT( r2, 3 ), t );
+    t = _mm_sub_ps( _mm_setzero_ps(), t );
+
+    _MM_TRANSPOSE4_PS( c0, c1, c2, t );
+
+    auto rcp = _mm_div_ps( _mm_set1_ps( 1.0f ), det );
+    _mm_storeu_ps( result.m[0], _mm_mul_ps( c0, rcp ) );
+    _mm_storeu_ps( result.m[1], _mm_mul_ps( c1, rcp ) );
+    _mm_storeu_ps( result.m[2], _mm_mul_ps( c2, rcp ) );
+#else
+    if ( &value == &result )
+    {
+        Matrix3x4 tmp = value;
+        Invert( tmp, result );
+        return;
+    }
+
+    auto c11 = value._22 * value._33 - value._23 * value._32;
+    auto c12 = value._23 * value._31 - value._21 * value._33;
+    auto c13 = value._21 * value._32 - value._22 * value._31;
+    auto c21 = value._32 * value._13 - value._33 * value._12;
+    auto c22 = value._33 * value._11 - value._31 * value._13;
+    auto c23 = value._31 * value._12 - value._32 * value._11;
+    auto c31 = value._12 * value._23 - value._13 * value._22;
+    auto c32 = value._13 * value._21 - value._11 * value._23;
+    auto c33 = value._11 * value._22 - value._12 * value._21;
+
+    auto det = value._11 * c11 + value._12 * c12 + value._13 * c13;
+    assert( det != 0.0f );
+    auto rcp = 1.0f / det;
+
+    auto tx = -( ( c11 * value._14 + c21 * value._24 ) + c31 * value._34 );
+    auto ty = -( ( c12 * value._14 + c22 * value._24 ) + c32 * value._34 );
+    auto tz = -( ( c13 * value._14 + c23 * value._24 ) + c33 * value._34 );
+
+    result._11 = c11 * rcp; result._12 = c21 * rcp; result._13 = c31 * rcp; result._14 = tx * rcp;
+    result._21 = c12 * rcp; result._22 = c22 * rcp; result._23 = c32 * rcp; result._24 = ty * rcp;
+    result._31 = c13 * rcp; result._32 = c23 * rcp; result._33 = c33 * rcp; result._34 = tz * rcp;
+#endif
+}
+
+ASDX_INLINE
+Matrix3x4 Matrix3x4::InvertRigid( const Matrix3x4& value )
+{
+    Matrix3x4 result;
+    InvertRigid( value, result );
+    return result;
+}
+
+ASDX_INLINE
+void Matrix3x4::InvertRigid( const Matrix3x4& value, Matrix3x4 &result )
+{
+    // 回転部分は直交行列なので転置が逆行列になる.
+#if ASDX_SIMD_SSE2
+    auto maskXYZ = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+    auto r0 = _mm_loadu_ps( value.m[0] );
+    auto r1 = _mm_loadu_ps( value.m[1] );
+    auto r2 = _mm_loadu_ps( value.m[2] );
+
+    auto t = _mm_mul_ps( r0, ASDX_SIMD_SPLAT( r0, 3 ) );
+    t = simd::MulAdd( r1, ASDX_SIMD_SPLAT( r1, 3 ), t );
+    t = simd::MulAdd( r2, ASDX_SIMD_SPLAT( r2, 3 ), t );
+    t = _mm_sub_ps( _mm_setzero_ps(), t );
+
+    r0 = _mm_and_ps( r0, maskXYZ );
+    r1 = _mm_and_ps( r1, maskXYZ );
+    r2 = _mm_and_ps( r2, maskXYZ );
+    _MM_TRANSPOSE4_PS( r0, r1, r2, t );
+
+    _mm_storeu_ps( result.m[0], r0 );
+    _mm_storeu_ps( result.m[1], r1 );
+    _mm_storeu_ps( result.m[2], r2 );
+#else
+    if ( &value == &result )
+    {
+        Matrix3x4 tmp = value;
+        InvertRigid( tmp, result );
+        return;
+    }
+
+    result._11 = value._11; result._12 = value._21; result._13 = value._31;
+    result._21 = value._12; result._22 = value._22; result._23 = value._32;
+    result._31 = value._13; result._32 = value._23; result._33 = value._33;
+
+    result._14 = -( ( value._11 * value._14 + value._21 * value._24 ) + value._31 * value._34 );
+    result._24 = -( ( value._12 * value._14 + value._22 * value._24 ) + value._32 * value._34 );
+    result._34 = -( ( value._13 * value._14 + value._23 * value._24 ) + value._33 * value._34 );
+#endif
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Quaternion
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3903,11 +4516,11 @@ Quaternion Quaternion::operator - () const
 
 ASDX_INLINE 
 Quaternion Quaternion::operator + ( const Quaternion& q ) const
-{ return Quaternion( x + q.x, y + q.y, z + q.z, w + q.z ); }
+{ return Quaternion( x + q.x, y + q.y, z + q.z, w + q.w ); }
 
 ASDX_INLINE 
 Quaternion Quaternion::operator - ( const Quaternion& q ) const
-{ return Quaternion( x - q.x, y - q.y, z - q.z, w - q.z ); }
+{ return Quaternion( x - q.x, y - q.y, z - q.z, w - q.w ); }
 
 ASDX_INLINE 
 Quaternion Quaternion::operator * ( const Quaternion& q ) const
@@ -4220,12 +4833,12 @@ ASDX_INLINE
 Quaternion Quaternion::CreateFromYawPitchRoll( const f32 yaw, const f32 pitch, const f32 roll )
 {
     Quaternion result;
-    f32 sr = sinf( roll  * 0.5f );
-    f32 cr = cosf( roll  * 0.5f );
-    f32 sp = sinf( pitch * 0.5f );
-    f32 cp = cosf( pitch * 0.5f );
-    f32 sy = sinf( yaw   * 0.5f );
-    f32 cy = cosf( yaw   * 0.5f );
+    f32 sr = Sin( roll  * 0.5f );
+    f32 cr = Cos( roll  * 0.5f );
+    f32 sp = Sin( pitch * 0.5f );
+    f32 cp = Cos( pitch * 0.5f );
+    f32 sy = Sin( yaw   * 0.5f );
+    f32 cy = Cos( yaw   * 0.5f );
 
     result.x = -(sy * sp * cr) + (cy * cp * sr);
     result.y =  (cy * sp * cr) + (sy * cp * sr);
@@ -4237,12 +4850,12 @@ Quaternion Quaternion::CreateFromYawPitchRoll( const f32 yaw, const f32 pitch, c
 ASDX_INLINE
 void Quaternion::CreateFromYawPitchRoll( const f32 yaw, const f32 pitch, const f32 roll, Quaternion &result )
 {
-    f32 sr = sinf( roll  * 0.5f );
-    f32 cr = cosf( roll  * 0.5f );
-    f32 sp = sinf( pitch * 0.5f );
-    f32 cp = cosf( pitch * 0.5f );
-    f32 sy = sinf( yaw   * 0.5f );
-    f32 cy = cosf( yaw   * 0.5f );
+    f32 sr = Sin( roll  * 0.5f );
+    f32 cr = Cos( roll  * 0.5f );
+    f32 sp = Sin( pitch * 0.5f );
+    f32 cp = Cos( pitch * 0.5f );
+    f32 sy = Sin( yaw   * 0.5f );
+    f32 cy = Cos( yaw   * 0.5f );
 
     result.x = -(sy * sp * cr) + (cy * cp * sr);
     result.y =  (cy * sp * cr) + (sy * cp * sr);
@@ -4254,12 +4867,12 @@ ASDX_INLINE
 Quaternion  Quaternion::CreateFromAxisAngle( const Vector3& axis, const f32 radian )
 {
     register f32 halfRad = radian * 0.5f;
-    register f32 sinX = sinf( halfRad );
+    register f32 sinX = Sin( halfRad );
     return Quaternion(
         axis.x * sinX,
         axis.y * sinX,
         axis.z * sinX,
-        cosf( halfRad )
+        Cos( halfRad )
    );
 }
 
@@ -4272,11 +4885,11 @@ void    Quaternion::CreateFromAxisAngle
 )
 {
     register f32 halfRad = radian * 0.5f;
-    register f32 sinX = sinf( halfRad );
+    register f32 sinX = Sin( halfRad );
     result.x = axis.x * sinX;
     result.y = axis.y * sinX;
     result.z = axis.z * sinX;
-    result.w = cosf( halfRad );
+    result.w = Cos( halfRad );
 }
 
 ASDX_INLINE
@@ -4391,7 +5004,7 @@ Quaternion Quaternion::Slerp( const Quaternion& a, const Quaternion& b, const f3
     if ( cosOmega < 0.0f )
     {
         flag = true;
-        cosOmega -= cosOmega;
+        cosOmega = -cosOmega;
     }
 
     f32 k1, k2;
@@ -4402,16 +5015,16 @@ Quaternion Quaternion::Slerp( const Quaternion& a, const Quaternion& b, const f3
     }
     else
     {
-        register f32 q5 = acosf( cosOmega );
-        register f32 q6 = 1.0f / sinf( q5 );
-        k1 = sinf( ( 1.0f - amount ) * q5 ) * q6;
-        k2 = ( flag ) ? -sinf( amount * q5 ) * q6 : sinf( amount * q5 ) * q6;
+        register f32 q5 = Acos( cosOmega );
+        register f32 q6 = 1.0f / Sin( q5 );
+        k1 = Sin( ( 1.0f - amount ) * q5 ) * q6;
+        k2 = ( flag ) ? -Sin( amount * q5 ) * q6 : Sin( amount * q5 ) * q6;
     }
     return Quaternion( 
-        ( k1 * a.x ) + ( k2 * a.x ),
-        ( k1 * a.y ) + ( k2 * a.y ),
-        ( k1 * a.z ) + ( k2 * a.z ),
-        ( k1 * a.w ) + ( k2 * a.w )
+        ( k1 * a.x ) + ( k2 * b.x ),
+        ( k1 * a.y ) + ( k2 * b.y ),
+        ( k1 * a.z ) + ( k2 * b.z ),
+        ( k1 * a.w ) + ( k2 * b.w )
     );
 }
 
@@ -4442,7 +5055,7 @@ void Quaternion::Slerp( const Quaternion &a, const Quaternion &b, const f32 amou
     if ( cosOmega < 0.0f )
     {
         flag = true;
-        cosOmega -= cosOmega;
+        cosOmega = -cosOmega;
     }
 
     f32 k1, k2;
@@ -4453,16 +5066,16 @@ void Quaternion::Slerp( const Quaternion &a, const Quaternion &b, const f32 amou
     }
     else
     {
-        register f32 q5 = acosf( cosOmega );
-        register f32 q6 = 1.0f / sinf( q5 );
-        k1 = sinf( ( 1.0f - amount ) * q5 ) * q6;
-        k2 = ( flag ) ? -sinf( amount * q5 ) * q6 : sinf( amount * q5 ) * q6;
+        register f32 q5 = Acos( cosOmega );
+        register f32 q6 = 1.0f / Sin( q5 );
+        k1 = Sin( ( 1.0f - amount ) * q5 ) * q6;
+        k2 = ( flag ) ? -Sin( amount * q5 ) * q6 : Sin( amount * q5 ) * q6;
     }
   
-    result.x = ( k1 * a.x ) + ( k2 * a.x );
-    result.y = ( k1 * a.y ) + ( k2 * a.y );
-    result.z = ( k1 * a.z ) + ( k2 * a.z );
-    result.w = ( k1 * a.w ) + ( k2 * a.w );
+    result.x = ( k1 * a.x ) + ( k2 * b.x );
+    result.y = ( k1 * a.y ) + ( k2 * b.y );
+    result.z = ( k1 * a.z ) + ( k2 * b.z );
+    result.w = ( k1 * a.w ) + ( k2 * b.w );
 }
 
 ASDX_INLINE
@@ -4481,6 +5094,112 @@ void Quaternion::Squad( const Quaternion &q, const Quaternion &a, const Quaterni
     Quaternion::Slerp( d, e, 2.0f * amount * ( 1.0f - amount ), result );
 }
 
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+ASDX_INLINE
+Random::Random( s32 seed )
+{ SetSeed( seed ); }
+
+ASDX_INLINE
+Random::Random( const Random& random )
+: m_X( random.m_X )
+, m_Y( random.m_Y )
+, m_Z( random.m_Z )
+, m_W( random.m_W )
+{ /* DO_NOTHING */ }
+
+ASDX_INLINE
+Random::~Random()
+{ /* DO_NOTHING */ }
+
+ASDX_INLINE
+void Random::SetSeed( s32 seed )
+{
+    m_X = 123456789;
+    m_Y = 362436069;
+    m_Z = 521288629;
+    m_W = ( seed <= 0 ) ? 88675123 : static_cast<u32>( seed );
+}
+
+ASDX_INLINE
+u32 Random::GetAsU32()
+{
+    auto t = m_X ^ ( m_X << 11 );
+    m_X = m_Y;
+    m_Y = m_Z;
+    m_Z = m_W;
+    m_W = ( m_W ^ ( m_W >> 19 ) ) ^ ( t ^ ( t >> 8 ) );
+    return m_W;
+}
+
+ASDX_INLINE
+s32 Random::GetAsS32()
+{ return static_cast<s32>( GetAsU32() ); }
+
+ASDX_INLINE
+s32 Random::GetAsS32( s32 a )
+{
+    assert( a > 0 );
+    return static_cast<s32>( GetAsU32() % static_cast<u32>( a ) ) + 1;
+}
+
+ASDX_INLINE
+s32 Random::GetAsS32( s32 a, s32 b )
+{
+    assert( a < b );
+    return a + static_cast<s32>( GetAsU32() % static_cast<u32>( b - a ) );
+}
+
+ASDX_INLINE
+f32 Random::GetAsF32()
+{ return static_cast<f32>( GetAsU32() >> 8 ) * ( 1.0f / 16777215.0f ); }
+
+ASDX_INLINE
+f32 Random::GetAsF32( f32 a )
+{ return GetAsF32() * a; }
+
+ASDX_INLINE
+f32 Random::GetAsF32( f32 a, f32 b )
+{ return a + GetAsF32() * ( b - a ); }
+
+ASDX_INLINE
+f64 Random::GetAsF64()
+{ return static_cast<f64>( GetAsU32() ) * ( 1.0 / 4294967295.0 ); }
+
+ASDX_INLINE
+f64 Random::GetAsF64( f64 a )
+{ return GetAsF64() * a; }
+
+ASDX_INLINE
+f64 Random::GetAsF64( f64 a, f64 b )
+{ return a + GetAsF64() * ( b - a ); }
+
+ASDX_INLINE
+Random& Random::operator = ( const Random& random )
+{
+    m_X = random.m_X;
+    m_Y = random.m_Y;
+    m_Z = random.m_Z;
+    m_W = random.m_W;
+    return *this;
+}
+
+ASDX_INLINE
+bool Random::operator == ( const Random& random ) const
+{
+    return ( m_X == random.m_X )
+        && ( m_Y == random.m_Y )
+        && ( m_Z == random.m_Z )
+        && ( m_W == random.m_W );
+}
+
+ASDX_INLINE
+bool Random::operator != ( const Random& random ) const
+{ return !( *this == random ); }
+
 } // namespace asdx
 
 #endif// __ASDX_MATH_INL__
@@ -0,0 +1,163 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMathParallel.h
+// Desc : Parallel Math Stream Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_MATH_PARALLEL_H__
+#define __ASDX_MATH_PARALLEL_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxParallel.h>
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const u32 DefaultStreamGrain = 16384;    //!< 1タスクあたりの既定の要素数です(8の倍数).
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Vector3::TransformStream() を並列に実行します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [in]     matrix          変換行列.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//! @param [in]     grain           1タスクあたりの要素数です.
+//-------------------------------------------------------------------------------------------------
+inline void ParallelTransformStream
+(
+    const Vector3*  pInput,
+    u32             inputStride,
+    u32             count,
+    const Matrix&   matrix,
+    Vector3*        pOutput,
+    u32             outputStride,
+    u32             grain = DefaultStreamGrain
+)
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+
+    ParallelFor( count, grain, [&]( u32 begin, u32 end )
+    {
+        Vector3::TransformStream(
+            reinterpret_cast<const Vector3*>( pSrc + size_t( begin ) * inputStride ), inputStride,
+            end - begin, matrix,
+            reinterpret_cast<Vector3*>( pDst + size_t( begin ) * outputStride ), outputStride );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Vector3::TransformNormalStream() を並列に実行します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [in]     matrix          変換行列.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//! @param [in]     grain           1タスクあたりの要素数です.
+//-------------------------------------------------------------------------------------------------
+inline void ParallelTransformNormalStream
+(
+    const Vector3*  pInput,
+    u32             inputStride,
+    u32             count,
+    const Matrix&   matrix,
+    Vector3*        pOutput,
+    u32             outputStride,
+    u32             grain = DefaultStreamGrain
+)
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+
+    ParallelFor( count, grain, [&]( u32 begin, u32 end )
+    {
+        Vector3::TransformNormalStream(
+            reinterpret_cast<const Vector3*>( pSrc + size_t( begin ) * inputStride ), inputStride,
+            end - begin, matrix,
+            reinterpret_cast<Vector3*>( pDst + size_t( begin ) * outputStride ), outputStride );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Vector3::TransformCoordStream() を並列に実行します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [in]     matrix          変換行列.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//! @param [in]     grain           1タスクあたりの要素数です.
+//-------------------------------------------------------------------------------------------------
+inline void ParallelTransformCoordStream
+(
+    const Vector3*  pInput,
+    u32             inputStride,
+    u32             count,
+    const Matrix&   matrix,
+    Vector3*        pOutput,
+    u32             outputStride,
+    u32             grain = DefaultStreamGrain
+)
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+
+    ParallelFor( count, grain, [&]( u32 begin, u32 end )
+    {
+        Vector3::TransformCoordStream(
+            reinterpret_cast<const Vector3*>( pSrc + size_t( begin ) * inputStride ), inputStride,
+            end - begin, matrix,
+            reinterpret_cast<Vector3*>( pDst + size_t( begin ) * outputStride ), outputStride );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Vector4::TransformStream() を並列に実行します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [in]     matrix          変換行列.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//! @param [in]     grain           1タスクあたりの要素数です.
+//-------------------------------------------------------------------------------------------------
+inline void ParallelTransformStream
+(
+    const Vector4*  pInput,
+    u32             inputStride,
+    u32             count,
+    const Matrix&   matrix,
+    Vector4*        pOutput,
+    u32             outputStride,
+    u32             grain = DefaultStreamGrain
+)
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+
+    ParallelFor( count, grain, [&]( u32 begin, u32 end )
+    {
+        Vector4::TransformStream(
+            reinterpret_cast<const Vector4*>( pSrc + size_t( begin ) * inputStride ), inputStride,
+            end - begin, matrix,
+            reinterpret_cast<Vector4*>( pDst + size_t( begin ) * outputStride ), outputStride );
+    });
+}
+
+} // namespace asdx
+
+#endif//__ASDX_MATH_PARALLEL_H__
@@ -0,0 +1,421 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxMemoryTracker.h
+// Desc : Tagged Memory Tracking Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_MEMORY_TRACKER_H__
+#define __ASDX_MEMORY_TRACKER_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <new>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+#ifndef ASDX_ENABLE_MEMORY_TRACKING
+#define ASDX_ENABLE_MEMORY_TRACKING     (1)     // タグ付きメモリ追跡を有効にする場合は 1.
+#endif//ASDX_ENABLE_MEMORY_TRACKING
+
+#ifndef ASDX_ENABLE_MEMORY_CALLSITE
+#define ASDX_ENABLE_MEMORY_CALLSITE     (0)     // 呼び出し元の記録を有効にする場合は 1.
+#endif//ASDX_ENABLE_MEMORY_CALLSITE
+
+
+//-------------------------------------------------------------------------------------------------
+// Macros
+//-------------------------------------------------------------------------------------------------
+#define ASDX_TAGGED_ALLOC(tag, size)    asdx::TaggedAlloc( (size), (tag), __FILE__, __LINE__ )
+#define ASDX_TAGGED_FREE(ptr)           asdx::TaggedFree( (ptr) )
+#define ASDX_TAGGED_NEW(tag, T, ...)    asdx::TaggedNewAt<T>( (tag), __FILE__, __LINE__, ##__VA_ARGS__ )
+#define ASDX_TAGGED_DELETE(ptr)         asdx::TaggedDelete( (ptr) )
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MEMORY_TAG enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum MEMORY_TAG
+{
+    MEMORY_TAG_MATH = 0,        //!< 数学ライブラリです.
+    MEMORY_TAG_RENDER,          //!< 描画です.
+    MEMORY_TAG_ASSETS,          //!< アセットです.
+    MEMORY_TAG_JOBS,            //!< ジョブです.
+    MEMORY_TAG_OTHER,           //!< その他です.
+    MEMORY_TAG_COUNT,
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemoryTagStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MemoryTagStats
+{
+    s64     LiveBytes;          //!< 生存中のバイト数です.
+    s64     PeakBytes;          //!< フレーム境界で観測した生存バイト数の最大値です.
+    u64     FrameAllocCount;    //!< 直前のフレームでの確保回数です.
+    u64     TotalAllocCount;    //!< 確保回数の累計です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemoryFrameReport structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MemoryFrameReport
+{
+    MemoryTagStats  Tags[MEMORY_TAG_COUNT];     //!< タグごとの統計です.
+    s64             LiveBytes;                  //!< 全タグの生存中のバイト数です.
+    u64             FrameAllocCount;            //!< 直前のフレームでの全タグの確保回数です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemoryCallSite structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MemoryCallSite
+{
+    const char*     File;       //!< ファイル名です.
+    int             Line;       //!< 行番号です.
+    MEMORY_TAG      Tag;        //!< タグです.
+    u64             Count;      //!< 確保回数の累計です.
+    u64             Bytes;      //!< 確保したバイト数の累計です.
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      タグ名を取得します.
+//!
+//! @param [in]     tag         タグです.
+//! @return     タグ名を返却します.
+//-------------------------------------------------------------------------------------------------
+inline const char* GetMemoryTagName( MEMORY_TAG tag )
+{
+    static const char* s_Names[] = {
+        "math",
+        "render",
+        "assets",
+        "jobs",
+        "other",
+    };
+    static_assert( sizeof(s_Names) / sizeof(s_Names[0]) == MEMORY_TAG_COUNT, "Tag name count mismatch." );
+
+    return ( tag < MEMORY_TAG_COUNT ) ? s_Names[tag] : "unknown";
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MemoryTracker class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MemoryTracker : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //!
+    //! @return     シングルトンインスタンスを返却します.
+    //---------------------------------------------------------------------------------------------
+    static MemoryTracker& Instance()
+    {
+        static MemoryTracker s_Instance;
+        return s_Instance;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリの確保を記録します.
+    //!
+    //! @param [in]     tag         タグです.
+    //! @param [in]     size        確保したサイズです.
+    //! @param [in]     file        呼び出し元のファイル名です. nullptr も指定できます.
+    //! @param [in]     line        呼び出し元の行番号です.
+    //---------------------------------------------------------------------------------------------
+    void OnAlloc( MEMORY_TAG tag, size_t size, const char* file = nullptr, int line = 0 )
+    {
+    #if ASDX_ENABLE_MEMORY_TRACKING
+        auto& shard = GetShard();
+        shard.Bytes[tag].fetch_add( static_cast<s64>( size ), std::memory_order_relaxed );
+        shard.Count[tag].fetch_add( 1, std::memory_order_relaxed );
+
+        #if ASDX_ENABLE_MEMORY_CALLSITE
+        if ( file != nullptr )
+        { RecordCallSite( tag, size, file, line ); }
+        #else
+        ASDX_UNUSED_VAR( file );
+        ASDX_UNUSED_VAR( line );
+        #endif
+    #else
+        ASDX_UNUSED_VAR( tag );
+        ASDX_UNUSED_VAR( size );
+        ASDX_UNUSED_VAR( file );
+        ASDX_UNUSED_VAR( line );
+    #endif
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリの解放を記録します.
+    //!
+    //! @param [in]     tag         確保時に指定したタグです.
+    //! @param [in]     size        確保時のサイズです.
+    //---------------------------------------------------------------------------------------------
+    void OnFree( MEMORY_TAG tag, size_t size )
+    {
+    #if ASDX_ENABLE_MEMORY_TRACKING
+        auto& shard = GetShard();
+        shard.Bytes[tag].fetch_sub( static_cast<s64>( size ), std::memory_order_relaxed );
+    #else
+        ASDX_UNUSED_VAR( tag );
+        ASDX_UNUSED_VAR( size );
+    #endif
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      フレームを締めて統計を集計します.
+    //!
+    //! @param [out]    pReport     集計結果の格納先です. nullptr も指定できます.
+    //! @note       1フレームに1回，メインスレッドから呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    void EndFrame( MemoryFrameReport* pReport )
+    {
+        MemoryFrameReport report;
+        memset( &report, 0, sizeof(report) );
+
+        for( u32 t=0; t<MEMORY_TAG_COUNT; ++t )
+        {
+            s64 bytes = 0;
+            u64 count = 0;
+            for( u32 i=0; i<ShardCount; ++i )
+            {
+                bytes += m_Shards[i].Bytes[t].load( std::memory_order_relaxed );
+                count += m_Shards[i].Count[t].load( std::memory_order_relaxed );
+            }
+
+            if ( bytes > m_PeakBytes[t] )
+            { m_PeakBytes[t] = bytes; }
+
+            auto& tag = report.Tags[t];
+            tag.LiveBytes       = bytes;
+            tag.PeakBytes       = m_PeakBytes[t];
+            tag.FrameAllocCount = count - m_LastCount[t];
+            tag.TotalAllocCount = count;
+            m_LastCount[t] = count;
+
+            report.LiveBytes       += tag.LiveBytes;
+            report.FrameAllocCount += tag.FrameAllocCount;
+        }
+
+        if ( pReport != nullptr )
+        { *pReport = report; }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      記録した呼び出し元を取得します.
+    //!
+    //! @param [out]    result      呼び出し元の格納先です.
+    //! @note       ASDX_ENABLE_MEMORY_CALLSITE が 0 の場合は常に空になります.
+    //---------------------------------------------------------------------------------------------
+    void GetCallSites( std::vector<MemoryCallSite>& result )
+    {
+        std::lock_guard<std::mutex> locker( m_CallSiteMutex );
+        result = m_CallSites;
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    static const u32 ShardCount = 32;       // シャード数です.
+
+    struct ASDX_ALIGN(64) Shard
+    {
+        std::atomic<s64>    Bytes[MEMORY_TAG_COUNT];    //!< 生存中のバイト数です.
+        std::atomic<u64>    Count[MEMORY_TAG_COUNT];    //!< 確保回数です.
+    };
+
+    Shard                       m_Shards[ShardCount];           //!< スレッドごとのシャードです.
+    s64                         m_PeakBytes[MEMORY_TAG_COUNT];  //!< 生存バイト数の最大値です.
+    u64                         m_LastCount[MEMORY_TAG_COUNT];  //!< 前のフレームまでの確保回数です.
+    std::atomic<u32>            m_NextShard;                    //!< 次に割り当てるシャード番号です.
+    std::vector<MemoryCallSite> m_CallSites;                    //!< 呼び出し元です.
+    std::mutex                  m_CallSiteMutex;                //!< 呼び出し元を保護します.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    MemoryTracker()
+    : m_NextShard( 0 )
+    {
+        for( u32 i=0; i<ShardCount; ++i )
+        {
+            for( u32 t=0; t<MEMORY_TAG_COUNT; ++t )
+            {
+                m_Shards[i].Bytes[t].store( 0, std::memory_order_relaxed );
+                m_Shards[i].Count[t].store( 0, std::memory_order_relaxed );
+            }
+        }
+
+        memset( m_PeakBytes, 0, sizeof(m_PeakBytes) );
+        memset( m_LastCount, 0, sizeof(m_LastCount) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      呼び出しスレッドのシャードを取得します.
+    //!
+    //! @note       スレッド数がシャード数を超えた場合は複数のスレッドでシャードを共有します.
+    //---------------------------------------------------------------------------------------------
+    Shard& GetShard()
+    {
+        thread_local u32 s_Index = 0xffffffff;
+        if ( s_Index == 0xffffffff )
+        { s_Index = m_NextShard.fetch_add( 1, std::memory_order_relaxed ) % ShardCount; }
+
+        return m_Shards[s_Index];
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      呼び出し元を記録します.
+    //---------------------------------------------------------------------------------------------
+    void RecordCallSite( MEMORY_TAG tag, size_t size, const char* file, int line )
+    {
+        std::lock_guard<std::mutex> locker( m_CallSiteMutex );
+
+        // __FILE__ は同じ翻訳単位内では同じポインタになるのでポインタで比較する.
+        for( size_t i=0; i<m_CallSites.size(); ++i )
+        {
+            auto& site = m_CallSites[i];
+            if ( site.File == file && site.Line == line && site.Tag == tag )
+            {
+                site.Count++;
+                site.Bytes += size;
+                return;
+            }
+        }
+
+        MemoryCallSite site;
+        site.File  = file;
+        site.Line  = line;
+        site.Tag   = tag;
+        site.Count = 1;
+        site.Bytes = size;
+        m_CallSites.push_back( site );
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      タグ付きでメモリを確保します.
+//!
+//! @param [in]     size        確保するサイズです.
+//! @param [in]     tag         タグです.
+//! @param [in]     file        呼び出し元のファイル名です.
+//! @param [in]     line        呼び出し元の行番号です.
+//! @return     確保したメモリを返却します. 16byteアライメントです.
+//! @note       通常は ASDX_TAGGED_ALLOC() マクロを使用してください.
+//-------------------------------------------------------------------------------------------------
+inline void* TaggedAlloc( size_t size, MEMORY_TAG tag, const char* file = nullptr, int line = 0 )
+{
+    // 先頭16byteにタグとサイズを埋め込む.
+    auto raw = static_cast<u8*>( malloc( size + 16 ) );
+    if ( raw == nullptr )
+    { return nullptr; }
+
+    auto header = reinterpret_cast<u64*>( raw );
+    header[0] = static_cast<u64>( tag );
+    header[1] = static_cast<u64>( size );
+
+    MemoryTracker::Instance().OnAlloc( tag, size, file, line );
+    return raw + 16;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      TaggedAlloc() で確保したメモリを解放します.
+//!
+//! @param [in]     ptr         解放するメモリです.
+//-------------------------------------------------------------------------------------------------
+inline void TaggedFree( void* ptr )
+{
+    if ( ptr == nullptr )
+    { return; }
+
+    auto raw    = static_cast<u8*>( ptr ) - 16;
+    auto header = reinterpret_cast<u64*>( raw );
+
+    MemoryTracker::Instance().OnFree( static_cast<MEMORY_TAG>( header[0] ), static_cast<size_t>( header[1] ) );
+    free( raw );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      タグ付きでオブジェクトを生成します.
+//!
+//! @param [in]     tag         タグです.
+//! @param [in]     file        呼び出し元のファイル名です.
+//! @param [in]     line        呼び出し元の行番号です.
+//! @param [in]     args        コンストラクタ引数です.
+//! @return     生成したオブジェクトを返却します.
+//! @note       通常は ASDX_TAGGED_NEW() マクロを使用してください.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename... Args>
+inline T* TaggedNewAt( MEMORY_TAG tag, const char* file, int line, Args&&... args )
+{
+    auto ptr = TaggedAlloc( sizeof(T), tag, file, line );
+    if ( ptr == nullptr )
+    { return nullptr; }
+    return new (ptr) T( std::forward<Args>( args )... );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      タグ付きでオブジェクトを生成します.
+//!
+//! @param [in]     tag         タグです.
+//! @param [in]     args        コンストラクタ引数です.
+//! @return     生成したオブジェクトを返却します.
+//! @note       呼び出し元は記録されません. 記録する場合は ASDX_TAGGED_NEW() マクロを使用してください.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename... Args>
+inline T* TaggedNew( MEMORY_TAG tag, Args&&... args )
+{ return TaggedNewAt<T>( tag, nullptr, 0, std::forward<Args>( args )... ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      TaggedNew() で生成したオブジェクトを破棄します.
+//!
+//! @param [in]     ptr         破棄するオブジェクトです.
+//-------------------------------------------------------------------------------------------------
+ASDX_TEMPLATE(T)
+inline void TaggedDelete( T* ptr )
+{
+    if ( ptr == nullptr )
+    { return; }
+    ptr->~T();
+    TaggedFree( ptr );
+}
+
+} // namespace asdx
+
+#endif//__ASDX_MEMORY_TRACKER_H__
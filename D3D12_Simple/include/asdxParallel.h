@@ -0,0 +1,257 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxParallel.h
+// Desc : Parallel For Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_PARALLEL_H__
+#define __ASDX_PARALLEL_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ThreadPool class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ThreadPool : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    typedef std::function<void(u32, u32)>   RangeFunc;  //!< [begin, end) の範囲を処理する関数です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      共有のスレッドプールを取得します.
+    //!
+    //! @return     論理コア数 - 1 個のワーカーを持つスレッドプールを返却します.
+    //---------------------------------------------------------------------------------------------
+    static ThreadPool& Instance()
+    {
+        static ThreadPool s_Instance( 0 );
+        return s_Instance;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param [in]     workerCount     ワーカースレッド数です. 0 の場合は論理コア数 - 1 個です.
+    //---------------------------------------------------------------------------------------------
+    explicit ThreadPool( u32 workerCount )
+    : m_pTask       ( nullptr )
+    , m_Generation  ( 0 )
+    , m_ActiveCount ( 0 )
+    , m_Quit        ( false )
+    {
+        if ( workerCount == 0 )
+        {
+            auto cores = std::thread::hardware_concurrency();
+            workerCount = ( cores > 1 ) ? cores - 1 : 0;
+        }
+
+        m_Workers.reserve( workerCount );
+        for( u32 i=0; i<workerCount; ++i )
+        { m_Workers.push_back( std::thread( &ThreadPool::WorkerMain, this ) ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> locker( m_Mutex );
+            m_Quit = true;
+        }
+        m_WakeCond.notify_all();
+
+        for( size_t i=0; i<m_Workers.size(); ++i )
+        { m_Workers[i].join(); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ワーカースレッド数を取得します.
+    //!
+    //! @return     ワーカースレッド数を返却します. 呼び出しスレッドも処理に参加します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetWorkerCount() const
+    { return static_cast<u32>( m_Workers.size() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [0, count) を grain 個ずつに分割して並列に処理します.
+    //!
+    //! @param [in]     count       要素数です.
+    //! @param [in]     grain       1回の呼び出しで処理する要素数です.
+    //! @param [in]     func        [begin, end) を処理する関数です.
+    //! @note       全ての範囲の処理が終わるまで戻りません. 処理関数の中から呼び出した場合は
+    //!             呼び出しスレッドで逐次処理します.
+    //!             count は u32 の最大値まで指定できます. 範囲の取り出しは 64bit で数えるので,
+    //!             末尾付近でも begin + grain が桁あふれすることはありません.
+    //---------------------------------------------------------------------------------------------
+    void ParallelFor( u32 count, u32 grain, const RangeFunc& func )
+    {
+        if ( count == 0 )
+        { return; }
+
+        if ( grain == 0 )
+        { grain = 1; }
+
+        if ( m_Workers.empty() || count <= grain || IsInsideTask() )
+        {
+            // begin += grain だと count が u32 の最大値付近で桁あふれするので end から進める.
+            for( u32 begin=0; begin<count; )
+            {
+                auto end = ( count - begin > grain ) ? begin + grain : count;
+                func( begin, end );
+                begin = end;
+            }
+            return;
+        }
+
+        // 同時に実行するタスクは1つだけにする.
+        std::lock_guard<std::mutex> submitLocker( m_SubmitMutex );
+
+        Task task;
+        task.pFunc = &func;
+        task.Count = count;
+        task.Grain = grain;
+        task.Next.store( 0, std::memory_order_relaxed );
+
+        {
+            std::lock_guard<std::mutex> locker( m_Mutex );
+            m_pTask = &task;
+            m_Generation++;
+        }
+        m_WakeCond.notify_all();
+
+        // 呼び出しスレッドも処理に参加する.
+        IsInsideTask() = true;
+        Run( task );
+        IsInsideTask() = false;
+
+        // 処理中のワーカーが居なくなってからタスクを外す.
+        std::unique_lock<std::mutex> locker( m_Mutex );
+        m_DoneCond.wait( locker, [this]{ return m_ActiveCount == 0; } );
+        m_pTask = nullptr;
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    struct Task
+    {
+        const RangeFunc*    pFunc;      //!< 処理関数です.
+        u32                 Count;      //!< 要素数です.
+        u32                 Grain;      //!< 分割単位です.
+        std::atomic<u64>    Next;       //!< 次に処理する要素番号です(桁あふれしないように 64bit で数えます).
+    };
+
+    std::vector<std::thread>    m_Workers;      //!< ワーカースレッドです.
+    std::mutex                  m_Mutex;        //!< タスクの受け渡しを保護します.
+    std::mutex                  m_SubmitMutex;  //!< タスクの投入を直列化します.
+    std::condition_variable     m_WakeCond;     //!< ワーカーを起こします.
+    std::condition_variable     m_DoneCond;     //!< ワーカーの処理完了を通知します.
+    Task*                       m_pTask;        //!< 実行中のタスクです.
+    u64                         m_Generation;   //!< タスクを投入するたびに進む番号です.
+    u32                         m_ActiveCount;  //!< タスクを処理中のワーカー数です.
+    bool                        m_Quit;         //!< 終了要求フラグです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      呼び出しスレッドがタスクを処理中かどうかを取得・設定します.
+    //---------------------------------------------------------------------------------------------
+    static bool& IsInsideTask()
+    {
+        thread_local bool s_Inside = false;
+        return s_Inside;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      タスクの範囲を取り出して処理します.
+    //---------------------------------------------------------------------------------------------
+    static void Run( Task& task )
+    {
+        for(;;)
+        {
+            // 取り出しに失敗したスレッドも1回ずつ加算するが, 64bit なので折り返さない.
+            auto next = task.Next.fetch_add( task.Grain, std::memory_order_relaxed );
+            if ( next >= task.Count )
+            { break; }
+
+            auto begin = static_cast<u32>( next );
+            auto end   = ( task.Count - begin > task.Grain ) ? begin + task.Grain : task.Count;
+            ( *task.pFunc )( begin, end );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ワーカースレッドのメイン処理です.
+    //---------------------------------------------------------------------------------------------
+    void WorkerMain()
+    {
+        IsInsideTask() = true;
+
+        u64 generation = 0;
+        for(;;)
+        {
+            Task* pTask = nullptr;
+            {
+                std::unique_lock<std::mutex> locker( m_Mutex );
+                m_WakeCond.wait( locker, [&]{ return m_Quit || ( m_pTask != nullptr && m_Generation != generation ); } );
+                if ( m_Quit )
+                { return; }
+
+                generation = m_Generation;
+                pTask = m_pTask;
+                m_ActiveCount++;
+            }
+
+            Run( *pTask );
+
+            {
+                std::lock_guard<std::mutex> locker( m_Mutex );
+                m_ActiveCount--;
+            }
+            m_DoneCond.notify_one();
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      共有のスレッドプールで [0, count) を並列に処理します.
+//!
+//! @param [in]     count       要素数です.
+//! @param [in]     grain       1回の呼び出しで処理する要素数です.
+//! @param [in]     func        [begin, end) を処理する関数です.
+//! @note       count は u32 の最大値まで指定できます.
+//-------------------------------------------------------------------------------------------------
+inline void ParallelFor( u32 count, u32 grain, const ThreadPool::RangeFunc& func )
+{ ThreadPool::Instance().ParallelFor( count, grain, func ); }
+
+} // namespace asdx
+
+#endif//__ASDX_PARALLEL_H__
@@ -0,0 +1,537 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxPool.h
+// Desc : Fixed Size Object Pool Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_POOL_H__
+#define __ASDX_POOL_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxMemoryTracker.h>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <new>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PoolStats structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct PoolStats
+{
+    u32     SlabCount;          //!< 確保したスラブ数です.
+    u32     Capacity;           //!< 確保可能なオブジェクトの総数です.
+    u64     AllocCount;         //!< 確保回数の累計です.
+    u64     FreeCount;          //!< 解放回数の累計です.
+    u64     GlobalPushCount;    //!< グローバルスタックにバッチを戻した回数です.
+    u64     GlobalPopCount;     //!< グローバルスタックからバッチを取り出した回数です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Pool class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+ASDX_TEMPLATE(T)
+class Pool : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 DefaultMagazineSize = 64;      //!< 既定のマガジンサイズです.
+    static const u32 DefaultSlabSize     = 1024;    //!< 既定のスラブあたりのオブジェクト数です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param [in]     magazineSize    スレッドローカルのマガジンのサイズです.
+    //! @param [in]     slabSize        スラブあたりのオブジェクト数です. マガジンサイズの倍数に切り上げます.
+    //! @param [in]     tag             メモリ追跡に使用するタグです.
+    //---------------------------------------------------------------------------------------------
+    Pool( u32 magazineSize = DefaultMagazineSize, u32 slabSize = DefaultSlabSize, MEMORY_TAG tag = MEMORY_TAG_OTHER )
+    : m_Id          ( GenerateId() )
+    , m_MagazineSize( ( magazineSize > 0 ) ? magazineSize : 1 )
+    , m_SlabSize    ( 0 )
+    , m_Head        ( 0 )
+    , m_Tag         ( tag )
+    , m_SlabCount   ( 0 )
+    , m_AllocCount  ( 0 )
+    , m_FreeCount   ( 0 )
+    , m_PushCount   ( 0 )
+    , m_PopCount    ( 0 )
+    , m_Partial     ( nullptr )
+    , m_PartialCount( 0 )
+    {
+        m_SlabSize = ( ( slabSize + m_MagazineSize - 1 ) / m_MagazineSize ) * m_MagazineSize;
+        if ( m_SlabSize == 0 )
+        { m_SlabSize = m_MagazineSize; }
+
+        std::lock_guard<std::mutex> locker( GetRegistryMutex() );
+        GetRegistry()[m_Id] = this;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //!
+    //! @note       生存中のオブジェクトのデストラクタは呼び出されません.
+    //---------------------------------------------------------------------------------------------
+    ~Pool()
+    {
+        // 以降に他のスレッドのマガジンが返却されないように先に登録を外す.
+        {
+            std::lock_guard<std::mutex> locker( GetRegistryMutex() );
+            GetRegistry().erase( m_Id );
+        }
+
+        for( size_t i=0; i<m_Slabs.size(); ++i )
+        {
+            ::operator delete( m_Slabs[i] );
+            MemoryTracker::Instance().OnFree( m_Tag, GetSlabBytes() );
+        }
+        m_Slabs.clear();
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクト1つ分のメモリを確保します.
+    //!
+    //! @return     確保したメモリを返却します. 確保に失敗した場合は nullptr を返却します.
+    //! @note       複数スレッドから同時に呼び出せます.
+    //---------------------------------------------------------------------------------------------
+    void* Alloc()
+    {
+        auto& mag = GetMagazine();
+        if ( mag.Head == nullptr )
+        {
+            FlushCounters( mag );
+            if ( !Refill( mag ) )
+            { return nullptr; }
+        }
+
+        auto node = mag.Head;
+        mag.Head = node->Next;
+        mag.Count--;
+        mag.AllocCount++;
+
+        return node;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      Alloc() で確保したメモリを解放します.
+    //!
+    //! @param [in]     ptr         解放するメモリです.
+    //! @note       確保したスレッドとは別のスレッドから解放しても構いません.
+    //---------------------------------------------------------------------------------------------
+    void Free( void* ptr )
+    {
+        if ( ptr == nullptr )
+        { return; }
+
+        auto& mag  = GetMagazine();
+        auto  node = static_cast<Node*>( ptr );
+
+        node->Next = mag.Head;
+        mag.Head = node;
+        mag.Count++;
+        mag.FreeCount++;
+
+        // 溜まりすぎたらマガジン1つ分をまとめてグローバルスタックに戻す.
+        if ( mag.Count >= m_MagazineSize * 2 )
+        {
+            auto batch = mag.Head;
+            auto tail  = batch;
+            for( u32 i=1; i<m_MagazineSize; ++i )
+            { tail = tail->Next; }
+
+            mag.Head = tail->Next;
+            mag.Count -= m_MagazineSize;
+            tail->Next = nullptr;
+
+            FlushCounters( mag );
+            PushBatch( batch );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを生成します.
+    //!
+    //! @param [in]     args        コンストラクタ引数です.
+    //! @return     生成したオブジェクトを返却します. 確保に失敗した場合は nullptr を返却します.
+    //---------------------------------------------------------------------------------------------
+    template<typename... Args>
+    T* Create( Args&&... args )
+    {
+        auto ptr = Alloc();
+        if ( ptr == nullptr )
+        { return nullptr; }
+        return new (ptr) T( std::forward<Args>( args )... );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを破棄します.
+    //!
+    //! @param [in]     ptr         Create() で生成したオブジェクトです.
+    //---------------------------------------------------------------------------------------------
+    void Destroy( T* ptr )
+    {
+        if ( ptr == nullptr )
+        { return; }
+        ptr->~T();
+        Free( ptr );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //!
+    //! @return     統計情報を返却します.
+    //! @note       確保・解放回数はマガジンがグローバルスタックとやり取りする際に集計されるため，
+    //!             各スレッドのマガジン内の分だけ遅れて反映されます. 終了したスレッドの分と,
+    //!             他のプールに追い出されたマガジンの分は返却時に集計されます.
+    //---------------------------------------------------------------------------------------------
+    PoolStats GetStats() const
+    {
+        PoolStats result;
+        result.SlabCount       = m_SlabCount.load( std::memory_order_relaxed );
+        result.Capacity        = result.SlabCount * m_SlabSize;
+        result.AllocCount      = m_AllocCount.load( std::memory_order_relaxed );
+        result.FreeCount       = m_FreeCount .load( std::memory_order_relaxed );
+        result.GlobalPushCount = m_PushCount .load( std::memory_order_relaxed );
+        result.GlobalPopCount  = m_PopCount  .load( std::memory_order_relaxed );
+        return result;
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    struct Node
+    {
+        Node*   Next;       //!< バッチ内の次のノードです.
+        Node*   NextBatch;  //!< グローバルスタック上の次のバッチです(バッチ先頭のノードのみ使用).
+    };
+
+    static const u32 MagazineCacheCount = 4;                // スレッドごとに保持するマガジン数です.
+
+    struct Magazine
+    {
+        u64     Owner;      //!< 所有しているプールのIDです.
+        Node*   Head;       //!< 空きノードの先頭です.
+        u32     Count;      //!< 空きノード数です.
+        u64     AllocCount; //!< 未集計の確保回数です.
+        u64     FreeCount;  //!< 未集計の解放回数です.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // MagazineCache structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct MagazineCache
+    {
+        Magazine    Magazines[MagazineCacheCount];  //!< マガジンです.
+        u32         Next;                           //!< 次に追い出すマガジンです.
+
+        MagazineCache()
+        : Next( 0 )
+        { memset( Magazines, 0, sizeof(Magazines) ); }
+
+        //! スレッドの終了時に残っているノードを各プールに返却します.
+        ~MagazineCache()
+        {
+            for( u32 i=0; i<MagazineCacheCount; ++i )
+            { Return( Magazines[i] ); }
+        }
+    };
+
+    static const u64 PointerMask        = 0x0000ffffffffffffull;
+    static const u32 TagShift           = 48;
+
+    static const size_t NodeAlign = ( alignof(T) > alignof(Node) ) ? alignof(T) : alignof(Node);
+    static const size_t NodeSize  = ( ( ( sizeof(T) > sizeof(Node) ) ? sizeof(T) : sizeof(Node) ) + NodeAlign - 1 ) & ~( NodeAlign - 1 );
+
+    u64                     m_Id;           //!< プールのIDです.
+    u32                     m_MagazineSize; //!< マガジンサイズです.
+    u32                     m_SlabSize;     //!< スラブあたりのオブジェクト数です.
+    std::atomic<u64>        m_Head;         //!< グローバルスタックの先頭です(上位16bitはABA対策のタグ).
+    std::vector<void*>      m_Slabs;        //!< 確保したスラブです.
+    std::mutex              m_SlabMutex;    //!< スラブの確保を保護します.
+    MEMORY_TAG              m_Tag;          //!< メモリ追跡に使用するタグです.
+    std::atomic<u32>        m_SlabCount;    //!< スラブ数です.
+    std::atomic<u64>        m_AllocCount;   //!< 確保回数です.
+    std::atomic<u64>        m_FreeCount;    //!< 解放回数です.
+    std::atomic<u64>        m_PushCount;    //!< バッチを戻した回数です.
+    std::atomic<u64>        m_PopCount;     //!< バッチを取り出した回数です.
+    Node*                   m_Partial;      //!< 返却されたマガジンサイズに満たないノードです(m_SlabMutex で保護).
+    u32                     m_PartialCount; //!< m_Partial のノード数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      プールのIDを生成します.
+    //---------------------------------------------------------------------------------------------
+    static u64 GenerateId()
+    {
+        static std::atomic<u64> s_Counter( 0 );
+        return ++s_Counter;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      生存しているプールの一覧を取得します.
+    //---------------------------------------------------------------------------------------------
+    static std::unordered_map<u64, Pool*>& GetRegistry()
+    {
+        static std::unordered_map<u64, Pool*> s_Registry;
+        return s_Registry;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      生存しているプールの一覧を保護するミューテックスを取得します.
+    //---------------------------------------------------------------------------------------------
+    static std::mutex& GetRegistryMutex()
+    {
+        static std::mutex s_Mutex;
+        return s_Mutex;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      マガジンのノードと未集計の回数を所有しているプールに返却します.
+    //!
+    //! @note       所有しているプールが破棄済みの場合はノードはスラブと一緒に解放済みなので捨てます.
+    //---------------------------------------------------------------------------------------------
+    static void Return( Magazine& mag )
+    {
+        if ( mag.Owner != 0 )
+        {
+            std::lock_guard<std::mutex> locker( GetRegistryMutex() );
+            auto itr = GetRegistry().find( mag.Owner );
+            if ( itr != GetRegistry().end() )
+            { itr->second->Reclaim( mag ); }
+        }
+
+        memset( &mag, 0, sizeof(mag) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      返却されたマガジンのノードを回収します.
+    //!
+    //! @note       マガジンサイズ分が揃うごとにバッチとしてグローバルスタックに積みます.
+    //!             揃わなかった分は次の返却まで保持するので, 回収できないノードは
+    //!             プールあたりマガジンサイズ未満に留まります.
+    //---------------------------------------------------------------------------------------------
+    void Reclaim( Magazine& mag )
+    {
+        FlushCounters( mag );
+
+        std::lock_guard<std::mutex> locker( m_SlabMutex );
+        auto node = mag.Head;
+        while( node != nullptr )
+        {
+            auto next = node->Next;
+            node->Next = m_Partial;
+            m_Partial  = node;
+            m_PartialCount++;
+
+            if ( m_PartialCount == m_MagazineSize )
+            {
+                PushBatch( m_Partial );
+                m_Partial      = nullptr;
+                m_PartialCount = 0;
+            }
+            node = next;
+        }
+
+        mag.Head  = nullptr;
+        mag.Count = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      呼び出しスレッドのマガジンを取得します.
+    //!
+    //! @note       同じスレッドで MagazineCacheCount 個を超えるプールを使うと古いマガジンを
+    //!             追い出し, 中のノードを所有しているプールに返却します.
+    //---------------------------------------------------------------------------------------------
+    Magazine& GetMagazine()
+    {
+        thread_local MagazineCache s_Cache;
+
+        for( u32 i=0; i<MagazineCacheCount; ++i )
+        {
+            if ( s_Cache.Magazines[i].Owner == m_Id )
+            { return s_Cache.Magazines[i]; }
+        }
+
+        auto& mag = s_Cache.Magazines[s_Cache.Next];
+        s_Cache.Next = ( s_Cache.Next + 1 ) % MagazineCacheCount;
+        Return( mag );
+
+        mag.Owner      = m_Id;
+        mag.Head       = nullptr;
+        mag.Count      = 0;
+        mag.AllocCount = 0;
+        mag.FreeCount  = 0;
+        return mag;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      マガジンの確保・解放回数を集計します.
+    //---------------------------------------------------------------------------------------------
+    void FlushCounters( Magazine& mag )
+    {
+        m_AllocCount.fetch_add( mag.AllocCount, std::memory_order_relaxed );
+        m_FreeCount .fetch_add( mag.FreeCount,  std::memory_order_relaxed );
+        mag.AllocCount = 0;
+        mag.FreeCount  = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      空のマガジンを補充します.
+    //---------------------------------------------------------------------------------------------
+    bool Refill( Magazine& mag )
+    {
+        auto batch = PopBatch();
+        if ( batch == nullptr )
+        {
+            batch = AllocSlab();
+            if ( batch == nullptr )
+            { return false; }
+        }
+
+        mag.Head  = batch;
+        mag.Count = m_MagazineSize;
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      バッチをグローバルスタックに積みます.
+    //---------------------------------------------------------------------------------------------
+    void PushBatch( Node* batch )
+    {
+        auto head = m_Head.load( std::memory_order_relaxed );
+        for(;;)
+        {
+            batch->NextBatch = Unpack( head );
+            auto next = Pack( batch, Tag( head ) + 1 );
+            if ( m_Head.compare_exchange_weak( head, next, std::memory_order_release, std::memory_order_relaxed ) )
+            { break; }
+        }
+        m_PushCount.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      グローバルスタックからバッチを取り出します.
+    //!
+    //! @note       スラブはプールの破棄時まで解放しないので，他のスレッドに取られたノードを
+    //!             読んでもタグの比較で失敗するだけで安全です.
+    //---------------------------------------------------------------------------------------------
+    Node* PopBatch()
+    {
+        auto head = m_Head.load( std::memory_order_acquire );
+        for(;;)
+        {
+            auto batch = Unpack( head );
+            if ( batch == nullptr )
+            { return nullptr; }
+
+            auto next = Pack( batch->NextBatch, Tag( head ) + 1 );
+            if ( m_Head.compare_exchange_weak( head, next, std::memory_order_acquire, std::memory_order_acquire ) )
+            {
+                m_PopCount.fetch_add( 1, std::memory_order_relaxed );
+                return batch;
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      スラブを確保し，最初のバッチを返却します. 残りはグローバルスタックに積みます.
+    //---------------------------------------------------------------------------------------------
+    Node* AllocSlab()
+    {
+        u8* base = nullptr;
+        {
+            std::lock_guard<std::mutex> locker( m_SlabMutex );
+
+            // 待っている間に他のスレッドが補充していればそれを使う.
+            auto batch = PopBatch();
+            if ( batch != nullptr )
+            { return batch; }
+
+            auto raw = ::operator new( GetSlabBytes(), std::nothrow );
+            if ( raw == nullptr )
+            { return nullptr; }
+
+            MemoryTracker::Instance().OnAlloc( m_Tag, GetSlabBytes() );
+
+            m_Slabs.push_back( raw );
+            m_SlabCount.fetch_add( 1, std::memory_order_relaxed );
+
+            auto addr = reinterpret_cast<size_t>( raw );
+            base = reinterpret_cast<u8*>( ( addr + NodeAlign - 1 ) & ~( NodeAlign - 1 ) );
+        }
+
+        // マガジンサイズごとにバッチとして連結する.
+        Node* first = nullptr;
+        auto batchCount = m_SlabSize / m_MagazineSize;
+        for( u32 b=0; b<batchCount; ++b )
+        {
+            auto batch = base + NodeSize * m_MagazineSize * b;
+            for( u32 i=0; i<m_MagazineSize; ++i )
+            {
+                auto node = reinterpret_cast<Node*>( batch + NodeSize * i );
+                node->Next = ( i + 1 < m_MagazineSize ) ? reinterpret_cast<Node*>( batch + NodeSize * ( i + 1 ) ) : nullptr;
+            }
+
+            if ( b == 0 )
+            { first = reinterpret_cast<Node*>( batch ); }
+            else
+            { PushBatch( reinterpret_cast<Node*>( batch ) ); }
+        }
+
+        return first;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      スラブ1つ分のバイト数を取得します.
+    //---------------------------------------------------------------------------------------------
+    size_t GetSlabBytes() const
+    { return NodeSize * m_SlabSize + NodeAlign; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ポインタとタグを64bitに詰めます.
+    //---------------------------------------------------------------------------------------------
+    static u64 Pack( Node* node, u64 tag )
+    { return ( reinterpret_cast<u64>( node ) & PointerMask ) | ( tag << TagShift ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      64bit値からポインタを取り出します.
+    //---------------------------------------------------------------------------------------------
+    static Node* Unpack( u64 value )
+    { return reinterpret_cast<Node*>( value & PointerMask ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      64bit値からタグを取り出します.
+    //---------------------------------------------------------------------------------------------
+    static u64 Tag( u64 value )
+    { return value >> TagShift; }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_POOL_H__
@@ -0,0 +1,1246 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxQuantization.h
+// Desc : Vertex Attribute Quantization Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_QUANTIZATION_H__
+#define __ASDX_QUANTIZATION_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxSimd.h>
+#include <cmath>
+#include <cassert>
+
+
+//-------------------------------------------------------------------------------------------------
+// 各形式のビット配置.
+//  - SNORM/UNORM       : D3D の DXGI_FORMAT_*_SNORM / *_UNORM と同じ変換です(最近接偶数丸め).
+//  - NormalOct16       : 下位16bit = x (SNORM16), 上位16bit = y (SNORM16) の八面体表現.
+//  - NormalOct8        : 下位8bit = x (SNORM8), 上位8bit = y (SNORM8) の八面体表現.
+//  - TangentOct        : bit 0-15 = x (SNORM16), bit 16-30 = y (SNORM15), bit 31 = w < 0.
+//  - R10G10B10A2       : DXGI_FORMAT_R10G10B10A2_UNORM と同じです.
+//  - Position16        : バウンディングボックスで正規化した UNORM16 x 3 です.
+// ストリーム版は SSE2 で4要素ずつ処理し, スカラー版とビット単位で一致します.
+//-------------------------------------------------------------------------------------------------
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// QuantizationError structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct QuantizationError
+{
+    f32     MaxError;       //!< 最大誤差です.
+    f32     MeanError;      //!< 平均誤差です.
+    f32     RmsError;       //!< 二乗平均平方根誤差です.
+};
+
+
+namespace detail {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      最近接偶数に丸めて整数に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+s32 QuantizeRound( f32 value )
+{
+#if ASDX_SIMD_SSE2
+    return _mm_cvtss_si32( _mm_set_ss( value ) );
+#else
+    return static_cast<s32>( lrintf( value ) );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      値を [lo, hi] に制限します(NaN は lo になります).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 QuantizeClamp( f32 value, f32 lo, f32 hi )
+{
+    // _mm_max_ps, _mm_min_ps と同じ比較にする.
+    value = ( value > lo ) ? value : lo;
+    return ( value < hi ) ? value : hi;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      0 以上なら 1, それ以外は -1 を返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 SignNotZero( f32 value )
+{ return ( value >= 0.0f ) ? 1.0f : -1.0f; }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [-1, 1] を SNORM に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+s32 EncodeSnorm( f32 value, f32 scale )
+{ return QuantizeRound( QuantizeClamp( value, -1.0f, 1.0f ) * scale ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SNORM を [-1, 1] に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 DecodeSnorm( s32 value, f32 scale )
+{
+    auto result = static_cast<f32>( value ) / scale;
+    return ( result > -1.0f ) ? result : -1.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [0, 1] を UNORM に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+s32 EncodeUnorm( f32 value, f32 scale )
+{ return QuantizeRound( QuantizeClamp( value, 0.0f, 1.0f ) * scale ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      UNORM を [0, 1] に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 DecodeUnorm( s32 value, f32 scale )
+{ return static_cast<f32>( value ) / scale; }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      バウンディングボックスの逆数スケールを求めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 PositionInvExtent( f32 boxMin, f32 boxMax )
+{ return ( boxMax > boxMin ) ? 1.0f / ( boxMax - boxMin ) : 0.0f; }
+
+#if ASDX_SIMD_SSE2
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ストライド付き配列から4要素の x, y, z, w を読み込みます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void QuantizeGather( const u8* pSrc, u32 stride, u32 componentCount, __m128* pResult )
+{
+    auto p0 = reinterpret_cast<const f32*>( pSrc );
+    auto p1 = reinterpret_cast<const f32*>( pSrc + stride );
+    auto p2 = reinterpret_cast<const f32*>( pSrc + stride * 2 );
+    auto p3 = reinterpret_cast<const f32*>( pSrc + stride * 3 );
+    for( u32 i=0; i<componentCount; ++i )
+    { pResult[i] = _mm_setr_ps( p0[i], p1[i], p2[i], p3[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      4要素の x, y, z, w をストライド付き配列に書き込みます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void QuantizeScatter( u8* pDst, u32 stride, u32 componentCount, const __m128* pValue )
+{
+    ASDX_ALIGN(16) f32 temp[4][4];
+    for( u32 i=0; i<componentCount; ++i )
+    { _mm_store_ps( temp[i], pValue[i] ); }
+
+    for( u32 j=0; j<4; ++j )
+    {
+        auto p = reinterpret_cast<f32*>( pDst + stride * j );
+        for( u32 i=0; i<componentCount; ++i )
+        { p[i] = temp[i][j]; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ストライド付き配列から4つの u32 を読み込みます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128i QuantizeGatherU32( const u8* pSrc, u32 stride )
+{
+    return _mm_setr_epi32(
+        *reinterpret_cast<const s32*>( pSrc ),
+        *reinterpret_cast<const s32*>( pSrc + stride ),
+        *reinterpret_cast<const s32*>( pSrc + stride * 2 ),
+        *reinterpret_cast<const s32*>( pSrc + stride * 3 ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      4つの u32 をストライド付き配列に書き込みます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void QuantizeScatterU32( u8* pDst, u32 stride, __m128i value )
+{
+    ASDX_ALIGN(16) u32 temp[4];
+    _mm_store_si128( reinterpret_cast<__m128i*>( temp ), value );
+    for( u32 j=0; j<4; ++j )
+    { *reinterpret_cast<u32*>( pDst + stride * j ) = temp[j]; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [-1, 1] を SNORM に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128i EncodeSnorm( __m128 value, __m128 scale )
+{
+    value = _mm_min_ps( _mm_max_ps( value, _mm_set1_ps( -1.0f ) ), _mm_set1_ps( 1.0f ) );
+    return _mm_cvtps_epi32( _mm_mul_ps( value, scale ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SNORM を [-1, 1] に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 DecodeSnorm( __m128i value, __m128 scale )
+{ return _mm_max_ps( _mm_div_ps( _mm_cvtepi32_ps( value ), scale ), _mm_set1_ps( -1.0f ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [0, 1] を UNORM に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128i EncodeUnorm( __m128 value, __m128 scale )
+{
+    value = _mm_min_ps( _mm_max_ps( value, _mm_setzero_ps() ), _mm_set1_ps( 1.0f ) );
+    return _mm_cvtps_epi32( _mm_mul_ps( value, scale ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      UNORM を [0, 1] に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 DecodeUnorm( __m128i value, __m128 scale )
+{ return _mm_div_ps( _mm_cvtepi32_ps( value ), scale ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      0 以上なら 1, それ以外は -1 を返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 SignNotZero( __m128 value )
+{
+    auto mask = _mm_cmpge_ps( value, _mm_setzero_ps() );
+    return _mm_or_ps( _mm_and_ps( mask, _mm_set1_ps( 1.0f ) ), _mm_andnot_ps( mask, _mm_set1_ps( -1.0f ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      4つの単位ベクトルを八面体表現に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeOctahedral( __m128 x, __m128 y, __m128 z, __m128& ox, __m128& oy )
+{
+    auto absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7FFFFFFF ) );
+    auto one     = _mm_set1_ps( 1.0f );
+
+    auto l1    = _mm_add_ps( _mm_add_ps( _mm_and_ps( x, absMask ), _mm_and_ps( y, absMask ) ), _mm_and_ps( z, absMask ) );
+    auto valid = _mm_cmpgt_ps( l1, _mm_setzero_ps() );
+    ox = _mm_and_ps( valid, _mm_div_ps( x, l1 ) );
+    oy = _mm_and_ps( valid, _mm_div_ps( y, l1 ) );
+
+    // 下半球は対角線で折り返す.
+    auto fx = _mm_mul_ps( _mm_sub_ps( one, _mm_and_ps( oy, absMask ) ), SignNotZero( ox ) );
+    auto fy = _mm_mul_ps( _mm_sub_ps( one, _mm_and_ps( ox, absMask ) ), SignNotZero( oy ) );
+    auto neg = _mm_cmplt_ps( z, _mm_setzero_ps() );
+    ox = _mm_or_ps( _mm_and_ps( neg, fx ), _mm_andnot_ps( neg, ox ) );
+    oy = _mm_or_ps( _mm_and_ps( neg, fy ), _mm_andnot_ps( neg, oy ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      4つの八面体表現を単位ベクトルに変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeOctahedral( __m128 ox, __m128 oy, __m128& x, __m128& y, __m128& z )
+{
+    auto absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7FFFFFFF ) );
+    auto zero    = _mm_setzero_ps();
+
+    z = _mm_sub_ps( _mm_sub_ps( _mm_set1_ps( 1.0f ), _mm_and_ps( ox, absMask ) ), _mm_and_ps( oy, absMask ) );
+    auto t = _mm_max_ps( _mm_sub_ps( zero, z ), zero );
+
+    auto tx = _mm_cmpge_ps( ox, zero );
+    auto ty = _mm_cmpge_ps( oy, zero );
+    x = _mm_add_ps( ox, _mm_or_ps( _mm_and_ps( tx, _mm_sub_ps( zero, t ) ), _mm_andnot_ps( tx, t ) ) );
+    y = _mm_add_ps( oy, _mm_or_ps( _mm_and_ps( ty, _mm_sub_ps( zero, t ) ), _mm_andnot_ps( ty, t ) ) );
+
+    auto len = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) ) );
+    x = _mm_div_ps( x, len );
+    y = _mm_div_ps( y, len );
+    z = _mm_div_ps( z, len );
+}
+
+#endif//ASDX_SIMD_SSE2
+
+} // namespace detail
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      単位ベクトルを八面体表現に変換します.
+//!
+//! @param [in]     normal      単位ベクトル.
+//! @return     [-1, 1] の八面体表現を返却します. ゼロベクトルは (0, 0) になります.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+Vector2 EncodeOctahedral( const Vector3& normal )
+{
+    auto l1 = ( fabsf( normal.x ) + fabsf( normal.y ) ) + fabsf( normal.z );
+    auto ox = ( l1 > 0.0f ) ? normal.x / l1 : 0.0f;
+    auto oy = ( l1 > 0.0f ) ? normal.y / l1 : 0.0f;
+
+    // 下半球は対角線で折り返す.
+    if ( normal.z < 0.0f )
+    {
+        auto fx = ( 1.0f - fabsf( oy ) ) * detail::SignNotZero( ox );
+        auto fy = ( 1.0f - fabsf( ox ) ) * detail::SignNotZero( oy );
+        ox = fx;
+        oy = fy;
+    }
+
+    return Vector2( ox, oy );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      八面体表現を単位ベクトルに変換します.
+//!
+//! @param [in]     value       [-1, 1] の八面体表現.
+//! @return     正規化したベクトルを返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+Vector3 DecodeOctahedral( const Vector2& value )
+{
+    auto z = ( 1.0f - fabsf( value.x ) ) - fabsf( value.y );
+    auto t = ( ( 0.0f - z ) > 0.0f ) ? ( 0.0f - z ) : 0.0f;
+    auto x = value.x + ( ( value.x >= 0.0f ) ? ( 0.0f - t ) : t );
+    auto y = value.y + ( ( value.y >= 0.0f ) ? ( 0.0f - t ) : t );
+
+    auto len = sqrtf( x * x + y * y + z * z );
+    return Vector3( x / len, y / len, z / len );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [-1, 1] の値を SNORM8 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+s8 EncodeSnorm8( f32 value )
+{ return static_cast<s8>( detail::EncodeSnorm( value, 127.0f ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [-1, 1] の値を SNORM16 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+s16 EncodeSnorm16( f32 value )
+{ return static_cast<s16>( detail::EncodeSnorm( value, 32767.0f ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [0, 1] の値を UNORM8 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u8 EncodeUnorm8( f32 value )
+{ return static_cast<u8>( detail::EncodeUnorm( value, 255.0f ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [0, 1] の値を UNORM16 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u16 EncodeUnorm16( f32 value )
+{ return static_cast<u16>( detail::EncodeUnorm( value, 65535.0f ) ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SNORM8 を [-1, 1] の値に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 DecodeSnorm8( s8 value )
+{ return detail::DecodeSnorm( value, 127.0f ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SNORM16 を [-1, 1] の値に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 DecodeSnorm16( s16 value )
+{ return detail::DecodeSnorm( value, 32767.0f ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      UNORM8 を [0, 1] の値に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 DecodeUnorm8( u8 value )
+{ return detail::DecodeUnorm( value, 255.0f ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      UNORM16 を [0, 1] の値に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 DecodeUnorm16( u16 value )
+{ return detail::DecodeUnorm( value, 65535.0f ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      法線ベクトルを NormalOct16 形式に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u32 EncodeNormalOct16( const Vector3& normal )
+{
+    auto oct = EncodeOctahedral( normal );
+    auto x   = static_cast<u32>( detail::EncodeSnorm( oct.x, 32767.0f ) ) & 0xFFFF;
+    auto y   = static_cast<u32>( detail::EncodeSnorm( oct.y, 32767.0f ) ) & 0xFFFF;
+    return x | ( y << 16 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      NormalOct16 形式を法線ベクトルに変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+Vector3 DecodeNormalOct16( u32 value )
+{
+    auto x = detail::DecodeSnorm( static_cast<s16>( value & 0xFFFF ), 32767.0f );
+    auto y = detail::DecodeSnorm( static_cast<s16>( value >> 16 ), 32767.0f );
+    return DecodeOctahedral( Vector2( x, y ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      法線ベクトルを NormalOct8 形式に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u16 EncodeNormalOct8( const Vector3& normal )
+{
+    auto oct = EncodeOctahedral( normal );
+    auto x   = static_cast<u32>( detail::EncodeSnorm( oct.x, 127.0f ) ) & 0xFF;
+    auto y   = static_cast<u32>( detail::EncodeSnorm( oct.y, 127.0f ) ) & 0xFF;
+    return static_cast<u16>( x | ( y << 8 ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      NormalOct8 形式を法線ベクトルに変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+Vector3 DecodeNormalOct8( u16 value )
+{
+    auto x = detail::DecodeSnorm( static_cast<s8>( value & 0xFF ), 127.0f );
+    auto y = detail::DecodeSnorm( static_cast<s8>( value >> 8 ), 127.0f );
+    return DecodeOctahedral( Vector2( x, y ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      接線ベクトルを TangentOct 形式に変換します.
+//!
+//! @param [in]     tangent     xyz = 単位接線ベクトル, w = 従法線の向き(±1).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u32 EncodeTangentOct( const Vector4& tangent )
+{
+    auto oct  = EncodeOctahedral( Vector3( tangent.x, tangent.y, tangent.z ) );
+    auto x    = static_cast<u32>( detail::EncodeSnorm( oct.x, 32767.0f ) ) & 0xFFFF;
+    auto y    = static_cast<u32>( detail::EncodeSnorm( oct.y, 16383.0f ) ) & 0x7FFF;
+    auto sign = ( tangent.w < 0.0f ) ? 0x80000000U : 0U;
+    return x | ( y << 16 ) | sign;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      TangentOct 形式を接線ベクトルに変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+Vector4 DecodeTangentOct( u32 value )
+{
+    auto x = detail::DecodeSnorm( static_cast<s16>( value & 0xFFFF ), 32767.0f );
+    auto y = detail::DecodeSnorm( static_cast<s32>( value << 1 ) >> 17, 16383.0f );
+    auto n = DecodeOctahedral( Vector2( x, y ) );
+    return Vector4( n.x, n.y, n.z, ( value & 0x80000000U ) ? -1.0f : 1.0f );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [0, 1] の値を R10G10B10A2 形式に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u32 EncodeR10G10B10A2( const Vector4& value )
+{
+    auto r = static_cast<u32>( detail::EncodeUnorm( value.x, 1023.0f ) );
+    auto g = static_cast<u32>( detail::EncodeUnorm( value.y, 1023.0f ) );
+    auto b = static_cast<u32>( detail::EncodeUnorm( value.z, 1023.0f ) );
+    auto a = static_cast<u32>( detail::EncodeUnorm( value.w, 3.0f ) );
+    return r | ( g << 10 ) | ( b << 20 ) | ( a << 30 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      R10G10B10A2 形式を [0, 1] の値に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+Vector4 DecodeR10G10B10A2( u32 value )
+{
+    return Vector4(
+        detail::DecodeUnorm( static_cast<s32>( value         & 0x3FF ), 1023.0f ),
+        detail::DecodeUnorm( static_cast<s32>( ( value >> 10 ) & 0x3FF ), 1023.0f ),
+        detail::DecodeUnorm( static_cast<s32>( ( value >> 20 ) & 0x3FF ), 1023.0f ),
+        detail::DecodeUnorm( static_cast<s32>( value >> 30 ), 3.0f ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      位置座標をバウンディングボックス基準の UNORM16 x 3 に変換します.
+//!
+//! @param [in]     position    位置座標.
+//! @param [in]     boxMin      バウンディングボックスの最小値.
+//! @param [in]     boxMax      バウンディングボックスの最大値.
+//! @param [out]    pResult     3要素の出力先.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodePosition16( const Vector3& position, const Vector3& boxMin, const Vector3& boxMax, u16* pResult )
+{
+    pResult[0] = static_cast<u16>( detail::EncodeUnorm( ( position.x - boxMin.x ) * detail::PositionInvExtent( boxMin.x, boxMax.x ), 65535.0f ) );
+    pResult[1] = static_cast<u16>( detail::EncodeUnorm( ( position.y - boxMin.y ) * detail::PositionInvExtent( boxMin.y, boxMax.y ), 65535.0f ) );
+    pResult[2] = static_cast<u16>( detail::EncodeUnorm( ( position.z - boxMin.z ) * detail::PositionInvExtent( boxMin.z, boxMax.z ), 65535.0f ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      バウンディングボックス基準の UNORM16 x 3 を位置座標に変換します.
+//!
+//! @param [in]     pValue      3要素の入力.
+//! @param [in]     boxMin      バウンディングボックスの最小値.
+//! @param [in]     boxMax      バウンディングボックスの最大値.
+//! @return     位置座標を返却します. シェーダでは boxMin + value * ( boxMax - boxMin ) で復元できます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+Vector3 DecodePosition16( const u16* pValue, const Vector3& boxMin, const Vector3& boxMax )
+{
+    return Vector3(
+        boxMin.x + detail::DecodeUnorm( pValue[0], 65535.0f ) * ( boxMax.x - boxMin.x ),
+        boxMin.y + detail::DecodeUnorm( pValue[1], 65535.0f ) * ( boxMax.y - boxMin.y ),
+        boxMin.z + detail::DecodeUnorm( pValue[2], 65535.0f ) * ( boxMax.z - boxMin.z ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [-1, 1] の配列を SNORM8 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeSnorm8Stream( const f32* pInput, u32 count, s8* pOutput )
+{
+    u32 i = 0;
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 127.0f );
+    for( ; i + 16 <= count; i += 16 )
+    {
+        auto a = detail::EncodeSnorm( _mm_loadu_ps( pInput + i +  0 ), scale );
+        auto b = detail::EncodeSnorm( _mm_loadu_ps( pInput + i +  4 ), scale );
+        auto c = detail::EncodeSnorm( _mm_loadu_ps( pInput + i +  8 ), scale );
+        auto d = detail::EncodeSnorm( _mm_loadu_ps( pInput + i + 12 ), scale );
+        auto v = _mm_packs_epi16( _mm_packs_epi32( a, b ), _mm_packs_epi32( c, d ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pOutput + i ), v );
+    }
+#endif
+    for( ; i < count; ++i )
+    { pOutput[i] = EncodeSnorm8( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [-1, 1] の配列を SNORM16 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeSnorm16Stream( const f32* pInput, u32 count, s16* pOutput )
+{
+    u32 i = 0;
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 32767.0f );
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto a = detail::EncodeSnorm( _mm_loadu_ps( pInput + i + 0 ), scale );
+        auto b = detail::EncodeSnorm( _mm_loadu_ps( pInput + i + 4 ), scale );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pOutput + i ), _mm_packs_epi32( a, b ) );
+    }
+#endif
+    for( ; i < count; ++i )
+    { pOutput[i] = EncodeSnorm16( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [0, 1] の配列を UNORM8 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeUnorm8Stream( const f32* pInput, u32 count, u8* pOutput )
+{
+    u32 i = 0;
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 255.0f );
+    for( ; i + 16 <= count; i += 16 )
+    {
+        auto a = detail::EncodeUnorm( _mm_loadu_ps( pInput + i +  0 ), scale );
+        auto b = detail::EncodeUnorm( _mm_loadu_ps( pInput + i +  4 ), scale );
+        auto c = detail::EncodeUnorm( _mm_loadu_ps( pInput + i +  8 ), scale );
+        auto d = detail::EncodeUnorm( _mm_loadu_ps( pInput + i + 12 ), scale );
+        auto v = _mm_packus_epi16( _mm_packs_epi32( a, b ), _mm_packs_epi32( c, d ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pOutput + i ), v );
+    }
+#endif
+    for( ; i < count; ++i )
+    { pOutput[i] = EncodeUnorm8( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [0, 1] の配列を UNORM16 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeUnorm16Stream( const f32* pInput, u32 count, u16* pOutput )
+{
+    u32 i = 0;
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 65535.0f );
+    for( ; i + 8 <= count; i += 8 )
+    {
+        // 符号付き飽和で詰めるので, 下位16bitを符号拡張しておく.
+        auto a = detail::EncodeUnorm( _mm_loadu_ps( pInput + i + 0 ), scale );
+        auto b = detail::EncodeUnorm( _mm_loadu_ps( pInput + i + 4 ), scale );
+        a = _mm_srai_epi32( _mm_slli_epi32( a, 16 ), 16 );
+        b = _mm_srai_epi32( _mm_slli_epi32( b, 16 ), 16 );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pOutput + i ), _mm_packs_epi32( a, b ) );
+    }
+#endif
+    for( ; i < count; ++i )
+    { pOutput[i] = EncodeUnorm16( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SNORM8 の配列を [-1, 1] に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeSnorm8Stream( const s8* pInput, u32 count, f32* pOutput )
+{
+    u32 i = 0;
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 127.0f );
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto v  = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( pInput + i ) );
+        auto v8 = _mm_unpacklo_epi8( v, v );
+        auto lo = _mm_srai_epi32( _mm_unpacklo_epi16( v8, v8 ), 24 );
+        auto hi = _mm_srai_epi32( _mm_unpackhi_epi16( v8, v8 ), 24 );
+        _mm_storeu_ps( pOutput + i + 0, detail::DecodeSnorm( lo, scale ) );
+        _mm_storeu_ps( pOutput + i + 4, detail::DecodeSnorm( hi, scale ) );
+    }
+#endif
+    for( ; i < count; ++i )
+    { pOutput[i] = DecodeSnorm8( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SNORM16 の配列を [-1, 1] に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeSnorm16Stream( const s16* pInput, u32 count, f32* pOutput )
+{
+    u32 i = 0;
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 32767.0f );
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto v  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pInput + i ) );
+        auto lo = _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 );
+        auto hi = _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 );
+        _mm_storeu_ps( pOutput + i + 0, detail::DecodeSnorm( lo, scale ) );
+        _mm_storeu_ps( pOutput + i + 4, detail::DecodeSnorm( hi, scale ) );
+    }
+#endif
+    for( ; i < count; ++i )
+    { pOutput[i] = DecodeSnorm16( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      UNORM8 の配列を [0, 1] に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeUnorm8Stream( const u8* pInput, u32 count, f32* pOutput )
+{
+    u32 i = 0;
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 255.0f );
+    auto zero  = _mm_setzero_si128();
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto v  = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( pInput + i ) ), zero );
+        _mm_storeu_ps( pOutput + i + 0, detail::DecodeUnorm( _mm_unpacklo_epi16( v, zero ), scale ) );
+        _mm_storeu_ps( pOutput + i + 4, detail::DecodeUnorm( _mm_unpackhi_epi16( v, zero ), scale ) );
+    }
+#endif
+    for( ; i < count; ++i )
+    { pOutput[i] = DecodeUnorm8( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      UNORM16 の配列を [0, 1] に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeUnorm16Stream( const u16* pInput, u32 count, f32* pOutput )
+{
+    u32 i = 0;
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 65535.0f );
+    auto zero  = _mm_setzero_si128();
+    for( ; i + 8 <= count; i += 8 )
+    {
+        auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pInput + i ) );
+        _mm_storeu_ps( pOutput + i + 0, detail::DecodeUnorm( _mm_unpacklo_epi16( v, zero ), scale ) );
+        _mm_storeu_ps( pOutput + i + 4, detail::DecodeUnorm( _mm_unpackhi_epi16( v, zero ), scale ) );
+    }
+#endif
+    for( ; i < count; ++i )
+    { pOutput[i] = DecodeUnorm16( pInput[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      法線ベクトルの配列を NormalOct16 形式に変換します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [out]    pOutput         出力の配列.
+//! @param [in]     outputStride    出力の間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeNormalOct16Stream( const Vector3* pInput, u32 inputStride, u32 count, u32* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 32767.0f );
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128 v[3];
+        __m128 ox, oy;
+        detail::QuantizeGather( pSrc + size_t( i ) * inputStride, inputStride, 3, v );
+        detail::EncodeOctahedral( v[0], v[1], v[2], ox, oy );
+
+        auto x = _mm_and_si128( detail::EncodeSnorm( ox, scale ), _mm_set1_epi32( 0xFFFF ) );
+        auto y = _mm_slli_epi32( detail::EncodeSnorm( oy, scale ), 16 );
+        detail::QuantizeScatterU32( pDst + size_t( i ) * outputStride, outputStride, _mm_or_si128( x, y ) );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto& n = *reinterpret_cast<const Vector3*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<u32*>( pDst + size_t( i ) * outputStride ) = EncodeNormalOct16( n );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      NormalOct16 形式の配列を法線ベクトルに変換します.
+//!
+//! @param [in]     pInput          入力の配列.
+//! @param [in]     inputStride     入力の間隔(バイト).
+//! @param [in]     count           要素数.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeNormalOct16Stream( const u32* pInput, u32 inputStride, u32 count, Vector3* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 32767.0f );
+    for( ; i + 4 <= count; i += 4 )
+    {
+        auto v  = detail::QuantizeGatherU32( pSrc + size_t( i ) * inputStride, inputStride );
+        auto ox = detail::DecodeSnorm( _mm_srai_epi32( _mm_slli_epi32( v, 16 ), 16 ), scale );
+        auto oy = detail::DecodeSnorm( _mm_srai_epi32( v, 16 ), scale );
+
+        __m128 n[3];
+        detail::DecodeOctahedral( ox, oy, n[0], n[1], n[2] );
+        detail::QuantizeScatter( pDst + size_t( i ) * outputStride, outputStride, 3, n );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto v = *reinterpret_cast<const u32*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<Vector3*>( pDst + size_t( i ) * outputStride ) = DecodeNormalOct16( v );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      法線ベクトルの配列を NormalOct8 形式に変換します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [out]    pOutput         出力の配列.
+//! @param [in]     outputStride    出力の間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeNormalOct8Stream( const Vector3* pInput, u32 inputStride, u32 count, u16* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 127.0f );
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128 v[3];
+        __m128 ox, oy;
+        detail::QuantizeGather( pSrc + size_t( i ) * inputStride, inputStride, 3, v );
+        detail::EncodeOctahedral( v[0], v[1], v[2], ox, oy );
+
+        auto x = _mm_and_si128( detail::EncodeSnorm( ox, scale ), _mm_set1_epi32( 0xFF ) );
+        auto y = _mm_and_si128( _mm_slli_epi32( detail::EncodeSnorm( oy, scale ), 8 ), _mm_set1_epi32( 0xFF00 ) );
+
+        ASDX_ALIGN(16) u32 temp[4];
+        _mm_store_si128( reinterpret_cast<__m128i*>( temp ), _mm_or_si128( x, y ) );
+        for( u32 j=0; j<4; ++j )
+        { *reinterpret_cast<u16*>( pDst + size_t( i + j ) * outputStride ) = static_cast<u16>( temp[j] ); }
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto& n = *reinterpret_cast<const Vector3*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<u16*>( pDst + size_t( i ) * outputStride ) = EncodeNormalOct8( n );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      NormalOct8 形式の配列を法線ベクトルに変換します.
+//!
+//! @param [in]     pInput          入力の配列.
+//! @param [in]     inputStride     入力の間隔(バイト).
+//! @param [in]     count           要素数.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeNormalOct8Stream( const u16* pInput, u32 inputStride, u32 count, Vector3* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 127.0f );
+    for( ; i + 4 <= count; i += 4 )
+    {
+        auto v = _mm_setr_epi32(
+            *reinterpret_cast<const u16*>( pSrc + size_t( i + 0 ) * inputStride ),
+            *reinterpret_cast<const u16*>( pSrc + size_t( i + 1 ) * inputStride ),
+            *reinterpret_cast<const u16*>( pSrc + size_t( i + 2 ) * inputStride ),
+            *reinterpret_cast<const u16*>( pSrc + size_t( i + 3 ) * inputStride ) );
+        auto ox = detail::DecodeSnorm( _mm_srai_epi32( _mm_slli_epi32( v, 24 ), 24 ), scale );
+        auto oy = detail::DecodeSnorm( _mm_srai_epi32( _mm_slli_epi32( v, 16 ), 24 ), scale );
+
+        __m128 n[3];
+        detail::DecodeOctahedral( ox, oy, n[0], n[1], n[2] );
+        detail::QuantizeScatter( pDst + size_t( i ) * outputStride, outputStride, 3, n );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto v = *reinterpret_cast<const u16*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<Vector3*>( pDst + size_t( i ) * outputStride ) = DecodeNormalOct8( v );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      接線ベクトルの配列を TangentOct 形式に変換します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [out]    pOutput         出力の配列.
+//! @param [in]     outputStride    出力の間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeTangentOctStream( const Vector4* pInput, u32 inputStride, u32 count, u32* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scaleX = _mm_set1_ps( 32767.0f );
+    auto scaleY = _mm_set1_ps( 16383.0f );
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128 v[4];
+        __m128 ox, oy;
+        detail::QuantizeGather( pSrc + size_t( i ) * inputStride, inputStride, 4, v );
+        detail::EncodeOctahedral( v[0], v[1], v[2], ox, oy );
+
+        auto x    = _mm_and_si128( detail::EncodeSnorm( ox, scaleX ), _mm_set1_epi32( 0xFFFF ) );
+        auto y    = _mm_and_si128( _mm_slli_epi32( detail::EncodeSnorm( oy, scaleY ), 16 ), _mm_set1_epi32( 0x7FFF0000 ) );
+        auto sign = _mm_and_si128( _mm_castps_si128( _mm_cmplt_ps( v[3], _mm_setzero_ps() ) ), _mm_set1_epi32( 0x80000000 ) );
+        detail::QuantizeScatterU32( pDst + size_t( i ) * outputStride, outputStride, _mm_or_si128( _mm_or_si128( x, y ), sign ) );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto& t = *reinterpret_cast<const Vector4*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<u32*>( pDst + size_t( i ) * outputStride ) = EncodeTangentOct( t );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      TangentOct 形式の配列を接線ベクトルに変換します.
+//!
+//! @param [in]     pInput          入力の配列.
+//! @param [in]     inputStride     入力の間隔(バイト).
+//! @param [in]     count           要素数.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeTangentOctStream( const u32* pInput, u32 inputStride, u32 count, Vector4* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scaleX = _mm_set1_ps( 32767.0f );
+    auto scaleY = _mm_set1_ps( 16383.0f );
+    for( ; i + 4 <= count; i += 4 )
+    {
+        auto v  = detail::QuantizeGatherU32( pSrc + size_t( i ) * inputStride, inputStride );
+        auto ox = detail::DecodeSnorm( _mm_srai_epi32( _mm_slli_epi32( v, 16 ), 16 ), scaleX );
+        auto oy = detail::DecodeSnorm( _mm_srai_epi32( _mm_slli_epi32( v, 1 ), 17 ), scaleY );
+
+        __m128 t[4];
+        detail::DecodeOctahedral( ox, oy, t[0], t[1], t[2] );
+
+        auto neg = _mm_castsi128_ps( _mm_srai_epi32( v, 31 ) );
+        t[3] = _mm_or_ps( _mm_and_ps( neg, _mm_set1_ps( -1.0f ) ), _mm_andnot_ps( neg, _mm_set1_ps( 1.0f ) ) );
+        detail::QuantizeScatter( pDst + size_t( i ) * outputStride, outputStride, 4, t );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto v = *reinterpret_cast<const u32*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<Vector4*>( pDst + size_t( i ) * outputStride ) = DecodeTangentOct( v );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      [0, 1] のベクトルの配列を R10G10B10A2 形式に変換します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [out]    pOutput         出力の配列.
+//! @param [in]     outputStride    出力の間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodeR10G10B10A2Stream( const Vector4* pInput, u32 inputStride, u32 count, u32* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scale10 = _mm_set1_ps( 1023.0f );
+    auto scale2  = _mm_set1_ps( 3.0f );
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128 v[4];
+        detail::QuantizeGather( pSrc + size_t( i ) * inputStride, inputStride, 4, v );
+
+        auto r = detail::EncodeUnorm( v[0], scale10 );
+        auto g = _mm_slli_epi32( detail::EncodeUnorm( v[1], scale10 ), 10 );
+        auto b = _mm_slli_epi32( detail::EncodeUnorm( v[2], scale10 ), 20 );
+        auto a = _mm_slli_epi32( detail::EncodeUnorm( v[3], scale2 ), 30 );
+        detail::QuantizeScatterU32( pDst + size_t( i ) * outputStride, outputStride, _mm_or_si128( _mm_or_si128( r, g ), _mm_or_si128( b, a ) ) );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto& v = *reinterpret_cast<const Vector4*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<u32*>( pDst + size_t( i ) * outputStride ) = EncodeR10G10B10A2( v );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      R10G10B10A2 形式の配列を [0, 1] のベクトルに変換します.
+//!
+//! @param [in]     pInput          入力の配列.
+//! @param [in]     inputStride     入力の間隔(バイト).
+//! @param [in]     count           要素数.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodeR10G10B10A2Stream( const u32* pInput, u32 inputStride, u32 count, Vector4* pOutput, u32 outputStride )
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scale10 = _mm_set1_ps( 1023.0f );
+    auto scale2  = _mm_set1_ps( 3.0f );
+    auto mask10  = _mm_set1_epi32( 0x3FF );
+    for( ; i + 4 <= count; i += 4 )
+    {
+        auto v = detail::QuantizeGatherU32( pSrc + size_t( i ) * inputStride, inputStride );
+
+        __m128 c[4];
+        c[0] = detail::DecodeUnorm( _mm_and_si128( v, mask10 ), scale10 );
+        c[1] = detail::DecodeUnorm( _mm_and_si128( _mm_srli_epi32( v, 10 ), mask10 ), scale10 );
+        c[2] = detail::DecodeUnorm( _mm_and_si128( _mm_srli_epi32( v, 20 ), mask10 ), scale10 );
+        c[3] = detail::DecodeUnorm( _mm_srli_epi32( v, 30 ), scale2 );
+        detail::QuantizeScatter( pDst + size_t( i ) * outputStride, outputStride, 4, c );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto v = *reinterpret_cast<const u32*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<Vector4*>( pDst + size_t( i ) * outputStride ) = DecodeR10G10B10A2( v );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      位置座標の配列をバウンディングボックス基準の UNORM16 x 3 に変換します.
+//!
+//! @param [in]     pInput          入力ベクトルの配列.
+//! @param [in]     inputStride     入力ベクトルの間隔(バイト).
+//! @param [in]     count           ベクトルの数.
+//! @param [in]     boxMin          バウンディングボックスの最小値.
+//! @param [in]     boxMax          バウンディングボックスの最大値.
+//! @param [out]    pOutput         出力の配列(1要素あたり u16 x 3).
+//! @param [in]     outputStride    出力の間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void EncodePosition16Stream
+(
+    const Vector3*  pInput,
+    u32             inputStride,
+    u32             count,
+    const Vector3&  boxMin,
+    const Vector3&  boxMax,
+    u16*            pOutput,
+    u32             outputStride
+)
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 65535.0f );
+    __m128 minV[3] = {
+        _mm_set1_ps( boxMin.x ),
+        _mm_set1_ps( boxMin.y ),
+        _mm_set1_ps( boxMin.z ) };
+    __m128 invV[3] = {
+        _mm_set1_ps( detail::PositionInvExtent( boxMin.x, boxMax.x ) ),
+        _mm_set1_ps( detail::PositionInvExtent( boxMin.y, boxMax.y ) ),
+        _mm_set1_ps( detail::PositionInvExtent( boxMin.z, boxMax.z ) ) };
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128 v[3];
+        detail::QuantizeGather( pSrc + size_t( i ) * inputStride, inputStride, 3, v );
+
+        ASDX_ALIGN(16) s32 temp[3][4];
+        for( u32 c=0; c<3; ++c )
+        {
+            auto q = detail::EncodeUnorm( _mm_mul_ps( _mm_sub_ps( v[c], minV[c] ), invV[c] ), scale );
+            _mm_store_si128( reinterpret_cast<__m128i*>( temp[c] ), q );
+        }
+
+        for( u32 j=0; j<4; ++j )
+        {
+            auto p = reinterpret_cast<u16*>( pDst + size_t( i + j ) * outputStride );
+            p[0] = static_cast<u16>( temp[0][j] );
+            p[1] = static_cast<u16>( temp[1][j] );
+            p[2] = static_cast<u16>( temp[2][j] );
+        }
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto& p = *reinterpret_cast<const Vector3*>( pSrc + size_t( i ) * inputStride );
+        EncodePosition16( p, boxMin, boxMax, reinterpret_cast<u16*>( pDst + size_t( i ) * outputStride ) );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      バウンディングボックス基準の UNORM16 x 3 の配列を位置座標に変換します.
+//!
+//! @param [in]     pInput          入力の配列(1要素あたり u16 x 3).
+//! @param [in]     inputStride     入力の間隔(バイト).
+//! @param [in]     count           要素数.
+//! @param [in]     boxMin          バウンディングボックスの最小値.
+//! @param [in]     boxMax          バウンディングボックスの最大値.
+//! @param [out]    pOutput         出力ベクトルの配列.
+//! @param [in]     outputStride    出力ベクトルの間隔(バイト).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void DecodePosition16Stream
+(
+    const u16*      pInput,
+    u32             inputStride,
+    u32             count,
+    const Vector3&  boxMin,
+    const Vector3&  boxMax,
+    Vector3*        pOutput,
+    u32             outputStride
+)
+{
+    auto pSrc = reinterpret_cast<const u8*>( pInput );
+    auto pDst = reinterpret_cast<u8*>( pOutput );
+    u32 i = 0;
+
+#if ASDX_SIMD_SSE2
+    auto scale = _mm_set1_ps( 65535.0f );
+    __m128 minV[3] = {
+        _mm_set1_ps( boxMin.x ),
+        _mm_set1_ps( boxMin.y ),
+        _mm_set1_ps( boxMin.z ) };
+    __m128 extV[3] = {
+        _mm_set1_ps( boxMax.x - boxMin.x ),
+        _mm_set1_ps( boxMax.y - boxMin.y ),
+        _mm_set1_ps( boxMax.z - boxMin.z ) };
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        auto p0 = reinterpret_cast<const u16*>( pSrc + size_t( i + 0 ) * inputStride );
+        auto p1 = reinterpret_cast<const u16*>( pSrc + size_t( i + 1 ) * inputStride );
+        auto p2 = reinterpret_cast<const u16*>( pSrc + size_t( i + 2 ) * inputStride );
+        auto p3 = reinterpret_cast<const u16*>( pSrc + size_t( i + 3 ) * inputStride );
+
+        __m128 v[3];
+        for( u32 c=0; c<3; ++c )
+        {
+            auto q = _mm_setr_epi32( p0[c], p1[c], p2[c], p3[c] );
+            v[c] = _mm_add_ps( minV[c], _mm_mul_ps( detail::DecodeUnorm( q, scale ), extV[c] ) );
+        }
+        detail::QuantizeScatter( pDst + size_t( i ) * outputStride, outputStride, 3, v );
+    }
+#endif
+
+    for( ; i < count; ++i )
+    {
+        auto p = reinterpret_cast<const u16*>( pSrc + size_t( i ) * inputStride );
+        *reinterpret_cast<Vector3*>( pDst + size_t( i ) * outputStride ) = DecodePosition16( p, boxMin, boxMax );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      要素ごとの絶対誤差を求めます.
+//!
+//! @param [in]     pOriginal       元の値の配列.
+//! @param [in]     pDecoded        復元した値の配列.
+//! @param [in]     count           要素数.
+//! @return     絶対誤差の統計を返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+QuantizationError ComputeQuantizationError( const f32* pOriginal, const f32* pDecoded, u32 count )
+{
+    QuantizationError result = {};
+    if ( count == 0 )
+    { return result; }
+
+    f64 sum   = 0.0;
+    f64 sumSq = 0.0;
+    for( u32 i=0; i<count; ++i )
+    {
+        auto e = fabsf( pOriginal[i] - pDecoded[i] );
+        result.MaxError = ( e > result.MaxError ) ? e : result.MaxError;
+        sum   += e;
+        sumSq += f64( e ) * e;
+    }
+
+    result.MeanError = static_cast<f32>( sum / count );
+    result.RmsError  = static_cast<f32>( sqrt( sumSq / count ) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      単位ベクトル同士の角度誤差(ラジアン)を求めます.
+//!
+//! @param [in]     pOriginal       元のベクトルの配列.
+//! @param [in]     originalStride  元のベクトルの間隔(バイト).
+//! @param [in]     pDecoded        復元したベクトルの配列.
+//! @param [in]     decodedStride   復元したベクトルの間隔(バイト).
+//! @param [in]     count           要素数.
+//! @return     角度誤差の統計を返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+QuantizationError ComputeAngularError
+(
+    const Vector3*  pOriginal,
+    u32             originalStride,
+    const Vector3*  pDecoded,
+    u32             decodedStride,
+    u32             count
+)
+{
+    QuantizationError result = {};
+    if ( count == 0 )
+    { return result; }
+
+    auto pA = reinterpret_cast<const u8*>( pOriginal );
+    auto pB = reinterpret_cast<const u8*>( pDecoded );
+
+    f64 sum   = 0.0;
+    f64 sumSq = 0.0;
+    for( u32 i=0; i<count; ++i )
+    {
+        auto& a = *reinterpret_cast<const Vector3*>( pA + size_t( i ) * originalStride );
+        auto& b = *reinterpret_cast<const Vector3*>( pB + size_t( i ) * decodedStride );
+
+        // acos は 1 付近で精度が落ちるので atan2 で求める.
+        auto c = Vector3::Cross( a, b );
+        auto e = static_cast<f32>( atan2( f64( c.Length() ), f64( Vector3::Dot( a, b ) ) ) );
+        result.MaxError = ( e > result.MaxError ) ? e : result.MaxError;
+        sum   += e;
+        sumSq += f64( e ) * e;
+    }
+
+    result.MeanError = static_cast<f32>( sum / count );
+    result.RmsError  = static_cast<f32>( sqrt( sumSq / count ) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      位置座標同士の距離誤差を求めます.
+//!
+//! @param [in]     pOriginal       元の位置座標の配列.
+//! @param [in]     originalStride  元の位置座標の間隔(バイト).
+//! @param [in]     pDecoded        復元した位置座標の配列.
+//! @param [in]     decodedStride   復元した位置座標の間隔(バイト).
+//! @param [in]     count           要素数.
+//! @return     距離誤差の統計を返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+QuantizationError ComputePositionError
+(
+    const Vector3*  pOriginal,
+    u32             originalStride,
+    const Vector3*  pDecoded,
+    u32             decodedStride,
+    u32             count
+)
+{
+    QuantizationError result = {};
+    if ( count == 0 )
+    { return result; }
+
+    auto pA = reinterpret_cast<const u8*>( pOriginal );
+    auto pB = reinterpret_cast<const u8*>( pDecoded );
+
+    f64 sum   = 0.0;
+    f64 sumSq = 0.0;
+    for( u32 i=0; i<count; ++i )
+    {
+        auto& a = *reinterpret_cast<const Vector3*>( pA + size_t( i ) * originalStride );
+        auto& b = *reinterpret_cast<const Vector3*>( pB + size_t( i ) * decodedStride );
+
+        auto e = Vector3::Distance( a, b );
+        result.MaxError = ( e > result.MaxError ) ? e : result.MaxError;
+        sum   += e;
+        sumSq += f64( e ) * e;
+    }
+
+    result.MeanError = static_cast<f32>( sum / count );
+    result.RmsError  = static_cast<f32>( sqrt( sumSq / count ) );
+    return result;
+}
+
+} // namespace asdx
+
+#endif//__ASDX_QUANTIZATION_H__
@@ -0,0 +1,709 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxRandom.h
+// Desc : Vectorized Random Number Generator Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_RANDOM_H__
+#define __ASDX_RANDOM_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxSimd.h>
+#include <cassert>
+
+
+namespace asdx {
+namespace detail {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      xoshiro128++ の状態を1つ進めます.
+//!
+//! @param [in,out] s       1レーン分の状態です.
+//! @return     生成した乱数を返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u32 Xoshiro128Next( u32 s[4] )
+{
+    auto result = s[0] + s[3];
+    result = ( ( result << 7 ) | ( result >> 25 ) ) + s[0];
+
+    auto t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = ( s[3] << 11 ) | ( s[3] >> 21 );
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      xoshiro128++ の状態をジャンプ多項式に従って進めます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void Xoshiro128Jump( u32 s[4], const u32 poly[4] )
+{
+    u32 r[4] = { 0, 0, 0, 0 };
+    for( u32 i=0; i<4; ++i )
+    {
+        for( u32 b=0; b<32; ++b )
+        {
+            if ( poly[i] & ( 1u << b ) )
+            {
+                r[0] ^= s[0];
+                r[1] ^= s[1];
+                r[2] ^= s[2];
+                r[3] ^= s[3];
+            }
+            Xoshiro128Next( s );
+        }
+    }
+
+    s[0] = r[0];
+    s[1] = r[1];
+    s[2] = r[2];
+    s[3] = r[3];
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SplitMix64 で種を拡散します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u64 SplitMix64( u64& state )
+{
+    auto z = ( state += 0x9E3779B97F4A7C15ull );
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+    return z ^ ( z >> 31 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ビット順を反転します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+u32 ReverseBits( u32 value )
+{
+    value = ( value << 16 ) | ( value >> 16 );
+    value = ( ( value & 0x00FF00FF ) << 8 ) | ( ( value & 0xFF00FF00 ) >> 8 );
+    value = ( ( value & 0x0F0F0F0F ) << 4 ) | ( ( value & 0xF0F0F0F0 ) >> 4 );
+    value = ( ( value & 0x33333333 ) << 2 ) | ( ( value & 0xCCCCCCCC ) >> 2 );
+    value = ( ( value & 0x55555555 ) << 1 ) | ( ( value & 0xAAAAAAAA ) >> 1 );
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      32bit の乱数を [0, 1) の f32 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 ToUnitF32( u32 value )
+{ return static_cast<f32>( value >> 8 ) * ( 1.0f / 16777216.0f ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2つの32bit の乱数を [0, 1) の f64 に変換します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f64 ToUnitF64( u32 hi, u32 lo )
+{ return ( static_cast<f64>( hi >> 5 ) * 67108864.0 + static_cast<f64>( lo >> 6 ) ) * ( 1.0 / 9007199254740992.0 ); }
+
+} // namespace detail
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RandomN class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class RandomN
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 LaneCount = 8;     //!< 同時に生成する乱数の数です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param [in]     seed        設定する種.
+    //---------------------------------------------------------------------------------------------
+    explicit RandomN( u64 seed = 0 )
+    { SetSeed( seed ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ランダム種を設定します.
+    //!
+    //! @param [in]     seed        設定する種.
+    //! @note       各レーンは 2^64 ずつ離れた xoshiro128++ の系列になります.
+    //---------------------------------------------------------------------------------------------
+    void SetSeed( u64 seed )
+    {
+        u32 s[4];
+        auto a = detail::SplitMix64( seed );
+        auto b = detail::SplitMix64( seed );
+        s[0] = static_cast<u32>( a );
+        s[1] = static_cast<u32>( a >> 32 );
+        s[2] = static_cast<u32>( b );
+        s[3] = static_cast<u32>( b >> 32 );
+
+        // 全てゼロの状態は不可.
+        if ( ( s[0] | s[1] | s[2] | s[3] ) == 0 )
+        { s[0] = 1; }
+
+        static const u32 kJump[4] = { 0x8764000B, 0xF542D2D3, 0x6FA035C3, 0x77F2DB5B };
+        for( u32 i=0; i<LaneCount; ++i )
+        {
+            if ( i > 0 )
+            { detail::Xoshiro128Jump( s, kJump ); }
+            SetLane( i, s );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全レーンを 2^96 進めます.
+    //!
+    //! @note       レーン同士の間隔は 2^64 なので, 1回進めるごとに重複しない系列が得られます.
+    //---------------------------------------------------------------------------------------------
+    void LongJump()
+    {
+        static const u32 kLongJump[4] = { 0xB523952E, 0x0B6F099F, 0xCCF5A0EF, 0x1C580662 };
+        for( u32 i=0; i<LaneCount; ++i )
+        {
+            u32 s[4];
+            GetLane( i, s );
+            detail::Xoshiro128Jump( s, kLongJump );
+            SetLane( i, s );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      独立した系列を分岐します.
+    //!
+    //! @return     現在の状態のコピーを返却し, 自身は LongJump() で次の系列に進みます.
+    //! @note       ワーカースレッドやジョブごとに1回ずつ呼び出して使います.
+    //---------------------------------------------------------------------------------------------
+    RandomN Split()
+    {
+        auto result = *this;
+        LongJump();
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      種と番号から系列を生成します.
+    //!
+    //! @param [in]     seed        設定する種.
+    //! @param [in]     index       系列番号です. LongJump() を index 回行うので O(index) です.
+    //---------------------------------------------------------------------------------------------
+    static RandomN CreateStream( u64 seed, u32 index )
+    {
+        RandomN result( seed );
+        for( u32 i=0; i<index; ++i )
+        { result.LongJump(); }
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      LaneCount 個の乱数を生成します.
+    //!
+    //! @param [out]    pResult     LaneCount 個の出力先です.
+    //---------------------------------------------------------------------------------------------
+    void Next( u32* pResult )
+    { GenerateU32( pResult, 1 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      u32 の乱数で配列を埋めます.
+    //!
+    //! @note       count が LaneCount の倍数でない場合, 最後のブロックの余りは捨てられます.
+    //---------------------------------------------------------------------------------------------
+    void Fill( u32* pResult, u32 count )
+    {
+        auto blocks = count / LaneCount;
+        GenerateU32( pResult, blocks );
+
+        auto rest = count - blocks * LaneCount;
+        if ( rest > 0 )
+        {
+            ASDX_ALIGN(32) u32 temp[LaneCount];
+            GenerateU32( temp, 1 );
+            for( u32 i=0; i<rest; ++i )
+            { pResult[blocks * LaneCount + i] = temp[i]; }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [0, bound) の u32 の乱数で配列を埋めます.
+    //!
+    //! @note       乗算とシフトで縮小するため, 偏りは bound / 2^32 以下です.
+    //---------------------------------------------------------------------------------------------
+    void Fill( u32* pResult, u32 count, u32 bound )
+    {
+        Fill( pResult, count );
+        for( u32 i=0; i<count; ++i )
+        { pResult[i] = static_cast<u32>( ( u64( pResult[i] ) * bound ) >> 32 ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [a, b) の s32 の乱数で配列を埋めます.
+    //---------------------------------------------------------------------------------------------
+    void Fill( s32* pResult, u32 count, s32 a, s32 b )
+    {
+        assert( a < b );
+        auto p = reinterpret_cast<u32*>( pResult );
+        Fill( p, count, static_cast<u32>( s64( b ) - s64( a ) ) );
+        for( u32 i=0; i<count; ++i )
+        { pResult[i] = static_cast<s32>( s64( a ) + p[i] ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [0, 1) の f32 の乱数で配列を埋めます.
+    //---------------------------------------------------------------------------------------------
+    void Fill( f32* pResult, u32 count )
+    { Fill( pResult, count, 0.0f, 1.0f ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [a, b) の f32 の乱数で配列を埋めます.
+    //!
+    //! @note       a + u * ( b - a ) で計算するため, 丸めにより b が含まれることがあります.
+    //---------------------------------------------------------------------------------------------
+    void Fill( f32* pResult, u32 count, f32 a, f32 b )
+    {
+        auto blocks = count / LaneCount;
+        GenerateF32( pResult, blocks, a, b - a );
+
+        auto rest = count - blocks * LaneCount;
+        if ( rest > 0 )
+        {
+            ASDX_ALIGN(32) u32 temp[LaneCount];
+            GenerateU32( temp, 1 );
+            for( u32 i=0; i<rest; ++i )
+            { pResult[blocks * LaneCount + i] = a + detail::ToUnitF32( temp[i] ) * ( b - a ); }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [0, 1) の f64 の乱数で配列を埋めます.
+    //---------------------------------------------------------------------------------------------
+    void Fill( f64* pResult, u32 count )
+    { Fill( pResult, count, 0.0, 1.0 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      [a, b) の f64 の乱数で配列を埋めます.
+    //!
+    //! @note       2ブロック分の乱数から上位 53bit を作ります.
+    //---------------------------------------------------------------------------------------------
+    void Fill( f64* pResult, u32 count, f64 a, f64 b )
+    {
+        ASDX_ALIGN(32) u32 temp[LaneCount * 2];
+        for( u32 i=0; i<count; i+=LaneCount )
+        {
+            GenerateU32( temp, 2 );
+
+            auto end = ( count - i < LaneCount ) ? count - i : LaneCount;
+            for( u32 j=0; j<end; ++j )
+            { pResult[i + j] = a + detail::ToUnitF64( temp[j], temp[LaneCount + j] ) * ( b - a ); }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      等価演算子です.
+    //---------------------------------------------------------------------------------------------
+    bool operator == ( const RandomN& value ) const
+    { return memcmp( m_State, value.m_State, sizeof(m_State) ) == 0; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      非等価演算子です.
+    //---------------------------------------------------------------------------------------------
+    bool operator != ( const RandomN& value ) const
+    { return !( *this == value ); }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    u32 m_State[4][LaneCount];      //!< [成分][レーン] の状態です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1レーン分の状態を取得します.
+    //---------------------------------------------------------------------------------------------
+    void GetLane( u32 lane, u32 s[4] ) const
+    {
+        for( u32 c=0; c<4; ++c )
+        { s[c] = m_State[c][lane]; }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1レーン分の状態を設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetLane( u32 lane, const u32 s[4] )
+    {
+        for( u32 c=0; c<4; ++c )
+        { m_State[c][lane] = s[c]; }
+    }
+
+#if ASDX_SIMD_AVX2
+    //---------------------------------------------------------------------------------------------
+    //! @brief      32bit 整数を左に回転します.
+    //---------------------------------------------------------------------------------------------
+    template<int N>
+    static __m256i Rotl( __m256i value )
+    { return _mm256_or_si256( _mm256_slli_epi32( value, N ), _mm256_srli_epi32( value, 32 - N ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      状態を1つ進めます.
+    //---------------------------------------------------------------------------------------------
+    static __m256i Step( __m256i& s0, __m256i& s1, __m256i& s2, __m256i& s3 )
+    {
+        auto result = _mm256_add_epi32( Rotl<7>( _mm256_add_epi32( s0, s3 ) ), s0 );
+        auto t = _mm256_slli_epi32( s1, 9 );
+        s2 = _mm256_xor_si256( s2, s0 );
+        s3 = _mm256_xor_si256( s3, s1 );
+        s1 = _mm256_xor_si256( s1, s2 );
+        s0 = _mm256_xor_si256( s0, s3 );
+        s2 = _mm256_xor_si256( s2, t );
+        s3 = Rotl<11>( s3 );
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      blocks * LaneCount 個の u32 を生成します.
+    //---------------------------------------------------------------------------------------------
+    void GenerateU32( u32* pResult, u32 blocks )
+    {
+        auto s0 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( m_State[0] ) );
+        auto s1 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( m_State[1] ) );
+        auto s2 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( m_State[2] ) );
+        auto s3 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( m_State[3] ) );
+
+        for( u32 i=0; i<blocks; ++i )
+        { _mm256_storeu_si256( reinterpret_cast<__m256i*>( pResult + i * LaneCount ), Step( s0, s1, s2, s3 ) ); }
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( m_State[0] ), s0 );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( m_State[1] ), s1 );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( m_State[2] ), s2 );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( m_State[3] ), s3 );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      blocks * LaneCount 個の offset + [0, 1) * scale を生成します.
+    //---------------------------------------------------------------------------------------------
+    void GenerateF32( f32* pResult, u32 blocks, f32 offset, f32 scale )
+    {
+        auto s0 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( m_State[0] ) );
+        auto s1 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( m_State[1] ) );
+        auto s2 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( m_State[2] ) );
+        auto s3 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( m_State[3] ) );
+
+        auto unit = _mm256_set1_ps( 1.0f / 16777216.0f );
+        auto o    = _mm256_set1_ps( offset );
+        auto k    = _mm256_set1_ps( scale );
+        for( u32 i=0; i<blocks; ++i )
+        {
+            auto u = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_srli_epi32( Step( s0, s1, s2, s3 ), 8 ) ), unit );
+            _mm256_storeu_ps( pResult + i * LaneCount, _mm256_add_ps( o, _mm256_mul_ps( u, k ) ) );
+        }
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( m_State[0] ), s0 );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( m_State[1] ), s1 );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( m_State[2] ), s2 );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( m_State[3] ), s3 );
+    }
+#elif ASDX_SIMD_SSE2
+    //---------------------------------------------------------------------------------------------
+    //! @brief      32bit 整数を左に回転します.
+    //---------------------------------------------------------------------------------------------
+    template<int N>
+    static __m128i Rotl( __m128i value )
+    { return _mm_or_si128( _mm_slli_epi32( value, N ), _mm_srli_epi32( value, 32 - N ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      状態を1つ進めます.
+    //---------------------------------------------------------------------------------------------
+    static __m128i Step( __m128i& s0, __m128i& s1, __m128i& s2, __m128i& s3 )
+    {
+        auto result = _mm_add_epi32( Rotl<7>( _mm_add_epi32( s0, s3 ) ), s0 );
+        auto t = _mm_slli_epi32( s1, 9 );
+        s2 = _mm_xor_si128( s2, s0 );
+        s3 = _mm_xor_si128( s3, s1 );
+        s1 = _mm_xor_si128( s1, s2 );
+        s0 = _mm_xor_si128( s0, s3 );
+        s2 = _mm_xor_si128( s2, t );
+        s3 = Rotl<11>( s3 );
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      blocks * LaneCount 個の u32 を生成します.
+    //! @note       4レーンずつ2回に分けて処理します.
+    //---------------------------------------------------------------------------------------------
+    void GenerateU32( u32* pResult, u32 blocks )
+    {
+        for( u32 h=0; h<LaneCount; h+=4 )
+        {
+            auto s0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( m_State[0] + h ) );
+            auto s1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( m_State[1] + h ) );
+            auto s2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( m_State[2] + h ) );
+            auto s3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( m_State[3] + h ) );
+
+            for( u32 i=0; i<blocks; ++i )
+            { _mm_storeu_si128( reinterpret_cast<__m128i*>( pResult + i * LaneCount + h ), Step( s0, s1, s2, s3 ) ); }
+
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( m_State[0] + h ), s0 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( m_State[1] + h ), s1 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( m_State[2] + h ), s2 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( m_State[3] + h ), s3 );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      blocks * LaneCount 個の offset + [0, 1) * scale を生成します.
+    //---------------------------------------------------------------------------------------------
+    void GenerateF32( f32* pResult, u32 blocks, f32 offset, f32 scale )
+    {
+        auto unit = _mm_set1_ps( 1.0f / 16777216.0f );
+        auto o    = _mm_set1_ps( offset );
+        auto k    = _mm_set1_ps( scale );
+
+        for( u32 h=0; h<LaneCount; h+=4 )
+        {
+            auto s0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( m_State[0] + h ) );
+            auto s1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( m_State[1] + h ) );
+            auto s2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( m_State[2] + h ) );
+            auto s3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( m_State[3] + h ) );
+
+            for( u32 i=0; i<blocks; ++i )
+            {
+                auto u = _mm_mul_ps( _mm_cvtepi32_ps( _mm_srli_epi32( Step( s0, s1, s2, s3 ), 8 ) ), unit );
+                _mm_storeu_ps( pResult + i * LaneCount + h, _mm_add_ps( o, _mm_mul_ps( u, k ) ) );
+            }
+
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( m_State[0] + h ), s0 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( m_State[1] + h ), s1 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( m_State[2] + h ), s2 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( m_State[3] + h ), s3 );
+        }
+    }
+#else
+    //---------------------------------------------------------------------------------------------
+    //! @brief      指定レーンの状態を1つ進めます.
+    //---------------------------------------------------------------------------------------------
+    u32 Step( u32 lane )
+    {
+        auto s0 = m_State[0][lane];
+        auto s1 = m_State[1][lane];
+        auto s2 = m_State[2][lane];
+        auto s3 = m_State[3][lane];
+
+        auto result = s0 + s3;
+        result = ( ( result << 7 ) | ( result >> 25 ) ) + s0;
+
+        auto t = s1 << 9;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+
+        m_State[0][lane] = s0;
+        m_State[1][lane] = s1;
+        m_State[2][lane] = s2;
+        m_State[3][lane] = ( s3 << 11 ) | ( s3 >> 21 );
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      blocks * LaneCount 個の u32 を生成します.
+    //---------------------------------------------------------------------------------------------
+    void GenerateU32( u32* pResult, u32 blocks )
+    {
+        for( u32 i=0; i<blocks; ++i )
+        {
+            for( u32 h=0; h<LaneCount; ++h )
+            { pResult[i * LaneCount + h] = Step( h ); }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      blocks * LaneCount 個の offset + [0, 1) * scale を生成します.
+    //---------------------------------------------------------------------------------------------
+    void GenerateF32( f32* pResult, u32 blocks, f32 offset, f32 scale )
+    {
+        for( u32 i=0; i<blocks; ++i )
+        {
+            for( u32 h=0; h<LaneCount; ++h )
+            { pResult[i * LaneCount + h] = offset + detail::ToUnitF32( Step( h ) ) * scale; }
+        }
+    }
+#endif
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      基数 base の逆基数関数 (radical inverse) を求めます.
+//!
+//! @param [in]     index       番号です.
+//! @param [in]     base        基数です(2以上).
+//! @return     [0, 1) の値を返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 RadicalInverse( u32 index, u32 base )
+{
+    assert( base >= 2 );
+    if ( base == 2 )
+    { return detail::ToUnitF32( detail::ReverseBits( index ) ); }
+
+    // 分子と分母を整数で求めて最後に1回だけ除算する.
+    auto invBase = 1.0 / base;
+    u64  reversed = 0;
+    f64  factor   = 1.0;
+    while ( index > 0 )
+    {
+        auto next  = index / base;
+        auto digit = index - next * base;
+        reversed = reversed * base + digit;
+        factor  *= invBase;
+        index    = next;
+    }
+
+    auto result = static_cast<f32>( reversed * factor );
+    return ( result < 1.0f ) ? result : 0.99999994f;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Halton 列の値を求めます.
+//!
+//! @param [in]     index       番号です.
+//! @param [in]     dimension   次元です. 32未満で, i 次元目は i 番目の素数を基数とします.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 Halton( u32 index, u32 dimension )
+{
+    static const u32 kPrimes[32] = {
+          2,   3,   5,   7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,
+         59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113, 127, 131,
+    };
+    assert( dimension < 32 );
+    return RadicalInverse( index, kPrimes[dimension] );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Halton 列で配列を埋めます.
+//!
+//! @param [in]     startIndex      開始番号です.
+//! @param [in]     count           点の数です.
+//! @param [in]     dimensionCount  1点あたりの次元数です(32以下).
+//! @param [out]    pResult         count * dimensionCount 個の出力先です. 点ごとに次元を並べます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FillHalton( u32 startIndex, u32 count, u32 dimensionCount, f32* pResult )
+{
+    assert( dimensionCount <= 32 );
+    for( u32 i=0; i<count; ++i )
+    {
+        for( u32 d=0; d<dimensionCount; ++d )
+        { pResult[i * dimensionCount + d] = Halton( startIndex + i, d ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Sobol 列の値を求めます.
+//!
+//! @param [in]     index       番号です.
+//! @param [in]     dimension   次元です(0 または 1).
+//! @param [in]     scramble    XOR スクランブル値です. 0 の場合はスクランブルしません.
+//! @note       最初の2次元は (0, 2)-列になるため, 2^k 個ごとに層別化された点が得られます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+f32 Sobol( u32 index, u32 dimension, u32 scramble = 0 )
+{
+    assert( dimension < 2 );
+    if ( dimension == 0 )
+    { return detail::ToUnitF32( detail::ReverseBits( index ) ^ scramble ); }
+
+    auto result = scramble;
+    for( u32 v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1 )
+    {
+        if ( index & 0x1 )
+        { result ^= v; }
+    }
+    return detail::ToUnitF32( result );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2次元 Sobol 列で配列を埋めます.
+//!
+//! @param [in]     startIndex      開始番号です.
+//! @param [in]     count           点の数です.
+//! @param [out]    pResult         出力先です.
+//! @param [in]     scrambleX       X のスクランブル値です.
+//! @param [in]     scrambleY       Y のスクランブル値です.
+//! @note       グレイコード順に1ビットずつ更新するため, 1点あたり XOR 2回で求まります.
+//!             点の順序は番号順ではありませんが, startIndex が 2^k の倍数なら先頭から 2^k 個の
+//!             点の集合は Sobol( startIndex ) ～ Sobol( startIndex + 2^k - 1 ) と一致します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void FillSobol2D( u32 startIndex, u32 count, Vector2* pResult, u32 scrambleX = 0, u32 scrambleY = 0 )
+{
+    if ( count == 0 )
+    { return; }
+
+    // 方向数.
+    u32 vx[32];
+    u32 vy[32];
+    vy[0] = 1u << 31;
+    for( u32 i=0; i<32; ++i )
+    {
+        vx[i] = 1u << ( 31 - i );
+        if ( i > 0 )
+        { vy[i] = vy[i - 1] ^ ( vy[i - 1] >> 1 ); }
+    }
+
+    // 開始位置の点から, 開始位置からの相対番号のグレイコード順に辿る.
+    auto x = scrambleX;
+    auto y = scrambleY;
+    for( u32 i=0; i<32; ++i )
+    {
+        if ( startIndex & ( 1u << i ) )
+        {
+            x ^= vx[i];
+            y ^= vy[i];
+        }
+    }
+
+    u32 index = 0;
+    for( u32 i=0; i<count; ++i )
+    {
+        pResult[i].x = detail::ToUnitF32( x );
+        pResult[i].y = detail::ToUnitF32( y );
+
+        // 次の番号で変化するビットの位置.
+        auto bit = 0u;
+        for( auto c = index; c & 0x1; c >>= 1 )
+        { ++bit; }
+
+        if ( bit < 32 )
+        {
+            x ^= vx[bit];
+            y ^= vy[bit];
+        }
+        ++index;
+    }
+}
+
+} // namespace asdx
+
+#endif//__ASDX_RANDOM_H__
@@ -88,6 +88,13 @@ public:
     : m_pPtr( value.m_pPtr )
     { AddRef(); }
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ムーブコンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    RefPtr( RefPtr&& value ) ASDX_NOTHROW
+    : m_pPtr( value.m_pPtr )
+    { value.m_pPtr = nullptr; }
+
     //---------------------------------------------------------------------------------------------
     //! @brief      引数付きコンストラクタです.
     //---------------------------------------------------------------------------------------------
@@ -122,6 +129,20 @@ public:
         return (*this);
     }
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ムーブ代入演算子です.
+    //---------------------------------------------------------------------------------------------
+    RefPtr& operator = ( RefPtr&& value ) ASDX_NOTHROW
+    {
+        if ( this != &value )
+        {
+            Release();
+            m_pPtr = value.m_pPtr;
+            value.m_pPtr = nullptr;
+        }
+        return (*this);
+    }
+
     //---------------------------------------------------------------------------------------------
     //! @brief      代入演算子です.
     //---------------------------------------------------------------------------------------------
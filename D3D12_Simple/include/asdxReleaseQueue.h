@@ -0,0 +1,198 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxReleaseQueue.h
+// Desc : Deferred Release Queue Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_RELEASE_QUEUE_H__
+#define __ASDX_RELEASE_QUEUE_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <asdxRef.h>
+#include <vector>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ReleaseQueue class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+ASDX_TEMPLATE(T)
+class ReleaseQueue : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ReleaseQueue()
+    : m_Current     ( 0 )
+    , m_Oldest      ( 0 )
+    , m_ClosedCount ( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~ReleaseQueue()
+    { Flush(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param [in]     frameCount      GPUが参照している可能性のあるフレーム数です.
+    //---------------------------------------------------------------------------------------------
+    void Init( u32 frameCount )
+    {
+        assert( frameCount > 0 );
+        Flush();
+
+        // 記録中のビンの分を1つ追加しておく.
+        m_Bins.resize( frameCount + 1 );
+        m_Current     = 0;
+        m_Oldest      = 0;
+        m_ClosedCount = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      解放を予約します.
+    //!
+    //! @param [in]     pObject         解放するオブジェクトです.
+    //! @note       参照カウントは呼び出し元から引き継ぎます.
+    //---------------------------------------------------------------------------------------------
+    void Push( T* pObject )
+    {
+        assert( !m_Bins.empty() );
+        if ( pObject != nullptr )
+        { m_Bins[m_Current].Objects.push_back( pObject ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      解放を予約します.
+    //!
+    //! @param [in]     value           解放するオブジェクトです. 呼び出し後は nullptr になります.
+    //---------------------------------------------------------------------------------------------
+    ASDX_TEMPLATE(U)
+    void Push( RefPtr<U>& value )
+    { Push( static_cast<T*>( value.Detach() ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のビンをフェンス値で閉じ，次のフレームのビンに切り替えます.
+    //!
+    //! @param [in]     fenceValue      現在のフレームのコマンドを実行した後にシグナルされるフェンス値です.
+    //! @note       空きビンが無い場合は現在のビンを使い続け，フェンス値のみ更新します.
+    //---------------------------------------------------------------------------------------------
+    void Close( u64 fenceValue )
+    {
+        assert( !m_Bins.empty() );
+        m_Bins[m_Current].FenceValue = fenceValue;
+
+        auto count = static_cast<u32>( m_Bins.size() );
+        if ( m_ClosedCount + 1 >= count )
+        { return; }
+
+        m_ClosedCount++;
+        m_Current = ( m_Current + 1 ) % count;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      GPUの処理が完了したビンのオブジェクトを解放します.
+    //!
+    //! @param [in]     completedValue  完了済みのフェンス値です.
+    //---------------------------------------------------------------------------------------------
+    void Collect( u64 completedValue )
+    {
+        auto count = static_cast<u32>( m_Bins.size() );
+
+        // ビンは閉じた順に並んでいるので，古いものから完了したものだけを見る.
+        while( m_ClosedCount > 0 && m_Bins[m_Oldest].FenceValue <= completedValue )
+        {
+            ReleaseBin( m_Bins[m_Oldest] );
+            m_Oldest = ( m_Oldest + 1 ) % count;
+            m_ClosedCount--;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全てのオブジェクトを即座に解放します.
+    //!
+    //! @note       GPUがアイドル状態であることを確認してから呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    void Flush()
+    {
+        for( u32 i=0; i<m_Bins.size(); ++i )
+        { ReleaseBin( m_Bins[i] ); }
+
+        m_Current     = m_Oldest;
+        m_ClosedCount = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      解放待ちのオブジェクト数を取得します.
+    //!
+    //! @return     解放待ちのオブジェクト数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetCount() const
+    {
+        u32 result = 0;
+        for( u32 i=0; i<m_Bins.size(); ++i )
+        { result += static_cast<u32>( m_Bins[i].Objects.size() ); }
+        return result;
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    struct Bin
+    {
+        u64             FenceValue; //!< このビンのオブジェクトが不要になるフェンス値です.
+        std::vector<T*> Objects;    //!< 解放待ちのオブジェクトです.
+
+        Bin()
+        : FenceValue( 0 )
+        { /* DO_NOTHING */ }
+    };
+
+    std::vector<Bin>    m_Bins;         //!< フレームごとのビンです.
+    u32                 m_Current;      //!< 記録中のビン番号です.
+    u32                 m_Oldest;       //!< 最も古い閉じたビン番号です.
+    u32                 m_ClosedCount;  //!< 閉じたビンの数です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ビンのオブジェクトを解放します.
+    //---------------------------------------------------------------------------------------------
+    static void ReleaseBin( Bin& bin )
+    {
+        for( u32 i=0; i<bin.Objects.size(); ++i )
+        { bin.Objects[i]->Release(); }
+
+        bin.Objects.clear();
+        bin.FenceValue = 0;
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_RELEASE_QUEUE_H__
@@ -0,0 +1,357 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxResidency.h
+// Desc : Residency Manager Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_RESIDENCY_H__
+#define __ASDX_RESIDENCY_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <dxgi1_4.h>
+#include <d3d12.h>
+#include <asdxTypedef.h>
+#include <asdxRef.h>
+#include <asdxResidencyPolicy.h>
+#include <vector>
+#include <cstring>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResidencyManager class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ResidencyManager : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 InvalidHandle = 0xffffffff;    //!< 無効なハンドルです.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ResidencyManager()
+    : m_CurrentFrame    ( 0 )
+    , m_FrameLatency    ( 2 )
+    , m_BatchSize       ( 64 )
+    , m_Threshold       ( 0.9f )
+    {
+        memset( m_Info, 0, sizeof(m_Info) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~ResidencyManager()
+    { Term(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param [in]     pDevice         デバイスです.
+    //! @param [in]     pAdapter        アダプターです.
+    //! @param [in]     frameLatency    GPUが参照している可能性のあるフレーム数です.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init( ID3D12Device* pDevice, IDXGIAdapter* pAdapter, u32 frameLatency )
+    {
+        if ( pDevice == nullptr || pAdapter == nullptr )
+        { return false; }
+
+        // 予算の取得には IDXGIAdapter3 が必要.
+        auto hr = pAdapter->QueryInterface( IID_PPV_ARGS( m_Adapter.GetAddress() ) );
+        if ( FAILED( hr ) )
+        { return false; }
+
+        m_Device       = pDevice;
+        m_CurrentFrame = 0;
+        m_FrameLatency = frameLatency;
+
+        QueryBudget();
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //---------------------------------------------------------------------------------------------
+    void Term()
+    {
+        for( u32 i=0; i<SegmentCount; ++i )
+        {
+            m_Policy[i] = ResidencyPolicy();
+            m_Objects[i].clear();
+        }
+
+        m_Adapter.Reset();
+        m_Device .Reset();
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      リソースを登録します.
+    //!
+    //! @param [in]     pResource       登録するリソースです.
+    //! @param [in]     segment         リソースを配置するメモリセグメントです.
+    //! @return     登録したリソースのハンドルを返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 Register( ID3D12Resource* pResource, DXGI_MEMORY_SEGMENT_GROUP segment = DXGI_MEMORY_SEGMENT_GROUP_LOCAL )
+    {
+        assert( pResource != nullptr );
+        auto desc = pResource->GetDesc();
+        auto info = m_Device->GetResourceAllocationInfo( 0, 1, &desc );
+        return Register( pResource, info.SizeInBytes, segment );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ヒープを登録します.
+    //!
+    //! @param [in]     pHeap           登録するヒープです.
+    //! @param [in]     segment         ヒープを配置するメモリセグメントです.
+    //! @return     登録したヒープのハンドルを返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 Register( ID3D12Heap* pHeap, DXGI_MEMORY_SEGMENT_GROUP segment = DXGI_MEMORY_SEGMENT_GROUP_LOCAL )
+    {
+        assert( pHeap != nullptr );
+        auto desc = pHeap->GetDesc();
+        return Register( pHeap, desc.SizeInBytes, segment );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ページング可能なオブジェクトを登録します.
+    //!
+    //! @param [in]     pObject         登録するオブジェクトです.
+    //! @param [in]     size            オブジェクトのサイズ(バイト)です.
+    //! @param [in]     segment         オブジェクトを配置するメモリセグメントです.
+    //! @return     登録したオブジェクトのハンドルを返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 Register( ID3D12Pageable* pObject, u64 size, DXGI_MEMORY_SEGMENT_GROUP segment )
+    {
+        assert( pObject != nullptr );
+        assert( segment < SegmentCount );
+
+        auto id = m_Policy[segment].Register( size, m_CurrentFrame );
+        if ( id >= m_Objects[segment].size() )
+        { m_Objects[segment].resize( id + 1 ); }
+        m_Objects[segment][id] = pObject;
+
+        return MakeHandle( segment, id );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      登録を解除します.
+    //!
+    //! @param [in]     handle          登録解除するハンドルです.
+    //---------------------------------------------------------------------------------------------
+    void Unregister( u32 handle )
+    {
+        if ( handle == InvalidHandle )
+        { return; }
+
+        auto segment = GetSegment( handle );
+        auto id      = GetId( handle );
+
+        m_Policy [segment].Unregister( id );
+        m_Objects[segment][id].Reset();
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のフレームで使用することを通知します.
+    //!
+    //! @param [in]     handle          使用するオブジェクトのハンドルです.
+    //! @note       退避済みのオブジェクトは次の Update() でまとめて常駐化されます.
+    //---------------------------------------------------------------------------------------------
+    void MarkUsed( u32 handle )
+    {
+        assert( handle != InvalidHandle );
+        m_Policy[GetSegment( handle )].Touch( GetId( handle ), m_CurrentFrame );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      今後使用する予定があることを通知します.
+    //!
+    //! @param [in]     handle          先行して常駐化するオブジェクトのハンドルです.
+    //! @note       退避済みのオブジェクトは Update() で1フレームあたり最大 SetBatchSize() 個ずつ常駐化されます.
+    //---------------------------------------------------------------------------------------------
+    void Prefetch( u32 handle )
+    {
+        assert( handle != InvalidHandle );
+        m_Policy[GetSegment( handle )].Prefetch( GetId( handle ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐状態を更新します.
+    //!
+    //! @note       コマンドリストを実行する前に1フレームに1回呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    void Update()
+    {
+        if ( m_Device.GetPtr() == nullptr )
+        { return; }
+
+        QueryBudget();
+
+        // GPUが参照している可能性のあるフレームで使用したものは退避しない.
+        u64 protectFrame = ( m_CurrentFrame > m_FrameLatency ) ? m_CurrentFrame - m_FrameLatency : 0;
+
+        for( u32 i=0; i<SegmentCount; ++i )
+        {
+            auto& policy = m_Policy[i];
+            auto& info   = m_Info[i];
+            auto  target = static_cast<u64>( info.Budget * m_Threshold );
+
+            // 予算を超えそうなものから先に退避して，常駐化の空きを作る.
+            policy.CollectEvictions( info.CurrentUsage, target, protectFrame, m_BatchSize, m_Ids );
+            if ( !m_Ids.empty() )
+            {
+                GatherObjects( i );
+                m_Device->Evict( static_cast<UINT>( m_Batch.size() ), m_Batch.data() );
+            }
+
+            // このフレームのコマンドリストが参照するものは全て常駐化し, 先行分だけ数を制限する.
+            policy.CollectResidents( m_CurrentFrame, m_BatchSize, m_Ids );
+            if ( !m_Ids.empty() )
+            {
+                GatherObjects( i );
+                m_Device->MakeResident( static_cast<UINT>( m_Batch.size() ), m_Batch.data() );
+            }
+        }
+
+        m_CurrentFrame++;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐しているかどうかチェックします.
+    //!
+    //! @param [in]     handle          判定するハンドルです.
+    //! @retval true    常駐しています.
+    //! @retval false   退避しています.
+    //---------------------------------------------------------------------------------------------
+    bool IsResident( u32 handle ) const
+    { return m_Policy[GetSegment( handle )].IsResident( GetId( handle ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オーバーサブスクライブ状態かどうかチェックします.
+    //!
+    //! @retval true    退避可能なオブジェクトを退避しても予算を超えています.
+    //! @retval false   予算内に収まっています.
+    //! @note       true の場合はアプリケーション側で品質を下げるなどして使用量を抑えてください.
+    //---------------------------------------------------------------------------------------------
+    bool IsOversubscribed() const
+    {
+        return m_Policy[DXGI_MEMORY_SEGMENT_GROUP_LOCAL    ].IsOversubscribed()
+            || m_Policy[DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL].IsOversubscribed();
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前に取得したビデオメモリ情報を取得します.
+    //!
+    //! @param [in]     segment         メモリセグメントです.
+    //! @return     ビデオメモリ情報を返却します.
+    //---------------------------------------------------------------------------------------------
+    const DXGI_QUERY_VIDEO_MEMORY_INFO& GetInfo( DXGI_MEMORY_SEGMENT_GROUP segment ) const
+    { return m_Info[segment]; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のフレーム番号を取得します.
+    //!
+    //! @return     現在のフレーム番号を返却します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetCurrentFrame() const
+    { return m_CurrentFrame; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      退避を開始する予算に対する割合を設定します.
+    //!
+    //! @param [in]     value           予算に対する割合(0.0f～1.0f)です.
+    //---------------------------------------------------------------------------------------------
+    void SetThreshold( f32 value )
+    { m_Threshold = value; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1フレームで退避・先行して常駐化する最大数を設定します.
+    //!
+    //! @param [in]     value           最大数です.
+    //! @note       MarkUsed() したオブジェクトの常駐化はこの数に制限されません.
+    //---------------------------------------------------------------------------------------------
+    void SetBatchSize( u32 value )
+    { m_BatchSize = value; }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    static const u32 SegmentCount = 2;      //!< メモリセグメント数です.
+    static const u32 SegmentShift = 31;     //!< ハンドル中のセグメントのビット位置です.
+
+    RefPtr<ID3D12Device>                    m_Device;                   //!< デバイスです.
+    RefPtr<IDXGIAdapter3>                   m_Adapter;                  //!< アダプターです.
+    ResidencyPolicy                         m_Policy [SegmentCount];    //!< セグメントごとのLRUポリシーです.
+    std::vector<RefPtr<ID3D12Pageable>>     m_Objects[SegmentCount];    //!< セグメントごとのオブジェクトです.
+    DXGI_QUERY_VIDEO_MEMORY_INFO            m_Info   [SegmentCount];    //!< セグメントごとのビデオメモリ情報です.
+    std::vector<u32>                        m_Ids;                      //!< 作業用IDリストです.
+    std::vector<ID3D12Pageable*>            m_Batch;                    //!< 作業用オブジェクトリストです.
+    u64                                     m_CurrentFrame;             //!< 現在のフレーム番号です.
+    u32                                     m_FrameLatency;             //!< GPUが参照している可能性のあるフレーム数です.
+    u32                                     m_BatchSize;                //!< 1フレームで処理する最大数です.
+    f32                                     m_Threshold;                //!< 予算に対する割合です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ハンドルを生成します.
+    //---------------------------------------------------------------------------------------------
+    static u32 MakeHandle( u32 segment, u32 id )
+    { return ( segment << SegmentShift ) | id; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ハンドルからセグメントを取得します.
+    //---------------------------------------------------------------------------------------------
+    static u32 GetSegment( u32 handle )
+    { return handle >> SegmentShift; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ハンドルからIDを取得します.
+    //---------------------------------------------------------------------------------------------
+    static u32 GetId( u32 handle )
+    { return handle & ~( 1u << SegmentShift ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ビデオメモリの予算と使用量を取得します.
+    //---------------------------------------------------------------------------------------------
+    void QueryBudget()
+    {
+        m_Adapter->QueryVideoMemoryInfo( 0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL,     &m_Info[DXGI_MEMORY_SEGMENT_GROUP_LOCAL] );
+        m_Adapter->QueryVideoMemoryInfo( 0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &m_Info[DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL] );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      作業用IDリストからオブジェクトリストを構築します.
+    //---------------------------------------------------------------------------------------------
+    void GatherObjects( u32 segment )
+    {
+        m_Batch.clear();
+        for( u32 i=0; i<m_Ids.size(); ++i )
+        { m_Batch.push_back( m_Objects[segment][m_Ids[i]].GetPtr() ); }
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_RESIDENCY_H__
@@ -0,0 +1,420 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxResidencyPolicy.h
+// Desc : Residency Policy Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_RESIDENCY_POLICY_H__
+#define __ASDX_RESIDENCY_POLICY_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <vector>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ResidencyPolicy class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ResidencyPolicy
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 InvalidId = 0xffffffff;    //!< 無効なIDです.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ResidencyPolicy()
+    : m_Head            ( InvalidId )
+    , m_Tail            ( InvalidId )
+    , m_FreeHead        ( InvalidId )
+    , m_ResidentSize    ( 0 )
+    , m_PendingSize     ( 0 )
+    , m_Oversubscribed  ( false )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを登録します.
+    //!
+    //! @param [in]     size        オブジェクトのサイズ(バイト).
+    //! @param [in]     frame       現在のフレーム番号.
+    //! @return     登録したオブジェクトのIDを返却します.
+    //! @note       登録直後のオブジェクトは常駐状態として扱います.
+    //---------------------------------------------------------------------------------------------
+    u32 Register( u64 size, u64 frame )
+    {
+        u32 id = m_FreeHead;
+        if ( id != InvalidId )
+        { m_FreeHead = m_Entries[id].Next; }
+        else
+        {
+            id = static_cast<u32>( m_Entries.size() );
+            m_Entries.push_back( Entry() );
+        }
+
+        Entry& entry = m_Entries[id];
+        entry.Size          = size;
+        entry.LastUsedFrame = frame;
+        entry.State         = State_Resident;
+        entry.Prev          = InvalidId;
+        entry.Next          = InvalidId;
+
+        PushBack( id );
+        m_ResidentSize += size;
+
+        return id;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトの登録を解除します.
+    //!
+    //! @param [in]     id          登録解除するオブジェクトのID.
+    //---------------------------------------------------------------------------------------------
+    void Unregister( u32 id )
+    {
+        assert( IsValid( id ) );
+        Entry& entry = m_Entries[id];
+
+        if ( entry.State == State_Resident )
+        {
+            Unlink( id );
+            m_ResidentSize -= entry.Size;
+        }
+        else if ( entry.State == State_Pending )
+        {
+            m_PendingSize -= entry.Size;
+            RemovePending( id );
+        }
+
+        entry.State = State_Free;
+        entry.Prev  = InvalidId;
+        entry.Next  = m_FreeHead;
+        m_FreeHead  = id;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オブジェクトを使用済みとしてマークします.
+    //!
+    //! @param [in]     id          使用するオブジェクトのID.
+    //! @param [in]     frame       現在のフレーム番号.
+    //! @retval true    退避済みのため常駐化要求に追加されました.
+    //! @retval false   常駐済みです.
+    //---------------------------------------------------------------------------------------------
+    bool Touch( u32 id, u64 frame )
+    {
+        assert( IsValid( id ) );
+        Entry& entry = m_Entries[id];
+        entry.LastUsedFrame = frame;
+
+        if ( entry.State == State_Resident )
+        {
+            // 最近使用したものとして末尾に移動.
+            if ( m_Tail != id )
+            {
+                Unlink( id );
+                PushBack( id );
+            }
+            return false;
+        }
+
+        if ( entry.State == State_Evicted )
+        {
+            entry.State = State_Pending;
+            m_PendingSize += entry.Size;
+            m_Pending.push_back( id );
+        }
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      先行して常駐化するオブジェクトとしてマークします.
+    //!
+    //! @param [in]     id          常駐化するオブジェクトのID.
+    //! @retval true    退避済みのため常駐化要求に追加されました.
+    //! @retval false   常駐済みか, 既に常駐化待ちです.
+    //! @note       最後に使用したフレーム番号は更新しないので, LRUの順序は変わりません.
+    //---------------------------------------------------------------------------------------------
+    bool Prefetch( u32 id )
+    {
+        assert( IsValid( id ) );
+        Entry& entry = m_Entries[id];
+
+        if ( entry.State != State_Evicted )
+        { return false; }
+
+        entry.State = State_Pending;
+        m_PendingSize += entry.Size;
+        m_Pending.push_back( id );
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐化するオブジェクトを取り出します.
+    //!
+    //! @param [in]     frame           現在のフレーム番号.
+    //! @param [in]     maxPrefetch     先行して常駐化するオブジェクトの最大数.
+    //! @param [out]    result          常駐化するオブジェクトIDの格納先.
+    //! @note       frame で使用したオブジェクトは数に関わらず全て取り出します.
+    //!             maxPrefetch は Prefetch() のみで要求されたオブジェクトにだけ適用されます.
+    //!             取り出したオブジェクトは常駐状態としてLRUリストの末尾に追加されます.
+    //---------------------------------------------------------------------------------------------
+    void CollectResidents( u64 frame, u32 maxPrefetch, std::vector<u32>& result )
+    {
+        result.clear();
+
+        u32 prefetchCount = 0;
+        u32 remain        = 0;
+        for( u32 i=0; i<m_Pending.size(); ++i )
+        {
+            auto id = m_Pending[i];
+            Entry& entry = m_Entries[id];
+
+            // 先行分が上限に達したら要求順のまま次のフレームに回す.
+            if ( entry.LastUsedFrame < frame )
+            {
+                if ( prefetchCount >= maxPrefetch )
+                {
+                    m_Pending[remain++] = id;
+                    continue;
+                }
+                prefetchCount++;
+            }
+
+            entry.State = State_Resident;
+            m_PendingSize  -= entry.Size;
+            m_ResidentSize += entry.Size;
+            PushBack( id );
+
+            result.push_back( id );
+        }
+
+        m_Pending.resize( remain );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      退避するオブジェクトを最も長く使用されていないものから取り出します.
+    //!
+    //! @param [in]     usage           現在の使用量(バイト).
+    //! @param [in]     target          目標とする使用量(バイト).
+    //! @param [in]     protectFrame    このフレーム番号以降に使用されたオブジェクトは退避しません.
+    //! @param [in]     maxCount        取り出す最大数.
+    //! @param [out]    result          退避するオブジェクトIDの格納先.
+    //! @return     退避により解放されるサイズを返却します.
+    //! @note       常駐化待ちのオブジェクトのサイズも使用量に加算して判定します.
+    //!             目標を満たせない場合はオーバーサブスクライブ状態になります.
+    //---------------------------------------------------------------------------------------------
+    u64 CollectEvictions( u64 usage, u64 target, u64 protectFrame, u32 maxCount, std::vector<u32>& result )
+    {
+        result.clear();
+
+        u64 required = usage + m_PendingSize;
+        u64 freed    = 0;
+
+        // 使用量は外部から取得した値なので，解放量が上回った場合に備えて差分は0で止める.
+        auto over = [&]() { return ( required > freed ) && ( required - freed ) > target; };
+
+        // LRUリストは使用フレーム順に並んでいるので先頭から走査する.
+        auto id = m_Head;
+        while( id != InvalidId && over() && result.size() < maxCount )
+        {
+            Entry& entry = m_Entries[id];
+            if ( entry.LastUsedFrame >= protectFrame )
+            { break; }
+
+            auto next = entry.Next;
+
+            Unlink( id );
+            entry.State = State_Evicted;
+            m_ResidentSize -= entry.Size;
+            freed          += entry.Size;
+
+            result.push_back( id );
+            id = next;
+        }
+
+        m_Oversubscribed = over() && ( result.size() < maxCount );
+
+        return freed;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐状態かどうかチェックします.
+    //!
+    //! @param [in]     id          判定するオブジェクトのID.
+    //! @retval true    常駐状態です.
+    //! @retval false   非常駐状態です.
+    //---------------------------------------------------------------------------------------------
+    bool IsResident( u32 id ) const
+    {
+        assert( IsValid( id ) );
+        return m_Entries[id].State == State_Resident;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      最後に使用したフレーム番号を取得します.
+    //!
+    //! @param [in]     id          オブジェクトのID.
+    //! @return     最後に使用したフレーム番号を返却します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetLastUsedFrame( u32 id ) const
+    {
+        assert( IsValid( id ) );
+        return m_Entries[id].LastUsedFrame;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      最も長く使用されていないオブジェクトのIDを取得します.
+    //!
+    //! @return     LRUリストの先頭IDを返却します. 存在しない場合は InvalidId を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetLeastRecentlyUsed() const
+    { return m_Head; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐しているオブジェクトの合計サイズを取得します.
+    //!
+    //! @return     常駐しているオブジェクトの合計サイズを返却します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetResidentSize() const
+    { return m_ResidentSize; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐化待ちのオブジェクトの合計サイズを取得します.
+    //!
+    //! @return     常駐化待ちのオブジェクトの合計サイズを返却します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetPendingSize() const
+    { return m_PendingSize; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐化待ちのオブジェクト数を取得します.
+    //!
+    //! @return     常駐化待ちのオブジェクト数を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetPendingCount() const
+    { return static_cast<u32>( m_Pending.size() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      オーバーサブスクライブ状態かどうかチェックします.
+    //!
+    //! @retval true    直前の退避処理で目標使用量を満たせませんでした.
+    //! @retval false   目標使用量を満たしています.
+    //---------------------------------------------------------------------------------------------
+    bool IsOversubscribed() const
+    { return m_Oversubscribed; }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    enum STATE
+    {
+        State_Free = 0,         //!< 未使用です.
+        State_Resident,         //!< 常駐しています.
+        State_Evicted,          //!< 退避しています.
+        State_Pending,          //!< 常駐化待ちです.
+    };
+
+    struct Entry
+    {
+        u64     Size;           //!< サイズです.
+        u64     LastUsedFrame;  //!< 最後に使用したフレーム番号です.
+        u32     Prev;           //!< LRUリストの前の要素です.
+        u32     Next;           //!< LRUリストの次の要素です(未使用時はフリーリストの次の要素).
+        STATE   State;          //!< 状態です.
+    };
+
+    std::vector<Entry>  m_Entries;          //!< エントリーです.
+    std::vector<u32>    m_Pending;          //!< 常駐化待ちのIDです.
+    u32                 m_Head;             //!< LRUリストの先頭(最も古い)です.
+    u32                 m_Tail;             //!< LRUリストの末尾(最も新しい)です.
+    u32                 m_FreeHead;         //!< フリーリストの先頭です.
+    u64                 m_ResidentSize;     //!< 常駐サイズです.
+    u64                 m_PendingSize;      //!< 常駐化待ちサイズです.
+    bool                m_Oversubscribed;   //!< オーバーサブスクライブ状態かどうか.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      有効なIDかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    bool IsValid( u32 id ) const
+    { return ( id < m_Entries.size() ) && ( m_Entries[id].State != State_Free ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      LRUリストの末尾に追加します.
+    //---------------------------------------------------------------------------------------------
+    void PushBack( u32 id )
+    {
+        Entry& entry = m_Entries[id];
+        entry.Prev = m_Tail;
+        entry.Next = InvalidId;
+
+        if ( m_Tail != InvalidId )
+        { m_Entries[m_Tail].Next = id; }
+        else
+        { m_Head = id; }
+
+        m_Tail = id;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      LRUリストから取り外します.
+    //---------------------------------------------------------------------------------------------
+    void Unlink( u32 id )
+    {
+        Entry& entry = m_Entries[id];
+
+        if ( entry.Prev != InvalidId )
+        { m_Entries[entry.Prev].Next = entry.Next; }
+        else
+        { m_Head = entry.Next; }
+
+        if ( entry.Next != InvalidId )
+        { m_Entries[entry.Next].Prev = entry.Prev; }
+        else
+        { m_Tail = entry.Prev; }
+
+        entry.Prev = InvalidId;
+        entry.Next = InvalidId;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐化待ちリストから取り除きます.
+    //---------------------------------------------------------------------------------------------
+    void RemovePending( u32 id )
+    {
+        for( u32 i=0; i<m_Pending.size(); ++i )
+        {
+            if ( m_Pending[i] == id )
+            {
+                m_Pending.erase( m_Pending.begin() + i );
+                return;
+            }
+        }
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_RESIDENCY_POLICY_H__
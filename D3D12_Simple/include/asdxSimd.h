@@ -0,0 +1,465 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxSimd.h
+// Desc : SIMD Backend Selection Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_SIMD_H__
+#define __ASDX_SIMD_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxTypedef.h>
+#include <cmath>
+
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+
+// ASDX_ENABLE_SIMD を 0 にするとスカラー版のみを使用します.
+#ifndef ASDX_ENABLE_SIMD
+#define ASDX_ENABLE_SIMD        (1)
+#endif//ASDX_ENABLE_SIMD
+
+// コンパイラが対象とする命令セットから使用するバックエンドを決定します.
+// MSVC は /arch:AVX で __AVX__ を, /arch:AVX2 で __AVX2__ を定義します. FMA と F16C は AVX2 と同時に有効にします.
+#if ASDX_ENABLE_SIMD
+    #if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || ( defined(_M_IX86_FP) && ( _M_IX86_FP >= 2 ) )
+        #define ASDX_SIMD_SSE2  (1)
+    #endif
+
+    #if defined(__AVX__)
+        #define ASDX_SIMD_AVX   (1)
+    #endif
+
+    #if defined(__AVX2__)
+        #define ASDX_SIMD_AVX2  (1)
+    #endif
+
+    #if defined(__FMA__) || ( defined(_MSC_VER) && defined(__AVX2__) )
+        #define ASDX_SIMD_FMA   (1)
+    #endif
+
+    #if defined(__F16C__) || ( defined(_MSC_VER) && defined(__AVX2__) )
+        #define ASDX_SIMD_F16C  (1)
+    #endif
+#endif//ASDX_ENABLE_SIMD
+
+// SIMD 版の精度について (FLT_EPSILON = 2^-23, ノルムは無限大ノルム).
+//  - Matrix::Multiply, MultiplyTranspose, Vector4::Transform は FMA 無効時にはスカラー版と同じ順序で
+//    加算するためビット単位で一致します. FMA 有効時の誤差は各要素 2 * FLT_EPSILON * Σ|a_ik * b_kj| 以内です.
+//  - Matrix::Transpose は常にスカラー版と一致します.
+//  - Matrix::Invert はブロック分割で計算するため丸めがスカラー版と異なります.
+//    誤差は各要素 2 * FLT_EPSILON * cond(A) * |A^-1| 以内です.
+//  - Matrix::Determinant の誤差は FLT_EPSILON * |A|^4 以内です.
+
+#ifndef ASDX_SIMD_SSE2
+#define ASDX_SIMD_SSE2          (0)
+#endif//ASDX_SIMD_SSE2
+
+#ifndef ASDX_SIMD_AVX
+#define ASDX_SIMD_AVX           (0)
+#endif//ASDX_SIMD_AVX
+
+#ifndef ASDX_SIMD_AVX2
+#define ASDX_SIMD_AVX2          (0)
+#endif//ASDX_SIMD_AVX2
+
+#ifndef ASDX_SIMD_FMA
+#define ASDX_SIMD_FMA           (0)
+#endif//ASDX_SIMD_FMA
+
+#ifndef ASDX_SIMD_F16C
+#define ASDX_SIMD_F16C          (0)
+#endif//ASDX_SIMD_F16C
+
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#if ASDX_SIMD_AVX || ASDX_SIMD_FMA || ASDX_SIMD_F16C
+#include <immintrin.h>
+#elif ASDX_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+// Macros
+//-------------------------------------------------------------------------------------------------
+#if ASDX_SIMD_SSE2
+#define ASDX_SIMD_SHUFFLE(v, x, y, z, w)    _mm_shuffle_ps( (v), (v), _MM_SHUFFLE( (w), (z), (y), (x) ) )
+#define ASDX_SIMD_SPLAT(v, i)               _mm_shuffle_ps( (v), (v), _MM_SHUFFLE( (i), (i), (i), (i) ) )
+#endif//ASDX_SIMD_SSE2
+
+
+namespace asdx {
+namespace simd {
+
+#if ASDX_SIMD_SSE2
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      a * b + c を計算します.
+//!
+//! @note       FMA が有効な場合は丸めが1回になるため, スカラー版と最大 1ULP 異なります.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 MulAdd( __m128 a, __m128 b, __m128 c )
+{
+#if ASDX_SIMD_FMA
+    return _mm_fmadd_ps( a, b, c );
+#else
+    return _mm_add_ps( _mm_mul_ps( a, b ), c );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      c - a * b を計算します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 NegMulAdd( __m128 a, __m128 b, __m128 c )
+{
+#if ASDX_SIMD_FMA
+    return _mm_fnmadd_ps( a, b, c );
+#else
+    return _mm_sub_ps( c, _mm_mul_ps( a, b ) );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      行ベクトルと行列の積を計算します.
+//!
+//! @param [in]     v           行ベクトルです.
+//! @param [in]     r0          行列の1行目です.
+//! @param [in]     r1          行列の2行目です.
+//! @param [in]     r2          行列の3行目です.
+//! @param [in]     r3          行列の4行目です.
+//! @return     ((v.x * r0 + v.y * r1) + v.z * r2) + v.w * r3 を返却します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 TransformRow( __m128 v, __m128 r0, __m128 r1, __m128 r2, __m128 r3 )
+{
+    auto result = _mm_mul_ps( ASDX_SIMD_SPLAT( v, 0 ), r0 );
+    result = MulAdd( ASDX_SIMD_SPLAT( v, 1 ), r1, result );
+    result = MulAdd( ASDX_SIMD_SPLAT( v, 2 ), r2, result );
+    result = MulAdd( ASDX_SIMD_SPLAT( v, 3 ), r3, result );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      4要素の総和を全要素に格納します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 HorizontalSum( __m128 v )
+{
+    auto t = _mm_add_ps( v, ASDX_SIMD_SHUFFLE( v, 1, 0, 3, 2 ) );
+    return _mm_add_ps( t, ASDX_SIMD_SHUFFLE( t, 2, 3, 0, 1 ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2x2行列の積 a * b を計算します(各ベクトルは行優先の2x2行列).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 Mat2Mul( __m128 a, __m128 b )
+{
+    return MulAdd(
+        ASDX_SIMD_SHUFFLE( a, 1, 0, 3, 2 ), ASDX_SIMD_SHUFFLE( b, 2, 1, 2, 1 ),
+        _mm_mul_ps( a, ASDX_SIMD_SHUFFLE( b, 0, 3, 0, 3 ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2x2行列の積 adj(a) * b を計算します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 Mat2AdjMul( __m128 a, __m128 b )
+{
+    return NegMulAdd(
+        ASDX_SIMD_SHUFFLE( a, 1, 1, 2, 2 ), ASDX_SIMD_SHUFFLE( b, 2, 3, 0, 1 ),
+        _mm_mul_ps( ASDX_SIMD_SHUFFLE( a, 3, 3, 0, 0 ), b ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2x2行列の積 a * adj(b) を計算します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 Mat2MulAdj( __m128 a, __m128 b )
+{
+    return NegMulAdd(
+        ASDX_SIMD_SHUFFLE( a, 1, 0, 3, 2 ), ASDX_SIMD_SHUFFLE( b, 2, 1, 2, 1 ),
+        _mm_mul_ps( a, ASDX_SIMD_SHUFFLE( b, 3, 0, 3, 0 ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      4つの f32 を f16 に変換します.
+//!
+//! @return     各 32bit 要素の下位 16bit に変換結果を格納して返却します.
+//! @note       F32ToF16() と同じく最近接偶数に丸め, 範囲外の値は無限大にします.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128i ConvertF32ToF16( __m128 value )
+{
+    auto bits = _mm_castps_si128( value );
+    auto sign = _mm_and_si128( bits, _mm_set1_epi32( 0x80000000 ) );
+    auto f    = _mm_xor_si128( bits, sign );
+
+    // 正規化数: 指数部のバイアスを付け替えて偶数丸め.
+    auto odd    = _mm_and_si128( _mm_srli_epi32( f, 13 ), _mm_set1_epi32( 1 ) );
+    auto normal = _mm_add_epi32( _mm_add_epi32( f, _mm_set1_epi32( 0xC8000FFF ) ), odd );
+    normal = _mm_srli_epi32( normal, 13 );
+
+    // 非正規化数: 0.5 を足して仮数部の下位に寄せる.
+    auto denorm = _mm_castps_si128( _mm_add_ps( _mm_castsi128_ps( f ), _mm_set1_ps( 0.5f ) ) );
+    denorm = _mm_sub_epi32( denorm, _mm_set1_epi32( 0x3F000000 ) );
+
+    // 無限大と NaN.
+    auto isNaN = _mm_cmpgt_epi32( f, _mm_set1_epi32( 0x7F800000 ) );
+    auto inf   = _mm_or_si128( _mm_set1_epi32( 0x7C00 ), _mm_and_si128( isNaN, _mm_set1_epi32( 0x0200 ) ) );
+
+    auto isDenorm = _mm_cmplt_epi32( f, _mm_set1_epi32( 0x38800000 ) );
+    auto isInf    = _mm_cmpgt_epi32( f, _mm_set1_epi32( 0x477FFFFF ) );
+
+    auto result = _mm_or_si128( _mm_and_si128( isDenorm, denorm ), _mm_andnot_si128( isDenorm, normal ) );
+    result = _mm_or_si128( _mm_and_si128( isInf, inf ), _mm_andnot_si128( isInf, result ) );
+    return _mm_or_si128( result, _mm_srli_epi32( sign, 16 ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      4つの f16 を f32 に変換します.
+//!
+//! @param [in]     value       各 32bit 要素の下位 16bit に f16 を格納した値.
+//! @note       非正規化数は 2^112 を掛けて正規化するため, DAZ が無効である必要があります.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 ConvertF16ToF32( __m128i value )
+{
+    auto expmant = _mm_and_si128( value, _mm_set1_epi32( 0x7FFF ) );
+    auto sign    = _mm_slli_epi32( _mm_xor_si128( value, expmant ), 16 );
+    auto scaled  = _mm_mul_ps(
+        _mm_castsi128_ps( _mm_slli_epi32( expmant, 13 ) ),
+        _mm_castsi128_ps( _mm_set1_epi32( 0x77800000 ) ) );
+
+    // 無限大と NaN は指数部を全て 1 にする.
+    auto infnan = _mm_and_si128( _mm_cmpgt_epi32( expmant, _mm_set1_epi32( 0x7BFF ) ), _mm_set1_epi32( 0x7F800000 ) );
+    return _mm_or_ps( scaled, _mm_castsi128_ps( _mm_or_si128( sign, infnan ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      xyz 成分の外積を計算します(w 成分は 0 になります).
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m128 Cross3( __m128 a, __m128 b )
+{
+    return _mm_sub_ps(
+        _mm_mul_ps( ASDX_SIMD_SHUFFLE( a, 1, 2, 0, 3 ), ASDX_SIMD_SHUFFLE( b, 2, 0, 1, 3 ) ),
+        _mm_mul_ps( ASDX_SIMD_SHUFFLE( a, 2, 0, 1, 3 ), ASDX_SIMD_SHUFFLE( b, 1, 2, 0, 3 ) ) );
+}
+
+#endif//ASDX_SIMD_SSE2
+
+#if ASDX_SIMD_AVX
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      a * b + c を計算します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m256 MulAdd( __m256 a, __m256 b, __m256 c )
+{
+#if ASDX_SIMD_FMA
+    return _mm256_fmadd_ps( a, b, c );
+#else
+    return _mm256_add_ps( _mm256_mul_ps( a, b ), c );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2つの行ベクトルと行列の積を計算します.
+//!
+//! @param [in]     v           上位・下位 128bit に行ベクトルを1つずつ格納したものです.
+//! @param [in]     r0          行列の1行目を両方の 128bit に格納したものです.
+//! @param [in]     r1          行列の2行目を両方の 128bit に格納したものです.
+//! @param [in]     r2          行列の3行目を両方の 128bit に格納したものです.
+//! @param [in]     r3          行列の4行目を両方の 128bit に格納したものです.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+__m256 TransformRow( __m256 v, __m256 r0, __m256 r1, __m256 r2, __m256 r3 )
+{
+    auto result = _mm256_mul_ps( _mm256_shuffle_ps( v, v, 0x00 ), r0 );
+    result = MulAdd( _mm256_shuffle_ps( v, v, 0x55 ), r1, result );
+    result = MulAdd( _mm256_shuffle_ps( v, v, 0xaa ), r2, result );
+    result = MulAdd( _mm256_shuffle_ps( v, v, 0xff ), r3, result );
+    return result;
+}
+
+#endif//ASDX_SIMD_AVX
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FloatN (使用可能な最大幅の浮動小数点ベクトル)
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#if ASDX_SIMD_AVX
+typedef __m256  FloatN;
+static const u32 FloatNWidth = 8;       //!< FloatN の要素数です.
+#elif ASDX_SIMD_SSE2
+typedef __m128  FloatN;
+static const u32 FloatNWidth = 4;       //!< FloatN の要素数です.
+#else
+typedef f32     FloatN;
+static const u32 FloatNWidth = 1;       //!< FloatN の要素数です.
+#endif
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アライメントされたアドレスから読み込みます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+FloatN LoadN( const f32* p )
+{
+#if ASDX_SIMD_AVX
+    return _mm256_load_ps( p );
+#elif ASDX_SIMD_SSE2
+    return _mm_load_ps( p );
+#else
+    return *p;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      任意のアドレスから読み込みます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+FloatN LoadUN( const f32* p )
+{
+#if ASDX_SIMD_AVX
+    return _mm256_loadu_ps( p );
+#elif ASDX_SIMD_SSE2
+    return _mm_loadu_ps( p );
+#else
+    return *p;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      アライメントされたアドレスに書き込みます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void StoreN( f32* p, FloatN v )
+{
+#if ASDX_SIMD_AVX
+    _mm256_store_ps( p, v );
+#elif ASDX_SIMD_SSE2
+    _mm_store_ps( p, v );
+#else
+    *p = v;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      任意のアドレスに書き込みます.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void StoreUN( f32* p, FloatN v )
+{
+#if ASDX_SIMD_AVX
+    _mm256_storeu_ps( p, v );
+#elif ASDX_SIMD_SSE2
+    _mm_storeu_ps( p, v );
+#else
+    *p = v;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      全要素に同じ値を設定します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+FloatN SetN( f32 value )
+{
+#if ASDX_SIMD_AVX
+    return _mm256_set1_ps( value );
+#elif ASDX_SIMD_SSE2
+    return _mm_set1_ps( value );
+#else
+    return value;
+#endif
+}
+
+#if ASDX_SIMD_AVX
+ASDX_INLINE FloatN AddN ( FloatN a, FloatN b ) { return _mm256_add_ps( a, b ); }
+ASDX_INLINE FloatN SubN ( FloatN a, FloatN b ) { return _mm256_sub_ps( a, b ); }
+ASDX_INLINE FloatN MulN ( FloatN a, FloatN b ) { return _mm256_mul_ps( a, b ); }
+ASDX_INLINE FloatN DivN ( FloatN a, FloatN b ) { return _mm256_div_ps( a, b ); }
+ASDX_INLINE FloatN MinN ( FloatN a, FloatN b ) { return _mm256_min_ps( a, b ); }
+ASDX_INLINE FloatN MaxN ( FloatN a, FloatN b ) { return _mm256_max_ps( a, b ); }
+ASDX_INLINE FloatN SqrtN( FloatN a )           { return _mm256_sqrt_ps( a ); }
+ASDX_INLINE FloatN MaskPositiveN( FloatN cond, FloatN value )
+{ return _mm256_and_ps( _mm256_cmp_ps( cond, _mm256_setzero_ps(), _CMP_GT_OQ ), value ); }
+ASDX_INLINE FloatN FlipSignN( FloatN value, FloatN sign )
+{ return _mm256_xor_ps( value, _mm256_and_ps( sign, _mm256_set1_ps( -0.0f ) ) ); }
+ASDX_INLINE FloatN AbsN( FloatN value )
+{ return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), value ); }
+ASDX_INLINE bool AnyNegativeN( FloatN value )
+{ return _mm256_movemask_ps( _mm256_cmp_ps( value, _mm256_setzero_ps(), _CMP_LT_OQ ) ) != 0; }
+ASDX_INLINE bool AnyLessEqualN( FloatN a, FloatN b )
+{ return _mm256_movemask_ps( _mm256_cmp_ps( a, b, _CMP_LE_OQ ) ) != 0; }
+ASDX_INLINE u32 LessEqualMaskN( FloatN a, FloatN b )
+{ return static_cast<u32>( _mm256_movemask_ps( _mm256_cmp_ps( a, b, _CMP_LE_OQ ) ) ); }
+#elif ASDX_SIMD_SSE2
+ASDX_INLINE FloatN AddN ( FloatN a, FloatN b ) { return _mm_add_ps( a, b ); }
+ASDX_INLINE FloatN SubN ( FloatN a, FloatN b ) { return _mm_sub_ps( a, b ); }
+ASDX_INLINE FloatN MulN ( FloatN a, FloatN b ) { return _mm_mul_ps( a, b ); }
+ASDX_INLINE FloatN DivN ( FloatN a, FloatN b ) { return _mm_div_ps( a, b ); }
+ASDX_INLINE FloatN MinN ( FloatN a, FloatN b ) { return _mm_min_ps( a, b ); }
+ASDX_INLINE FloatN MaxN ( FloatN a, FloatN b ) { return _mm_max_ps( a, b ); }
+ASDX_INLINE FloatN SqrtN( FloatN a )           { return _mm_sqrt_ps( a ); }
+ASDX_INLINE FloatN MaskPositiveN( FloatN cond, FloatN value )
+{ return _mm_and_ps( _mm_cmpgt_ps( cond, _mm_setzero_ps() ), value ); }
+ASDX_INLINE FloatN FlipSignN( FloatN value, FloatN sign )
+{ return _mm_xor_ps( value, _mm_and_ps( sign, _mm_set1_ps( -0.0f ) ) ); }
+ASDX_INLINE FloatN AbsN( FloatN value )
+{ return _mm_andnot_ps( _mm_set1_ps( -0.0f ), value ); }
+ASDX_INLINE bool AnyNegativeN( FloatN value )
+{ return _mm_movemask_ps( _mm_cmplt_ps( value, _mm_setzero_ps() ) ) != 0; }
+ASDX_INLINE bool AnyLessEqualN( FloatN a, FloatN b )
+{ return _mm_movemask_ps( _mm_cmple_ps( a, b ) ) != 0; }
+ASDX_INLINE u32 LessEqualMaskN( FloatN a, FloatN b )
+{ return static_cast<u32>( _mm_movemask_ps( _mm_cmple_ps( a, b ) ) ); }
+#else
+ASDX_INLINE FloatN AddN ( FloatN a, FloatN b ) { return a + b; }
+ASDX_INLINE FloatN SubN ( FloatN a, FloatN b ) { return a - b; }
+ASDX_INLINE FloatN MulN ( FloatN a, FloatN b ) { return a * b; }
+ASDX_INLINE FloatN DivN ( FloatN a, FloatN b ) { return a / b; }
+ASDX_INLINE FloatN MinN ( FloatN a, FloatN b ) { return ( a < b ) ? a : b; }
+ASDX_INLINE FloatN MaxN ( FloatN a, FloatN b ) { return ( a > b ) ? a : b; }
+ASDX_INLINE FloatN SqrtN( FloatN a )           { return sqrtf( a ); }
+ASDX_INLINE FloatN MaskPositiveN( FloatN cond, FloatN value )
+{ return ( cond > 0.0f ) ? value : 0.0f; }
+ASDX_INLINE FloatN FlipSignN( FloatN value, FloatN sign )
+{ return std::signbit( sign ) ? -value : value; }
+ASDX_INLINE FloatN AbsN( FloatN value )
+{ return fabsf( value ); }
+ASDX_INLINE bool AnyNegativeN( FloatN value )
+{ return value < 0.0f; }
+ASDX_INLINE bool AnyLessEqualN( FloatN a, FloatN b )
+{ return a <= b; }
+ASDX_INLINE u32 LessEqualMaskN( FloatN a, FloatN b )
+{ return ( a <= b ) ? 1u : 0u; }
+#endif
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      a * b + c を計算します.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+FloatN MulAddN( FloatN a, FloatN b, FloatN c )
+{
+#if ASDX_SIMD_SSE2
+    return MulAdd( a, b, c );
+#else
+    return a * b + c;
+#endif
+}
+
+} // namespace simd
+} // namespace asdx
+
+#endif//__ASDX_SIMD_H__
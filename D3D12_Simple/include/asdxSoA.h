@@ -0,0 +1,798 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxSoA.h
+// Desc : Structure of Arrays Vector Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_SOA_H__
+#define __ASDX_SOA_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxSimd.h>
+#include <asdxMemoryTracker.h>
+#include <asdxAlignedAllocator.h>
+#include <cstring>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SoABuffer class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<u32 ComponentCount>
+class SoABuffer
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 Alignment = 32;    //!< 各成分配列のアライメントです.
+    static const u32 BlockSize = 8;     //!< 容量の丸め単位です(AVX の要素数).
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    SoABuffer()
+    : m_pData   ( nullptr )
+    , m_Count   ( 0 )
+    , m_Capacity( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コピーコンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    SoABuffer( const SoABuffer& value )
+    : m_pData   ( nullptr )
+    , m_Count   ( 0 )
+    , m_Capacity( 0 )
+    { Assign( value ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ムーブコンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    SoABuffer( SoABuffer&& value )
+    : m_pData   ( value.m_pData )
+    , m_Count   ( value.m_Count )
+    , m_Capacity( value.m_Capacity )
+    {
+        value.m_pData    = nullptr;
+        value.m_Count    = 0;
+        value.m_Capacity = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~SoABuffer()
+    { Release(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素数を変更します.
+    //!
+    //! @param [in]     count       要素数です.
+    //! @note       既存の要素は保持されます. 追加された要素はゼロで初期化されます.
+    //---------------------------------------------------------------------------------------------
+    void Resize( u32 count )
+    {
+        if ( count > m_Capacity )
+        { Reserve( count ); }
+        else if ( count < m_Count )
+        {
+            // 余白の要素はゼロに保つ.
+            for( u32 i=0; i<ComponentCount; ++i )
+            { memset( m_pData + i * m_Capacity + count, 0, sizeof(f32) * ( m_Count - count ) ); }
+        }
+
+        m_Count = count;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を確保します.
+    //!
+    //! @param [in]     capacity    確保する要素数です. 現在の容量以下の場合は何もしません.
+    //! @note       既存の要素は保持されます. 要素数は変わりません.
+    //---------------------------------------------------------------------------------------------
+    void Reserve( u32 capacity )
+    {
+        if ( capacity <= m_Capacity )
+        { return; }
+
+        capacity   = ( capacity + BlockSize - 1 ) & ~( BlockSize - 1 );
+        auto pData = AllocData( capacity );
+        memset( pData, 0, GetBytes( capacity ) );
+
+        if ( m_pData != nullptr )
+        {
+            for( u32 i=0; i<ComponentCount; ++i )
+            { memcpy( pData + i * capacity, m_pData + i * m_Capacity, sizeof(f32) * m_Count ); }
+            FreeData( m_pData, m_Capacity );
+        }
+
+        m_pData    = pData;
+        m_Capacity = capacity;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      メモリを解放します.
+    //---------------------------------------------------------------------------------------------
+    void Release()
+    {
+        if ( m_pData != nullptr )
+        { FreeData( m_pData, m_Capacity ); }
+
+        m_pData    = nullptr;
+        m_Count    = 0;
+        m_Capacity = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetCount() const
+    { return m_Count; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を取得します.
+    //!
+    //! @return     BlockSize の倍数に丸めた要素数を返却します. [count, capacity) はゼロです.
+    //---------------------------------------------------------------------------------------------
+    u32 GetCapacity() const
+    { return m_Capacity; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素数を BlockSize の倍数に切り上げた数を取得します.
+    //!
+    //! @note       要素数が同じバッファは全てこの数まで確保されていて, [count, padded) はゼロです.
+    //!             容量は縮まないので, 複数のバッファをまとめて処理する場合は容量ではなくこの数を使います.
+    //---------------------------------------------------------------------------------------------
+    u32 GetPaddedCount() const
+    { return ( m_Count + BlockSize - 1 ) & ~( BlockSize - 1 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      成分配列を取得します.
+    //!
+    //! @param [in]     index       成分番号です.
+    //! @return     Alignment でアライメントされた成分配列を返却します.
+    //---------------------------------------------------------------------------------------------
+    f32* GetComponent( u32 index )
+    {
+        assert( index < ComponentCount );
+        return m_pData + index * m_Capacity;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      成分配列を取得します.
+    //!
+    //! @param [in]     index       成分番号です.
+    //! @return     Alignment でアライメントされた成分配列を返却します.
+    //---------------------------------------------------------------------------------------------
+    const f32* GetComponent( u32 index ) const
+    {
+        assert( index < ComponentCount );
+        return m_pData + index * m_Capacity;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      代入演算子です.
+    //---------------------------------------------------------------------------------------------
+    SoABuffer& operator = ( const SoABuffer& value )
+    {
+        if ( this != &value )
+        { Assign( value ); }
+        return (*this);
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ムーブ代入演算子です.
+    //---------------------------------------------------------------------------------------------
+    SoABuffer& operator = ( SoABuffer&& value )
+    {
+        if ( this != &value )
+        {
+            Release();
+            m_pData    = value.m_pData;
+            m_Count    = value.m_Count;
+            m_Capacity = value.m_Capacity;
+
+            value.m_pData    = nullptr;
+            value.m_Count    = 0;
+            value.m_Capacity = 0;
+        }
+        return (*this);
+    }
+
+protected:
+    //=============================================================================================
+    // protected variables.
+    //=============================================================================================
+    f32*    m_pData;        //!< 成分配列を連結したメモリです.
+    u32     m_Count;        //!< 要素数です.
+    u32     m_Capacity;     //!< 成分配列あたりの容量です.
+
+private:
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      値をコピーします.
+    //---------------------------------------------------------------------------------------------
+    void Assign( const SoABuffer& value )
+    {
+        Resize( 0 );
+        Resize( value.m_Count );
+        for( u32 i=0; i<ComponentCount; ++i )
+        { memcpy( GetComponent( i ), value.GetComponent( i ), sizeof(f32) * value.m_Count ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全成分のバイト数を取得します.
+    //---------------------------------------------------------------------------------------------
+    static size_t GetBytes( u32 capacity )
+    { return sizeof(f32) * ComponentCount * capacity; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アライメントされたメモリを確保します.
+    //---------------------------------------------------------------------------------------------
+    static f32* AllocData( u32 capacity )
+    {
+        auto size = GetBytes( capacity );
+        auto ptr  = AlignedAlloc( size, Alignment );
+        assert( ptr != nullptr );
+        MemoryTracker::Instance().OnAlloc( MEMORY_TAG_MATH, size );
+        return static_cast<f32*>( ptr );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      アライメントされたメモリを解放します.
+    //---------------------------------------------------------------------------------------------
+    static void FreeData( f32* ptr, u32 capacity )
+    {
+        MemoryTracker::Instance().OnFree( MEMORY_TAG_MATH, GetBytes( capacity ) );
+        AlignedFree( ptr );
+    }
+};
+
+
+namespace detail {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      成分ごとに線形補間します.
+//-------------------------------------------------------------------------------------------------
+template<u32 N>
+ASDX_INLINE
+void SoALerp( const SoABuffer<N>& a, const SoABuffer<N>& b, f32 amount, SoABuffer<N>& result )
+{
+    using namespace simd;
+    assert( a.GetCount() == b.GetCount() );
+    result.Resize( a.GetCount() );
+
+    auto t = SetN( amount );
+    auto n = a.GetPaddedCount();
+    for( u32 c=0; c<N; ++c )
+    {
+        auto pA = a.GetComponent( c );
+        auto pB = b.GetComponent( c );
+        auto pR = result.GetComponent( c );
+        for( u32 i=0; i<n; i+=FloatNWidth )
+        {
+            auto va = LoadN( pA + i );
+            StoreN( pR + i, SubN( va, MulN( t, SubN( va, LoadN( pB + i ) ) ) ) );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      成分ごとの最小値を求めます.
+//-------------------------------------------------------------------------------------------------
+template<u32 N>
+ASDX_INLINE
+void SoAMin( const SoABuffer<N>& a, const SoABuffer<N>& b, SoABuffer<N>& result )
+{
+    using namespace simd;
+    assert( a.GetCount() == b.GetCount() );
+    result.Resize( a.GetCount() );
+
+    auto n = a.GetPaddedCount();
+    for( u32 c=0; c<N; ++c )
+    {
+        auto pA = a.GetComponent( c );
+        auto pB = b.GetComponent( c );
+        auto pR = result.GetComponent( c );
+        for( u32 i=0; i<n; i+=FloatNWidth )
+        { StoreN( pR + i, MinN( LoadN( pA + i ), LoadN( pB + i ) ) ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      成分ごとの最大値を求めます.
+//-------------------------------------------------------------------------------------------------
+template<u32 N>
+ASDX_INLINE
+void SoAMax( const SoABuffer<N>& a, const SoABuffer<N>& b, SoABuffer<N>& result )
+{
+    using namespace simd;
+    assert( a.GetCount() == b.GetCount() );
+    result.Resize( a.GetCount() );
+
+    auto n = a.GetPaddedCount();
+    for( u32 c=0; c<N; ++c )
+    {
+        auto pA = a.GetComponent( c );
+        auto pB = b.GetComponent( c );
+        auto pR = result.GetComponent( c );
+        for( u32 i=0; i<n; i+=FloatNWidth )
+        { StoreN( pR + i, MaxN( LoadN( pA + i ), LoadN( pB + i ) ) ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      計算結果をスカラー配列に書き出します.
+//!
+//! @note       pResult は count 個分の領域しか無いため，端数はスタック経由でコピーします.
+//-------------------------------------------------------------------------------------------------
+ASDX_INLINE
+void SoAStoreResult( f32* pResult, u32 index, u32 count, simd::FloatN value )
+{
+    if ( index + simd::FloatNWidth <= count )
+    {
+        simd::StoreUN( pResult + index, value );
+        return;
+    }
+
+    ASDX_ALIGN(32) f32 temp[8];
+    simd::StoreN( temp, value );
+    memcpy( pResult + index, temp, sizeof(f32) * ( count - index ) );
+}
+
+} // namespace detail
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Vector3SoA class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Vector3SoA : public SoABuffer<3>
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Vector3SoA()
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param [in]     count       要素数です. 全ての要素はゼロで初期化されます.
+    //---------------------------------------------------------------------------------------------
+    explicit Vector3SoA( u32 count )
+    { Resize( count ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      各成分の配列を取得します.
+    //---------------------------------------------------------------------------------------------
+    f32*       X()       { return GetComponent( 0 ); }
+    f32*       Y()       { return GetComponent( 1 ); }
+    f32*       Z()       { return GetComponent( 2 ); }
+    const f32* X() const { return GetComponent( 0 ); }
+    const f32* Y() const { return GetComponent( 1 ); }
+    const f32* Z() const { return GetComponent( 2 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素を取得します.
+    //---------------------------------------------------------------------------------------------
+    Vector3 Get( u32 index ) const
+    {
+        assert( index < m_Count );
+        return Vector3( X()[index], Y()[index], Z()[index] );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素を設定します.
+    //---------------------------------------------------------------------------------------------
+    void Set( u32 index, const Vector3& value )
+    {
+        assert( index < m_Count );
+        X()[index] = value.x;
+        Y()[index] = value.y;
+        Z()[index] = value.z;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      AoS 配列から変換します.
+    //!
+    //! @param [in]     pInput      入力ベクトルの配列.
+    //! @param [in]     count       ベクトルの数.
+    //! @param [in]     stride      入力ベクトルの間隔(バイト).
+    //---------------------------------------------------------------------------------------------
+    void FromAoS( const Vector3* pInput, u32 count, u32 stride = sizeof(Vector3) )
+    {
+        Resize( count );
+
+        auto pSrc = reinterpret_cast<const u8*>( pInput );
+        auto pX = X();
+        auto pY = Y();
+        auto pZ = Z();
+        for( u32 i=0; i<count; ++i )
+        {
+            auto v = reinterpret_cast<const Vector3*>( pSrc + size_t( i ) * stride );
+            pX[i] = v->x;
+            pY[i] = v->y;
+            pZ[i] = v->z;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      AoS 配列に変換します.
+    //!
+    //! @param [out]    pOutput     GetCount() 個の出力ベクトルの配列.
+    //! @param [in]     stride      出力ベクトルの間隔(バイト).
+    //---------------------------------------------------------------------------------------------
+    void ToAoS( Vector3* pOutput, u32 stride = sizeof(Vector3) ) const
+    {
+        auto pDst = reinterpret_cast<u8*>( pOutput );
+        auto pX = X();
+        auto pY = Y();
+        auto pZ = Z();
+        for( u32 i=0; i<m_Count; ++i )
+        {
+            auto v = reinterpret_cast<Vector3*>( pDst + size_t( i ) * stride );
+            v->x = pX[i];
+            v->y = pY[i];
+            v->z = pZ[i];
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの内積を求めます.
+    //!
+    //! @param [in]     a           入力ベクトル.
+    //! @param [in]     b           入力ベクトル.
+    //! @param [out]    pResult     a.GetCount() 個の内積を格納する配列.
+    //---------------------------------------------------------------------------------------------
+    static void Dot( const Vector3SoA& a, const Vector3SoA& b, f32* pResult )
+    {
+        using namespace simd;
+        assert( a.GetCount() == b.GetCount() );
+
+        auto count = a.GetCount();
+        for( u32 i=0; i<count; i+=FloatNWidth )
+        {
+            auto d = MulN( LoadN( a.X() + i ), LoadN( b.X() + i ) );
+            d = AddN( d, MulN( LoadN( a.Y() + i ), LoadN( b.Y() + i ) ) );
+            d = AddN( d, MulN( LoadN( a.Z() + i ), LoadN( b.Z() + i ) ) );
+            detail::SoAStoreResult( pResult, i, count, d );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの長さを求めます.
+    //!
+    //! @param [in]     value       入力ベクトル.
+    //! @param [out]    pResult     value.GetCount() 個の長さを格納する配列.
+    //---------------------------------------------------------------------------------------------
+    static void Length( const Vector3SoA& value, f32* pResult )
+    {
+        using namespace simd;
+
+        auto count = value.GetCount();
+        for( u32 i=0; i<count; i+=FloatNWidth )
+        {
+            auto x = LoadN( value.X() + i );
+            auto y = LoadN( value.Y() + i );
+            auto z = LoadN( value.Z() + i );
+            auto d = AddN( AddN( MulN( x, x ), MulN( y, y ) ), MulN( z, z ) );
+            detail::SoAStoreResult( pResult, i, count, SqrtN( d ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの外積を求めます.
+    //!
+    //! @note       result は a, b と同じオブジェクトでも構いません.
+    //---------------------------------------------------------------------------------------------
+    static void Cross( const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& result )
+    {
+        using namespace simd;
+        assert( a.GetCount() == b.GetCount() );
+        result.Resize( a.GetCount() );
+
+        auto n = a.GetPaddedCount();
+        for( u32 i=0; i<n; i+=FloatNWidth )
+        {
+            auto ax = LoadN( a.X() + i );
+            auto ay = LoadN( a.Y() + i );
+            auto az = LoadN( a.Z() + i );
+            auto bx = LoadN( b.X() + i );
+            auto by = LoadN( b.Y() + i );
+            auto bz = LoadN( b.Z() + i );
+            StoreN( result.X() + i, SubN( MulN( ay, bz ), MulN( az, by ) ) );
+            StoreN( result.Y() + i, SubN( MulN( az, bx ), MulN( ax, bz ) ) );
+            StoreN( result.Z() + i, SubN( MulN( ax, by ), MulN( ay, bx ) ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとに正規化します.
+    //!
+    //! @note       長さがゼロの要素はゼロベクトルになります.
+    //!             result は value と同じオブジェクトでも構いません.
+    //---------------------------------------------------------------------------------------------
+    static void Normalize( const Vector3SoA& value, Vector3SoA& result )
+    {
+        using namespace simd;
+        result.Resize( value.GetCount() );
+
+        auto n = value.GetPaddedCount();
+        for( u32 i=0; i<n; i+=FloatNWidth )
+        {
+            auto x   = LoadN( value.X() + i );
+            auto y   = LoadN( value.Y() + i );
+            auto z   = LoadN( value.Z() + i );
+            auto mag = SqrtN( AddN( AddN( MulN( x, x ), MulN( y, y ) ), MulN( z, z ) ) );
+            StoreN( result.X() + i, MaskPositiveN( mag, DivN( x, mag ) ) );
+            StoreN( result.Y() + i, MaskPositiveN( mag, DivN( y, mag ) ) );
+            StoreN( result.Z() + i, MaskPositiveN( mag, DivN( z, mag ) ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとに線形補間します.
+    //!
+    //! @note       Vector3::Lerp() と同じ式で計算します.
+    //---------------------------------------------------------------------------------------------
+    static void Lerp( const Vector3SoA& a, const Vector3SoA& b, f32 amount, Vector3SoA& result )
+    { detail::SoALerp( a, b, amount, result ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの最小値を求めます.
+    //---------------------------------------------------------------------------------------------
+    static void Min( const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& result )
+    { detail::SoAMin( a, b, result ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの最大値を求めます.
+    //---------------------------------------------------------------------------------------------
+    static void Max( const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& result )
+    { detail::SoAMax( a, b, result ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Vector4SoA class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Vector4SoA : public SoABuffer<4>
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Vector4SoA()
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      引数付きコンストラクタです.
+    //!
+    //! @param [in]     count       要素数です. 全ての要素はゼロで初期化されます.
+    //---------------------------------------------------------------------------------------------
+    explicit Vector4SoA( u32 count )
+    { Resize( count ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      各成分の配列を取得します.
+    //---------------------------------------------------------------------------------------------
+    f32*       X()       { return GetComponent( 0 ); }
+    f32*       Y()       { return GetComponent( 1 ); }
+    f32*       Z()       { return GetComponent( 2 ); }
+    f32*       W()       { return GetComponent( 3 ); }
+    const f32* X() const { return GetComponent( 0 ); }
+    const f32* Y() const { return GetComponent( 1 ); }
+    const f32* Z() const { return GetComponent( 2 ); }
+    const f32* W() const { return GetComponent( 3 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素を取得します.
+    //---------------------------------------------------------------------------------------------
+    Vector4 Get( u32 index ) const
+    {
+        assert( index < m_Count );
+        return Vector4( X()[index], Y()[index], Z()[index], W()[index] );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素を設定します.
+    //---------------------------------------------------------------------------------------------
+    void Set( u32 index, const Vector4& value )
+    {
+        assert( index < m_Count );
+        X()[index] = value.x;
+        Y()[index] = value.y;
+        Z()[index] = value.z;
+        W()[index] = value.w;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      AoS 配列から変換します.
+    //!
+    //! @param [in]     pInput      入力ベクトルの配列.
+    //! @param [in]     count       ベクトルの数.
+    //! @param [in]     stride      入力ベクトルの間隔(バイト).
+    //---------------------------------------------------------------------------------------------
+    void FromAoS( const Vector4* pInput, u32 count, u32 stride = sizeof(Vector4) )
+    {
+        Resize( count );
+
+        auto pSrc = reinterpret_cast<const u8*>( pInput );
+        auto pX = X();
+        auto pY = Y();
+        auto pZ = Z();
+        auto pW = W();
+        for( u32 i=0; i<count; ++i )
+        {
+            auto v = reinterpret_cast<const Vector4*>( pSrc + size_t( i ) * stride );
+            pX[i] = v->x;
+            pY[i] = v->y;
+            pZ[i] = v->z;
+            pW[i] = v->w;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      AoS 配列に変換します.
+    //!
+    //! @param [out]    pOutput     GetCount() 個の出力ベクトルの配列.
+    //! @param [in]     stride      出力ベクトルの間隔(バイト).
+    //---------------------------------------------------------------------------------------------
+    void ToAoS( Vector4* pOutput, u32 stride = sizeof(Vector4) ) const
+    {
+        auto pDst = reinterpret_cast<u8*>( pOutput );
+        auto pX = X();
+        auto pY = Y();
+        auto pZ = Z();
+        auto pW = W();
+        for( u32 i=0; i<m_Count; ++i )
+        {
+            auto v = reinterpret_cast<Vector4*>( pDst + size_t( i ) * stride );
+            v->x = pX[i];
+            v->y = pY[i];
+            v->z = pZ[i];
+            v->w = pW[i];
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの内積を求めます.
+    //!
+    //! @param [in]     a           入力ベクトル.
+    //! @param [in]     b           入力ベクトル.
+    //! @param [out]    pResult     a.GetCount() 個の内積を格納する配列.
+    //---------------------------------------------------------------------------------------------
+    static void Dot( const Vector4SoA& a, const Vector4SoA& b, f32* pResult )
+    {
+        using namespace simd;
+        assert( a.GetCount() == b.GetCount() );
+
+        auto count = a.GetCount();
+        for( u32 i=0; i<count; i+=FloatNWidth )
+        {
+            auto d = MulN( LoadN( a.X() + i ), LoadN( b.X() + i ) );
+            d = AddN( d, MulN( LoadN( a.Y() + i ), LoadN( b.Y() + i ) ) );
+            d = AddN( d, MulN( LoadN( a.Z() + i ), LoadN( b.Z() + i ) ) );
+            d = AddN( d, MulN( LoadN( a.W() + i ), LoadN( b.W() + i ) ) );
+            detail::SoAStoreResult( pResult, i, count, d );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの長さを求めます.
+    //!
+    //! @param [in]     value       入力ベクトル.
+    //! @param [out]    pResult     value.GetCount() 個の長さを格納する配列.
+    //---------------------------------------------------------------------------------------------
+    static void Length( const Vector4SoA& value, f32* pResult )
+    {
+        using namespace simd;
+
+        auto count = value.GetCount();
+        for( u32 i=0; i<count; i+=FloatNWidth )
+        {
+            auto x = LoadN( value.X() + i );
+            auto y = LoadN( value.Y() + i );
+            auto z = LoadN( value.Z() + i );
+            auto w = LoadN( value.W() + i );
+            auto d = AddN( AddN( AddN( MulN( x, x ), MulN( y, y ) ), MulN( z, z ) ), MulN( w, w ) );
+            detail::SoAStoreResult( pResult, i, count, SqrtN( d ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとに正規化します.
+    //!
+    //! @note       長さがゼロの要素はゼロベクトルになります.
+    //!             result は value と同じオブジェクトでも構いません.
+    //---------------------------------------------------------------------------------------------
+    static void Normalize( const Vector4SoA& value, Vector4SoA& result )
+    {
+        using namespace simd;
+        result.Resize( value.GetCount() );
+
+        auto n = value.GetPaddedCount();
+        for( u32 i=0; i<n; i+=FloatNWidth )
+        {
+            auto x   = LoadN( value.X() + i );
+            auto y   = LoadN( value.Y() + i );
+            auto z   = LoadN( value.Z() + i );
+            auto w   = LoadN( value.W() + i );
+            auto mag = SqrtN( AddN( AddN( AddN( MulN( x, x ), MulN( y, y ) ), MulN( z, z ) ), MulN( w, w ) ) );
+            StoreN( result.X() + i, MaskPositiveN( mag, DivN( x, mag ) ) );
+            StoreN( result.Y() + i, MaskPositiveN( mag, DivN( y, mag ) ) );
+            StoreN( result.Z() + i, MaskPositiveN( mag, DivN( z, mag ) ) );
+            StoreN( result.W() + i, MaskPositiveN( mag, DivN( w, mag ) ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとに線形補間します.
+    //!
+    //! @note       Vector4::Lerp() と同じ式で計算します.
+    //---------------------------------------------------------------------------------------------
+    static void Lerp( const Vector4SoA& a, const Vector4SoA& b, f32 amount, Vector4SoA& result )
+    { detail::SoALerp( a, b, amount, result ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの最小値を求めます.
+    //---------------------------------------------------------------------------------------------
+    static void Min( const Vector4SoA& a, const Vector4SoA& b, Vector4SoA& result )
+    { detail::SoAMin( a, b, result ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      要素ごとの最大値を求めます.
+    //---------------------------------------------------------------------------------------------
+    static void Max( const Vector4SoA& a, const Vector4SoA& b, Vector4SoA& result )
+    { detail::SoAMax( a, b, result ); }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_SOA_H__
@@ -0,0 +1,681 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxSphericalHarmonics.h
+// Desc : Spherical Harmonics Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_SPHERICAL_HARMONICS_H__
+#define __ASDX_SPHERICAL_HARMONICS_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxSimd.h>
+#include <asdxSoA.h>
+#include <asdxParallel.h>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <cstring>
+
+
+//-------------------------------------------------------------------------------------------------
+// 基底関数は DirectXSH と同じ符号規約の実球面調和関数です.
+//
+//      Y0 =  0.282095                  Y4 =  1.092548 * x * y
+//      Y1 = -0.488603 * y              Y5 = -1.092548 * y * z
+//      Y2 =  0.488603 * z              Y6 =  0.315392 * ( 3 * z * z - 1 )
+//      Y3 = -0.488603 * x              Y7 = -1.092548 * x * z
+//                                      Y8 =  0.546274 * ( x * x - y * y )
+//
+// 次数 2 (SH4) は Y0 - Y3, 次数 3 (SH9) は Y0 - Y8 を使用します. 係数は RGB ごとに持ちます.
+//-------------------------------------------------------------------------------------------------
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const f32 SH_K0      = 0.282094791773878f;   //!< sqrt( 1 / 4π ) です.
+static const f32 SH_K1      = 0.488602511902920f;   //!< sqrt( 3 / 4π ) です.
+static const f32 SH_K2      = 1.092548430592079f;   //!< sqrt( 15 / 4π ) です.
+static const f32 SH_K3      = 0.315391565252520f;   //!< sqrt( 5 / 16π ) です.
+static const f32 SH_K4      = 0.546274215296040f;   //!< sqrt( 15 / 16π ) です.
+static const f32 SH_A0      = 3.141592653589793f;   //!< 余弦ローブの帯域 0 の係数 π です.
+static const f32 SH_A1      = 2.094395102393195f;   //!< 余弦ローブの帯域 1 の係数 2π/3 です.
+static const f32 SH_A2      = 0.785398163397448f;   //!< 余弦ローブの帯域 2 の係数 π/4 です.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SH9 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SH9
+{
+    Vector3     c[9];       //!< RGB ごとの係数です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです. 全ての係数をゼロにします.
+    //---------------------------------------------------------------------------------------------
+    SH9()
+    {
+        for( u32 i=0; i<9; ++i )
+        { c[i] = Vector3( 0.0f, 0.0f, 0.0f ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      加算代入演算子です.
+    //---------------------------------------------------------------------------------------------
+    SH9& operator += ( const SH9& value )
+    {
+        for( u32 i=0; i<9; ++i )
+        { c[i] += value.c[i]; }
+        return *this;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      乗算代入演算子です.
+    //---------------------------------------------------------------------------------------------
+    SH9& operator *= ( f32 scale )
+    {
+        for( u32 i=0; i<9; ++i )
+        { c[i] *= scale; }
+        return *this;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      線形補間します.
+    //---------------------------------------------------------------------------------------------
+    static SH9 Lerp( const SH9& a, const SH9& b, f32 amount )
+    {
+        SH9 result;
+        for( u32 i=0; i<9; ++i )
+        { result.c[i] = a.c[i] + ( b.c[i] - a.c[i] ) * amount; }
+        return result;
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SH4 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SH4
+{
+    Vector3     c[4];       //!< RGB ごとの係数です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです. 全ての係数をゼロにします.
+    //---------------------------------------------------------------------------------------------
+    SH4()
+    {
+        for( u32 i=0; i<4; ++i )
+        { c[i] = Vector3( 0.0f, 0.0f, 0.0f ); }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      次数 3 の係数の先頭 4 つから生成します.
+    //---------------------------------------------------------------------------------------------
+    explicit SH4( const SH9& value )
+    {
+        for( u32 i=0; i<4; ++i )
+        { c[i] = value.c[i]; }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      加算代入演算子です.
+    //---------------------------------------------------------------------------------------------
+    SH4& operator += ( const SH4& value )
+    {
+        for( u32 i=0; i<4; ++i )
+        { c[i] += value.c[i]; }
+        return *this;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      乗算代入演算子です.
+    //---------------------------------------------------------------------------------------------
+    SH4& operator *= ( f32 scale )
+    {
+        for( u32 i=0; i<4; ++i )
+        { c[i] *= scale; }
+        return *this;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      線形補間します.
+    //---------------------------------------------------------------------------------------------
+    static SH4 Lerp( const SH4& a, const SH4& b, f32 amount )
+    {
+        SH4 result;
+        for( u32 i=0; i<4; ++i )
+        { result.c[i] = a.c[i] + ( b.c[i] - a.c[i] ) * amount; }
+        return result;
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      次数 2 の基底関数を評価します.
+//!
+//! @param [in]     dir         正規化済みの方向です.
+//! @param [out]    result      基底関数の値です.
+//-------------------------------------------------------------------------------------------------
+inline void EvaluateSHBasis( const Vector3& dir, f32 (&result)[4] )
+{
+    result[0] =  SH_K0;
+    result[1] = -SH_K1 * dir.y;
+    result[2] =  SH_K1 * dir.z;
+    result[3] = -SH_K1 * dir.x;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      次数 3 の基底関数を評価します.
+//!
+//! @param [in]     dir         正規化済みの方向です.
+//! @param [out]    result      基底関数の値です.
+//-------------------------------------------------------------------------------------------------
+inline void EvaluateSHBasis( const Vector3& dir, f32 (&result)[9] )
+{
+    auto x = dir.x;
+    auto y = dir.y;
+    auto z = dir.z;
+
+    result[0] =  SH_K0;
+    result[1] = -SH_K1 * y;
+    result[2] =  SH_K1 * z;
+    result[3] = -SH_K1 * x;
+    result[4] =  SH_K2 * x * y;
+    result[5] = -SH_K2 * y * z;
+    result[6] =  SH_K3 * ( 3.0f * z * z - 1.0f );
+    result[7] = -SH_K2 * x * z;
+    result[8] =  SH_K4 * ( x * x - y * y );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      指定方向の値を求めます.
+//-------------------------------------------------------------------------------------------------
+inline Vector3 EvaluateSH( const SH4& sh, const Vector3& dir )
+{
+    f32 basis[4];
+    EvaluateSHBasis( dir, basis );
+
+    auto result = sh.c[0] * basis[0];
+    for( u32 i=1; i<4; ++i )
+    { result += sh.c[i] * basis[i]; }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      指定方向の値を求めます.
+//-------------------------------------------------------------------------------------------------
+inline Vector3 EvaluateSH( const SH9& sh, const Vector3& dir )
+{
+    f32 basis[9];
+    EvaluateSHBasis( dir, basis );
+
+    auto result = sh.c[0] * basis[0];
+    for( u32 i=1; i<9; ++i )
+    { result += sh.c[i] * basis[i]; }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      放射輝度の係数から指定法線の放射照度を求めます.
+//!
+//! @note       余弦ローブとの畳み込みを行います. 拡散反射は結果に albedo / π を掛けてください.
+//-------------------------------------------------------------------------------------------------
+inline Vector3 EvaluateIrradiance( const SH4& sh, const Vector3& normal )
+{
+    f32 basis[4];
+    EvaluateSHBasis( normal, basis );
+
+    auto result = sh.c[0] * ( SH_A0 * basis[0] );
+    for( u32 i=1; i<4; ++i )
+    { result += sh.c[i] * ( SH_A1 * basis[i] ); }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      放射輝度の係数から指定法線の放射照度を求めます.
+//!
+//! @note       余弦ローブとの畳み込みを行います. 拡散反射は結果に albedo / π を掛けてください.
+//-------------------------------------------------------------------------------------------------
+inline Vector3 EvaluateIrradiance( const SH9& sh, const Vector3& normal )
+{
+    f32 basis[9];
+    EvaluateSHBasis( normal, basis );
+
+    auto result = sh.c[0] * ( SH_A0 * basis[0] );
+    for( u32 i=1; i<4; ++i )
+    { result += sh.c[i] * ( SH_A1 * basis[i] ); }
+    for( u32 i=4; i<9; ++i )
+    { result += sh.c[i] * ( SH_A2 * basis[i] ); }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      放射照度をまとめて求めます.
+//!
+//! @param [in]     sh          放射輝度の係数です.
+//! @param [in]     normals     正規化済みの法線です.
+//! @param [out]    result      放射照度の格納先です. RGB を XYZ に格納します.
+//! @note       FloatN 単位で処理し, 余白の要素はゼロに戻します.
+//-------------------------------------------------------------------------------------------------
+inline void EvaluateIrradiance( const SH9& sh, const Vector3SoA& normals, Vector3SoA& result )
+{
+    using namespace simd;
+    result.Resize( normals.GetCount() );
+
+    // 帯域の係数と基底の定数を畳み込み, 法線の多項式の係数にしておく.
+    //  E = k0 + k1 * y + k2 * z + k3 * x + k4 * xy + k5 * yz + k6 * zz + k7 * xz + k8 * ( xx - yy )
+    FloatN k[3][9];
+    for( u32 ch=0; ch<3; ++ch )
+    {
+        auto c = [&]( u32 i ) { return ( &sh.c[i].x )[ch]; };
+        k[ch][0] = SetN( SH_A0 * SH_K0 * c( 0 ) - SH_A2 * SH_K3 * c( 6 ) );
+        k[ch][1] = SetN( -SH_A1 * SH_K1 * c( 1 ) );
+        k[ch][2] = SetN(  SH_A1 * SH_K1 * c( 2 ) );
+        k[ch][3] = SetN( -SH_A1 * SH_K1 * c( 3 ) );
+        k[ch][4] = SetN(  SH_A2 * SH_K2 * c( 4 ) );
+        k[ch][5] = SetN( -SH_A2 * SH_K2 * c( 5 ) );
+        k[ch][6] = SetN(  SH_A2 * SH_K3 * 3.0f * c( 6 ) );
+        k[ch][7] = SetN( -SH_A2 * SH_K2 * c( 7 ) );
+        k[ch][8] = SetN(  SH_A2 * SH_K4 * c( 8 ) );
+    }
+
+    auto count = normals.GetCount();
+    auto n     = ( count + FloatNWidth - 1 ) & ~( FloatNWidth - 1 );
+    for( u32 i=0; i<n; i+=FloatNWidth )
+    {
+        auto x  = LoadN( normals.X() + i );
+        auto y  = LoadN( normals.Y() + i );
+        auto z  = LoadN( normals.Z() + i );
+        auto xy = MulN( x, y );
+        auto yz = MulN( y, z );
+        auto zz = MulN( z, z );
+        auto xz = MulN( x, z );
+        auto dd = SubN( MulN( x, x ), MulN( y, y ) );
+
+        for( u32 ch=0; ch<3; ++ch )
+        {
+            auto e = MulAddN( k[ch][1], y, k[ch][0] );
+            e = MulAddN( k[ch][2], z,  e );
+            e = MulAddN( k[ch][3], x,  e );
+            e = MulAddN( k[ch][4], xy, e );
+            e = MulAddN( k[ch][5], yz, e );
+            e = MulAddN( k[ch][6], zz, e );
+            e = MulAddN( k[ch][7], xz, e );
+            e = MulAddN( k[ch][8], dd, e );
+            StoreN( result.GetComponent( ch ) + i, e );
+        }
+    }
+
+    // 余白の要素はゼロに保つ.
+    for( u32 ch=0; ch<3; ++ch )
+    { memset( result.GetComponent( ch ) + count, 0, sizeof(f32) * ( n - count ) ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      放射照度をまとめて求めます.
+//!
+//! @param [in]     sh          放射輝度の係数です.
+//! @param [in]     pNormals    正規化済みの法線の配列です.
+//! @param [in]     count       法線の数です.
+//! @param [out]    pResult     放射照度の格納先です. RGB を XYZ に格納します.
+//! @note       FloatNWidth 個ずつ SoA に並べ替えて処理します.
+//-------------------------------------------------------------------------------------------------
+inline void EvaluateIrradianceStream( const SH9& sh, const Vector3* pNormals, u32 count, Vector3* pResult )
+{
+    const u32 BlockSize = 256;
+
+    thread_local Vector3SoA s_Normals;
+    thread_local Vector3SoA s_Result;
+
+    for( u32 begin=0; begin<count; begin+=BlockSize )
+    {
+        auto size = Min( BlockSize, count - begin );
+        s_Normals.FromAoS( pNormals + begin, size );
+        EvaluateIrradiance( sh, s_Normals, s_Result );
+        s_Result.ToAoS( pResult + begin );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      次数 2 の係数を回転します.
+//!
+//! @param [in]     value       入力係数です.
+//! @param [in]     rotation    回転行列です. 平行移動とスケールは含まないでください.
+//! @param [out]    result      出力係数です. value と同じオブジェクトでも構いません.
+//! @note       方向 d の値が Vector3::TransformNormal( d, rotation ) に移るように回転します.
+//-------------------------------------------------------------------------------------------------
+inline void RotateSH( const SH4& value, const Matrix& rotation, SH4& result )
+{
+    // 帯域 1 は方向の1次式 b・n なので, b を回転すれば良い.
+    auto bx = -value.c[3];
+    auto by = -value.c[1];
+    auto bz =  value.c[2];
+
+    auto rx = bx * rotation._11 + by * rotation._21 + bz * rotation._31;
+    auto ry = bx * rotation._12 + by * rotation._22 + bz * rotation._32;
+    auto rz = bx * rotation._13 + by * rotation._23 + bz * rotation._33;
+
+    result.c[0] =  value.c[0];
+    result.c[1] = -ry;
+    result.c[2] =  rz;
+    result.c[3] = -rx;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      次数 3 の係数を回転します.
+//!
+//! @param [in]     value       入力係数です.
+//! @param [in]     rotation    回転行列です. 平行移動とスケールは含まないでください.
+//! @param [out]    result      出力係数です. value と同じオブジェクトでも構いません.
+//! @note       方向 d の値が Vector3::TransformNormal( d, rotation ) に移るように回転します.
+//-------------------------------------------------------------------------------------------------
+inline void RotateSH( const SH9& value, const Matrix& rotation, SH9& result )
+{
+    // 帯域 2 は球面上で跡がゼロの2次形式 nQn と等しいので, Q' = M^T Q M として戻す.
+    Vector3 q[3][3];
+    q[0][0] = value.c[8] * SH_K4 - value.c[6] * SH_K3;
+    q[1][1] = value.c[8] * -SH_K4 - value.c[6] * SH_K3;
+    q[2][2] = value.c[6] * ( 2.0f * SH_K3 );
+    q[0][1] = q[1][0] = value.c[4] * ( 0.5f * SH_K2 );
+    q[1][2] = q[2][1] = value.c[5] * ( -0.5f * SH_K2 );
+    q[0][2] = q[2][0] = value.c[7] * ( -0.5f * SH_K2 );
+
+    Vector3 t[3][3];
+    for( u32 k=0; k<3; ++k )
+    {
+        for( u32 j=0; j<3; ++j )
+        { t[k][j] = q[k][0] * rotation.m[0][j] + q[k][1] * rotation.m[1][j] + q[k][2] * rotation.m[2][j]; }
+    }
+
+    Vector3 r[3][3];
+    for( u32 i=0; i<3; ++i )
+    {
+        for( u32 j=i; j<3; ++j )
+        { r[i][j] = t[0][j] * rotation.m[0][i] + t[1][j] * rotation.m[1][i] + t[2][j] * rotation.m[2][i]; }
+    }
+
+    SH4 band1( value );
+    RotateSH( band1, rotation, band1 );
+
+    for( u32 i=0; i<4; ++i )
+    { result.c[i] = band1.c[i]; }
+
+    result.c[4] = r[0][1] * (  2.0f / SH_K2 );
+    result.c[5] = r[1][2] * ( -2.0f / SH_K2 );
+    result.c[6] = r[2][2] * (  0.5f / SH_K3 );
+    result.c[7] = r[0][2] * ( -2.0f / SH_K2 );
+    result.c[8] = ( r[0][0] - r[1][1] ) * ( 0.5f / SH_K4 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      次数 2 の係数をクォータニオンで回転します.
+//-------------------------------------------------------------------------------------------------
+inline void RotateSH( const SH4& value, const Quaternion& rotation, SH4& result )
+{ RotateSH( value, Matrix::CreateFromQuaternion( rotation ), result ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      次数 3 の係数をクォータニオンで回転します.
+//-------------------------------------------------------------------------------------------------
+inline void RotateSH( const SH9& value, const Quaternion& rotation, SH9& result )
+{ RotateSH( value, Matrix::CreateFromQuaternion( rotation ), result ); }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      サンプル集合を次数 3 の係数に射影します.
+//!
+//! @param [in]     pDirections 正規化済みのサンプル方向です.
+//! @param [in]     pWeights    サンプルごとの立体角です. nullptr の場合は 4π / count とします.
+//! @param [in]     pValues     サンプルの値(RGB)です.
+//! @param [in]     count       サンプル数です.
+//! @param [out]    result      係数の格納先です.
+//-------------------------------------------------------------------------------------------------
+inline void ProjectSH( const Vector3* pDirections, const f32* pWeights, const Vector3* pValues, u32 count, SH9& result )
+{
+    result = SH9();
+    if ( count == 0 )
+    { return; }
+
+    auto uniform = 4.0f * F_PI / f32( count );
+    for( u32 i=0; i<count; ++i )
+    {
+        f32 basis[9];
+        EvaluateSHBasis( pDirections[i], basis );
+
+        auto value = pValues[i] * ( ( pWeights != nullptr ) ? pWeights[i] : uniform );
+        for( u32 j=0; j<9; ++j )
+        { result.c[j] += value * basis[j]; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      サンプル集合を次数 2 の係数に射影します.
+//!
+//! @param [in]     pDirections 正規化済みのサンプル方向です.
+//! @param [in]     pWeights    サンプルごとの立体角です. nullptr の場合は 4π / count とします.
+//! @param [in]     pValues     サンプルの値(RGB)です.
+//! @param [in]     count       サンプル数です.
+//! @param [out]    result      係数の格納先です.
+//-------------------------------------------------------------------------------------------------
+inline void ProjectSH( const Vector3* pDirections, const f32* pWeights, const Vector3* pValues, u32 count, SH4& result )
+{
+    result = SH4();
+    if ( count == 0 )
+    { return; }
+
+    auto uniform = 4.0f * F_PI / f32( count );
+    for( u32 i=0; i<count; ++i )
+    {
+        f32 basis[4];
+        EvaluateSHBasis( pDirections[i], basis );
+
+        auto value = pValues[i] * ( ( pWeights != nullptr ) ? pWeights[i] : uniform );
+        for( u32 j=0; j<4; ++j )
+        { result.c[j] += value * basis[j]; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      キューブマップのテクセル方向と立体角を求めます.
+//!
+//! @param [in]     size        1面の幅(テクセル数)です.
+//! @param [out]    directions  6 * size * size 個のテクセル中心の方向です.
+//! @param [out]    weights     6 * size * size 個のテクセルの立体角です. 合計は 4π になります.
+//! @note       面の順序と向きは Direct3D と同じ (+X, -X, +Y, -Y, +Z, -Z) で, 各面は行優先です.
+//-------------------------------------------------------------------------------------------------
+inline void CreateCubemapSampleSet( u32 size, std::vector<Vector3>& directions, std::vector<f32>& weights )
+{
+    directions.resize( size_t( 6 ) * size * size );
+    weights   .resize( size_t( 6 ) * size * size );
+
+    // 面上の (0, 0) - (x, y) の矩形の立体角です.
+    auto area = []( f32 x, f32 y ) { return atan2f( x * y, sqrtf( x * x + y * y + 1.0f ) ); };
+
+    auto texel = 2.0f / f32( size );
+    for( u32 face=0; face<6; ++face )
+    {
+        for( u32 v=0; v<size; ++v )
+        {
+            for( u32 u=0; u<size; ++u )
+            {
+                auto s  = ( f32( u ) + 0.5f ) * texel - 1.0f;
+                auto t  = ( f32( v ) + 0.5f ) * texel - 1.0f;
+                auto x0 = s - 0.5f * texel;
+                auto x1 = s + 0.5f * texel;
+                auto y0 = t - 0.5f * texel;
+                auto y1 = t + 0.5f * texel;
+
+                Vector3 dir;
+                switch( face )
+                {
+                case 0: dir = Vector3(  1.0f,    -t,    -s ); break;
+                case 1: dir = Vector3( -1.0f,    -t,     s ); break;
+                case 2: dir = Vector3(     s,  1.0f,     t ); break;
+                case 3: dir = Vector3(     s, -1.0f,    -t ); break;
+                case 4: dir = Vector3(     s,    -t,  1.0f ); break;
+                default:dir = Vector3(    -s,    -t, -1.0f ); break;
+                }
+
+                auto index = ( size_t( face ) * size + v ) * size + u;
+                directions[index] = Vector3::Normalize( dir );
+                weights   [index] = area( x0, y0 ) - area( x0, y1 ) - area( x1, y0 ) + area( x1, y1 );
+            }
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SHProjector class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      同じサンプル方向を共有する多数のプローブを次数 3 の係数に射影します.
+//!
+//! @note       重みを掛けた基底関数を SoA で保持しておき, プローブごとの射影を
+//!             FloatN 単位の内積 27 回で行います.
+//-------------------------------------------------------------------------------------------------
+class SHProjector
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      サンプル集合を設定します.
+    //!
+    //! @param [in]     pDirections 正規化済みのサンプル方向です.
+    //! @param [in]     pWeights    サンプルごとの立体角です. nullptr の場合は 4π / count とします.
+    //! @param [in]     count       サンプル数です.
+    //---------------------------------------------------------------------------------------------
+    void Init( const Vector3* pDirections, const f32* pWeights, u32 count )
+    {
+        m_Basis.Release();
+        m_Basis.Resize( count );
+
+        auto uniform = ( count > 0 ) ? 4.0f * F_PI / f32( count ) : 0.0f;
+        for( u32 i=0; i<count; ++i )
+        {
+            f32 basis[9];
+            EvaluateSHBasis( pDirections[i], basis );
+
+            auto weight = ( pWeights != nullptr ) ? pWeights[i] : uniform;
+            for( u32 j=0; j<9; ++j )
+            { m_Basis.GetComponent( j )[i] = basis[j] * weight; }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      キューブマップのテクセルをサンプル集合に設定します.
+    //!
+    //! @param [in]     size        1面の幅(テクセル数)です. 並びは CreateCubemapSampleSet() と同じです.
+    //---------------------------------------------------------------------------------------------
+    void InitCubemap( u32 size )
+    {
+        std::vector<Vector3> directions;
+        std::vector<f32>     weights;
+        CreateCubemapSampleSet( size, directions, weights );
+        Init( directions.data(), weights.data(), static_cast<u32>( directions.size() ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      サンプル数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetSampleCount() const
+    { return m_Basis.GetCount(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1つのプローブを射影します.
+    //!
+    //! @param [in]     pValues     GetSampleCount() 個のサンプルの値(RGB)です.
+    //! @param [out]    result      係数の格納先です.
+    //---------------------------------------------------------------------------------------------
+    void Project( const Vector3* pValues, SH9& result ) const
+    {
+        using namespace simd;
+
+        thread_local Vector3SoA s_Values;
+        s_Values.FromAoS( pValues, GetSampleCount() );
+
+        auto count = GetSampleCount();
+        auto n     = ( count + FloatNWidth - 1 ) & ~( FloatNWidth - 1 );
+        for( u32 j=0; j<9; ++j )
+        {
+            auto pBasis = m_Basis.GetComponent( j );
+            auto r = SetN( 0.0f );
+            auto g = SetN( 0.0f );
+            auto b = SetN( 0.0f );
+
+            // 余白の基底はゼロなので容量分まとめて処理する.
+            for( u32 i=0; i<n; i+=FloatNWidth )
+            {
+                auto w = LoadN( pBasis + i );
+                r = MulAddN( w, LoadN( s_Values.X() + i ), r );
+                g = MulAddN( w, LoadN( s_Values.Y() + i ), g );
+                b = MulAddN( w, LoadN( s_Values.Z() + i ), b );
+            }
+
+            result.c[j] = Vector3( Sum( r ), Sum( g ), Sum( b ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      複数のプローブを並列に射影します.
+    //!
+    //! @param [in]     pValues     probeCount * GetSampleCount() 個のサンプルの値(RGB)です.
+    //!                             プローブごとに連続して並べてください.
+    //! @param [in]     probeCount  プローブ数です.
+    //! @param [out]    pResult     probeCount 個の係数の格納先です.
+    //! @param [in]     grain       1タスクあたりのプローブ数です.
+    //---------------------------------------------------------------------------------------------
+    void ProjectParallel( const Vector3* pValues, u32 probeCount, SH9* pResult, u32 grain = 4 ) const
+    {
+        auto sampleCount = GetSampleCount();
+        ParallelFor( probeCount, grain, [&]( u32 begin, u32 end )
+        {
+            for( u32 i=begin; i<end; ++i )
+            { Project( pValues + size_t( i ) * sampleCount, pResult[i] ); }
+        });
+    }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    SoABuffer<9>    m_Basis;    //!< 立体角を掛けた基底関数の値です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全要素の和を求めます.
+    //---------------------------------------------------------------------------------------------
+    static f32 Sum( simd::FloatN value )
+    {
+        ASDX_ALIGN(32) f32 temp[simd::FloatNWidth];
+        simd::StoreN( temp, value );
+
+        f32 result = 0.0f;
+        for( u32 i=0; i<simd::FloatNWidth; ++i )
+        { result += temp[i]; }
+        return result;
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_SPHERICAL_HARMONICS_H__
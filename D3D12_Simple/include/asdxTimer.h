@@ -10,11 +10,49 @@
 //-------------------------------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------------------------------
-#include <Windows.h>
 #include <asdxTypedef.h>
 
+#if ASDX_IS_WIN
+#include <Windows.h>
+#else
+#include <time.h>
+#endif//ASDX_IS_WIN
+
 
 namespace asdx {
+namespace detail {
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      高分解能カウンタの現在値を取得します.
+//-------------------------------------------------------------------------------------------------
+inline s64 QueryTimerCounter()
+{
+#if ASDX_IS_WIN
+    LARGE_INTEGER qwTime = { 0 };
+    QueryPerformanceCounter( &qwTime );
+    return qwTime.QuadPart;
+#else
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return static_cast<s64>( ts.tv_sec ) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      高分解能カウンタの1秒あたりの刻み数を取得します.
+//-------------------------------------------------------------------------------------------------
+inline s64 QueryTimerFrequency()
+{
+#if ASDX_IS_WIN
+    LARGE_INTEGER qwTicksPerSec = { 0 };
+    QueryPerformanceFrequency( &qwTicksPerSec );
+    return qwTicksPerSec.QuadPart;
+#else
+    return 1000000000;
+#endif
+}
+
+} // namespace detail
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Timer class
@@ -46,16 +84,12 @@ private:
     //---------------------------------------------------------------------------------------------
     s64 GetAdjustedCurrentTime( void )
     {
-        LARGE_INTEGER qwTime;
-
         // 停止状態であれば，停止時間を返却.
         if ( m_StopTime != 0 )
-        { qwTime.QuadPart = m_StopTime; }
-        // 非停止状態ならば，現在のカウンタを取得.
-        else
-        { QueryPerformanceCounter( &qwTime ); }
+        { return m_StopTime; }
 
-        return qwTime.QuadPart;
+        // 非停止状態ならば，現在のカウンタを取得.
+        return detail::QueryTimerCounter();
     }
 
 protected:
@@ -82,18 +116,14 @@ public:
     //---------------------------------------------------------------------------------------------
     //! @brief      コンストラクタです.
     //---------------------------------------------------------------------------------------------
-    Timer::Timer()
+    Timer()
     : m_IsStop     ( true )
     , m_StopTime   ( 0 )
     , m_ElapsedTime( 0 )
     , m_BaseTime   ( 0 )
     {
-        LARGE_INTEGER qwTicksPerSec = { 0 };
-
         // 周波数を取得します.
-        QueryPerformanceFrequency( &qwTicksPerSec );
-
-        m_TicksPerSec = qwTicksPerSec.QuadPart;
+        m_TicksPerSec = detail::QueryTimerFrequency();
         m_InvTicksPerSec = 1.0 / static_cast<double>( m_TicksPerSec );
     }
 
@@ -122,17 +152,15 @@ public:
     //---------------------------------------------------------------------------------------------
     void Start()
     {
-        LARGE_INTEGER qwTime = { 0 };
-
         // 現在のカウンタを取得.
-        QueryPerformanceCounter( &qwTime );
+        s64 qwTime = detail::QueryTimerCounter();
 
         // 停止中ならベース時間を加算.
         if ( m_IsStop )
-        { m_BaseTime += qwTime.QuadPart - m_StopTime; }
+        { m_BaseTime += qwTime - m_StopTime; }
 
         m_StopTime    = 0;
-        m_ElapsedTime = qwTime.QuadPart;
+        m_ElapsedTime = qwTime;
         m_IsStop      = false;
     }
 
@@ -143,13 +171,11 @@ public:
     {
         if ( !m_IsStop )
         {
-            LARGE_INTEGER qwTime = { 0 };
-
             // 現在のカウンタを取得.
-            QueryPerformanceCounter( &qwTime );
+            s64 qwTime = detail::QueryTimerCounter();
 
-            m_StopTime    = qwTime.QuadPart;
-            m_ElapsedTime = qwTime.QuadPart;
+            m_StopTime    = qwTime;
+            m_ElapsedTime = qwTime;
             m_IsStop      = true;
         }
     }
@@ -176,13 +202,11 @@ public:
     //---------------------------------------------------------------------------------------------
     f64 GetAbsoluteTime()
     {
-        LARGE_INTEGER qwTime = { 0 };
-
         // 現在のカウンタを取得.
-        QueryPerformanceCounter( &qwTime );
+        s64 qwTime = detail::QueryTimerCounter();
 
         // システム時間を算出して，返却する.
-        return qwTime.QuadPart * m_InvTicksPerSec;
+        return qwTime * m_InvTicksPerSec;
     }
 
     //---------------------------------------------------------------------------------------------
@@ -307,9 +331,7 @@ public:
     : m_StartTime( 0 )
     , m_EndTime  ( 0 )
     {
-        LARGE_INTEGER qwTime = { 0 };
-        QueryPerformanceFrequency( &qwTime );
-        m_TicksPerSec = qwTime.QuadPart;
+        m_TicksPerSec = detail::QueryTimerFrequency();
         m_InvTicksPerSec = 1.0 / static_cast<double>( m_TicksPerSec );
     }
 
@@ -318,9 +340,7 @@ public:
     //---------------------------------------------------------------------------------------------
     void Start()
     {
-        LARGE_INTEGER qwTime = { 0 };
-        QueryPerformanceCounter( &qwTime );
-        m_StartTime = qwTime.QuadPart;
+        m_StartTime = detail::QueryTimerCounter();
     }
 
     //---------------------------------------------------------------------------------------------
@@ -328,9 +348,7 @@ public:
     //---------------------------------------------------------------------------------------------
     void End()
     {
-        LARGE_INTEGER qwTime = { 0 };
-        QueryPerformanceCounter( &qwTime );
-        m_EndTime = qwTime.QuadPart;
+        m_EndTime = detail::QueryTimerCounter();
     }
 
     //---------------------------------------------------------------------------------------------
@@ -0,0 +1,577 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxTransformHierarchy.h
+// Desc : Data Oriented Transform Hierarchy.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+#ifndef __ASDX_TRANSFORM_HIERARCHY_H__
+#define __ASDX_TRANSFORM_HIERARCHY_H__
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <asdxMath.h>
+#include <asdxSoA.h>
+#include <asdxParallel.h>
+#include <asdxAlignedAllocator.h>
+#include <vector>
+#include <atomic>
+#include <cassert>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TransformHierarchy class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      階層構造を持つ姿勢の集合です.
+//!
+//! @note       ノードは深さ順に並べた SoA 配列で保持し, 親は常に子より前に来ます.
+//!             Update() は変更されたノードとその子孫だけを, 深さごとに並列に再計算します.
+//!             ワールド行列は Matrix::CreateScale() * Matrix::CreateFromQuaternion()
+//!             * Matrix::CreateTranslation() * 親のワールド行列 です.
+//-------------------------------------------------------------------------------------------------
+class TransformHierarchy : private NonCopyable
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    static const u32 InvalidId = 0xffffffff;    //!< 無効なノード番号です.
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    TransformHierarchy()
+    : m_NeedsSort( false )
+    { m_LevelOffsets.push_back( 0 ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      容量を確保します.
+    //!
+    //! @param [in]     count       ノード数です.
+    //---------------------------------------------------------------------------------------------
+    void Reserve( u32 count )
+    {
+        m_Translation.Reserve( count );
+        m_Rotation   .Reserve( count );
+        m_Scale      .Reserve( count );
+        m_Parents    .reserve( count );
+        m_Depths     .reserve( count );
+        m_Flags      .reserve( count );
+        m_World      .reserve( count );
+        m_IndexToId  .reserve( count );
+        m_IdToIndex  .reserve( count );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全てのノードを削除します.
+    //---------------------------------------------------------------------------------------------
+    void Clear()
+    {
+        m_Translation.Resize( 0 );
+        m_Rotation   .Resize( 0 );
+        m_Scale      .Resize( 0 );
+        m_Parents     .clear();
+        m_Depths      .clear();
+        m_Flags       .clear();
+        m_World       .clear();
+        m_IndexToId   .clear();
+        m_IdToIndex   .clear();
+        m_FreeIds     .clear();
+        m_LevelOffsets.clear();
+        m_LevelDirty  .clear();
+        m_LevelOffsets.push_back( 0 );
+        m_NeedsSort = false;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードを追加します.
+    //!
+    //! @param [in]     parentId        親のノード番号です. ルートの場合は InvalidId を指定します.
+    //! @param [in]     translation     ローカルの平行移動です.
+    //! @param [in]     rotation        ローカルの回転(正規化済み)です.
+    //! @param [in]     scale           ローカルのスケールです.
+    //! @return     追加したノードの番号を返却します. 削除されるまで変わりません.
+    //! @note       親より浅い位置に追加した場合は, 次の Update() で並べ替えます.
+    //---------------------------------------------------------------------------------------------
+    u32 Add
+    (
+        u32                 parentId,
+        const Vector3&      translation,
+        const Quaternion&   rotation,
+        const Vector3&      scale
+    )
+    {
+        auto parent = InvalidId;
+        u32  depth  = 0;
+        if ( parentId != InvalidId )
+        {
+            assert( IsValid( parentId ) );
+            parent = m_IdToIndex[parentId];
+            depth  = m_Depths[parent] + 1;
+        }
+
+        u32 id;
+        if ( !m_FreeIds.empty() )
+        {
+            id = m_FreeIds.back();
+            m_FreeIds.pop_back();
+        }
+        else
+        {
+            id = static_cast<u32>( m_IdToIndex.size() );
+            m_IdToIndex.push_back( 0 );
+        }
+
+        auto index = GetCount();
+        Grow( index + 1 );
+
+        m_Translation.Set( index, translation );
+        m_Rotation   .Set( index, Vector4( rotation.x, rotation.y, rotation.z, rotation.w ) );
+        m_Scale      .Set( index, scale );
+        m_Parents  .push_back( parent );
+        m_Depths   .push_back( depth );
+        m_Flags    .push_back( FLAG_DIRTY );
+        m_World    .push_back( Matrix::Identity() );
+        m_IndexToId.push_back( id );
+        m_IdToIndex[id] = index;
+
+        // 末尾の深さ以上であれば並びは崩れない.
+        auto levelCount = GetLevelCount();
+        if ( m_NeedsSort || depth + 1 < levelCount )
+        { m_NeedsSort = true; }
+        else if ( depth + 1 == levelCount )
+        {
+            m_LevelOffsets.back()++;
+            m_LevelDirty[depth] = 1;
+        }
+        else
+        {
+            m_LevelOffsets.push_back( index + 1 );
+            m_LevelDirty  .push_back( 1 );
+        }
+
+        return id;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードを子孫ごと削除します.
+    //!
+    //! @param [in]     id          削除するノードの番号です.
+    //! @note       子孫のノード番号は次の Update() まで有効です.
+    //---------------------------------------------------------------------------------------------
+    void Remove( u32 id )
+    {
+        assert( IsValid( id ) );
+        m_Flags[m_IdToIndex[id]] |= FLAG_REMOVED;
+        m_NeedsSort = true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノード番号が有効かどうかを判定します.
+    //---------------------------------------------------------------------------------------------
+    bool IsValid( u32 id ) const
+    {
+        return id < m_IdToIndex.size()
+            && m_IdToIndex[id] != InvalidId
+            && ( m_Flags[m_IdToIndex[id]] & FLAG_REMOVED ) == 0;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ローカルの姿勢を設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetLocal( u32 id, const Vector3& translation, const Quaternion& rotation, const Vector3& scale )
+    {
+        auto index = MarkDirty( id );
+        m_Translation.Set( index, translation );
+        m_Rotation   .Set( index, Vector4( rotation.x, rotation.y, rotation.z, rotation.w ) );
+        m_Scale      .Set( index, scale );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ローカルの平行移動を設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetTranslation( u32 id, const Vector3& value )
+    { m_Translation.Set( MarkDirty( id ), value ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ローカルの回転を設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetRotation( u32 id, const Quaternion& value )
+    { m_Rotation.Set( MarkDirty( id ), Vector4( value.x, value.y, value.z, value.w ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ローカルのスケールを設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetScale( u32 id, const Vector3& value )
+    { m_Scale.Set( MarkDirty( id ), value ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ローカルの平行移動を取得します.
+    //---------------------------------------------------------------------------------------------
+    Vector3 GetTranslation( u32 id ) const
+    { return m_Translation.Get( GetIndex( id ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ローカルの回転を取得します.
+    //---------------------------------------------------------------------------------------------
+    Quaternion GetRotation( u32 id ) const
+    {
+        auto v = m_Rotation.Get( GetIndex( id ) );
+        return Quaternion( v.x, v.y, v.z, v.w );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ローカルのスケールを取得します.
+    //---------------------------------------------------------------------------------------------
+    Vector3 GetScale( u32 id ) const
+    { return m_Scale.Get( GetIndex( id ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      親のノード番号を取得します.
+    //!
+    //! @return     親のノード番号を返却します. ルートの場合は InvalidId を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetParent( u32 id ) const
+    {
+        auto parent = m_Parents[GetIndex( id )];
+        return ( parent != InvalidId ) ? m_IndexToId[parent] : InvalidId;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ワールド行列を取得します.
+    //!
+    //! @note       最後の Update() の結果を返却します.
+    //---------------------------------------------------------------------------------------------
+    const Matrix& GetWorld( u32 id ) const
+    { return m_World[GetIndex( id )]; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全てのノードを変更済みにします.
+    //---------------------------------------------------------------------------------------------
+    void Invalidate()
+    {
+        for( size_t i=0; i<m_Flags.size(); ++i )
+        { m_Flags[i] |= FLAG_DIRTY; }
+
+        for( size_t i=0; i<m_LevelDirty.size(); ++i )
+        { m_LevelDirty[i] = 1; }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ワールド行列を更新します.
+    //!
+    //! @param [in]     grain       1タスクあたりのノード数です.
+    //! @note       変更されたノードとその子孫だけを再計算します. 変更を含まない深さは走査しません.
+    //---------------------------------------------------------------------------------------------
+    void Update( u32 grain = 4096 )
+    {
+        if ( m_NeedsSort )
+        { Sort(); }
+
+        bool parentUpdated = false;
+        for( u32 level=0; level<GetLevelCount(); ++level )
+        {
+            if ( !m_LevelDirty[level] && !parentUpdated )
+            { continue; }
+
+            auto begin = m_LevelOffsets[level];
+            auto count = m_LevelOffsets[level + 1] - begin;
+
+            // 親の更新フラグは直前の深さを処理した場合のみ今回の結果を表す.
+            auto checkParent = parentUpdated;
+            std::atomic<u32> updated( 0 );
+            ParallelFor( count, grain, [&, begin, checkParent]( u32 b, u32 e )
+            {
+                if ( UpdateRange( begin + b, begin + e, checkParent ) )
+                { updated.store( 1, std::memory_order_relaxed ); }
+            });
+
+            parentUpdated = ( updated.load( std::memory_order_relaxed ) != 0 );
+            m_LevelDirty[level] = 0;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノード数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetCount() const
+    { return static_cast<u32>( m_Parents.size() ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      深さの段数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetLevelCount() const
+    { return static_cast<u32>( m_LevelOffsets.size() ) - 1; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノード番号から配列上の位置を取得します.
+    //!
+    //! @note       並べ替えで変わるため, Update() の後に取得し直してください.
+    //---------------------------------------------------------------------------------------------
+    u32 GetIndex( u32 id ) const
+    {
+        assert( id < m_IdToIndex.size() && m_IdToIndex[id] != InvalidId );
+        return m_IdToIndex[id];
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      配列上の位置からノード番号を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetId( u32 index ) const
+    { return m_IndexToId[index]; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      深さ順に並んだワールド行列の配列を取得します.
+    //---------------------------------------------------------------------------------------------
+    const Matrix* GetWorldMatrices() const
+    { return m_World.empty() ? nullptr : &m_World[0]; }
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    enum FLAG
+    {
+        FLAG_DIRTY      = 0x1,      //!< ローカルの姿勢が変更されました.
+        FLAG_UPDATED    = 0x2,      //!< 直前の Update() でワールド行列を再計算しました.
+        FLAG_REMOVED    = 0x4,      //!< 削除されました.
+    };
+
+    Vector3SoA              m_Translation;      //!< ローカルの平行移動です.
+    Vector4SoA              m_Rotation;         //!< ローカルの回転です.
+    Vector3SoA              m_Scale;            //!< ローカルのスケールです.
+    std::vector<u32>        m_Parents;          //!< 親の位置です. ルートは InvalidId です.
+    std::vector<u32>        m_Depths;           //!< 深さです.
+    std::vector<u8>         m_Flags;            //!< FLAG の組み合わせです.
+    AlignedVector<Matrix>   m_World;            //!< ワールド行列です.
+    std::vector<u32>        m_IndexToId;        //!< 位置からノード番号への対応です.
+    std::vector<u32>        m_IdToIndex;        //!< ノード番号から位置への対応です.
+    std::vector<u32>        m_FreeIds;          //!< 再利用できるノード番号です.
+    std::vector<u32>        m_LevelOffsets;     //!< 深さごとの開始位置です. 末尾はノード数です.
+    std::vector<u8>         m_LevelDirty;       //!< 深さごとの変更フラグです.
+    bool                    m_NeedsSort;        //!< 並べ替えが必要かどうか.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      SoA 配列の要素数を増やします.
+    //---------------------------------------------------------------------------------------------
+    void Grow( u32 count )
+    {
+        if ( count > m_Translation.GetCapacity() )
+        {
+            auto capacity = Max( count, m_Translation.GetCapacity() * 2 );
+            m_Translation.Reserve( capacity );
+            m_Rotation   .Reserve( capacity );
+            m_Scale      .Reserve( capacity );
+        }
+
+        m_Translation.Resize( count );
+        m_Rotation   .Resize( count );
+        m_Scale      .Resize( count );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ノードを変更済みにします.
+    //!
+    //! @return     ノードの位置を返却します.
+    //---------------------------------------------------------------------------------------------
+    u32 MarkDirty( u32 id )
+    {
+        auto index = GetIndex( id );
+        m_Flags[index] |= FLAG_DIRTY;
+
+        // 並べ替え時に深さごとのフラグを作り直す.
+        if ( !m_NeedsSort )
+        { m_LevelDirty[m_Depths[index]] = 1; }
+
+        return index;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      同じ深さに並んだ [begin, end) のワールド行列を更新します.
+    //!
+    //! @return     1つでも再計算した場合は true を返却します.
+    //---------------------------------------------------------------------------------------------
+    bool UpdateRange( u32 begin, u32 end, bool checkParent )
+    {
+        auto pTX = m_Translation.X();
+        auto pTY = m_Translation.Y();
+        auto pTZ = m_Translation.Z();
+        auto pRX = m_Rotation.X();
+        auto pRY = m_Rotation.Y();
+        auto pRZ = m_Rotation.Z();
+        auto pRW = m_Rotation.W();
+        auto pSX = m_Scale.X();
+        auto pSY = m_Scale.Y();
+        auto pSZ = m_Scale.Z();
+
+        bool result = false;
+        for( u32 i=begin; i<end; ++i )
+        {
+            auto parent = m_Parents[i];
+            auto dirty  = ( m_Flags[i] & FLAG_DIRTY ) != 0;
+            if ( checkParent && parent != InvalidId )
+            { dirty |= ( m_Flags[parent] & FLAG_UPDATED ) != 0; }
+
+            m_Flags[i] = dirty ? u8( FLAG_UPDATED ) : u8( 0 );
+            if ( !dirty )
+            { continue; }
+
+            auto x = pRX[i];
+            auto y = pRY[i];
+            auto z = pRZ[i];
+            auto w = pRW[i];
+            auto xx = x * x;
+            auto yy = y * y;
+            auto zz = z * z;
+            auto xy = x * y;
+            auto yw = y * w;
+            auto yz = y * z;
+            auto xw = x * w;
+            auto zx = z * x;
+            auto zw = z * w;
+
+            auto sx = pSX[i];
+            auto sy = pSY[i];
+            auto sz = pSZ[i];
+
+            Matrix local(
+                sx * ( 1.0f - 2.0f * ( yy + zz ) ), sx * 2.0f * ( xy + zw ),            sx * 2.0f * ( zx - yw ),            0.0f,
+                sy * 2.0f * ( xy - zw ),            sy * ( 1.0f - 2.0f * ( zz + xx ) ), sy * 2.0f * ( yz + xw ),            0.0f,
+                sz * 2.0f * ( zx + yw ),            sz * 2.0f * ( yz - xw ),            sz * ( 1.0f - 2.0f * ( yy + xx ) ), 0.0f,
+                pTX[i],                             pTY[i],                             pTZ[i],                             1.0f );
+
+            if ( parent != InvalidId )
+            { Matrix::Multiply( local, m_World[parent], m_World[i] ); }
+            else
+            { m_World[i] = local; }
+
+            result = true;
+        }
+
+        return result;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      削除されたノードを取り除き, 深さ順に並べ替えます.
+    //!
+    //! @note       親は常に子より前にあるので, 先頭から1回走査すれば削除と深さが確定します.
+    //---------------------------------------------------------------------------------------------
+    void Sort()
+    {
+        auto count = GetCount();
+
+        // 削除を子孫に伝播して, 深さごとの数を数える.
+        std::vector<u32> levelCounts;
+        for( u32 i=0; i<count; ++i )
+        {
+            auto parent = m_Parents[i];
+            if ( parent != InvalidId && ( m_Flags[parent] & FLAG_REMOVED ) != 0 )
+            { m_Flags[i] |= FLAG_REMOVED; }
+
+            if ( m_Flags[i] & FLAG_REMOVED )
+            { continue; }
+
+            auto depth = m_Depths[i];
+            if ( depth >= levelCounts.size() )
+            { levelCounts.resize( depth + 1, 0 ); }
+            levelCounts[depth]++;
+        }
+
+        auto levelCount = static_cast<u32>( levelCounts.size() );
+        m_LevelOffsets.assign( levelCount + 1, 0 );
+        m_LevelDirty  .assign( levelCount, 0 );
+        for( u32 l=0; l<levelCount; ++l )
+        { m_LevelOffsets[l + 1] = m_LevelOffsets[l] + levelCounts[l]; }
+
+        // 深さ内では元の順序を保つ.
+        std::vector<u32> remap( count );
+        std::vector<u32> cursor( m_LevelOffsets.begin(), m_LevelOffsets.end() - 1 );
+        for( u32 i=0; i<count; ++i )
+        {
+            if ( m_Flags[i] & FLAG_REMOVED )
+            {
+                remap[i] = InvalidId;
+                m_IdToIndex[m_IndexToId[i]] = InvalidId;
+                m_FreeIds.push_back( m_IndexToId[i] );
+                continue;
+            }
+            remap[i] = cursor[m_Depths[i]]++;
+        }
+
+        auto newCount = m_LevelOffsets.back();
+
+        Vector3SoA            translation;
+        Vector4SoA            rotation;
+        Vector3SoA            scale;
+        std::vector<u32>      parents  ( newCount );
+        std::vector<u32>      depths   ( newCount );
+        std::vector<u8>       flags    ( newCount );
+        AlignedVector<Matrix> world    ( newCount );
+        std::vector<u32>      indexToId( newCount );
+
+        translation.Reserve( m_Translation.GetCapacity() );
+        rotation   .Reserve( m_Rotation   .GetCapacity() );
+        scale      .Reserve( m_Scale      .GetCapacity() );
+        translation.Resize( newCount );
+        rotation   .Resize( newCount );
+        scale      .Resize( newCount );
+
+        for( u32 i=0; i<count; ++i )
+        {
+            auto dst = remap[i];
+            if ( dst == InvalidId )
+            { continue; }
+
+            for( u32 c=0; c<3; ++c )
+            {
+                translation.GetComponent( c )[dst] = m_Translation.GetComponent( c )[i];
+                scale      .GetComponent( c )[dst] = m_Scale      .GetComponent( c )[i];
+            }
+            for( u32 c=0; c<4; ++c )
+            { rotation.GetComponent( c )[dst] = m_Rotation.GetComponent( c )[i]; }
+
+            auto parent = m_Parents[i];
+            parents  [dst] = ( parent != InvalidId ) ? remap[parent] : InvalidId;
+            depths   [dst] = m_Depths[i];
+            flags    [dst] = m_Flags[i] & FLAG_DIRTY;
+            world    [dst] = m_World[i];
+            indexToId[dst] = m_IndexToId[i];
+
+            m_IdToIndex[m_IndexToId[i]] = dst;
+            if ( flags[dst] )
+            { m_LevelDirty[depths[dst]] = 1; }
+        }
+
+        m_Translation = std::move( translation );
+        m_Rotation    = std::move( rotation );
+        m_Scale       = std::move( scale );
+        m_Parents  .swap( parents );
+        m_Depths   .swap( depths );
+        m_Flags    .swap( flags );
+        m_World    .swap( world );
+        m_IndexToId.swap( indexToId );
+
+        m_NeedsSort = false;
+    }
+};
+
+} // namespace asdx
+
+#endif//__ASDX_TRANSFORM_HIERARCHY_H__
@@ -50,10 +50,25 @@ App*    g_pApp = nullptr;
 App::App()
 : m_hInst           ( nullptr )
 , m_hWnd            ( nullptr )
-, m_BufferCount     ( 2 )
+, m_BufferCount     ( FrameCount )
 , m_SwapChainFormat ( DXGI_FORMAT_R8G8B8A8_UNORM )  // SRGBƃG[̂ŎbI...
+, m_DepthStencilFormat  ( DXGI_FORMAT_D32_FLOAT )
 , m_EventHandle     ( nullptr )
-{ /* DO_NOTHING */ }
+, m_DepthTargetResidency( asdx::ResidencyManager::InvalidHandle )
+, m_FenceValue      ( 0 )
+, m_FrameIndex      ( 0 )
+, m_BackBufferIndex ( 0 )
+, m_FrameTimeSum    ( 0.0 )
+, m_FrameStatsCount ( 0 )
+{
+    for( u32 i=0; i<FrameCount; ++i )
+    {
+        m_ColorTargetHandle   [i].ptr = 0;
+        m_ColorTargetResidency[i] = asdx::ResidencyManager::InvalidHandle;
+        m_FrameFenceValue     [i] = 0;
+    }
+    memset( m_FrameAllocSum, 0, sizeof(m_FrameAllocSum) );
+}
 
 //-------------------------------------------------------------------------------------------------
 //      fXgN^ł.
@@ -252,17 +267,27 @@ bool App::InitD3D()
         }
     }
 
-    // R}hAP[^𐶐.
-    hr = m_Device->CreateCommandAllocator(
-        D3D12_COMMAND_LIST_TYPE_DIRECT, 
-        IID_ID3D12CommandAllocator,
-        (void**)m_CmdAllocator.GetAddress() );
-    if ( FAILED( hr ) )
+    // WfV[}l[W̏.
+    if ( !m_Residency.Init( m_Device.GetPtr(), m_Adapter.GetPtr(), m_BufferCount ) )
     {
-        ELOG( "Error : ID3D12Device::CreateCommandAllocator() Failed." );
+        ELOG( "Error : ResidencyManager::Init() Failed." );
         return false;
     }
 
+    // R}hAP[^𐶐. GPUs̃t[̂̂gȂ悤Ƀt[ƂɎ.
+    for( u32 i=0; i<FrameCount; ++i )
+    {
+        hr = m_Device->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_DIRECT, 
+            IID_ID3D12CommandAllocator,
+            (void**)m_CmdAllocator[i].GetAddress() );
+        if ( FAILED( hr ) )
+        {
+            ELOG( "Error : ID3D12Device::CreateCommandAllocator() Failed." );
+            return false;
+        }
+    }
+
     // R}hL[𐶐.
     {
        D3D12_COMMAND_QUEUE_DESC desc;
@@ -298,12 +323,21 @@ bool App::InitD3D()
         desc.Flags                              = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
 
         // A_v^[Pʂ̏Ƀ}b`̂ m_Device ł͂Ȃ m_CmdQueue@Ȃ̂ŁCm_CmdQueue@Ƃēn.
-        hr = m_Factory->CreateSwapChain( m_CmdQueue.GetPtr(), &desc, m_SwapChain.GetAddress() );
+        asdx::RefPtr<IDXGISwapChain> swapChain;
+        hr = m_Factory->CreateSwapChain( m_CmdQueue.GetPtr(), &desc, swapChain.GetAddress() );
         if ( FAILED( hr ) )
         {
             ELOG( "Error : IDXGIFactory::CreateSwapChain() Failed." );
             return false;
         }
+
+        // `̃obNobt@ԍ擾邽߂ IDXGISwapChain3 g.
+        hr = swapChain->QueryInterface( IID_PPV_ARGS( m_SwapChain.GetAddress() ) );
+        if ( FAILED( hr ) )
+        {
+            ELOG( "Error : IDXGISwapChain::QueryInterface() Failed." );
+            return false;
+        }
     }
 
     // fXNv^q[v̐.
@@ -311,7 +345,7 @@ bool App::InitD3D()
         D3D12_DESCRIPTOR_HEAP_DESC desc;
         ZeroMemory( &desc, sizeof(desc) );
 
-        desc.NumDescriptors = 1;
+        desc.NumDescriptors = FrameCount;
         desc.Type           = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
         desc.Flags          = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
 
@@ -328,7 +362,7 @@ bool App::InitD3D()
         hr = m_Device->CreateCommandList(
             1,
             D3D12_COMMAND_LIST_TYPE_DIRECT,
-            m_CmdAllocator.GetPtr(),
+            m_CmdAllocator[m_FrameIndex].GetPtr(),
             nullptr,
             IID_ID3D12GraphicsCommandList,
             (void**)m_CmdList.GetAddress() );
@@ -340,21 +374,40 @@ bool App::InitD3D()
     }
 
     // obNobt@烌_[^[Qbg𐶐.
+    if ( !CreateColorTargets() )
+    {
+        ELOG( "Error : App::CreateColorTargets() Failed." );
+        return false;
+    }
+
+    // [xXeVobt@̐.
     {
-        hr = m_SwapChain->GetBuffer( 0, IID_ID3D12Resource, (void**)m_ColorTarget.GetAddress() );
+        D3D12_DESCRIPTOR_HEAP_DESC desc;
+        ZeroMemory( &desc, sizeof(desc) );
+
+        desc.NumDescriptors = 1;
+        desc.Type           = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+        desc.Flags          = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+
+        hr = m_Device->CreateDescriptorHeap( &desc, IID_ID3D12DescriptorHeap, (void**)m_DepthDescriptorHeap.GetAddress() );
         if ( FAILED( hr ) )
         {
-            ELOG( "Error : IDXGISwapChain::GetBuffer() Failed." );
+            ELOG( "Error : ID3D12Device::CreateDescriptorHeap() Failed." );
             return false;
         }
 
-        m_ColorTargetHandle = m_DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-        m_Device->CreateRenderTargetView( m_ColorTarget.GetPtr(), nullptr, m_ColorTargetHandle );
+        m_DepthTargetHandle = m_DepthDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+        if ( !CreateDepthTarget( w, h ) )
+        {
+            ELOG( "Error : App::CreateDepthTarget() Failed." );
+            return false;
+        }
     }
 
     // tFX̐.
     {
         m_EventHandle = CreateEvent( 0, FALSE, FALSE, 0 );
+        m_FenceValue  = 0;
 
         hr = m_Device->CreateFence( 0, D3D12_FENCE_FLAG_NONE, IID_ID3D12Fence, (void**)m_Fence.GetAddress() );
         if ( FAILED( hr ) )
@@ -362,6 +415,9 @@ bool App::InitD3D()
             ELOG( "Error : ID3D12Device::CreateFence() Failed." );
             return false;
         }
+
+        // L[̏.
+        m_ReleaseQueue.Init( m_BufferCount );
     }
 
     // r[|[g̐ݒ.
@@ -416,6 +472,12 @@ void App::TermWnd()
 //-------------------------------------------------------------------------------------------------
 void App::TermD3D()
 {
+    // GPȔ̊҂Ă\񂳂ꂽIuWFNg.
+    WaitForGpu();
+    m_ReleaseQueue.Flush();
+
+    m_Residency.Term();
+
     CloseHandle( m_EventHandle );
 
     m_EventHandle = nullptr;
@@ -439,12 +501,55 @@ void App::MainLoop()
         }
         else
         {
+            m_FrameWatch.Start();
+
             OnFrameMove();
             OnFrameRender();
+
+            m_FrameWatch.End();
+            UpdateFrameStats();
         }
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+//      t[Ԃƃmۉ񐔂Wv܂.
+//-------------------------------------------------------------------------------------------------
+void App::UpdateFrameStats()
+{
+    const u32 StatsInterval = 60;
+
+    asdx::MemoryFrameReport report;
+    asdx::MemoryTracker::Instance().EndFrame( &report );
+
+    m_FrameTimeSum += m_FrameWatch.GetElapsedTimeMsec();
+    for( u32 i=0; i<asdx::MEMORY_TAG_COUNT; ++i )
+    { m_FrameAllocSum[i] += report.Tags[i].FrameAllocCount; }
+    m_FrameStatsCount++;
+
+    if ( m_FrameStatsCount < StatsInterval )
+    { return; }
+
+    // t[Ƃɕϒlo. zbgpXł͊mۉ񐔂 0 ɂȂ̂ڕW.
+    u64 total = 0;
+    for( u32 i=0; i<asdx::MEMORY_TAG_COUNT; ++i )
+    { total += m_FrameAllocSum[i]; }
+
+    DLOG( "Info : Frame %.3f ms, Alloc %.2f/frame (math %llu, render %llu, assets %llu, jobs %llu, other %llu), Live %lld KB",
+        m_FrameTimeSum / m_FrameStatsCount,
+        double( total ) / m_FrameStatsCount,
+        m_FrameAllocSum[asdx::MEMORY_TAG_MATH],
+        m_FrameAllocSum[asdx::MEMORY_TAG_RENDER],
+        m_FrameAllocSum[asdx::MEMORY_TAG_ASSETS],
+        m_FrameAllocSum[asdx::MEMORY_TAG_JOBS],
+        m_FrameAllocSum[asdx::MEMORY_TAG_OTHER],
+        report.LiveBytes / 1024 );
+
+    m_FrameTimeSum    = 0.0;
+    m_FrameStatsCount = 0;
+    memset( m_FrameAllocSum, 0, sizeof(m_FrameAllocSum) );
+}
+
 //-------------------------------------------------------------------------------------------------
 //      AvP[Vs܂.
 //-------------------------------------------------------------------------------------------------
@@ -491,12 +596,16 @@ void App::OnFrameRender()
 {
     // r[|[gݒ.
     m_CmdList->RSSetViewports( 1, &m_Viewport );
-    SetResourceBarrier( m_CmdList.GetPtr(), m_ColorTarget.GetPtr(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    auto pColorTarget = m_ColorTarget[m_BackBufferIndex].GetPtr();
+    auto colorHandle  = m_ColorTargetHandle[m_BackBufferIndex];
+    SetResourceBarrier( m_CmdList.GetPtr(), pColorTarget, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    m_CmdList->OMSetRenderTargets( 1, &colorHandle, FALSE, &m_DepthTargetHandle );
 
-    // J[obt@NA.
+    // J[obt@Ɛ[xobt@NA.
     float clearColor[] = { 0.39f, 0.58f, 0.92f, 1.0f };
-    m_CmdList->ClearRenderTargetView( m_ColorTargetHandle, clearColor, 0, nullptr );
-    SetResourceBarrier( m_CmdList.GetPtr(), m_ColorTarget.GetPtr(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+    m_CmdList->ClearRenderTargetView( colorHandle, clearColor, 0, nullptr );
+    m_CmdList->ClearDepthStencilView( m_DepthTargetHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr );
+    SetResourceBarrier( m_CmdList.GetPtr(), pColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
 
     // ʂɕ\.
     Present( 0 );
@@ -507,26 +616,137 @@ void App::OnFrameRender()
 //-------------------------------------------------------------------------------------------------
 void App::OnResize( u32 width, u32 height )
 {
+    // ŏꂽꍇ͑傫 0 ̃obt@Ȃ̂, ɖ߂܂ł̂܂܂ɂ.
+    if ( width == 0 || height == 0 || m_SwapChain.GetPtr() == nullptr )
+    { return; }
+
     m_Viewport.Width  = FLOAT( width );
     m_Viewport.Height = FLOAT( height );
 
+    // Xbv`FC̃obt@ ResizeBuffers() ̑OɑSĂ̎QƂKv̂ŁC
+    // GPȔ̊҂Ă瑦ɔj.
+    WaitForGpu();
+    m_ReleaseQueue.Flush();
+
     // _[^[Qbgj.
-    m_ColorTarget.Reset();
-    m_ColorTargetHandle.ptr = 0;
+    ReleaseColorTargets();
+
+    // [xobt@̓Xbv`FCƊ֌WȂ̂, ̃\[XƓL[ɔC.
+    m_Residency.Unregister( m_DepthTargetResidency );
+    m_DepthTargetResidency = asdx::ResidencyManager::InvalidHandle;
+    DeferRelease( m_DepthTarget.Detach() );
 
     // obNobt@TCY.
     HRESULT hr = m_SwapChain->ResizeBuffers( m_BufferCount, 0, 0, m_SwapChainFormat, 0 );
     if ( FAILED( hr ) )
     { ELOG( "Error : IDXGISwapChain::ResizeBuffer() Failed." ); }
 
-    // obNobt@擾.
-    hr = m_SwapChain->GetBuffer( 0, IID_ID3D12Resource, (void**)m_ColorTarget.GetAddress() );
+    // _[^[Qbg𐶐.
+    if ( !CreateColorTargets() )
+    { ELOG( "Error : App::CreateColorTargets() Failed." ); }
+
+    // [xobt@蒼.
+    if ( !CreateDepthTarget( width, height ) )
+    { ELOG( "Error : App::CreateDepthTarget() Failed." ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      obNobt@烌_[^[Qbg𐶐܂.
+//-------------------------------------------------------------------------------------------------
+bool App::CreateColorTargets()
+{
+    auto handle    = m_DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+    auto increment = m_Device->GetDescriptorHandleIncrementSize( D3D12_DESCRIPTOR_HEAP_TYPE_RTV );
+
+    for( u32 i=0; i<FrameCount; ++i )
+    {
+        HRESULT hr = m_SwapChain->GetBuffer( i, IID_ID3D12Resource, (void**)m_ColorTarget[i].GetAddress() );
+        if ( FAILED( hr ) )
+        {
+            ELOG( "Error : IDXGISwapChain::GetBuffer() Failed." );
+            return false;
+        }
+
+        m_ColorTargetHandle[i] = handle;
+        m_Device->CreateRenderTargetView( m_ColorTarget[i].GetPtr(), nullptr, m_ColorTargetHandle[i] );
+        handle.ptr += increment;
+
+        // \Z̊ǗΏۂɂ.
+        m_ColorTargetResidency[i] = m_Residency.Register( m_ColorTarget[i].GetPtr() );
+    }
+
+    m_BackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      _[^[Qbgj܂.
+//-------------------------------------------------------------------------------------------------
+void App::ReleaseColorTargets()
+{
+    // WfV[}l[WQƂĂ̂œo^.
+    for( u32 i=0; i<FrameCount; ++i )
+    {
+        m_Residency.Unregister( m_ColorTargetResidency[i] );
+        m_ColorTargetResidency[i] = asdx::ResidencyManager::InvalidHandle;
+        m_ColorTarget[i].Reset();
+        m_ColorTargetHandle[i].ptr = 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      [xobt@𐶐܂.
+//-------------------------------------------------------------------------------------------------
+bool App::CreateDepthTarget( u32 width, u32 height )
+{
+    D3D12_HEAP_PROPERTIES prop = {};
+    prop.Type                   = D3D12_HEAP_TYPE_DEFAULT;
+    prop.CPUPageProperty        = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    prop.MemoryPoolPreference   = D3D12_MEMORY_POOL_UNKNOWN;
+    prop.CreationNodeMask       = 1;
+    prop.VisibleNodeMask        = 1;
+
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension          = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.Alignment          = 0;
+    desc.Width              = width;
+    desc.Height             = height;
+    desc.DepthOrArraySize   = 1;
+    desc.MipLevels          = 1;
+    desc.Format             = m_DepthStencilFormat;
+    desc.SampleDesc.Count   = 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Layout             = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    desc.Flags              = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+
+    D3D12_CLEAR_VALUE clearValue = {};
+    clearValue.Format               = m_DepthStencilFormat;
+    clearValue.DepthStencil.Depth   = 1.0f;
+    clearValue.DepthStencil.Stencil = 0;
+
+    HRESULT hr = m_Device->CreateCommittedResource(
+        &prop,
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        D3D12_RESOURCE_STATE_DEPTH_WRITE,
+        &clearValue,
+        IID_ID3D12Resource,
+        (void**)m_DepthTarget.GetAddress() );
     if ( FAILED( hr ) )
-    { ELOG( "Error : IDXGISwapChain::GetBuffer() Failed." ); }
+    {
+        ELOG( "Error : ID3D12Device::CreateCommittedResource() Failed." );
+        return false;
+    }
 
-    // _[^[Qbg𐶐.
-    m_ColorTargetHandle = m_DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    m_Device->CreateRenderTargetView( m_ColorTarget.GetPtr(), nullptr, m_ColorTargetHandle );
+    D3D12_DEPTH_STENCIL_VIEW_DESC viewDesc = {};
+    viewDesc.Format        = m_DepthStencilFormat;
+    viewDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+    viewDesc.Flags         = D3D12_DSV_FLAG_NONE;
+    m_Device->CreateDepthStencilView( m_DepthTarget.GetPtr(), &viewDesc, m_DepthTargetHandle );
+
+    // \Z̊ǗΏۂɂ.
+    m_DepthTargetResidency = m_Residency.Register( m_DepthTarget.GetPtr() );
+    return true;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -559,20 +779,75 @@ void App::Present( u32 syncInterval )
 
     // R}hXgւ̋L^ICR}hs.
     m_CmdList->Close();
-    m_CmdQueue->ExecuteCommandLists( 1, &cmdList );
 
-    // R}h̎s̏Iҋ@
-    m_Fence->Signal( 0 );
-    m_Fence->SetEventOnCompletion( 1, m_EventHandle );
-    m_CmdQueue->Signal( m_Fence.GetPtr(), 1 );
-    WaitForSingleObject( m_EventHandle, INFINITE );
+    // ̃t[Ŏg`^[Qbgʒm, \Zɍ킹đޔE풓Ăs.
+    m_Residency.MarkUsed( m_ColorTargetResidency[m_BackBufferIndex] );
+    m_Residency.MarkUsed( m_DepthTargetResidency );
+    m_Residency.Update();
+    m_CmdQueue->ExecuteCommandLists( 1, &cmdList );
 
     // ʂɕ\.
     m_SwapChain->Present( syncInterval, 0 );
+    m_BackBufferIndex = m_SwapChain->GetCurrentBackBufferIndex();
+
+    // ̃t[̊tFXlL^.
+    m_FrameFenceValue[m_FrameIndex] = SignalFence();
+
+    // ɎgR}hAP[^L^t[̊҂.
+    // Vt[ GPU Ŏŝ܂ CPU ɐi߂.
+    m_FrameIndex = ( m_FrameIndex + 1 ) % FrameCount;
+    WaitForFence( m_FrameFenceValue[m_FrameIndex] );
+
+    // GPȔt[ŉ\񂳂ꂽIuWFNg.
+    m_ReleaseQueue.Collect( m_Fence->GetCompletedValue() );
 
     // R}hXgƃR}hAP[^Zbg.
-    m_CmdAllocator->Reset();
-    m_CmdList->Reset( m_CmdAllocator.GetPtr(), nullptr );
+    m_CmdAllocator[m_FrameIndex]->Reset();
+    m_CmdList->Reset( m_CmdAllocator[m_FrameIndex].GetPtr(), nullptr );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      GPUQƂĂ\̂IuWFNg̉\񂵂܂.
+//-------------------------------------------------------------------------------------------------
+void App::DeferRelease( IUnknown* pObject )
+{
+    // ݋L^̃t[̊ɉ.
+    m_ReleaseQueue.Push( pObject );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      GPȔ̊ҋ@܂.
+//-------------------------------------------------------------------------------------------------
+void App::WaitForGpu()
+{
+    if ( m_CmdQueue.GetPtr() == nullptr || m_Fence.GetPtr() == nullptr )
+    { return; }
+
+    WaitForFence( SignalFence() );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      tFXVOi܂.
+//-------------------------------------------------------------------------------------------------
+u64 App::SignalFence()
+{
+    // ݂̃t[̉\VOitFXlŒ߂.
+    m_FenceValue++;
+    m_CmdQueue->Signal( m_Fence.GetPtr(), m_FenceValue );
+    m_ReleaseQueue.Close( m_FenceValue );
+    return m_FenceValue;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      tFXw肵lɒB܂őҋ@܂.
+//-------------------------------------------------------------------------------------------------
+void App::WaitForFence( u64 value )
+{
+    if ( m_Fence->GetCompletedValue() < value )
+    {
+        m_Fence->SetEventOnCompletion( value, m_EventHandle );
+        WaitForSingleObject( m_EventHandle, INFINITE );
+    }
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -0,0 +1,1862 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : Benchmark.cpp
+// Desc : Math Library Micro Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// 数学ライブラリの各演算のスループットとレイテンシを計測します. Linux 等のヘッドレス環境でも動作します.
+//
+//  ビルド例 (Linux) :
+//      g++ -std=c++14 -O2 -march=native -I../include Benchmark.cpp -o Benchmark -pthread
+//      g++ -std=c++14 -O2 -DASDX_ENABLE_SIMD=0 -I../include Benchmark.cpp -o BenchmarkScalar -pthread
+//
+//  使用例 :
+//      Benchmark -o before.json
+//      Benchmark -filter Quaternion -samples 30
+//
+//  オプション :
+//      -filter <文字列>      グループ名か演算名に文字列を含むものだけを計測します.
+//      -samples <数>         計測回数 (既定値 15).
+//      -warmup <ミリ秒>      計測前に空回しする時間 (既定値 20).
+//      -sample-time <ミリ秒> 1回の計測の最短時間. これを超えるように繰り返し回数を決めます (既定値 2).
+//      -o <ファイル名>       結果を JSON で出力します.
+//      -list                 計測せずに一覧を表示します.
+//
+//  throughput は独立した要素を連続して処理した場合, latency は直前の結果を次の入力にした場合の
+//  1要素あたりの時間です. スカラー版と SIMD 版の比較は ASDX_ENABLE_SIMD を変えてビルドし, 同じ名前の
+//  結果同士を比べてください. 同じビルド内で両方を持つ演算 (Stream 版や SoA 版) は別名で計測します.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <asdxMath.h>
+#include <asdxSimd.h>
+#include <asdxFastMath.h>
+#include <asdxRandom.h>
+#include <asdxSoA.h>
+#include <asdxAlignedAllocator.h>
+#include <asdxPool.h>
+#include <asdxParallel.h>
+#include <asdxBvh.h>
+#include <asdxTransformHierarchy.h>
+#include <asdxEntity.h>
+#include <asdxSphericalHarmonics.h>
+#include <asdxBroadphase.h>
+#include <asdxIntersection.h>
+#include <asdxTimer.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const u32 Count          = 1024;     //!< 1回の処理で扱う要素数です. L1 キャッシュに収まる大きさにします.
+static const u32 BvhPrimitives  = 65536;    //!< BVH の計測に使うプリミティブ数です.
+static const u32 BvhRays        = 1024;     //!< BVH の計測に使うレイの数です.
+static const u32 MeshGridSize   = 708;      //!< 三角形メッシュの計測に使う格子の分割数です (約100万三角形).
+static const u32 TriangleCount  = 64;       //!< 交差判定の計測に使う三角形の数です.
+static const u32 IntersectionRays = 16;     //!< 交差判定の計測に使うレイの数です. パケット幅の倍数にします.
+static const u32 HierarchyNodes = 1000000;  //!< 階層姿勢の計測に使うノード数です.
+static const u32 HierarchyRoots = 64;       //!< 階層姿勢の計測に使うルートの数です.
+static const u32 EntityCount    = 100000;   //!< エンティティの計測に使うエンティティ数です.
+static const u32 ShNormals      = 65536;    //!< 放射照度の計測に使う法線の数です.
+static const u32 ShProbes       = 256;      //!< 射影の計測に使うプローブ数です.
+static const u32 ShCubemapSize  = 16;       //!< 射影の計測に使うキューブマップの幅です.
+static const u32 BroadphaseCount = 100000;  //!< ブロードフェーズの計測に使う物体数です.
+static const f32 BroadphaseWorldSize = 32.0f; //!< ブロードフェーズの物体を配置する範囲です. 平均で物体あたり1ペア程度になる密度にします.
+static const u32 MemoryCountPerThread = 16384; //!< 並列の確保・解放の計測でスレッドあたりに扱う数です.
+
+#if !defined(__GNUC__) && !defined(__clang__)
+volatile const void* g_EscapePtr = nullptr;
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ポインタの指す先が外部から参照されるものとしてコンパイラに扱わせます.
+//!
+//! @note       計測対象の処理が最適化で取り除かれないようにするために使います.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+inline void Escape( T* ptr )
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile( "" : : "g"( ptr ) : "memory" );
+#else
+    g_EscapePtr = ptr;
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchmarkConfig structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchmarkConfig
+{
+    std::string     Filter;             //!< 計測対象の絞り込み文字列です.
+    u32             Samples;            //!< 計測回数です.
+    f64             WarmupTime;         //!< 空回しする時間(秒)です.
+    f64             SampleTime;         //!< 1回の計測の最短時間(秒)です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchmarkResult structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchmarkResult
+{
+    std::string     Group;              //!< グループ名です.
+    std::string     Name;               //!< 演算名です.
+    std::string     Kind;               //!< throughput または latency です.
+    u32             Items;              //!< 1回の処理で扱う要素数です.
+    u32             Repeat;             //!< 1回の計測で処理を繰り返した回数です.
+    f64             Min;                //!< 1要素あたりの時間(ナノ秒)の最小値です.
+    f64             Median;             //!< 1要素あたりの時間(ナノ秒)の中央値です.
+    f64             Mean;               //!< 1要素あたりの時間(ナノ秒)の平均値です.
+    f64             StdDev;             //!< 1要素あたりの時間(ナノ秒)の標準偏差です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchmarkSuite class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class BenchmarkSuite
+{
+public:
+    typedef std::function<void()> Body;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      計測対象を登録します.
+    //!
+    //! @param [in]     group       グループ名.
+    //! @param [in]     name        演算名.
+    //! @param [in]     kind        throughput または latency.
+    //! @param [in]     items       body を1回呼び出したときに処理する要素数.
+    //! @param [in]     body        計測する処理.
+    //---------------------------------------------------------------------------------------------
+    void Add( const char* group, const char* name, const char* kind, u32 items, const Body& body )
+    {
+        Entry entry = { group, name, kind, items, body };
+        m_Entries.push_back( entry );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      登録された計測対象の一覧を表示します.
+    //---------------------------------------------------------------------------------------------
+    void List( const BenchmarkConfig& config ) const
+    {
+        for( size_t i=0; i<m_Entries.size(); ++i )
+        {
+            if ( IsMatch( m_Entries[i], config.Filter ) )
+            { printf( "%-12s %-36s %s\n", m_Entries[i].Group.c_str(), m_Entries[i].Name.c_str(), m_Entries[i].Kind.c_str() ); }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      計測を実行します.
+    //---------------------------------------------------------------------------------------------
+    void Run( const BenchmarkConfig& config, std::vector<BenchmarkResult>& results ) const
+    {
+        printf( "%-12s %-36s %-10s %10s %10s %10s %8s %10s\n",
+            "Group", "Name", "Kind", "min[ns]", "median[ns]", "mean[ns]", "stddev", "Mitems/s" );
+
+        for( size_t i=0; i<m_Entries.size(); ++i )
+        {
+            auto& entry = m_Entries[i];
+            if ( !IsMatch( entry, config.Filter ) )
+            { continue; }
+
+            BenchmarkResult result;
+            Measure( config, entry, result );
+            results.push_back( result );
+
+            printf( "%-12s %-36s %-10s %10.3f %10.3f %10.3f %7.1f%% %10.2f\n",
+                result.Group.c_str(), result.Name.c_str(), result.Kind.c_str(),
+                result.Min, result.Median, result.Mean,
+                ( result.Mean > 0.0 ) ? 100.0 * result.StdDev / result.Mean : 0.0,
+                ( result.Median > 0.0 ) ? 1e3 / result.Median : 0.0 );
+            fflush( stdout );
+        }
+    }
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        std::string     Group;          //!< グループ名です.
+        std::string     Name;           //!< 演算名です.
+        std::string     Kind;           //!< 計測の種類です.
+        u32             Items;          //!< 処理する要素数です.
+        Body            Func;           //!< 計測する処理です.
+    };
+
+    std::vector<Entry>  m_Entries;      //!< 計測対象です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      絞り込み文字列に一致するかどうかチェックします.
+    //---------------------------------------------------------------------------------------------
+    static bool IsMatch( const Entry& entry, const std::string& filter )
+    {
+        if ( filter.empty() )
+        { return true; }
+
+        return ( entry.Group.find( filter ) != std::string::npos )
+            || ( entry.Name .find( filter ) != std::string::npos );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1つの計測対象を計測して統計を求めます.
+    //---------------------------------------------------------------------------------------------
+    static void Measure( const BenchmarkConfig& config, const Entry& entry, BenchmarkResult& result )
+    {
+        asdx::StopWatch watch;
+
+        // 大きなデータは最初の呼び出しで生成されるので, 見積もりに含めないように先に1回呼び出す.
+        entry.Func();
+
+        // 空回ししながら1回あたりの時間を見積もる.
+        u32 calls = 0;
+        f64 elapsed = 0.0;
+        watch.Start();
+        do
+        {
+            entry.Func();
+            calls++;
+            watch.End();
+            elapsed = watch.GetElapsedTimeSec();
+        }
+        while( elapsed < config.WarmupTime );
+
+        auto perCall = elapsed / calls;
+        auto repeat  = static_cast<u32>( ceil( config.SampleTime / std::max( perCall, 1e-9 ) ) );
+        repeat = std::max( repeat, 1u );
+
+        std::vector<f64> samples( config.Samples );
+        for( u32 s=0; s<config.Samples; ++s )
+        {
+            watch.Start();
+            for( u32 r=0; r<repeat; ++r )
+            { entry.Func(); }
+            watch.End();
+            samples[s] = watch.GetElapsedTimeSec() * 1e9 / ( static_cast<f64>( repeat ) * entry.Items );
+        }
+
+        std::sort( samples.begin(), samples.end() );
+
+        auto mean = 0.0;
+        for( size_t s=0; s<samples.size(); ++s )
+        { mean += samples[s]; }
+        mean /= samples.size();
+
+        auto variance = 0.0;
+        for( size_t s=0; s<samples.size(); ++s )
+        { variance += ( samples[s] - mean ) * ( samples[s] - mean ); }
+        variance /= samples.size();
+
+        auto mid = samples.size() / 2;
+        result.Group  = entry.Group;
+        result.Name   = entry.Name;
+        result.Kind   = entry.Kind;
+        result.Items  = entry.Items;
+        result.Repeat = repeat;
+        result.Min    = samples.front();
+        result.Median = ( samples.size() % 2 ) ? samples[mid] : 0.5 * ( samples[mid - 1] + samples[mid] );
+        result.Mean   = mean;
+        result.StdDev = sqrt( variance );
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DataSet structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct DataSet
+{
+    std::vector<f32>                Scalar;     //!< [0, 1] の値です.
+    std::vector<f32>                Angle;      //!< [-π, π] の値です.
+    std::vector<f32>                Positive;   //!< [0.01, 100] の値です.
+    std::vector<asdx::Vector2>      V2A;        //!< 2次元ベクトルです.
+    std::vector<asdx::Vector2>      V2B;        //!< 2次元ベクトルです.
+    std::vector<asdx::Vector3>      V3A;        //!< 3次元ベクトルです.
+    std::vector<asdx::Vector3>      V3B;        //!< 3次元ベクトルです.
+    std::vector<asdx::Vector4>      V4A;        //!< 4次元ベクトルです.
+    std::vector<asdx::Vector4>      V4B;        //!< 4次元ベクトルです.
+    std::vector<asdx::Matrix>       MA;         //!< 剛体変換行列です.
+    std::vector<asdx::Matrix>       MB;         //!< 剛体変換行列です.
+    std::vector<asdx::Matrix3x4>    M34A;       //!< 剛体変換行列です.
+    std::vector<asdx::Matrix3x4>    M34B;       //!< 剛体変換行列です.
+    std::vector<asdx::Quaternion>   QA;         //!< 単位クォータニオンです.
+    std::vector<asdx::Quaternion>   QB;         //!< 単位クォータニオンです.
+    std::vector<f16>                Half;       //!< 半精度の値です.
+    asdx::AlignedVector<asdx::Vector4A> V4Aligned;  //!< V4A と同じ値を持つアライメント済みベクトルです.
+    asdx::MatrixA                   MAligned;   //!< MA[0] と同じ値を持つアライメント済み行列です.
+
+    std::vector<f32>                OutF32;     //!< 出力先です.
+    std::vector<u32>                OutU32;     //!< 出力先です.
+    std::vector<f16>                OutF16;     //!< 出力先です.
+    std::vector<asdx::Vector2>      OutV2;      //!< 出力先です.
+    std::vector<asdx::Vector3>      OutV3;      //!< 出力先です.
+    std::vector<asdx::Vector4>      OutV4;      //!< 出力先です.
+    std::vector<asdx::Matrix>       OutM;       //!< 出力先です.
+    std::vector<asdx::Matrix3x4>    OutM34;     //!< 出力先です.
+    std::vector<asdx::Quaternion>   OutQ;       //!< 出力先です.
+    asdx::AlignedVector<asdx::Vector4A> OutV4Aligned;   //!< 出力先です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      乱数で初期化します.
+    //---------------------------------------------------------------------------------------------
+    void Init( u32 seed )
+    {
+        asdx::Random random( static_cast<s32>( seed ) );
+        auto pi = asdx::F_PI;
+
+        for( u32 i=0; i<Count; ++i )
+        {
+            Scalar  .push_back( random.GetAsF32() );
+            Angle   .push_back( random.GetAsF32( -pi, pi ) );
+            Positive.push_back( random.GetAsF32( 0.01f, 100.0f ) );
+
+            V2A.push_back( asdx::Vector2( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) ) );
+            V2B.push_back( asdx::Vector2( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) ) );
+            V3A.push_back( asdx::Vector3( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) ) );
+            V3B.push_back( asdx::Vector3( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) ) );
+            V4A.push_back( asdx::Vector4( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), 1.0f ) );
+            V4B.push_back( asdx::Vector4( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), 1.0f ) );
+
+            MA.push_back( CreateRigid( random ) );
+            MB.push_back( CreateRigid( random ) );
+            M34A.push_back( asdx::Matrix3x4( MA.back() ) );
+            M34B.push_back( asdx::Matrix3x4( MB.back() ) );
+
+            QA.push_back( asdx::Quaternion::CreateFromYawPitchRoll( random.GetAsF32( -pi, pi ), random.GetAsF32( -pi, pi ), random.GetAsF32( -pi, pi ) ) );
+            QB.push_back( asdx::Quaternion::CreateFromYawPitchRoll( random.GetAsF32( -pi, pi ), random.GetAsF32( -pi, pi ), random.GetAsF32( -pi, pi ) ) );
+
+            Half.push_back( asdx::F32ToF16( random.GetAsF32( -100.0f, 100.0f ) ) );
+        }
+
+        OutF32.resize( Count );
+        OutU32.resize( Count );
+        OutF16.resize( Count );
+        OutV2 .resize( Count );
+        OutV3 .resize( Count );
+        OutV4 .resize( Count );
+        OutM  .resize( Count );
+        OutM34.resize( Count );
+        OutQ  .resize( Count );
+
+        V4Aligned   .assign( V4A.begin(), V4A.end() );
+        MAligned     = MA[0];
+        OutV4Aligned.resize( Count );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ランダムな剛体変換行列を生成します.
+    //---------------------------------------------------------------------------------------------
+    static asdx::Matrix CreateRigid( asdx::Random& random )
+    {
+        auto pi = asdx::F_PI;
+        auto r  = asdx::Matrix::CreateRotationFromYawPitchRoll( random.GetAsF32( -pi, pi ), random.GetAsF32( -pi, pi ), random.GetAsF32( -pi, pi ) );
+        auto t  = asdx::Matrix::CreateTranslation( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) );
+        return r * t;
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      要素ごとに独立した処理のスループットを計測対象に登録します.
+//!
+//! @param [in]     func        T func( u32 index ) です.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename Func>
+void AddMap( BenchmarkSuite& suite, const char* group, const char* name, std::vector<T>& output, Func func )
+{
+    auto pOutput = output.data();
+    suite.Add( group, name, "throughput", Count, [pOutput, func]()
+    {
+        for( u32 i=0; i<Count; ++i )
+        { pOutput[i] = func( i ); }
+        Escape( pOutput );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      直前の結果を入力にする処理のレイテンシを計測対象に登録します.
+//!
+//! @param [in]     func        T func( const T& value, u32 index ) です.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename Func>
+void AddChain( BenchmarkSuite& suite, const char* group, const char* name, const T& init, Func func )
+{
+    suite.Add( group, name, "latency", Count, [init, func]()
+    {
+        auto value = init;
+        for( u32 i=0; i<Count; ++i )
+        { value = func( value, i ); }
+        Escape( &value );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Vector2 の演算を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterVector2( BenchmarkSuite& suite, DataSet& d )
+{
+    typedef asdx::Vector2 V;
+    auto& a = d.V2A;
+    auto& b = d.V2B;
+    auto& s = d.Scalar;
+    auto& m = d.MA;
+    const char* g = "Vector2";
+
+    AddMap( suite, g, "Add",                d.OutV2,  [&]( u32 i ) { return a[i] + b[i]; } );
+    AddMap( suite, g, "Mul",                d.OutV2,  [&]( u32 i ) { return a[i] * s[i]; } );
+    AddMap( suite, g, "Length",             d.OutF32, [&]( u32 i ) { return a[i].Length(); } );
+    AddMap( suite, g, "Dot",                d.OutF32, [&]( u32 i ) { return V::Dot( a[i], b[i] ); } );
+    AddMap( suite, g, "Distance",           d.OutF32, [&]( u32 i ) { return V::Distance( a[i], b[i] ); } );
+    AddMap( suite, g, "Normalize",          d.OutV2,  [&]( u32 i ) { return V::Normalize( a[i] ); } );
+    AddMap( suite, g, "SafeNormalize",      d.OutV2,  [&]( u32 i ) { return V::SafeNormalize( a[i], b[i] ); } );
+    AddMap( suite, g, "Abs",                d.OutV2,  [&]( u32 i ) { return V::Abs( a[i] ); } );
+    AddMap( suite, g, "Clamp",              d.OutV2,  [&]( u32 i ) { return V::Clamp( a[i], -b[i], b[i] ); } );
+    AddMap( suite, g, "Saturate",           d.OutV2,  [&]( u32 i ) { return V::Saturate( a[i] ); } );
+    AddMap( suite, g, "Min",                d.OutV2,  [&]( u32 i ) { return V::Min( a[i], b[i] ); } );
+    AddMap( suite, g, "Max",                d.OutV2,  [&]( u32 i ) { return V::Max( a[i], b[i] ); } );
+    AddMap( suite, g, "ComputeCrossingAngle", d.OutF32, [&]( u32 i ) { return V::ComputeCrossingAngle( a[i], b[i] ); } );
+    AddMap( suite, g, "Reflect",            d.OutV2,  [&]( u32 i ) { return V::Reflect( a[i], b[i] ); } );
+    AddMap( suite, g, "Refract",            d.OutV2,  [&]( u32 i ) { return V::Refract( a[i], b[i], 0.66f ); } );
+    AddMap( suite, g, "Lerp",               d.OutV2,  [&]( u32 i ) { return V::Lerp( a[i], b[i], s[i] ); } );
+    AddMap( suite, g, "SmoothStep",         d.OutV2,  [&]( u32 i ) { return V::SmoothStep( a[i], b[i], s[i] ); } );
+    AddMap( suite, g, "Barycentric",        d.OutV2,  [&]( u32 i ) { return V::Barycentric( a[i], b[i], a[i ^ 1], s[i], s[i ^ 1] ); } );
+    AddMap( suite, g, "Hermite",            d.OutV2,  [&]( u32 i ) { return V::Hermite( a[i], b[i], a[i ^ 1], b[i ^ 1], s[i] ); } );
+    AddMap( suite, g, "CatmullRom",         d.OutV2,  [&]( u32 i ) { return V::CatmullRom( a[i], b[i], a[i ^ 1], b[i ^ 1], s[i] ); } );
+    AddMap( suite, g, "Transform",          d.OutV2,  [&]( u32 i ) { return V::Transform( a[i], m[i] ); } );
+    AddMap( suite, g, "TransformNormal",    d.OutV2,  [&]( u32 i ) { return V::TransformNormal( a[i], m[i] ); } );
+    AddMap( suite, g, "TransformCoord",     d.OutV2,  [&]( u32 i ) { return V::TransformCoord( a[i], m[i] ); } );
+
+    AddChain( suite, g, "Add",              a[0], [&]( const V& x, u32 i ) { return x + b[i]; } );
+    AddChain( suite, g, "Normalize",        a[0], [&]( const V& x, u32 )   { return V::Normalize( x ); } );
+    AddChain( suite, g, "Lerp",             a[0], [&]( const V& x, u32 i ) { return V::Lerp( x, b[i], 0.5f ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Vector3 の演算を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterVector3( BenchmarkSuite& suite, DataSet& d )
+{
+    typedef asdx::Vector3 V;
+    auto& a = d.V3A;
+    auto& b = d.V3B;
+    auto& s = d.Scalar;
+    auto& m = d.MA;
+    auto& m34 = d.M34A;
+    const char* g = "Vector3";
+
+    AddMap( suite, g, "Add",                d.OutV3,  [&]( u32 i ) { return a[i] + b[i]; } );
+    AddMap( suite, g, "Mul",                d.OutV3,  [&]( u32 i ) { return a[i] * s[i]; } );
+    AddMap( suite, g, "Length",             d.OutF32, [&]( u32 i ) { return a[i].Length(); } );
+    AddMap( suite, g, "Dot",                d.OutF32, [&]( u32 i ) { return V::Dot( a[i], b[i] ); } );
+    AddMap( suite, g, "Cross",              d.OutV3,  [&]( u32 i ) { return V::Cross( a[i], b[i] ); } );
+    AddMap( suite, g, "Distance",           d.OutF32, [&]( u32 i ) { return V::Distance( a[i], b[i] ); } );
+    AddMap( suite, g, "Normalize",          d.OutV3,  [&]( u32 i ) { return V::Normalize( a[i] ); } );
+    AddMap( suite, g, "SafeNormalize",      d.OutV3,  [&]( u32 i ) { return V::SafeNormalize( a[i], b[i] ); } );
+    AddMap( suite, g, "Abs",                d.OutV3,  [&]( u32 i ) { return V::Abs( a[i] ); } );
+    AddMap( suite, g, "Clamp",              d.OutV3,  [&]( u32 i ) { return V::Clamp( a[i], -b[i], b[i] ); } );
+    AddMap( suite, g, "Saturate",           d.OutV3,  [&]( u32 i ) { return V::Saturate( a[i] ); } );
+    AddMap( suite, g, "Min",                d.OutV3,  [&]( u32 i ) { return V::Min( a[i], b[i] ); } );
+    AddMap( suite, g, "Max",                d.OutV3,  [&]( u32 i ) { return V::Max( a[i], b[i] ); } );
+    AddMap( suite, g, "ComputeNormal",      d.OutV3,  [&]( u32 i ) { return V::ComputeNormal( a[i], b[i], a[i ^ 1] ); } );
+    AddMap( suite, g, "ComputeCrossingAngle", d.OutF32, [&]( u32 i ) { return V::ComputeCrossingAngle( a[i], b[i] ); } );
+    AddMap( suite, g, "Reflect",            d.OutV3,  [&]( u32 i ) { return V::Reflect( a[i], b[i] ); } );
+    AddMap( suite, g, "Refract",            d.OutV3,  [&]( u32 i ) { return V::Refract( a[i], b[i], 0.66f ); } );
+    AddMap( suite, g, "Lerp",               d.OutV3,  [&]( u32 i ) { return V::Lerp( a[i], b[i], s[i] ); } );
+    AddMap( suite, g, "SmoothStep",         d.OutV3,  [&]( u32 i ) { return V::SmoothStep( a[i], b[i], s[i] ); } );
+    AddMap( suite, g, "Barycentric",        d.OutV3,  [&]( u32 i ) { return V::Barycentric( a[i], b[i], a[i ^ 1], s[i], s[i ^ 1] ); } );
+    AddMap( suite, g, "Hermite",            d.OutV3,  [&]( u32 i ) { return V::Hermite( a[i], b[i], a[i ^ 1], b[i ^ 1], s[i] ); } );
+    AddMap( suite, g, "CatmullRom",         d.OutV3,  [&]( u32 i ) { return V::CatmullRom( a[i], b[i], a[i ^ 1], b[i ^ 1], s[i] ); } );
+    AddMap( suite, g, "ScalarTriple",       d.OutF32, [&]( u32 i ) { return V::ScalarTriple( a[i], b[i], a[i ^ 1] ); } );
+    AddMap( suite, g, "VectorTriple",       d.OutV3,  [&]( u32 i ) { return V::VectorTriple( a[i], b[i], a[i ^ 1] ); } );
+    AddMap( suite, g, "Transform",          d.OutV3,  [&]( u32 i ) { return V::Transform( a[i], m[i] ); } );
+    AddMap( suite, g, "TransformNormal",    d.OutV3,  [&]( u32 i ) { return V::TransformNormal( a[i], m[i] ); } );
+    AddMap( suite, g, "TransformCoord",     d.OutV3,  [&]( u32 i ) { return V::TransformCoord( a[i], m[i] ); } );
+    AddMap( suite, g, "Transform (3x4)",    d.OutV3,  [&]( u32 i ) { return V::Transform( a[i], m34[i] ); } );
+
+    suite.Add( g, "TransformStream", "throughput", Count, [&]()
+    {
+        V::TransformStream( d.V3A.data(), sizeof(V), Count, d.MA[0], d.OutV3.data(), sizeof(V) );
+        Escape( d.OutV3.data() );
+    });
+    suite.Add( g, "TransformNormalStream", "throughput", Count, [&]()
+    {
+        V::TransformNormalStream( d.V3A.data(), sizeof(V), Count, d.MA[0], d.OutV3.data(), sizeof(V) );
+        Escape( d.OutV3.data() );
+    });
+    suite.Add( g, "TransformCoordStream", "throughput", Count, [&]()
+    {
+        V::TransformCoordStream( d.V3A.data(), sizeof(V), Count, d.MA[0], d.OutV3.data(), sizeof(V) );
+        Escape( d.OutV3.data() );
+    });
+
+    AddChain( suite, g, "Add",              a[0], [&]( const V& x, u32 i ) { return x + b[i]; } );
+    AddChain( suite, g, "Cross",            a[0], [&]( const V& x, u32 i ) { return V::Cross( x, b[i] ) + a[i]; } );
+    AddChain( suite, g, "Normalize",        a[0], [&]( const V& x, u32 )   { return V::Normalize( x ); } );
+    AddChain( suite, g, "Lerp",             a[0], [&]( const V& x, u32 i ) { return V::Lerp( x, b[i], 0.5f ); } );
+    AddChain( suite, g, "Transform",        a[0], [&]( const V& x, u32 i ) { return V::Transform( x, m[i] ); } );
+    AddChain( suite, g, "TransformNormal",  a[0], [&]( const V& x, u32 i ) { return V::TransformNormal( x, m[i] ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Vector4 の演算を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterVector4( BenchmarkSuite& suite, DataSet& d )
+{
+    typedef asdx::Vector4 V;
+    auto& a = d.V4A;
+    auto& b = d.V4B;
+    auto& s = d.Scalar;
+    auto& m = d.MA;
+    const char* g = "Vector4";
+
+    AddMap( suite, g, "Add",                d.OutV4,  [&]( u32 i ) { return a[i] + b[i]; } );
+    AddMap( suite, g, "Mul",                d.OutV4,  [&]( u32 i ) { return a[i] * s[i]; } );
+    AddMap( suite, g, "Length",             d.OutF32, [&]( u32 i ) { return a[i].Length(); } );
+    AddMap( suite, g, "Dot",                d.OutF32, [&]( u32 i ) { return V::Dot( a[i], b[i] ); } );
+    AddMap( suite, g, "Distance",           d.OutF32, [&]( u32 i ) { return V::Distance( a[i], b[i] ); } );
+    AddMap( suite, g, "Normalize",          d.OutV4,  [&]( u32 i ) { return V::Normalize( a[i] ); } );
+    AddMap( suite, g, "SafeNormalize",      d.OutV4,  [&]( u32 i ) { return V::SafeNormalize( a[i], b[i] ); } );
+    AddMap( suite, g, "Abs",                d.OutV4,  [&]( u32 i ) { return V::Abs( a[i] ); } );
+    AddMap( suite, g, "Clamp",              d.OutV4,  [&]( u32 i ) { return V::Clamp( a[i], -b[i], b[i] ); } );
+    AddMap( suite, g, "Saturate",           d.OutV4,  [&]( u32 i ) { return V::Saturate( a[i] ); } );
+    AddMap( suite, g, "Min",                d.OutV4,  [&]( u32 i ) { return V::Min( a[i], b[i] ); } );
+    AddMap( suite, g, "Max",                d.OutV4,  [&]( u32 i ) { return V::Max( a[i], b[i] ); } );
+    AddMap( suite, g, "ComputeCrossingAngle", d.OutF32, [&]( u32 i ) { return V::ComputeCrossingAngle( a[i], b[i] ); } );
+    AddMap( suite, g, "Lerp",               d.OutV4,  [&]( u32 i ) { return V::Lerp( a[i], b[i], s[i] ); } );
+    AddMap( suite, g, "SmoothStep",         d.OutV4,  [&]( u32 i ) { return V::SmoothStep( a[i], b[i], s[i] ); } );
+    AddMap( suite, g, "Barycentric",        d.OutV4,  [&]( u32 i ) { return V::Barycentric( a[i], b[i], a[i ^ 1], s[i], s[i ^ 1] ); } );
+    AddMap( suite, g, "Hermite",            d.OutV4,  [&]( u32 i ) { return V::Hermite( a[i], b[i], a[i ^ 1], b[i ^ 1], s[i] ); } );
+    AddMap( suite, g, "CatmullRom",         d.OutV4,  [&]( u32 i ) { return V::CatmullRom( a[i], b[i], a[i ^ 1], b[i ^ 1], s[i] ); } );
+    AddMap( suite, g, "Transform",          d.OutV4,  [&]( u32 i ) { return V::Transform( a[i], m[i] ); } );
+
+    suite.Add( g, "TransformStream", "throughput", Count, [&]()
+    {
+        V::TransformStream( d.V4A.data(), sizeof(V), Count, d.MA[0], d.OutV4.data(), sizeof(V) );
+        Escape( d.OutV4.data() );
+    });
+
+    suite.Add( g, "TransformStreamAligned", "throughput", Count, [&]()
+    {
+        asdx::TransformStream( d.V4Aligned.data(), Count, d.MAligned, d.OutV4Aligned.data() );
+        Escape( d.OutV4Aligned.data() );
+    });
+
+    AddChain( suite, g, "Add",              a[0], [&]( const V& x, u32 i ) { return x + b[i]; } );
+    AddChain( suite, g, "Normalize",        a[0], [&]( const V& x, u32 )   { return V::Normalize( x ); } );
+    AddChain( suite, g, "Lerp",             a[0], [&]( const V& x, u32 i ) { return V::Lerp( x, b[i], 0.5f ); } );
+    AddChain( suite, g, "Transform",        a[0], [&]( const V& x, u32 i ) { return V::Transform( x, m[i] ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Matrix と Matrix3x4 の演算を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterMatrix( BenchmarkSuite& suite, DataSet& d )
+{
+    typedef asdx::Matrix    M;
+    typedef asdx::Matrix3x4 M34;
+    auto& a   = d.MA;
+    auto& b   = d.MB;
+    auto& a34 = d.M34A;
+    auto& b34 = d.M34B;
+    auto& s   = d.Scalar;
+    auto& r   = d.Angle;
+    auto& v   = d.V3A;
+    auto& q   = d.QA;
+    const char* g = "Matrix";
+
+    AddMap( suite, g, "Multiply",           d.OutM,   [&]( u32 i ) { return M::Multiply( a[i], b[i] ); } );
+    AddMap( suite, g, "MultiplyScalar",     d.OutM,   [&]( u32 i ) { return M::Multiply( a[i], s[i] ); } );
+    AddMap( suite, g, "MultiplyTranspose",  d.OutM,   [&]( u32 i ) { return M::MultiplyTranspose( a[i], b[i] ); } );
+    AddMap( suite, g, "Transpose",          d.OutM,   [&]( u32 i ) { return M::Transpose( a[i] ); } );
+    AddMap( suite, g, "Invert",             d.OutM,   [&]( u32 i ) { return M::Invert( a[i] ); } );
+    AddMap( suite, g, "Determinant",        d.OutF32, [&]( u32 i ) { return a[i].Determinant(); } );
+    AddMap( suite, g, "Lerp",               d.OutM,   [&]( u32 i ) { return M::Lerp( a[i], b[i], s[i] ); } );
+    AddMap( suite, g, "CreateScale",        d.OutM,   [&]( u32 i ) { return M::CreateScale( v[i] ); } );
+    AddMap( suite, g, "CreateTranslation",  d.OutM,   [&]( u32 i ) { return M::CreateTranslation( v[i] ); } );
+    AddMap( suite, g, "CreateRotationX",    d.OutM,   [&]( u32 i ) { return M::CreateRotationX( r[i] ); } );
+    AddMap( suite, g, "CreateRotationY",    d.OutM,   [&]( u32 i ) { return M::CreateRotationY( r[i] ); } );
+    AddMap( suite, g, "CreateRotationZ",    d.OutM,   [&]( u32 i ) { return M::CreateRotationZ( r[i] ); } );
+    AddMap( suite, g, "CreateFromQuaternion", d.OutM, [&]( u32 i ) { return M::CreateFromQuaternion( q[i] ); } );
+    AddMap( suite, g, "CreateFromAxisAngle", d.OutM,  [&]( u32 i ) { return M::CreateFromAxisAngle( v[i], r[i] ); } );
+    AddMap( suite, g, "CreateRotationFromYawPitchRoll", d.OutM, [&]( u32 i ) { return M::CreateRotationFromYawPitchRoll( r[i], r[i ^ 1], r[i ^ 2] ); } );
+    AddMap( suite, g, "CreateLookAt",       d.OutM,   [&]( u32 i ) { return M::CreateLookAt( v[i], d.V3B[i], asdx::Vector3( 0.0f, 1.0f, 0.0f ) ); } );
+    AddMap( suite, g, "CreatePerspectiveFieldOfView", d.OutM, [&]( u32 i ) { return M::CreatePerspectiveFieldOfView( 0.5f + s[i], 1.777f, 0.1f, 1000.0f ); } );
+    AddMap( suite, g, "CreateOrthographic", d.OutM,   [&]( u32 i ) { return M::CreateOrthographic( 1.0f + s[i], 1.0f + s[i ^ 1], 0.1f, 1000.0f ); } );
+
+    AddChain( suite, g, "Multiply",         a[0], [&]( const M& x, u32 i ) { return M::Multiply( x, b[i] ); } );
+    AddChain( suite, g, "Transpose",        a[0], [&]( const M& x, u32 )   { return M::Transpose( x ); } );
+    AddChain( suite, g, "Invert",           a[0], [&]( const M& x, u32 )   { return M::Invert( x ); } );
+
+    g = "Matrix3x4";
+    AddMap( suite, g, "Multiply",           d.OutM34, [&]( u32 i ) { return M34::Multiply( a34[i], b34[i] ); } );
+    AddMap( suite, g, "Invert",             d.OutM34, [&]( u32 i ) { return M34::Invert( a34[i] ); } );
+    AddMap( suite, g, "InvertRigid",        d.OutM34, [&]( u32 i ) { return M34::InvertRigid( a34[i] ); } );
+    AddMap( suite, g, "ToMatrix",           d.OutM,   [&]( u32 i ) { return a34[i].ToMatrix(); } );
+
+    AddChain( suite, g, "Multiply",         a34[0], [&]( const M34& x, u32 i ) { return M34::Multiply( x, b34[i] ); } );
+    AddChain( suite, g, "InvertRigid",      a34[0], [&]( const M34& x, u32 )   { return M34::InvertRigid( x ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Quaternion の演算を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterQuaternion( BenchmarkSuite& suite, DataSet& d )
+{
+    typedef asdx::Quaternion Q;
+    auto& a = d.QA;
+    auto& b = d.QB;
+    auto& s = d.Scalar;
+    auto& r = d.Angle;
+    auto& v = d.V3A;
+    auto& m = d.MA;
+    const char* g = "Quaternion";
+
+    AddMap( suite, g, "Multiply",           d.OutQ,   [&]( u32 i ) { return Q::Multiply( a[i], b[i] ); } );
+    AddMap( suite, g, "Concatenate",        d.OutQ,   [&]( u32 i ) { return Q::Concatenate( a[i], b[i] ); } );
+    AddMap( suite, g, "Dot",                d.OutF32, [&]( u32 i ) { return Q::Dot( a[i], b[i] ); } );
+    AddMap( suite, g, "Length",             d.OutF32, [&]( u32 i ) { return a[i].Length(); } );
+    AddMap( suite, g, "Conjugate",          d.OutQ,   [&]( u32 i ) { return Q::Conjugate( a[i] ); } );
+    AddMap( suite, g, "Normalize",          d.OutQ,   [&]( u32 i ) { return Q::Normalize( a[i] ); } );
+    AddMap( suite, g, "SafeNormalize",      d.OutQ,   [&]( u32 i ) { return Q::SafeNormalize( a[i], b[i] ); } );
+    AddMap( suite, g, "Inverse",            d.OutQ,   [&]( u32 i ) { return Q::Inverse( a[i] ); } );
+    AddMap( suite, g, "CreateFromYawPitchRoll", d.OutQ, [&]( u32 i ) { return Q::CreateFromYawPitchRoll( r[i], r[i ^ 1], r[i ^ 2] ); } );
+    AddMap( suite, g, "CreateFromAxisAngle", d.OutQ,  [&]( u32 i ) { return Q::CreateFromAxisAngle( v[i], r[i] ); } );
+    AddMap( suite, g, "CreateFromRotationMatrix", d.OutQ, [&]( u32 i ) { return Q::CreateFromRotationMatrix( m[i] ); } );
+    AddMap( suite, g, "Slerp",              d.OutQ,   [&]( u32 i ) { return Q::Slerp( a[i], b[i], s[i] ); } );
+    AddMap( suite, g, "Squad",              d.OutQ,   [&]( u32 i ) { return Q::Squad( a[i], b[i], a[i ^ 1], b[i ^ 1], s[i] ); } );
+
+    AddChain( suite, g, "Multiply",         a[0], [&]( const Q& x, u32 i ) { return Q::Multiply( x, b[i] ); } );
+    AddChain( suite, g, "Normalize",        a[0], [&]( const Q& x, u32 )   { return Q::Normalize( x ); } );
+    AddChain( suite, g, "Slerp",            a[0], [&]( const Q& x, u32 i ) { return Q::Slerp( x, b[i], 0.5f ); } );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      乱数生成と半精度変換を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterRandomAndF16( BenchmarkSuite& suite, DataSet& d )
+{
+    // 計測中に状態が進むので, 生成器はラムダ式に持たせる.
+    const char* g = "Random";
+    {
+        auto pOutput = d.OutU32.data();
+        asdx::Random random( 12345 );
+        suite.Add( g, "Random::GetAsU32", "throughput", Count, [pOutput, random]() mutable
+        {
+            for( u32 i=0; i<Count; ++i )
+            { pOutput[i] = random.GetAsU32(); }
+            Escape( pOutput );
+        });
+    }
+    {
+        auto pOutput = d.OutF32.data();
+        asdx::Random random( 12345 );
+        suite.Add( g, "Random::GetAsF32", "throughput", Count, [pOutput, random]() mutable
+        {
+            for( u32 i=0; i<Count; ++i )
+            { pOutput[i] = random.GetAsF32(); }
+            Escape( pOutput );
+        });
+    }
+    {
+        auto pOutput = d.OutU32.data();
+        asdx::RandomN random( 12345 );
+        suite.Add( g, "RandomN::Fill(u32)", "throughput", Count, [pOutput, random]() mutable
+        {
+            random.Fill( pOutput, Count );
+            Escape( pOutput );
+        });
+    }
+    {
+        auto pOutput = d.OutF32.data();
+        asdx::RandomN random( 12345 );
+        suite.Add( g, "RandomN::Fill(f32)", "throughput", Count, [pOutput, random]() mutable
+        {
+            random.Fill( pOutput, Count );
+            Escape( pOutput );
+        });
+    }
+    {
+        asdx::Random random( 12345 );
+        suite.Add( g, "Random::GetAsU32", "latency", Count, [random]() mutable
+        {
+            u32 value = 0;
+            for( u32 i=0; i<Count; ++i )
+            { value ^= random.GetAsU32(); }
+            Escape( &value );
+        });
+    }
+
+    g = "F16";
+    AddMap( suite, g, "F32ToF16", d.OutF16, [&]( u32 i ) { return asdx::F32ToF16( d.Positive[i] ); } );
+    AddMap( suite, g, "F16ToF32", d.OutF32, [&]( u32 i ) { return asdx::F16ToF32( d.Half[i] ); } );
+    suite.Add( g, "F32ToF16Stream", "throughput", Count, [&]()
+    {
+        asdx::F32ToF16Stream( d.Positive.data(), Count, d.OutF16.data() );
+        Escape( d.OutF16.data() );
+    });
+    suite.Add( g, "F16ToF32Stream", "throughput", Count, [&]()
+    {
+        asdx::F16ToF32Stream( d.Half.data(), Count, d.OutF32.data() );
+        Escape( d.OutF32.data() );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SoA 形式の演算を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterSoA( BenchmarkSuite& suite, DataSet& d )
+{
+    // 登録したラムダ式から参照するので, 計測が終わるまで解放しない.
+    static asdx::Vector3SoA a( Count );
+    static asdx::Vector3SoA b( Count );
+    static asdx::Vector3SoA result( Count );
+    a.FromAoS( d.V3A.data(), Count );
+    b.FromAoS( d.V3B.data(), Count );
+
+    const char* g = "SoA";
+    suite.Add( g, "Vector3SoA::Dot", "throughput", Count, [&]()
+    {
+        asdx::Vector3SoA::Dot( a, b, d.OutF32.data() );
+        Escape( d.OutF32.data() );
+    });
+    suite.Add( g, "Vector3SoA::Length", "throughput", Count, [&]()
+    {
+        asdx::Vector3SoA::Length( a, d.OutF32.data() );
+        Escape( d.OutF32.data() );
+    });
+    suite.Add( g, "Vector3SoA::Cross", "throughput", Count, []()
+    {
+        asdx::Vector3SoA::Cross( a, b, result );
+        Escape( &result );
+    });
+    suite.Add( g, "Vector3SoA::Normalize", "throughput", Count, []()
+    {
+        asdx::Vector3SoA::Normalize( a, result );
+        Escape( &result );
+    });
+    suite.Add( g, "Vector3SoA::Lerp", "throughput", Count, []()
+    {
+        asdx::Vector3SoA::Lerp( a, b, 0.25f, result );
+        Escape( &result );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      近似関数と標準ライブラリを登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterFastMath( BenchmarkSuite& suite, DataSet& d )
+{
+    auto& x = d.Angle;
+    auto& s = d.Scalar;
+    auto& p = d.Positive;
+    const char* g = "FastMath";
+
+    AddMap( suite, g, "sinf",   d.OutF32, [&]( u32 i ) { return sinf( x[i] ); } );
+    AddMap( suite, g, "cosf",   d.OutF32, [&]( u32 i ) { return cosf( x[i] ); } );
+    AddMap( suite, g, "acosf",  d.OutF32, [&]( u32 i ) { return acosf( s[i] ); } );
+    AddMap( suite, g, "atan2f", d.OutF32, [&]( u32 i ) { return atan2f( x[i], x[i ^ 1] ); } );
+    AddMap( suite, g, "exp2f",  d.OutF32, [&]( u32 i ) { return exp2f( x[i] ); } );
+    AddMap( suite, g, "log2f",  d.OutF32, [&]( u32 i ) { return log2f( p[i] ); } );
+    AddMap( suite, g, "powf",   d.OutF32, [&]( u32 i ) { return powf( p[i], x[i] ); } );
+    AddMap( suite, g, "1/sqrtf", d.OutF32, [&]( u32 i ) { return 1.0f / sqrtf( p[i] ); } );
+
+    AddMap( suite, g, "FastSin",   d.OutF32, [&]( u32 i ) { return asdx::FastSin( x[i] ); } );
+    AddMap( suite, g, "FastCos",   d.OutF32, [&]( u32 i ) { return asdx::FastCos( x[i] ); } );
+    AddMap( suite, g, "FastAcos",  d.OutF32, [&]( u32 i ) { return asdx::FastAcos( s[i] ); } );
+    AddMap( suite, g, "FastAtan2", d.OutF32, [&]( u32 i ) { return asdx::FastAtan2( x[i], x[i ^ 1] ); } );
+    AddMap( suite, g, "FastExp2",  d.OutF32, [&]( u32 i ) { return asdx::FastExp2( x[i] ); } );
+    AddMap( suite, g, "FastLog2",  d.OutF32, [&]( u32 i ) { return asdx::FastLog2( p[i] ); } );
+    AddMap( suite, g, "FastPow",   d.OutF32, [&]( u32 i ) { return asdx::FastPow( p[i], x[i] ); } );
+    AddMap( suite, g, "FastRsqrt", d.OutF32, [&]( u32 i ) { return asdx::FastRsqrt( p[i] ); } );
+
+    auto out = d.OutF32.data();
+    suite.Add( g, "FastSinStream",   "throughput", Count, [&, out]() { asdx::FastSinStream  ( x.data(), Count, out ); Escape( out ); } );
+    suite.Add( g, "FastCosStream",   "throughput", Count, [&, out]() { asdx::FastCosStream  ( x.data(), Count, out ); Escape( out ); } );
+    suite.Add( g, "FastAcosStream",  "throughput", Count, [&, out]() { asdx::FastAcosStream ( s.data(), Count, out ); Escape( out ); } );
+    suite.Add( g, "FastAtan2Stream", "throughput", Count, [&, out]() { asdx::FastAtan2Stream( x.data(), d.Scalar.data(), Count, out ); Escape( out ); } );
+    suite.Add( g, "FastExp2Stream",  "throughput", Count, [&, out]() { asdx::FastExp2Stream ( x.data(), Count, out ); Escape( out ); } );
+    suite.Add( g, "FastLog2Stream",  "throughput", Count, [&, out]() { asdx::FastLog2Stream ( p.data(), Count, out ); Escape( out ); } );
+    suite.Add( g, "FastPowStream",   "throughput", Count, [&, out]() { asdx::FastPowStream  ( p.data(), x.data(), Count, out ); Escape( out ); } );
+    suite.Add( g, "FastRsqrtStream", "throughput", Count, [&, out]() { asdx::FastRsqrtStream( p.data(), Count, out ); Escape( out ); } );
+
+    AddChain( suite, g, "sinf",    0.5f, []( f32 v, u32 ) { return sinf( v ); } );
+    AddChain( suite, g, "FastSin", 0.5f, []( f32 v, u32 ) { return asdx::FastSin( v ); } );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PoolObject structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct PoolObject
+{
+    u8 Data[64];        //!< ペイロードです.
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      メモリ確保を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterMemory( BenchmarkSuite& suite )
+{
+    static asdx::Pool<PoolObject> pool;
+    static std::vector<void*> ptrs( Count );
+
+    const char* g = "Memory";
+    suite.Add( g, "malloc/free (64B)", "throughput", Count, []()
+    {
+        for( u32 i=0; i<Count; ++i )
+        { ptrs[i] = malloc( sizeof(PoolObject) ); }
+        Escape( ptrs.data() );
+        for( u32 i=0; i<Count; ++i )
+        { free( ptrs[i] ); }
+    });
+    suite.Add( g, "Pool::Alloc/Free (64B)", "throughput", Count, []()
+    {
+        for( u32 i=0; i<Count; ++i )
+        { ptrs[i] = pool.Alloc(); }
+        Escape( ptrs.data() );
+        for( u32 i=0; i<Count; ++i )
+        { pool.Free( ptrs[i] ); }
+    });
+
+    // 全スレッドで同時に確保・解放して競合時の性能を計測する.
+    // cross は確保したスレッドとは別のタスクが解放する場合です.
+    static const u32 threads = asdx::ThreadPool::Instance().GetWorkerCount() + 1;
+    static std::vector<void*> mtPtrs( size_t( threads ) * MemoryCountPerThread );
+
+    static std::string names[4];
+    auto suffix = " (64B, " + std::to_string( threads ) + " threads)";
+    names[0] = "malloc/free"            + suffix;
+    names[1] = "Pool::Alloc/Free"       + suffix;
+    names[2] = "malloc/free cross"      + suffix;
+    names[3] = "Pool::Alloc/Free cross" + suffix;
+
+    auto items = threads * MemoryCountPerThread;
+    auto local = []( void* (*alloc)(), void (*release)( void* ) )
+    {
+        asdx::ParallelFor( threads, 1, [=]( u32 begin, u32 end )
+        {
+            for( u32 t=begin; t<end; ++t )
+            {
+                auto p = &mtPtrs[size_t( t ) * MemoryCountPerThread];
+                for( u32 i=0; i<MemoryCountPerThread; ++i )
+                { p[i] = alloc(); }
+                Escape( p );
+                for( u32 i=0; i<MemoryCountPerThread; ++i )
+                { release( p[i] ); }
+            }
+        });
+    };
+    auto cross = []( void* (*alloc)(), void (*release)( void* ) )
+    {
+        asdx::ParallelFor( threads, 1, [=]( u32 begin, u32 end )
+        {
+            for( u32 t=begin; t<end; ++t )
+            {
+                auto p = &mtPtrs[size_t( t ) * MemoryCountPerThread];
+                for( u32 i=0; i<MemoryCountPerThread; ++i )
+                { p[i] = alloc(); }
+                Escape( p );
+            }
+        });
+        asdx::ParallelFor( threads, 1, [=]( u32 begin, u32 end )
+        {
+            for( u32 t=begin; t<end; ++t )
+            {
+                auto p = &mtPtrs[size_t( ( t + 1 ) % threads ) * MemoryCountPerThread];
+                for( u32 i=0; i<MemoryCountPerThread; ++i )
+                { release( p[i] ); }
+            }
+        });
+    };
+
+    static void* (*mallocFunc)() = []() { return malloc( sizeof(PoolObject) ); };
+    static void  (*freeFunc)( void* ) = []( void* p ) { free( p ); };
+    static void* (*poolAlloc)() = []() { return pool.Alloc(); };
+    static void  (*poolFree)( void* ) = []( void* p ) { pool.Free( p ); };
+
+    suite.Add( g, names[0].c_str(), "throughput", items, [=]() { local( mallocFunc, freeFunc ); } );
+    suite.Add( g, names[1].c_str(), "throughput", items, [=]() { local( poolAlloc,  poolFree ); } );
+    suite.Add( g, names[2].c_str(), "throughput", items, [=]() { cross( mallocFunc, freeFunc ); } );
+    suite.Add( g, names[3].c_str(), "throughput", items, [=]() { cross( poolAlloc,  poolFree ); } );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshScene structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MeshScene
+{
+    std::vector<asdx::Vector3>      Positions;  //!< 頂点座標です.
+    std::vector<u32>                Indices;    //!< 三角形ごとに3つ並んだ頂点番号です.
+    std::vector<asdx::BoundingBox>  Bounds;     //!< 三角形のバウンディングボックスです.
+    std::vector<asdx::Ray>          Rays;       //!< 探索に使うレイです.
+    asdx::Bvh                       Bvh;        //!< 構築済みの階層です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      起伏のある地形のような格子状のメッシュを生成します.
+    //---------------------------------------------------------------------------------------------
+    MeshScene()
+    {
+        asdx::Random random( 8642 );
+        const u32 n = MeshGridSize;
+        for( u32 z=0; z<=n; ++z )
+        {
+            for( u32 x=0; x<=n; ++x )
+            {
+                auto fx = -10.0f + 20.0f * x / n;
+                auto fz = -10.0f + 20.0f * z / n;
+                auto fy = sinf( fx * 1.3f ) * cosf( fz * 0.7f ) + random.GetAsF32( -0.05f, 0.05f );
+                Positions.push_back( asdx::Vector3( fx, fy, fz ) );
+            }
+        }
+        for( u32 z=0; z<n; ++z )
+        {
+            for( u32 x=0; x<n; ++x )
+            {
+                auto i0 = z * ( n + 1 ) + x;
+                auto i1 = i0 + 1;
+                auto i2 = i0 + ( n + 1 );
+                auto i3 = i2 + 1;
+                u32 quad[6] = { i0, i2, i1, i1, i2, i3 };
+                Indices.insert( Indices.end(), quad, quad + 6 );
+            }
+        }
+
+        Bounds.resize( GetTriangleCount() );
+        asdx::ComputeTriangleBounds( Positions.data(), Indices.data(), GetTriangleCount(), Bounds.data() );
+        Bvh.Build( Bounds.data(), GetTriangleCount() );
+
+        // 上空から斜めに地表へ向かうレイ.
+        for( u32 i=0; i<BvhRays; ++i )
+        {
+            asdx::Vector3 origin( random.GetAsF32( -10.0f, 10.0f ), 5.0f, random.GetAsF32( -10.0f, 10.0f ) );
+            asdx::Vector3 dir( random.GetAsF32( -1.0f, 1.0f ), -1.0f, random.GetAsF32( -1.0f, 1.0f ) );
+            Rays.push_back( asdx::Ray( origin, dir ) );
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      三角形の数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetTriangleCount() const
+    { return static_cast<u32>( Indices.size() / 3 ); }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      三角形メッシュを取得します.
+//!
+//! @note       生成に時間がかかるので, 最初に計測するときに生成します.
+//-------------------------------------------------------------------------------------------------
+MeshScene& GetMeshScene()
+{
+    static MeshScene scene;
+    return scene;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BoxScene structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BoxScene
+{
+    std::vector<asdx::BoundingBox>  Boxes;      //!< [-10, 10]^3 に散らばった小さなボックスです.
+    std::vector<asdx::Ray>          Rays;       //!< 探索に使うレイです.
+    asdx::Bvh                       Bvh;        //!< 構築済みの階層です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ボックスとレイを生成して階層を構築します.
+    //---------------------------------------------------------------------------------------------
+    BoxScene()
+    {
+        asdx::Random random( 4321 );
+        for( u32 i=0; i<BvhPrimitives; ++i )
+        {
+            asdx::Vector3 center( random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ) );
+            asdx::Vector3 extent( random.GetAsF32( 0.01f, 0.1f ), random.GetAsF32( 0.01f, 0.1f ), random.GetAsF32( 0.01f, 0.1f ) );
+            Boxes.push_back( asdx::BoundingBox( center - extent, center + extent ) );
+        }
+        for( u32 i=0; i<BvhRays; ++i )
+        {
+            asdx::Vector3 origin( random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ), -20.0f );
+            asdx::Vector3 target( random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ),  20.0f );
+            Rays.push_back( asdx::Ray( origin, target - origin ) );
+        }
+        Bvh.Build( Boxes.data(), BvhPrimitives );
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ボックスのシーンを取得します.
+//!
+//! @note       最初に計測するときに生成します.
+//-------------------------------------------------------------------------------------------------
+BoxScene& GetBoxScene()
+{
+    static BoxScene scene;
+    return scene;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      BVH の構築と探索を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterBvh( BenchmarkSuite& suite )
+{
+    const char* g = "Bvh";
+    suite.Add( g, "Build", "throughput", BvhPrimitives, []()
+    {
+        auto& scene = GetBoxScene();
+        asdx::Bvh temp;
+        temp.Build( scene.Boxes.data(), BvhPrimitives );
+        Escape( &temp );
+    });
+    suite.Add( g, "Refit", "throughput", BvhPrimitives, []()
+    {
+        auto& scene = GetBoxScene();
+        scene.Bvh.Refit( scene.Boxes.data() );
+        Escape( &scene.Bvh );
+    });
+    suite.Add( g, "Intersect", "throughput", BvhRays, []()
+    {
+        auto& scene = GetBoxScene();
+        u32 hitCount = 0;
+        for( u32 i=0; i<BvhRays; ++i )
+        {
+            auto ray    = scene.Rays[i];
+            auto invDir = asdx::Vector3( 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z );
+            auto hit = scene.Bvh.Intersect( ray, [&]( u32 index, asdx::Ray& r )
+            {
+                f32 t;
+                if ( !asdx::IntersectRayBox( r.Origin, invDir, scene.Boxes[index], r.TMin, r.TMax, t ) )
+                { return false; }
+                r.TMax = t;
+                return true;
+            });
+            hitCount += hit ? 1 : 0;
+        }
+        Escape( &hitCount );
+    });
+    suite.Add( g, "Query (Frustum)", "throughput", 1, []()
+    {
+        auto& scene = GetBoxScene();
+        auto view = asdx::Matrix::CreateLookAt( asdx::Vector3( 0.0f, 0.0f, -20.0f ), asdx::Vector3( 0.0f, 0.0f, 0.0f ), asdx::Vector3( 0.0f, 1.0f, 0.0f ) );
+        auto proj = asdx::Matrix::CreatePerspectiveFieldOfView( asdx::ToRadian( 30.0f ), 1.0f, 0.1f, 100.0f );
+        auto frustum = asdx::Frustum::CreateFromMatrix( view * proj );
+
+        u32 visibleCount = 0;
+        scene.Bvh.Query( frustum, [&]( u32 ) { visibleCount++; } );
+        Escape( &visibleCount );
+    });
+
+    const auto meshTriangles = MeshGridSize * MeshGridSize * 2;
+    suite.Add( g, "Build (Mesh 1M)", "throughput", meshTriangles, []()
+    {
+        auto& scene = GetMeshScene();
+        asdx::Bvh temp;
+        temp.Build( scene.Bounds.data(), scene.GetTriangleCount() );
+        Escape( &temp );
+    });
+    suite.Add( g, "IntersectTriangles (Mesh 1M)", "throughput", BvhRays, []()
+    {
+        auto& scene = GetMeshScene();
+        u32 hitCount = 0;
+        for( u32 i=0; i<BvhRays; ++i )
+        {
+            auto ray = scene.Rays[i];
+            asdx::BvhHit hit;
+            hitCount += asdx::IntersectTriangles( scene.Bvh, scene.Positions.data(), scene.Indices.data(), ray, hit ) ? 1 : 0;
+        }
+        Escape( &hitCount );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ノードごとに確保する素朴なシーングラフのノードです. 比較用です.
+//-------------------------------------------------------------------------------------------------
+struct NaiveSceneNode
+{
+    asdx::Vector3                   Translation;    //!< ローカルの平行移動です.
+    asdx::Quaternion                Rotation;       //!< ローカルの回転です.
+    asdx::Vector3                   Scale;          //!< ローカルのスケールです.
+    asdx::Matrix                    World;          //!< ワールド行列です.
+    std::vector<NaiveSceneNode*>    Children;       //!< 子ノードです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      子孫を含めてワールド行列を再帰的に更新します.
+    //---------------------------------------------------------------------------------------------
+    void Update( const asdx::Matrix& parent )
+    {
+        World = asdx::Matrix::CreateScale( Scale )
+              * asdx::Matrix::CreateFromQuaternion( Rotation )
+              * asdx::Matrix::CreateTranslation( Translation )
+              * parent;
+
+        for( size_t i=0; i<Children.size(); ++i )
+        { Children[i]->Update( World ); }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TransformScene structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TransformScene
+{
+    asdx::TransformHierarchy        Hierarchy;  //!< 階層姿勢です.
+    std::vector<u32>                Ids;        //!< 生成順のノード番号です.
+    std::vector<u32>                DirtyIds;   //!< 毎回変更するノード番号です.
+    std::vector<asdx::Quaternion>   Rotations;  //!< 変更後の回転です.
+    std::vector<NaiveSceneNode>     NaiveNodes; //!< 比較用のノードです.
+    std::vector<NaiveSceneNode*>    NaiveRoots; //!< 比較用のルートノードです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      同じ形の階層を2通りの方法で生成します.
+    //---------------------------------------------------------------------------------------------
+    TransformScene()
+    {
+        // 親を既存のノードから一様に選ぶので, 深さは平均 ln(N) 程度になる.
+        asdx::Random random( 1357 );
+        Hierarchy .Reserve( HierarchyNodes );
+        Ids       .reserve( HierarchyNodes );
+        NaiveNodes.resize ( HierarchyNodes );
+        for( u32 i=0; i<HierarchyNodes; ++i )
+        {
+            auto parent = ( i < HierarchyRoots ) ? asdx::TransformHierarchy::InvalidId : random.GetAsU32() % i;
+            auto t = asdx::Vector3( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) );
+            auto r = asdx::Quaternion::CreateFromYawPitchRoll( random.GetAsF32( -0.1f, 0.1f ), random.GetAsF32( -0.1f, 0.1f ), random.GetAsF32( -0.1f, 0.1f ) );
+            auto s = asdx::Vector3( 1.0f, 1.0f, 1.0f );
+
+            Ids.push_back( Hierarchy.Add( ( parent != asdx::TransformHierarchy::InvalidId ) ? Ids[parent] : parent, t, r, s ) );
+
+            auto& node = NaiveNodes[i];
+            node.Translation = t;
+            node.Rotation    = r;
+            node.Scale       = s;
+            if ( parent != asdx::TransformHierarchy::InvalidId )
+            { NaiveNodes[parent].Children.push_back( &node ); }
+            else
+            { NaiveRoots.push_back( &node ); }
+        }
+        Hierarchy.Update();
+
+        // 毎回 1% のノードを変更する.
+        for( u32 i=0; i<HierarchyNodes / 100; ++i )
+        {
+            DirtyIds .push_back( Ids[random.GetAsU32() % HierarchyNodes] );
+            Rotations.push_back( asdx::Quaternion::CreateFromYawPitchRoll( random.GetAsF32( -0.1f, 0.1f ), 0.0f, 0.0f ) );
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      階層姿勢のシーンを取得します.
+//!
+//! @note       最初に計測するときに生成します.
+//-------------------------------------------------------------------------------------------------
+TransformScene& GetTransformScene()
+{
+    static TransformScene scene;
+    return scene;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      階層姿勢の更新を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterTransform( BenchmarkSuite& suite )
+{
+    const char* g = "Transform";
+    suite.Add( g, "Hierarchy Update (All)", "throughput", HierarchyNodes, []()
+    {
+        auto& scene = GetTransformScene();
+        scene.Hierarchy.Invalidate();
+        scene.Hierarchy.Update();
+        Escape( scene.Hierarchy.GetWorldMatrices() );
+    });
+    suite.Add( g, "Hierarchy Update (1%)", "throughput", HierarchyNodes, []()
+    {
+        auto& scene = GetTransformScene();
+        for( size_t i=0; i<scene.DirtyIds.size(); ++i )
+        { scene.Hierarchy.SetRotation( scene.DirtyIds[i], scene.Rotations[i] ); }
+        scene.Hierarchy.Update();
+        Escape( scene.Hierarchy.GetWorldMatrices() );
+    });
+    suite.Add( g, "Recursive Update (All)", "throughput", HierarchyNodes, []()
+    {
+        auto& scene = GetTransformScene();
+        auto identity = asdx::Matrix::Identity();
+        for( size_t i=0; i<scene.NaiveRoots.size(); ++i )
+        { scene.NaiveRoots[i]->Update( identity ); }
+        Escape( scene.NaiveNodes.data() );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      仮想関数で更新するオブジェクトです. 比較用です.
+//-------------------------------------------------------------------------------------------------
+class VirtualObject
+{
+public:
+    asdx::Vector3   Position;   //!< 位置です.
+    asdx::Vector3   Velocity;   //!< 速度です.
+
+    virtual ~VirtualObject()
+    { /* DO_NOTHING */ }
+
+    virtual void OnFrameMove( f32 elapsedSec )
+    { Position += Velocity * elapsedSec; }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// EntityScene structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct EntityScene
+{
+    struct Position { asdx::Vector3 Value; };
+    struct Velocity { asdx::Vector3 Value; };
+
+    asdx::EntityWorld                            World;     //!< エンティティです.
+    std::vector<std::unique_ptr<VirtualObject>>  Objects;   //!< 比較用の仮想関数で更新するオブジェクトです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      同じ値を持つエンティティとオブジェクトを生成します.
+    //---------------------------------------------------------------------------------------------
+    EntityScene()
+    {
+        asdx::Random random( 9753 );
+        for( u32 i=0; i<EntityCount; ++i )
+        {
+            asdx::Vector3 p( random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ) );
+            asdx::Vector3 v( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) );
+            World.Create( Position{ p }, Velocity{ v } );
+
+            Objects.push_back( std::unique_ptr<VirtualObject>( new VirtualObject() ) );
+            Objects.back()->Position = p;
+            Objects.back()->Velocity = v;
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      エンティティのシーンを取得します.
+//!
+//! @note       最初に計測するときに生成します.
+//-------------------------------------------------------------------------------------------------
+EntityScene& GetEntityScene()
+{
+    static EntityScene scene;
+    return scene;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      エンティティの更新を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterEntity( BenchmarkSuite& suite )
+{
+    typedef EntityScene::Position Position;
+    typedef EntityScene::Velocity Velocity;
+
+    const char* g = "Entity";
+    suite.Add( g, "Each (Position += Velocity)", "throughput", EntityCount, []()
+    {
+        auto& scene = GetEntityScene();
+        scene.World.Each<Position, const Velocity>( []( u32 count, const asdx::Entity*, Position* p, const Velocity* v )
+        {
+            for( u32 i=0; i<count; ++i )
+            { p[i].Value += v[i].Value * ( 1.0f / 60.0f ); }
+        });
+        Escape( &scene.World );
+    });
+    suite.Add( g, "EachParallel (Position += Velocity)", "throughput", EntityCount, []()
+    {
+        auto& scene = GetEntityScene();
+        scene.World.EachParallel<Position, const Velocity>( []( u32 count, const asdx::Entity*, Position* p, const Velocity* v )
+        {
+            for( u32 i=0; i<count; ++i )
+            { p[i].Value += v[i].Value * ( 1.0f / 60.0f ); }
+        });
+        Escape( &scene.World );
+    });
+    suite.Add( g, "Virtual OnFrameMove", "throughput", EntityCount, []()
+    {
+        auto& scene = GetEntityScene();
+        for( size_t i=0; i<scene.Objects.size(); ++i )
+        { scene.Objects[i]->OnFrameMove( 1.0f / 60.0f ); }
+        Escape( scene.Objects.data() );
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ShScene structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ShScene
+{
+    asdx::SH9                   Sh;             //!< 評価する係数です.
+    std::vector<asdx::Vector3>  Normals;        //!< 評価する法線です.
+    std::vector<asdx::Vector3>  Irradiance;     //!< 放射照度の出力先です.
+    std::vector<asdx::Vector3>  Directions;     //!< キューブマップのテクセルの方向です.
+    std::vector<f32>            Weights;        //!< キューブマップのテクセルの立体角です.
+    std::vector<asdx::Vector3>  Texels;         //!< プローブごとのキューブマップのテクセルです.
+    std::vector<asdx::SH9>      Probes;         //!< 射影の出力先です.
+    asdx::SHProjector           Projector;      //!< 射影の前計算です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      係数とキューブマップを生成します.
+    //---------------------------------------------------------------------------------------------
+    ShScene()
+    {
+        asdx::Random random( 2468 );
+        for( u32 i=0; i<9; ++i )
+        { Sh.c[i] = asdx::Vector3( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) ); }
+
+        Normals.resize( ShNormals );
+        Irradiance.resize( ShNormals );
+        for( u32 i=0; i<ShNormals; ++i )
+        { Normals[i] = asdx::Vector3::Normalize( asdx::Vector3( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( 0.1f, 1.0f ) ) ); }
+
+        asdx::CreateCubemapSampleSet( ShCubemapSize, Directions, Weights );
+        Projector.Init( Directions.data(), Weights.data(), static_cast<u32>( Directions.size() ) );
+
+        Texels.resize( Directions.size() * ShProbes );
+        for( size_t i=0; i<Texels.size(); ++i )
+        { Texels[i] = asdx::Vector3( random.GetAsF32( 0.0f, 4.0f ), random.GetAsF32( 0.0f, 4.0f ), random.GetAsF32( 0.0f, 4.0f ) ); }
+        Probes.resize( ShProbes );
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      球面調和関数のシーンを取得します.
+//!
+//! @note       最初に計測するときに生成します.
+//-------------------------------------------------------------------------------------------------
+ShScene& GetShScene()
+{
+    static ShScene scene;
+    return scene;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      球面調和関数の評価と射影を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterSphericalHarmonics( BenchmarkSuite& suite )
+{
+    const char* g = "SphericalHarmonics";
+    suite.Add( g, "EvaluateIrradiance (Scalar)", "throughput", ShNormals, []()
+    {
+        auto& scene = GetShScene();
+        for( u32 i=0; i<ShNormals; ++i )
+        { scene.Irradiance[i] = asdx::EvaluateIrradiance( scene.Sh, scene.Normals[i] ); }
+        Escape( scene.Irradiance.data() );
+    });
+    suite.Add( g, "EvaluateIrradianceStream", "throughput", ShNormals, []()
+    {
+        auto& scene = GetShScene();
+        asdx::EvaluateIrradianceStream( scene.Sh, scene.Normals.data(), ShNormals, scene.Irradiance.data() );
+        Escape( scene.Irradiance.data() );
+    });
+    suite.Add( g, "ProjectSH (Scalar)", "throughput", ShProbes, []()
+    {
+        auto& scene = GetShScene();
+        auto sampleCount = static_cast<u32>( scene.Directions.size() );
+        for( u32 i=0; i<ShProbes; ++i )
+        { asdx::ProjectSH( scene.Directions.data(), scene.Weights.data(), scene.Texels.data() + size_t( i ) * sampleCount, sampleCount, scene.Probes[i] ); }
+        Escape( scene.Probes.data() );
+    });
+    suite.Add( g, "SHProjector::Project", "throughput", ShProbes, []()
+    {
+        auto& scene = GetShScene();
+        auto sampleCount = scene.Projector.GetSampleCount();
+        for( u32 i=0; i<ShProbes; ++i )
+        { scene.Projector.Project( scene.Texels.data() + size_t( i ) * sampleCount, scene.Probes[i] ); }
+        Escape( scene.Probes.data() );
+    });
+    suite.Add( g, "SHProjector::ProjectParallel", "throughput", ShProbes, []()
+    {
+        auto& scene = GetShScene();
+        scene.Projector.ProjectParallel( scene.Texels.data(), ShProbes, scene.Probes.data() );
+        Escape( scene.Probes.data() );
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BroadphaseScene structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BroadphaseScene
+{
+    std::vector<asdx::Vector3>          Positions;  //!< 位置です.
+    std::vector<asdx::Vector3>          Velocities; //!< 速度です.
+    std::vector<asdx::Vector3>          Extents;    //!< ボックスの半径です.
+    std::vector<asdx::BoundingBox>      Bounds;     //!< ボックスです.
+    std::vector<u32>                    Proxies;    //!< 木に登録したプロキシです.
+    std::vector<asdx::BroadphasePair>   Pairs;      //!< ペアの出力先です.
+    asdx::DynamicAabbTree               Tree;       //!< 動的 AABB 木です.
+    asdx::SweepAndPrune                 Sap;        //!< Sweep and Prune です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      物体を配置して木に登録します.
+    //---------------------------------------------------------------------------------------------
+    BroadphaseScene()
+    {
+        const auto size = BroadphaseWorldSize;
+
+        asdx::Random random( 1357 );
+        Positions .resize( BroadphaseCount );
+        Velocities.resize( BroadphaseCount );
+        Extents   .resize( BroadphaseCount );
+        Bounds    .resize( BroadphaseCount );
+        Proxies   .resize( BroadphaseCount );
+        for( u32 i=0; i<BroadphaseCount; ++i )
+        {
+            Positions [i] = asdx::Vector3( random.GetAsF32( -size, size ), random.GetAsF32( -size, size ), random.GetAsF32( -size, size ) );
+            Velocities[i] = asdx::Vector3( random.GetAsF32( -0.05f, 0.05f ), random.GetAsF32( -0.05f, 0.05f ), random.GetAsF32( -0.05f, 0.05f ) );
+            Extents   [i] = asdx::Vector3( random.GetAsF32( 0.25f, 0.75f ), random.GetAsF32( 0.25f, 0.75f ), random.GetAsF32( 0.25f, 0.75f ) );
+            Bounds    [i] = asdx::BoundingBox( Positions[i] - Extents[i], Positions[i] + Extents[i] );
+            Proxies   [i] = Tree.CreateProxy( Bounds[i], i );
+        }
+        Tree.FindPairs( Pairs );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      壁で跳ね返りながら等速で動かします.
+    //---------------------------------------------------------------------------------------------
+    void Step()
+    {
+        const auto size = BroadphaseWorldSize;
+        for( u32 i=0; i<BroadphaseCount; ++i )
+        {
+            auto& p = Positions [i];
+            auto& v = Velocities[i];
+            p += v;
+            if ( p.x < -size || p.x > size ) { v.x = -v.x; }
+            if ( p.y < -size || p.y > size ) { v.y = -v.y; }
+            if ( p.z < -size || p.z > size ) { v.z = -v.z; }
+            Bounds[i] = asdx::BoundingBox( p - Extents[i], p + Extents[i] );
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ブロードフェーズのシーンを取得します.
+//!
+//! @note       最初に計測するときに生成します.
+//-------------------------------------------------------------------------------------------------
+BroadphaseScene& GetBroadphaseScene()
+{
+    static BroadphaseScene scene;
+    return scene;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ブロードフェーズのペア生成を登録します.
+//!
+//! @note       1回の計測で全ての物体を1ステップ動かしてからペアを求めます.
+//-------------------------------------------------------------------------------------------------
+void RegisterBroadphase( BenchmarkSuite& suite )
+{
+    const char* g = "Broadphase";
+    suite.Add( g, "DynamicAabbTree MoveProxy + FindPairs", "throughput", BroadphaseCount, []()
+    {
+        auto& scene = GetBroadphaseScene();
+        scene.Step();
+        for( u32 i=0; i<BroadphaseCount; ++i )
+        { scene.Tree.MoveProxy( scene.Proxies[i], scene.Bounds[i], scene.Velocities[i] ); }
+        scene.Tree.FindPairs( scene.Pairs );
+        Escape( scene.Pairs.data() );
+    });
+    suite.Add( g, "DynamicAabbTree MoveProxies + FindPairs", "throughput", BroadphaseCount, []()
+    {
+        auto& scene = GetBroadphaseScene();
+        scene.Step();
+        scene.Tree.MoveProxies( scene.Proxies.data(), scene.Bounds.data(), scene.Velocities.data(), BroadphaseCount );
+        scene.Tree.FindPairs( scene.Pairs );
+        Escape( scene.Pairs.data() );
+    });
+    suite.Add( g, "SweepAndPrune FindPairs", "throughput", BroadphaseCount, []()
+    {
+        auto& scene = GetBroadphaseScene();
+        scene.Step();
+        scene.Sap.FindPairs( scene.Bounds.data(), BroadphaseCount, scene.Pairs );
+        Escape( scene.Pairs.data() );
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IntersectionScene structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IntersectionScene
+{
+    asdx::Vector3       Positions[TriangleCount * 3];   //!< 三角形の頂点です.
+    asdx::Ray           Rays[IntersectionRays];         //!< 原点から +Z 方向へ広がるレイです.
+    asdx::BoxPacket8    Boxes;                          //!< 8個のボックスです.
+    asdx::BoundingBox   BoxArray[8];                    //!< Boxes と同じボックスです.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      三角形とレイとボックスを生成します.
+    //---------------------------------------------------------------------------------------------
+    IntersectionScene()
+    {
+        asdx::Random random( 2468 );
+        for( u32 i=0; i<TriangleCount * 3; ++i )
+        { Positions[i] = asdx::Vector3( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( 1.0f, 2.0f ) ); }
+        for( u32 i=0; i<IntersectionRays; ++i )
+        {
+            auto dir = asdx::Vector3( random.GetAsF32( -0.3f, 0.3f ), random.GetAsF32( -0.3f, 0.3f ), 1.0f );
+            Rays[i] = asdx::Ray( asdx::Vector3( 0.0f, 0.0f, 0.0f ), dir );
+        }
+        Boxes.Reset();
+        for( u32 i=0; i<8; ++i )
+        {
+            auto center = asdx::Vector3( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( 1.0f, 2.0f ) );
+            BoxArray[i] = asdx::BoundingBox( center - asdx::Vector3( 0.2f, 0.2f, 0.2f ), center + asdx::Vector3( 0.2f, 0.2f, 0.2f ) );
+            Boxes.Set( i, BoxArray[i] );
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      交差判定のシーンを取得します.
+//!
+//! @note       最初に計測するときに生成します.
+//-------------------------------------------------------------------------------------------------
+IntersectionScene& GetIntersectionScene()
+{
+    static IntersectionScene scene;
+    return scene;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PacketScene structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<u32 N>
+struct PacketScene
+{
+    static const u32 PacketCount = IntersectionRays / N;
+    static_assert( IntersectionRays % N == 0, "Packet width must divide the ray count." );
+
+    asdx::RayPacket<N>          Rays [PacketCount];     //!< IntersectionScene のレイを N 本ずつまとめたパケットです.
+    asdx::WatertightPacket<N>   Shear[PacketCount];     //!< 水密な判定に使う剪断変換です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      レイをパケットにまとめます.
+    //---------------------------------------------------------------------------------------------
+    PacketScene()
+    {
+        auto& scene = GetIntersectionScene();
+        for( u32 p=0; p<PacketCount; ++p )
+        {
+            for( u32 i=0; i<N; ++i )
+            { Rays[p].Set( i, scene.Rays[p * N + i] ); }
+            Shear[p].Init( Rays[p] );
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      N 本のレイパケットを取得します.
+//!
+//! @note       最初に計測するときに生成します.
+//-------------------------------------------------------------------------------------------------
+template<u32 N>
+PacketScene<N>& GetPacketScene()
+{
+    static PacketScene<N> scene;
+    return scene;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      N 本のレイパケットと三角形の交差判定を登録します.
+//!
+//! @tparam     Watertight      水密な判定を計測する場合は true.
+//-------------------------------------------------------------------------------------------------
+template<u32 N, bool Watertight>
+void AddPacketTriangle( BenchmarkSuite& suite, const char* group )
+{
+    auto name = std::string( Watertight ? "IntersectPacketTriangleWatertight<" : "IntersectPacketTriangle<" ) + std::to_string( N ) + ">";
+    suite.Add( group, name.c_str(), "throughput", IntersectionRays * TriangleCount, []()
+    {
+        auto& scene   = GetIntersectionScene();
+        auto& packets = GetPacketScene<N>();
+        u32 hitMask = 0;
+        for( u32 p=0; p<PacketScene<N>::PacketCount; ++p )
+        {
+            // 交差すると TMax が更新されるので, 毎回同じ条件で計測するために複製する.
+            auto rays = packets.Rays[p];
+            asdx::PacketHit<N> hit;
+            hit.Reset();
+            for( u32 i=0; i<TriangleCount; ++i )
+            {
+                const auto& p0 = scene.Positions[i * 3 + 0];
+                const auto& p1 = scene.Positions[i * 3 + 1];
+                const auto& p2 = scene.Positions[i * 3 + 2];
+                hitMask |= Watertight
+                    ? asdx::IntersectPacketTriangleWatertight( rays, packets.Shear[p], p0, p1, p2, i, hit )
+                    : asdx::IntersectPacketTriangle( rays, p0, p1, p2, i, hit );
+            }
+            Escape( &hit );
+        }
+        Escape( &hitMask );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パケット交差判定とスカラー版を登録します.
+//-------------------------------------------------------------------------------------------------
+void RegisterIntersection( BenchmarkSuite& suite )
+{
+    const char* g = "Intersection";
+    suite.Add( g, "IntersectRayTriangle", "throughput", IntersectionRays * TriangleCount, []()
+    {
+        auto& scene = GetIntersectionScene();
+        u32 hitCount = 0;
+        for( u32 r=0; r<IntersectionRays; ++r )
+        {
+            for( u32 i=0; i<TriangleCount; ++i )
+            {
+                f32 t, u, v;
+                hitCount += asdx::IntersectRayTriangle( scene.Rays[r], scene.Positions[i * 3 + 0], scene.Positions[i * 3 + 1], scene.Positions[i * 3 + 2], t, u, v ) ? 1 : 0;
+            }
+        }
+        Escape( &hitCount );
+    });
+    suite.Add( g, "IntersectRayTriangleWatertight", "throughput", IntersectionRays * TriangleCount, []()
+    {
+        auto& scene = GetIntersectionScene();
+        u32 hitCount = 0;
+        for( u32 r=0; r<IntersectionRays; ++r )
+        {
+            for( u32 i=0; i<TriangleCount; ++i )
+            {
+                f32 t, u, v;
+                hitCount += asdx::IntersectRayTriangleWatertight( scene.Rays[r], scene.Positions[i * 3 + 0], scene.Positions[i * 3 + 1], scene.Positions[i * 3 + 2], t, u, v ) ? 1 : 0;
+            }
+        }
+        Escape( &hitCount );
+    });
+
+    // 4本は SSE, 8本と16本は AVX が有効なら8レーン単位で処理される.
+    AddPacketTriangle<4,  false>( suite, g );
+    AddPacketTriangle<8,  false>( suite, g );
+    AddPacketTriangle<16, false>( suite, g );
+    AddPacketTriangle<4,  true> ( suite, g );
+    AddPacketTriangle<8,  true> ( suite, g );
+    AddPacketTriangle<16, true> ( suite, g );
+
+    suite.Add( g, "IntersectRayBox", "throughput", IntersectionRays * 8, []()
+    {
+        auto& scene = GetIntersectionScene();
+        u32 hitCount = 0;
+        for( u32 r=0; r<IntersectionRays; ++r )
+        {
+            const auto& ray = scene.Rays[r];
+            auto invDir = asdx::Vector3( 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z );
+            for( u32 i=0; i<8; ++i )
+            {
+                f32 t;
+                hitCount += asdx::IntersectRayBox( ray.Origin, invDir, scene.BoxArray[i], 0.0f, FLT_MAX, t ) ? 1 : 0;
+            }
+        }
+        Escape( &hitCount );
+    });
+    suite.Add( g, "IntersectRayBoxes8", "throughput", IntersectionRays * 8, []()
+    {
+        auto& scene = GetIntersectionScene();
+        u32 hitMask = 0;
+        for( u32 r=0; r<IntersectionRays; ++r )
+        {
+            const auto& ray = scene.Rays[r];
+            auto invDir = asdx::Vector3( 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z );
+            hitMask ^= asdx::IntersectRayBoxes8( ray.Origin, invDir, scene.Boxes, 0.0f, FLT_MAX );
+        }
+        Escape( &hitMask );
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      有効な SIMD 命令セットの名前を取得します.
+//-------------------------------------------------------------------------------------------------
+const char* GetSimdName()
+{
+#if ASDX_SIMD_AVX2
+    return "AVX2";
+#elif ASDX_SIMD_AVX
+    return "AVX";
+#elif ASDX_SIMD_SSE2
+    return "SSE2";
+#else
+    return "None";
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      コンパイラの名前を取得します.
+//-------------------------------------------------------------------------------------------------
+std::string GetCompilerName()
+{
+    char buffer[256];
+#if defined(__clang__)
+    sprintf( buffer, "clang %s", __clang_version__ );
+#elif defined(__GNUC__)
+    sprintf( buffer, "gcc %s", __VERSION__ );
+#elif defined(_MSC_VER)
+    sprintf( buffer, "msvc %d", _MSC_VER );
+#else
+    sprintf( buffer, "unknown" );
+#endif
+    return buffer;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      JSON の文字列として出力します.
+//-------------------------------------------------------------------------------------------------
+void WriteJsonString( FILE* pFile, const std::string& value )
+{
+    fputc( '"', pFile );
+    for( size_t i=0; i<value.size(); ++i )
+    {
+        auto c = value[i];
+        if ( c == '"' || c == '\\' )
+        { fputc( '\\', pFile ); }
+        fputc( c, pFile );
+    }
+    fputc( '"', pFile );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      計測結果を JSON で保存します.
+//-------------------------------------------------------------------------------------------------
+bool SaveJson( const std::string& path, const BenchmarkConfig& config, const std::vector<BenchmarkResult>& results )
+{
+    auto pFile = fopen( path.c_str(), "w" );
+    if ( pFile == nullptr )
+    { return false; }
+
+    fprintf( pFile, "{\n" );
+    fprintf( pFile, "  \"config\": {\n" );
+    fprintf( pFile, "    \"simd\": \"%s\",\n", GetSimdName() );
+    fprintf( pFile, "    \"fma\": %s,\n", ASDX_SIMD_FMA ? "true" : "false" );
+    fprintf( pFile, "    \"fast_math\": %s,\n", ASDX_FAST_MATH ? "true" : "false" );
+    fprintf( pFile, "    \"compiler\": " );
+    WriteJsonString( pFile, GetCompilerName() );
+    fprintf( pFile, ",\n" );
+    fprintf( pFile, "    \"samples\": %u,\n", config.Samples );
+    fprintf( pFile, "    \"warmup_ms\": %.3f,\n", config.WarmupTime * 1e3 );
+    fprintf( pFile, "    \"sample_ms\": %.3f\n", config.SampleTime * 1e3 );
+    fprintf( pFile, "  },\n" );
+    fprintf( pFile, "  \"results\": [\n" );
+
+    for( size_t i=0; i<results.size(); ++i )
+    {
+        auto& r = results[i];
+        fprintf( pFile, "    { \"group\": " );
+        WriteJsonString( pFile, r.Group );
+        fprintf( pFile, ", \"name\": " );
+        WriteJsonString( pFile, r.Name );
+        fprintf( pFile, ", \"kind\": \"%s\", \"items\": %u, \"repeat\": %u, \"min_ns\": %.4f, \"median_ns\": %.4f, \"mean_ns\": %.4f, \"stddev_ns\": %.4f, \"mitems_per_sec\": %.4f }%s\n",
+            r.Kind.c_str(), r.Items, r.Repeat, r.Min, r.Median, r.Mean, r.StdDev,
+            ( r.Median > 0.0 ) ? 1e3 / r.Median : 0.0,
+            ( i + 1 < results.size() ) ? "," : "" );
+    }
+
+    fprintf( pFile, "  ]\n" );
+    fprintf( pFile, "}\n" );
+    fclose( pFile );
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    BenchmarkConfig config;
+    config.Samples    = 15;
+    config.WarmupTime = 0.02;
+    config.SampleTime = 0.002;
+
+    std::string output;
+    bool        list = false;
+
+    for( int i=1; i<argc; ++i )
+    {
+        auto hasValue = ( i + 1 < argc );
+        if      ( hasValue && strcmp( argv[i], "-filter"      ) == 0 ) { config.Filter     = argv[++i]; }
+        else if ( hasValue && strcmp( argv[i], "-samples"     ) == 0 ) { config.Samples    = static_cast<u32>( atoi( argv[++i] ) ); }
+        else if ( hasValue && strcmp( argv[i], "-warmup"      ) == 0 ) { config.WarmupTime = atof( argv[++i] ) * 1e-3; }
+        else if ( hasValue && strcmp( argv[i], "-sample-time" ) == 0 ) { config.SampleTime = atof( argv[++i] ) * 1e-3; }
+        else if ( hasValue && strcmp( argv[i], "-o"           ) == 0 ) { output            = argv[++i]; }
+        else if ( strcmp( argv[i], "-list" ) == 0 ) { list = true; }
+        else
+        {
+            fprintf( stderr, "Usage : %s [-filter text] [-samples count] [-warmup msec] [-sample-time msec] [-o result.json] [-list]\n", argv[0] );
+            return -1;
+        }
+    }
+
+    if ( config.Samples == 0 )
+    {
+        fprintf( stderr, "Error : Invalid Argument.\n" );
+        return -1;
+    }
+
+    // 登録したラムダ式がデータを参照するので, 計測が終わるまで解放しない.
+    static DataSet data;
+    data.Init( 1234 );
+
+    BenchmarkSuite suite;
+    RegisterVector2     ( suite, data );
+    RegisterVector3     ( suite, data );
+    RegisterVector4     ( suite, data );
+    RegisterMatrix      ( suite, data );
+    RegisterQuaternion  ( suite, data );
+    RegisterRandomAndF16( suite, data );
+    RegisterSoA         ( suite, data );
+    RegisterFastMath    ( suite, data );
+    RegisterMemory      ( suite );
+    RegisterBvh         ( suite );
+    RegisterIntersection( suite );
+    RegisterTransform   ( suite );
+    RegisterEntity      ( suite );
+    RegisterSphericalHarmonics( suite );
+    RegisterBroadphase  ( suite );
+
+    if ( list )
+    {
+        suite.List( config );
+        return 0;
+    }
+
+    printf( "SIMD : %s, FMA : %s, FastMath : %s, Compiler : %s\n",
+        GetSimdName(), ASDX_SIMD_FMA ? "on" : "off", ASDX_FAST_MATH ? "on" : "off", GetCompilerName().c_str() );
+
+    std::vector<BenchmarkResult> results;
+    suite.Run( config, results );
+
+    if ( !output.empty() )
+    {
+        if ( !SaveJson( output, config, results ) )
+        {
+            fprintf( stderr, "Error : Save Failed. path = %s\n", output.c_str() );
+            return -1;
+        }
+        printf( "Saved : %s\n", output.c_str() );
+    }
+
+    return 0;
+}
@@ -0,0 +1,956 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : PathTracer.cpp
+// Desc : CPU Reference Path Tracer.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// ウィンドウを使わずに画像ファイルへ出力するので, Linux 等のヘッドレス環境でも動作します.
+//
+//  ビルド例 (Linux) :
+//      g++ -std=c++14 -O2 -march=native -I../include PathTracer.cpp -o PathTracer -pthread
+//
+//  使用例 :
+//      PathTracer -w 512 -h 512 -spp 256 -o result.ppm
+//      PathTracer -obj bunny.obj -time 60 -o result.pfm
+//
+//  オプション :
+//      -w <幅> -h <高さ>     出力解像度 (既定値 512 x 512).
+//      -spp <数>             1ピクセルあたりのサンプル数 (既定値 64).
+//      -time <秒>            指定秒数を超えたらサンプル数に達していなくても終了します.
+//      -o <ファイル名>       出力先. 拡張子が .pfm の場合は線形値を, それ以外は sRGB の PPM を出力します.
+//      -obj <ファイル名>     箱の中に置くメッシュを OBJ から読み込みます (頂点と面のみ対応).
+//      -snapshot <数>        指定パス数ごとに途中結果を出力します.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <asdxMath.h>
+#include <asdxSimd.h>
+#include <asdxBvh.h>
+#include <asdxIntersection.h>
+#include <asdxParallel.h>
+#include <asdxRandom.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values.
+//-------------------------------------------------------------------------------------------------
+static const u32 TileSize           = 16;                       //!< タイルの一辺のピクセル数です.
+static const u32 PacketSize         = asdx::simd::FloatNWidth;  //!< 1次レイのパケットのレイ数です.
+static const u32 MaxBounce          = 16;                       //!< 最大反射回数です.
+static const u32 RouletteBounce     = 3;                        //!< ロシアンルーレットを開始する反射回数です.
+static const f32 RayEpsilon         = 1e-4f;                    //!< 自己交差を避けるためのオフセットです.
+static const f32 GlassIor           = 1.5f;                     //!< ガラスの屈折率です.
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MATERIAL_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum MATERIAL_TYPE
+{
+    MATERIAL_DIFFUSE = 0,       //!< 完全拡散面です.
+    MATERIAL_MIRROR,            //!< 完全鏡面です.
+    MATERIAL_GLASS,             //!< 誘電体です.
+    MATERIAL_LIGHT,             //!< 光源です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Material structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Material
+{
+    MATERIAL_TYPE   Type;       //!< 種類です.
+    asdx::Vector3   Color;      //!< 反射率, 光源の場合は放射輝度です.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Scene class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Scene
+{
+public:
+    std::vector<asdx::Vector3>  Positions;      //!< 頂点座標です.
+    std::vector<asdx::Vector3>  Normals;        //!< 頂点法線です.
+    std::vector<u32>            Indices;        //!< 三角形ごとの頂点番号です.
+    std::vector<u32>            MaterialIds;    //!< 三角形ごとのマテリアル番号です.
+    std::vector<Material>       Materials;      //!< マテリアルです.
+    std::vector<u32>            Lights;         //!< 光源の三角形番号です.
+    std::vector<f32>            LightCdf;       //!< 面積に比例した光源選択の累積分布です.
+    f32                         LightArea;      //!< 光源の総面積です.
+    asdx::Bvh                   Bvh;            //!< 三角形の階層です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      マテリアルを追加します.
+    //---------------------------------------------------------------------------------------------
+    u32 AddMaterial( MATERIAL_TYPE type, const asdx::Vector3& color )
+    {
+        Material material = { type, color };
+        Materials.push_back( material );
+        return static_cast<u32>( Materials.size() - 1 );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      三角形を追加します.
+    //---------------------------------------------------------------------------------------------
+    void AddTriangle( u32 i0, u32 i1, u32 i2, u32 material )
+    {
+        Indices.push_back( i0 );
+        Indices.push_back( i1 );
+        Indices.push_back( i2 );
+        MaterialIds.push_back( material );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      四角形を追加します. 頂点は表から見て反時計回りに与えます.
+    //---------------------------------------------------------------------------------------------
+    void AddQuad( const asdx::Vector3& p0, const asdx::Vector3& p1, const asdx::Vector3& p2, const asdx::Vector3& p3, u32 material )
+    {
+        auto n    = asdx::Vector3::Normalize( asdx::Vector3::Cross( p1 - p0, p2 - p0 ) );
+        auto base = static_cast<u32>( Positions.size() );
+        const asdx::Vector3 p[4] = { p0, p1, p2, p3 };
+        for( u32 i=0; i<4; ++i )
+        {
+            Positions.push_back( p[i] );
+            Normals  .push_back( n );
+        }
+        AddTriangle( base + 0, base + 1, base + 2, material );
+        AddTriangle( base + 0, base + 2, base + 3, material );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      球を追加します.
+    //---------------------------------------------------------------------------------------------
+    void AddSphere( const asdx::Vector3& center, f32 radius, u32 slices, u32 stacks, u32 material )
+    {
+        auto base = static_cast<u32>( Positions.size() );
+        for( u32 j=0; j<=stacks; ++j )
+        {
+            auto theta = asdx::F_PI * j / stacks;
+            for( u32 i=0; i<=slices; ++i )
+            {
+                auto phi = asdx::F_2PI * i / slices;
+                asdx::Vector3 n( sinf( theta ) * cosf( phi ), cosf( theta ), sinf( theta ) * sinf( phi ) );
+                Positions.push_back( center + n * radius );
+                Normals  .push_back( n );
+            }
+        }
+
+        for( u32 j=0; j<stacks; ++j )
+        {
+            for( u32 i=0; i<slices; ++i )
+            {
+                auto i0 = base + j * ( slices + 1 ) + i;
+                auto i1 = i0 + slices + 1;
+                if ( j != 0 )
+                { AddTriangle( i0, i0 + 1, i1, material ); }
+                if ( j != stacks - 1 )
+                { AddTriangle( i0 + 1, i1 + 1, i1, material ); }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      OBJ ファイルを読み込み, 指定した箱に収まるように配置します.
+    //---------------------------------------------------------------------------------------------
+    bool LoadObj( const char* path, const asdx::BoundingBox& fit, u32 material )
+    {
+        auto pFile = fopen( path, "r" );
+        if ( pFile == nullptr )
+        { return false; }
+
+        std::vector<asdx::Vector3> positions;
+        std::vector<u32>           indices;
+        asdx::BoundingBox          bounds;
+
+        char line[1024];
+        while( fgets( line, sizeof(line), pFile ) != nullptr )
+        {
+            if ( line[0] == 'v' && line[1] == ' ' )
+            {
+                asdx::Vector3 p( 0.0f, 0.0f, 0.0f );
+                sscanf( line + 2, "%f %f %f", &p.x, &p.y, &p.z );
+                positions.push_back( p );
+                bounds.Merge( p );
+            }
+            else if ( line[0] == 'f' && line[1] == ' ' )
+            {
+                // 多角形は扇状に分割します. "v/vt/vn" 形式と負の番号に対応します.
+                std::vector<u32> face;
+                char* pCursor = line + 2;
+                for(;;)
+                {
+                    char* pEnd = nullptr;
+                    auto value = strtol( pCursor, &pEnd, 10 );
+                    if ( pEnd == pCursor )
+                    { break; }
+
+                    auto index = ( value < 0 ) ? static_cast<long>( positions.size() ) + value : value - 1;
+                    if ( 0 <= index && index < static_cast<long>( positions.size() ) )
+                    { face.push_back( static_cast<u32>( index ) ); }
+
+                    pCursor = pEnd;
+                    while( *pCursor != '\0' && *pCursor != ' ' && *pCursor != '\t' )
+                    { pCursor++; }
+                }
+
+                for( size_t i=2; i<face.size(); ++i )
+                {
+                    indices.push_back( face[0] );
+                    indices.push_back( face[i - 1] );
+                    indices.push_back( face[i] );
+                }
+            }
+        }
+        fclose( pFile );
+
+        if ( positions.empty() || indices.empty() )
+        { return false; }
+
+        // 最も長い辺が収まるように一様に拡大縮小して, 底面に接地させる.
+        auto extent = bounds.Maxi - bounds.Mini;
+        auto space  = fit.Maxi - fit.Mini;
+        auto scale  = asdx::Min( space.x / extent.x, asdx::Min( space.y / extent.y, space.z / extent.z ) );
+        auto center = bounds.GetCenter();
+        asdx::Vector3 offset( ( fit.Mini.x + fit.Maxi.x ) * 0.5f, fit.Mini.y + extent.y * scale * 0.5f, ( fit.Mini.z + fit.Maxi.z ) * 0.5f );
+
+        auto base = static_cast<u32>( Positions.size() );
+        for( size_t i=0; i<positions.size(); ++i )
+        {
+            Positions.push_back( ( positions[i] - center ) * scale + offset );
+            Normals  .push_back( asdx::Vector3( 0.0f, 0.0f, 0.0f ) );
+        }
+
+        // 面積で重み付けした頂点法線を求める.
+        for( size_t i=0; i<indices.size(); i+=3 )
+        {
+            auto i0 = base + indices[i + 0];
+            auto i1 = base + indices[i + 1];
+            auto i2 = base + indices[i + 2];
+            auto n  = asdx::Vector3::Cross( Positions[i1] - Positions[i0], Positions[i2] - Positions[i0] );
+            Normals[i0] += n;
+            Normals[i1] += n;
+            Normals[i2] += n;
+            AddTriangle( i0, i1, i2, material );
+        }
+
+        for( size_t i=base; i<Normals.size(); ++i )
+        {
+            if ( Normals[i].LengthSq() > 0.0f )
+            { Normals[i].Normalize(); }
+        }
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      光源の一覧と階層を構築します.
+    //---------------------------------------------------------------------------------------------
+    void Build()
+    {
+        Lights   .clear();
+        LightCdf .clear();
+        LightArea = 0.0f;
+
+        auto triangleCount = static_cast<u32>( MaterialIds.size() );
+        for( u32 i=0; i<triangleCount; ++i )
+        {
+            if ( Materials[MaterialIds[i]].Type != MATERIAL_LIGHT )
+            { continue; }
+
+            const auto& p0 = Positions[Indices[i * 3 + 0]];
+            const auto& p1 = Positions[Indices[i * 3 + 1]];
+            const auto& p2 = Positions[Indices[i * 3 + 2]];
+            LightArea += asdx::Vector3::Cross( p1 - p0, p2 - p0 ).Length() * 0.5f;
+            Lights  .push_back( i );
+            LightCdf.push_back( LightArea );
+        }
+
+        std::vector<asdx::BoundingBox> bounds( triangleCount );
+        asdx::ComputeTriangleBounds( Positions.data(), Indices.data(), triangleCount, bounds.data() );
+        Bvh.Build( bounds.data(), triangleCount );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      最も近い交差を求めます.
+    //---------------------------------------------------------------------------------------------
+    bool Intersect( asdx::Ray& ray, asdx::BvhHit& hit ) const
+    { return asdx::IntersectTriangles( Bvh, Positions.data(), Indices.data(), ray, hit ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      区間内に遮蔽物があるかどうかを判定します.
+    //---------------------------------------------------------------------------------------------
+    bool Occluded( const asdx::Ray& ray ) const
+    {
+        return Bvh.IntersectAny( ray, [&]( u32 index, asdx::Ray& r )
+        {
+            f32 t, u, v;
+            return asdx::IntersectRayTriangle( r, GetVertex( index, 0 ), GetVertex( index, 1 ), GetVertex( index, 2 ), t, u, v );
+        });
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      三角形の頂点座標を取得します.
+    //---------------------------------------------------------------------------------------------
+    const asdx::Vector3& GetVertex( u32 triangle, u32 corner ) const
+    { return Positions[Indices[triangle * 3 + corner]]; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      交差位置の補間した法線を取得します.
+    //---------------------------------------------------------------------------------------------
+    asdx::Vector3 GetNormal( const asdx::BvhHit& hit ) const
+    {
+        const auto& n0 = Normals[Indices[hit.Index * 3 + 0]];
+        const auto& n1 = Normals[Indices[hit.Index * 3 + 1]];
+        const auto& n2 = Normals[Indices[hit.Index * 3 + 2]];
+        auto n = n0 * ( 1.0f - hit.U - hit.V ) + n1 * hit.U + n2 * hit.V;
+        if ( n.LengthSq() <= 0.0f )
+        { return GetFaceNormal( hit.Index ); }
+        return asdx::Vector3::Normalize( n );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      三角形の面法線を取得します.
+    //---------------------------------------------------------------------------------------------
+    asdx::Vector3 GetFaceNormal( u32 triangle ) const
+    {
+        const auto& p0 = GetVertex( triangle, 0 );
+        return asdx::Vector3::Normalize( asdx::Vector3::Cross( GetVertex( triangle, 1 ) - p0, GetVertex( triangle, 2 ) - p0 ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      光源上の点を面積に対して一様にサンプリングします.
+    //---------------------------------------------------------------------------------------------
+    void SampleLight( asdx::Random& random, asdx::Vector3& position, asdx::Vector3& normal, u32& triangle ) const
+    {
+        auto key = random.GetAsF32( LightArea );
+        auto idx = static_cast<u32>( std::lower_bound( LightCdf.begin(), LightCdf.end(), key ) - LightCdf.begin() );
+        triangle = Lights[asdx::Min( idx, static_cast<u32>( Lights.size() - 1 ) )];
+
+        auto su = sqrtf( random.GetAsF32() );
+        auto b1 = random.GetAsF32() * su;
+        auto b0 = 1.0f - su;
+
+        const auto& p0 = GetVertex( triangle, 0 );
+        const auto& p1 = GetVertex( triangle, 1 );
+        const auto& p2 = GetVertex( triangle, 2 );
+        position = p0 * b0 + p1 * ( su - b1 ) + p2 * b1;
+        normal   = GetFaceNormal( triangle );
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Camera structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Camera
+{
+    asdx::Vector3           Position;       //!< 位置です.
+    asdx::OrthonormalBasis  Basis;          //!< u が右, v が上, w が視線方向の基底です.
+    f32                     TanX;           //!< 水平方向の画角の正接です.
+    f32                     TanY;           //!< 垂直方向の画角の正接です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      カメラを設定します.
+    //---------------------------------------------------------------------------------------------
+    void Init( const asdx::Vector3& position, const asdx::Vector3& target, const asdx::Vector3& upward, f32 fovY, f32 aspect )
+    {
+        Position = position;
+        Basis.InitFromWV( target - position, upward );
+        TanY = tanf( fovY * 0.5f );
+        TanX = TanY * aspect;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      正規化スクリーン座標 [-1, 1] に対応するレイの方向を求めます.
+    //---------------------------------------------------------------------------------------------
+    asdx::Vector3 GetDirection( f32 sx, f32 sy ) const
+    { return asdx::Vector3::Normalize( Basis.w + Basis.u * ( sx * TanX ) + Basis.v * ( sy * TanY ) ); }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PrimaryPacket structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct PrimaryPacket
+{
+    asdx::RayPacket<PacketSize>     Rays;               //!< レイです. 交差が見つかると TMax が更新されます.
+    asdx::PacketHit<PacketSize>     Hit;                //!< 交差情報です.
+    ASDX_ALIGN(32) f32              InvDirX[PacketSize];    //!< 方向の逆数の X 成分です.
+    ASDX_ALIGN(32) f32              InvDirY[PacketSize];    //!< 方向の逆数の Y 成分です.
+    ASDX_ALIGN(32) f32              InvDirZ[PacketSize];    //!< 方向の逆数の Z 成分です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      i 番目のレイを設定します.
+    //---------------------------------------------------------------------------------------------
+    void SetRay( u32 i, const asdx::Ray& ray )
+    {
+        Rays.Set( i, ray );
+        InvDirX[i] = 1.0f / ray.Direction.x;
+        InvDirY[i] = 1.0f / ray.Direction.y;
+        InvDirZ[i] = 1.0f / ray.Direction.z;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      i 番目のレイの交差情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    bool GetHit( u32 i, asdx::BvhHit& hit ) const
+    {
+        hit.Index = Hit.Index[i];
+        hit.T     = Hit.T[i];
+        hit.U     = Hit.U[i];
+        hit.V     = Hit.V[i];
+        return hit.Index != UINT32_MAX;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パケット内のいずれかのレイがノードと交差するかどうかを判定します.
+//-------------------------------------------------------------------------------------------------
+bool IntersectPacketNode( const asdx::BvhNode& node, const PrimaryPacket& packet, f32& tnear )
+{
+    using namespace asdx::simd;
+    auto ox = LoadN( packet.Rays.OriginX );
+    auto oy = LoadN( packet.Rays.OriginY );
+    auto oz = LoadN( packet.Rays.OriginZ );
+    auto ix = LoadN( packet.InvDirX );
+    auto iy = LoadN( packet.InvDirY );
+    auto iz = LoadN( packet.InvDirZ );
+
+    auto x0 = MulN( SubN( SetN( node.Mini[0] ), ox ), ix );
+    auto x1 = MulN( SubN( SetN( node.Maxi[0] ), ox ), ix );
+    auto y0 = MulN( SubN( SetN( node.Mini[1] ), oy ), iy );
+    auto y1 = MulN( SubN( SetN( node.Maxi[1] ), oy ), iy );
+    auto z0 = MulN( SubN( SetN( node.Mini[2] ), oz ), iz );
+    auto z1 = MulN( SubN( SetN( node.Maxi[2] ), oz ), iz );
+
+    auto tmin = MaxN( MaxN( MinN( x0, x1 ), MinN( y0, y1 ) ), MaxN( MinN( z0, z1 ), SetN( 0.0f ) ) );
+    auto tmax = MinN( MinN( MaxN( x0, x1 ), MaxN( y0, y1 ) ), MinN( MaxN( z0, z1 ), LoadN( packet.Rays.TMax ) ) );
+
+    // 走査順は先頭のレイの進入距離で決めます. 1次レイはほぼ同じ方向を向くので十分です.
+    ASDX_ALIGN(32) f32 entry[PacketSize];
+    StoreN( entry, tmin );
+    tnear = entry[0];
+    return AnyLessEqualN( tmin, tmax );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイパケットで階層を走査して, 各レイの最も近い交差を求めます.
+//!
+//! @param [in]     stack       走査用のスタックです. 要素数は Bvh::GetDepth() + 1 以上必要です.
+//-------------------------------------------------------------------------------------------------
+void IntersectPacket( const Scene& scene, PrimaryPacket& packet, std::vector<u32>& stack )
+{
+    const auto* pNodes   = scene.Bvh.GetNodes();
+    const auto* pIndices = scene.Bvh.GetIndices();
+    if ( scene.Bvh.GetNodeCount() == 0 )
+    { return; }
+
+    f32 tnear;
+    if ( !IntersectPacketNode( pNodes[0], packet, tnear ) )
+    { return; }
+
+    // 節を取り出すと子を2つ積むので, 深さ d の節を調べている間は d + 2 個まで積まれる.
+    if ( stack.size() < scene.Bvh.GetDepth() + 1 )
+    { stack.resize( scene.Bvh.GetDepth() + 1 ); }
+
+    u32 top = 0;
+    stack[top++] = 0;
+
+    while( top > 0 )
+    {
+        const auto& node = pNodes[stack[--top]];
+        if ( node.IsLeaf() )
+        {
+            for( u32 i=0; i<node.Count; ++i )
+            {
+                auto index = pIndices[node.Offset + i];
+                asdx::IntersectPacketTriangle( packet.Rays, scene.GetVertex( index, 0 ), scene.GetVertex( index, 1 ), scene.GetVertex( index, 2 ), index, packet.Hit );
+            }
+            continue;
+        }
+
+        f32 tl, tr;
+        auto hitL = IntersectPacketNode( pNodes[node.Offset + 0], packet, tl );
+        auto hitR = IntersectPacketNode( pNodes[node.Offset + 1], packet, tr );
+        assert( top + 2 <= stack.size() );
+
+        // 近い方を後に積んで先に調べる.
+        if ( hitL && hitR )
+        {
+            stack[top++] = ( tl <= tr ) ? node.Offset + 1 : node.Offset + 0;
+            stack[top++] = ( tl <= tr ) ? node.Offset + 0 : node.Offset + 1;
+        }
+        else if ( hitL )
+        { stack[top++] = node.Offset + 0; }
+        else if ( hitR )
+        { stack[top++] = node.Offset + 1; }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Renderer class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Renderer
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    Renderer( const Scene& scene, const Camera& camera, u32 width, u32 height )
+    : m_Scene       ( scene )
+    , m_Camera      ( camera )
+    , m_Width       ( width )
+    , m_Height      ( height )
+    , m_TileX       ( ( width  + TileSize - 1 ) / TileSize )
+    , m_TileY       ( ( height + TileSize - 1 ) / TileSize )
+    , m_Pass        ( 0 )
+    , m_RayCount    ( 0 )
+    { m_Accum.resize( width * height, asdx::Vector3( 0.0f, 0.0f, 0.0f ) ); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      全ピクセルに1サンプルずつ追加します.
+    //---------------------------------------------------------------------------------------------
+    void RenderPass()
+    {
+        asdx::ParallelFor( m_TileX * m_TileY, 1, [this]( u32 begin, u32 end )
+        {
+            for( u32 i=begin; i<end; ++i )
+            { RenderTile( i ); }
+        });
+        m_Pass++;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      完了したパス数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u32 GetPassCount() const
+    { return m_Pass; }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      これまでに追跡したレイの数を取得します.
+    //---------------------------------------------------------------------------------------------
+    u64 GetRayCount() const
+    { return m_RayCount.load(); }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      画像を書き出します.
+    //!
+    //! @note       拡張子が .pfm の場合は平均放射輝度を, それ以外は sRGB に変換した PPM を出力します.
+    //---------------------------------------------------------------------------------------------
+    bool Save( const std::string& path ) const
+    {
+        auto pFile = fopen( path.c_str(), "wb" );
+        if ( pFile == nullptr )
+        { return false; }
+
+        auto scale = ( m_Pass > 0 ) ? 1.0f / m_Pass : 0.0f;
+        auto isPfm = ( path.size() >= 4 ) && ( path.compare( path.size() - 4, 4, ".pfm" ) == 0 );
+        if ( isPfm )
+        {
+            // PFM は下の行から格納します. 負のスケールはリトルエンディアンを表します.
+            fprintf( pFile, "PF\n%u %u\n-1.0\n", m_Width, m_Height );
+            std::vector<f32> row( m_Width * 3 );
+            for( u32 y=0; y<m_Height; ++y )
+            {
+                const auto* pSrc = &m_Accum[( m_Height - 1 - y ) * m_Width];
+                for( u32 x=0; x<m_Width; ++x )
+                {
+                    row[x * 3 + 0] = pSrc[x].x * scale;
+                    row[x * 3 + 1] = pSrc[x].y * scale;
+                    row[x * 3 + 2] = pSrc[x].z * scale;
+                }
+                fwrite( row.data(), sizeof(f32), row.size(), pFile );
+            }
+        }
+        else
+        {
+            fprintf( pFile, "P6\n%u %u\n255\n", m_Width, m_Height );
+            std::vector<u8> row( m_Width * 3 );
+            for( u32 y=0; y<m_Height; ++y )
+            {
+                const auto* pSrc = &m_Accum[y * m_Width];
+                for( u32 x=0; x<m_Width; ++x )
+                {
+                    row[x * 3 + 0] = ToSRGB( pSrc[x].x * scale );
+                    row[x * 3 + 1] = ToSRGB( pSrc[x].y * scale );
+                    row[x * 3 + 2] = ToSRGB( pSrc[x].z * scale );
+                }
+                fwrite( row.data(), sizeof(u8), row.size(), pFile );
+            }
+        }
+
+        fclose( pFile );
+        return true;
+    }
+
+private:
+    const Scene&                m_Scene;        //!< シーンです.
+    const Camera&               m_Camera;       //!< カメラです.
+    u32                         m_Width;        //!< 画像の横幅です.
+    u32                         m_Height;       //!< 画像の縦幅です.
+    u32                         m_TileX;        //!< 横方向のタイル数です.
+    u32                         m_TileY;        //!< 縦方向のタイル数です.
+    u32                         m_Pass;         //!< 完了したパス数です.
+    std::atomic<u64>            m_RayCount;     //!< 追跡したレイの数です.
+    std::vector<asdx::Vector3>  m_Accum;        //!< 放射輝度の累積値です.
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      線形値を 8bit の sRGB に変換します.
+    //---------------------------------------------------------------------------------------------
+    static u8 ToSRGB( f32 value )
+    {
+        value = asdx::Clamp( value, 0.0f, 1.0f );
+        value = ( value <= 0.0031308f ) ? value * 12.92f : 1.055f * powf( value, 1.0f / 2.4f ) - 0.055f;
+        return static_cast<u8>( value * 255.0f + 0.5f );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      タイルを描画します.
+    //---------------------------------------------------------------------------------------------
+    void RenderTile( u32 tile )
+    {
+        // スレッドの割り当てに依存しないようにタイルとパスから乱数を初期化する.
+        // 近い番号同士で系列が似ないように SplitMix64 で拡散してから種にする. 0以下は固定の種になるので正の値にする.
+        u64 state = ( static_cast<u64>( m_Pass ) << 32 ) | tile;
+        asdx::Random random( static_cast<s32>( ( asdx::detail::SplitMix64( state ) >> 33 ) | 1u ) );
+
+        auto x0 = ( tile % m_TileX ) * TileSize;
+        auto y0 = ( tile / m_TileX ) * TileSize;
+        auto x1 = asdx::Min( x0 + TileSize, m_Width );
+        auto y1 = asdx::Min( y0 + TileSize, m_Height );
+
+        u64 rayCount = 0;
+        PrimaryPacket packet;
+        std::vector<u32> stack( m_Scene.Bvh.GetDepth() + 1 );
+        for( auto y=y0; y<y1; ++y )
+        {
+            for( auto x=x0; x<x1; x+=PacketSize )
+            {
+                // 1次レイはパケットでまとめて追跡する. 画像の外にはみ出したレイは端のピクセルを複製する.
+                for( u32 i=0; i<PacketSize; ++i )
+                {
+                    auto px = asdx::Min( x + i, x1 - 1 );
+                    auto sx = ( 2.0f * ( px + random.GetAsF32() ) / m_Width  ) - 1.0f;
+                    auto sy = 1.0f - ( 2.0f * ( y  + random.GetAsF32() ) / m_Height );
+                    packet.SetRay( i, asdx::Ray( m_Camera.Position, m_Camera.GetDirection( sx, sy ) ) );
+                }
+                packet.Hit.Reset();
+                IntersectPacket( m_Scene, packet, stack );
+                rayCount += PacketSize;
+
+                for( u32 i=0; i<PacketSize && x + i < x1; ++i )
+                {
+                    asdx::BvhHit hit;
+                    auto valid = packet.GetHit( i, hit );
+                    auto L = Trace( packet.Rays.Get( i ), valid, hit, random, rayCount );
+                    m_Accum[y * m_Width + x + i] += L;
+                }
+            }
+        }
+
+        m_RayCount += rayCount;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1次レイの交差結果から経路を追跡して放射輝度を求めます.
+    //---------------------------------------------------------------------------------------------
+    asdx::Vector3 Trace( asdx::Ray ray, bool valid, asdx::BvhHit hit, asdx::Random& random, u64& rayCount ) const
+    {
+        asdx::Vector3 L( 0.0f, 0.0f, 0.0f );
+        asdx::Vector3 W( 1.0f, 1.0f, 1.0f );
+        auto specular = true;
+
+        for( u32 bounce=0; valid; ++bounce )
+        {
+            const auto& material = m_Scene.Materials[m_Scene.MaterialIds[hit.Index]];
+            auto  dir = asdx::Vector3::Normalize( ray.Direction );
+            auto  pos = ray.GetPoint( hit.T );
+            auto  ng  = m_Scene.GetFaceNormal( hit.Index );
+            auto  ns  = m_Scene.GetNormal( hit );
+            auto  into = asdx::Vector3::Dot( dir, ng ) < 0.0f;
+
+            // 面の向きをレイに対向させる.
+            if ( !into )
+            {
+                ng = -ng;
+                ns = -ns;
+            }
+            if ( asdx::Vector3::Dot( ns, dir ) > 0.0f )
+            { ns = ng; }
+
+            if ( material.Type == MATERIAL_LIGHT )
+            {
+                // 拡散面からの直接光は光源サンプリングで加算済み.
+                if ( specular && into )
+                { L += Mul( W, material.Color ); }
+                break;
+            }
+
+            if ( bounce >= MaxBounce )
+            { break; }
+
+            asdx::Vector3 next;
+            if ( material.Type == MATERIAL_DIFFUSE )
+            {
+                L += Mul( W, SampleDirectLight( pos + ng * RayEpsilon, ns, material.Color, random, rayCount ) );
+
+                // コサイン重み付きで半球をサンプリングすると重みは反射率のみになる.
+                asdx::OrthonormalBasis onb;
+                onb.InitFromW( ns );
+                auto r1  = random.GetAsF32();
+                auto phi = asdx::F_2PI * random.GetAsF32();
+                auto r   = sqrtf( r1 );
+                next = onb.u * ( r * cosf( phi ) ) + onb.v * ( r * sinf( phi ) ) + onb.w * sqrtf( asdx::Max( 0.0f, 1.0f - r1 ) );
+                W    = Mul( W, material.Color );
+                pos  = pos + ng * RayEpsilon;
+                specular = false;
+            }
+            else if ( material.Type == MATERIAL_MIRROR )
+            {
+                next = asdx::Vector3::Reflect( dir, ns );
+                W    = Mul( W, material.Color );
+                pos  = pos + ng * RayEpsilon;
+                specular = true;
+            }
+            else
+            {
+                // 反射と屈折を Fresnel 項の確率で選択する.
+                auto n1   = into ? 1.0f : GlassIor;
+                auto n2   = into ? GlassIor : 1.0f;
+                auto eta  = n1 / n2;
+                auto cosI = -asdx::Vector3::Dot( dir, ns );
+                auto k    = 1.0f - eta * eta * ( 1.0f - cosI * cosI );
+
+                auto reflect = true;
+                if ( k > 0.0f )
+                {
+                    auto cosT = sqrtf( k );
+                    auto fr   = asdx::Fresnel( n1, n2, into ? cosI : cosT );
+                    if ( random.GetAsF32() >= fr )
+                    {
+                        next    = dir * eta + ns * ( eta * cosI - cosT );
+                        pos     = pos - ng * RayEpsilon;
+                        reflect = false;
+                    }
+                }
+
+                if ( reflect )
+                {
+                    next = asdx::Vector3::Reflect( dir, ns );
+                    pos  = pos + ng * RayEpsilon;
+                }
+
+                W = Mul( W, material.Color );
+                specular = true;
+            }
+
+            // 寄与の小さい経路はロシアンルーレットで打ち切る.
+            if ( bounce >= RouletteBounce )
+            {
+                auto p = asdx::Clamp( asdx::Max( W.x, asdx::Max( W.y, W.z ) ), 0.05f, 0.95f );
+                if ( random.GetAsF32() >= p )
+                { break; }
+                W /= p;
+            }
+
+            ray   = asdx::Ray( pos, next );
+            valid = m_Scene.Intersect( ray, hit );
+            rayCount++;
+        }
+
+        return L;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      光源をサンプリングして拡散面の直接光を求めます.
+    //---------------------------------------------------------------------------------------------
+    asdx::Vector3 SampleDirectLight( const asdx::Vector3& pos, const asdx::Vector3& normal, const asdx::Vector3& albedo, asdx::Random& random, u64& rayCount ) const
+    {
+        asdx::Vector3 zero( 0.0f, 0.0f, 0.0f );
+        if ( m_Scene.Lights.empty() )
+        { return zero; }
+
+        asdx::Vector3 lightPos, lightNormal;
+        u32 triangle;
+        m_Scene.SampleLight( random, lightPos, lightNormal, triangle );
+
+        auto toLight = lightPos - pos;
+        auto dist2   = toLight.LengthSq();
+        auto dist    = sqrtf( dist2 );
+        auto dir     = toLight / dist;
+        auto cosS    = asdx::Vector3::Dot( normal, dir );
+        auto cosL    = -asdx::Vector3::Dot( lightNormal, dir );
+        if ( cosS <= 0.0f || cosL <= 0.0f )
+        { return zero; }
+
+        rayCount++;
+        if ( m_Scene.Occluded( asdx::Ray( pos, dir, 0.0f, dist * ( 1.0f - RayEpsilon ) ) ) )
+        { return zero; }
+
+        // 面積測度の確率密度 1 / A を立体角に変換して, BRDF (albedo / π) を掛ける.
+        const auto& Le = m_Scene.Materials[m_Scene.MaterialIds[triangle]].Color;
+        auto g = ( cosS * cosL * m_Scene.LightArea ) / ( dist2 * asdx::F_PI );
+        return Mul( Mul( Le, albedo ), asdx::Vector3( g, g, g ) );
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      成分ごとに乗算します.
+    //---------------------------------------------------------------------------------------------
+    static asdx::Vector3 Mul( const asdx::Vector3& a, const asdx::Vector3& b )
+    { return asdx::Vector3( a.x * b.x, a.y * b.y, a.z * b.z ); }
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      コーネルボックスのシーンを構築します.
+//-------------------------------------------------------------------------------------------------
+void CreateCornellBox( Scene& scene, const char* objPath )
+{
+    using asdx::Vector3;
+
+    auto white = scene.AddMaterial( MATERIAL_DIFFUSE, Vector3( 0.73f, 0.73f, 0.73f ) );
+    auto red   = scene.AddMaterial( MATERIAL_DIFFUSE, Vector3( 0.65f, 0.05f, 0.05f ) );
+    auto green = scene.AddMaterial( MATERIAL_DIFFUSE, Vector3( 0.12f, 0.45f, 0.15f ) );
+    auto light = scene.AddMaterial( MATERIAL_LIGHT,   Vector3( 17.0f, 12.0f,  4.0f ) );
+    auto glass = scene.AddMaterial( MATERIAL_GLASS,   Vector3( 1.0f,  1.0f,  1.0f ) );
+    auto metal = scene.AddMaterial( MATERIAL_MIRROR,  Vector3( 0.9f,  0.9f,  0.9f ) );
+
+    // 箱は [-1, 1]^3 で, z = -1 の面が開いています.
+    scene.AddQuad( Vector3( -1, -1, -1 ), Vector3( -1, -1,  1 ), Vector3(  1, -1,  1 ), Vector3(  1, -1, -1 ), white );    // 床.
+    scene.AddQuad( Vector3( -1,  1, -1 ), Vector3(  1,  1, -1 ), Vector3(  1,  1,  1 ), Vector3( -1,  1,  1 ), white );    // 天井.
+    scene.AddQuad( Vector3( -1, -1,  1 ), Vector3( -1,  1,  1 ), Vector3(  1,  1,  1 ), Vector3(  1, -1,  1 ), white );    // 奥.
+    scene.AddQuad( Vector3( -1, -1, -1 ), Vector3( -1,  1, -1 ), Vector3( -1,  1,  1 ), Vector3( -1, -1,  1 ), red   );    // 左.
+    scene.AddQuad( Vector3(  1, -1, -1 ), Vector3(  1, -1,  1 ), Vector3(  1,  1,  1 ), Vector3(  1,  1, -1 ), green );    // 右.
+
+    // 天井の少し下に下向きの光源を置く.
+    const f32 s = 0.25f;
+    scene.AddQuad( Vector3( -s, 0.998f, -s ), Vector3( s, 0.998f, -s ), Vector3( s, 0.998f, s ), Vector3( -s, 0.998f, s ), light );
+
+    if ( objPath != nullptr )
+    {
+        asdx::BoundingBox fit;
+        fit.Merge( Vector3( -0.6f, -1.0f, -0.6f ) );
+        fit.Merge( Vector3(  0.6f,  0.4f,  0.6f ) );
+        if ( !scene.LoadObj( objPath, fit, white ) )
+        { fprintf( stderr, "Error : Load OBJ Failed. path = %s\n", objPath ); }
+    }
+    else
+    {
+        scene.AddSphere( Vector3( -0.45f, -0.6f,  0.35f ), 0.4f, 256, 128, metal );
+        scene.AddSphere( Vector3(  0.45f, -0.6f, -0.25f ), 0.4f, 256, 128, glass );
+    }
+
+    scene.Build();
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    u32         width    = 512;
+    u32         height   = 512;
+    u32         spp      = 64;
+    u32         snapshot = 0;
+    f64         limit    = 0.0;
+    std::string output   = "PathTracer.ppm";
+    const char* objPath  = nullptr;
+
+    for( int i=1; i<argc; ++i )
+    {
+        auto hasValue = ( i + 1 < argc );
+        if      ( hasValue && strcmp( argv[i], "-w"        ) == 0 ) { width    = static_cast<u32>( atoi( argv[++i] ) ); }
+        else if ( hasValue && strcmp( argv[i], "-h"        ) == 0 ) { height   = static_cast<u32>( atoi( argv[++i] ) ); }
+        else if ( hasValue && strcmp( argv[i], "-spp"      ) == 0 ) { spp      = static_cast<u32>( atoi( argv[++i] ) ); }
+        else if ( hasValue && strcmp( argv[i], "-time"     ) == 0 ) { limit    = atof( argv[++i] ); }
+        else if ( hasValue && strcmp( argv[i], "-o"        ) == 0 ) { output   = argv[++i]; }
+        else if ( hasValue && strcmp( argv[i], "-obj"      ) == 0 ) { objPath  = argv[++i]; }
+        else if ( hasValue && strcmp( argv[i], "-snapshot" ) == 0 ) { snapshot = static_cast<u32>( atoi( argv[++i] ) ); }
+        else
+        {
+            fprintf( stderr, "Usage : %s [-w width] [-h height] [-spp count] [-time sec] [-o output.ppm|.pfm] [-obj mesh.obj] [-snapshot passes]\n", argv[0] );
+            return -1;
+        }
+    }
+
+    if ( width == 0 || height == 0 || spp == 0 )
+    {
+        fprintf( stderr, "Error : Invalid Argument.\n" );
+        return -1;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    auto elapsed = []( Clock::time_point start )
+    { return std::chrono::duration<f64>( Clock::now() - start ).count(); };
+
+    Scene scene;
+    auto buildStart = Clock::now();
+    CreateCornellBox( scene, objPath );
+    printf( "Scene : %u triangles, %u nodes, build %.1f ms\n",
+        static_cast<u32>( scene.MaterialIds.size() ), scene.Bvh.GetNodeCount(), elapsed( buildStart ) * 1000.0 );
+    printf( "Render : %u x %u, %u spp, %u threads, packet %u\n",
+        width, height, spp, asdx::ThreadPool::Instance().GetWorkerCount() + 1, PacketSize );
+
+    Camera camera;
+    camera.Init( asdx::Vector3( 0.0f, 0.0f, -3.4f ), asdx::Vector3( 0.0f, 0.0f, 0.0f ), asdx::Vector3( 0.0f, 1.0f, 0.0f ),
+        asdx::ToRadian( 39.3f ), static_cast<f32>( width ) / height );
+
+    Renderer renderer( scene, camera, width, height );
+
+    auto start = Clock::now();
+    while( renderer.GetPassCount() < spp )
+    {
+        auto passStart = Clock::now();
+        auto prevRays  = renderer.GetRayCount();
+        renderer.RenderPass();
+
+        auto passTime  = elapsed( passStart );
+        auto totalTime = elapsed( start );
+        auto samples   = static_cast<f64>( width ) * height;
+        printf( "Pass %4u : %8.2f ms, %7.3f Msamples/s, %7.3f Mrays/s (total %.1f s)\n",
+            renderer.GetPassCount(),
+            passTime * 1000.0,
+            samples * 1e-6 / passTime,
+            ( renderer.GetRayCount() - prevRays ) * 1e-6 / passTime,
+            totalTime );
+        fflush( stdout );
+
+        if ( snapshot > 0 && ( renderer.GetPassCount() % snapshot ) == 0 )
+        { renderer.Save( output ); }
+
+        if ( limit > 0.0 && totalTime >= limit )
+        { break; }
+    }
+
+    auto totalTime = elapsed( start );
+    auto samples   = static_cast<f64>( width ) * height * renderer.GetPassCount();
+    printf( "Total : %u spp in %.2f s, %.3f Msamples/s, %.3f Mrays/s\n",
+        renderer.GetPassCount(), totalTime, samples * 1e-6 / totalTime, renderer.GetRayCount() * 1e-6 / totalTime );
+
+    if ( !renderer.Save( output ) )
+    {
+        fprintf( stderr, "Error : Save Failed. path = %s\n", output.c_str() );
+        return -1;
+    }
+
+    printf( "Saved : %s\n", output.c_str() );
+    return 0;
+}
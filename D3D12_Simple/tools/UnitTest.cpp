@@ -0,0 +1,3501 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : UnitTest.cpp
+// Desc : Library Regression Test.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// ヘッダーのみのモジュールの回帰テストです. Linux 等のヘッドレス環境でも動作します.
+//
+//  ビルド例 (Linux) :
+//      g++ -std=c++14 -O1 -g -fsanitize=address,undefined -I../include UnitTest.cpp -o UnitTest -pthread
+//      g++ -std=c++14 -O2 -DASDX_ENABLE_SIMD=0 -I../include UnitTest.cpp -o UnitTestScalar -pthread
+//      g++ -std=c++14 -O2 -DNDEBUG -march=native -I../include UnitTest.cpp -o UnitTestRelease -pthread
+//
+//  使用例 :
+//      UnitTest
+//      UnitTest -filter SoA
+//
+//  失敗したテストがある場合は 0 以外を返却します. バッファの範囲外アクセスを検出するために
+//  サニタイザーを有効にしてビルドすることを推奨します. assert に頼らない処理を確認するため,
+//  NDEBUG を定義したビルドでも実行してください.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <asdxMath.h>
+#include <asdxSoA.h>
+#include <asdxAnimation.h>
+#include <asdxResidencyPolicy.h>
+#include <asdxParallel.h>
+#include <asdxEntity.h>
+#include <asdxPool.h>
+#include <asdxFastMath.h>
+#include <asdxBvh.h>
+#include <asdxHandle.h>
+#include <asdxMemoryTracker.h>
+#include <asdxBroadphase.h>
+#include <asdxFrameAllocator.h>
+#include <asdxMathParallel.h>
+#include <asdxQuantization.h>
+#include <asdxRandom.h>
+#include <asdxCulling.h>
+#include <asdxIntersection.h>
+#include <asdxAlignedAllocator.h>
+#include <asdxTransformHierarchy.h>
+#include <asdxSphericalHarmonics.h>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cfloat>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Global Variables.
+//-------------------------------------------------------------------------------------------------
+std::atomic<u32> g_FailCount( 0 );  //!< 失敗したチェックの数です. ワーカースレッドからも加算します.
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      条件が偽の場合に失敗として記録します.
+//-------------------------------------------------------------------------------------------------
+#define TEST_CHECK( expr )                                                          \
+    do {                                                                            \
+        if ( !( expr ) )                                                            \
+        {                                                                           \
+            fprintf( stderr, "    %s(%d) : Check Failed : %s\n", __FILE__, __LINE__, #expr );   \
+            g_FailCount++;                                                          \
+        }                                                                           \
+    } while( 0 )
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      誤差を許して等しいかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+inline bool IsNear( f32 a, f32 b, f32 epsilon = 1e-5f )
+{ return fabsf( a - b ) <= epsilon; }
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestCase structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TestCase
+{
+    const char* Name;       //!< テスト名です.
+    void      (*Func)();    //!< テスト関数です.
+};
+
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      容量が異なる SoA バッファ同士の演算をテストします.
+//!
+//! @note       容量は縮まないので, 一度大きくしたバッファと要素数だけが同じになります.
+//-------------------------------------------------------------------------------------------------
+void TestSoAMismatchedCapacity()
+{
+    const u32 count = 10;
+
+    asdx::Vector3SoA a;
+    a.Resize( 1000 );
+    a.Resize( count );
+
+    asdx::Vector3SoA b( count );
+    for( u32 i=0; i<count; ++i )
+    {
+        a.Set( i, asdx::Vector3( f32( i ), 1.0f, 2.0f ) );
+        b.Set( i, asdx::Vector3( 0.0f, f32( i ), 4.0f ) );
+    }
+
+    asdx::Vector3SoA r;
+    asdx::Vector3SoA::Lerp( a, b, 0.5f, r );
+    TEST_CHECK( r.GetCount() == count );
+    for( u32 i=0; i<count; ++i )
+    {
+        auto v = r.Get( i );
+        TEST_CHECK( IsNear( v.x, f32( i ) * 0.5f ) && IsNear( v.y, ( 1.0f + f32( i ) ) * 0.5f ) && IsNear( v.z, 3.0f ) );
+    }
+
+    asdx::Vector3SoA::Min  ( b, a, r );
+    asdx::Vector3SoA::Max  ( b, a, r );
+    asdx::Vector3SoA::Cross( b, a, r );
+
+    // 小さい容量の結果に大きい容量の入力を書き込む.
+    asdx::Vector3SoA n( count );
+    asdx::Vector3SoA::Normalize( a, n );
+    for( u32 i=0; i<count; ++i )
+    {
+        auto v = n.Get( i );
+        TEST_CHECK( IsNear( v.x * v.x + v.y * v.y + v.z * v.z, 1.0f ) );
+    }
+
+    // 余白の要素はゼロのままです.
+    for( u32 i=count; i<n.GetCapacity(); ++i )
+    { TEST_CHECK( n.X()[i] == 0.0f && n.Y()[i] == 0.0f && n.Z()[i] == 0.0f ); }
+
+    asdx::Vector4SoA c;
+    c.Resize( 1000 );
+    c.Resize( count );
+    for( u32 i=0; i<count; ++i )
+    { c.Set( i, asdx::Vector4( 1.0f, 1.0f, 1.0f, 1.0f ) ); }
+
+    asdx::Vector4SoA m( count );
+    asdx::Vector4SoA::Normalize( c, m );
+    asdx::Vector4SoA::Lerp( m, c, 0.5f, m );
+    for( u32 i=0; i<count; ++i )
+    { TEST_CHECK( IsNear( m.Get( i ).w, 0.75f ) ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ジョイント数の異なるクリップを同じスレッドで評価するテストです.
+//!
+//! @note       スレッドごとの作業用ポーズは大きいスケルトンの容量を保持したままになります.
+//-------------------------------------------------------------------------------------------------
+void TestAnimationMixedSkeletons()
+{
+    const u32 jointCounts[] = { 64, 16, 5 };
+    const f32 angle = asdx::F_PIDIV4;
+
+    asdx::AnimationClip clips[3];
+    for( u32 c=0; c<3; ++c )
+    {
+        clips[c].Init( jointCounts[c], 2, 1.0f );
+        for( u32 j=0; j<jointCounts[c]; ++j )
+        {
+            auto t = asdx::Vector3( f32( j ), 0.0f, 0.0f );
+            auto s = asdx::Vector3( 1.0f, 1.0f, 1.0f );
+            clips[c].SetKey( 1, j, asdx::Quaternion::CreateFromAxisAngle( asdx::Vector3( 0.0f, 0.0f, 1.0f ), angle ), t, s );
+        }
+    }
+
+    // 大きいスケルトンから順に同じスレッドで評価する.
+    asdx::AnimationPose pose;
+    for( u32 c=0; c<3; ++c )
+    {
+        clips[c].Sample( 0.5f, false, pose );
+        TEST_CHECK( pose.GetJointCount() == jointCounts[c] );
+
+        auto expected = asdx::Quaternion::CreateFromAxisAngle( asdx::Vector3( 0.0f, 0.0f, 1.0f ), angle * 0.5f );
+        for( u32 j=0; j<jointCounts[c]; ++j )
+        {
+            auto q = pose.Rotation.Get( j );
+            TEST_CHECK( IsNear( q.z, expected.z, 1e-3f ) && IsNear( q.w, expected.w, 1e-3f ) );
+            TEST_CHECK( IsNear( pose.Translation.Get( j ).x, f32( j ) * 0.5f, 1e-2f ) );
+        }
+
+        // 余白の要素はゼロのままです.
+        for( u32 j=jointCounts[c]; j<pose.Rotation.GetCapacity(); ++j )
+        { TEST_CHECK( pose.Rotation.W()[j] == 0.0f && pose.Scale.X()[j] == 0.0f ); }
+    }
+
+    // ブレンド用の作業用ポーズも同じスレッドで使い回される.
+    asdx::AnimationPose poses[3];
+    asdx::AnimationJob  jobs[3] = {};
+    for( u32 c=0; c<3; ++c )
+    {
+        jobs[c].pClip       = &clips[c];
+        jobs[c].Time        = 0.0f;
+        jobs[c].pBlendClip  = &clips[c];
+        jobs[c].BlendTime   = 1.0f;
+        jobs[c].BlendWeight = 0.5f;
+        jobs[c].pPose       = &poses[c];
+    }
+    asdx::EvaluateAnimationJobs( jobs, 3, 3 );
+
+    for( u32 c=0; c<3; ++c )
+    {
+        TEST_CHECK( poses[c].GetJointCount() == jointCounts[c] );
+        for( u32 j=0; j<jointCounts[c]; ++j )
+        { TEST_CHECK( IsNear( poses[c].Translation.Get( j ).x, f32( j ) * 0.5f, 1e-2f ) ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      常駐管理の LRU ポリシーをテストします.
+//-------------------------------------------------------------------------------------------------
+void TestResidencyPolicyLru()
+{
+    const u64 size = 100;
+
+    // フレーム 0, 1, 2, 3 で1つずつ登録する.
+    asdx::ResidencyPolicy policy;
+    u32 ids[4];
+    for( u32 i=0; i<4; ++i )
+    { ids[i] = policy.Register( size, i ); }
+
+    // ids[0] を使い直したので, 古い順は 1, 2, 3, 0 になる.
+    policy.Touch( ids[0], 4 );
+    TEST_CHECK( policy.GetLeastRecentlyUsed() == ids[1] );
+
+    // 予算 250 に収めるには古いものから2つ退避する.
+    std::vector<u32> result;
+    auto freed = policy.CollectEvictions( 400, 250, 4, 16, result );
+    TEST_CHECK( freed == 2 * size );
+    TEST_CHECK( result.size() == 2 && result[0] == ids[1] && result[1] == ids[2] );
+    TEST_CHECK( !policy.IsResident( ids[1] ) && !policy.IsResident( ids[2] ) );
+    TEST_CHECK( policy.GetResidentSize() == 2 * size );
+    TEST_CHECK( !policy.IsOversubscribed() );
+
+    // 保護フレーム以降に使用したものは予算を超えても退避しない.
+    freed = policy.CollectEvictions( 200, 0, 3, 16, result );
+    TEST_CHECK( freed == 0 && result.empty() );
+    TEST_CHECK( policy.IsResident( ids[3] ) && policy.IsResident( ids[0] ) );
+    TEST_CHECK( policy.IsOversubscribed() );
+
+    // このフレームで使用するものは先行常駐化の上限に関わらず全て常駐化する.
+    u32 extra[4];
+    for( u32 i=0; i<4; ++i )
+    { extra[i] = policy.Register( size, 5 ); }
+    policy.CollectEvictions( 600, 0, 6, 16, result );
+    TEST_CHECK( result.size() == 6 && policy.GetResidentSize() == 0 );
+
+    policy.Prefetch( extra[0] );
+    policy.Prefetch( extra[1] );
+    TEST_CHECK( policy.Touch( ids[1], 6 ) );
+    TEST_CHECK( policy.Touch( ids[2], 6 ) );
+    TEST_CHECK( policy.Touch( extra[2], 6 ) );
+    TEST_CHECK( policy.GetPendingCount() == 5 );
+
+    policy.CollectResidents( 6, 1, result );
+    TEST_CHECK( result.size() == 4 );
+    TEST_CHECK( policy.IsResident( ids[1] ) && policy.IsResident( ids[2] ) && policy.IsResident( extra[2] ) );
+    TEST_CHECK( policy.IsResident( extra[0] ) && !policy.IsResident( extra[1] ) );
+    TEST_CHECK( policy.GetPendingCount() == 1 && policy.GetPendingSize() == size );
+
+    // 先行常駐化の上限が0でも使用したものは常駐化する.
+    TEST_CHECK( policy.Touch( extra[3], 7 ) );
+    policy.CollectResidents( 7, 0, result );
+    TEST_CHECK( result.size() == 1 && result[0] == extra[3] );
+    TEST_CHECK( policy.GetPendingCount() == 1 );
+
+    // 残った先行分は次のフレームで常駐化される.
+    policy.CollectResidents( 8, 1, result );
+    TEST_CHECK( result.size() == 1 && result[0] == extra[1] );
+    TEST_CHECK( policy.GetPendingCount() == 0 && policy.GetPendingSize() == 0 );
+    TEST_CHECK( policy.GetResidentSize() == 6 * size );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      要素数が u32 の最大値付近の場合の分割をテストします.
+//!
+//! @note       範囲を取り出すカウンタが折り返すと同じ範囲を何度も処理して終わらなくなります.
+//-------------------------------------------------------------------------------------------------
+void TestParallelForCountLimit()
+{
+    const u32 count  = 0xffffffffu;
+    const u32 grains[] = { 0x40000000u, 0x7fffffffu, 0xfffffff0u };
+
+    for( auto grain : grains )
+    {
+        std::atomic<u64> total ( 0 );
+        std::atomic<u32> calls ( 0 );
+        std::atomic<u32> maxEnd( 0 );
+        asdx::ParallelFor( count, grain, [&]( u32 begin, u32 end )
+        {
+            TEST_CHECK( begin < end && end - begin <= grain );
+            total += end - begin;
+            calls++;
+
+            auto prev = maxEnd.load();
+            while( prev < end && !maxEnd.compare_exchange_weak( prev, end ) )
+            { /* DO_NOTHING */ }
+        });
+
+        TEST_CHECK( total == count );
+        TEST_CHECK( calls == ( u64( count ) + grain - 1 ) / grain );
+        TEST_CHECK( maxEnd == count );
+    }
+
+    // 処理関数の中から呼び出すと逐次処理になる.
+    std::atomic<u64> nested( 0 );
+    asdx::ParallelFor( 2, 1, [&]( u32, u32 )
+    {
+        asdx::ParallelFor( count, 0xc0000000u, [&]( u32 begin, u32 end )
+        { nested += end - begin; });
+    });
+    TEST_CHECK( nested == u64( count ) * 2 );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Entity Test Components
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TestPosition { f32 x, y, z; };
+struct TestVelocity { f32 x, y, z; };
+struct TestHealth   { s32 value; };
+struct TestLarge    { u32 data[2250]; };    // 9000 バイト. チャンクに1行だけ入ります.
+struct TestLarge2   { u32 data[2250]; };    // TestLarge と合わせるとチャンクに入りません.
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      エンティティの生成・破棄・コンポーネントの追加と削除をテストします.
+//-------------------------------------------------------------------------------------------------
+void TestEntityStructuralChanges()
+{
+    asdx::EntityWorld world;
+
+    // 複数のチャンクにまたがる数を生成する.
+    const u32 count = 3000;
+    std::vector<asdx::Entity> entities;
+    for( u32 i=0; i<count; ++i )
+    {
+        TestPosition p = { f32( i ), 0.0f, 0.0f };
+        TestVelocity v = { 0.0f, f32( i ), 0.0f };
+        entities.push_back( world.Create( p, v ) );
+    }
+    TEST_CHECK( world.GetEntityCount() == count );
+    TEST_CHECK( world.GetArchetype( 0 ).GetChunkCount() > 1 );
+
+    // 偶数番目を破棄しても残りの値は穴埋めで移動した後も保たれる.
+    for( u32 i=0; i<count; i+=2 )
+    { TEST_CHECK( world.Destroy( entities[i] ) ); }
+    TEST_CHECK( !world.Destroy( entities[0] ) );
+    TEST_CHECK( world.GetEntityCount() == count / 2 );
+    for( u32 i=0; i<count; ++i )
+    {
+        auto alive = ( i & 1 ) != 0;
+        TEST_CHECK( world.IsAlive( entities[i] ) == alive );
+        if ( alive )
+        {
+            TEST_CHECK( world.Get<TestPosition>( entities[i] )->x == f32( i ) );
+            TEST_CHECK( world.Get<TestVelocity>( entities[i] )->y == f32( i ) );
+        }
+        else
+        { TEST_CHECK( world.Get<TestPosition>( entities[i] ) == nullptr ); }
+    }
+
+    // 追加と削除でアーキタイプを移動しても共通のコンポーネントは保たれる.
+    TestHealth health = { 42 };
+    world.Add( entities[1], health );
+    TEST_CHECK( world.Has<TestHealth>( entities[1] ) && world.Get<TestHealth>( entities[1] )->value == 42 );
+    TEST_CHECK( world.Get<TestPosition>( entities[1] )->x == 1.0f );
+
+    world.Remove<TestVelocity>( entities[1] );
+    TEST_CHECK( !world.Has<TestVelocity>( entities[1] ) );
+    TEST_CHECK( world.Get<TestPosition>( entities[1] )->x == 1.0f );
+    TEST_CHECK( world.Get<TestHealth>( entities[1] )->value == 42 );
+    TEST_CHECK( world.GetArchetypeCount() == 3 );
+
+    // Each は指定した組み合わせを持つものだけを処理する.
+    u32 visited = 0;
+    f32 sum     = 0.0f;
+    world.Each<const TestPosition, TestVelocity>( [&]( u32 n, const asdx::Entity* pEntities, const TestPosition* pPos, TestVelocity* pVel )
+    {
+        for( u32 i=0; i<n; ++i )
+        {
+            TEST_CHECK( world.Get<TestPosition>( pEntities[i] ) == &pPos[i] );
+            pVel[i].z = pPos[i].x;
+            sum += pPos[i].x;
+        }
+        visited += n;
+    });
+    TEST_CHECK( visited == count / 2 - 1 );
+    TEST_CHECK( world.Get<TestVelocity>( entities[3] )->z == 3.0f );
+    TEST_CHECK( sum == f32( ( count / 2 ) * ( count / 2 ) - 1 ) );
+
+    // 処理中の構造変更はリリースビルドでも拒否する.
+    bool thrown = false;
+    try
+    {
+        world.Each<TestHealth>( [&]( u32, const asdx::Entity*, TestHealth* )
+        { world.Create( TestHealth() ); });
+    }
+    catch( const std::logic_error& )
+    { thrown = true; }
+    TEST_CHECK( thrown );
+
+    // 例外で抜けた後は再び構造変更できる.
+    auto e = world.Create( health );
+    TEST_CHECK( world.IsAlive( e ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      コマンドバッファによる構造変更の遅延反映をテストします.
+//-------------------------------------------------------------------------------------------------
+void TestEntityCommandBuffer()
+{
+    asdx::EntityWorld         world;
+    asdx::EntityCommandBuffer commands;
+
+    std::vector<asdx::Entity> entities;
+    for( u32 i=0; i<1000; ++i )
+    {
+        TestHealth h = { s32( i ) };
+        entities.push_back( world.Create( h ) );
+    }
+
+    // 処理中に記録して, 処理後に反映する.
+    world.EachParallel<TestHealth>( [&]( u32 n, const asdx::Entity* pEntities, TestHealth* pHealth )
+    {
+        for( u32 i=0; i<n; ++i )
+        {
+            if ( pHealth[i].value % 10 == 0 )
+            { commands.Destroy( pEntities[i] ); }
+            else if ( pHealth[i].value % 10 == 1 )
+            {
+                TestPosition p = { f32( pHealth[i].value ), 0.0f, 0.0f };
+                commands.Add( pEntities[i], p );
+            }
+            else if ( pHealth[i].value == 2 )
+            {
+                TestPosition p = { -1.0f, -2.0f, -3.0f };
+                TestHealth   h = { -1 };
+                commands.Create( p, h );
+            }
+        }
+    });
+    TEST_CHECK( !commands.IsEmpty() );
+    TEST_CHECK( world.GetEntityCount() == 1000 );
+
+    // 反映前に破棄したエンティティへのコマンドは無視される.
+    world.Destroy( entities[1] );
+    commands.Remove<TestHealth>( entities[1] );
+    commands.Playback( world );
+    TEST_CHECK( commands.IsEmpty() );
+
+    TEST_CHECK( world.GetEntityCount() == 1000 - 100 - 1 + 1 );
+    for( u32 i=0; i<1000; ++i )
+    {
+        if ( i % 10 == 0 || i == 1 )
+        { TEST_CHECK( !world.IsAlive( entities[i] ) ); }
+        else if ( i % 10 == 1 )
+        { TEST_CHECK( world.Get<TestPosition>( entities[i] ) != nullptr && world.Get<TestPosition>( entities[i] )->x == f32( i ) ); }
+        else
+        { TEST_CHECK( !world.Has<TestPosition>( entities[i] ) ); }
+    }
+
+    u32 created = 0;
+    world.Each<TestPosition, TestHealth>( [&]( u32 n, const asdx::Entity*, TestPosition* pPos, TestHealth* pHealth )
+    {
+        for( u32 i=0; i<n; ++i )
+        {
+            if ( pHealth[i].value == -1 )
+            {
+                TEST_CHECK( pPos[i].x == -1.0f && pPos[i].y == -2.0f && pPos[i].z == -3.0f );
+                created++;
+            }
+        }
+    });
+    TEST_CHECK( created == 1 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      チャンクに1行しか入らない大きなコンポーネントをテストします.
+//!
+//! @note       列の開始位置が assert の中でしか決まらない不具合があったため, NDEBUG を定義した
+//!             ビルドでも実行してください.
+//-------------------------------------------------------------------------------------------------
+void TestEntityLargeComponent()
+{
+    asdx::EntityWorld world;
+
+    std::vector<asdx::Entity> entities;
+    for( u32 i=0; i<4; ++i )
+    {
+        auto e = world.Create( TestLarge(), TestHealth() );
+        auto pLarge = world.Get<TestLarge>( e );
+        pLarge->data[0]    = i;
+        pLarge->data[2249] = i * 7;
+        world.Get<TestHealth>( e )->value = s32( i );
+        entities.push_back( e );
+    }
+
+    auto& archetype = world.GetArchetype( 0 );
+    TEST_CHECK( archetype.GetCapacity() == 1 );
+    TEST_CHECK( archetype.GetChunkCount() == 4 );
+
+    TEST_CHECK( world.Destroy( entities[1] ) );
+    TEST_CHECK( archetype.GetChunkCount() == 3 );
+    for( u32 i=0; i<4; ++i )
+    {
+        if ( i == 1 )
+        { continue; }
+
+        auto pLarge = world.Get<TestLarge>( entities[i] );
+        TEST_CHECK( pLarge->data[0] == i && pLarge->data[2249] == i * 7 );
+        TEST_CHECK( world.Get<TestHealth>( entities[i] )->value == s32( i ) );
+    }
+
+    // 1行も入らない組み合わせは生成時に拒否する.
+    bool thrown = false;
+    try
+    { world.Create( TestLarge(), TestLarge2() ); }
+    catch( const std::length_error& )
+    { thrown = true; }
+    TEST_CHECK( thrown );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TestPoolObject structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TestPoolObject
+{
+    u64 Data[4];    //!< ペイロードです.
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      別スレッドでの解放とスレッド終了時の返却をテストします.
+//-------------------------------------------------------------------------------------------------
+void TestPoolCrossThreadFree()
+{
+    const u32 threadCount = 4;
+    const u32 count       = 10000;
+
+    asdx::Pool<TestPoolObject> pool;
+
+    // 各スレッドで確保したものを隣のスレッドで解放する.
+    std::vector<std::vector<void*>> ptrs( threadCount );
+    for( u32 round=0; round<4; ++round )
+    {
+        std::vector<std::thread> threads;
+        for( u32 t=0; t<threadCount; ++t )
+        {
+            threads.push_back( std::thread( [&, t]()
+            {
+                auto& mine = ptrs[t];
+                for( u32 i=0; i<count; ++i )
+                {
+                    auto p = static_cast<u64*>( pool.Alloc() );
+                    TEST_CHECK( p != nullptr );
+                    *p = ( u64( t ) << 32 ) | i;
+                    mine.push_back( p );
+                }
+            }));
+        }
+        for( auto& thread : threads )
+        { thread.join(); }
+
+        threads.clear();
+        for( u32 t=0; t<threadCount; ++t )
+        {
+            threads.push_back( std::thread( [&, t]()
+            {
+                auto& other = ptrs[( t + 1 ) % threadCount];
+                for( u32 i=0; i<count; ++i )
+                {
+                    TEST_CHECK( *static_cast<u64*>( other[i] ) == ( ( u64( ( t + 1 ) % threadCount ) << 32 ) | i ) );
+                    pool.Free( other[i] );
+                }
+                other.clear();
+            }));
+        }
+        for( auto& thread : threads )
+        { thread.join(); }
+    }
+
+    // 終了したスレッドのマガジンは返却済みなので, 回数は全て集計されている.
+    auto stats = pool.GetStats();
+    TEST_CHECK( stats.AllocCount == u64( threadCount ) * count * 4 );
+    TEST_CHECK( stats.FreeCount  == stats.AllocCount );
+
+    // 使い回しているのでスラブは同時に生存している数の分だけで済む.
+    auto maxLive = threadCount * count + threadCount * 2 * asdx::Pool<TestPoolObject>::DefaultMagazineSize;
+    TEST_CHECK( stats.Capacity <= maxLive + asdx::Pool<TestPoolObject>::DefaultSlabSize );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      1つのスレッドで多数のプールを使った場合にマガジンが失われないことをテストします.
+//-------------------------------------------------------------------------------------------------
+void TestPoolMagazineEviction()
+{
+    // スレッドごとのマガジン数より多いプールを交互に使う.
+    const u32 poolCount = 8;
+    std::unique_ptr<asdx::Pool<TestPoolObject>> pools[poolCount];
+    for( u32 i=0; i<poolCount; ++i )
+    { pools[i].reset( new asdx::Pool<TestPoolObject>() ); }
+
+    for( u32 round=0; round<1000; ++round )
+    {
+        for( u32 i=0; i<poolCount; ++i )
+        {
+            auto p = pools[i]->Alloc();
+            TEST_CHECK( p != nullptr );
+            pools[i]->Free( p );
+        }
+    }
+
+    // 追い出されたマガジンのノードは回収されるので, スラブは増え続けない.
+    for( u32 i=0; i<poolCount; ++i )
+    {
+        auto stats = pools[i]->GetStats();
+        TEST_CHECK( stats.SlabCount == 1 );
+        TEST_CHECK( stats.AllocCount == stats.FreeCount );
+        TEST_CHECK( stats.AllocCount >= 999 && stats.AllocCount <= 1000 );
+    }
+
+    // 破棄済みのプールのマガジンを追い出しても安全です.
+    pools[0].reset();
+    for( u32 i=1; i<poolCount; ++i )
+    { pools[i]->Free( pools[i]->Alloc() ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      2つの値が何 ulp 離れているかを求めます. 両方 NaN なら 0 とします.
+//-------------------------------------------------------------------------------------------------
+u32 UlpDistance( f32 a, f32 b )
+{
+    if ( std::isnan( a ) || std::isnan( b ) )
+    { return ( std::isnan( a ) && std::isnan( b ) ) ? 0 : 0xffffffff; }
+
+    // 符号付きの大小と整数の大小が一致するように並べ替える.
+    s32 ia, ib;
+    memcpy( &ia, &a, sizeof(ia) );
+    memcpy( &ib, &b, sizeof(ib) );
+    s64 oa = ( ia < 0 ) ? s64( -0x80000000LL ) - ia : ia;
+    s64 ob = ( ib < 0 ) ? s64( -0x80000000LL ) - ib : ib;
+    auto d = ( oa > ob ) ? oa - ob : ob - oa;
+    return ( d > 0xffffffffLL ) ? 0xffffffff : u32( d );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      決定的な疑似乱数を [lo, hi) で返します.
+//-------------------------------------------------------------------------------------------------
+f32 TestRandom( u32& state, f32 lo, f32 hi )
+{
+    state = state * 1664525u + 1013904223u;
+    return lo + ( hi - lo ) * ( f32( state >> 8 ) / 16777216.0f );
+}
+
+static const u32 FastKernelCount = 8;   //!< EvalFastKernels() が出力する関数の数です.
+static const u32 FastBlockSize   = 8;   //!< 各幅で共通に処理する要素数です.
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      近似関数のカーネルを Ops の幅でまとめて評価します.
+//!
+//! @param [out]    pOut        k 番目の関数の結果を pOut[k * FastBlockSize] から格納します.
+//-------------------------------------------------------------------------------------------------
+template<typename Ops>
+void EvalFastKernels( const f32* pX, const f32* pY, f32* pOut )
+{
+    using namespace asdx::detail;
+    for( u32 i=0; i<FastBlockSize; i+=Ops::Width )
+    {
+        auto x = Ops::Load( pX + i );
+        auto y = Ops::Load( pY + i );
+        typename Ops::Float s, c;
+        SinCosKernel<Ops>( x, s, c );
+        Ops::Store( pOut + 0 * FastBlockSize + i, s );
+        Ops::Store( pOut + 1 * FastBlockSize + i, c );
+        Ops::Store( pOut + 2 * FastBlockSize + i, AcosKernel <Ops>( x ) );
+        Ops::Store( pOut + 3 * FastBlockSize + i, Atan2Kernel<Ops>( y, x ) );
+        Ops::Store( pOut + 4 * FastBlockSize + i, Exp2Kernel <Ops>( x ) );
+        Ops::Store( pOut + 5 * FastBlockSize + i, Log2Kernel <Ops>( x ) );
+        Ops::Store( pOut + 6 * FastBlockSize + i, PowKernel  <Ops>( x, y ) );
+        Ops::Store( pOut + 7 * FastBlockSize + i, RsqrtKernel<Ops>( x ) );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      近似関数の定義域外と特殊値の扱いをテストします.
+//-------------------------------------------------------------------------------------------------
+void TestFastMathDomain()
+{
+    auto nan = std::numeric_limits<f32>::quiet_NaN();
+    auto inf = std::numeric_limits<f32>::infinity();
+
+    // NaN は丸めずにそのまま返す.
+    TEST_CHECK( std::isnan( asdx::FastExp2( nan ) ) );
+    TEST_CHECK( std::isnan( asdx::FastLog2( nan ) ) );
+    TEST_CHECK( std::isnan( asdx::FastPow( nan, 2.0f ) ) );
+    TEST_CHECK( std::isnan( asdx::FastPow( 2.0f, nan ) ) );
+    TEST_CHECK( std::isnan( asdx::FastSin( nan ) ) );
+    TEST_CHECK( std::isnan( asdx::FastCos( nan ) ) );
+
+    // 定義域の端.
+    TEST_CHECK( asdx::FastExp2( -200.0f ) == 0.0f );
+    TEST_CHECK( asdx::FastExp2( -inf ) == 0.0f );
+    TEST_CHECK( asdx::FastLog2( 0.0f ) == -inf );
+    TEST_CHECK( asdx::FastLog2( inf ) == inf );
+    TEST_CHECK( std::isnan( asdx::FastLog2( -1.0f ) ) );
+
+    // y = 0 は x によらず 1.
+    TEST_CHECK( asdx::FastPow( 0.0f, 0.0f ) == 1.0f );
+    TEST_CHECK( asdx::FastPow( -2.0f, 0.0f ) == 1.0f );
+    TEST_CHECK( asdx::FastPow( nan, 0.0f ) == 1.0f );
+    TEST_CHECK( asdx::FastPow( inf, -0.0f ) == 1.0f );
+
+    // x = 0.
+    TEST_CHECK( asdx::FastPow( 0.0f, 2.0f ) == 0.0f );
+    TEST_CHECK( asdx::FastPow( -0.0f, 0.5f ) == 0.0f );
+    TEST_CHECK( asdx::FastPow( 0.0f, -1.0f ) == inf );
+
+    // 負の底は整数乗のみ.
+    TEST_CHECK( IsNear( asdx::FastPow( -2.0f, 2.0f ), 4.0f ) );
+    TEST_CHECK( IsNear( asdx::FastPow( -2.0f, 3.0f ), -8.0f ) );
+    TEST_CHECK( IsNear( asdx::FastPow( -2.0f, -1.0f ), -0.5f ) );
+    TEST_CHECK( IsNear( asdx::FastPow( -1.0f, 33554432.0f ), 1.0f ) );
+    TEST_CHECK( std::isnan( asdx::FastPow( -2.0f, 0.5f ) ) );
+    TEST_CHECK( std::isnan( asdx::FastPow( -2.0f, inf ) ) == false );
+
+    // 整数に変換できない大きさの引数でも未定義動作にならない (UBSan で確認します).
+    f32 s, c;
+    asdx::FastSinCos( 3.0e9f, s, c );
+    asdx::FastSinCos( -1.0e30f, s, c );
+    asdx::FastSinCos( inf, s, c );
+    TEST_CHECK( std::isnan( s ) && std::isnan( c ) );
+
+    // ASDX_FAST_MATH の切り替え先も同じ扱いになる.
+    TEST_CHECK( asdx::Pow( 0.0f, 0.0f ) == 1.0f );
+    TEST_CHECK( IsNear( asdx::Pow( -2.0f, 2.0f ), 4.0f ) );
+    TEST_CHECK( std::isnan( asdx::Exp2( nan ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      近似関数がヘッダーに記載した誤差に収まることをテストします.
+//-------------------------------------------------------------------------------------------------
+void TestFastMathErrorBound()
+{
+    const u32 count = 65536;
+    std::vector<f32> x( count ), y( count ), r( count );
+    u32 state = 12345;
+
+    auto checkAbs = [&]( const char* name, f32 bound, f64 (*ref)( f64, f64 ), void (*stream)( const f32*, const f32*, u32, f32* ) )
+    {
+        stream( x.data(), y.data(), count, r.data() );
+        f64 maxErr = 0.0;
+        for( u32 i=0; i<count; ++i )
+        { maxErr = std::max( maxErr, fabs( f64( r[i] ) - ref( x[i], y[i] ) ) ); }
+        if ( maxErr > bound )
+        { fprintf( stderr, "    %s : max abs error %g > %g\n", name, maxErr, bound ); }
+        TEST_CHECK( maxErr <= bound );
+    };
+    auto checkRel = [&]( const char* name, f32 bound, f64 (*ref)( f64, f64 ), void (*stream)( const f32*, const f32*, u32, f32* ) )
+    {
+        stream( x.data(), y.data(), count, r.data() );
+        f64 maxErr = 0.0;
+        for( u32 i=0; i<count; ++i )
+        {
+            auto e = ref( x[i], y[i] );
+            maxErr = std::max( maxErr, fabs( ( f64( r[i] ) - e ) / e ) );
+        }
+        if ( maxErr > bound )
+        { fprintf( stderr, "    %s : max rel error %g > %g\n", name, maxErr, bound ); }
+        TEST_CHECK( maxErr <= bound );
+    };
+
+    // Stream 版で SIMD 版を, 関数を直接呼んでスカラー版を確認する.
+    for( u32 i=0; i<count; ++i )
+    { x[i] = TestRandom( state, -8192.0f, 8192.0f ); }
+    checkAbs( "FastSin", 9.3e-8f, []( f64 a, f64 ) { return sin( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { asdx::FastSinStream( a, n, o ); } );
+    checkAbs( "FastCos", 9.3e-8f, []( f64 a, f64 ) { return cos( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { asdx::FastCosStream( a, n, o ); } );
+    checkAbs( "FastSin (scalar)", 9.3e-8f, []( f64 a, f64 ) { return sin( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { for( u32 i=0; i<n; ++i ) { o[i] = asdx::FastSin( a[i] ); } } );
+
+    for( u32 i=0; i<count; ++i )
+    { x[i] = TestRandom( state, -1.0f, 1.0f ); }
+    checkAbs( "FastAcos", 3.1e-7f, []( f64 a, f64 ) { return acos( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { asdx::FastAcosStream( a, n, o ); } );
+    checkAbs( "FastAcos (scalar)", 3.1e-7f, []( f64 a, f64 ) { return acos( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { for( u32 i=0; i<n; ++i ) { o[i] = asdx::FastAcos( a[i] ); } } );
+
+    for( u32 i=0; i<count; ++i )
+    {
+        x[i] = TestRandom( state, -10.0f, 10.0f );
+        y[i] = TestRandom( state, -10.0f, 10.0f );
+    }
+    checkAbs( "FastAtan2", 2.8e-7f, []( f64 a, f64 b ) { return atan2( b, a ); },
+        []( const f32* a, const f32* b, u32 n, f32* o ) { asdx::FastAtan2Stream( b, a, n, o ); } );
+    checkAbs( "FastAtan2 (scalar)", 2.8e-7f, []( f64 a, f64 b ) { return atan2( b, a ); },
+        []( const f32* a, const f32* b, u32 n, f32* o ) { for( u32 i=0; i<n; ++i ) { o[i] = asdx::FastAtan2( b[i], a[i] ); } } );
+
+    for( u32 i=0; i<count; ++i )
+    { x[i] = TestRandom( state, -126.0f, 127.5f ); }
+    checkRel( "FastExp2", 1.0e-7f, []( f64 a, f64 ) { return exp2( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { asdx::FastExp2Stream( a, n, o ); } );
+    checkRel( "FastExp2 (scalar)", 1.0e-7f, []( f64 a, f64 ) { return exp2( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { for( u32 i=0; i<n; ++i ) { o[i] = asdx::FastExp2( a[i] ); } } );
+
+    // 正の正規化数全体から選ぶ. 1 の近くは log2(x) が 0 に近いので別に調べる.
+    for( u32 i=0; i<count; ++i )
+    {
+        x[i] = ( i & 1 ) ? exp2f( TestRandom( state, -125.0f, 127.0f ) ) : TestRandom( state, 0.5f, 2.0f );
+        if ( x[i] == 1.0f ) { x[i] = 1.5f; }
+    }
+    checkRel( "FastLog2", 1.7e-7f, []( f64 a, f64 ) { return log2( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { asdx::FastLog2Stream( a, n, o ); } );
+    checkRel( "FastLog2 (scalar)", 1.7e-7f, []( f64 a, f64 ) { return log2( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { for( u32 i=0; i<n; ++i ) { o[i] = asdx::FastLog2( a[i] ); } } );
+    checkRel( "FastRsqrt", 2.4e-7f, []( f64 a, f64 ) { return 1.0 / sqrt( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { asdx::FastRsqrtStream( a, n, o ); } );
+    checkRel( "FastRsqrt (scalar)", 2.4e-7f, []( f64 a, f64 ) { return 1.0 / sqrt( a ); },
+        []( const f32* a, const f32*, u32 n, f32* o ) { for( u32 i=0; i<n; ++i ) { o[i] = asdx::FastRsqrt( a[i] ); } } );
+
+    // FastPow は |y * log2(x)| に比例して誤差が増えるので, 記載の式で要素ごとに判定する.
+    for( u32 i=0; i<count; ++i )
+    {
+        x[i] = TestRandom( state, 1.0e-3f, 100.0f );
+        y[i] = TestRandom( state, -8.0f, 8.0f );
+    }
+    asdx::FastPowStream( x.data(), y.data(), count, r.data() );
+    for( u32 pass=0; pass<2; ++pass )
+    {
+        u32 failed = 0;
+        for( u32 i=0; i<count; ++i )
+        {
+            auto v     = ( pass == 0 ) ? r[i] : asdx::FastPow( x[i], y[i] );
+            auto e     = pow( f64( x[i] ), f64( y[i] ) );
+            auto bound = ( 2.0 + fabs( y[i] * log2( f64( x[i] ) ) ) ) * 1.2e-7;
+            if ( fabs( ( v - e ) / e ) > bound )
+            { failed++; }
+        }
+        TEST_CHECK( failed == 0 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      スカラー版, 4要素版, 8要素版のカーネルが同じ結果を返すことをテストします.
+//-------------------------------------------------------------------------------------------------
+void TestFastMathWidths()
+{
+    auto nan = std::numeric_limits<f32>::quiet_NaN();
+    auto inf = std::numeric_limits<f32>::infinity();
+
+    // 特殊値の組み合わせと乱数を並べる.
+    const f32 specials[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.5f, 3.0f, -3.0f, 1.0e-40f, 1.0e-30f,
+        127.49f, 127.5f, 128.0f, -126.0f, -127.0f, -150.0f, 8192.0f, 3.0e9f, -1.0e30f,
+        16777217.0f, inf, -inf, nan
+    };
+    const u32 specialCount = sizeof(specials) / sizeof(specials[0]);
+
+    std::vector<f32> x, y;
+    for( u32 i=0; i<specialCount; ++i )
+    {
+        for( u32 j=0; j<specialCount; ++j )
+        {
+            x.push_back( specials[i] );
+            y.push_back( specials[j] );
+        }
+    }
+    u32 state = 777;
+    for( u32 i=0; i<4096; ++i )
+    {
+        x.push_back( TestRandom( state, -200.0f, 200.0f ) );
+        y.push_back( TestRandom( state, -10.0f, 10.0f ) );
+    }
+    while( x.size() % FastBlockSize )
+    {
+        x.push_back( 1.0f );
+        y.push_back( 1.0f );
+    }
+
+    // FMA はスカラー版では使わないので, 有効な場合は多項式の丸めが最大 1ulp 異なる.
+    // FastPow は log2 の差が y 倍されるため, 記載の相対誤差の範囲で比較する.
+    // 精度を保証しない |x| > 8192 の正弦・余弦は還元の丸めで大きく変わるので比較しない.
+    const u32 allowUlp = ASDX_SIMD_FMA ? 1 : 0;
+    auto compare = [&]( const f32* a, const f32* b, u32 ulp, const char* label )
+    {
+        u32 failed = 0;
+        for( size_t i=0; i<x.size(); i+=FastBlockSize )
+        {
+            for( u32 k=0; k<FastKernelCount; ++k )
+            {
+                for( u32 j=0; j<FastBlockSize; ++j )
+                {
+                    auto va = a[i * FastKernelCount + k * FastBlockSize + j];
+                    auto vb = b[i * FastKernelCount + k * FastBlockSize + j];
+                    auto ok = UlpDistance( va, vb ) <= ulp;
+                    if ( !ok && k <= 1 && ulp > 0 && !( fabsf( x[i + j] ) <= 8192.0f ) )
+                    { continue; }
+                    if ( !ok && k == 6 && ulp > 0 && std::isfinite( va ) && std::isfinite( vb ) )
+                    {
+                        auto px = f64( x[i + j] ), py = f64( y[i + j] );
+                        auto bound = ( 2.0 + fabs( py * log2( fabs( px ) ) ) ) * 2.4e-7;
+                        ok = fabs( f64( va ) - f64( vb ) ) <= bound * fabs( f64( vb ) );
+                    }
+                    if ( !ok && failed++ < 4 )
+                    {
+                        fprintf( stderr, "    %s : kernel %u, x = %g, y = %g : %g != %g\n",
+                            label, k, x[i + j], y[i + j], va, vb );
+                    }
+                }
+            }
+        }
+        TEST_CHECK( failed == 0 );
+    };
+
+    std::vector<f32> r1( x.size() * FastKernelCount );
+    for( size_t i=0; i<x.size(); i+=FastBlockSize )
+    { EvalFastKernels<asdx::detail::FastOps1>( &x[i], &y[i], &r1[i * FastKernelCount] ); }
+
+#if ASDX_SIMD_SSE2
+    std::vector<f32> r4( x.size() * FastKernelCount );
+    for( size_t i=0; i<x.size(); i+=FastBlockSize )
+    { EvalFastKernels<asdx::detail::FastOps4>( &x[i], &y[i], &r4[i * FastKernelCount] ); }
+    compare( r4.data(), r1.data(), allowUlp, "4-wide vs scalar" );
+#endif
+
+#if ASDX_SIMD_AVX2
+    std::vector<f32> r8( x.size() * FastKernelCount );
+    for( size_t i=0; i<x.size(); i+=FastBlockSize )
+    { EvalFastKernels<asdx::detail::FastOps8>( &x[i], &y[i], &r8[i * FastKernelCount] ); }
+    compare( r8.data(), r4.data(), 0, "8-wide vs 4-wide" );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      全てのボックスを調べてレイの最も近い交差位置を求めます.
+//-------------------------------------------------------------------------------------------------
+bool BruteForceRayBoxes( const std::vector<asdx::BoundingBox>& boxes, const asdx::Ray& ray, f32& tnear )
+{
+    auto invDir = asdx::Vector3( 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z );
+    auto hit = false;
+    tnear = ray.TMax;
+    for( size_t i=0; i<boxes.size(); ++i )
+    {
+        f32 t;
+        if ( asdx::IntersectRayBox( ray.Origin, invDir, boxes[i], ray.TMin, tnear, t ) )
+        {
+            tnear = t;
+            hit   = true;
+        }
+    }
+    return hit;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      BVH の探索結果が総当たりと一致することをテストします.
+//-------------------------------------------------------------------------------------------------
+void TestBvhBruteForce()
+{
+    // 並列に分割する大きさにして, 中心が重なるボックスや大きなボックスも混ぜる.
+    const u32 count = 40000;
+    asdx::Random random( 1357 );
+    std::vector<asdx::BoundingBox> boxes;
+    for( u32 i=0; i<count; ++i )
+    {
+        asdx::Vector3 center( random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ) );
+        if ( i % 7 == 0 )
+        { center = asdx::Vector3( 1.0f, 2.0f, 3.0f ); }
+        auto size = ( i % 101 == 0 ) ? 3.0f : 0.1f;
+        asdx::Vector3 extent( random.GetAsF32( 0.01f, size ), random.GetAsF32( 0.01f, size ), random.GetAsF32( 0.01f, size ) );
+        boxes.push_back( asdx::BoundingBox( center - extent, center + extent ) );
+    }
+
+    asdx::Bvh bvh;
+    bvh.Build( boxes.data(), count );
+
+    auto check = [&]()
+    {
+        // 全てのプリミティブが1回ずつ葉から参照される.
+        std::vector<u32> refs( count, 0 );
+        for( u32 i=0; i<bvh.GetNodeCount(); ++i )
+        {
+            const auto& node = bvh.GetNodes()[i];
+            if ( !node.IsLeaf() )
+            { continue; }
+            for( u32 j=0; j<node.Count; ++j )
+            { refs[bvh.GetIndices()[node.Offset + j]]++; }
+        }
+        u32 badRefs = 0;
+        for( u32 i=0; i<count; ++i )
+        { badRefs += ( refs[i] != 1 ) ? 1 : 0; }
+        TEST_CHECK( badRefs == 0 );
+
+        u32 mismatch = 0;
+        for( u32 r=0; r<256; ++r )
+        {
+            asdx::Vector3 origin( random.GetAsF32( -15.0f, 15.0f ), random.GetAsF32( -15.0f, 15.0f ), -20.0f );
+            asdx::Vector3 target( random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 20.0f ) );
+            asdx::Ray ray( origin, target - origin );
+            if ( r % 4 == 0 )
+            { ray.TMax = 0.5f; }
+
+            f32 expected;
+            auto expectedHit = BruteForceRayBoxes( boxes, ray, expected );
+
+            auto invDir = asdx::Vector3( 1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z );
+            auto func = [&]( u32 index, asdx::Ray& x )
+            {
+                f32 t;
+                if ( !asdx::IntersectRayBox( x.Origin, invDir, boxes[index], x.TMin, x.TMax, t ) )
+                { return false; }
+                x.TMax = t;
+                return true;
+            };
+
+            auto closest = ray;
+            auto hit = bvh.Intersect( closest, func );
+            auto any = bvh.IntersectAny( ray, func );
+            if ( hit != expectedHit || any != expectedHit || ( hit && closest.TMax != expected ) )
+            { mismatch++; }
+        }
+        TEST_CHECK( mismatch == 0 );
+
+        mismatch = 0;
+        for( u32 q=0; q<64; ++q )
+        {
+            asdx::Vector3 center( random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ), random.GetAsF32( -10.0f, 10.0f ) );
+            asdx::Vector3 extent( random.GetAsF32( 0.1f, 2.0f ), random.GetAsF32( 0.1f, 2.0f ), random.GetAsF32( 0.1f, 2.0f ) );
+            asdx::BoundingBox query( center - extent, center + extent );
+
+            std::vector<u32> found;
+            bvh.Query( query, [&]( u32 index ) { found.push_back( index ); } );
+
+            // Query() は葉の単位で返すので, 重なるものは全て含まれていなければならない.
+            std::vector<bool> mark( count, false );
+            for( auto index : found )
+            { mark[index] = true; }
+            for( u32 i=0; i<count; ++i )
+            {
+                auto overlap = ( boxes[i].Mini.x <= query.Maxi.x ) && ( query.Mini.x <= boxes[i].Maxi.x )
+                            && ( boxes[i].Mini.y <= query.Maxi.y ) && ( query.Mini.y <= boxes[i].Maxi.y )
+                            && ( boxes[i].Mini.z <= query.Maxi.z ) && ( query.Mini.z <= boxes[i].Maxi.z );
+                if ( overlap && !mark[i] )
+                { mismatch++; }
+            }
+        }
+        TEST_CHECK( mismatch == 0 );
+    };
+
+    check();
+
+    // 動かしてから再計算した場合も一致する.
+    for( u32 i=0; i<count; ++i )
+    {
+        asdx::Vector3 offset( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 1.0f ) );
+        boxes[i] = asdx::BoundingBox( boxes[i].Mini + offset, boxes[i].Maxi + offset );
+    }
+    bvh.Refit( boxes.data() );
+    check();
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      三角形メッシュの交差判定が総当たりと一致することをテストします.
+//-------------------------------------------------------------------------------------------------
+void TestBvhTriangles()
+{
+    // 起伏のある格子.
+    const u32 n = 64;
+    asdx::Random random( 97531 );
+    std::vector<asdx::Vector3> positions;
+    std::vector<u32> indices;
+    for( u32 z=0; z<=n; ++z )
+    {
+        for( u32 x=0; x<=n; ++x )
+        {
+            auto fx = -4.0f + 8.0f * x / n;
+            auto fz = -4.0f + 8.0f * z / n;
+            positions.push_back( asdx::Vector3( fx, sinf( fx ) * cosf( fz ) + random.GetAsF32( -0.1f, 0.1f ), fz ) );
+        }
+    }
+    for( u32 z=0; z<n; ++z )
+    {
+        for( u32 x=0; x<n; ++x )
+        {
+            auto i0 = z * ( n + 1 ) + x;
+            u32 quad[6] = { i0, i0 + n + 1, i0 + 1, i0 + 1, i0 + n + 1, i0 + n + 2 };
+            indices.insert( indices.end(), quad, quad + 6 );
+        }
+    }
+
+    auto triangleCount = static_cast<u32>( indices.size() / 3 );
+    std::vector<asdx::BoundingBox> bounds( triangleCount );
+    asdx::ComputeTriangleBounds( positions.data(), indices.data(), triangleCount, bounds.data() );
+
+    asdx::Bvh bvh;
+    bvh.Build( bounds.data(), triangleCount );
+
+    u32 mismatch = 0;
+    for( u32 r=0; r<1024; ++r )
+    {
+        asdx::Vector3 origin( random.GetAsF32( -5.0f, 5.0f ), random.GetAsF32( 1.0f, 3.0f ), random.GetAsF32( -5.0f, 5.0f ) );
+        asdx::Vector3 dir( random.GetAsF32( -1.0f, 1.0f ), random.GetAsF32( -1.0f, 0.2f ), random.GetAsF32( -1.0f, 1.0f ) );
+        asdx::Ray ray( origin, dir );
+
+        auto expectedHit = false;
+        auto expected    = ray.TMax;
+        for( u32 i=0; i<triangleCount; ++i )
+        {
+            f32 t, u, v;
+            if ( asdx::IntersectRayTriangle( ray, positions[indices[i * 3 + 0]], positions[indices[i * 3 + 1]], positions[indices[i * 3 + 2]], t, u, v )
+              && t < expected )
+            {
+                expected    = t;
+                expectedHit = true;
+            }
+        }
+
+        asdx::BvhHit hit;
+        auto result = asdx::IntersectTriangles( bvh, positions.data(), indices.data(), ray, hit );
+        if ( result != expectedHit || ( result && hit.T != expected ) )
+        { mismatch++; }
+    }
+    TEST_CHECK( mismatch == 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      破棄済みや未発行のハンドルが空きスロットを参照しないことを確認します.
+//-------------------------------------------------------------------------------------------------
+void TestHandleStale()
+{
+    asdx::HandlePool<u32> pool;
+
+    std::vector<asdx::Handle<u32>> handles;
+    for( u32 i=0; i<8; ++i )
+    { handles.push_back( pool.Create( i ) ); }
+
+    // 空きスロットを作る. 空きスロットの Dense はフリーリストの次を指している.
+    for( u32 i=0; i<8; i+=2 )
+    { TEST_CHECK( pool.Destroy( handles[i] ) ); }
+
+    for( u32 i=0; i<8; ++i )
+    {
+        auto alive = ( i % 2 ) != 0;
+        TEST_CHECK( pool.IsValid( handles[i] ) == alive );
+        TEST_CHECK( ( pool.Get( handles[i] ) != nullptr ) == alive );
+        if ( alive )
+        { TEST_CHECK( *pool.Get( handles[i] ) == i ); }
+
+        // 破棄で進んだ世代を持つ未発行のハンドルも無効でなければならない.
+        asdx::Handle<u32> forged( handles[i].Index, handles[i].Generation + 1 );
+        TEST_CHECK( !pool.IsValid( forged ) );
+        TEST_CHECK( pool.Get( forged ) == nullptr );
+        TEST_CHECK( !pool.Destroy( forged ) );
+    }
+    TEST_CHECK( !pool.Destroy( handles[0] ) );
+    TEST_CHECK( pool.GetCount() == 4 );
+
+    // スロットを再利用すると古いハンドルは無効のまま, 新しいハンドルだけが有効になる.
+    auto reused = pool.Create( 100 );
+    TEST_CHECK( pool.IsValid( reused ) );
+    TEST_CHECK( *pool.Get( reused ) == 100 );
+    for( u32 i=0; i<8; i+=2 )
+    {
+        TEST_CHECK( !pool.IsValid( handles[i] ) );
+        TEST_CHECK( pool.Get( handles[i] ) == nullptr );
+    }
+
+    // Clear 後は発行済みのハンドルも, 世代を合わせたハンドルも全て無効になる.
+    pool.Clear();
+    TEST_CHECK( pool.GetCount() == 0 );
+    TEST_CHECK( !pool.IsValid( reused ) );
+    for( u32 i=0; i<8; ++i )
+    {
+        TEST_CHECK( !pool.IsValid( handles[i] ) );
+        for( u32 g=1; g<4; ++g )
+        { TEST_CHECK( pool.Get( asdx::Handle<u32>( handles[i].Index, g ) ) == nullptr ); }
+    }
+    TEST_CHECK( !pool.IsValid( asdx::Handle<u32>() ) );
+    TEST_CHECK( !pool.IsValid( asdx::Handle<u32>( 100, 1 ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ASDX_TAGGED_NEW() で生成したオブジェクトがタグに計上されることを確認します.
+//-------------------------------------------------------------------------------------------------
+struct TestTaggedObject
+{
+    u32 A;
+    u32 B;
+
+    TestTaggedObject()
+    : A( 1 ), B( 2 )
+    { /* DO_NOTHING */ }
+
+    TestTaggedObject( u32 a, u32 b )
+    : A( a ), B( b )
+    { /* DO_NOTHING */ }
+};
+
+void TestMemoryTrackerTaggedNew()
+{
+    auto& tracker = asdx::MemoryTracker::Instance();
+    asdx::MemoryFrameReport before, after;
+    tracker.EndFrame( &before );
+
+    // 引数なしと引数ありの両方をマクロで生成できる.
+    auto pDefault = ASDX_TAGGED_NEW( asdx::MEMORY_TAG_ASSETS, TestTaggedObject );
+    auto pValue   = ASDX_TAGGED_NEW( asdx::MEMORY_TAG_ASSETS, TestTaggedObject, 3u, 4u );
+    TEST_CHECK( pDefault != nullptr && pDefault->A == 1 && pDefault->B == 2 );
+    TEST_CHECK( pValue   != nullptr && pValue  ->A == 3 && pValue  ->B == 4 );
+
+    tracker.EndFrame( &after );
+#if ASDX_ENABLE_MEMORY_TRACKING
+    const auto& tagBefore = before.Tags[asdx::MEMORY_TAG_ASSETS];
+    const auto& tagAfter  = after .Tags[asdx::MEMORY_TAG_ASSETS];
+    TEST_CHECK( tagAfter.LiveBytes - tagBefore.LiveBytes == static_cast<s64>( 2 * sizeof(TestTaggedObject) ) );
+    TEST_CHECK( tagAfter.FrameAllocCount == 2 );
+#endif
+
+#if ASDX_ENABLE_MEMORY_TRACKING && ASDX_ENABLE_MEMORY_CALLSITE
+    // 呼び出し元としてこのファイルが記録される.
+    std::vector<asdx::MemoryCallSite> sites;
+    tracker.GetCallSites( sites );
+    u64 count = 0;
+    for( size_t i=0; i<sites.size(); ++i )
+    {
+        if ( sites[i].Tag == asdx::MEMORY_TAG_ASSETS && strcmp( sites[i].File, __FILE__ ) == 0 )
+        { count += sites[i].Count; }
+    }
+    TEST_CHECK( count >= 2 );
+#endif
+
+    ASDX_TAGGED_DELETE( pDefault );
+    ASDX_TAGGED_DELETE( pValue );
+
+    tracker.EndFrame( &after );
+#if ASDX_ENABLE_MEMORY_TRACKING
+    TEST_CHECK( after.Tags[asdx::MEMORY_TAG_ASSETS].LiveBytes == before.Tags[asdx::MEMORY_TAG_ASSETS].LiveBytes );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      行列の積の1要素を ((a0 * b0 + a1 * b1) + a2 * b2) + a3 * b3 の順に求めます.
+//!
+//! @param [out]    bound       asdxSimd.h に記載した FMA 有効時の誤差の上限 2 * FLT_EPSILON * Σ|a_k * b_k| です.
+//-------------------------------------------------------------------------------------------------
+f32 ScalarDot4( const f32 a[4], const f32* b, u32 stride, f32& bound )
+{
+    auto result = ( ( ( a[0] * b[0] ) + ( a[1] * b[stride] ) ) + ( a[2] * b[2 * stride] ) ) + ( a[3] * b[3 * stride] );
+    bound = 0.0f;
+    for( u32 k=0; k<4; ++k )
+    { bound += fabsf( a[k] * b[k * stride] ); }
+    bound *= 2.0f * FLT_EPSILON;
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SIMD 版の結果がスカラー版と許容範囲内で一致するかどうかチェックします.
+//!
+//! @note       FMA 無効時はスカラー版と同じ順序で加算するのでビット単位で一致します.
+//-------------------------------------------------------------------------------------------------
+bool IsSimdMatch( f32 simd, f32 scalar, f32 bound )
+{
+#if ASDX_SIMD_FMA
+    return fabsf( simd - scalar ) <= bound;
+#else
+    ASDX_UNUSED_VAR( bound );
+    return UlpDistance( simd, scalar ) == 0;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      倍精度のガウス・ジョルダン法で逆行列を求めます. 比較用です.
+//-------------------------------------------------------------------------------------------------
+bool InvertReference( const asdx::Matrix& value, f64 result[4][4] )
+{
+    f64 a[4][8];
+    for( u32 r=0; r<4; ++r )
+    {
+        for( u32 c=0; c<4; ++c )
+        {
+            a[r][c]     = value.m[r][c];
+            a[r][c + 4] = ( r == c ) ? 1.0 : 0.0;
+        }
+    }
+
+    for( u32 c=0; c<4; ++c )
+    {
+        auto pivot = c;
+        for( u32 r=c + 1; r<4; ++r )
+        {
+            if ( fabs( a[r][c] ) > fabs( a[pivot][c] ) )
+            { pivot = r; }
+        }
+        if ( a[pivot][c] == 0.0 )
+        { return false; }
+
+        for( u32 k=0; k<8; ++k )
+        { std::swap( a[c][k], a[pivot][k] ); }
+
+        auto inv = 1.0 / a[c][c];
+        for( u32 k=0; k<8; ++k )
+        { a[c][k] *= inv; }
+
+        for( u32 r=0; r<4; ++r )
+        {
+            if ( r == c )
+            { continue; }
+            auto f = a[r][c];
+            for( u32 k=0; k<8; ++k )
+            { a[r][k] -= f * a[c][k]; }
+        }
+    }
+
+    for( u32 r=0; r<4; ++r )
+    {
+        for( u32 c=0; c<4; ++c )
+        { result[r][c] = a[r][c + 4]; }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      行列の無限大ノルム(行ごとの絶対値の和の最大値)を求めます.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+f64 InfinityNorm( const T m[4][4] )
+{
+    f64 result = 0.0;
+    for( u32 r=0; r<4; ++r )
+    {
+        f64 sum = 0.0;
+        for( u32 c=0; c<4; ++c )
+        { sum += fabs( static_cast<f64>( m[r][c] ) ); }
+        result = std::max( result, sum );
+    }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SIMD 版の行列演算がスカラー版と asdxSimd.h に記載した誤差の範囲で一致することを確認します.
+//!
+//! @note       SIMD を無効にしたビルドではスカラー版同士の比較になります.
+//-------------------------------------------------------------------------------------------------
+void TestSimdMatrixKernels()
+{
+    const u32 count = 2000;
+    u32 state = 13579;
+
+    u32 invertChecked = 0;
+    for( u32 n=0; n<count; ++n )
+    {
+        asdx::Matrix a, b;
+        for( u32 r=0; r<4; ++r )
+        {
+            for( u32 c=0; c<4; ++c )
+            {
+                a.m[r][c] = TestRandom( state, -2.0f, 2.0f );
+                b.m[r][c] = TestRandom( state, -2.0f, 2.0f );
+            }
+        }
+
+        // 積, 転置した積, 行ベクトルの変換.
+        auto ab  = asdx::Matrix::Multiply( a, b );
+        auto abT = asdx::Matrix::MultiplyTranspose( a, b );
+        auto t   = asdx::Matrix::Transpose( a );
+        for( u32 r=0; r<4; ++r )
+        {
+            for( u32 c=0; c<4; ++c )
+            {
+                f32 bound;
+                auto expected = ScalarDot4( a.m[r], &b.m[0][c], 4, bound );
+                TEST_CHECK( IsSimdMatch( ab.m[r][c],  expected, bound ) );
+                TEST_CHECK( IsSimdMatch( abT.m[c][r], expected, bound ) );
+                TEST_CHECK( UlpDistance( t.m[c][r], a.m[r][c] ) == 0 );
+            }
+
+            asdx::Vector4 v( a.m[r][0], a.m[r][1], a.m[r][2], a.m[r][3] );
+            auto tv = asdx::Vector4::Transform( v, b );
+            const f32* pResult = &tv.x;
+            for( u32 c=0; c<4; ++c )
+            {
+                f32 bound;
+                auto expected = ScalarDot4( a.m[r], &b.m[0][c], 4, bound );
+                TEST_CHECK( IsSimdMatch( pResult[c], expected, bound ) );
+            }
+        }
+
+        // 行列式と逆行列は倍精度で求めた値と比較する.
+        f64 inv[4][4];
+        if ( !InvertReference( a, inv ) )
+        { continue; }
+
+        auto normA   = InfinityNorm( a.m );
+        auto normInv = InfinityNorm( inv );
+        auto cond    = normA * normInv;
+
+        f64 detRef = 1.0;
+        {
+            // 逆行列の行列式の逆数として求めると精度が落ちるので, 部分ピボット付きの LU 分解で求める.
+            f64 lu[4][4];
+            for( u32 r=0; r<4; ++r )
+            {
+                for( u32 c=0; c<4; ++c )
+                { lu[r][c] = a.m[r][c]; }
+            }
+            for( u32 c=0; c<4; ++c )
+            {
+                auto pivot = c;
+                for( u32 r=c + 1; r<4; ++r )
+                {
+                    if ( fabs( lu[r][c] ) > fabs( lu[pivot][c] ) )
+                    { pivot = r; }
+                }
+                if ( pivot != c )
+                {
+                    for( u32 k=0; k<4; ++k )
+                    { std::swap( lu[c][k], lu[pivot][k] ); }
+                    detRef = -detRef;
+                }
+                detRef *= lu[c][c];
+                for( u32 r=c + 1; r<4; ++r )
+                {
+                    auto f = lu[r][c] / lu[c][c];
+                    for( u32 k=c; k<4; ++k )
+                    { lu[r][k] -= f * lu[c][k]; }
+                }
+            }
+        }
+
+        auto detBound = FLT_EPSILON * normA * normA * normA * normA;
+        TEST_CHECK( fabs( a.Determinant() - detRef ) <= detBound );
+
+        // ほぼ特異な行列は単精度の逆行列自体が意味を持たないので除く.
+        if ( cond > 1e4 )
+        { continue; }
+
+        auto invA  = asdx::Matrix::Invert( a );
+        auto bound = 2.0 * FLT_EPSILON * cond * normInv;
+        for( u32 r=0; r<4; ++r )
+        {
+            for( u32 c=0; c<4; ++c )
+            { TEST_CHECK( fabs( invA.m[r][c] - inv[r][c] ) <= bound ); }
+        }
+        invertChecked++;
+    }
+    TEST_CHECK( invertChecked > count / 2 );
+
+    // ストリーム版は1要素ずつの変換と一致する. AVX2 では8個ずつの経路と端数の経路の両方を通す.
+    {
+        const u32 streamCount = 37;
+        asdx::Matrix m;
+        for( u32 r=0; r<4; ++r )
+        {
+            for( u32 c=0; c<4; ++c )
+            { m.m[r][c] = TestRandom( state, -2.0f, 2.0f ); }
+        }
+
+        std::vector<asdx::Vector4> input( streamCount ), output( streamCount );
+        asdx::AlignedVector<asdx::Vector4A> inputA( streamCount ), outputA( streamCount );
+        for( u32 i=0; i<streamCount; ++i )
+        {
+            input[i] = asdx::Vector4( TestRandom( state, -4.0f, 4.0f ), TestRandom( state, -4.0f, 4.0f ), TestRandom( state, -4.0f, 4.0f ), 1.0f );
+            inputA[i] = input[i];
+        }
+
+        asdx::MatrixA matrixA = m;
+        asdx::Vector4::TransformStream( input.data(), sizeof(asdx::Vector4), streamCount, m, output.data(), sizeof(asdx::Vector4) );
+        asdx::TransformStream( inputA.data(), streamCount, matrixA, outputA.data() );
+
+        for( u32 i=0; i<streamCount; ++i )
+        {
+            const f32* pIn  = &input  [i].x;
+            const f32* pOut = &output [i].x;
+            const f32* pOutA = &outputA[i].x;
+            for( u32 c=0; c<4; ++c )
+            {
+                f32 bound;
+                auto expected = ScalarDot4( pIn, &m.m[0][c], 4, bound );
+                TEST_CHECK( IsSimdMatch( pOut [c], expected, bound ) );
+                TEST_CHECK( IsSimdMatch( pOutA[c], expected, bound ) );
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ペアを比較できるように 64bit のキーにして並べます.
+//-------------------------------------------------------------------------------------------------
+std::vector<u64> ToPairKeys( const std::vector<asdx::BroadphasePair>& pairs )
+{
+    std::vector<u64> result;
+    result.reserve( pairs.size() );
+    for( auto& pair : pairs )
+    {
+        TEST_CHECK( pair.A < pair.B );
+        result.push_back( ( u64( pair.A ) << 32 ) | pair.B );
+    }
+    std::sort( result.begin(), result.end() );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ブロードフェーズのテスト用のボックスを生成します.
+//!
+//! @note       格子の境界で接するボックスと, 多くの格子にまたがる大きなボックスを混ぜます.
+//-------------------------------------------------------------------------------------------------
+void MakeBroadphaseBoxes( asdx::Random& random, u32 count, f32 worldSize, std::vector<asdx::BoundingBox>& boxes )
+{
+    boxes.resize( count );
+    for( u32 i=0; i<count; ++i )
+    {
+        asdx::Vector3 mini( random.GetAsF32( 0.0f, worldSize ), random.GetAsF32( 0.0f, worldSize ), random.GetAsF32( 0.0f, worldSize ) );
+        auto size = ( i % 257 == 0 ) ? worldSize * 0.3f : 1.0f;
+        if ( i % 5 == 0 )
+        { mini = asdx::Vector3( floorf( mini.x ), floorf( mini.y ), floorf( mini.z ) ); size = 1.0f; }
+        asdx::Vector3 extent( random.GetAsF32( 0.1f, size ), random.GetAsF32( 0.1f, size ), random.GetAsF32( 0.1f, size ) );
+        if ( i % 5 == 0 )
+        { extent = asdx::Vector3( 1.0f, 1.0f, 1.0f ); }
+        boxes[i] = asdx::BoundingBox( mini, mini + extent );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SweepAndPrune のペアが総当たりと一致することを確認します.
+//-------------------------------------------------------------------------------------------------
+void TestBroadphaseSweepAndPrune()
+{
+    asdx::Random random( 2468 );
+    asdx::SweepAndPrune sap;
+    std::vector<asdx::BoundingBox> boxes;
+    std::vector<asdx::BroadphasePair> pairs;
+
+    // 格子が1つの場合と, 複数の格子に分かれる場合.
+    const u32 counts[] = { 300, 6000 };
+    for( auto count : counts )
+    {
+        MakeBroadphaseBoxes( random, count, 100.0f, boxes );
+        sap.FindPairs( boxes.data(), count, pairs );
+        TEST_CHECK( ( count > 4 * asdx::SweepAndPrune::CellTarget ) == ( sap.GetGridSize() > 1 ) );
+
+        std::vector<u64> expected;
+        for( u32 i=0; i<count; ++i )
+        {
+            for( u32 j=i + 1; j<count; ++j )
+            {
+                if ( boxes[i].Intersects( boxes[j] ) )
+                { expected.push_back( ( u64( i ) << 32 ) | j ); }
+            }
+        }
+
+        auto actual = ToPairKeys( pairs );
+        TEST_CHECK( actual.size() == pairs.size() );
+        TEST_CHECK( std::adjacent_find( actual.begin(), actual.end() ) == actual.end() );
+        TEST_CHECK( actual == expected );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      DynamicAabbTree のペアが太らせたボックスの総当たりと一致することを確認します.
+//-------------------------------------------------------------------------------------------------
+void TestBroadphaseDynamicAabbTree()
+{
+    const u32 count = 3000;
+    asdx::Random random( 1234 );
+    std::vector<asdx::BoundingBox> boxes;
+    MakeBroadphaseBoxes( random, count, 60.0f, boxes );
+
+    asdx::DynamicAabbTree tree;
+    std::vector<u32> proxies( count );
+    for( u32 i=0; i<count; ++i )
+    { proxies[i] = tree.CreateProxy( boxes[i], i ); }
+
+    // 一部を破棄して空きノードを再利用させる.
+    for( u32 i=0; i<count; i+=11 )
+    {
+        tree.DestroyProxy( proxies[i] );
+        proxies[i] = tree.CreateProxy( boxes[i], i );
+    }
+
+    std::vector<asdx::BroadphasePair> pairs;
+    std::vector<u8> moved( count, 1 );
+    for( u32 step=0; step<3; ++step )
+    {
+        TEST_CHECK( tree.GetProxyCount() == count );
+        tree.FindPairs( pairs, 64 );
+        TEST_CHECK( tree.GetMovedCount() == 0 );
+
+        // 移動したプロキシが関わる, 太らせたボックス同士の重なりだけが報告される.
+        std::vector<u64> expected;
+        for( u32 i=0; i<count; ++i )
+        {
+            TEST_CHECK( tree.GetUserData( proxies[i] ) == i );
+            for( u32 j=i + 1; j<count; ++j )
+            {
+                if ( moved[i] == 0 && moved[j] == 0 )
+                { continue; }
+                if ( !tree.GetFatBounds( proxies[i] ).Intersects( tree.GetFatBounds( proxies[j] ) ) )
+                { continue; }
+                auto a = std::min( proxies[i], proxies[j] );
+                auto b = std::max( proxies[i], proxies[j] );
+                expected.push_back( ( u64( a ) << 32 ) | b );
+            }
+        }
+        std::sort( expected.begin(), expected.end() );
+        TEST_CHECK( ToPairKeys( pairs ) == expected );
+
+        // 少しずつ動かすものと大きく動かすものを混ぜる.
+        std::fill( moved.begin(), moved.end(), u8( 0 ) );
+        for( u32 i=step; i<count; i+=3 )
+        {
+            auto scale = ( i % 13 == 0 ) ? 5.0f : 0.05f;
+            asdx::Vector3 delta( random.GetAsF32( -scale, scale ), random.GetAsF32( -scale, scale ), random.GetAsF32( -scale, scale ) );
+            boxes[i] = asdx::BoundingBox( boxes[i].Mini + delta, boxes[i].Maxi + delta );
+            moved[i] = tree.MoveProxy( proxies[i], boxes[i], delta ) ? 1 : 0;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      FrameAllocator の確保, 再利用, 統計情報を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestFrameAllocator()
+{
+    const size_t chunkSize = 4096;
+    asdx::FrameAllocator allocator;
+    TEST_CHECK( allocator.Init( 2, chunkSize ) );
+
+    // アライメントが守られ, 確保した領域が重ならない.
+    {
+        struct Range { uintptr_t Begin; uintptr_t End; };
+        std::vector<Range> ranges;
+        u32 state = 97531;
+        u64 bytes = 0;
+        for( u32 i=0; i<500; ++i )
+        {
+            size_t size      = 1 + size_t( TestRandom( state, 0.0f, 300.0f ) );
+            size_t alignment = size_t( 1 ) << ( i % 8 );
+            auto ptr = allocator.Alloc( size, alignment );
+            TEST_CHECK( ptr != nullptr );
+            TEST_CHECK( ( reinterpret_cast<uintptr_t>( ptr ) & ( alignment - 1 ) ) == 0 );
+            memset( ptr, 0xcd, size );
+            ranges.push_back( { reinterpret_cast<uintptr_t>( ptr ), reinterpret_cast<uintptr_t>( ptr ) + size } );
+            bytes += size;
+        }
+        TEST_CHECK( allocator.GetCurrentFrameBytes() == bytes );
+
+        std::sort( ranges.begin(), ranges.end(), []( const Range& a, const Range& b ) { return a.Begin < b.Begin; } );
+        for( size_t i=1; i<ranges.size(); ++i )
+        { TEST_CHECK( ranges[i - 1].End <= ranges[i].Begin ); }
+
+        auto array = allocator.AllocArray<asdx::Vector4A>( 3 );
+        TEST_CHECK( ( reinterpret_cast<uintptr_t>( array ) & ( alignof(asdx::Vector4A) - 1 ) ) == 0 );
+        bytes += sizeof(asdx::Vector4A) * 3;
+
+        allocator.NextFrame();
+        TEST_CHECK( allocator.GetStats().FrameBytes == bytes );
+        TEST_CHECK( allocator.GetStats().PeakFrameBytes == bytes );
+        TEST_CHECK( allocator.GetStats().FrameChunks == allocator.GetStats().TotalChunks );
+        TEST_CHECK( allocator.GetCurrentFrameBytes() == 0 );
+    }
+
+    // フレーム数分進めるとチャンクが再利用され, OS から新たに確保しない.
+    {
+        for( u32 frame=0; frame<6; ++frame )
+        {
+            for( u32 i=0; i<40; ++i )
+            { TEST_CHECK( allocator.Alloc( 256 ) != nullptr ); }
+            allocator.NextFrame();
+        }
+        auto total = allocator.GetStats().TotalChunks;
+        for( u32 frame=0; frame<6; ++frame )
+        {
+            for( u32 i=0; i<40; ++i )
+            { TEST_CHECK( allocator.Alloc( 256 ) != nullptr ); }
+            allocator.NextFrame();
+        }
+        TEST_CHECK( allocator.GetStats().TotalChunks == total );
+        TEST_CHECK( allocator.GetStats().FrameBytes == 40 * 256 );
+    }
+
+    // チャンクに収まらないものは個別に確保され, 再利用時に解放される.
+    {
+        auto count = allocator.GetStats().LargeAllocCount;
+        auto ptr = static_cast<u8*>( allocator.Alloc( chunkSize * 3, 64 ) );
+        TEST_CHECK( ptr != nullptr );
+        TEST_CHECK( ( reinterpret_cast<uintptr_t>( ptr ) & 63 ) == 0 );
+        memset( ptr, 0xab, chunkSize * 3 );
+        TEST_CHECK( allocator.GetStats().LargeAllocCount == count + 1 );
+        TEST_CHECK( allocator.GetCurrentFrameBytes() == chunkSize * 3 );
+        allocator.NextFrame();
+        allocator.NextFrame();
+    }
+
+    // 複数スレッドから同時に確保しても領域が重ならない.
+    {
+        const u32 threadCount = 4;
+        const u32 allocCount  = 2000;
+        std::vector<std::vector<u32*>> results( threadCount );
+        std::vector<std::thread> threads;
+        for( u32 t=0; t<threadCount; ++t )
+        {
+            threads.emplace_back( [&, t]()
+            {
+                for( u32 i=0; i<allocCount; ++i )
+                {
+                    auto ptr = allocator.AllocArray<u32>( 4 );
+                    if ( ptr == nullptr )
+                    { continue; }
+                    for( u32 k=0; k<4; ++k )
+                    { ptr[k] = t * allocCount + i; }
+                    results[t].push_back( ptr );
+                }
+            });
+        }
+        for( auto& thread : threads )
+        { thread.join(); }
+
+        u32 broken = 0;
+        for( u32 t=0; t<threadCount; ++t )
+        {
+            TEST_CHECK( results[t].size() == allocCount );
+            for( u32 i=0; i<u32( results[t].size() ); ++i )
+            {
+                for( u32 k=0; k<4; ++k )
+                { broken += ( results[t][i][k] != t * allocCount + i ) ? 1 : 0; }
+            }
+        }
+        TEST_CHECK( broken == 0 );
+        TEST_CHECK( allocator.GetCurrentFrameBytes() == u64( threadCount ) * allocCount * sizeof(u32) * 4 );
+    }
+
+    allocator.Term();
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ストリーム版の結果が1要素ずつの変換と一致するかどうかチェックします.
+//!
+//! @note       FMA 無効時は同じ順序で加算するのでビット単位で一致します.
+//-------------------------------------------------------------------------------------------------
+bool IsStreamMatch( const asdx::Vector3& a, const asdx::Vector3& b )
+{
+#if ASDX_SIMD_FMA
+    auto scale = std::max( 1.0f, std::max( fabsf( b.x ), std::max( fabsf( b.y ), fabsf( b.z ) ) ) );
+    return IsNear( a.x, b.x, 1e-5f * scale )
+        && IsNear( a.y, b.y, 1e-5f * scale )
+        && IsNear( a.z, b.z, 1e-5f * scale );
+#else
+    return UlpDistance( a.x, b.x ) == 0
+        && UlpDistance( a.y, b.y ) == 0
+        && UlpDistance( a.z, b.z ) == 0;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ストライド付きのストリーム変換と並列版を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestMathTransformStream()
+{
+    // 頂点バッファを模したインターリーブ配置.
+    struct Vertex
+    {
+        asdx::Vector3   Position;
+        asdx::Vector3   Normal;
+        asdx::Vector2   TexCoord;
+    };
+    const u32 stride = sizeof(Vertex);
+
+    u32 state = 8642;
+    asdx::Matrix matrix;
+    for( u32 r=0; r<4; ++r )
+    {
+        for( u32 c=0; c<4; ++c )
+        { matrix.m[r][c] = TestRandom( state, -2.0f, 2.0f ); }
+    }
+    // TransformCoord() の W が 0 付近にならないようにする.
+    matrix._14 = TestRandom( state, -0.1f, 0.1f );
+    matrix._24 = TestRandom( state, -0.1f, 0.1f );
+    matrix._34 = TestRandom( state, -0.1f, 0.1f );
+    matrix._44 = 4.0f;
+
+    // AVX2 で8個ずつ処理する経路と端数の経路の両方を通す.
+    const u32 counts[] = { 1, 7, 8, 37, 100003 };
+    for( auto count : counts )
+    {
+        std::vector<Vertex> vertices( count );
+        for( auto& v : vertices )
+        {
+            v.Position = asdx::Vector3( TestRandom( state, -4.0f, 4.0f ), TestRandom( state, -4.0f, 4.0f ), TestRandom( state, -4.0f, 4.0f ) );
+            v.Normal   = asdx::Vector3( TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ) );
+            v.TexCoord = asdx::Vector2( TestRandom( state, 0.0f, 1.0f ), TestRandom( state, 0.0f, 1.0f ) );
+        }
+
+        std::vector<asdx::Vector3> positions( count ), normals( count ), coords( count );
+        asdx::Vector3::TransformStream      ( &vertices[0].Position, stride, count, matrix, positions.data(), sizeof(asdx::Vector3) );
+        asdx::Vector3::TransformNormalStream( &vertices[0].Normal,   stride, count, matrix, normals  .data(), sizeof(asdx::Vector3) );
+        asdx::Vector3::TransformCoordStream ( &vertices[0].Position, stride, count, matrix, coords   .data(), sizeof(asdx::Vector3) );
+
+        u32 mismatch = 0;
+        for( u32 i=0; i<count; ++i )
+        {
+            mismatch += IsStreamMatch( positions[i], asdx::Vector3::Transform      ( vertices[i].Position, matrix ) ) ? 0 : 1;
+            mismatch += IsStreamMatch( normals  [i], asdx::Vector3::TransformNormal( vertices[i].Normal,   matrix ) ) ? 0 : 1;
+            mismatch += IsStreamMatch( coords   [i], asdx::Vector3::TransformCoord ( vertices[i].Position, matrix ) ) ? 0 : 1;
+        }
+        TEST_CHECK( mismatch == 0 );
+
+        // 法線の変換は平行移動を含まない行ベクトルと 3x3 部分の積.
+        {
+            const auto& n = vertices[0].Normal;
+            asdx::Vector3 expected(
+                ( ( n.x * matrix._11 ) + ( n.y * matrix._21 ) ) + ( n.z * matrix._31 ),
+                ( ( n.x * matrix._12 ) + ( n.y * matrix._22 ) ) + ( n.z * matrix._32 ),
+                ( ( n.x * matrix._13 ) + ( n.y * matrix._23 ) ) + ( n.z * matrix._33 ) );
+            TEST_CHECK( IsStreamMatch( normals[0], expected ) );
+        }
+
+        // 並列版は同じ境界で分割されるので逐次版とビット単位で一致する.
+        std::vector<asdx::Vector3> parallel( count );
+        asdx::ParallelTransformStream( &vertices[0].Position, stride, count, matrix, parallel.data(), sizeof(asdx::Vector3) );
+        TEST_CHECK( memcmp( parallel.data(), positions.data(), sizeof(asdx::Vector3) * count ) == 0 );
+        asdx::ParallelTransformNormalStream( &vertices[0].Normal, stride, count, matrix, parallel.data(), sizeof(asdx::Vector3) );
+        TEST_CHECK( memcmp( parallel.data(), normals.data(), sizeof(asdx::Vector3) * count ) == 0 );
+        asdx::ParallelTransformCoordStream( &vertices[0].Position, stride, count, matrix, parallel.data(), sizeof(asdx::Vector3) );
+        TEST_CHECK( memcmp( parallel.data(), coords.data(), sizeof(asdx::Vector3) * count ) == 0 );
+
+        // 同じバッファへの書き込みも許される. UV は書き換えられない.
+        auto texCoord = vertices[count - 1].TexCoord;
+        asdx::Vector3::TransformStream( &vertices[0].Position, stride, count, matrix, &vertices[0].Position, stride );
+        TEST_CHECK( memcmp( &vertices[count - 1].TexCoord, &texCoord, sizeof(texCoord) ) == 0 );
+        mismatch = 0;
+        for( u32 i=0; i<count; ++i )
+        { mismatch += ( memcmp( &vertices[i].Position, &positions[i], sizeof(asdx::Vector3) ) == 0 ) ? 0 : 1; }
+        TEST_CHECK( mismatch == 0 );
+
+        // Vector4 版.
+        std::vector<asdx::Vector4> input( count ), output( count ), outputParallel( count );
+        for( u32 i=0; i<count; ++i )
+        { input[i] = asdx::Vector4( vertices[i].Normal, 1.0f ); }
+        asdx::Vector4::TransformStream( input.data(), sizeof(asdx::Vector4), count, matrix, output.data(), sizeof(asdx::Vector4) );
+        asdx::ParallelTransformStream( input.data(), sizeof(asdx::Vector4), count, matrix, outputParallel.data(), sizeof(asdx::Vector4) );
+        TEST_CHECK( memcmp( output.data(), outputParallel.data(), sizeof(asdx::Vector4) * count ) == 0 );
+        mismatch = 0;
+        for( u32 i=0; i<count; ++i )
+        {
+            auto expected = asdx::Vector4::Transform( input[i], matrix );
+            mismatch += IsStreamMatch( asdx::Vector3( output[i].x, output[i].y, output[i].z ), asdx::Vector3( expected.x, expected.y, expected.z ) ) ? 0 : 1;
+            mismatch += IsStreamMatch( asdx::Vector3( output[i].w, 0.0f, 0.0f ), asdx::Vector3( expected.w, 0.0f, 0.0f ) ) ? 0 : 1;
+        }
+        TEST_CHECK( mismatch == 0 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      テスト用のアフィン変換行列(回転, 拡大縮小, 平行移動)を生成します.
+//!
+//! @param [in]     rigid       true の場合は拡大縮小を含めません.
+//-------------------------------------------------------------------------------------------------
+asdx::Matrix MakeAffineMatrix( u32& state, bool rigid )
+{
+    auto q = asdx::Quaternion::Normalize( asdx::Quaternion(
+        TestRandom( state, -1.0f, 1.0f ),
+        TestRandom( state, -1.0f, 1.0f ),
+        TestRandom( state, -1.0f, 1.0f ),
+        TestRandom( state, 0.1f, 1.0f ) ) );
+
+    auto scale = rigid
+        ? asdx::Matrix::CreateScale( 1.0f )
+        : asdx::Matrix::CreateScale( TestRandom( state, 0.5f, 2.0f ), TestRandom( state, 0.5f, 2.0f ), TestRandom( state, 0.5f, 2.0f ) );
+    auto translation = asdx::Matrix::CreateTranslation( TestRandom( state, -10.0f, 10.0f ), TestRandom( state, -10.0f, 10.0f ), TestRandom( state, -10.0f, 10.0f ) );
+
+    return scale * asdx::Matrix::CreateFromQuaternion( q ) * translation;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Matrix3x4 と Matrix の対応する要素が許容誤差内で一致するかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool IsAffineNear( const asdx::Matrix3x4& a, const asdx::Matrix& b, f32 epsilon )
+{
+    auto m = a.ToMatrix();
+    for( u32 r=0; r<4; ++r )
+    {
+        for( u32 c=0; c<4; ++c )
+        {
+            if ( !IsNear( m.m[r][c], b.m[r][c], epsilon ) )
+            { return false; }
+        }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Matrix3x4 の積, 逆行列, 変換が Matrix の結果と一致することを確認します.
+//-------------------------------------------------------------------------------------------------
+void TestMatrix3x4()
+{
+    u32 state = 24680;
+    for( u32 n=0; n<500; ++n )
+    {
+        auto a = MakeAffineMatrix( state, false );
+        auto b = MakeAffineMatrix( state, false );
+        asdx::Matrix3x4 a34( a );
+        asdx::Matrix3x4 b34( b );
+
+        // HLSL の float3x4 と同じく転置して格納し, 変換は往復で失われない.
+        TEST_CHECK( a34._14 == a._41 && a34._24 == a._42 && a34._34 == a._43 );
+        TEST_CHECK( a34.ToMatrix() == a );
+
+        // 積は Matrix と同じ順序(a の後に b).
+        TEST_CHECK( IsAffineNear( asdx::Matrix3x4::Multiply( a34, b34 ), asdx::Matrix::Multiply( a, b ), 1e-4f ) );
+        TEST_CHECK( IsAffineNear( a34 * b34, a * b, 1e-4f ) );
+        TEST_CHECK( IsNear( a34.Determinant(), a.Determinant(), 1e-4f * fabsf( a.Determinant() ) ) );
+
+        auto inv = asdx::Matrix3x4::Invert( a34 );
+        TEST_CHECK( IsAffineNear( inv, asdx::Matrix::Invert( a ), 1e-4f ) );
+        TEST_CHECK( IsAffineNear( inv * a34, asdx::Matrix::Identity(), 1e-4f ) );
+
+        // 剛体変換では転置による逆行列が一般の逆行列と一致する.
+        auto rigid = MakeAffineMatrix( state, true );
+        asdx::Matrix3x4 rigid34( rigid );
+        TEST_CHECK( IsAffineNear( asdx::Matrix3x4::InvertRigid( rigid34 ), asdx::Matrix::Invert( rigid ), 1e-4f ) );
+        TEST_CHECK( IsNear( rigid34.Determinant(), 1.0f, 1e-5f ) );
+
+        asdx::Vector3 v( TestRandom( state, -5.0f, 5.0f ), TestRandom( state, -5.0f, 5.0f ), TestRandom( state, -5.0f, 5.0f ) );
+        auto p0 = asdx::Vector3::Transform( v, a34 );
+        auto p1 = asdx::Vector3::Transform( v, a );
+        TEST_CHECK( IsNear( p0.x, p1.x, 1e-4f ) && IsNear( p0.y, p1.y, 1e-4f ) && IsNear( p0.z, p1.z, 1e-4f ) );
+        auto n0 = asdx::Vector3::TransformNormal( v, a34 );
+        auto n1 = asdx::Vector3::TransformNormal( v, a );
+        TEST_CHECK( IsNear( n0.x, n1.x, 1e-4f ) && IsNear( n0.y, n1.y, 1e-4f ) && IsNear( n0.z, n1.z, 1e-4f ) );
+    }
+
+    // 正規化したクォータニオンからの回転行列は正規直交.
+    for( u32 n=0; n<100; ++n )
+    {
+        auto m = MakeAffineMatrix( state, true );
+        auto product = m * asdx::Matrix::Transpose( m );
+        for( u32 r=0; r<3; ++r )
+        {
+            for( u32 c=0; c<3; ++c )
+            { TEST_CHECK( IsNear( product.m[r][c], ( r == c ) ? 1.0f : 0.0f, 1e-5f ) ); }
+        }
+    }
+
+    TEST_CHECK( asdx::Matrix3x4::Identity().ToMatrix() == asdx::Matrix::Identity() );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      半精度のビット列を倍精度に変換します. 比較用です.
+//-------------------------------------------------------------------------------------------------
+f64 DecodeHalfReference( f16 value )
+{
+    auto sign     = ( value & 0x8000 ) ? -1.0 : 1.0;
+    auto exponent = ( value >> 10 ) & 0x1f;
+    auto mantissa = value & 0x3ff;
+    if ( exponent == 0 )
+    { return sign * ldexp( f64( mantissa ), -24 ); }
+    if ( exponent == 31 )
+    { return ( mantissa == 0 ) ? sign * std::numeric_limits<f64>::infinity() : std::numeric_limits<f64>::quiet_NaN(); }
+    return sign * ldexp( f64( mantissa | 0x400 ), exponent - 25 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      半精度変換の往復, 丸め, 特殊値とストリーム版の一致を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestF16Conversion()
+{
+    // 全ての半精度の値が正しく展開され, 往復で元に戻る.
+    std::vector<f16> halves( 65536 );
+    std::vector<f32> floats( 65536 );
+    for( u32 i=0; i<65536; ++i )
+    { halves[i] = f16( i ); }
+    asdx::F16ToF32Stream( halves.data(), 65536, floats.data() );
+
+    u32 mismatch = 0;
+    for( u32 i=0; i<65536; ++i )
+    {
+        auto h   = f16( i );
+        auto f   = asdx::F16ToF32( h );
+        auto ref = DecodeHalfReference( h );
+        if ( ref != ref )
+        {
+            mismatch += ( f != f && floats[i] != floats[i] ) ? 0 : 1;
+            auto back = asdx::F32ToF16( f );
+            mismatch += ( ( back & 0x7c00 ) == 0x7c00 && ( back & 0x3ff ) != 0 ) ? 0 : 1;
+            continue;
+        }
+        mismatch += ( f64( f ) == ref ) ? 0 : 1;
+        mismatch += ( memcmp( &f, &floats[i], sizeof(f) ) == 0 ) ? 0 : 1;
+        mismatch += ( asdx::F32ToF16( f ) == h ) ? 0 : 1;
+    }
+    TEST_CHECK( mismatch == 0 );
+
+    // 境界値と最近接偶数丸め.
+    const f32 inf = std::numeric_limits<f32>::infinity();
+    TEST_CHECK( asdx::F32ToF16(  1.0f )                     == 0x3c00 );
+    TEST_CHECK( asdx::F32ToF16( -2.0f )                     == 0xc000 );
+    TEST_CHECK( asdx::F32ToF16(  0.0f )                     == 0x0000 );
+    TEST_CHECK( asdx::F32ToF16( -0.0f )                     == 0x8000 );
+    TEST_CHECK( asdx::F32ToF16( 65504.0f )                  == 0x7bff );
+    TEST_CHECK( asdx::F32ToF16( 65519.0f )                  == 0x7bff );
+    TEST_CHECK( asdx::F32ToF16( 65520.0f )                  == 0x7c00 );
+    TEST_CHECK( asdx::F32ToF16( 1e10f )                     == 0x7c00 );
+    TEST_CHECK( asdx::F32ToF16( -inf )                      == 0xfc00 );
+    TEST_CHECK( asdx::F32ToF16( 1.0f + ldexpf( 1.0f, -11 ) ) == 0x3c00 );
+    TEST_CHECK( asdx::F32ToF16( 1.0f + ldexpf( 3.0f, -11 ) ) == 0x3c02 );
+    TEST_CHECK( asdx::F32ToF16( ldexpf( 1.0f, -24 ) )       == 0x0001 );
+    TEST_CHECK( asdx::F32ToF16( ldexpf( 1.0f, -25 ) )       == 0x0000 );
+    TEST_CHECK( asdx::F32ToF16( ldexpf( 3.0f, -25 ) )       == 0x0002 );
+    TEST_CHECK( asdx::F32ToF16( ldexpf( 1.0f, -40 ) )       == 0x0000 );
+    TEST_CHECK( asdx::F32ToF16( -FLT_MIN )                  == 0x8000 );
+    TEST_CHECK( asdx::F16ToF32( 0x7c00 )                    == inf );
+    TEST_CHECK( asdx::F16ToF32( 0xfc00 )                    == -inf );
+
+    // 任意の単精度は最も近い半精度に丸められ, 等距離の場合は偶数側を選ぶ.
+    {
+        const u32 count = 1 << 16;
+        std::vector<f32> input( count );
+        std::vector<f16> output( count );
+        u32 bits = 0x12345;
+        for( u32 i=0; i<count; ++i )
+        {
+            bits += 0x10000 + 0x3fff;
+            f32 value;
+            memcpy( &value, &bits, sizeof(value) );
+            input[i] = ( value != value ) ? 0.0f : value;
+        }
+        asdx::F32ToF16Stream( input.data(), count, output.data() );
+
+        mismatch = 0;
+        for( u32 i=0; i<count; ++i )
+        {
+            auto x = f64( input[i] );
+            auto h = asdx::F32ToF16( input[i] );
+            mismatch += ( h == output[i] ) ? 0 : 1;
+
+            auto magnitude = h & 0x7fff;
+            if ( fabs( x ) >= 65520.0 )
+            { mismatch += ( magnitude == 0x7c00 ) ? 0 : 1; continue; }
+
+            auto error = fabs( DecodeHalfReference( h ) - x );
+            auto sign  = h & 0x8000;
+            if ( magnitude < 0x7bff )
+            {
+                auto e = fabs( DecodeHalfReference( f16( sign | ( magnitude + 1 ) ) ) - x );
+                mismatch += ( error < e || ( error == e && ( h & 1 ) == 0 ) ) ? 0 : 1;
+            }
+            if ( magnitude > 0 )
+            {
+                auto e = fabs( DecodeHalfReference( f16( sign | ( magnitude - 1 ) ) ) - x );
+                mismatch += ( error < e || ( error == e && ( h & 1 ) == 0 ) ) ? 0 : 1;
+            }
+        }
+        TEST_CHECK( mismatch == 0 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      テスト用の単位ベクトルを生成します. 軸方向と八面体の折り返しの境界を含めます.
+//-------------------------------------------------------------------------------------------------
+asdx::Vector3 MakeTestUnitVector( u32& state, u32 index )
+{
+    static const asdx::Vector3 kSpecial[] = {
+        asdx::Vector3(  1.0f,  0.0f,  0.0f ), asdx::Vector3( -1.0f,  0.0f,  0.0f ),
+        asdx::Vector3(  0.0f,  1.0f,  0.0f ), asdx::Vector3(  0.0f, -1.0f,  0.0f ),
+        asdx::Vector3(  0.0f,  0.0f,  1.0f ), asdx::Vector3(  0.0f,  0.0f, -1.0f ),
+        asdx::Vector3(  0.6f,  0.8f,  0.0f ), asdx::Vector3( -0.6f, -0.8f, -0.0f ),
+    };
+    const u32 specialCount = sizeof(kSpecial) / sizeof(kSpecial[0]);
+    if ( index < specialCount )
+    { return kSpecial[index]; }
+
+    for( ;; )
+    {
+        asdx::Vector3 v( TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ) );
+        auto len = v.Length();
+        if ( len > 0.1f && len <= 1.0f )
+        { return v / len; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ストリーム版の復元結果がスカラー版と一致するかどうかチェックします.
+//!
+//! @note       FMA 有効時はコンパイラがスカラー版の積和を縮約するので, 数 ULP の差を許します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+bool IsDecodeMatch( const T& a, const T& b )
+{
+    const f32* pA = &a.x;
+    const f32* pB = &b.x;
+    for( u32 i=0; i<sizeof(T) / sizeof(f32); ++i )
+    {
+#if ASDX_SIMD_FMA
+        if ( UlpDistance( pA[i], pB[i] ) > 4 && !IsNear( pA[i], pB[i], 1e-7f ) )
+        { return false; }
+#else
+        if ( UlpDistance( pA[i], pB[i] ) != 0 )
+        { return false; }
+#endif
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      SNORM/UNORM の変換規則とストリーム版の一致を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestQuantizationNorm()
+{
+    // 範囲外は飽和し, NaN は下限になる. 復元時は -128 / -32768 も -1 になる.
+    const f32 nan = std::numeric_limits<f32>::quiet_NaN();
+    TEST_CHECK( asdx::EncodeSnorm8 (  1.0f ) ==  127 );
+    TEST_CHECK( asdx::EncodeSnorm8 ( -3.0f ) == -127 );
+    TEST_CHECK( asdx::EncodeSnorm16( -1.0f ) == -32767 );
+    TEST_CHECK( asdx::EncodeUnorm8 (  2.0f ) == 255 );
+    TEST_CHECK( asdx::EncodeUnorm8 ( -1.0f ) == 0 );
+    TEST_CHECK( asdx::EncodeUnorm16(  nan  ) == 0 );
+    TEST_CHECK( asdx::EncodeSnorm16(  nan  ) == -32767 );
+    TEST_CHECK( asdx::DecodeSnorm8 ( -128 ) == -1.0f );
+    TEST_CHECK( asdx::DecodeSnorm16( -32768 ) == -1.0f );
+    TEST_CHECK( asdx::DecodeUnorm16( 65535 ) == 1.0f );
+
+    // 全ての符号が往復で元に戻る.
+    u32 mismatch = 0;
+    for( s32 c=-127; c<=127; ++c )
+    { mismatch += ( asdx::EncodeSnorm8( asdx::DecodeSnorm8( s8( c ) ) ) == c ) ? 0 : 1; }
+    for( s32 c=-32767; c<=32767; ++c )
+    { mismatch += ( asdx::EncodeSnorm16( asdx::DecodeSnorm16( s16( c ) ) ) == c ) ? 0 : 1; }
+    for( u32 c=0; c<=255; ++c )
+    { mismatch += ( asdx::EncodeUnorm8( asdx::DecodeUnorm8( u8( c ) ) ) == c ) ? 0 : 1; }
+    for( u32 c=0; c<=65535; ++c )
+    { mismatch += ( asdx::EncodeUnorm16( asdx::DecodeUnorm16( u16( c ) ) ) == c ) ? 0 : 1; }
+    TEST_CHECK( mismatch == 0 );
+
+    // ストリーム版は範囲外や NaN を含めてスカラー版とビット単位で一致する.
+    const u32 count = 67;
+    std::vector<f32> input( count );
+    u32 state = 1122;
+    for( u32 i=0; i<count; ++i )
+    { input[i] = ( i % 17 == 3 ) ? nan : TestRandom( state, -1.5f, 1.5f ); }
+
+    std::vector<s8>  s8s ( count );
+    std::vector<s16> s16s( count );
+    std::vector<u8>  u8s ( count );
+    std::vector<u16> u16s( count );
+    asdx::EncodeSnorm8Stream ( input.data(), count, s8s .data() );
+    asdx::EncodeSnorm16Stream( input.data(), count, s16s.data() );
+    asdx::EncodeUnorm8Stream ( input.data(), count, u8s .data() );
+    asdx::EncodeUnorm16Stream( input.data(), count, u16s.data() );
+
+    std::vector<f32> decoded( count );
+    mismatch = 0;
+    for( u32 i=0; i<count; ++i )
+    {
+        mismatch += ( s8s [i] == asdx::EncodeSnorm8 ( input[i] ) ) ? 0 : 1;
+        mismatch += ( s16s[i] == asdx::EncodeSnorm16( input[i] ) ) ? 0 : 1;
+        mismatch += ( u8s [i] == asdx::EncodeUnorm8 ( input[i] ) ) ? 0 : 1;
+        mismatch += ( u16s[i] == asdx::EncodeUnorm16( input[i] ) ) ? 0 : 1;
+    }
+    asdx::DecodeSnorm8Stream( s8s.data(), count, decoded.data() );
+    for( u32 i=0; i<count; ++i )
+    { mismatch += ( decoded[i] == asdx::DecodeSnorm8( s8s[i] ) ) ? 0 : 1; }
+    asdx::DecodeSnorm16Stream( s16s.data(), count, decoded.data() );
+    for( u32 i=0; i<count; ++i )
+    { mismatch += ( decoded[i] == asdx::DecodeSnorm16( s16s[i] ) ) ? 0 : 1; }
+    asdx::DecodeUnorm8Stream( u8s.data(), count, decoded.data() );
+    for( u32 i=0; i<count; ++i )
+    { mismatch += ( decoded[i] == asdx::DecodeUnorm8( u8s[i] ) ) ? 0 : 1; }
+    asdx::DecodeUnorm16Stream( u16s.data(), count, decoded.data() );
+    for( u32 i=0; i<count; ++i )
+    { mismatch += ( decoded[i] == asdx::DecodeUnorm16( u16s[i] ) ) ? 0 : 1; }
+    TEST_CHECK( mismatch == 0 );
+
+    // 範囲内の値の誤差は半ステップ以内.
+    std::vector<f32> clamped( count );
+    for( u32 i=0; i<count; ++i )
+    { clamped[i] = ( input[i] != input[i] ) ? -1.0f : asdx::Clamp( input[i], -1.0f, 1.0f ); }
+    asdx::EncodeSnorm16Stream( clamped.data(), count, s16s.data() );
+    asdx::DecodeSnorm16Stream( s16s.data(), count, decoded.data() );
+    auto error = asdx::ComputeQuantizationError( clamped.data(), decoded.data(), count );
+    TEST_CHECK( error.MaxError <= 0.5f / 32767.0f + 1e-7f );
+    TEST_CHECK( error.MeanError <= error.RmsError && error.RmsError <= error.MaxError );
+
+    const f32 original[] = { 0.0f, 1.0f, 2.0f };
+    const f32 approx  [] = { 0.0f, 1.5f, 1.0f };
+    error = asdx::ComputeQuantizationError( original, approx, 3 );
+    TEST_CHECK( error.MaxError == 1.0f );
+    TEST_CHECK( IsNear( error.MeanError, 0.5f ) );
+    TEST_CHECK( IsNear( error.RmsError, sqrtf( 1.25f / 3.0f ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      八面体表現の法線と接線, R10G10B10A2, 位置座標の量子化を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestQuantizationVertex()
+{
+    // インターリーブ配置の頂点を模したデータ.
+    struct Vertex
+    {
+        asdx::Vector3   Position;
+        asdx::Vector3   Normal;
+        asdx::Vector4   Tangent;
+        asdx::Vector4   Color;
+    };
+    struct Packed
+    {
+        u16     Position[3];
+        u16     Normal8;
+        u32     Normal16;
+        u32     Tangent;
+        u32     Color;
+    };
+    const u32 count = 1003;
+    const u32 vs = sizeof(Vertex);
+    const u32 ps = sizeof(Packed);
+
+    asdx::Vector3 boxMin( -3.0f, 0.0f, 10.0f );
+    asdx::Vector3 boxMax(  5.0f, 0.0f, 12.0f );   // Y は幅 0 の退化した軸.
+
+    u32 state = 3344;
+    std::vector<Vertex> vertices( count );
+    for( u32 i=0; i<count; ++i )
+    {
+        auto& v = vertices[i];
+        v.Position = asdx::Vector3( TestRandom( state, boxMin.x, boxMax.x ), 0.0f, TestRandom( state, boxMin.z, boxMax.z ) );
+        v.Normal   = MakeTestUnitVector( state, i );
+        auto t     = MakeTestUnitVector( state, i + 3 );
+        v.Tangent  = asdx::Vector4( t.x, t.y, t.z, ( i & 1 ) ? -1.0f : 1.0f );
+        v.Color    = asdx::Vector4( TestRandom( state, 0.0f, 1.0f ), TestRandom( state, 0.0f, 1.0f ), TestRandom( state, 0.0f, 1.0f ), TestRandom( state, 0.0f, 1.0f ) );
+    }
+    vertices[1].Position = boxMin;
+    vertices[2].Position = boxMax;
+
+    std::vector<Packed> packed( count );
+    asdx::EncodePosition16Stream ( &vertices[0].Position, vs, count, boxMin, boxMax, packed[0].Position, ps );
+    asdx::EncodeNormalOct8Stream ( &vertices[0].Normal,   vs, count, &packed[0].Normal8,  ps );
+    asdx::EncodeNormalOct16Stream( &vertices[0].Normal,   vs, count, &packed[0].Normal16, ps );
+    asdx::EncodeTangentOctStream ( &vertices[0].Tangent,  vs, count, &packed[0].Tangent,  ps );
+    asdx::EncodeR10G10B10A2Stream( &vertices[0].Color,    vs, count, &packed[0].Color,    ps );
+
+    // 符号化はストリーム版とスカラー版がビット単位で一致する.
+    u32 mismatch = 0;
+    for( u32 i=0; i<count; ++i )
+    {
+        u16 position[3];
+        asdx::EncodePosition16( vertices[i].Position, boxMin, boxMax, position );
+        mismatch += ( memcmp( position, packed[i].Position, sizeof(position) ) == 0 ) ? 0 : 1;
+        mismatch += ( packed[i].Normal8  == asdx::EncodeNormalOct8 ( vertices[i].Normal ) )  ? 0 : 1;
+        mismatch += ( packed[i].Normal16 == asdx::EncodeNormalOct16( vertices[i].Normal ) )  ? 0 : 1;
+        mismatch += ( packed[i].Tangent  == asdx::EncodeTangentOct ( vertices[i].Tangent ) ) ? 0 : 1;
+        mismatch += ( packed[i].Color    == asdx::EncodeR10G10B10A2( vertices[i].Color ) )   ? 0 : 1;
+    }
+    TEST_CHECK( mismatch == 0 );
+
+    std::vector<Vertex> decoded( count );
+    asdx::DecodePosition16Stream ( packed[0].Position,  ps, count, boxMin, boxMax, &decoded[0].Position, vs );
+    asdx::DecodeNormalOct16Stream( &packed[0].Normal16, ps, count, &decoded[0].Normal,  vs );
+    asdx::DecodeTangentOctStream ( &packed[0].Tangent,  ps, count, &decoded[0].Tangent, vs );
+    asdx::DecodeR10G10B10A2Stream( &packed[0].Color,    ps, count, &decoded[0].Color,   vs );
+
+    mismatch = 0;
+    for( u32 i=0; i<count; ++i )
+    {
+        mismatch += IsDecodeMatch( decoded[i].Position, asdx::DecodePosition16( packed[i].Position, boxMin, boxMax ) ) ? 0 : 1;
+        mismatch += IsDecodeMatch( decoded[i].Normal,   asdx::DecodeNormalOct16( packed[i].Normal16 ) ) ? 0 : 1;
+        mismatch += IsDecodeMatch( decoded[i].Tangent,  asdx::DecodeTangentOct ( packed[i].Tangent ) ) ? 0 : 1;
+        mismatch += IsDecodeMatch( decoded[i].Color,    asdx::DecodeR10G10B10A2( packed[i].Color ) ) ? 0 : 1;
+        mismatch += ( decoded[i].Tangent.w == vertices[i].Tangent.w ) ? 0 : 1;
+    }
+    TEST_CHECK( mismatch == 0 );
+
+    // 誤差は精度から決まる上限以内. 角度は度数法で NormalOct16 0.01, NormalOct8 1.0, TangentOct 0.01.
+    const f32 toDegree = 180.0f / asdx::F_PI;
+    auto normalError = asdx::ComputeAngularError( &vertices[0].Normal, vs, &decoded[0].Normal, vs, count );
+    TEST_CHECK( normalError.MaxError * toDegree < 0.01f );
+
+    auto tangentError = asdx::ComputeAngularError(
+        reinterpret_cast<const asdx::Vector3*>( &vertices[0].Tangent ), vs,
+        reinterpret_cast<const asdx::Vector3*>( &decoded[0].Tangent ), vs, count );
+    TEST_CHECK( tangentError.MaxError * toDegree < 0.01f );
+
+    asdx::DecodeNormalOct8Stream( &packed[0].Normal8, ps, count, &decoded[0].Normal, vs );
+    normalError = asdx::ComputeAngularError( &vertices[0].Normal, vs, &decoded[0].Normal, vs, count );
+    TEST_CHECK( normalError.MaxError * toDegree < 1.0f );
+    TEST_CHECK( normalError.MeanError <= normalError.MaxError );
+
+    // 軸方向の法線は正確に復元される.
+    for( u32 i=0; i<6; ++i )
+    {
+        auto n = asdx::DecodeNormalOct16( asdx::EncodeNormalOct16( vertices[i].Normal ) );
+        TEST_CHECK( n == vertices[i].Normal );
+    }
+
+    auto positionError = asdx::ComputePositionError( &vertices[0].Position, vs, &decoded[0].Position, vs, count );
+    auto extent = boxMax - boxMin;
+    TEST_CHECK( positionError.MaxError <= 0.5f * extent.Length() / 65535.0f + 1e-5f );
+    TEST_CHECK( decoded[1].Position == boxMin );
+    TEST_CHECK( IsNear( decoded[2].Position.x, boxMax.x ) && IsNear( decoded[2].Position.z, boxMax.z ) );
+
+    mismatch = 0;
+    for( u32 i=0; i<count; ++i )
+    {
+        auto& a = vertices[i].Color;
+        auto& b = decoded[i].Color;
+        mismatch += ( fabsf( a.x - b.x ) <= 0.5f / 1023.0f + 1e-6f ) ? 0 : 1;
+        mismatch += ( fabsf( a.w - b.w ) <= 0.5f / 3.0f + 1e-6f ) ? 0 : 1;
+    }
+    TEST_CHECK( mismatch == 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      RandomN の各レーンが xoshiro128++ のスカラー版と同じ系列になることを確認します.
+//-------------------------------------------------------------------------------------------------
+void TestRandomN()
+{
+    // xoshiro128++ の参照値 (s = { 1, 2, 3, 4 }).
+    {
+        u32 s[4] = { 1, 2, 3, 4 };
+        TEST_CHECK( asdx::detail::Xoshiro128Next( s ) == 0x00000281 );
+        TEST_CHECK( asdx::detail::Xoshiro128Next( s ) == 0x00180387 );
+        TEST_CHECK( asdx::detail::Xoshiro128Next( s ) == 0xc0183387 );
+        TEST_CHECK( asdx::detail::Xoshiro128Next( s ) == 0xd1ae3b02 );
+    }
+
+    // ジャンプは状態遷移の多項式なので, 1ステップ進めることと可換.
+    {
+        static const u32 kJump[4] = { 0x8764000B, 0xF542D2D3, 0x6FA035C3, 0x77F2DB5B };
+        u32 a[4] = { 0x12345678, 0x9abcdef0, 0x0fedcba9, 0x87654321 };
+        u32 b[4] = { a[0], a[1], a[2], a[3] };
+        asdx::detail::Xoshiro128Jump( a, kJump );
+        asdx::detail::Xoshiro128Next( a );
+        asdx::detail::Xoshiro128Next( b );
+        asdx::detail::Xoshiro128Jump( b, kJump );
+        TEST_CHECK( memcmp( a, b, sizeof(a) ) == 0 );
+    }
+
+    // 種から作ったスカラー版の参照系列.
+    const u64 seed  = 20261019;
+    const u32 lanes = asdx::RandomN::LaneCount;
+    const u32 steps = 37;
+    std::vector<u32> reference( steps * lanes );
+    {
+        static const u32 kJump[4] = { 0x8764000B, 0xF542D2D3, 0x6FA035C3, 0x77F2DB5B };
+        auto state = seed;
+        auto a = asdx::detail::SplitMix64( state );
+        auto b = asdx::detail::SplitMix64( state );
+        u32 s[4] = { u32( a ), u32( a >> 32 ), u32( b ), u32( b >> 32 ) };
+        for( u32 lane=0; lane<lanes; ++lane )
+        {
+            if ( lane > 0 )
+            { asdx::detail::Xoshiro128Jump( s, kJump ); }
+            u32 t[4] = { s[0], s[1], s[2], s[3] };
+            for( u32 i=0; i<steps; ++i )
+            { reference[i * lanes + lane] = asdx::detail::Xoshiro128Next( t ); }
+        }
+    }
+
+    {
+        asdx::RandomN random( seed );
+        ASDX_ALIGN(32) u32 block[asdx::RandomN::LaneCount];
+        random.Next( block );
+        TEST_CHECK( memcmp( block, reference.data(), sizeof(block) ) == 0 );
+
+        // 端数のある Fill() は最後のブロックの余りを捨てる.
+        std::vector<u32> values( ( steps - 2 ) * lanes - 3 );
+        random.Fill( values.data(), u32( values.size() ) );
+        TEST_CHECK( memcmp( values.data(), reference.data() + lanes, values.size() * sizeof(u32) ) == 0 );
+        random.Next( block );
+        TEST_CHECK( memcmp( block, reference.data() + ( steps - 1 ) * lanes, sizeof(block) ) == 0 );
+    }
+
+    // f32 と f64 は u32 の系列から変換した値.
+    {
+        asdx::RandomN random( seed );
+        std::vector<f32> values( steps * lanes - 5 );
+        random.Fill( values.data(), u32( values.size() ) );
+        u32 mismatch = 0;
+        for( size_t i=0; i<values.size(); ++i )
+        { mismatch += ( values[i] == asdx::detail::ToUnitF32( reference[i] ) ) ? 0 : 1; }
+        TEST_CHECK( mismatch == 0 );
+
+        random.SetSeed( seed );
+        std::vector<f64> doubles( 2 * lanes + 3 );
+        random.Fill( doubles.data(), u32( doubles.size() ) );
+        for( size_t i=0; i<doubles.size(); ++i )
+        {
+            auto block = i / lanes;
+            auto lane  = i % lanes;
+            auto hi    = reference[( 2 * block     ) * lanes + lane];
+            auto lo    = reference[( 2 * block + 1 ) * lanes + lane];
+            mismatch += ( doubles[i] == asdx::detail::ToUnitF64( hi, lo ) ) ? 0 : 1;
+            mismatch += ( doubles[i] >= 0.0 && doubles[i] < 1.0 ) ? 0 : 1;
+        }
+        TEST_CHECK( mismatch == 0 );
+    }
+
+    // 範囲指定の Fill() は範囲内に収まり, 平均は中央付近になる.
+    {
+        const u32 count = 100003;
+        asdx::RandomN random( 7 );
+        std::vector<u32> bounded( count );
+        random.Fill( bounded.data(), count, 10 );
+        std::vector<u32> histogram( 10, 0 );
+        u32 outside = 0;
+        for( auto v : bounded )
+        {
+            outside += ( v < 10 ) ? 0 : 1;
+            if ( v < 10 )
+            { histogram[v]++; }
+        }
+        TEST_CHECK( outside == 0 );
+        for( auto h : histogram )
+        { TEST_CHECK( h > count / 10 * 9 / 10 && h < count / 10 * 11 / 10 ); }
+
+        std::vector<s32> ranged( count );
+        random.Fill( ranged.data(), count, -5, 3 );
+        f64 sum = 0.0;
+        for( auto v : ranged )
+        {
+            outside += ( v >= -5 && v < 3 ) ? 0 : 1;
+            sum += v;
+        }
+        TEST_CHECK( outside == 0 );
+        TEST_CHECK( fabs( sum / count + 1.5 ) < 0.05 );
+
+        std::vector<f32> floats( count );
+        random.Fill( floats.data(), count, -2.0f, 6.0f );
+        sum = 0.0;
+        for( auto v : floats )
+        {
+            outside += ( v >= -2.0f && v <= 6.0f ) ? 0 : 1;
+            sum += v;
+        }
+        TEST_CHECK( outside == 0 );
+        TEST_CHECK( fabs( sum / count - 2.0 ) < 0.05 );
+    }
+
+    // Split() は現在の系列を返して自身を次の系列に進め, CreateStream() と一致する.
+    {
+        asdx::RandomN random( seed );
+        auto first  = random.Split();
+        auto second = random.Split();
+        TEST_CHECK( first == asdx::RandomN( seed ) );
+        TEST_CHECK( second == asdx::RandomN::CreateStream( seed, 1 ) );
+        TEST_CHECK( random == asdx::RandomN::CreateStream( seed, 2 ) );
+        TEST_CHECK( first != second );
+
+        ASDX_ALIGN(32) u32 a[asdx::RandomN::LaneCount];
+        ASDX_ALIGN(32) u32 b[asdx::RandomN::LaneCount];
+        first .Next( a );
+        second.Next( b );
+        TEST_CHECK( memcmp( a, b, sizeof(a) ) != 0 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      Halton 列と Sobol 列を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestLowDiscrepancy()
+{
+    // 逆基数関数は倍精度で求めた値に丸められる.
+    TEST_CHECK( asdx::RadicalInverse( 0, 2 ) == 0.0f );
+    TEST_CHECK( asdx::RadicalInverse( 1, 2 ) == 0.5f );
+    TEST_CHECK( asdx::RadicalInverse( 3, 2 ) == 0.75f );
+    TEST_CHECK( asdx::RadicalInverse( 6, 2 ) == 0.375f );
+    TEST_CHECK( asdx::RadicalInverse( 0xffffffff, 2 ) < 1.0f );
+    TEST_CHECK( asdx::RadicalInverse( 0xffffffff, 131 ) < 1.0f );
+
+    static const u32 kPrimes[] = { 2, 3, 5, 7, 11, 13, 127, 131 };
+    static const u32 kDimensions[] = { 0, 1, 2, 3, 4, 5, 30, 31 };
+    u32 mismatch = 0;
+    for( u32 p=0; p<8; ++p )
+    {
+        auto base = kPrimes[p];
+        for( u32 index=0; index<5000; index+=7 )
+        {
+            f64 expected = 0.0;
+            f64 factor   = 1.0 / base;
+            for( auto i = index; i > 0; i /= base, factor /= base )
+            { expected += f64( i % base ) * factor; }
+
+            auto value = asdx::RadicalInverse( index, base );
+            mismatch += ( fabs( value - expected ) <= 1e-7 ) ? 0 : 1;
+            mismatch += ( asdx::Halton( index, kDimensions[p] ) == value ) ? 0 : 1;
+        }
+    }
+    TEST_CHECK( mismatch == 0 );
+
+    {
+        f32 points[4 * 3];
+        asdx::FillHalton( 10, 4, 3, points );
+        for( u32 i=0; i<4; ++i )
+        {
+            for( u32 d=0; d<3; ++d )
+            { TEST_CHECK( points[i * 3 + d] == asdx::Halton( 10 + i, d ) ); }
+        }
+    }
+
+    // Sobol 列の最初の2次元は (0, 2)-列: 2^k 個ごとの点は面積 1/2^k の基本区間に1点ずつ入る.
+    const u32 k = 8;
+    const u32 n = 1u << k;
+    const u32 scrambles[][2] = { { 0, 0 }, { 0x9e3779b9, 0x7f4a7c15 } };
+    for( auto& scramble : scrambles )
+    {
+        for( u32 start=0; start<4 * n; start+=n )
+        {
+            std::vector<asdx::Vector2> points( n );
+            for( u32 i=0; i<n; ++i )
+            {
+                points[i].x = asdx::Sobol( start + i, 0, scramble[0] );
+                points[i].y = asdx::Sobol( start + i, 1, scramble[1] );
+            }
+
+            for( u32 a=0; a<=k; ++a )
+            {
+                std::vector<u32> cells( n, 0 );
+                for( auto& p : points )
+                {
+                    auto cx = u32( p.x * f32( 1u << a ) );
+                    auto cy = u32( p.y * f32( 1u << ( k - a ) ) );
+                    cells[( cy << a ) | cx]++;
+                }
+                u32 bad = 0;
+                for( auto c : cells )
+                { bad += ( c == 1 ) ? 0 : 1; }
+                TEST_CHECK( bad == 0 );
+            }
+
+            // グレイコード順の一括生成は同じ点集合になる.
+            std::vector<asdx::Vector2> filled( n );
+            asdx::FillSobol2D( start, n, filled.data(), scramble[0], scramble[1] );
+            TEST_CHECK( filled[0].x == points[0].x && filled[0].y == points[0].y );
+            auto less = []( const asdx::Vector2& l, const asdx::Vector2& r )
+            { return ( l.x < r.x ) || ( l.x == r.x && l.y < r.y ); };
+            std::sort( points.begin(), points.end(), less );
+            std::sort( filled.begin(), filled.end(), less );
+            TEST_CHECK( memcmp( points.data(), filled.data(), sizeof(asdx::Vector2) * n ) == 0 );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      バウンディングボリュームの変換と視錐台の抽出を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestBoundingVolume()
+{
+    u32 state = 4242;
+    auto view     = asdx::Matrix::CreateLookAt( asdx::Vector3( 3.0f, 2.0f, -8.0f ), asdx::Vector3( 0.0f, 0.0f, 0.0f ), asdx::Vector3( 0.0f, 1.0f, 0.0f ) );
+    auto proj     = asdx::Matrix::CreatePerspectiveFieldOfView( asdx::F_PIDIV4, 16.0f / 9.0f, 0.5f, 50.0f );
+    auto viewProj = view * proj;
+    auto invViewProj = asdx::Matrix::Invert( viewProj );
+    auto frustum  = asdx::Frustum::CreateFromMatrix( viewProj );
+
+    // 平面は正規化され, NDC の内側の点を含み外側の点を含まない.
+    for( u32 i=0; i<6; ++i )
+    {
+        const auto& p = frustum.Planes[i];
+        TEST_CHECK( IsNear( p.x * p.x + p.y * p.y + p.z * p.z, 1.0f ) );
+    }
+    for( u32 n=0; n<200; ++n )
+    {
+        asdx::Vector3 ndc( TestRandom( state, -0.95f, 0.95f ), TestRandom( state, -0.95f, 0.95f ), TestRandom( state, 0.05f, 0.95f ) );
+        TEST_CHECK( frustum.Contains( asdx::Vector3::TransformCoord( ndc, invViewProj ) ) );
+
+        auto outside = ndc;
+        switch( n % 5 )
+        {
+        case 0: outside.x =  1.1f; break;
+        case 1: outside.x = -1.1f; break;
+        case 2: outside.y =  1.1f; break;
+        case 3: outside.y = -1.1f; break;
+        case 4: outside.z =  1.05f; break;
+        }
+        TEST_CHECK( !frustum.Contains( asdx::Vector3::TransformCoord( outside, invViewProj ) ) );
+    }
+    TEST_CHECK( !frustum.Contains( asdx::Vector3( 3.0f, 2.0f, -8.0f ) ) );
+
+    // 変換したボリュームは変換した頂点を全て含む.
+    for( u32 n=0; n<200; ++n )
+    {
+        auto world = MakeAffineMatrix( state, false );
+        asdx::Vector3 mini( TestRandom( state, -2.0f, 0.0f ), TestRandom( state, -2.0f, 0.0f ), TestRandom( state, -2.0f, 0.0f ) );
+        asdx::Vector3 maxi( TestRandom( state,  0.0f, 2.0f ), TestRandom( state,  0.0f, 2.0f ), TestRandom( state,  0.0f, 2.0f ) );
+        asdx::BoundingBox box( mini, maxi );
+
+        auto aabb   = asdx::BoundingBox::Transform( box, world );
+        auto obb    = asdx::OrientedBox::CreateFromBox( box, world );
+        auto sphere = asdx::BoundingSphere::Transform( asdx::BoundingSphere::CreateFromBox( box ), world );
+
+        asdx::Vector3 corners[8];
+        for( u32 c=0; c<8; ++c )
+        {
+            asdx::Vector3 local( ( c & 1 ) ? maxi.x : mini.x, ( c & 2 ) ? maxi.y : mini.y, ( c & 4 ) ? maxi.z : mini.z );
+            corners[c] = asdx::Vector3::Transform( local, world );
+        }
+
+        // 境界上の頂点の丸め誤差を吸収するため少し広げて判定する.
+        const f32 slack = 1e-4f * ( 1.0f + world.m[3][0] * world.m[3][0] + world.m[3][1] * world.m[3][1] + world.m[3][2] * world.m[3][2] );
+        asdx::BoundingBox looseBox( aabb.Mini - asdx::Vector3( slack, slack, slack ), aabb.Maxi + asdx::Vector3( slack, slack, slack ) );
+        auto looseObb = obb;
+        looseObb.Extent = obb.Extent + asdx::Vector3( slack, slack, slack );
+        asdx::BoundingSphere looseSphere( sphere.Center, sphere.Radius + slack );
+
+        auto tight = asdx::BoundingBox::CreateFromPoints( corners, 8 );
+        auto fitted = asdx::BoundingSphere::CreateFromPoints( corners, 8 );
+        asdx::BoundingSphere looseFitted( fitted.Center, fitted.Radius + slack );
+        for( u32 c=0; c<8; ++c )
+        {
+            TEST_CHECK( looseBox.Contains( corners[c] ) );
+            TEST_CHECK( looseObb.Contains( corners[c] ) );
+            TEST_CHECK( looseSphere.Contains( corners[c] ) );
+            TEST_CHECK( looseFitted.Contains( corners[c] ) );
+            TEST_CHECK( tight.Contains( corners[c] ) );
+        }
+
+        // Arvo の方法は8頂点を囲む最小のボックスと一致する.
+        for( u32 a=0; a<3; ++a )
+        {
+            TEST_CHECK( IsNear( ( &aabb.Mini.x )[a], ( &tight.Mini.x )[a], slack ) );
+            TEST_CHECK( IsNear( ( &aabb.Maxi.x )[a], ( &tight.Maxi.x )[a], slack ) );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      視錐台の平面のどれかに対して境界上にあるかどうかチェックします.
+//!
+//! @note       FMA の有無で結果が変わり得るのは丸め誤差の範囲で平面に接するものだけです.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+bool IsCullingBorderline( const asdx::Frustum& frustum, const T& value )
+{
+    for( u32 i=0; i<6; ++i )
+    {
+        asdx::Frustum single;
+        for( u32 j=0; j<6; ++j )
+        { single.Planes[j] = frustum.Planes[i]; }
+
+        // 平面を少し動かして結果が変われば境界上.
+        auto a = single;
+        auto b = single;
+        for( u32 j=0; j<6; ++j )
+        {
+            a.Planes[j].w += 1e-3f;
+            b.Planes[j].w -= 1e-3f;
+        }
+        if ( a.Intersects( value ) != b.Intersects( value ) )
+        { return true; }
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      一括カリングの結果がスカラー版の判定と一致するかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename CullFunc, typename ParallelFunc>
+void CheckCulling( const asdx::Frustum& frustum, const std::vector<T>& bounds, CullFunc cull, ParallelFunc cullParallel )
+{
+    auto count = u32( bounds.size() );
+    std::vector<u32> visible( count );
+    std::vector<u32> parallel( count );
+    auto visibleCount  = cull( frustum, bounds.data(), count, visible.data() );
+    auto parallelCount = cullParallel( frustum, bounds.data(), count, parallel.data(), 1000 );
+
+    // 並列版は逐次版と同じ順序で同じ結果.
+    TEST_CHECK( visibleCount == parallelCount );
+    TEST_CHECK( memcmp( visible.data(), parallel.data(), sizeof(u32) * visibleCount ) == 0 );
+
+    u32 mismatch = 0;
+    u32 culled   = 0;
+    u32 cursor   = 0;
+    for( u32 i=0; i<count; ++i )
+    {
+        auto listed = ( cursor < visibleCount && visible[cursor] == i );
+        if ( listed )
+        { cursor++; }
+        else
+        { culled++; }
+
+        if ( listed != frustum.Intersects( bounds[i] ) && !IsCullingBorderline( frustum, bounds[i] ) )
+        { mismatch++; }
+    }
+    TEST_CHECK( cursor == visibleCount );
+    TEST_CHECK( mismatch == 0 );
+
+    // 半分程度が可視になる配置であることを確認する.
+    TEST_CHECK( culled > count / 10 && visibleCount > count / 10 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      一括カリングと並列版を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestCulling()
+{
+    auto view     = asdx::Matrix::CreateLookAt( asdx::Vector3( 0.0f, 5.0f, -20.0f ), asdx::Vector3( 0.0f, 0.0f, 0.0f ), asdx::Vector3( 0.0f, 1.0f, 0.0f ) );
+    auto proj     = asdx::Matrix::CreatePerspectiveFieldOfView( asdx::F_PIDIV3, 1.5f, 0.1f, 40.0f );
+    auto frustum  = asdx::Frustum::CreateFromMatrix( view * proj );
+
+    const u32 count = 20011;
+    u32 state = 777;
+    std::vector<asdx::BoundingBox>    boxes  ( count );
+    std::vector<asdx::BoundingSphere> spheres( count );
+    std::vector<asdx::OrientedBox>    obbs   ( count );
+    for( u32 i=0; i<count; ++i )
+    {
+        asdx::Vector3 center( TestRandom( state, -30.0f, 30.0f ), TestRandom( state, -20.0f, 20.0f ), TestRandom( state, -25.0f, 35.0f ) );
+        asdx::Vector3 extent( TestRandom( state, 0.0f, 2.0f ), TestRandom( state, 0.0f, 2.0f ), TestRandom( state, 0.0f, 2.0f ) );
+        boxes  [i] = asdx::BoundingBox( center - extent, center + extent );
+        spheres[i] = asdx::BoundingSphere( center, extent.x );
+
+        auto rotation = asdx::Matrix::CreateFromAxisAngle( asdx::Vector3::Normalize( extent + asdx::Vector3( 0.1f, 0.2f, 0.3f ) ), TestRandom( state, -3.0f, 3.0f ) );
+        obbs[i] = asdx::OrientedBox::CreateFromBox( asdx::BoundingBox( -extent, extent ), rotation * asdx::Matrix::CreateTranslation( center ) );
+    }
+
+    CheckCulling( frustum, boxes,   asdx::CullBoxes,         []( const asdx::Frustum& f, const asdx::BoundingBox* p, u32 n, u32* o, u32 g )    { return asdx::CullBoxesParallel( f, p, n, o, g ); } );
+    CheckCulling( frustum, spheres, asdx::CullSpheres,       []( const asdx::Frustum& f, const asdx::BoundingSphere* p, u32 n, u32* o, u32 g ) { return asdx::CullSpheresParallel( f, p, n, o, g ); } );
+    CheckCulling( frustum, obbs,    asdx::CullOrientedBoxes, []( const asdx::Frustum& f, const asdx::OrientedBox* p, u32 n, u32* o, u32 g )    { return asdx::CullOrientedBoxesParallel( f, p, n, o, g ); } );
+
+    // 空の入力と端数の要素数.
+    u32 dummy = 0xffffffff;
+    TEST_CHECK( asdx::CullBoxes( frustum, boxes.data(), 0, &dummy ) == 0 );
+    TEST_CHECK( asdx::CullBoxesParallel( frustum, boxes.data(), 0, &dummy ) == 0 );
+    std::vector<u32> visible( 3 );
+    auto n = asdx::CullSpheres( frustum, spheres.data(), 3, visible.data() );
+    u32 expected = 0;
+    for( u32 i=0; i<3; ++i )
+    { expected += frustum.Intersects( spheres[i] ) ? 1 : 0; }
+    TEST_CHECK( n == expected );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      パケット版の交差結果がスカラー版と一致するかどうかチェックします.
+//!
+//! @note       FMA 有効時はコンパイラがスカラー版の積和を縮約するので, わずかな差を許します.
+//-------------------------------------------------------------------------------------------------
+bool IsHitMatch( f32 a, f32 b )
+{
+#if ASDX_SIMD_FMA
+    return UlpDistance( a, b ) <= 16 || IsNear( a, b, 1e-5f );
+#else
+    return a == b;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      丸め差で交差の有無が分かれ得る境界上の結果かどうかを判定します.
+//-------------------------------------------------------------------------------------------------
+bool IsHitBorderline( f32 t, f32 u, f32 v, f32 tmax )
+{
+#if ASDX_SIMD_FMA
+    const f32 eps = 1e-4f;
+    return u < eps || v < eps || ( u + v ) > 1.0f - eps || t >= tmax * ( 1.0f - eps );
+#else
+    ASDX_UNUSED_VAR( t );
+    ASDX_UNUSED_VAR( u );
+    ASDX_UNUSED_VAR( v );
+    ASDX_UNUSED_VAR( tmax );
+    return false;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイパケットの最近接交差がスカラー版を順に適用した結果と一致することを確認します.
+//-------------------------------------------------------------------------------------------------
+template<u32 N>
+void CheckPacketTriangles( const std::vector<asdx::Vector3>& vertices, u32& state )
+{
+    auto triangleCount = u32( vertices.size() / 3 );
+    u32 mismatch = 0;
+    for( u32 p=0; p<64; ++p )
+    {
+        asdx::RayPacket<N> rays;
+        asdx::Ray scalar[N];
+        for( u32 i=0; i<N; ++i )
+        {
+            asdx::Vector3 origin( TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ), -5.0f );
+            asdx::Vector3 target( TestRandom( state, -2.0f, 2.0f ), TestRandom( state, -2.0f, 2.0f ), TestRandom( state, -1.0f, 1.0f ) );
+            // 一部のレイは区間を短くして途中の三角形だけと交差させる.
+            auto tmax = ( i % 3 == 0 ) ? TestRandom( state, 0.5f, 1.0f ) : FLT_MAX;
+            scalar[i] = asdx::Ray( origin, target - origin, 0.0f, tmax );
+            rays.Set( i, scalar[i] );
+        }
+
+        asdx::PacketHit<N> hit;
+        hit.Reset();
+        for( u32 t=0; t<triangleCount; ++t )
+        {
+            auto mask = asdx::IntersectPacketTriangle( rays, vertices[t * 3 + 0], vertices[t * 3 + 1], vertices[t * 3 + 2], t, hit );
+            for( u32 i=0; i<N; ++i )
+            {
+                f32 tt, u, v;
+                auto prevTMax = scalar[i].TMax;
+                auto expected = asdx::IntersectRayTriangle( scalar[i], vertices[t * 3 + 0], vertices[t * 3 + 1], vertices[t * 3 + 2], tt, u, v );
+                auto actual   = ( ( mask >> i ) & 1 ) != 0;
+                if ( expected && actual )
+                {
+                    scalar[i].TMax = tt;
+                    mismatch += ( hit.Index[i] == t && IsHitMatch( hit.T[i], tt ) && IsHitMatch( hit.U[i], u ) && IsHitMatch( hit.V[i], v ) ) ? 0 : 1;
+                }
+                else if ( expected != actual )
+                {
+                    // 境界上でだけ判定が分かれることを許し, 以降はパケット側の区間に揃える.
+                    auto borderline = expected
+                        ? IsHitBorderline( tt, u, v, prevTMax )
+                        : IsHitBorderline( hit.T[i], hit.U[i], hit.V[i], prevTMax );
+                    mismatch += borderline ? 0 : 1;
+                    scalar[i].TMax = rays.Get( i ).TMax;
+                }
+            }
+        }
+
+        // 交差しなかったレイはそのまま, 交差したレイは TMax が更新される.
+        for( u32 i=0; i<N; ++i )
+        {
+            auto ray = rays.Get( i );
+            mismatch += IsHitMatch( ray.TMax, scalar[i].TMax ) ? 0 : 1;
+            mismatch += ( hit.Index[i] == UINT32_MAX ) == ( hit.T[i] == FLT_MAX ) ? 0 : 1;
+        }
+    }
+    TEST_CHECK( mismatch == 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      水密な交差判定のパケット版と1本版が一致し, 共有辺を抜けないことを確認します.
+//-------------------------------------------------------------------------------------------------
+template<u32 N>
+void CheckPacketWatertight( const std::vector<asdx::Vector3>& grid, u32 gridSize, u32& state )
+{
+    u32 mismatch = 0;
+    u32 leaks    = 0;
+    for( u32 p=0; p<64; ++p )
+    {
+        // 格子の内部の辺上の点を狙う. 格子は XY 平面の z = 0 にある.
+        asdx::RayPacket<N> rays;
+        for( u32 i=0; i<N; ++i )
+        {
+            auto cx = 1 + u32( TestRandom( state, 0.0f, f32( gridSize - 2 ) ) );
+            auto cy = 1 + u32( TestRandom( state, 0.0f, f32( gridSize - 2 ) ) );
+            auto s  = TestRandom( state, 0.0f, 1.0f );
+            asdx::Vector3 target;
+            switch( i % 3 )
+            {
+            case 0: target = asdx::Vector3( f32( cx ) + s, f32( cy ), 0.0f ); break;           // 横の辺.
+            case 1: target = asdx::Vector3( f32( cx ), f32( cy ) + s, 0.0f ); break;           // 縦の辺.
+            case 2: target = asdx::Vector3( f32( cx ) + s, f32( cy ) + 1.0f - s, 0.0f ); break; // 対角線.
+            }
+            asdx::Vector3 origin( TestRandom( state, -3.0f, 3.0f ) + target.x, TestRandom( state, -3.0f, 3.0f ) + target.y, -7.0f );
+            rays.Set( i, asdx::Ray( origin, target - origin ) );
+        }
+
+        asdx::WatertightPacket<N> shear;
+        shear.Init( rays );
+        auto single = rays;
+
+        asdx::PacketHit<N> hit;
+        hit.Reset();
+        for( u32 t=0; t<u32( grid.size() / 3 ); ++t )
+        {
+            asdx::IntersectPacketTriangleWatertight( rays, shear, grid[t * 3 + 0], grid[t * 3 + 1], grid[t * 3 + 2], t, hit );
+            for( u32 i=0; i<N; ++i )
+            {
+                f32 tt, u, v;
+                auto ray = single.Get( i );
+                if ( asdx::IntersectRayTriangleWatertight( ray, grid[t * 3 + 0], grid[t * 3 + 1], grid[t * 3 + 2], tt, u, v ) )
+                { single.TMax[i] = tt; }
+            }
+        }
+
+        for( u32 i=0; i<N; ++i )
+        {
+            leaks    += ( hit.Index[i] == UINT32_MAX ) ? 1 : 0;
+            mismatch += ( rays.TMax[i] == single.TMax[i] ) ? 0 : 1;
+        }
+    }
+    TEST_CHECK( leaks == 0 );
+    TEST_CHECK( mismatch == 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      レイパケットと8個のボックスの交差判定を確認します.
+//-------------------------------------------------------------------------------------------------
+void TestIntersectionPacket()
+{
+    u32 state = 31415;
+
+    // 重なり合うランダムな三角形.
+    std::vector<asdx::Vector3> triangles;
+    for( u32 i=0; i<40 * 3; ++i )
+    { triangles.push_back( asdx::Vector3( TestRandom( state, -2.0f, 2.0f ), TestRandom( state, -2.0f, 2.0f ), TestRandom( state, -1.0f, 1.0f ) ) ); }
+
+    CheckPacketTriangles<4> ( triangles, state );
+    CheckPacketTriangles<8> ( triangles, state );
+    CheckPacketTriangles<16>( triangles, state );
+
+    // 辺を共有する三角形の格子.
+    const u32 gridSize = 8;
+    std::vector<asdx::Vector3> grid;
+    for( u32 y=0; y<gridSize; ++y )
+    {
+        for( u32 x=0; x<gridSize; ++x )
+        {
+            asdx::Vector3 p00( f32( x ),     f32( y ),     0.0f );
+            asdx::Vector3 p10( f32( x + 1 ), f32( y ),     0.0f );
+            asdx::Vector3 p01( f32( x ),     f32( y + 1 ), 0.0f );
+            asdx::Vector3 p11( f32( x + 1 ), f32( y + 1 ), 0.0f );
+            grid.push_back( p00 ); grid.push_back( p10 ); grid.push_back( p01 );
+            grid.push_back( p10 ); grid.push_back( p11 ); grid.push_back( p01 );
+        }
+    }
+    CheckPacketWatertight<4> ( grid, gridSize, state );
+    CheckPacketWatertight<8> ( grid, gridSize, state );
+    CheckPacketWatertight<16>( grid, gridSize, state );
+
+    // 8個のボックス. 未使用の枠は交差しない.
+    u32 mismatch = 0;
+    for( u32 n=0; n<2000; ++n )
+    {
+        asdx::BoxPacket8 packet;
+        packet.Reset();
+        asdx::BoundingBox boxes[8];
+        auto used = 1 + n % 8;
+        for( u32 i=0; i<used; ++i )
+        {
+            asdx::Vector3 center( TestRandom( state, -4.0f, 4.0f ), TestRandom( state, -4.0f, 4.0f ), TestRandom( state, -4.0f, 4.0f ) );
+            asdx::Vector3 extent( TestRandom( state, 0.0f, 1.5f ), TestRandom( state, 0.0f, 1.5f ), TestRandom( state, 0.0f, 1.5f ) );
+            boxes[i] = asdx::BoundingBox( center - extent, center + extent );
+            packet.Set( i, boxes[i] );
+        }
+
+        asdx::Vector3 origin( TestRandom( state, -6.0f, 6.0f ), TestRandom( state, -6.0f, 6.0f ), TestRandom( state, -6.0f, 6.0f ) );
+        asdx::Vector3 dir( TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ) );
+        if ( n % 10 == 0 )
+        { dir.y = 0.0f; }   // 軸に平行なレイ.
+        asdx::Vector3 invDir( 1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z );
+        auto tmax = ( n % 4 == 0 ) ? 3.0f : FLT_MAX;
+
+        ASDX_ALIGN(32) f32 tnear[8];
+        ASDX_ALIGN(32) f32 robustNear[8];
+        auto mask   = asdx::IntersectRayBoxes8( origin, invDir, packet, 0.0f, tmax, tnear );
+        auto robust = asdx::IntersectRayBoxes8Robust( origin, invDir, packet, 0.0f, tmax, robustNear );
+        mismatch += ( ( mask & ~robust ) == 0 ) ? 0 : 1;
+        mismatch += ( ( robust >> used ) == 0 ) ? 0 : 1;
+        for( u32 i=0; i<used; ++i )
+        {
+            f32 expectedNear;
+            auto expected = asdx::IntersectRayBox( origin, invDir, boxes[i], 0.0f, tmax, expectedNear );
+            mismatch += ( ( ( mask >> i ) & 1 ) == ( expected ? 1u : 0u ) ) ? 0 : 1;
+            if ( expected )
+            { mismatch += ( tnear[i] == expectedNear && robustNear[i] == expectedNear ) ? 0 : 1; }
+        }
+    }
+    TEST_CHECK( mismatch == 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ポインタが指定のアライメントを満たすかどうか判定します.
+//-------------------------------------------------------------------------------------------------
+inline bool IsAligned( const void* ptr, size_t alignment )
+{ return ( reinterpret_cast<uintptr_t>( ptr ) & ( alignment - 1 ) ) == 0; }
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      再確保を繰り返しても全要素のアライメントが保たれることを確認します.
+//-------------------------------------------------------------------------------------------------
+template<typename T, u32 Alignment>
+void CheckAlignedVector()
+{
+    asdx::AlignedVector<T, Alignment> values;
+    u32 misaligned = 0;
+    for( u32 i=0; i<300; ++i )
+    {
+        values.push_back( T() );
+        misaligned += IsAligned( values.data(), Alignment ) ? 0 : 1;
+    }
+    for( size_t i=0; i<values.size(); ++i )
+    { misaligned += IsAligned( &values[i], alignof(T) ) ? 0 : 1; }
+
+    values.resize( 7 );
+    values.shrink_to_fit();
+    misaligned += IsAligned( values.data(), Alignment ) ? 0 : 1;
+    TEST_CHECK( misaligned == 0 );
+}
+
+void TestAlignedAllocator()
+{
+    // 生の確保関数.
+    const size_t alignments[] = { sizeof(void*), 16, 32, 64, 256, 4096 };
+    for( auto alignment : alignments )
+    {
+        for( size_t size=1; size<=1024; size*=4 )
+        {
+            auto ptr = asdx::AlignedAlloc( size, alignment );
+            TEST_CHECK( ptr != nullptr && IsAligned( ptr, alignment ) );
+            if ( ptr != nullptr )
+            { memset( ptr, 0xcd, size ); }
+            asdx::AlignedFree( ptr );
+        }
+    }
+
+    auto& tracker = asdx::MemoryTracker::Instance();
+    asdx::MemoryFrameReport before, after;
+    tracker.EndFrame( &before );
+
+    // 要素の型が要求するアライメントと, 配列の先頭のアライメントの両方.
+    CheckAlignedVector<f32,               32>();
+    CheckAlignedVector<u8,                64>();
+    CheckAlignedVector<asdx::Vector4A,    16>();
+    CheckAlignedVector<asdx::Vector4A32,  32>();
+    CheckAlignedVector<asdx::MatrixA64,   64>();
+    CheckAlignedVector<asdx::CacheAligned<u32>, asdx::CacheLineSize>();
+
+    // 確保したメモリはすべて解放されている.
+    tracker.EndFrame( &after );
+#if ASDX_ENABLE_MEMORY_TRACKING
+    TEST_CHECK( after.Tags[asdx::MEMORY_TAG_MATH].LiveBytes == before.Tags[asdx::MEMORY_TAG_MATH].LiveBytes );
+    TEST_CHECK( after.Tags[asdx::MEMORY_TAG_MATH].FrameAllocCount > 0 );
+#endif
+
+    // 隣り合う要素は別のキャッシュラインに置かれる.
+    asdx::CacheAligned<u32> counters[4];
+    for( u32 i=0; i<3; ++i )
+    {
+        auto distance = reinterpret_cast<uintptr_t>( &counters[i + 1] ) - reinterpret_cast<uintptr_t>( &counters[i] );
+        TEST_CHECK( distance == asdx::CacheLineSize );
+        TEST_CHECK( IsAligned( &counters[i], asdx::CacheLineSize ) );
+    }
+
+    // アライメント済みの変換は通常の変換と一致し, 入出力に同じ配列を指定できる.
+    u32 state = 0x9e3779b9;
+    asdx::MatrixA matrix;
+    for( u32 r=0; r<4; ++r )
+    {
+        for( u32 c=0; c<4; ++c )
+        { matrix.m[r][c] = TestRandom( state, -2.0f, 2.0f ); }
+    }
+
+    asdx::AlignedVector<asdx::Vector4A, 16> input( 37 );
+    asdx::AlignedVector<asdx::Vector4A, 16> output( input.size() );
+    for( size_t i=0; i<input.size(); ++i )
+    {
+        input[i] = asdx::Vector4( TestRandom( state, -10.0f, 10.0f ), TestRandom( state, -10.0f, 10.0f ),
+                                  TestRandom( state, -10.0f, 10.0f ), TestRandom( state, -10.0f, 10.0f ) );
+    }
+
+    asdx::TransformStream( input.data(), u32( input.size() ), matrix, output.data() );
+    u32 mismatch = 0;
+    for( size_t i=0; i<input.size(); ++i )
+    {
+        auto expected = asdx::Vector4::Transform( input[i], matrix );
+        const f32* pA = &output[i].x;
+        const f32* pB = &expected.x;
+        for( u32 j=0; j<4; ++j )
+        { mismatch += IsNear( pA[j], pB[j], 1e-5f * ( 1.0f + fabsf( pB[j] ) ) ) ? 0 : 1; }
+    }
+    TEST_CHECK( mismatch == 0 );
+
+    asdx::TransformStream( input.data(), u32( input.size() ), matrix, input.data() );
+    TEST_CHECK( memcmp( input.data(), output.data(), sizeof(asdx::Vector4A) * input.size() ) == 0 );
+
+#if ASDX_SIMD_SSE2
+    // アライメント済みのロード・ストアで値が変わらない.
+    asdx::Vector4A64 loaded;
+    asdx::simd::Store( loaded, asdx::simd::Load( output[3] ) );
+    TEST_CHECK( loaded.x == output[3].x && loaded.y == output[3].y && loaded.z == output[3].z && loaded.w == output[3].w );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      階層の比較用のノードです.
+//-------------------------------------------------------------------------------------------------
+struct ReferenceNode
+{
+    u32                 Parent;         //!< 親のノード番号です.
+    asdx::Vector3       Translation;    //!< ローカルの平行移動です.
+    asdx::Quaternion    Rotation;       //!< ローカルの回転です.
+    asdx::Vector3       Scale;          //!< ローカルのスケールです.
+    bool                Alive;          //!< 削除されていないかどうか.
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      親をたどってワールド行列を再帰的に求めます. 比較用です.
+//-------------------------------------------------------------------------------------------------
+asdx::Matrix ComputeReferenceWorld( const std::vector<ReferenceNode>& nodes, u32 id )
+{
+    const auto& node = nodes[id];
+    auto local = asdx::Matrix::CreateScale( node.Scale )
+               * asdx::Matrix::CreateFromQuaternion( node.Rotation )
+               * asdx::Matrix::CreateTranslation( node.Translation );
+    if ( node.Parent == asdx::TransformHierarchy::InvalidId )
+    { return local; }
+    return local * ComputeReferenceWorld( nodes, node.Parent );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ランダムなローカルの姿勢を生成します.
+//-------------------------------------------------------------------------------------------------
+void MakeReferenceLocal( u32& state, ReferenceNode& node )
+{
+    node.Translation = asdx::Vector3( TestRandom( state, -2.0f, 2.0f ), TestRandom( state, -2.0f, 2.0f ), TestRandom( state, -2.0f, 2.0f ) );
+    node.Rotation    = asdx::Quaternion::CreateFromYawPitchRoll( TestRandom( state, -3.0f, 3.0f ), TestRandom( state, -1.5f, 1.5f ), TestRandom( state, -3.0f, 3.0f ) );
+    node.Scale       = asdx::Vector3( TestRandom( state, 0.8f, 1.25f ), TestRandom( state, 0.8f, 1.25f ), TestRandom( state, 0.8f, 1.25f ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      全ての生存ノードのワールド行列と親子関係が比較用の結果と一致するか数えます.
+//-------------------------------------------------------------------------------------------------
+u32 CountHierarchyMismatch( const asdx::TransformHierarchy& hierarchy, const std::vector<ReferenceNode>& nodes )
+{
+    u32 mismatch = 0;
+    u32 alive    = 0;
+    for( u32 id=0; id<u32( nodes.size() ); ++id )
+    {
+        if ( !nodes[id].Alive )
+        {
+            mismatch += hierarchy.IsValid( id ) ? 1 : 0;
+            continue;
+        }
+
+        alive++;
+        if ( !hierarchy.IsValid( id ) || hierarchy.GetParent( id ) != nodes[id].Parent )
+        {
+            mismatch++;
+            continue;
+        }
+
+        // 親は常に子より前に並ぶ.
+        if ( nodes[id].Parent != asdx::TransformHierarchy::InvalidId )
+        { mismatch += ( hierarchy.GetIndex( nodes[id].Parent ) < hierarchy.GetIndex( id ) ) ? 0 : 1; }
+
+        auto expected = ComputeReferenceWorld( nodes, id );
+        const auto& actual = hierarchy.GetWorld( id );
+        for( u32 r=0; r<4; ++r )
+        {
+            for( u32 c=0; c<4; ++c )
+            { mismatch += IsNear( actual.m[r][c], expected.m[r][c], 1e-4f * ( 1.0f + fabsf( expected.m[r][c] ) ) ) ? 0 : 1; }
+        }
+    }
+    mismatch += ( hierarchy.GetCount() == alive ) ? 0 : 1;
+    return mismatch;
+}
+
+void TestTransformHierarchyReference()
+{
+    const auto invalid = asdx::TransformHierarchy::InvalidId;
+
+    u32 state = 0x2545f491;
+    asdx::TransformHierarchy    hierarchy;
+    std::vector<ReferenceNode>  nodes;
+
+    auto add = [&]( u32 parent )
+    {
+        ReferenceNode node;
+        node.Parent = parent;
+        node.Alive  = true;
+        MakeReferenceLocal( state, node );
+        auto id = hierarchy.Add( parent, node.Translation, node.Rotation, node.Scale );
+        if ( id >= nodes.size() )
+        { nodes.resize( id + 1 ); }
+        nodes[id] = node;
+        return id;
+    };
+
+    auto pickAlive = [&]()
+    {
+        for( ;; )
+        {
+            auto id = u32( TestRandom( state, 0.0f, f32( nodes.size() ) ) ) % u32( nodes.size() );
+            if ( nodes[id].Alive )
+            { return id; }
+        }
+    };
+
+    // 親を既存のノードから選ぶので, 深さの順序が崩れた追加も混ざる.
+    for( u32 i=0; i<8; ++i )
+    { add( invalid ); }
+    for( u32 i=0; i<600; ++i )
+    { add( pickAlive() ); }
+
+    hierarchy.Update( 16 );
+    TEST_CHECK( CountHierarchyMismatch( hierarchy, nodes ) == 0 );
+
+    // 変更が無ければ行列はそのまま.
+    std::vector<asdx::Matrix> previous( hierarchy.GetWorldMatrices(), hierarchy.GetWorldMatrices() + hierarchy.GetCount() );
+    hierarchy.Update( 16 );
+    TEST_CHECK( memcmp( previous.data(), hierarchy.GetWorldMatrices(), sizeof(asdx::Matrix) * previous.size() ) == 0 );
+
+    for( u32 round=0; round<6; ++round )
+    {
+        // 一部のノードだけ変更し, 子孫へ伝播することを確認する.
+        for( u32 i=0; i<20; ++i )
+        {
+            auto  id   = pickAlive();
+            auto& node = nodes[id];
+            ReferenceNode local;
+            MakeReferenceLocal( state, local );
+            switch( ( round + i ) % 4 )
+            {
+            case 0:
+                node.Translation = local.Translation;
+                node.Rotation    = local.Rotation;
+                node.Scale       = local.Scale;
+                hierarchy.SetLocal( id, node.Translation, node.Rotation, node.Scale );
+                break;
+            case 1:
+                node.Translation = local.Translation;
+                hierarchy.SetTranslation( id, node.Translation );
+                break;
+            case 2:
+                node.Rotation = local.Rotation;
+                hierarchy.SetRotation( id, node.Rotation );
+                break;
+            default:
+                node.Scale = local.Scale;
+                hierarchy.SetScale( id, node.Scale );
+                break;
+            }
+        }
+
+        // 部分木の削除とノード番号の再利用.
+        if ( round % 2 == 1 )
+        {
+            for( u32 i=0; i<3; ++i )
+            {
+                auto id = pickAlive();
+                hierarchy.Remove( id );
+                nodes[id].Alive = false;
+            }
+
+            // 親が削除されたノードは子孫ごと削除される.
+            for( size_t id=0; id<nodes.size(); ++id )
+            {
+                auto parent = nodes[id].Parent;
+                if ( nodes[id].Alive && parent != invalid && !nodes[parent].Alive )
+                {
+                    // 番号を再利用した親は子より大きいことがあるので先頭からやり直す.
+                    nodes[id].Alive = false;
+                    id = size_t( -1 );
+                }
+            }
+
+            hierarchy.Update( 16 );
+            TEST_CHECK( CountHierarchyMismatch( hierarchy, nodes ) == 0 );
+
+            for( u32 i=0; i<40; ++i )
+            { add( ( i % 5 == 0 ) ? invalid : pickAlive() ); }
+        }
+
+        hierarchy.Update( 1 + round * 7 );
+        TEST_CHECK( CountHierarchyMismatch( hierarchy, nodes ) == 0 );
+    }
+
+    // 全て変更済みにしても結果は変わらない.
+    hierarchy.Invalidate();
+    hierarchy.Update();
+    TEST_CHECK( CountHierarchyMismatch( hierarchy, nodes ) == 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ベクトルが相対誤差 epsilon 以内で一致するかどうか判定します.
+//-------------------------------------------------------------------------------------------------
+inline bool IsNearRelative( const asdx::Vector3& a, const asdx::Vector3& b, f32 epsilon )
+{
+    return IsNear( a.x, b.x, epsilon * ( 1.0f + fabsf( b.x ) ) )
+        && IsNear( a.y, b.y, epsilon * ( 1.0f + fabsf( b.y ) ) )
+        && IsNear( a.z, b.z, epsilon * ( 1.0f + fabsf( b.z ) ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ランダムな係数を生成します.
+//-------------------------------------------------------------------------------------------------
+asdx::SH9 MakeTestSH9( u32& state )
+{
+    asdx::SH9 result;
+    for( u32 i=0; i<9; ++i )
+    { result.c[i] = asdx::Vector3( TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ), TestRandom( state, -1.0f, 1.0f ) ); }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      回転した係数を回転先の方向で評価すると, 元の方向の値と一致することを確認します.
+//-------------------------------------------------------------------------------------------------
+void TestSphericalHarmonicsRotation()
+{
+    u32 state = 0x6a09e667;
+    u32 mismatch = 0;
+    for( u32 iter=0; iter<64; ++iter )
+    {
+        auto sh = MakeTestSH9( state );
+        asdx::SH4 sh4( sh );
+        auto q = asdx::Quaternion::CreateFromYawPitchRoll( TestRandom( state, -3.0f, 3.0f ), TestRandom( state, -1.5f, 1.5f ), TestRandom( state, -3.0f, 3.0f ) );
+        auto m = asdx::Matrix::CreateFromQuaternion( q );
+
+        asdx::SH9 rotated, rotatedQ;
+        asdx::SH4 rotated4;
+        asdx::RotateSH( sh,  m, rotated );
+        asdx::RotateSH( sh,  q, rotatedQ );
+        asdx::RotateSH( sh4, m, rotated4 );
+
+        for( u32 i=0; i<32; ++i )
+        {
+            auto d = MakeTestUnitVector( state, i );
+            auto r = asdx::Vector3::TransformNormal( d, m );
+            mismatch += IsNearRelative( asdx::EvaluateSH( rotated,  r ), asdx::EvaluateSH( sh,  d ), 1e-4f ) ? 0 : 1;
+            mismatch += IsNearRelative( asdx::EvaluateSH( rotatedQ, r ), asdx::EvaluateSH( sh,  d ), 1e-4f ) ? 0 : 1;
+            mismatch += IsNearRelative( asdx::EvaluateSH( rotated4, r ), asdx::EvaluateSH( sh4, d ), 1e-4f ) ? 0 : 1;
+        }
+
+        // 回転の合成と, 入出力に同じオブジェクトを指定した場合.
+        auto q2 = asdx::Quaternion::CreateFromYawPitchRoll( TestRandom( state, -3.0f, 3.0f ), TestRandom( state, -1.5f, 1.5f ), TestRandom( state, -3.0f, 3.0f ) );
+        auto m2 = asdx::Matrix::CreateFromQuaternion( q2 );
+        asdx::SH9 composed;
+        asdx::RotateSH( sh, m * m2, composed );
+        asdx::RotateSH( rotated, m2, rotated );
+        for( u32 i=0; i<9; ++i )
+        { mismatch += IsNearRelative( rotated.c[i], composed.c[i], 1e-4f ) ? 0 : 1; }
+    }
+    TEST_CHECK( mismatch == 0 );
+}
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      射影の SoA 版と放射照度の SoA 版がスカラー版と一致することを確認します.
+//-------------------------------------------------------------------------------------------------
+void TestSphericalHarmonicsIrradiance()
+{
+    u32 state = 0xbb67ae85;
+
+    // キューブマップの立体角の合計は 4π になる.
+    std::vector<asdx::Vector3> directions;
+    std::vector<f32>           weights;
+    asdx::CreateCubemapSampleSet( 16, directions, weights );
+    f64 total = 0.0;
+    for( size_t i=0; i<weights.size(); ++i )
+    { total += weights[i]; }
+    TEST_CHECK( fabs( total - 4.0 * asdx::F_PI ) < 1e-4 );
+
+    // 帯域制限された関数を射影すると元の係数に戻る.
+    const u32 probeCount = 5;
+    auto sampleCount = u32( directions.size() );
+    std::vector<asdx::SH9>     expected( probeCount );
+    std::vector<asdx::Vector3> values( size_t( probeCount ) * sampleCount );
+    for( u32 p=0; p<probeCount; ++p )
+    {
+        expected[p] = MakeTestSH9( state );
+        for( u32 i=0; i<sampleCount; ++i )
+        { values[size_t( p ) * sampleCount + i] = asdx::EvaluateSH( expected[p], directions[i] ); }
+    }
+
+    asdx::SHProjector projector;
+    projector.InitCubemap( 16 );
+    TEST_CHECK( projector.GetSampleCount() == sampleCount );
+
+    std::vector<asdx::SH9> parallel( probeCount );
+    projector.ProjectParallel( values.data(), probeCount, parallel.data(), 1 );
+
+    u32 mismatch = 0;
+    for( u32 p=0; p<probeCount; ++p )
+    {
+        asdx::SH9 scalar, packed;
+        asdx::ProjectSH( directions.data(), weights.data(), values.data() + size_t( p ) * sampleCount, sampleCount, scalar );
+        projector.Project( values.data() + size_t( p ) * sampleCount, packed );
+        for( u32 i=0; i<9; ++i )
+        {
+            mismatch += IsNearRelative( packed.c[i], scalar.c[i], 1e-4f ) ? 0 : 1;
+            mismatch += IsNearRelative( scalar.c[i], expected[p].c[i], 1e-2f ) ? 0 : 1;
+            mismatch += memcmp( &parallel[p].c[i], &packed.c[i], sizeof(asdx::Vector3) ) == 0 ? 0 : 1;
+        }
+    }
+    TEST_CHECK( mismatch == 0 );
+
+    // 一様な放射輝度 L の放射照度は π L になる.
+    {
+        asdx::SH9 uniform;
+        uniform.c[0] = asdx::Vector3( 1.0f, 2.0f, 3.0f ) * ( 4.0f * asdx::F_PI * asdx::SH_K0 );
+        auto e = asdx::EvaluateIrradiance( uniform, MakeTestUnitVector( state, UINT32_MAX ) );
+        TEST_CHECK( IsNearRelative( e, asdx::Vector3( 1.0f, 2.0f, 3.0f ) * asdx::F_PI, 1e-5f ) );
+    }
+
+    // 余白を含む要素数で SoA 版とストリーム版をスカラー版と比べる.
+    const u32 counts[] = { 1, 3, 7, 8, 9, 17, 31, 256, 600 };
+    for( auto count : counts )
+    {
+        auto sh = MakeTestSH9( state );
+        std::vector<asdx::Vector3> normals( count );
+        for( u32 i=0; i<count; ++i )
+        { normals[i] = MakeTestUnitVector( state, i ); }
+
+        asdx::Vector3SoA soaNormals, soaResult;
+        soaNormals.FromAoS( normals.data(), count );
+        asdx::EvaluateIrradiance( sh, soaNormals, soaResult );
+
+        std::vector<asdx::Vector3> stream( count );
+        asdx::EvaluateIrradianceStream( sh, normals.data(), count, stream.data() );
+
+        mismatch = 0;
+        TEST_CHECK( soaResult.GetCount() == count );
+        for( u32 i=0; i<count; ++i )
+        {
+            auto expectedIrradiance = asdx::EvaluateIrradiance( sh, normals[i] );
+            auto actual = soaResult.Get( i );
+            mismatch += IsNearRelative( actual, expectedIrradiance, 1e-4f ) ? 0 : 1;
+            mismatch += memcmp( &stream[i], &actual, sizeof(asdx::Vector3) ) == 0 ? 0 : 1;
+        }
+
+        // 余白の要素はゼロに保たれる.
+        auto padded = ( count + asdx::simd::FloatNWidth - 1 ) & ~( asdx::simd::FloatNWidth - 1 );
+        for( u32 ch=0; ch<3; ++ch )
+        {
+            for( u32 i=count; i<padded; ++i )
+            { mismatch += ( soaResult.GetComponent( ch )[i] == 0.0f ) ? 0 : 1; }
+        }
+        TEST_CHECK( mismatch == 0 );
+    }
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    const char* filter = nullptr;
+    for( int i=1; i<argc; ++i )
+    {
+        if ( i + 1 < argc && strcmp( argv[i], "-filter" ) == 0 )
+        { filter = argv[++i]; }
+        else
+        {
+            fprintf( stderr, "Usage : %s [-filter text]\n", argv[0] );
+            return -1;
+        }
+    }
+
+    static const TestCase tests[] = {
+        { "SoA.MismatchedCapacity",     TestSoAMismatchedCapacity },
+        { "Animation.MixedSkeletons",   TestAnimationMixedSkeletons },
+        { "Residency.PolicyLru",        TestResidencyPolicyLru },
+        { "Parallel.CountLimit",        TestParallelForCountLimit },
+        { "Entity.StructuralChanges",   TestEntityStructuralChanges },
+        { "Entity.CommandBuffer",       TestEntityCommandBuffer },
+        { "Entity.LargeComponent",      TestEntityLargeComponent },
+        { "Pool.CrossThreadFree",       TestPoolCrossThreadFree },
+        { "Pool.MagazineEviction",      TestPoolMagazineEviction },
+        { "FastMath.Domain",            TestFastMathDomain },
+        { "FastMath.ErrorBound",        TestFastMathErrorBound },
+        { "FastMath.Widths",            TestFastMathWidths },
+        { "Bvh.BruteForce",             TestBvhBruteForce },
+        { "Bvh.Triangles",              TestBvhTriangles },
+        { "Handle.Stale",               TestHandleStale },
+        { "MemoryTracker.TaggedNew",    TestMemoryTrackerTaggedNew },
+        { "Simd.MatrixKernels",         TestSimdMatrixKernels },
+        { "Broadphase.SweepAndPrune",   TestBroadphaseSweepAndPrune },
+        { "Broadphase.DynamicAabbTree", TestBroadphaseDynamicAabbTree },
+        { "FrameAllocator.Basic",       TestFrameAllocator },
+        { "Math.TransformStream",       TestMathTransformStream },
+        { "Math.Matrix3x4",             TestMatrix3x4 },
+        { "Math.F16Conversion",         TestF16Conversion },
+        { "Quantization.Norm",          TestQuantizationNorm },
+        { "Quantization.Vertex",        TestQuantizationVertex },
+        { "Random.Xoshiro128",          TestRandomN },
+        { "Random.LowDiscrepancy",      TestLowDiscrepancy },
+        { "Bounds.Transform",           TestBoundingVolume },
+        { "Bounds.Culling",             TestCulling },
+        { "Intersection.Packet",        TestIntersectionPacket },
+        { "AlignedAllocator.Alignment", TestAlignedAllocator },
+        { "TransformHierarchy.Reference", TestTransformHierarchyReference },
+        { "SphericalHarmonics.Rotation", TestSphericalHarmonicsRotation },
+        { "SphericalHarmonics.Irradiance", TestSphericalHarmonicsIrradiance },
+    };
+
+    u32 failedTests = 0;
+    u32 runTests    = 0;
+    for( auto& test : tests )
+    {
+        if ( filter != nullptr && strstr( test.Name, filter ) == nullptr )
+        { continue; }
+
+        u32 before = g_FailCount;
+        test.Func();
+        runTests++;
+
+        auto failed = ( g_FailCount != before );
+        if ( failed )
+        { failedTests++; }
+
+        printf( "[%s] %s\n", failed ? "FAILED" : "  OK  ", test.Name );
+    }
+
+    printf( "%u / %u passed.\n", runTests - failedTests, runTests );
+    return ( failedTests == 0 ) ? 0 : 1;
+}